@@ -61,6 +61,8 @@ enum {
   P_SHRINK_BYTES,
   P_LOCK,
   P_UNLOCK,
+  P_READAHEAD,
+  P_READAHEAD_HIT,
   P_LAST,
 };
 
@@ -75,6 +77,8 @@ int SimpleRADOSStriper::config_logger(CephContext* cct, std::string_view name, s
   plb.add_u64_counter(P_SHRINK_BYTES, "shrink_bytes", "Bytes shrunk");
   plb.add_u64_counter(P_LOCK, "lock", "Number of locks");
   plb.add_u64_counter(P_UNLOCK, "unlock", "Number of unlocks");
+  plb.add_u64_counter(P_READAHEAD, "readahead", "Number of read-ahead window fetches");
+  plb.add_u64_counter(P_READAHEAD_HIT, "readahead_hit", "Number of reads served from the read-ahead window");
   l->reset(plb.create_perf_counters());
   return 0;
 }
@@ -148,6 +152,8 @@ int SimpleRADOSStriper::truncate(uint64_t size)
     return -EBLOCKLISTED;
   }
 
+  drop_readahead();
+
   /* TODO: (not currently used by SQLite) handle growth + sparse */
   if (int rc = set_metadata(size, true); rc < 0) {
     return rc;
@@ -449,6 +455,11 @@ ssize_t SimpleRADOSStriper::write(const void* data, size_t len, uint64_t off)
     return -EBLOCKLISTED;
   }
 
+  if (off < readahead_off + readahead_bl.length() &&
+      readahead_off < off + len) {
+    drop_readahead();
+  }
+
   if (allocated < (len+off)) {
     if (int rc = set_metadata(len+off, false); rc < 0) {
       return rc;
@@ -487,6 +498,55 @@ ssize_t SimpleRADOSStriper::read(void* data, size_t len, uint64_t off)
     return -EBLOCKLISTED;
   }
 
+  if (readahead_max > 0) {
+    if (off >= readahead_off &&
+        off + len <= readahead_off + readahead_bl.length()) {
+      d(20) << " readahead hit " << readahead_off << "~"
+            << readahead_bl.length() << dendl;
+      readahead_bl.begin(off - readahead_off).copy(len, (char*)data);
+      last_read_end = off + len;
+      if (logger) logger->inc(P_READAHEAD_HIT);
+      return len;
+    }
+    if (off == last_read_end) {
+      ++sequential_reads;
+    } else {
+      sequential_reads = 0;
+    }
+    /* sequential scan: once two reads in a row have each started where the
+     * previous one ended, fetch a larger window and serve the following
+     * reads from it.  The window is dropped on any write and whenever the
+     * lock changes hands, so it never outlives the lock it was read under.
+     */
+    if (sequential_reads >= 2 && len < readahead_max && off + len < size) {
+      size_t ralen = std::min<uint64_t>(readahead_max, size - off);
+      ceph::bufferptr bp(ceph::buffer::create(ralen));
+      ssize_t r = read_extents(bp.c_str(), ralen, off);
+      if (r < 0) {
+        drop_readahead();
+        return r;
+      }
+      if (logger) logger->inc(P_READAHEAD);
+      bp.set_length(r);
+      readahead_bl.clear();
+      readahead_bl.append(std::move(bp));
+      readahead_off = off;
+      size_t n = std::min<size_t>(len, r);
+      readahead_bl.begin().copy(n, (char*)data);
+      last_read_end = off + n;
+      return n;
+    }
+  }
+
+  ssize_t r = read_extents((char*)data, len, off);
+  if (r >= 0) {
+    last_read_end = off + r;
+  }
+  return r;
+}
+
+ssize_t SimpleRADOSStriper::read_extents(char* data, size_t len, uint64_t off)
+{
   size_t r = 0;
   // Don't use std::vector to store bufferlists (e.g for parallelizing aio_reads),
   // as they are being moved whenever the vector resizes
@@ -509,7 +569,7 @@ ssize_t SimpleRADOSStriper::read(void* data, size_t len, uint64_t off)
       d(1) << " read failure: " << cpp_strerror(rc) << dendl;
       return rc;
     }
-    bl.begin().copy(bl.length(), ((char*)data)+r);
+    bl.begin().copy(bl.length(), data+r);
     r += bl.length();
   }
   ceph_assert(r <= len);
@@ -672,6 +732,8 @@ int SimpleRADOSStriper::lock(uint64_t timeoutms)
 
   ceph_assert(!is_locked());
 
+  drop_readahead();
+
   /* We're going to be very lazy here in implementation: only exclusive locks
    * are allowed. That even ensures a single reader.
    */
@@ -750,6 +812,8 @@ int SimpleRADOSStriper::unlock()
 
   ceph_assert(is_locked());
 
+  drop_readahead();
+
   /* wait for flush of metadata */
   if (int rc = flush(); rc < 0) {
     return rc;
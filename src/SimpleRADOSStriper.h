@@ -79,6 +79,10 @@ public:
   void set_blocklist_the_dead(bool b) {
     blocklist_the_dead = b;
   }
+  void set_readahead(size_t max) {
+    readahead_max = max;
+    drop_readahead();
+  }
 
 protected:
   struct extent {
@@ -93,6 +97,13 @@ protected:
   int shrink_alloc(uint64_t a);
   int maybe_shrink_alloc();
   int wait_for_aios(bool block);
+  ssize_t read_extents(char* data, size_t len, uint64_t off);
+  void drop_readahead() {
+    readahead_bl.clear();
+    readahead_off = 0;
+    last_read_end = UINT64_MAX;
+    sequential_reads = 0;
+  }
   int recover_lock();
   extent get_next_extent(uint64_t off, size_t len) const;
   extent get_first_extent() const {
@@ -133,6 +144,11 @@ private:
   bool blocklist_the_dead = true;
   std::queue<aiocompletionptr> aios;
   int aios_failure = 0;
+  size_t readahead_max = 0;
+  uint64_t readahead_off = 0;
+  ceph::bufferlist readahead_bl;
+  uint64_t last_read_end = UINT64_MAX; /* no read yet */
+  unsigned sequential_reads = 0;
   std::string myaddrs;
 };
 
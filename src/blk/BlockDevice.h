@@ -181,6 +181,10 @@ protected:
   bool rotational = true;
   bool lock_exclusive = true;
 
+  /// writes whose payload had to be copied to meet the O_DIRECT alignment
+  std::atomic<uint64_t> realigned_writes = {0};
+  std::atomic<uint64_t> realigned_write_bytes = {0};
+
   // HM-SMR specific properties.  In HM-SMR drives the LBA space is divided into
   // fixed-size zones.  Typically, the first few zones are randomly writable;
   // they form a conventional region of the drive.  The remaining zones must be
@@ -206,6 +210,13 @@ public:
   virtual bool supported_bdev_label() { return true; }
   virtual bool is_rotational() { return rotational; }
 
+  uint64_t get_realigned_writes() const {
+    return realigned_writes.load(std::memory_order_relaxed);
+  }
+  uint64_t get_realigned_write_bytes() const {
+    return realigned_write_bytes.load(std::memory_order_relaxed);
+  }
+
   // HM-SMR-specific calls
   virtual bool is_smr() const { return false; }
   virtual uint64_t get_zone_size() const {
@@ -229,6 +240,13 @@ public:
 
   virtual void aio_submit(IOContext *ioc) = 0;
 
+  /// while plugged, aio_submit() from the calling thread only stages the
+  /// ios; the matching aio_submit_unplug() pushes them in one go
+  virtual void aio_submit_plug() {}
+  virtual void aio_submit_unplug() {}
+  /// reap already completed aios inline (non-blocking); returns # reaped
+  virtual int aio_reap() { return 0; }
+
   void set_no_exclusive_lock() {
     lock_exclusive = false;
   }
@@ -103,6 +103,17 @@ struct io_queue_t {
   virtual int submit_batch(aio_iter begin, aio_iter end, uint16_t aios_size,
 			   void *priv, int *retries) = 0;
   virtual int get_next_completed(int timeout_ms, aio_t **paio, int max) = 0;
+
+  // Stage a batch without ringing the doorbell; the staged ios are pushed
+  // to the kernel by a later submit_queued() (or by any submit_batch()).
+  // Engines without a shared submission queue just submit right away.
+  virtual int queue_batch(aio_iter begin, aio_iter end, uint16_t aios_size,
+			  void *priv, int *retries) {
+    return submit_batch(begin, end, aios_size, priv, retries);
+  }
+  virtual int submit_queued() {
+    return 0;
+  }
 };
 
 struct aio_queue_t final : public io_queue_t {
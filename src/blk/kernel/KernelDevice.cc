@@ -59,6 +59,10 @@ using ceph::make_timespan;
 using ceph::mono_clock;
 using ceph::operator <<;
 
+// aio_submit() plug of the calling thread, see aio_submit_plug()
+static thread_local KernelDevice *aio_plug_owner = nullptr;
+static thread_local unsigned aio_plug_depth = 0;
+
 KernelDevice::KernelDevice(CephContext* cct, aio_callback_t cb, void *cbpriv, aio_callback_t d_cb, void *d_cbpriv)
   : BlockDevice(cct, cb, cbpriv),
     aio(false), dio(false),
@@ -81,6 +85,7 @@ KernelDevice::KernelDevice(CephContext* cct, aio_callback_t cb, void *cbpriv, ai
     bool use_ioring_hipri = cct->_conf.get_val<bool>("bdev_ioring_hipri");
     bool use_ioring_sqthread_poll = cct->_conf.get_val<bool>("bdev_ioring_sqthread_poll");
     io_queue = std::make_unique<ioring_queue_t>(iodepth, use_ioring_hipri, use_ioring_sqthread_poll);
+    batch_submit = cct->_conf.get_val<bool>("bdev_ioring_batch_submit");
   } else {
     static bool once;
     if (use_ioring && !once) {
@@ -558,9 +563,13 @@ void KernelDevice::discard_drain()
 {
   dout(10) << __func__ << dendl;
   std::unique_lock l(discard_lock);
+  // let a throttled discard thread know it should stop pacing
+  ++discard_drain_waiters;
+  discard_cond.notify_all();
   while (!discard_queued.empty() || discard_running) {
     discard_cond.wait(l);
   }
+  --discard_drain_waiters;
 }
 
 static bool is_expected_ioerr(const int r)
@@ -577,92 +586,97 @@ static bool is_expected_ioerr(const int r)
 	  );
 }
 
-void KernelDevice::_aio_thread()
+int KernelDevice::_aio_reap(int timeout_ms)
 {
-  dout(10) << __func__ << " start" << dendl;
-  int inject_crash_count = 0;
-  while (!aio_stop) {
-    dout(40) << __func__ << " polling" << dendl;
-    int max = cct->_conf->bdev_aio_reap_max;
-    aio_t *aio[max];
-    int r = io_queue->get_next_completed(cct->_conf->bdev_aio_poll_ms,
-					 aio, max);
-    if (r < 0) {
-      derr << __func__ << " got " << cpp_strerror(r) << dendl;
-      ceph_abort_msg("got unexpected error from io_getevents");
-    }
-    if (r > 0) {
-      dout(30) << __func__ << " got " << r << " completed aios" << dendl;
-      for (int i = 0; i < r; ++i) {
-	IOContext *ioc = static_cast<IOContext*>(aio[i]->priv);
-	_aio_log_finish(ioc, aio[i]->offset, aio[i]->length);
-	if (aio[i]->queue_item.is_linked()) {
-	  std::lock_guard l(debug_queue_lock);
-	  debug_aio_unlink(*aio[i]);
-	}
+  int max = cct->_conf->bdev_aio_reap_max;
+  aio_t *aio[max];
+  int r = io_queue->get_next_completed(timeout_ms, aio, max);
+  if (r < 0) {
+    derr << __func__ << " got " << cpp_strerror(r) << dendl;
+    ceph_abort_msg("got unexpected error from io_getevents");
+  }
+  if (r > 0) {
+    dout(30) << __func__ << " got " << r << " completed aios" << dendl;
+    for (int i = 0; i < r; ++i) {
+      IOContext *ioc = static_cast<IOContext*>(aio[i]->priv);
+      _aio_log_finish(ioc, aio[i]->offset, aio[i]->length);
+      if (aio[i]->queue_item.is_linked()) {
+	std::lock_guard l(debug_queue_lock);
+	debug_aio_unlink(*aio[i]);
+      }
 
-	// set flag indicating new ios have completed.  we do this *before*
-	// any completion or notifications so that any user flush() that
-	// follows the observed io completion will include this io.  Note
-	// that an earlier, racing flush() could observe and clear this
-	// flag, but that also ensures that the IO will be stable before the
-	// later flush() occurs.
-	io_since_flush.store(true);
-
-	long r = aio[i]->get_return_value();
-        if (r < 0) {
-          derr << __func__ << " got r=" << r << " (" << cpp_strerror(r) << ")"
+      // set flag indicating new ios have completed.  we do this *before*
+      // any completion or notifications so that any user flush() that
+      // follows the observed io completion will include this io.  Note
+      // that an earlier, racing flush() could observe and clear this
+      // flag, but that also ensures that the IO will be stable before the
+      // later flush() occurs.
+      io_since_flush.store(true);
+
+      long r = aio[i]->get_return_value();
+      if (r < 0) {
+        derr << __func__ << " got r=" << r << " (" << cpp_strerror(r) << ")"
+	     << dendl;
+        if (ioc->allow_eio && is_expected_ioerr(r)) {
+          derr << __func__ << " translating the error to EIO for upper layer"
 	       << dendl;
-          if (ioc->allow_eio && is_expected_ioerr(r)) {
-            derr << __func__ << " translating the error to EIO for upper layer"
-		 << dendl;
-            ioc->set_return_value(-EIO);
-          } else {
-	    if (is_expected_ioerr(r)) {
-	      note_io_error_event(
-		devname.c_str(),
-		path.c_str(),
-		r,
+          ioc->set_return_value(-EIO);
+        } else {
+	  if (is_expected_ioerr(r)) {
+	    note_io_error_event(
+	      devname.c_str(),
+	      path.c_str(),
+	      r,
 #if defined(HAVE_POSIXAIO)
-                aio[i]->aio.aiocb.aio_lio_opcode,
+              aio[i]->aio.aiocb.aio_lio_opcode,
 #else
-                aio[i]->iocb.aio_lio_opcode,
+              aio[i]->iocb.aio_lio_opcode,
 #endif
-		aio[i]->offset,
-		aio[i]->length);
-	      ceph_abort_msg(
-		"Unexpected IO error. "
-		"This may suggest a hardware issue. "
-		"Please check your kernel log!");
-	    }
+	      aio[i]->offset,
+	      aio[i]->length);
 	    ceph_abort_msg(
 	      "Unexpected IO error. "
-	      "This may suggest HW issue. Please check your dmesg!");
-          }
-        } else if (aio[i]->length != (uint64_t)r) {
-          derr << "aio to 0x" << std::hex << aio[i]->offset
-	       << "~" << aio[i]->length << std::dec
-               << " but returned: " << r << dendl;
-          ceph_abort_msg("unexpected aio return value: does not match length");
+	      "This may suggest a hardware issue. "
+	      "Please check your kernel log!");
+	  }
+	  ceph_abort_msg(
+	    "Unexpected IO error. "
+	    "This may suggest HW issue. Please check your dmesg!");
         }
+      } else if (aio[i]->length != (uint64_t)r) {
+        derr << "aio to 0x" << std::hex << aio[i]->offset
+	     << "~" << aio[i]->length << std::dec
+             << " but returned: " << r << dendl;
+        ceph_abort_msg("unexpected aio return value: does not match length");
+      }
 
-        dout(10) << __func__ << " finished aio " << aio[i] << " r " << r
-                 << " ioc " << ioc
-                 << " with " << (ioc->num_running.load() - 1)
-                 << " aios left" << dendl;
-
-	// NOTE: once num_running and we either call the callback or
-	// call aio_wake we cannot touch ioc or aio[] as the caller
-	// may free it.
-	if (ioc->priv) {
-	  if (--ioc->num_running == 0) {
-	    aio_callback(aio_callback_priv, ioc->priv);
-	  }
-	} else {
-          ioc->try_aio_wake();
+      dout(10) << __func__ << " finished aio " << aio[i] << " r " << r
+               << " ioc " << ioc
+               << " with " << (ioc->num_running.load() - 1)
+               << " aios left" << dendl;
+
+      // NOTE: once num_running and we either call the callback or
+      // call aio_wake we cannot touch ioc or aio[] as the caller
+      // may free it.
+      if (ioc->priv) {
+	if (--ioc->num_running == 0) {
+	  aio_callback(aio_callback_priv, ioc->priv);
 	}
+      } else {
+        ioc->try_aio_wake();
       }
     }
+  }
+  return r;
+}
+
+void KernelDevice::_aio_thread()
+{
+  dout(10) << __func__ << " start" << dendl;
+  int inject_crash_count = 0;
+  while (!aio_stop) {
+    dout(40) << __func__ << " polling" << dendl;
+    _aio_reap(cct->_conf->bdev_aio_poll_ms);
     if (cct->_conf->bdev_debug_aio) {
       utime_t now = ceph_clock_now();
       std::lock_guard l(debug_queue_lock);
@@ -717,12 +731,47 @@ void KernelDevice::_discard_thread()
       discard_finishing.swap(discard_queued);
       discard_running = true;
       l.unlock();
-      dout(20) << __func__ << " finishing" << dendl;
-      for (auto p = discard_finishing.begin();p != discard_finishing.end(); ++p) {
-	_discard(p.get_start(), p.get_len());
+      dout(20) << __func__ << " finishing " << discard_finishing.num_intervals()
+	       << " extents, 0x" << std::hex << discard_finishing.size()
+	       << std::dec << " bytes" << dendl;
+      const uint64_t max_rate = cct->_conf.get_val<Option::size_t>(
+	"bdev_async_discard_max_bytes_per_sec");
+      if (!max_rate) {
+	for (auto p = discard_finishing.begin();p != discard_finishing.end(); ++p) {
+	  _discard(p.get_start(), p.get_len());
+	}
+	discard_callback(discard_callback_priv, static_cast<void*>(&discard_finishing));
+      } else {
+	// a throttled pass can take a while, so do not hold the whole batch
+	// until the end: discard until we are a pacing interval ahead of the
+	// rate, hand what was discarded so far back to the allocator in one
+	// go, then sleep off the lead.  anything released meanwhile keeps
+	// merging in discard_queued.  stop pacing once we are asked to shut
+	// down or someone is waiting in discard_drain().
+	static constexpr auto pacing_interval = std::chrono::milliseconds(100);
+	const auto start = mono_clock::now();
+	uint64_t issued = 0;
+	interval_set<uint64_t> done;
+	for (auto p = discard_finishing.begin();p != discard_finishing.end(); ++p) {
+	  _discard(p.get_start(), p.get_len());
+	  issued += p.get_len();
+	  done.insert(p.get_start(), p.get_len());
+	  auto due = start + make_timespan((double)issued / max_rate);
+	  if (due - mono_clock::now() < pacing_interval) {
+	    continue;
+	  }
+	  discard_callback(discard_callback_priv, static_cast<void*>(&done));
+	  done.clear();
+	  l.lock();
+	  discard_cond.wait_until(l, due, [this] {
+	    return discard_stop || discard_drain_waiters > 0;
+	  });
+	  l.unlock();
+	}
+	if (!done.empty()) {
+	  discard_callback(discard_callback_priv, static_cast<void*>(&done));
+	}
       }
-
-      discard_callback(discard_callback_priv, static_cast<void*>(&discard_finishing));
       discard_finishing.clear();
       l.lock();
       discard_running = false;
@@ -742,6 +791,18 @@ int KernelDevice::_queue_discard(interval_set<uint64_t> &to_release)
     return 0;
 
   std::lock_guard l(discard_lock);
+  // only a paced discard thread can fall behind for long
+  const uint64_t max_backlog =
+    cct->_conf.get_val<Option::size_t>("bdev_async_discard_max_bytes_per_sec") ?
+    cct->_conf.get_val<Option::size_t>("bdev_async_discard_max_backlog") : 0;
+  if (max_backlog && discard_queued.size() >= max_backlog) {
+    // the discard thread is not keeping up; let the caller release these
+    // extents without discarding them
+    dout(20) << __func__ << " backlog 0x" << std::hex << discard_queued.size()
+	     << " >= 0x" << max_backlog << std::dec
+	     << ", not discarding " << to_release << dendl;
+    return -EBUSY;
+  }
   discard_queued.insert(to_release);
   discard_cond.notify_all();
   return 0;
@@ -868,8 +929,13 @@ void KernelDevice::aio_submit(IOContext *ioc)
   int r, retries = 0;
   // num of pending aios should not overflow when passed to submit_batch()
   assert(pending <= std::numeric_limits<uint16_t>::max());
-  r = io_queue->submit_batch(ioc->running_aios.begin(), e,
-			     pending, priv, &retries);
+  if (aio_plug_owner == this) {
+    r = io_queue->queue_batch(ioc->running_aios.begin(), e,
+			      pending, priv, &retries);
+  } else {
+    r = io_queue->submit_batch(ioc->running_aios.begin(), e,
+			       pending, priv, &retries);
+  }
 
   if (retries)
     derr << __func__ << " retries " << retries << dendl;
@@ -879,6 +945,43 @@ void KernelDevice::aio_submit(IOContext *ioc)
   }
 }
 
+void KernelDevice::aio_submit_plug()
+{
+  if (!batch_submit) {
+    return;
+  }
+  ceph_assert(aio_plug_owner == nullptr || aio_plug_owner == this);
+  aio_plug_owner = this;
+  ++aio_plug_depth;
+}
+
+void KernelDevice::aio_submit_unplug()
+{
+  if (!batch_submit) {
+    return;
+  }
+  ceph_assert(aio_plug_owner == this);
+  ceph_assert(aio_plug_depth > 0);
+  if (--aio_plug_depth > 0) {
+    return;
+  }
+  aio_plug_owner = nullptr;
+  int r = io_queue->submit_queued();
+  dout(20) << __func__ << " submitted " << r << " staged aios" << dendl;
+  if (r < 0) {
+    derr << " aio submit got " << cpp_strerror(r) << dendl;
+    ceph_assert(r == 0);
+  }
+}
+
+int KernelDevice::aio_reap()
+{
+  if (!aio || aio_stop) {
+    return 0;
+  }
+  return _aio_reap(0);
+}
+
 int KernelDevice::_sync_write(uint64_t off, bufferlist &bl, bool buffered, int write_hint)
 {
   uint64_t len = bl.length();
@@ -962,6 +1065,8 @@ int KernelDevice::write(
   if ((!buffered || bl.get_num_buffers() >= IOV_MAX) &&
       bl.rebuild_aligned_size_and_memory(block_size, block_size, IOV_MAX)) {
     dout(20) << __func__ << " rebuilding buffer to be aligned" << dendl;
+    ++realigned_writes;
+    realigned_write_bytes += len;
   }
   dout(40) << "data:\n";
   bl.hexdump(*_dout);
@@ -991,6 +1096,8 @@ int KernelDevice::aio_write(
   if ((!buffered || bl.get_num_buffers() >= IOV_MAX) &&
       bl.rebuild_aligned_size_and_memory(block_size, block_size, IOV_MAX)) {
     dout(20) << __func__ << " rebuilding buffer to be aligned" << dendl;
+    ++realigned_writes;
+    realigned_write_bytes += len;
   }
   dout(40) << "data:\n";
   bl.hexdump(*_dout);
@@ -47,6 +47,7 @@ private:
   ceph::mutex flush_mutex = ceph::make_mutex("KernelDevice::flush_mutex");
 
   std::unique_ptr<io_queue_t> io_queue;
+  bool batch_submit = false;  ///< honor aio_submit_plug()
   aio_callback_t discard_callback;
   void *discard_callback_priv;
   bool aio_stop;
@@ -56,6 +57,7 @@ private:
   ceph::mutex discard_lock = ceph::make_mutex("KernelDevice::discard_lock");
   ceph::condition_variable discard_cond;
   bool discard_running = false;
+  unsigned discard_drain_waiters = 0;
   interval_set<uint64_t> discard_queued;
   interval_set<uint64_t> discard_finishing;
 
@@ -83,6 +85,7 @@ private:
   virtual void  _pre_close() { }  // hook for child implementations
 
   void _aio_thread();
+  int _aio_reap(int timeout_ms);
   void _discard_thread();
   int _queue_discard(interval_set<uint64_t> &to_release);
   bool try_discard(interval_set<uint64_t> &to_release, bool async = true) override;
@@ -118,6 +121,9 @@ public:
   KernelDevice(CephContext* cct, aio_callback_t cb, void *cbpriv, aio_callback_t d_cb, void *d_cbpriv);
 
   void aio_submit(IOContext *ioc) override;
+  void aio_submit_plug() override;
+  void aio_submit_unplug() override;
+  int aio_reap() override;
   void discard_drain() override;
 
   int collect_metadata(const std::string& prefix, std::map<std::string,std::string> *pm) const override;
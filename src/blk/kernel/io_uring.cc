@@ -7,6 +7,7 @@
 
 #include "liburing.h"
 #include <sys/epoll.h>
+#include <unistd.h>
 
 using std::list;
 using std::make_unique;
@@ -17,6 +18,7 @@ struct ioring_data {
   pthread_mutex_t sq_mutex;
   int epoll_fd = -1;
   std::map<int, int> fixed_fds_map;
+  unsigned staged = 0;  ///< sqes prepared but not yet submitted; sq_mutex
 };
 
 static int ioring_get_cqe(struct ioring_data *d, unsigned int max,
@@ -70,31 +72,64 @@ static void init_sqe(struct ioring_data *d, struct io_uring_sqe *sqe,
   io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
 }
 
+static int ioring_submit(struct ioring_data *d, int *retries)
+{
+  struct io_uring *ring = &d->io_uring;
+  // same back-off as aio_queue_t::submit_batch()
+  int attempts = 16;
+  int delay = 125;
+
+  while (true) {
+    int r = io_uring_submit(ring);
+    if (r >= 0) {
+      d->staged = 0;
+      return r;
+    }
+    if ((r == -EAGAIN || r == -EBUSY) && attempts-- > 0) {
+      usleep(delay);
+      delay *= 2;
+      if (retries)
+	(*retries)++;
+      continue;
+    }
+    return r;
+  }
+}
+
 static int ioring_queue(struct ioring_data *d, void *priv,
-			list<aio_t>::iterator beg, list<aio_t>::iterator end)
+			list<aio_t>::iterator beg, list<aio_t>::iterator end,
+			bool submit, int *retries)
 {
   struct io_uring *ring = &d->io_uring;
-  struct aio_t *io = nullptr;
+  int queued = 0;
 
   ceph_assert(beg != end);
 
   do {
     struct io_uring_sqe *sqe = io_uring_get_sqe(ring);
-    if (!sqe)
-      break;
-
-    io = &*beg;
+    if (!sqe) {
+      /* SQ ring is full, hand what we have to the kernel and retry */
+      int r = ioring_submit(d, retries);
+      if (r < 0)
+	return r;
+      continue;
+    }
+
+    struct aio_t *io = &*beg;
     io->priv = priv;
 
     init_sqe(d, sqe, io);
-
-  } while (++beg != end);
-
-  if (!io)
-    /* Queue is full, go and reap something first */
-    return 0;
-
-  return io_uring_submit(ring);
+    ++d->staged;
+    ++queued;
+    ++beg;
+  } while (beg != end);
+
+  if (submit) {
+    int r = ioring_submit(d, retries);
+    if (r < 0)
+      return r;
+  }
+  return queued;
 }
 
 static void build_fixed_fds_map(struct ioring_data *d,
@@ -180,10 +215,34 @@ int ioring_queue_t::submit_batch(aio_iter beg, aio_iter end,
                                  int *retries)
 {
   (void)aios_size;
-  (void)retries;
 
   pthread_mutex_lock(&d->sq_mutex);
-  int rc = ioring_queue(d.get(), priv, beg, end);
+  int rc = ioring_queue(d.get(), priv, beg, end, true, retries);
+  pthread_mutex_unlock(&d->sq_mutex);
+
+  return rc;
+}
+
+int ioring_queue_t::queue_batch(aio_iter beg, aio_iter end,
+                                uint16_t aios_size, void *priv,
+                                int *retries)
+{
+  (void)aios_size;
+
+  pthread_mutex_lock(&d->sq_mutex);
+  int rc = ioring_queue(d.get(), priv, beg, end, false, retries);
+  pthread_mutex_unlock(&d->sq_mutex);
+
+  return rc;
+}
+
+int ioring_queue_t::submit_queued()
+{
+  int rc = 0;
+
+  pthread_mutex_lock(&d->sq_mutex);
+  if (d->staged)
+    rc = ioring_submit(d.get(), nullptr);
   pthread_mutex_unlock(&d->sq_mutex);
 
   return rc;
@@ -251,6 +310,18 @@ int ioring_queue_t::submit_batch(aio_iter beg, aio_iter end,
   ceph_assert(0);
 }
 
+int ioring_queue_t::queue_batch(aio_iter beg, aio_iter end,
+                                uint16_t aios_size, void *priv,
+                                int *retries)
+{
+  ceph_assert(0);
+}
+
+int ioring_queue_t::submit_queued()
+{
+  ceph_assert(0);
+}
+
 int ioring_queue_t::get_next_completed(int timeout_ms, aio_t **paio, int max)
 {
   ceph_assert(0);
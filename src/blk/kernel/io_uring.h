@@ -30,4 +30,8 @@ struct ioring_queue_t final : public io_queue_t {
   int submit_batch(aio_iter begin, aio_iter end, uint16_t aios_size,
                    void *priv, int *retries) final;
   int get_next_completed(int timeout_ms, aio_t **paio, int max) final;
+
+  int queue_batch(aio_iter begin, aio_iter end, uint16_t aios_size,
+                  void *priv, int *retries) final;
+  int submit_queued() final;
 };
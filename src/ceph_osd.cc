@@ -549,14 +549,21 @@ flushjournal_out:
 					   entity_name_t::OSD(whoami), "client", nonce);
   Messenger *ms_cluster = Messenger::create(g_ceph_context, cluster_msg_type,
 					    entity_name_t::OSD(whoami), "cluster", nonce);
+  // optionally keep heartbeats off the workers busy with the data path
+  const std::string hb_stack =
+    g_conf()->ms_async_heartbeat_op_threads ? "hb" : "";
   Messenger *ms_hb_back_client = Messenger::create(g_ceph_context, cluster_msg_type,
-					     entity_name_t::OSD(whoami), "hb_back_client", nonce);
+					     entity_name_t::OSD(whoami), "hb_back_client", nonce,
+					     hb_stack);
   Messenger *ms_hb_front_client = Messenger::create(g_ceph_context, public_msg_type,
-					     entity_name_t::OSD(whoami), "hb_front_client", nonce);
+					     entity_name_t::OSD(whoami), "hb_front_client", nonce,
+					     hb_stack);
   Messenger *ms_hb_back_server = Messenger::create(g_ceph_context, cluster_msg_type,
-						   entity_name_t::OSD(whoami), "hb_back_server", nonce);
+						   entity_name_t::OSD(whoami), "hb_back_server", nonce,
+						   hb_stack);
   Messenger *ms_hb_front_server = Messenger::create(g_ceph_context, public_msg_type,
-						    entity_name_t::OSD(whoami), "hb_front_server", nonce);
+						    entity_name_t::OSD(whoami), "hb_front_server", nonce,
+						    hb_stack);
   Messenger *ms_objecter = Messenger::create(g_ceph_context, public_msg_type,
 					     entity_name_t::OSD(whoami), "ms_objecter", nonce);
   if (!ms_public || !ms_cluster || !ms_hb_front_client || !ms_hb_back_client || !ms_hb_back_server || !ms_hb_front_server || !ms_objecter)
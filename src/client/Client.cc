@@ -369,6 +369,7 @@ Client::Client(Messenger *m, MonClient *mc, Objecter *objecter_)
     remount_finisher(m->cct),
     async_ino_releasor(m->cct),
     objecter_finisher(m->cct),
+    ll_io_cb_finisher(m->cct, "ll_io_cb_finisher", "client_llio_cb"),
     m_command_hook(this),
     fscid(0)
 {
@@ -723,6 +724,17 @@ void Client::shutdown()
     async_ino_releasor.stop();
   }
 
+  for (auto& fin : ll_io_finishers) {
+    fin->wait_for_empty();
+    fin->stop();
+  }
+  ll_io_finishers.clear();
+  if (ll_io_cb_started) {
+    ll_io_cb_finisher.wait_for_empty();
+    ll_io_cb_finisher.stop();
+    ll_io_cb_started = false;
+  }
+
   objectcacher->stop();  // outside of client_lock! this does a join.
 
   /*
@@ -2409,6 +2421,13 @@ void Client::handle_client_session(const MConstRef<MClientSession>& m)
      */
     renew_and_flush_cap_releases();
     trim_caps(session.get(), m->get_max_caps());
+    // with batching enabled, answer the recall now instead of at the
+    // next tick
+    if (cct->_conf.get_val<uint64_t>("client_caps_release_batch") > 0) {
+      if (uint64_t nr_caps = _flush_cap_release(session.get()); nr_caps > 0) {
+        dec_pinned_icaps(nr_caps);
+      }
+    }
     break;
 
   case CEPH_SESSION_FLUSHMSG:
@@ -4482,6 +4501,7 @@ void Client::remove_cap(Cap *cap, bool queue_release)
       cap->issue_seq,
       cap->mseq,
       cap_epoch_barrier);
+    _maybe_flush_cap_release(session);
   } else {
     dec_pinned_icaps();
   }
@@ -6578,6 +6598,15 @@ void Client::_unmount(bool abort)
     return mds_requests.empty();
   });
 
+  // nonblocking I/O still holds Fh references
+  mount_cond.wait(lock, [this] {
+    if (ll_io_inflight) {
+      ldout(cct, 10) << "waiting on " << ll_io_inflight
+		     << " nonblocking I/Os" << dendl;
+    }
+    return ll_io_inflight == 0;
+  });
+
   cwd.reset();
   root.reset();
 
@@ -6710,23 +6739,51 @@ void Client::abort_conn()
   _unmount(true);
 }
 
+/**
+ * Send the queued cap release message of one session, if any.
+ *
+ * @return the number of caps released, for dec_pinned_icaps()
+ */
+uint64_t Client::_flush_cap_release(MetaSession *s)
+{
+  if (!s->release || !mdsmap->is_clientreplay_or_active_or_stopping(
+        s->mds_num)) {
+    return 0;
+  }
+  uint64_t nr_caps = s->release->caps.size();
+  if (cct->_conf->client_inject_release_failure) {
+    ldout(cct, 20) << __func__ << " injecting failure to send cap release message" << dendl;
+  } else {
+    s->con->send_message2(std::move(s->release));
+  }
+  s->release.reset();
+  return nr_caps;
+}
+
+/**
+ * Send a session's cap releases early once client_caps_release_batch
+ * of them are queued, rather than holding them until the next tick.
+ * During a recall storm this bounds both the size of each release
+ * message and how long the MDS waits for the caps it asked for.
+ */
+void Client::_maybe_flush_cap_release(MetaSession *s)
+{
+  const auto batch = cct->_conf.get_val<uint64_t>("client_caps_release_batch");
+  if (batch == 0 || !s->release || s->release->caps.size() < batch) {
+    return;
+  }
+  if (uint64_t nr_caps = _flush_cap_release(s); nr_caps > 0) {
+    dec_pinned_icaps(nr_caps);
+  }
+}
+
 void Client::flush_cap_releases()
 {
   uint64_t nr_caps = 0;
 
   // send any cap releases
   for (auto &p : mds_sessions) {
-    auto session = p.second;
-    if (session->release && mdsmap->is_clientreplay_or_active_or_stopping(
-          p.first)) {
-      nr_caps += session->release->caps.size();
-      if (cct->_conf->client_inject_release_failure) {
-        ldout(cct, 20) << __func__ << " injecting failure to send cap release message" << dendl;
-      } else {
-        session->con->send_message2(std::move(session->release));
-      }
-      session->release.reset();
-    }
+    nr_caps += _flush_cap_release(p.second.get());
   }
 
   if (nr_caps > 0) {
@@ -9039,6 +9096,11 @@ int Client::_readdir_get_frag(dir_result_t *dirp)
   req->set_inode(diri.get());
   req->head.args.readdir.frag = fg;
   req->head.args.readdir.flags = CEPH_READDIR_REPLY_BITFLAGS;
+  // 0 leaves the chunk size to the MDS
+  req->head.args.readdir.max_entries =
+    cct->_conf.get_val<uint64_t>("client_readdir_max_entries");
+  req->head.args.readdir.max_bytes =
+    cct->_conf.get_val<Option::size_t>("client_readdir_max_bytes");
   if (dirp->last_name.length()) {
     req->path2.set_path(dirp->last_name);
   } else if (dirp->hash_order()) {
@@ -10420,6 +10482,12 @@ int Client::_read_async(Fh *f, uint64_t off, uint64_t len, bufferlist *bl)
   C_SaferCond onfinish("Client::_read_async flock");
   r = objectcacher->file_read(&in->oset, &in->layout, in->snapid,
 			      off, len, bl, 0, &onfinish);
+
+  // Start the readahead before waiting for the read itself, so that the
+  // objects beyond it are fetched in parallel with it rather than after
+  // it.  The read above was queued first and is not delayed by this.
+  _readahead(f, off, len);
+
   if (r == 0) {
     get_cap_ref(in, CEPH_CAP_FILE_CACHE);
     client_lock.unlock();
@@ -10429,26 +10497,31 @@ int Client::_read_async(Fh *f, uint64_t off, uint64_t len, bufferlist *bl)
     update_read_io_size(bl->length());
   }
 
-  if(f->readahead.get_min_readahead_size() > 0) {
-    pair<uint64_t, uint64_t> readahead_extent = f->readahead.update(off, len, in->size);
-    if (readahead_extent.second > 0) {
-      ldout(cct, 20) << "readahead " << readahead_extent.first << "~" << readahead_extent.second
-		     << " (caller wants " << off << "~" << len << ")" << dendl;
-      Context *onfinish2 = new C_Readahead(this, f);
-      int r2 = objectcacher->file_read(&in->oset, &in->layout, in->snapid,
-				       readahead_extent.first, readahead_extent.second,
-				       NULL, 0, onfinish2);
-      if (r2 == 0) {
-	ldout(cct, 20) << "readahead initiated, c " << onfinish2 << dendl;
-	get_cap_ref(in, CEPH_CAP_FILE_RD | CEPH_CAP_FILE_CACHE);
-      } else {
-	ldout(cct, 20) << "readahead was no-op, already cached" << dendl;
-	delete onfinish2;
-      }
+  return r;
+}
+
+void Client::_readahead(Fh *f, uint64_t off, uint64_t len)
+{
+  Inode *in = f->inode.get();
+
+  if (f->readahead.get_min_readahead_size() == 0)
+    return;
+  pair<uint64_t, uint64_t> readahead_extent = f->readahead.update(off, len, in->size);
+  if (readahead_extent.second > 0) {
+    ldout(cct, 20) << "readahead " << readahead_extent.first << "~" << readahead_extent.second
+		   << " (caller wants " << off << "~" << len << ")" << dendl;
+    Context *onfinish2 = new C_Readahead(this, f);
+    int r2 = objectcacher->file_read(&in->oset, &in->layout, in->snapid,
+				     readahead_extent.first, readahead_extent.second,
+				     NULL, 0, onfinish2);
+    if (r2 == 0) {
+      ldout(cct, 20) << "readahead initiated, c " << onfinish2 << dendl;
+      get_cap_ref(in, CEPH_CAP_FILE_RD | CEPH_CAP_FILE_CACHE);
+    } else {
+      ldout(cct, 20) << "readahead was no-op, already cached" << dendl;
+      delete onfinish2;
     }
   }
-
-  return r;
 }
 
 int Client::_read_sync(Fh *f, uint64_t off, uint64_t len, bufferlist *bl,
@@ -14864,6 +14937,281 @@ int64_t Client::ll_readv(struct Fh *fh, const struct iovec *iov, int iovcnt, int
   return _preadv_pwritev_locked(fh, iov, iovcnt, off, false, false);
 }
 
+Client::C_LL_Read_Nonblocking::C_LL_Read_Nonblocking(
+  Client *c, Fh *f, struct ceph_ll_io_info *io_info, uint64_t len,
+  bool cached) :
+    client(c), f(f), io_info(io_info), len(len), cached(cached) {
+  f->get();
+}
+
+void Client::C_LL_Read_Nonblocking::finish(int r) {
+  // ObjectCacher completions already hold client_lock, Filer ones come
+  // from objecter_finisher without it
+  std::unique_lock cl(client->client_lock, std::defer_lock);
+  if (!cached)
+    cl.lock();
+  Inode *in = f->inode.get();
+  lgeneric_subdout(client->cct, client, 20) << "client." << client->get_nodeid()
+    << " C_LL_Read_Nonblocking on " << f->inode << " r " << r << dendl;
+
+  if (cache_ref)
+    client->put_cap_ref(in, CEPH_CAP_FILE_CACHE);
+
+  if (!cached) {
+    // as in _read_sync(): ENOENT from the OSD means nothing written there
+    if (r == -CEPHFS_ENOENT)
+      r = 0;
+    if (r >= 0 && bl.length() < len) {
+      // zero up to known EOF
+      uint64_t eof = std::min<uint64_t>(io_info->off + len, in->size);
+      if (io_info->off + bl.length() < eof)
+	bl.append_zero(eof - io_info->off - bl.length());
+    }
+    if (r >= 0 && bl.length() < len) {
+      // short read: the size we had may be stale.  let a worker recheck it
+      // with the blocking path and read the rest, like _read() does.
+      client->put_cap_ref(in, CEPH_CAP_FILE_RD);
+      Finisher *fin = client->_get_ll_io_finisher(f);
+      auto rest = [client=client, f=f, io_info=io_info, len=len,
+		   bl=std::move(bl)](int) mutable {
+	std::scoped_lock l(client->client_lock);
+	bufferlist more;
+	int64_t r = client->_read(f, io_info->off + bl.length(),
+				  len - bl.length(), &more);
+	if (r >= 0) {
+	  bl.claim_append(more);
+	  r = bl.length();
+	}
+	client->_put_fh(f);
+	client->_ll_io_complete(io_info, r, std::move(bl));
+      };
+      if (fin) {
+	fin->queue(new LambdaContext(std::move(rest)));
+      } else {
+	cl.unlock();
+	rest(0);
+      }
+      return;
+    }
+  }
+
+  client->put_cap_ref(in, CEPH_CAP_FILE_RD);
+  if (r >= 0) {
+    client->update_read_io_size(bl.length());
+    r = bl.length();
+  }
+  client->_put_fh(f);
+  client->_ll_io_complete(io_info, r, std::move(bl));
+}
+
+void Client::_ll_io_complete(struct ceph_ll_io_info *io_info, int64_t r,
+			     bufferlist bl)
+{
+  ceph_assert(ceph_mutex_is_locked_by_me(client_lock));
+  ceph_assert(ll_io_inflight > 0);
+  if (--ll_io_inflight == 0)
+    mount_cond.notify_all();
+
+  // copy out and call back without client_lock, so that the callback may
+  // submit more I/O
+  ll_io_cb_finisher.queue(new LambdaContext(
+    [io_info, r, bl=std::move(bl)](int) {
+      if (r > 0 && !io_info->write) {
+	auto iter = bl.cbegin();
+	uint64_t resid = r;
+	for (int j = 0; j < io_info->iovcnt && resid > 0; j++) {
+	  const auto round_size =
+	    std::min<uint64_t>(resid, io_info->iov[j].iov_len);
+	  iter.copy(round_size, reinterpret_cast<char*>(io_info->iov[j].iov_base));
+	  resid -= round_size;
+	}
+      }
+      io_info->result = r;
+      io_info->callback(io_info);
+    }));
+}
+
+Finisher *Client::_get_ll_io_finisher(Fh *fh)
+{
+  ceph_assert(ceph_mutex_is_locked_by_me(client_lock));
+  if (ll_io_finishers.empty()) {
+    auto io_threads = cct->_conf.get_val<uint64_t>("client_ll_async_io_threads");
+    for (uint64_t i = 0; i < io_threads; ++i) {
+      auto& fin = ll_io_finishers.emplace_back(std::make_unique<Finisher>(
+	cct, "ll_io_finisher-" + std::to_string(i), "client_llio"));
+      fin->start();
+    }
+    if (ll_io_finishers.empty())
+      return nullptr;
+  }
+  // Fh pointers are allocation aligned: mix the bits before picking one
+  uint64_t h = reinterpret_cast<uintptr_t>(fh) >> 4;
+  h = (h * 0x9e3779b97f4a7c15ull) >> 32;
+  return ll_io_finishers[h % ll_io_finishers.size()].get();
+}
+
+bool Client::_ll_read_nonblocking(Fh *fh, struct ceph_ll_io_info *io_info)
+{
+  ceph_assert(ceph_mutex_is_locked_by_me(client_lock));
+
+  const auto& conf = cct->_conf;
+  Inode *in = fh->inode.get();
+
+  if (io_info->off < 0 ||
+      (fh->mode & CEPH_FILE_MODE_RD) == 0 ||
+      (fh->flags & (O_DIRECT | O_RSYNC)) ||
+#if defined(__linux__) && defined(O_PATH)
+      (fh->flags & O_PATH) ||
+#endif
+      in->inline_version != CEPH_INLINE_NONE ||
+      !in->caps_issued_mask(CEPH_CAP_FILE_RD) ||
+      ll_io_ordered.count(fh))
+    return false;
+
+  int want, have = 0;
+  if (fh->mode & CEPH_FILE_MODE_LAZY)
+    want = CEPH_CAP_FILE_CACHE | CEPH_CAP_FILE_LAZYIO;
+  else
+    want = CEPH_CAP_FILE_CACHE;
+  int r = get_caps(fh, CEPH_CAP_FILE_RD, want, &have, -1);
+  ++ll_io_inflight;
+  if (r < 0) {
+    _ll_io_complete(io_info, r);
+    return true;
+  }
+
+  uint64_t off = io_info->off;
+  uint64_t len = 0;
+  for (int i = 0; i < io_info->iovcnt; i++)
+    len += io_info->iov[i].iov_len;
+  if (off >= in->size || len == 0) {
+    put_cap_ref(in, CEPH_CAP_FILE_RD);
+    _ll_io_complete(io_info, 0);
+    return true;
+  }
+  if (off + len > in->size)
+    len = in->size - off;
+
+  bool cached = !conf->client_debug_force_sync_read &&
+    conf->client_oc &&
+    (have & (CEPH_CAP_FILE_CACHE | CEPH_CAP_FILE_LAZYIO));
+  auto onfinish = new C_LL_Read_Nonblocking(this, fh, io_info, len, cached);
+  ldout(cct, 10) << __func__ << " " << *in << " " << off << "~" << len
+		 << (cached ? " cached" : " uncached") << dendl;
+  if (cached) {
+    r = objectcacher->file_read(&in->oset, &in->layout, in->snapid,
+				off, len, &onfinish->bl, 0, onfinish);
+    _readahead(fh, off, len);
+    if (r == 0) {
+      // completes from the ObjectCacher once the data is in
+      get_cap_ref(in, CEPH_CAP_FILE_CACHE);
+      onfinish->cache_ref = true;
+    } else {
+      onfinish->complete(r);
+    }
+  } else {
+    filer->read_trunc(in->ino, &in->layout, in->snapid,
+		      off, len, &onfinish->bl, 0,
+		      in->truncate_size, in->truncate_seq,
+		      onfinish);
+  }
+  return true;
+}
+
+bool Client::_ll_write_nonblocking(Fh *fh, struct ceph_ll_io_info *io_info)
+{
+  ceph_assert(ceph_mutex_is_locked_by_me(client_lock));
+
+  Inode *in = fh->inode.get();
+  uint64_t len = 0;
+  for (int i = 0; i < io_info->iovcnt; i++)
+    len += io_info->iov[i].iov_len;
+
+  // only a buffered write that already has its caps and max_size, and
+  // fits under the cache's dirty limit, is just a copy into the cache;
+  // everything else may wait on the MDS or OSDs
+  if (io_info->off < 0 || io_info->fsync ||
+      !cct->_conf->client_oc ||
+      (fh->flags & (O_DIRECT | O_SYNC | O_DSYNC | O_APPEND)) ||
+      in->inline_version != CEPH_INLINE_NONE ||
+      (in->mode & (S_ISUID | S_ISGID)) ||
+      !in->caps_issued_mask(CEPH_CAP_FILE_WR | CEPH_CAP_FILE_BUFFER |
+			    CEPH_CAP_AUTH_SHARED) ||
+      io_info->off + len > in->max_size ||
+      ll_io_ordered.count(fh) ||
+      objectcacher->write_would_block(len))
+    return false;
+
+  ++ll_io_inflight;
+  int64_t r = _preadv_pwritev_locked(fh, io_info->iov, io_info->iovcnt,
+				     io_info->off, true, false);
+  _ll_io_complete(io_info, r);
+  return true;
+}
+
+int64_t Client::ll_nonblocking_readv_writev(struct ceph_ll_io_info *io_info)
+{
+  RWRef_t mref_reader(mount_state, CLIENT_MOUNTING);
+  if (!mref_reader.is_state_satisfied())
+    return -CEPHFS_ENOTCONN;
+
+  if (!io_info || !io_info->callback || !io_info->fh || io_info->iovcnt < 0)
+    return -CEPHFS_EINVAL;
+
+  ldout(cct, 10) << __func__ << " " << (io_info->write ? "write" : "read")
+		 << " " << io_info->fh << " " << io_info->off
+		 << " iovcnt " << io_info->iovcnt << dendl;
+
+  std::unique_lock cl(client_lock);
+  if (!ll_io_cb_started) {
+    ll_io_cb_finisher.start();
+    ll_io_cb_started = true;
+  }
+
+  Fh *fh = io_info->fh;
+  if (io_info->write ? _ll_write_nonblocking(fh, io_info) :
+		       _ll_read_nonblocking(fh, io_info))
+    return 0;
+
+  // blocking path: run it on the Fh's worker, or right here if there are
+  // none configured
+  Finisher *fin = _get_ll_io_finisher(fh);
+  ++ll_io_ordered[fh];
+  ++ll_io_inflight;
+  fh->get();
+  auto work = [this, io_info, fh](int) {
+    int64_t r;
+    if (io_info->write) {
+      r = ll_writev(fh, io_info->iov, io_info->iovcnt, io_info->off);
+      if (r >= 0 && io_info->fsync) {
+	int sr = ll_fsync(fh, io_info->syncdataonly);
+	if (sr < 0)
+	  r = sr;
+      }
+    } else {
+      r = ll_readv(fh, io_info->iov, io_info->iovcnt, io_info->off);
+    }
+    {
+      std::scoped_lock l(client_lock);
+      auto p = ll_io_ordered.find(fh);
+      if (--p->second == 0)
+	ll_io_ordered.erase(p);
+      _put_fh(fh);
+      if (--ll_io_inflight == 0)
+	mount_cond.notify_all();
+    }
+    io_info->result = r;
+    io_info->callback(io_info);
+  };
+  if (fin) {
+    fin->queue(new LambdaContext(std::move(work)));
+  } else {
+    cl.unlock();
+    work(0);
+  }
+  return 0;
+}
+
 int Client::ll_flush(Fh *fh)
 {
   RWRef_t mref_reader(mount_state, CLIENT_MOUNTING);
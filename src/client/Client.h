@@ -638,6 +638,7 @@ public:
   int ll_read(Fh *fh, loff_t off, loff_t len, bufferlist *bl);
   int ll_write(Fh *fh, loff_t off, loff_t len, const char *data);
   int64_t ll_readv(struct Fh *fh, const struct iovec *iov, int iovcnt, int64_t off);
+  int64_t ll_nonblocking_readv_writev(struct ceph_ll_io_info *io_info);
   int64_t ll_writev(struct Fh *fh, const struct iovec *iov, int iovcnt, int64_t off);
   loff_t ll_lseek(Fh *fh, loff_t offset, int whence);
   int ll_flush(Fh *fh);
@@ -816,6 +817,8 @@ public:
   void renew_caps();
   void renew_caps(MetaSession *session);
   void flush_cap_releases();
+  uint64_t _flush_cap_release(MetaSession *s);
+  void _maybe_flush_cap_release(MetaSession *s);
   void renew_and_flush_cap_releases();
   void tick();
   void start_tick_thread();
@@ -1246,6 +1249,20 @@ private:
     Fh *f;
   };
 
+  struct C_LL_Read_Nonblocking : public Context {
+    C_LL_Read_Nonblocking(Client *c, Fh *f, struct ceph_ll_io_info *io_info,
+			  uint64_t len, bool cached);
+    void finish(int r) override;
+
+    Client *client;
+    Fh *f;
+    struct ceph_ll_io_info *io_info;
+    uint64_t len;
+    bool cached;	// completes from the ObjectCacher, under client_lock
+    bool cache_ref = false;
+    ceph::buffer::list bl;
+  };
+
   /*
    * These define virtual xattrs exposing the recursive directory
    * statistics and layout metadata.
@@ -1311,6 +1328,12 @@ private:
 
   int _read_sync(Fh *f, uint64_t off, uint64_t len, bufferlist *bl, bool *checkeof);
   int _read_async(Fh *f, uint64_t off, uint64_t len, bufferlist *bl);
+  void _readahead(Fh *f, uint64_t off, uint64_t len);
+  bool _ll_read_nonblocking(Fh *fh, struct ceph_ll_io_info *io_info);
+  bool _ll_write_nonblocking(Fh *fh, struct ceph_ll_io_info *io_info);
+  void _ll_io_complete(struct ceph_ll_io_info *io_info, int64_t r,
+		       ceph::buffer::list bl = {});
+  Finisher *_get_ll_io_finisher(Fh *fh);
 
   bool _dentry_valid(const Dentry *dn);
 
@@ -1500,6 +1523,18 @@ private:
   Finisher remount_finisher;
   Finisher async_ino_releasor;
   Finisher objecter_finisher;
+  // ll_nonblocking_readv_writev(): cached and uncached reads complete from
+  // the ObjectCacher/Filer callbacks and buffered writes are copied in
+  // place; ll_io_cb_finisher then runs the caller's callback outside
+  // client_lock.  whatever needs to block (O_DIRECT/O_SYNC, sync writes,
+  // fsync, inline data, waiting on caps) goes to the lazily started
+  // ll_io_finishers workers, picked per Fh.  while an Fh has requests on
+  // its worker, later requests for it follow them there to stay ordered.
+  Finisher ll_io_cb_finisher;
+  bool ll_io_cb_started = false;
+  std::vector<std::unique_ptr<Finisher>> ll_io_finishers;
+  std::map<Fh*, unsigned> ll_io_ordered;
+  uint64_t ll_io_inflight = 0;
 
   ceph::coarse_mono_time last_cap_renew;
 
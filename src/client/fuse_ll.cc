@@ -1424,6 +1424,9 @@ int CephFuse::Handle::init(int argc, const char *argv[])
   if(!newargv)
     return ENOMEM;
 
+  // newargv points into this until fuse has parsed and copied the args
+  char strsplice[65];
+
   newargv[newargc++] = argv[0];
   newargv[newargc++] = "-f";  // stay in foreground
 
@@ -1464,7 +1467,6 @@ int CephFuse::Handle::init(int argc, const char *argv[])
   }
 #endif
   if (fuse_max_write > 0) {
-    char strsplice[65];
     newargv[newargc++] = "-o";
     sprintf(strsplice, "max_write=%zu", (size_t)fuse_max_write);
     newargv[newargc++] = strsplice;
@@ -505,6 +505,10 @@ int push_part(cls_method_context_t hctx, ceph::buffer::list* in,
 
   int entries_pushed = 0;
   ceph::buffer::list all_data;
+  // the per-entry framing is small; copy it into one preallocated buffer
+  // rather than allocating a bufferptr for every entry's pre-header
+  const auto framing_len = sizeof(pre_header) + entry_header_bl.length();
+  all_data.reserve(framing_len * op.data_bufs.size());
   for (auto& data : op.data_bufs) {
     if (full_part(part_header))
       break;
@@ -513,10 +517,10 @@ int push_part(cls_method_context_t hctx, ceph::buffer::list* in,
     pre_header.data_size = data.length();
     pre_header.index = max_index;
 
-    bufferptr pre(reinterpret_cast<char*>(&pre_header), sizeof(pre_header));
-    auto entry_write_len = pre.length() + entry_header_bl.length() + data.length();
-    all_data.append(pre);
-    all_data.append(entry_header_bl);
+    auto entry_write_len = framing_len + data.length();
+    all_data.append(reinterpret_cast<const char*>(&pre_header),
+		    sizeof(pre_header));
+    all_data.append(entry_header_bl.c_str(), entry_header_bl.length());
     all_data.claim_append(data);
 
     part_header.last_ofs = ofs;
@@ -3,8 +3,10 @@
  */
 #include <errno.h>
 #include <setjmp.h>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <unordered_map>
 #include <lua.hpp>
 #include "include/types.h"
 #include "objclass/objclass.h"
@@ -827,6 +829,50 @@ static int unpack_json_command(lua_State *L, struct clslua_hctx *ctx,
   return 0;
 }
 
+/*
+ * Compiled chunks, keyed by script source. Every call runs in a fresh
+ * lua_State, but loading a dumped chunk skips parsing and code generation
+ * for scripts that are sent over and over.
+ */
+static const size_t clslua_chunk_cache_max = 128;
+static std::mutex clslua_chunk_cache_lock;
+static std::unordered_map<string, string> clslua_chunk_cache;
+
+static int clslua_chunk_writer(lua_State *L, const void *p, size_t sz, void *ud)
+{
+  static_cast<string*>(ud)->append(static_cast<const char*>(p), sz);
+  return 0;
+}
+
+/*
+ * Same as luaL_loadstring(L, script.c_str()), served from the chunk cache
+ * when possible.
+ */
+static int clslua_load_script(lua_State *L, const string& script)
+{
+  string chunk;
+  {
+    std::lock_guard l(clslua_chunk_cache_lock);
+    auto it = clslua_chunk_cache.find(script);
+    if (it != clslua_chunk_cache.end())
+      chunk = it->second;
+  }
+  if (!chunk.empty())
+    return luaL_loadbuffer(L, chunk.data(), chunk.size(), script.c_str());
+
+  int ret = luaL_loadstring(L, script.c_str());
+  if (ret)
+    return ret;
+
+  if (lua_dump(L, clslua_chunk_writer, &chunk, 0) == 0 && !chunk.empty()) {
+    std::lock_guard l(clslua_chunk_cache_lock);
+    if (clslua_chunk_cache.size() >= clslua_chunk_cache_max)
+      clslua_chunk_cache.clear();
+    clslua_chunk_cache.emplace(script, std::move(chunk));
+  }
+  return 0;
+}
+
 /*
  * Runs the script, and calls handler.
  */
@@ -900,7 +946,7 @@ static int clslua_eval(lua_State *L)
   lua_settable(L, LUA_REGISTRYINDEX);
 
   /* load and compile chunk */
-  if (luaL_loadstring(L, ctx->script.c_str()))
+  if (clslua_load_script(L, ctx->script))
     return lua_error(L);
 
   /* execute chunk */
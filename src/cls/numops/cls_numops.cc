@@ -25,10 +25,14 @@
 #include <errno.h>
 #include <string>
 #include <sstream>
+#include <algorithm>
 #include <cstdio>
+#include <limits>
 #include <include/compat.h>
 
 #define DECIMAL_PRECISION 10
+#define SUM_MAX_PER_PASS 1000
+#define SUM_MAX_PER_CALL 10000
 
 using ceph::bufferlist;
 using std::string;
@@ -148,6 +152,89 @@ static int mul(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
   return cls_cxx_map_set_val(hctx, key, &new_value);
 }
 
+/**
+ * Sum the numeric omap values whose key starts with the given prefix and
+ * return the total and the number of values summed. The reduction runs
+ * inside the OSD, so a client only receives the result instead of every
+ * matching key/value pair. A single call looks at no more than
+ * SUM_MAX_PER_CALL values, starting after the given key, and returns the
+ * last key it summed and whether there are more, so that big omaps are
+ * summed over several calls instead of in one long op.
+ */
+static int sum(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  string prefix;
+  string start_after;
+  uint64_t max_entries;
+
+  auto iter = in->cbegin();
+  try {
+    decode(prefix, iter);
+    decode(start_after, iter);
+    decode(max_entries, iter);
+  } catch (const ceph::buffer::error &err) {
+    CLS_LOG(20, "sum: invalid decode of input");
+    return -EINVAL;
+  }
+
+  if (max_entries == 0 || max_entries > SUM_MAX_PER_CALL) {
+    max_entries = SUM_MAX_PER_CALL;
+  }
+
+  double total = 0;
+  uint64_t count = 0;
+  uint64_t seen = 0;
+  bool more = true;
+
+  while (more && seen < max_entries) {
+    std::map<string, bufferlist> vals;
+    int ret = cls_cxx_map_get_vals(hctx, start_after, prefix,
+                                   std::min<uint64_t>(SUM_MAX_PER_PASS,
+                                                      max_entries - seen),
+                                   &vals, &more);
+    if (ret < 0) {
+      if (ret != -ENOENT) {
+        CLS_ERR("sum: error reading omap: %d", ret);
+      }
+      return ret;
+    }
+    if (vals.empty()) {
+      more = false;
+      break;
+    }
+
+    for (auto& [key, bl] : vals) {
+      ++seen;
+      if (bl.length() == 0) {
+        continue;
+      }
+      std::string stored_value(bl.c_str(), bl.length());
+      char *end_ptr = 0;
+      double value = strtod(stored_value.c_str(), &end_ptr);
+
+      if (end_ptr && *end_ptr != '\0') {
+        CLS_ERR("sum: invalid stored value for key %s: %s",
+                key.c_str(), stored_value.c_str());
+        return -EBADMSG;
+      }
+      total += value;
+      ++count;
+    }
+    start_after = vals.rbegin()->first;
+  }
+
+  // the partial totals are added up by the client, keep every digit
+  std::stringstream stream;
+  stream << std::setprecision(std::numeric_limits<double>::max_digits10)
+         << total;
+
+  encode(stream.str(), *out);
+  encode(count, *out);
+  encode(start_after, *out);
+  encode(more, *out);
+  return 0;
+}
+
 CLS_INIT(numops)
 {
   CLS_LOG(20, "loading cls_numops");
@@ -155,6 +242,7 @@ CLS_INIT(numops)
   cls_handle_t h_class;
   cls_method_handle_t h_add;
   cls_method_handle_t h_mul;
+  cls_method_handle_t h_sum;
 
   cls_register("numops", &h_class);
 
@@ -165,4 +253,8 @@ CLS_INIT(numops)
   cls_register_cxx_method(h_class, "mul",
                           CLS_METHOD_RD | CLS_METHOD_WR,
                           mul, &h_mul);
+
+  cls_register_cxx_method(h_class, "sum",
+                          CLS_METHOD_RD,
+                          sum, &h_sum);
 }
@@ -17,6 +17,7 @@
 #include "include/rados/librados.hpp"
 
 #include <errno.h>
+#include <cstdlib>
 #include <sstream>
 
 namespace rados {
@@ -74,6 +75,51 @@ namespace rados {
         return mul(ioctx, oid, key, 1 / value_to_divide);
       }
 
+      int sum(librados::IoCtx *ioctx,
+              const std::string& oid,
+              const std::string& prefix,
+              double *total,
+              uint64_t *count,
+              uint64_t max_per_op)
+      {
+        double sum_total = 0;
+        uint64_t sum_count = 0;
+        std::string start_after;
+        bool more = true;
+
+        while (more) {
+          bufferlist in, out;
+          encode(prefix, in);
+          encode(start_after, in);
+          encode(max_per_op, in);
+
+          int r = ioctx->exec(oid, "numops", "sum", in, out);
+          if (r < 0)
+            return r;
+
+          std::string total_str;
+          uint64_t n;
+          try {
+            auto iter = out.cbegin();
+            decode(total_str, iter);
+            decode(n, iter);
+            decode(start_after, iter);
+            decode(more, iter);
+          } catch (const ceph::buffer::error &err) {
+            return -EBADMSG;
+          }
+
+          sum_total += strtod(total_str.c_str(), nullptr);
+          sum_count += n;
+        }
+
+        if (total)
+          *total = sum_total;
+        if (count)
+          *count = sum_count;
+        return 0;
+      }
+
     } // namespace numops
   } // namespace cls
 } // namespace rados
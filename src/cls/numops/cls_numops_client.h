@@ -16,6 +16,7 @@
 #define CEPH_LIBRBD_CLS_NUMOPS_CLIENT_H
 
 #include "include/rados/librados_fwd.hpp"
+#include <cstdint>
 #include <string>
 
 namespace rados {
@@ -42,6 +43,17 @@ namespace rados {
                      const std::string& key,
                      double value_to_divide);
 
+      // sum every numeric omap value whose key starts with prefix; the
+      // reduction is done by the OSD and only the result is returned.
+      // Big omaps are summed over several ops of at most max_per_op
+      // values each (0 means the OSD side limit).
+      extern int sum(librados::IoCtx *ioctx,
+                     const std::string& oid,
+                     const std::string& prefix,
+                     double *total,
+                     uint64_t *count,
+                     uint64_t max_per_op = 0);
+
     } // namespace numops
   } // namespace cls
 } // namespace rados
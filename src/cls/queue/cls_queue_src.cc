@@ -186,6 +186,34 @@ int queue_enqueue(cls_method_context_t hctx, cls_queue_enqueue_op& op, cls_queue
     return -ENOSPC;
   }
 
+  // entries that land back to back are written with a single op instead of
+  // one write per entry; a wrap around the end of the queue starts a new run
+  bufferlist pending;
+  uint64_t pending_ofs = 0;
+  auto flush_pending = [&] {
+    if (pending.length() == 0) {
+      return 0;
+    }
+    auto len = pending.length();
+    auto ret = cls_cxx_write2(hctx, pending_ofs, len, &pending, CEPH_OSD_OP_FLAG_FADVISE_SEQUENTIAL);
+    pending.clear();
+    return ret;
+  };
+  auto add_pending = [&](bufferlist& bl) {
+    if (pending.length() > 0 &&
+        pending_ofs + pending.length() != head.tail.offset) {
+      auto ret = flush_pending();
+      if (ret < 0) {
+        return ret;
+      }
+    }
+    if (pending.length() == 0) {
+      pending_ofs = head.tail.offset;
+    }
+    pending.claim_append(bl);
+    return 0;
+  };
+
   for (auto& bl_data : op.bl_data_vec) {
     bufferlist bl;
     uint16_t entry_start = QUEUE_ENTRY_START;
@@ -200,22 +228,27 @@ int queue_enqueue(cls_method_context_t hctx, cls_queue_enqueue_op& op, cls_queue
       // check if data can fit in the remaining space in queue
       if ((head.tail.offset + bl.length()) <= head.queue_size) {
         CLS_LOG(5, "INFO: queue_enqueue: Writing data size and data: offset: %s, size: %u", head.tail.to_str().c_str(), bl.length());
-        //write data size and data at tail offset
-        auto ret = cls_cxx_write2(hctx, head.tail.offset, bl.length(), &bl, CEPH_OSD_OP_FLAG_FADVISE_SEQUENTIAL);
+        //queue data size and data for writing at tail offset
+        const uint64_t len = bl.length();
+        auto ret = add_pending(bl);
         if (ret < 0) {
           return ret;
         }
-        head.tail.offset += bl.length();
+        head.tail.offset += len;
       } else {
         uint64_t free_space_available = (head.queue_size - head.tail.offset) + (head.front.offset - head.max_head_size);
         //Split data if there is free space available
         if (bl.length() <= free_space_available) {
           uint64_t size_before_wrap = head.queue_size - head.tail.offset;
+          auto ret = flush_pending();
+          if (ret < 0) {
+            return ret;
+          }
           bufferlist bl_data_before_wrap;
           bl.splice(0, size_before_wrap, &bl_data_before_wrap);
           //write spliced (data size and data) at tail offset
           CLS_LOG(5, "INFO: queue_enqueue: Writing spliced data at offset: %s and data size: %u", head.tail.to_str().c_str(), bl_data_before_wrap.length());
-          auto ret = cls_cxx_write2(hctx, head.tail.offset, bl_data_before_wrap.length(), &bl_data_before_wrap, CEPH_OSD_OP_FLAG_FADVISE_SEQUENTIAL);
+          ret = cls_cxx_write2(hctx, head.tail.offset, bl_data_before_wrap.length(), &bl_data_before_wrap, CEPH_OSD_OP_FLAG_FADVISE_SEQUENTIAL);
           if (ret < 0) {
             return ret;
           }
@@ -237,12 +270,13 @@ int queue_enqueue(cls_method_context_t hctx, cls_queue_enqueue_op& op, cls_queue
     } else if (head.front.offset > head.tail.offset) {
       if ((head.tail.offset + bl.length()) <= head.front.offset) {
         CLS_LOG(5, "INFO: queue_enqueue: Writing data size and data: offset: %s, size: %u", head.tail.to_str().c_str(), bl.length());
-        //write data size and data at tail offset
-        auto ret = cls_cxx_write2(hctx, head.tail.offset, bl.length(), &bl, CEPH_OSD_OP_FLAG_FADVISE_SEQUENTIAL);
+        //queue data size and data for writing at tail offset
+        const uint64_t len = bl.length();
+        auto ret = add_pending(bl);
         if (ret < 0) {
           return ret;
         }
-        head.tail.offset += bl.length();
+        head.tail.offset += len;
       } else {
         CLS_LOG(0, "ERROR: No space left in queue");
         // return queue full error
@@ -257,7 +291,7 @@ int queue_enqueue(cls_method_context_t hctx, cls_queue_enqueue_op& op, cls_queue
     CLS_LOG(20, "INFO: queue_enqueue: New tail offset: %s", head.tail.to_str().c_str());
   } //end - for
 
-  return 0;
+  return flush_pending();
 }
 
 int queue_list_entries(cls_method_context_t hctx, const cls_queue_list_op& op, cls_queue_list_ret& op_ret, cls_queue_head& head)
@@ -494,6 +494,20 @@ int cls_rgw_bi_list(librados::IoCtx& io_ctx, const std::string& oid,
   return 0;
 }
 
+void cls_rgw_bi_list(librados::ObjectReadOperation& op,
+                     const std::string& name_filter, const std::string& marker, uint32_t max,
+                     rgw_cls_bi_list_ret *pdata, int *ret)
+{
+  rgw_cls_bi_list_op call;
+  call.name_filter = name_filter;
+  call.marker = marker;
+  call.max = max;
+
+  bufferlist in;
+  encode(call, in);
+  op.exec(RGW_CLASS, RGW_BI_LIST, in, new ClsBucketIndexOpCtx<rgw_cls_bi_list_ret>(pdata, ret));
+}
+
 int cls_rgw_bucket_link_olh(librados::IoCtx& io_ctx, const string& oid,
                             const cls_rgw_obj_key& key, const bufferlist& olh_tag,
                             bool delete_marker, const string& op_tag, const rgw_bucket_dir_entry_meta *meta,
@@ -370,6 +370,9 @@ void cls_rgw_bi_put(librados::ObjectWriteOperation& op, const std::string oid, c
 int cls_rgw_bi_list(librados::IoCtx& io_ctx, const std::string& oid,
                    const std::string& name, const std::string& marker, uint32_t max,
                    std::list<rgw_cls_bi_entry> *entries, bool *is_truncated);
+void cls_rgw_bi_list(librados::ObjectReadOperation& op,
+                     const std::string& name, const std::string& marker, uint32_t max,
+                     rgw_cls_bi_list_ret *pdata, int *ret = nullptr);
 
 
 void cls_rgw_bucket_link_olh(librados::ObjectWriteOperation& op,
@@ -86,12 +86,26 @@ static inline bool _scan(
       *pp = (*p)->c_str();
       *pe = *pp + (*p)->length();
     }
-    const char *te = std::min(*pe, *pp + max - pos);
-    for (; *pp < te; ++(*pp), ++pos) {
-      if ((fp & mask) == mask) {
-	return false;
+    // work on locals: through the pointer/reference arguments the compiler
+    // has to assume every table load may alias them and spill both the
+    // cursor and the fingerprint on each byte.
+    const char *cp = *pp;
+    const char *te = std::min(*pe, cp + max - pos);
+    const char *start = cp;
+    uint64_t f = fp;
+    bool found = false;
+    for (; cp < te; ++cp) {
+      if ((f & mask) == mask) {
+	found = true;
+	break;
       }
-      fp = (fp << 1) ^ table[*(unsigned char*)*pp];
+      f = (f << 1) ^ table[*(const unsigned char*)cp];
+    }
+    pos += cp - start;
+    *pp = cp;
+    fp = f;
+    if (found) {
+      return false;
     }
     if (pos >= max) {
       return true;
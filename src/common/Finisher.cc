@@ -10,12 +10,32 @@
 void Finisher::start()
 {
   ldout(cct, 10) << __func__ << dendl;
+  if (auto n = cct->_conf.get_val<uint64_t>("finisher_shared_threads"); n > 0) {
+    pool = &cct->lookup_or_create_singleton_object<FinisherPool>(
+      "finisher_pool", false, cct, n);
+    std::lock_guard l(finisher_lock);
+    if (!finisher_queue.empty() && !pool_scheduled) {
+      pool_scheduled = true;
+      pool->schedule(this);
+    }
+    return;
+  }
   finisher_thread.create(thread_name.c_str());
 }
 
 void Finisher::stop()
 {
   ldout(cct, 10) << __func__ << dendl;
+  if (pool) {
+    std::unique_lock ul(finisher_lock);
+    finisher_stop = true;
+    // unlike our own thread, the pool only drops us once the queue is empty
+    finisher_empty_cond.wait(ul, [this] { return !pool_scheduled; });
+    finisher_stop = false;
+    pool = nullptr;
+    ldout(cct, 10) << __func__ << " finish" << dendl;
+    return;
+  }
   finisher_lock.lock();
   finisher_stop = true;
   // we don't have any new work to do, but we want the worker to wake up anyway
@@ -38,43 +58,63 @@ void Finisher::wait_for_empty()
   finisher_empty_wait = false;
 }
 
+void Finisher::wake(bool all)
+{
+  // called with finisher_lock held
+  if (pool) {
+    if (!pool_scheduled) {
+      pool_scheduled = true;
+      pool->schedule(this);
+    }
+  } else if (all) {
+    finisher_cond.notify_all();
+  } else {
+    finisher_cond.notify_one();
+  }
+}
+
+void Finisher::run_batch(std::unique_lock<ceph::mutex>& ul)
+{
+  // To reduce lock contention, we swap out the queue to process.
+  // This way other threads can submit new contexts to complete
+  // while we are working.
+  in_progress_queue.swap(finisher_queue);
+  finisher_running = true;
+  ul.unlock();
+  ldout(cct, 10) << "finisher_thread doing " << in_progress_queue << dendl;
+
+  utime_t start;
+  uint64_t count = 0;
+  if (logger) {
+    start = ceph_clock_now();
+    count = in_progress_queue.size();
+  }
+
+  // Now actually process the contexts.
+  for (auto p : in_progress_queue) {
+    p.first->complete(p.second);
+  }
+  ldout(cct, 10) << "finisher_thread done with " << in_progress_queue
+                 << dendl;
+  in_progress_queue.clear();
+  if (logger) {
+    logger->dec(l_finisher_queue_len, count);
+    logger->tinc(l_finisher_complete_lat, ceph_clock_now() - start);
+  }
+
+  ul.lock();
+  finisher_running = false;
+}
+
 void *Finisher::finisher_thread_entry()
 {
   std::unique_lock ul(finisher_lock);
   ldout(cct, 10) << "finisher_thread start" << dendl;
 
-  utime_t start;
-  uint64_t count = 0;
   while (!finisher_stop) {
     /// Every time we are woken up, we process the queue until it is empty.
     while (!finisher_queue.empty()) {
-      // To reduce lock contention, we swap out the queue to process.
-      // This way other threads can submit new contexts to complete
-      // while we are working.
-      in_progress_queue.swap(finisher_queue);
-      finisher_running = true;
-      ul.unlock();
-      ldout(cct, 10) << "finisher_thread doing " << in_progress_queue << dendl;
-
-      if (logger) {
-	start = ceph_clock_now();
-	count = in_progress_queue.size();
-      }
-
-      // Now actually process the contexts.
-      for (auto p : in_progress_queue) {
-	p.first->complete(p.second);
-      }
-      ldout(cct, 10) << "finisher_thread done with " << in_progress_queue
-                     << dendl;
-      in_progress_queue.clear();
-      if (logger) {
-	logger->dec(l_finisher_queue_len, count);
-	logger->tinc(l_finisher_complete_lat, ceph_clock_now() - start);
-      }
-
-      ul.lock();
-      finisher_running = false;
+      run_batch(ul);
     }
     ldout(cct, 10) << "finisher_thread empty" << dendl;
     if (unlikely(finisher_empty_wait))
@@ -94,3 +134,98 @@ void *Finisher::finisher_thread_entry()
   return 0;
 }
 
+void Finisher::pool_entry()
+{
+  std::unique_lock ul(finisher_lock);
+  if (!finisher_queue.empty()) {
+    run_batch(ul);
+  }
+  if (!finisher_queue.empty()) {
+    // more arrived while we were running; let the others have a turn first
+    pool->schedule(this);
+    return;
+  }
+  pool_scheduled = false;
+  if (unlikely(finisher_empty_wait || finisher_stop))
+    finisher_empty_cond.notify_all();
+}
+
+#undef dout_prefix
+#define dout_prefix *_dout << "finisher_pool(" << this << ") "
+
+struct FinisherPool::ForkHook : public CephContext::ForkWatcher {
+  FinisherPool *pool;
+  explicit ForkHook(FinisherPool *p) : pool(p) {}
+  void handle_pre_fork() override {
+    pool->stop_threads();
+  }
+  void handle_post_fork() override {
+    pool->start_threads();
+  }
+};
+
+FinisherPool::FinisherPool(CephContext *cct_, unsigned num_threads)
+  : cct(cct_), num_threads(num_threads),
+    fork_hook(std::make_unique<ForkHook>(this))
+{
+  ldout(cct, 10) << __func__ << " " << num_threads << " threads" << dendl;
+  start_threads();
+  // we live as long as the context, so the hook is never left dangling
+  cct->register_fork_watcher(fork_hook.get());
+}
+
+FinisherPool::~FinisherPool()
+{
+  stop_threads();
+}
+
+void FinisherPool::start_threads()
+{
+  std::lock_guard l(lock);
+  ceph_assert(threads.empty());
+  for (unsigned i = 0; i < num_threads; ++i) {
+    threads.emplace_back(std::make_unique<PoolThread>(this));
+    threads.back()->create("fn_shared");
+  }
+}
+
+void FinisherPool::stop_threads()
+{
+  // the threads drain the ready list before they exit
+  std::vector<std::unique_ptr<PoolThread>> stopped;
+  {
+    std::lock_guard l(lock);
+    stopping = true;
+    cond.notify_all();
+    stopped.swap(threads);
+  }
+  for (auto& t : stopped) {
+    t->join();
+  }
+  std::lock_guard l(lock);
+  stopping = false;
+}
+
+void FinisherPool::schedule(Finisher *f)
+{
+  std::lock_guard l(lock);
+  ready.push_back(f);
+  cond.notify_one();
+}
+
+void *FinisherPool::entry()
+{
+  std::unique_lock ul(lock);
+  while (true) {
+    cond.wait(ul, [this] { return stopping || !ready.empty(); });
+    if (ready.empty()) {
+      break;
+    }
+    Finisher *f = ready.front();
+    ready.pop_front();
+    ul.unlock();
+    f->pool_entry();
+    ul.lock();
+  }
+  return 0;
+}
@@ -22,6 +22,10 @@
 #include "common/perf_counters.h"
 #include "common/Cond.h"
 
+#include <deque>
+#include <memory>
+#include <vector>
+
 
 /// Finisher queue length performance counter ID.
 enum {
@@ -31,6 +35,52 @@ enum {
   l_finisher_last
 };
 
+class Finisher;
+
+/** @brief A fixed set of threads shared by many Finishers.
+ * Finishers started while finisher_shared_threads is non-zero complete
+ * their contexts here instead of on a thread of their own.  A Finisher
+ * is handed to at most one pool thread at a time, so the contexts queued
+ * to it still complete in order; busy Finishers go to the back of the
+ * line after every batch so that they cannot starve the others.
+ * The threads are joined before a fork and started again after it, so
+ * the pool and the Finishers pointing at it stay valid in the child.
+ */
+class FinisherPool {
+  CephContext *cct;
+  const unsigned num_threads;
+  ceph::mutex lock = ceph::make_mutex("FinisherPool::lock");
+  ceph::condition_variable cond;
+  bool stopping = false;
+  std::deque<Finisher*> ready;
+
+  struct PoolThread : public Thread {
+    FinisherPool *pool;
+    explicit PoolThread(FinisherPool *p) : pool(p) {}
+    void* entry() override { return pool->entry(); }
+  };
+  std::vector<std::unique_ptr<PoolThread>> threads;
+
+  struct ForkHook;
+  std::unique_ptr<ForkHook> fork_hook;
+
+  void *entry();
+  void start_threads();
+  void stop_threads();
+
+ public:
+  FinisherPool(CephContext *cct_, unsigned num_threads);
+  ~FinisherPool();
+
+  /// Queue @p f to have its pending contexts completed.
+  void schedule(Finisher *f);
+  /// Number of threads currently running, 0 while forking.
+  size_t get_num_running() {
+    std::lock_guard l(lock);
+    return threads.size();
+  }
+};
+
 /** @brief Asynchronous cleanup class.
  * Finisher asynchronously completes Contexts, which are simple classes
  * representing callbacks, in a dedicated worker thread. Enqueuing
@@ -55,7 +105,16 @@ class Finisher {
   /// Only active for named finishers.
   PerfCounters *logger;
 
+  /// Shared threads we run on in place of finisher_thread, if any.
+  FinisherPool *pool = nullptr;
+  /// True while we are queued on, or running in, the pool.
+  bool pool_scheduled = false;
+
+  void wake(bool all);
+  void run_batch(std::unique_lock<ceph::mutex>& ul);
   void *finisher_thread_entry();
+  void pool_entry();
+  friend class FinisherPool;
 
   struct FinisherThread : public Thread {
     Finisher *fin;
@@ -70,7 +129,7 @@ class Finisher {
     bool was_empty = finisher_queue.empty();
     finisher_queue.push_back(std::make_pair(c, r));
     if (was_empty) {
-      finisher_cond.notify_one();
+      wake(false);
     }
     if (logger)
       logger->inc(l_finisher_queue_len);
@@ -80,7 +139,7 @@ class Finisher {
     {
       std::unique_lock ul(finisher_lock);
       if (finisher_queue.empty()) {
-	finisher_cond.notify_all();
+	wake(true);
       }
       for (auto i : ls) {
 	finisher_queue.push_back(std::make_pair(i, 0));
@@ -94,7 +153,7 @@ class Finisher {
     {
       std::unique_lock ul(finisher_lock);
       if (finisher_queue.empty()) {
-	finisher_cond.notify_all();
+	wake(true);
       }
       for (auto i : ls) {
 	finisher_queue.push_back(std::make_pair(i, 0));
@@ -108,7 +167,7 @@ class Finisher {
     {
       std::unique_lock ul(finisher_lock);
       if (finisher_queue.empty()) {
-	finisher_cond.notify_all();
+	wake(true);
       }
       for (auto i : ls) {
 	finisher_queue.push_back(std::make_pair(i, 0));
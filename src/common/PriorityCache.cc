@@ -12,8 +12,13 @@
  *
  */
 
+#include <algorithm>
+
 #include "PriorityCache.h"
+#include "common/admin_socket.h"
+#include "common/Clock.h"
 #include "common/dout.h"
+#include "common/Formatter.h"
 #include "perfglue/heap_profiler.h"
 #define dout_context cct
 #define dout_subsys ceph_subsys_prioritycache
@@ -22,6 +27,46 @@
 
 namespace PriorityCache
 {
+  class Manager::SocketHook : public AdminSocketHook {
+    CephContext *cct;
+    Manager *manager;
+    std::string command;
+  public:
+    SocketHook(Manager *m) :
+      cct(m->cct), manager(m), command(m->name + " balance trace")
+    {
+      AdminSocket *admin_socket = cct->get_admin_socket();
+      if (admin_socket) {
+        int r = admin_socket->register_command(
+          command.c_str(), this,
+          "dump the recent cache balancing decisions");
+        if (r != 0) {
+          manager = nullptr; // some collision, disable
+        }
+      }
+    }
+    ~SocketHook() {
+      AdminSocket *admin_socket = cct->get_admin_socket();
+      if (admin_socket && manager) {
+        admin_socket->unregister_commands(this);
+      }
+    }
+
+    int call(std::string_view cmd,
+             const cmdmap_t& cmdmap,
+             const ceph::bufferlist&,
+             ceph::Formatter *f,
+             std::ostream& ss,
+             ceph::bufferlist& out) override {
+      if (cmd != command) {
+        ss << "Invalid command" << std::endl;
+        return -ENOSYS;
+      }
+      manager->dump_balance_trace(f);
+      return 0;
+    }
+  };
+
   int64_t get_chunk(uint64_t usage, uint64_t total_bytes)
   {
     uint64_t chunk = total_bytes;
@@ -98,11 +143,14 @@ namespace PriorityCache
     logger = b.create_perf_counters();
     cct->get_perfcounters_collection()->add(logger);
 
+    asok_hook = new SocketHook(this);
+
     tune_memory();
   }
 
   Manager::~Manager()
   {
+    delete asok_hook;
     clear();
     cct->get_perfcounters_collection()->remove(logger);
     delete logger;
@@ -229,6 +277,10 @@ namespace PriorityCache
               "total bytes committed,", "c",
               PerfCountersBuilder::PRIO_USEFUL, unit_t(UNIT_BYTES));
 
+    b.add_u64(cur_index + Extra::E_RATIO, "balance_ratio",
+              "ratio used by the last balance, in thousandths", "br",
+              PerfCountersBuilder::PRIO_USEFUL);
+
     for (int i = 0; i < Extra::E_LAST+1; i++) {
       indexes[name][i] = cur_index + i;
     }
@@ -250,6 +302,8 @@ namespace PriorityCache
     }
     indexes.erase(name);
     caches.erase(name);
+    miss_state.erase(name);
+    ratios.erase(name);
   }
 
   void Manager::clear()
@@ -262,10 +316,102 @@ namespace PriorityCache
     }
     indexes.clear();
     caches.clear();
+    miss_state.clear();
+    ratios.clear();
+  }
+
+  void Manager::update_ratios()
+  {
+    ratios.clear();
+    for (auto& [n, c] : caches) {
+      ratios[n] = c->get_cache_ratio();
+    }
+    if (!adaptive) {
+      return;
+    }
+
+    // Score every cache that tracks lookups by the bytes it missed since the
+    // last balance relative to the bytes it holds: with the usual concave
+    // hit curves, the cache missing the most per byte held gains the most
+    // hits from extra memory.
+    std::vector<std::string> scored;
+    double score_sum = 0;
+    for (auto& [n, c] : caches) {
+      uint64_t misses = 0, bytes_per_miss = 0, resident = 0;
+      auto& ms = miss_state[n];
+      if (!c->get_miss_stats(&misses, &bytes_per_miss, &resident)) {
+        ms = miss_state_t();
+        continue;
+      }
+      uint64_t delta = misses >= ms.misses ? misses - ms.misses : 0;
+      ms.misses = misses;
+      if (!ms.primed) {
+        ms.primed = true;
+        continue;
+      }
+      ms.score = (double)delta * bytes_per_miss /
+        std::max<uint64_t>(resident, 1);
+      score_sum += ms.score;
+      scored.push_back(n);
+    }
+    if (scored.size() < 2) {
+      return;
+    }
+
+    // Move each weight a quarter of the way towards its score relative to
+    // the mean, bounded so no cache is starved or takes everything.
+    double mean = score_sum / scored.size();
+    double base_sum = 0;
+    double weighted_sum = 0;
+    for (auto& n : scored) {
+      auto& ms = miss_state[n];
+      if (mean > 0) {
+        double target = std::clamp(ms.score / mean, 0.25, 4.0);
+        ms.weight = 0.75 * ms.weight + 0.25 * target;
+      }
+      base_sum += ratios[n];
+      weighted_sum += ratios[n] * ms.weight;
+    }
+    if (weighted_sum <= 0) {
+      return;
+    }
+    // The scored caches share what their configured ratios add up to.
+    for (auto& n : scored) {
+      ratios[n] = ratios[n] * miss_state[n].weight * base_sum / weighted_sum;
+    }
+  }
+
+  void Manager::dump_balance_trace(ceph::Formatter *f)
+  {
+    std::lock_guard l(trace_lock);
+    f->open_object_section("balance_trace");
+    f->dump_bool("adaptive", adaptive);
+    f->open_array_section("balances");
+    for (auto& t : trace) {
+      f->open_object_section("balance");
+      f->dump_stream("stamp") << t.stamp;
+      f->dump_unsigned("tuned_mem", t.tuned_mem);
+      f->open_array_section("caches");
+      for (auto& d : t.caches) {
+        f->open_object_section("cache");
+        f->dump_string("name", d.name);
+        f->dump_float("score", d.score);
+        f->dump_float("weight", d.weight);
+        f->dump_float("ratio", d.ratio);
+        f->dump_int("committed_bytes", d.committed);
+        f->close_section();
+      }
+      f->close_section();
+      f->close_section();
+    }
+    f->close_section();
+    f->close_section();
   }
 
   void Manager::balance()
   {
+    update_ratios();
+
     int64_t mem_avail = tuned_mem;
     // Each cache is going to get a little extra from get_chunk, so shrink the
     // available memory here to compensate.
@@ -299,6 +445,9 @@ namespace PriorityCache
     // assert if we assigned more memory than is available.
     ceph_assert(mem_avail >= 0);
 
+    balance_trace_t t;
+    t.stamp = ceph_clock_now();
+    t.tuned_mem = tuned_mem;
     for (auto &l : loggers) {
       auto it = caches.find(l.first);
       ceph_assert(it != caches.end());
@@ -310,6 +459,18 @@ namespace PriorityCache
 
       l.second->set(indexes[it->first][Extra::E_RESERVED], committed - alloc);
       l.second->set(indexes[it->first][Extra::E_COMMITTED], committed);
+      l.second->set(indexes[it->first][Extra::E_RATIO],
+                    ratios[it->first] * 1000);
+
+      auto& ms = miss_state[it->first];
+      t.caches.push_back(
+        {it->first, ms.score, ms.weight, ratios[it->first], committed});
+    }
+
+    std::lock_guard l(trace_lock);
+    trace.push_back(std::move(t));
+    if (trace.size() > BALANCE_TRACE_MAX) {
+      trace.pop_front();
     }
   }
 
@@ -331,7 +492,7 @@ namespace PriorityCache
     // First, zero this priority's bytes, sum the initial ratios.
     for (auto it = caches.begin(); it != caches.end(); it++) {
       it->second->set_cache_bytes(pri, 0);
-      cur_ratios += it->second->get_cache_ratio();
+      cur_ratios += ratios[it->first];
     }
 
     // For other priorities, loop until caches are satisified or we run out of
@@ -347,7 +508,7 @@ namespace PriorityCache
         // them an equal shot at the remaining memory for this priority.
         double ratio = 1.0 / tmp_caches.size();
         if (cur_ratios > 0) {
-          ratio = it->second->get_cache_ratio() / cur_ratios;
+          ratio = ratios[it->first] / cur_ratios;
         }
         int64_t fair_share = static_cast<int64_t>(*mem_avail * ratio);
 
@@ -355,7 +516,7 @@ namespace PriorityCache
                        << " pri: " << (int) pri
                        << " round: " << round
                        << " wanted: " << cache_wants
-                       << " ratio: " << it->second->get_cache_ratio()
+                       << " ratio: " << ratios[it->first]
                        << " cur_ratios: " << cur_ratios
                        << " fair_share: " << fair_share
                        << " mem_avail: " << *mem_avail
@@ -365,7 +526,7 @@ namespace PriorityCache
           // If we want too much, take what we can get but stick around for more
           it->second->add_cache_bytes(pri, fair_share);
           total_assigned += fair_share;
-          new_ratios += it->second->get_cache_ratio();
+          new_ratios += ratios[it->first];
           ++it;
         } else {
           // Otherwise assign only what we want
@@ -390,7 +551,7 @@ namespace PriorityCache
     if (pri == Priority::LAST) {
       uint64_t total_assigned = 0;
       for (auto it = caches.begin(); it != caches.end(); it++) {
-        double ratio = it->second->get_cache_ratio();
+        double ratio = ratios[it->first];
         int64_t fair_share = static_cast<int64_t>(*mem_avail * ratio);
         it->second->set_cache_bytes(Priority::LAST, fair_share);
         total_assigned += fair_share;
@@ -16,12 +16,15 @@
 #define CEPH_PRIORITY_CACHE_H
 
 #include <stdint.h>
+#include <deque>
 #include <string>
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include "common/ceph_mutex.h"
 #include "common/perf_counters.h"
 #include "include/ceph_assert.h"
+#include "include/utime.h"
 
 namespace PriorityCache {
   // Reserve 16384 slots for PriorityCache perf counters
@@ -57,7 +60,8 @@ namespace PriorityCache {
   enum Extra {
     E_RESERVED = Priority::LAST+1,
     E_COMMITTED,
-    E_LAST = E_COMMITTED,
+    E_RATIO,
+    E_LAST = E_RATIO,
   };
 
   int64_t get_chunk(uint64_t usage, uint64_t total_bytes);
@@ -112,9 +116,44 @@ namespace PriorityCache {
 
     // Get bins
     virtual uint64_t get_bins(PriorityCache::Priority pri) const = 0;
+
+    /* Report the misses seen so far, the bytes each of them stands for (1
+     * for caches that count missed bytes, the average item size for caches
+     * that count missed items) and the bytes currently cached.  The
+     * adaptive balancer uses them to estimate which cache gains the most
+     * from more memory.  Caches that do not track lookups return false and
+     * keep their configured ratio. */
+    virtual bool get_miss_stats(uint64_t *misses, uint64_t *bytes_per_miss,
+                                uint64_t *resident_bytes) const {
+      return false;
+    }
   };
 
   class Manager {
+    class SocketHook;
+
+    // What one adaptive balance() decided for one cache.
+    struct balance_decision_t {
+      std::string name;
+      double score;   //< bytes missed since the last balance per byte cached
+      double weight;  //< multiplier applied to the configured ratio
+      double ratio;   //< effective ratio used by this balance
+      int64_t committed;
+    };
+    struct balance_trace_t {
+      utime_t stamp;
+      uint64_t tuned_mem;
+      std::vector<balance_decision_t> caches;
+    };
+    static constexpr size_t BALANCE_TRACE_MAX = 32;
+
+    struct miss_state_t {
+      uint64_t misses = 0;
+      bool primed = false;
+      double score = 0;
+      double weight = 1.0;
+    };
+
     CephContext* cct = nullptr;
     PerfCounters* logger;
     std::unordered_map<std::string, PerfCounters*> loggers;
@@ -130,6 +169,14 @@ namespace PriorityCache {
     uint64_t tuned_mem = 0;
     bool reserve_extra;
     std::string name;
+
+    bool adaptive = false;
+    std::unordered_map<std::string, miss_state_t> miss_state;
+    std::unordered_map<std::string, double> ratios;
+
+    ceph::mutex trace_lock = ceph::make_mutex("PriorityCache::Manager::trace_lock");
+    std::deque<balance_trace_t> trace;
+    SocketHook *asok_hook = nullptr;
   public:
     Manager(CephContext *c, uint64_t min, uint64_t max, uint64_t target,
             bool reserve_extra, const std::string& name = std::string());
@@ -146,6 +193,12 @@ namespace PriorityCache {
     uint64_t get_tuned_mem() const {
       return tuned_mem;
     }
+    /* In adaptive mode the configured cache ratios are scaled by how much
+     * each cache missed since the previous balance, relative to its size, so
+     * memory drifts towards the cache where it saves the most misses. */
+    void set_adaptive(bool a) {
+      adaptive = a;
+    }
     void insert(const std::string& name, const std::shared_ptr<PriCache> c,
                 bool enable_perf_counters);
     void erase(const std::string& name);
@@ -153,8 +206,10 @@ namespace PriorityCache {
     void tune_memory();
     void balance();
     void shift_bins();
+    void dump_balance_trace(ceph::Formatter *f);
   private:
     void balance_priority(int64_t *mem_avail, Priority pri);
+    void update_ratios();
   };
 }
 
@@ -296,6 +296,8 @@ bool OpTracker::register_inflight_op(TrackedOp *i)
     sdata->ops_in_flight_sharded.push_back(*i);
     i->seq = current_seq;
   }
+  const uint32_t sample_rate = history_sample_rate;
+  i->sampled = sample_rate <= 1 || current_seq % sample_rate == 0;
   return true;
 }
 
@@ -314,6 +316,13 @@ void OpTracker::unregister_inflight_op(TrackedOp* const i)
   }
 }
 
+bool OpTracker::wants_history(const TrackedOp& i) const
+{
+  // unsampled ops are still kept if slow, so that the slow op history
+  // remains complete
+  return i.sampled || history.is_slow(i.get_duration());
+}
+
 void OpTracker::record_history_op(TrackedOpRef&& i)
 {
   std::shared_lock l{lock};
@@ -486,7 +495,15 @@ void TrackedOp::mark_event(std::string_view event, utime_t stamp)
 
   {
     std::lock_guard l(lock);
-    events.emplace_back(stamp, event);
+    if (!sampled && events.size() > 1) {
+      // only 'initiated' and the current state are kept. Reuse the
+      // storage of the previous event.
+      auto& last = events.back();
+      last.stamp = stamp;
+      last.str.assign(event);
+    } else {
+      events.emplace_back(stamp, event);
+    }
   }
   dout(6) << " seq: " << seq
 	  << ", time: " << stamp
@@ -114,6 +114,9 @@ public:
     history_slow_op_size = new_size;
     history_slow_op_threshold = new_threshold;
   }
+  bool is_slow(double opduration) const {
+    return opduration >= history_slow_op_threshold.load();
+  }
 };
 
 struct ShardedTrackingData;
@@ -126,6 +129,10 @@ class OpTracker {
   float complaint_time;
   int log_threshold;
   std::atomic<bool> tracking_enabled;
+  /// only one op in 'history_sample_rate' keeps its full event timeline
+  /// and is kept in the history; the others only remember their latest
+  /// event, and are kept only if slow
+  std::atomic<uint32_t> history_sample_rate{1};
   ceph::shared_mutex lock = ceph::make_shared_mutex("OpTracker::lock");
 
 public:
@@ -142,6 +149,9 @@ public:
   void set_history_slow_op_size_and_threshold(uint32_t new_size, uint32_t new_threshold) {
     history.set_slow_op_size_and_threshold(new_size, new_threshold);
   }
+  void set_history_sample_rate(uint32_t rate) {
+    history_sample_rate = std::max<uint32_t>(rate, 1);
+  }
   bool is_tracking() const {
     return tracking_enabled;
   }
@@ -154,6 +164,8 @@ public:
   bool register_inflight_op(TrackedOp *i);
   void unregister_inflight_op(TrackedOp *i);
   void record_history_op(TrackedOpRef&& i);
+  /// should a completed op be moved to the history?
+  bool wants_history(const TrackedOp& i) const;
 
   void get_age_ms_histogram(pow2_hist_t *h);
 
@@ -268,6 +280,7 @@ protected:
   std::vector<Event> events;    ///< std::list of events and their times
   mutable ceph::mutex lock = ceph::make_mutex("TrackedOp::lock"); ///< to protect the events list
   uint64_t seq = 0;        ///< a unique value std::set by the OpTracker
+  bool sampled = true;     ///< keeping the full event timeline?
 
   uint32_t warn_interval_multiplier = 1; //< limits output of a given op warning
 
@@ -325,7 +338,7 @@ public:
 	mark_event("done");
 	tracker->unregister_inflight_op(this);
 	_unregistered();
-	if (!tracker->is_tracking()) {
+	if (!tracker->is_tracking() || !tracker->wants_history(*this)) {
 	  delete this;
 	} else {
 	  state = TrackedOp::STATE_HISTORY;
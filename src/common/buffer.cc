@@ -2209,6 +2209,53 @@ buffer::ptr_node::create_hypercombined(ceph::unique_leakable_ptr<buffer::raw> r)
     new ptr_node(std::move(r)));
 }
 
+namespace {
+struct ptr_node_cache_t {
+  static constexpr unsigned max_cached = 128;
+  void* free_list = nullptr;
+  unsigned count = 0;
+  bool destroyed = false;
+
+  ~ptr_node_cache_t() {
+    while (free_list) {
+      void* next = *static_cast<void**>(free_list);
+      ::operator delete(free_list);
+      free_list = next;
+    }
+    count = 0;
+    // nodes freed by thread_local destructors that run after us go
+    // straight back to the heap
+    destroyed = true;
+  }
+};
+thread_local ptr_node_cache_t ptr_node_cache;
+}
+
+void* buffer::ptr_node::operator new(std::size_t size)
+{
+  ceph_assert(size == sizeof(ptr_node));
+  auto& cache = ptr_node_cache;
+  if (cache.free_list) {
+    void* p = cache.free_list;
+    cache.free_list = *static_cast<void**>(p);
+    --cache.count;
+    return p;
+  }
+  return ::operator new(size);
+}
+
+void buffer::ptr_node::operator delete(void* p)
+{
+  auto& cache = ptr_node_cache;
+  if (cache.destroyed || cache.count >= ptr_node_cache_t::max_cached) {
+    ::operator delete(p);
+    return;
+  }
+  *static_cast<void**>(p) = cache.free_list;
+  cache.free_list = p;
+  ++cache.count;
+}
+
 buffer::ptr_node* buffer::ptr_node::cloner::operator()(
   const buffer::ptr_node& clone_this)
 {
@@ -15,13 +15,18 @@
 #ifndef COMMON_CEPH_TIMER_H
 #define COMMON_CEPH_TIMER_H
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <boost/intrusive/list.hpp>
 #include <boost/intrusive/set.hpp>
 
 #include "include/function2.hpp"
@@ -307,6 +312,318 @@ public:
     }
   }
 }; // timer
+
+// A hashed timing wheel offering the same interface as timer.
+//
+// Events are binned by deadline into one of Slots buckets, each
+// covering one tick of the resolution given at construction, so adding,
+// adjusting and cancelling an event never rebalance a tree ordered by
+// time. The price is precision: an event runs up to one tick late (never
+// early), and events falling due in the same tick run in the order they
+// were added rather than strictly by deadline. That is the right trade
+// for timeouts, which are armed and cancelled far more often than they
+// fire.
+template<typename TC, std::size_t Slots = 512>
+class wheel_timer {
+  using lh = bi::list_member_hook<bi::link_mode<bi::auto_unlink>>;
+  using sh = bi::set_member_hook<bi::link_mode<bi::normal_link>>;
+
+  struct event {
+    typename TC::time_point t = typename TC::time_point::min();
+    std::uint64_t id = 0;
+    std::uint64_t tick = 0;
+    fu2::unique_function<void()> f;
+
+    lh slot_link;
+    sh event_link;
+
+    event() = default;
+    event(typename TC::time_point t, std::uint64_t id,
+	  fu2::unique_function<void()> f) : t(t), id(id), f(std::move(f)) {}
+
+    event(const event&) = delete;
+    event& operator =(const event&) = delete;
+
+    event(event&&) = delete;
+    event& operator =(event&&) = delete;
+  };
+  struct id_key {
+    using type = std::uint64_t;
+    const type& operator ()(const event& e) const noexcept {
+      return e.id;
+    }
+  };
+
+  using slot_list = bi::list<event,
+			     bi::member_hook<event, lh, &event::slot_link>,
+			     bi::constant_time_size<false>>;
+  std::array<slot_list, Slots> slots;
+
+  // Ids only ever grow, so inserting at the end is amortized constant.
+  bi::set<event, bi::member_hook<event, sh, &event::event_link>,
+	  bi::constant_time_size<false>,
+	  bi::key_of_value<id_key>> events;
+
+  std::mutex lock;
+  std::condition_variable cond;
+
+  const typename TC::duration resolution;
+  const typename TC::time_point epoch;
+  // The first tick whose slot has not been swept yet
+  std::uint64_t next_tick = 0;
+  // The tick the timer thread is sleeping until, if it is sleeping
+  std::uint64_t wake_tick = 0;
+
+  event* running = nullptr;
+  std::uint64_t next_id = 0;
+
+  bool suspended;
+  std::thread thread;
+
+  // The first tick that starts at or after t, so that an event is never
+  // run before its deadline.
+  std::uint64_t tick_of(typename TC::time_point t) const {
+    if (t <= epoch)
+      return 0;
+    const auto d = (t - epoch).count();
+    const auto r = resolution.count();
+    return (d + r - 1) / r;
+  }
+
+  // Must be called with the lock held.
+  void link(event& e) {
+    e.tick = std::max(tick_of(e.t), next_tick);
+    slots[e.tick % Slots].push_back(e);
+    if (e.tick < wake_tick)
+      cond.notify_one();
+  }
+
+  void timer_thread() {
+    std::unique_lock l(lock);
+    while (!suspended) {
+      auto now = TC::now();
+      const std::uint64_t last = now <= epoch ? 0 :
+	(now - epoch).count() / resolution.count();
+
+      if (events.empty()) {
+	next_tick = std::max(next_tick, last + 1);
+      } else if (next_tick <= last) {
+	// However far behind we are, one lap of the wheel sees every
+	// event that is due.
+	const auto laps = std::min<std::uint64_t>(last - next_tick + 1, Slots);
+	slot_list due;
+	for (std::uint64_t i = 0; i < laps; ++i) {
+	  auto& slot = slots[(next_tick + i) % Slots];
+	  for (auto p = slot.begin(); p != slot.end();) {
+	    auto& e = *p++;
+	    if (e.tick <= last) {
+	      e.slot_link.unlink();
+	      due.push_back(e);
+	    }
+	  }
+	}
+	next_tick = last + 1;
+
+	while (!due.empty()) {
+	  auto& e = due.front();
+	  due.pop_front();
+	  events.erase(e.id);
+
+	  // Since we have only one thread it is impossible to have more
+	  // than one running event
+	  running = &e;
+
+	  l.unlock();
+	  e.f();
+	  l.lock();
+
+	  if (running) {
+	    running = nullptr;
+	    delete &e;
+	  } // Otherwise the event requeued itself
+	}
+	continue;
+      }
+
+      if (suspended)
+	break;
+      if (events.empty()) {
+	wake_tick = std::numeric_limits<std::uint64_t>::max();
+	cond.wait(l);
+      } else {
+	// Sleep until the next occupied slot. Its events may belong to
+	// a later lap, in which case sweeping it is merely wasted.
+	std::uint64_t i = 0;
+	while (i < Slots - 1 && slots[(next_tick + i) % Slots].empty())
+	  ++i;
+	wake_tick = next_tick + i;
+	cond.wait_until(l, epoch + resolution *
+			static_cast<typename TC::duration::rep>(wake_tick));
+      }
+      wake_tick = 0;
+    }
+  }
+
+public:
+  explicit wheel_timer(typename TC::duration resolution =
+		       std::chrono::duration_cast<typename TC::duration>(
+			 std::chrono::milliseconds(10)))
+    : resolution(resolution), epoch(TC::now()), suspended(false) {
+    assert(resolution.count() > 0);
+    thread = std::thread(&wheel_timer::timer_thread, this);
+    ceph_pthread_setname(thread.native_handle(), "ceph_timer");
+  }
+
+  // Create a suspended timer, jobs will be executed in order when
+  // it is resumed.
+  explicit wheel_timer(construct_suspended_t,
+		       typename TC::duration resolution =
+		       std::chrono::duration_cast<typename TC::duration>(
+			 std::chrono::milliseconds(10)))
+    : resolution(resolution), epoch(TC::now()), suspended(true) {
+    assert(resolution.count() > 0);
+  }
+
+  wheel_timer(const wheel_timer&) = delete;
+  wheel_timer& operator =(const wheel_timer&) = delete;
+
+  ~wheel_timer() {
+    suspend();
+    cancel_all_events();
+  }
+
+  // Suspend operation of the timer (and let its thread die).
+  void suspend() {
+    std::unique_lock l(lock);
+    if (suspended)
+      return;
+
+    suspended = true;
+    cond.notify_one();
+    l.unlock();
+    thread.join();
+  }
+
+  // Resume operation of the timer. (Must have been previously
+  // suspended.)
+  void resume() {
+    std::unique_lock l(lock);
+    if (!suspended)
+      return;
+
+    suspended = false;
+    assert(!thread.joinable());
+    thread = std::thread(&wheel_timer::timer_thread, this);
+  }
+
+  // Schedule an event in the relative future
+  template<typename Callable, typename... Args>
+  std::uint64_t add_event(typename TC::duration duration,
+			  Callable&& f, Args&&... args) {
+    return add_event(TC::now() + duration,
+		     std::forward<Callable>(f),
+		     std::forward<Args>(args)...);
+  }
+
+  // Schedule an event in the absolute future
+  template<typename Callable, typename... Args>
+  std::uint64_t add_event(typename TC::time_point when,
+			  Callable&& f, Args&&... args) {
+    std::lock_guard l(lock);
+    auto e = std::make_unique<event>(when, ++next_id,
+				     std::bind(std::forward<Callable>(f),
+					       std::forward<Args>(args)...));
+    auto id = e->id;
+    link(*e);
+    events.insert(events.end(), *(e.release()));
+    return id;
+  }
+
+  // Adjust the timeout of a currently-scheduled event (relative)
+  bool adjust_event(std::uint64_t id, typename TC::duration duration) {
+    return adjust_event(id, TC::now() + duration);
+  }
+
+  // Adjust the timeout of a currently-scheduled event (absolute)
+  bool adjust_event(std::uint64_t id, typename TC::time_point when) {
+    std::lock_guard l(lock);
+
+    auto it = events.find(id);
+
+    if (it == events.end())
+      return false;
+
+    auto& e = *it;
+
+    e.slot_link.unlink();
+    e.t = when;
+    link(e);
+
+    return true;
+  }
+
+  // Cancel an event. If the event has already come and gone (or you
+  // never submitted it) you will receive false. Otherwise you will
+  // receive true and it is guaranteed the event will not execute.
+  bool cancel_event(const std::uint64_t id) {
+    std::lock_guard l(lock);
+    auto p = events.find(id);
+    if (p == events.end()) {
+      return false;
+    }
+
+    auto& e = *p;
+    events.erase(p);
+    // the slot hook unlinks itself, even from the timer thread's
+    // list of due events
+    delete &e;
+
+    return true;
+  }
+
+  // Reschedules a currently running event in the relative
+  // future. Must be called only from an event executed by this
+  // timer; see timer::reschedule_me().
+  //
+  // Returns an event id. If you had an event_id from the first
+  // scheduling, replace it with this return value.
+  std::uint64_t reschedule_me(typename TC::duration duration) {
+    return reschedule_me(TC::now() + duration);
+  }
+
+  // Reschedules a currently running event in the absolute
+  // future. Must be called only from an event executed by this
+  // timer; see timer::reschedule_me().
+  //
+  // Returns an event id. If you had an event_id from the first
+  // scheduling, replace it with this return value.
+  std::uint64_t reschedule_me(typename TC::time_point when) {
+    assert(std::this_thread::get_id() == thread.get_id());
+    std::lock_guard l(lock);
+    running->t = when;
+    std::uint64_t id = ++next_id;
+    running->id = id;
+    link(*running);
+    events.insert(events.end(), *running);
+
+    // Hacky, but keeps us from being deleted
+    running = nullptr;
+
+    // Same function, but you get a new ID.
+    return id;
+  }
+
+  // Remove all events from the queue.
+  void cancel_all_events() {
+    std::lock_guard l(lock);
+    while (!events.empty()) {
+      auto p = events.begin();
+      event& e = *p;
+      events.erase(p);
+      delete &e;
+    }
+  }
+}; // wheel_timer
 } // namespace ceph
 
 #endif
@@ -12,6 +12,7 @@
  *
  */
 
+#include <algorithm>
 #include <filesystem>
 #include "common/ceph_argparse.h"
 #include "common/common_init.h"
@@ -1067,9 +1068,15 @@ Option::value_t md_config_t::_get_val(
   }
 
   // In key names, leading and trailing whitespace are not significant.
-  string k(ConfFile::normalize_key_name(key));
-
-  const Option *o = find_option(k);
+  // Callers almost always pass the canonical name, so only pay for the
+  // normalized copy when there is whitespace to strip.
+  const Option *o;
+  if (std::none_of(key.begin(), key.end(),
+		   [](unsigned char c) { return std::isspace(c); })) {
+    o = find_option(key);
+  } else {
+    o = find_option(ConfFile::normalize_key_name(key));
+  }
   if (!o) {
     // not a valid config option
     return {};
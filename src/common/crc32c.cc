@@ -52,6 +52,21 @@ ceph_crc32c_func_t ceph_choose_crc32(void)
  */
 ceph_crc32c_func_t ceph_crc32c_func = ceph_choose_crc32();
 
+void ceph_crc32c_multi(unsigned count, uint32_t *crcs,
+		       unsigned char const *const *data,
+		       unsigned const *lengths)
+{
+#if (defined(__arm__) || defined(__aarch64__)) && defined(HAVE_ARMV8_CRC)
+  if (ceph_crc32c_func == ceph_crc32c_aarch64) {
+    ceph_crc32c_aarch64_multi(count, crcs, data, lengths);
+    return;
+  }
+#endif
+  for (unsigned i = 0; i < count; i++) {
+    crcs[i] = ceph_crc32c(crcs[i], data[i], lengths[i]);
+  }
+}
+
 
 /*
  * Look: http://crcutil.googlecode.com/files/crc-doc.1.0.pdf
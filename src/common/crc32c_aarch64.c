@@ -272,3 +272,48 @@ uint32_t ceph_crc32c_aarch64(uint32_t crc, unsigned char const *buffer, unsigned
 	}
 	return crc;
 }
+
+/*
+ * A single crc32cx chain is bound by the instruction's latency; with three
+ * independent buffers in flight the unit issues one every cycle.  Buffers
+ * of 1K and up already get that from the PMULL path above, so only
+ * interleave the shorter ones.
+ */
+void ceph_crc32c_aarch64_multi(unsigned count, uint32_t *crcs,
+			       unsigned char const *const *data,
+			       unsigned const *lengths)
+{
+	unsigned i = 0;
+
+	while (i + 3 <= count) {
+		if (!data[i] || !data[i + 1] || !data[i + 2] ||
+		    lengths[i] >= 1024 || lengths[i + 1] >= 1024 ||
+		    lengths[i + 2] >= 1024) {
+			crcs[i] = ceph_crc32c_aarch64(crcs[i], data[i], lengths[i]);
+			i++;
+			continue;
+		}
+		uint32_t crc0 = crcs[i], crc1 = crcs[i + 1], crc2 = crcs[i + 2];
+		const unsigned char *b0 = data[i], *b1 = data[i + 1], *b2 = data[i + 2];
+		unsigned common = lengths[i];
+		if (lengths[i + 1] < common)
+			common = lengths[i + 1];
+		if (lengths[i + 2] < common)
+			common = lengths[i + 2];
+		common &= ~(unsigned)(sizeof(uint64_t) - 1);
+		for (unsigned off = 0; off < common; off += sizeof(uint64_t)) {
+			CRC32CX(crc0, *(const uint64_t *)(b0 + off));
+			CRC32CX(crc1, *(const uint64_t *)(b1 + off));
+			CRC32CX(crc2, *(const uint64_t *)(b2 + off));
+		}
+		crcs[i] = ceph_crc32c_aarch64(crc0, b0 + common, lengths[i] - common);
+		crcs[i + 1] = ceph_crc32c_aarch64(crc1, b1 + common,
+						  lengths[i + 1] - common);
+		crcs[i + 2] = ceph_crc32c_aarch64(crc2, b2 + common,
+						  lengths[i + 2] - common);
+		i += 3;
+	}
+	for (; i < count; i++) {
+		crcs[i] = ceph_crc32c_aarch64(crcs[i], data[i], lengths[i]);
+	}
+}
@@ -11,6 +11,9 @@ extern "C" {
 #ifdef HAVE_ARMV8_CRC
 
 extern uint32_t ceph_crc32c_aarch64(uint32_t crc, unsigned char const *buffer, unsigned len);
+extern void ceph_crc32c_aarch64_multi(unsigned count, uint32_t *crcs,
+				      unsigned char const *const *data,
+				      unsigned const *lengths);
 
 #else
 
@@ -19,6 +22,12 @@ static inline uint32_t ceph_crc32c_aarch64(uint32_t crc, unsigned char const *bu
 	return 0;
 }
 
+static inline void ceph_crc32c_aarch64_multi(unsigned count, uint32_t *crcs,
+					     unsigned char const *const *data,
+					     unsigned const *lengths)
+{
+}
+
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,103 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ceph::common {
+
+/**
+ * frequency_sketch: a count-min sketch of recent access frequencies
+ *
+ * Keys are given as 64-bit hashes. Each key maps to one saturating 8-bit
+ * counter in each of 'depth' rows, and its frequency is estimated as the
+ * smallest of those counters; the estimate can only over-count, through
+ * collisions. To follow changing workloads, all counters are halved once
+ * 'sample_size' keys have been added since the last halving (the TinyLFU
+ * "reset"), so the estimates favour recent accesses.
+ *
+ * Memory use is 'width' * 'depth' bytes. Not thread-safe.
+ */
+class frequency_sketch {
+public:
+  static constexpr unsigned depth = 4;
+
+  /**
+   * @param width counters per row, rounded up to a power of two
+   * @param sample_size additions between halvings. Defaults to 10 times
+   *        the width.
+   */
+  explicit frequency_sketch(uint32_t width, uint64_t sample_size = 0)
+    : width(round_up(width)),
+      mask(this->width - 1),
+      sample_size(sample_size ? sample_size : 10ull * this->width),
+      counters(depth * this->width, 0) {}
+
+  void add(uint64_t hash) {
+    for (unsigned row = 0; row < depth; ++row) {
+      auto& c = counters[index(hash, row)];
+      if (c < std::numeric_limits<uint8_t>::max()) {
+	++c;
+      }
+    }
+    if (++additions >= sample_size) {
+      age();
+    }
+  }
+
+  unsigned estimate(uint64_t hash) const {
+    unsigned est = std::numeric_limits<uint8_t>::max();
+    for (unsigned row = 0; row < depth; ++row) {
+      est = std::min<unsigned>(est, counters[index(hash, row)]);
+    }
+    return est;
+  }
+
+  /// halve all counters
+  void age() {
+    for (auto& c : counters) {
+      c >>= 1;
+    }
+    additions = 0;
+  }
+
+  void clear() {
+    std::fill(counters.begin(), counters.end(), 0);
+    additions = 0;
+  }
+
+  uint32_t get_width() const {
+    return width;
+  }
+
+private:
+  const uint32_t width;
+  const uint32_t mask;
+  const uint64_t sample_size;
+  uint64_t additions = 0;
+  std::vector<uint8_t> counters;
+
+  static uint32_t round_up(uint32_t w) {
+    uint32_t r = 1;
+    while (r < w && r < (1u << 31)) {
+      r <<= 1;
+    }
+    return r;
+  }
+
+  size_t index(uint64_t hash, unsigned row) const {
+    // a different multiplicative mix of the key for each row
+    static constexpr uint64_t seeds[depth] = {
+      0x9e3779b97f4a7c15ull, 0xc2b2ae3d27d4eb4full,
+      0x165667b19e3779f9ull, 0xd6e8feb86659fd93ull};
+    uint64_t h = (hash + row) * seeds[row];
+    h ^= h >> 32;
+    return size_t(row) * width + (h & mask);
+  }
+};
+
+} // namespace ceph::common
@@ -112,9 +112,8 @@ class intrusive_lru {
     b.lru = this;
   }
 
-  void insert(base_t &b) {
+  void inserted(base_t &b) {
     assert(!b.lru);
-    lru_set.insert(b);
     b.lru = this;
     evict();
   }
@@ -140,7 +139,7 @@ public:
     if (missing) {
       auto ret = new T(k);
       lru_set.insert_commit(*ret, icd);
-      insert(*ret);
+      inserted(*ret);
       return {TRef(ret), false};
     } else {
       access(*iter);
@@ -295,6 +295,7 @@ int ObjBencher::aio_bench(
   data.max_latency = 0;
   data.avg_latency = 0;
   data.latency_diff_sum = 0;
+  data.latency_hist.clear();
   data.object_contents = contentsChars;
   lock.unlock();
 
@@ -363,6 +364,68 @@ void _aio_cb(void *cb, void *arg) {
   lc->lock->unlock();
 }
 
+void bench_latency_histogram::add(double seconds)
+{
+  uint64_t v = seconds > 0 ? static_cast<uint64_t>(seconds * 1000000.0) : 0;
+  size_t idx;
+  if (v < (1ull << SUB_BITS)) {
+    idx = v;
+  } else {
+    unsigned shift = 63 - __builtin_clzll(v) - SUB_BITS;
+    idx = ((size_t)(shift + 1) << SUB_BITS) +
+      ((v >> shift) - (1ull << SUB_BITS));
+  }
+  if (idx >= counts.size()) {
+    counts.resize(idx + 1);
+  }
+  ++counts[idx];
+  ++total;
+}
+
+double bench_latency_histogram::percentile(double p) const
+{
+  if (!total) {
+    return 0;
+  }
+  uint64_t target = std::max<uint64_t>(1, std::ceil(p / 100.0 * total));
+  uint64_t seen = 0;
+  for (size_t idx = 0; idx < counts.size(); ++idx) {
+    seen += counts[idx];
+    if (seen < target) {
+      continue;
+    }
+    uint64_t v;
+    if (idx < (1ull << SUB_BITS)) {
+      v = idx;
+    } else {
+      unsigned shift = (idx >> SUB_BITS) - 1;
+      uint64_t sub = idx & ((1ull << SUB_BITS) - 1);
+      // report the middle of the bucket
+      v = (((1ull << SUB_BITS) + sub) << shift) + ((1ull << shift) >> 1);
+    }
+    return v / 1000000.0;
+  }
+  return 0;
+}
+
+void ObjBencher::dump_latency_percentiles()
+{
+  static const std::pair<const char*, double> pcts[] = {
+    {"50", 50}, {"90", 90}, {"99", 99}, {"99.9", 99.9}, {"99.99", 99.99}
+  };
+  for (const auto& [name, p] : pcts) {
+    double lat = data.latency_hist.percentile(p);
+    if (formatter) {
+      formatter->dump_format(("p" + std::string(name) + "_latency").c_str(),
+			     "%f", lat);
+    } else {
+      std::string label = std::string("p") + name + " latency(s):";
+      out(cout) << label << std::string(label.size() < 24 ? 24 - label.size() : 1, ' ')
+		<< lat << std::endl;
+    }
+  }
+}
+
 int ObjBencher::fetch_bench_metadata(const std::string& metadata_file,
 				     uint64_t *op_size, uint64_t* object_size,
 				     int* num_ops, int* num_objects, int* prevPid) {
@@ -511,6 +574,7 @@ int ObjBencher::write_bench(int secondsToRun,
     }
     data.cur_latency = mono_clock::now() - start_times[slot];
     total_latency += data.cur_latency.count();
+    data.latency_hist.add(data.cur_latency.count());
     if( data.cur_latency.count() > data.max_latency)
       data.max_latency = data.cur_latency.count();
     if (data.cur_latency.count() < data.min_latency)
@@ -609,6 +673,7 @@ int ObjBencher::write_bench(int secondsToRun,
        << "Stddev Latency(s):      " << latency_stddev << std::endl
        << "Max latency(s):         " << data.max_latency << std::endl
        << "Min latency(s):         " << data.min_latency << std::endl;
+    dump_latency_percentiles();
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_writes_made", "%d", data.finished);
@@ -626,6 +691,7 @@ int ObjBencher::write_bench(int secondsToRun,
     formatter->dump_format("stddev_latency", "%f", latency_stddev);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles();
   }
   //write object size/number data for read benchmarks
   encode(data.object_size, b_write);
@@ -772,6 +838,7 @@ int ObjBencher::seq_read_bench(
       goto ERR;
     }
     total_latency += data.cur_latency.count();
+    data.latency_hist.add(data.cur_latency.count());
     if (data.cur_latency.count() > data.max_latency)
       data.max_latency = data.cur_latency.count();
     if (data.cur_latency.count() < data.min_latency)
@@ -831,6 +898,7 @@ int ObjBencher::seq_read_bench(
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
        << "Min latency(s):       " << data.min_latency << std::endl;
+    dump_latency_percentiles();
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -844,6 +912,7 @@ int ObjBencher::seq_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles();
   }
 
   completions_done();
@@ -967,6 +1036,7 @@ int ObjBencher::rand_read_bench(
     }
 
     total_latency += data.cur_latency.count();
+    data.latency_hist.add(data.cur_latency.count());
     if (data.cur_latency.count() > data.max_latency)
       data.max_latency = data.cur_latency.count();
     if (data.cur_latency.count() < data.min_latency)
@@ -1044,6 +1114,7 @@ int ObjBencher::rand_read_bench(
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
        << "Min latency(s):       " << data.min_latency << std::endl;
+    dump_latency_percentiles();
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -1057,6 +1128,7 @@ int ObjBencher::rand_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles();
   }
   completions_done();
 
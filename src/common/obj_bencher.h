@@ -19,6 +19,8 @@
 #include "common/Formatter.h"
 #include "ceph_time.h"
 #include <cfloat>
+#include <cstdint>
+#include <vector>
 
 using ceph::mono_clock;
 
@@ -35,6 +37,23 @@ struct bench_interval_data {
   double iops_diff_sum = 0;
 };
 
+// log-linear (HDR style) latency histogram: latencies are kept in
+// microseconds, and every power of two is split into 2^SUB_BITS linear
+// buckets, so percentiles are within ~1.6% of the recorded values
+struct bench_latency_histogram {
+  static constexpr unsigned SUB_BITS = 6;
+  std::vector<uint64_t> counts;
+  uint64_t total = 0;
+
+  void clear() {
+    counts.clear();
+    total = 0;
+  }
+  void add(double seconds);
+  // latency in seconds below which p percent of the samples fall
+  double percentile(double p) const;
+};
+
 struct bench_data {
   bool done; //is the benchmark is done
   uint64_t object_size; //the size of the objects
@@ -49,6 +68,7 @@ struct bench_data {
   double avg_latency;
   struct bench_interval_data idata; // data that is updated by time intervals and not by events
   double latency_diff_sum;
+  bench_latency_histogram latency_hist;
   std::chrono::duration<double> cur_latency; //latency of last completed transaction - in seconds by default
   mono_time start_time; //start time for benchmark - use the monotonic clock as we'll measure the passage of time
   char *object_contents; //pointer to the contents written to each object
@@ -74,6 +94,8 @@ protected:
 
   struct bench_data data;
 
+  void dump_latency_percentiles();
+
   int fetch_bench_metadata(const std::string& metadata_file, uint64_t* op_size,
 			   uint64_t* object_size, int* num_ops, int* num_objects, int* prev_pid);
 
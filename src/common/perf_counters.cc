@@ -168,7 +168,15 @@ void PerfCounters::inc(int idx, uint64_t amt)
   perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_U64))
     return;
-  if (data.type & PERFCOUNTER_LONGRUNAVG) {
+  if (auto slot = local_slot(idx - m_lower_bound - 1, data); slot) {
+    if (data.type & PERFCOUNTER_LONGRUNAVG) {
+      slot->avgcount++;
+      slot->u64 += amt;
+      slot->avgcount2++;
+    } else {
+      slot->u64.fetch_add(amt, std::memory_order_relaxed);
+    }
+  } else if (data.type & PERFCOUNTER_LONGRUNAVG) {
     data.avgcount++;
     data.u64 += amt;
     data.avgcount2++;
@@ -190,7 +198,12 @@ void PerfCounters::dec(int idx, uint64_t amt)
   ceph_assert(!(data.type & PERFCOUNTER_LONGRUNAVG));
   if (!(data.type & PERFCOUNTER_U64))
     return;
-  data.u64 -= amt;
+  if (auto slot = local_slot(idx - m_lower_bound - 1, data); slot) {
+    // wraps, but the sum over all shards comes out right
+    slot->u64.fetch_sub(amt, std::memory_order_relaxed);
+  } else {
+    data.u64 -= amt;
+  }
 }
 
 void PerfCounters::set(int idx, uint64_t amt)
@@ -208,6 +221,7 @@ void PerfCounters::set(int idx, uint64_t amt)
 
   ANNOTATE_BENIGN_RACE_SIZED(&data.u64, sizeof(data.u64),
                              "perf counter atomic");
+  clear_shards(idx - m_lower_bound - 1);
   if (data.type & PERFCOUNTER_LONGRUNAVG) {
     data.avgcount++;
     data.u64 = amt;
@@ -229,7 +243,7 @@ uint64_t PerfCounters::get(int idx) const
   const perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_U64))
     return 0;
-  return data.u64;
+  return read_u64(data);
 }
 
 void PerfCounters::tinc(int idx, utime_t amt)
@@ -244,7 +258,15 @@ void PerfCounters::tinc(int idx, utime_t amt)
   perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return;
-  if (data.type & PERFCOUNTER_LONGRUNAVG) {
+  if (auto slot = local_slot(idx - m_lower_bound - 1, data); slot) {
+    if (data.type & PERFCOUNTER_LONGRUNAVG) {
+      slot->avgcount++;
+      slot->u64 += amt.to_nsec();
+      slot->avgcount2++;
+    } else {
+      slot->u64.fetch_add(amt.to_nsec(), std::memory_order_relaxed);
+    }
+  } else if (data.type & PERFCOUNTER_LONGRUNAVG) {
     data.avgcount++;
     data.u64 += amt.to_nsec();
     data.avgcount2++;
@@ -265,7 +287,15 @@ void PerfCounters::tinc(int idx, ceph::timespan amt)
   perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return;
-  if (data.type & PERFCOUNTER_LONGRUNAVG) {
+  if (auto slot = local_slot(idx - m_lower_bound - 1, data); slot) {
+    if (data.type & PERFCOUNTER_LONGRUNAVG) {
+      slot->avgcount++;
+      slot->u64 += amt.count();
+      slot->avgcount2++;
+    } else {
+      slot->u64.fetch_add(amt.count(), std::memory_order_relaxed);
+    }
+  } else if (data.type & PERFCOUNTER_LONGRUNAVG) {
     data.avgcount++;
     data.u64 += amt.count();
     data.avgcount2++;
@@ -286,6 +316,7 @@ void PerfCounters::tset(int idx, utime_t amt)
   perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return;
+  clear_shards(idx - m_lower_bound - 1);
   data.u64 = amt.to_nsec();
   if (data.type & PERFCOUNTER_LONGRUNAVG)
     ceph_abort();
@@ -303,7 +334,7 @@ utime_t PerfCounters::tget(int idx) const
   const perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return utime_t();
-  uint64_t v = data.u64;
+  uint64_t v = read_u64(data);
   return utime_t(v / 1000000000ull, v % 1000000000ull);
 }
 
@@ -338,10 +369,73 @@ pair<uint64_t, uint64_t> PerfCounters::get_tavg_ns(int idx) const
     return make_pair(0, 0);
   if (!(data.type & PERFCOUNTER_LONGRUNAVG))
     return make_pair(0, 0);
-  pair<uint64_t,uint64_t> a = data.read_avg();
+  pair<uint64_t,uint64_t> a = read_avg(data);
   return make_pair(a.second, a.first);
 }
 
+namespace {
+// threads are spread over the shards in the order they first touch a
+// counter
+unsigned perf_thread_index()
+{
+  static std::atomic<unsigned> next_index = {0};
+  thread_local unsigned index = next_index++;
+  return index;
+}
+}
+
+PerfCounters::shard_slot_t *PerfCounters::local_slot(
+  size_t i, const perf_counter_data_any_d &data)
+{
+  if (!m_num_shards || !is_sharded_type(data.type)) {
+    return nullptr;
+  }
+  unsigned shard = perf_thread_index() % m_num_shards;
+  return &m_shards[shard * m_shard_stride + i];
+}
+
+void PerfCounters::clear_shards(size_t i)
+{
+  if (!m_num_shards || !is_sharded_type(m_data[i].type)) {
+    return;
+  }
+  for (unsigned shard = 0; shard < m_num_shards; ++shard) {
+    m_shards[shard * m_shard_stride + i].u64 = 0;
+  }
+}
+
+uint64_t PerfCounters::read_u64(const perf_counter_data_any_d &data) const
+{
+  uint64_t v = data.u64;
+  if (m_num_shards && is_sharded_type(data.type)) {
+    size_t i = &data - &m_data[0];
+    for (unsigned shard = 0; shard < m_num_shards; ++shard) {
+      v += m_shards[shard * m_shard_stride + i].u64;
+    }
+  }
+  return v;
+}
+
+pair<uint64_t, uint64_t> PerfCounters::read_avg(
+  const perf_counter_data_any_d &data) const
+{
+  auto a = data.read_avg();
+  if (m_num_shards && is_sharded_type(data.type)) {
+    size_t i = &data - &m_data[0];
+    for (unsigned shard = 0; shard < m_num_shards; ++shard) {
+      const shard_slot_t &slot = m_shards[shard * m_shard_stride + i];
+      uint64_t sum, count;
+      do {
+	count = slot.avgcount2;
+	sum = slot.u64;
+      } while (slot.avgcount != count);
+      a.first += sum;
+      a.second += count;
+    }
+  }
+  return a;
+}
+
 void PerfCounters::reset()
 {
   perf_counter_data_vec_t::iterator d = m_data.begin();
@@ -349,6 +443,16 @@ void PerfCounters::reset()
 
   while (d != d_end) {
     d->reset();
+    if (d->type != PERFCOUNTER_U64 && m_num_shards &&
+	is_sharded_type(d->type)) {
+      size_t i = d - m_data.begin();
+      for (unsigned shard = 0; shard < m_num_shards; ++shard) {
+	shard_slot_t &slot = m_shards[shard * m_shard_stride + i];
+	slot.u64 = 0;
+	slot.avgcount = 0;
+	slot.avgcount2 = 0;
+      }
+    }
     ++d;
   }
 }
@@ -421,7 +525,7 @@ void PerfCounters::dump_formatted_generic(Formatter *f, bool schema,
     } else {
       if (d->type & PERFCOUNTER_LONGRUNAVG) {
 	f->open_object_section(d->name);
-	pair<uint64_t,uint64_t> a = d->read_avg();
+	pair<uint64_t,uint64_t> a = read_avg(*d);
 	if (d->type & PERFCOUNTER_U64) {
 	  f->dump_unsigned("avgcount", a.second);
 	  f->dump_unsigned("sum", a.first);
@@ -451,7 +555,7 @@ void PerfCounters::dump_formatted_generic(Formatter *f, bool schema,
         d->histogram->dump_formatted(f);
         f->close_section();
       } else {
-	uint64_t v = d->u64;
+	uint64_t v = read_u64(*d);
 	if (d->type & PERFCOUNTER_U64) {
 	  f->dump_unsigned(d->name, v);
 	} else if (d->type & PERFCOUNTER_TIME) {
@@ -485,6 +589,17 @@ PerfCounters::PerfCounters(CephContext *cct, const std::string &name,
 #endif
 {
   m_data.resize(upper_bound - lower_bound - 1);
+#ifndef WITH_SEASTAR
+  if (cct) {
+    m_num_shards = cct->_conf->perf_counters_shards;
+  }
+#endif
+  if (m_num_shards) {
+    // pad each shard by more than a cacheline so that neighbouring
+    // shards never share one
+    m_shard_stride = m_data.size() + 3;
+    m_shards.reset(new shard_slot_t[m_num_shards * m_shard_stride]);
+  }
 }
 
 PerfCountersBuilder::PerfCountersBuilder(CephContext *cct, const std::string &name,
@@ -245,6 +245,12 @@ public:
 
   void hinc(int idx, int64_t x, int64_t y);
 
+  /// current value of a counter of this set, folding in its shards
+  uint64_t read_u64(const perf_counter_data_any_d &data) const;
+  /// the (sum, count) pair of a long-run average, folding in its shards
+  std::pair<uint64_t,uint64_t> read_avg(
+    const perf_counter_data_any_d &data) const;
+
   void reset();
   void dump_formatted(ceph::Formatter *f, bool schema,
                       const std::string &counter = "") const {
@@ -282,6 +288,25 @@ private:
 
   typedef std::vector<perf_counter_data_any_d> perf_counter_data_vec_t;
 
+  /**
+   * With perf_counters_shards, counters that are only ever added to keep
+   * per-shard partial sums that threads update instead of the shared
+   * perf_counter_data_any_d, so that counters bumped by every op do not
+   * bounce one cacheline between all cores. Readers add them up.
+   */
+  struct shard_slot_t {
+    std::atomic<uint64_t> u64 = { 0 };
+    std::atomic<uint64_t> avgcount = { 0 };
+    std::atomic<uint64_t> avgcount2 = { 0 };
+  };
+  static bool is_sharded_type(int type) {
+    return (type & (PERFCOUNTER_COUNTER | PERFCOUNTER_LONGRUNAVG)) &&
+      !(type & PERFCOUNTER_HISTOGRAM);
+  }
+  /// the calling thread's slot for counter i, or nullptr if not sharded
+  shard_slot_t *local_slot(size_t i, const perf_counter_data_any_d &data);
+  void clear_shards(size_t i);
+
   CephContext *m_cct;
   int m_lower_bound;
   int m_upper_bound;
@@ -297,6 +322,10 @@ private:
 
   perf_counter_data_vec_t m_data;
 
+  unsigned m_num_shards = 0;
+  size_t m_shard_stride = 0;
+  std::unique_ptr<shard_slot_t[]> m_shards;
+
   friend class PerfCountersBuilder;
   friend class PerfCountersCollectionImpl;
 };
@@ -46,15 +46,45 @@ public:
 private:
   using C = std::less<K>;
   using H = std::hash<K>;
-  ceph::unordered_map<K, typename std::list<std::pair<K, VPtr> >::iterator, H> contents;
-  std::list<std::pair<K, VPtr> > lru;
+  using lru_list_t = std::list<std::pair<K, VPtr> >;
+  struct lru_pos_t {
+    typename lru_list_t::iterator it;
+    bool hot = false;  ///< in the 'hot' segment
+  };
+  ceph::unordered_map<K, lru_pos_t, H> contents;
+  lru_list_t lru;
+
+  /**
+   * Segmented LRU: when 'hot_max' is set, entries that are hit again while
+   * cached are moved to the 'hot' segment, which holds up to 'hot_max'
+   * entries and is only evicted from when 'lru' is empty. Entries falling
+   * off the hot segment go back to the head of 'lru'. A scan of entries
+   * that are used once can thus not push out frequently used ones.
+   */
+  lru_list_t hot;
+  size_t hot_max = 0;
+  unsigned hot_size = 0;
 
   std::map<K, std::pair<WeakVPtr, V*>, C> weak_refs;
 
+  /// the next entry to evict
+  const std::pair<K, VPtr>& lru_victim() const {
+    return lru.empty() ? hot.back() : lru.back();
+  }
+
+  void trim_hot() {
+    while (hot_size > hot_max) {
+      auto victim = std::prev(hot.end());
+      contents[victim->first].hot = false;
+      --hot_size;
+      lru.splice(lru.begin(), hot, victim);
+    }
+  }
+
   void trim_cache(std::list<VPtr> *to_release) {
     while (size > max_size) {
-      to_release->push_back(lru.back().second);
-      lru_remove(lru.back().first);
+      to_release->push_back(lru_victim().second);
+      lru_remove(lru_victim().first);
     }
   }
 
@@ -62,7 +92,12 @@ private:
     auto i = contents.find(key);
     if (i == contents.end())
       return;
-    lru.erase(i->second);
+    if (i->second.hot) {
+      hot.erase(i->second.it);
+      --hot_size;
+    } else {
+      lru.erase(i->second.it);
+    }
     --size;
     contents.erase(i);
   }
@@ -70,11 +105,21 @@ private:
   void lru_add(const K& key, const VPtr& val, std::list<VPtr> *to_release) {
     auto i = contents.find(key);
     if (i != contents.end()) {
-      lru.splice(lru.begin(), lru, i->second);
+      auto& pos = i->second;
+      if (pos.hot) {
+	hot.splice(hot.begin(), hot, pos.it);
+      } else if (hot_max) {
+	hot.splice(hot.begin(), lru, pos.it);
+	pos.hot = true;
+	++hot_size;
+	trim_hot();
+      } else {
+	lru.splice(lru.begin(), lru, pos.it);
+      }
     } else {
       ++size;
       lru.push_front(make_pair(key, val));
-      contents[key] = lru.begin();
+      contents[key] = lru_pos_t{lru.begin()};
       trim_cache(to_release);
     }
   }
@@ -111,6 +156,7 @@ public:
   ~SharedLRU() {
     contents.clear();
     lru.clear();
+    hot.clear();
     if (!weak_refs.empty()) {
       lderr(cct) << "leaked refs:\n";
       dump_weak_refs(*_dout);
@@ -153,8 +199,8 @@ public:
       if (size == 0)
         break;
 
-      val = lru.back().second;
-      lru_remove(lru.back().first);
+      val = lru_victim().second;
+      lru_remove(lru_victim().first);
     }
   }
 
@@ -209,6 +255,14 @@ public:
     }
   }
 
+  /// the number of entries protected from scans (see 'hot'). 0 disables
+  /// the hot segment.
+  void set_hot_size(size_t new_size) {
+    std::lock_guard l{lock};
+    hot_max = new_size;
+    trim_hot();
+  }
+
   // Returns K key s.t. key <= k for all currently cached k,v
   K cached_key_lower_bound() {
     std::lock_guard l{lock};
@@ -19,7 +19,9 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 #include "include/ceph_assert.h"    // boost clobbers this
+#include "common/ceph_time.h"
 #include "include/common_fwd.h"
 #include "include/buffer.h"
 #include "include/int_types.h"
@@ -91,6 +93,25 @@ public:
     return alg;
   }
   virtual int compress(const ceph::bufferlist &in, ceph::bufferlist &out, std::optional<int32_t> &compressor_message) = 0;
+
+  // one independent buffer for compress_batch()
+  struct compress_job_t {
+    const ceph::bufferlist *in = nullptr;
+    ceph::bufferlist out;
+    std::optional<int32_t> compressor_message;
+    int r = 0;
+    ceph::timespan lat = ceph::timespan::zero();  // time spent on this job
+  };
+  // Compress several buffers, returning once all of them are done.
+  // Accelerated implementations keep the jobs in flight together; the
+  // default compresses them one after the other.
+  virtual void compress_batch(std::vector<compress_job_t> &jobs) {
+    for (auto &j : jobs) {
+      auto start = ceph::mono_clock::now();
+      j.r = compress(*j.in, j.out, j.compressor_message);
+      j.lat = ceph::mono_clock::now() - start;
+    }
+  }
   virtual int decompress(const ceph::bufferlist &in, ceph::bufferlist &out, std::optional<int32_t> compressor_message) = 0;
   // this is a bit weird but we need non-const iterator to be in
   // alignment with decode methods
@@ -126,6 +126,14 @@ QatAccel::session_ptr QatAccel::get_session() {
 QatAccel::QatAccel() {}
 
 QatAccel::~QatAccel() {
+  {
+    std::scoped_lock lock{batch_mutex};
+    workers_stop = true;
+  }
+  batch_cond.notify_all();
+  for (auto &w : workers) {
+    w.join();
+  }
   // First, we should uninitialize all QATzip session that disconnects all session
   // from a hardware instance and deallocates buffers.
   sessions.clear();
@@ -181,6 +189,68 @@ int QatAccel::compress(const bufferlist &in, bufferlist &out, std::optional<int3
   return 0;
 }
 
+void QatAccel::start_workers() {
+  uint64_t n = g_ceph_context->_conf.get_val<uint64_t>("qat_compressor_batch_threads");
+  dout(10) << "starting " << n << " batch workers" << dendl;
+  for (uint64_t i = 0; i < n; i++) {
+    workers.emplace_back(&QatAccel::worker_entry, this);
+  }
+}
+
+void QatAccel::worker_entry() {
+  std::unique_lock lock{batch_mutex};
+  while (true) {
+    batch_cond.wait(lock, [this] { return workers_stop || !batch_queue.empty(); });
+    if (batch_queue.empty()) {
+      return; // stopping
+    }
+    auto task = std::move(batch_queue.front());
+    batch_queue.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
+
+void QatAccel::run_batch(std::vector<std::function<void()>> &tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+  std::mutex done_mutex;
+  std::condition_variable done_cond;
+  size_t left = tasks.size() - 1;
+  {
+    std::scoped_lock lock{batch_mutex};
+    if (workers.empty()) {
+      start_workers();
+    }
+    if (workers.empty()) {
+      left = 0;
+    } else {
+      for (size_t i = 1; i < tasks.size(); i++) {
+        batch_queue.emplace_back([&, i] {
+          tasks[i]();
+          std::scoped_lock l{done_mutex};
+          if (--left == 0) {
+            done_cond.notify_one();
+          }
+        });
+      }
+    }
+  }
+  if (left) {
+    batch_cond.notify_all();
+    tasks[0]();
+    std::unique_lock l{done_mutex};
+    done_cond.wait(l, [&] { return left == 0; });
+  } else {
+    // no workers configured
+    for (auto &t : tasks) {
+      t();
+    }
+  }
+}
+
 int QatAccel::decompress(const bufferlist &in, bufferlist &out, std::optional<int32_t> compressor_message) {
   auto i = in.begin();
   return decompress(i, in.length(), out, compressor_message);
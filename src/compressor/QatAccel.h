@@ -16,9 +16,12 @@
 #define CEPH_QATACCEL_H
 
 #include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <thread>
 #include <vector>
 
 #include "include/buffer.h"
@@ -41,6 +44,10 @@ class QatAccel {
   int decompress(const bufferlist &in, bufferlist &out, std::optional<int32_t> compressor_message);
   int decompress(bufferlist::const_iterator &p, size_t compressed_len, bufferlist &dst, std::optional<int32_t> compressor_message);
 
+  // run the tasks concurrently on the batch workers, each one driving its
+  // own session, and wait for all of them
+  void run_batch(std::vector<std::function<void()>> &tasks);
+
  private:
   // get a session from the pool or create a new one. returns null if session init fails
   session_ptr get_session();
@@ -49,6 +56,15 @@ class QatAccel {
   std::vector<session_ptr> sessions;
   std::mutex mutex;
   std::string alg_name;
+
+  void start_workers();
+  void worker_entry();
+
+  std::mutex batch_mutex;
+  std::condition_variable batch_cond;
+  std::deque<std::function<void()>> batch_queue;
+  std::vector<std::thread> workers;
+  bool workers_stop = false;
 };
 
 #endif
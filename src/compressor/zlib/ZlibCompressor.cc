@@ -168,6 +168,26 @@ int ZlibCompressor::isal_compress(const bufferlist &in, bufferlist &out, std::op
 }
 #endif
 
+#ifdef HAVE_QATZIP
+void ZlibCompressor::compress_batch(std::vector<compress_job_t> &jobs)
+{
+  if (!qat_enabled || jobs.size() < 2) {
+    Compressor::compress_batch(jobs);
+    return;
+  }
+  std::vector<std::function<void()>> tasks;
+  tasks.reserve(jobs.size());
+  for (auto &j : jobs) {
+    tasks.emplace_back([&j] {
+      auto start = ceph::mono_clock::now();
+      j.r = qat_accel.compress(*j.in, j.out, j.compressor_message);
+      j.lat = ceph::mono_clock::now() - start;
+    });
+  }
+  qat_accel.run_batch(tasks);
+}
+#endif
+
 int ZlibCompressor::compress(const bufferlist &in, bufferlist &out, std::optional<int32_t> &compressor_message)
 {
 #ifdef HAVE_QATZIP
@@ -35,6 +35,9 @@ public:
   }
 
   int compress(const ceph::buffer::list &in, ceph::buffer::list &out, std::optional<int32_t> &compressor_message) override;
+#ifdef HAVE_QATZIP
+  void compress_batch(std::vector<compress_job_t> &jobs) override;
+#endif
   int decompress(const ceph::buffer::list &in, ceph::buffer::list &out, std::optional<int32_t> compressor_message) override;
   int decompress(ceph::buffer::list::const_iterator &p, size_t compressed_len, ceph::buffer::list &out, std::optional<int32_t> compressor_message) override;
 private:
@@ -1519,6 +1519,10 @@ segment_id_t SegmentCleaner::get_next_reclaim_segment() const
       if (benefit_cost > max_benefit_cost) {
         id = _id;
         max_benefit_cost = benefit_cost;
+        if (benefit_cost == std::numeric_limits<double>::max()) {
+          // an empty segment is free to reclaim, nothing can beat it
+          break;
+        }
       }
     }
   }
@@ -1021,23 +1021,50 @@ private:
   friend class crimson::os::seastore::backref::BtreeBackrefManager;
   friend class crimson::os::seastore::BackrefManager;
   /**
-   * lru
+   * LRU
    *
-   * holds references to recently used extents
+   * Segmented LRU of clean extents.  Extents enter the probationary
+   * segment and are promoted to the protected segment when touched again,
+   * so a single pass over many extents (e.g. a large data scan) only
+   * cycles through probation and does not evict the repeatedly accessed
+   * btree nodes.  Eviction drains probation first; the protected segment
+   * is bounded to PROTECTED_RATIO of the capacity and demotes its coldest
+   * extents back into probation.
    */
   class LRU {
+    static constexpr double PROTECTED_RATIO = 0.8;
+
     // max size (bytes)
     const size_t capacity = 0;
 
+    // max size of the protected segment (bytes)
+    const size_t protected_capacity = 0;
+
     // current size (bytes)
     size_t contents = 0;
 
-    CachedExtent::list lru;
+    // current size of the protected segment (bytes)
+    size_t protected_contents = 0;
+
+    CachedExtent::list probation;
+    CachedExtent::list protected_lru;
 
     void trim_to_capacity() {
+      while (protected_contents > protected_capacity) {
+	assert(protected_lru.size() > 0);
+	auto &extent = protected_lru.front();
+	protected_lru.pop_front();
+	protected_contents -= extent.get_length();
+	extent.lru_protected = false;
+	probation.push_back(extent);
+      }
       while (contents > capacity) {
-	assert(lru.size() > 0);
-	remove_from_lru(lru.front());
+	if (probation.size() > 0) {
+	  remove_from_lru(probation.front());
+	} else {
+	  assert(protected_lru.size() > 0);
+	  remove_from_lru(protected_lru.front());
+	}
       }
     }
 
@@ -1047,13 +1074,16 @@ private:
       if (!extent.primary_ref_list_hook.is_linked()) {
 	contents += extent.get_length();
 	intrusive_ptr_add_ref(&extent);
-	lru.push_back(extent);
+	extent.lru_protected = false;
+	probation.push_back(extent);
       }
       trim_to_capacity();
     }
 
   public:
-    LRU(size_t capacity) : capacity(capacity) {}
+    LRU(size_t capacity)
+      : capacity(capacity),
+	protected_capacity(capacity * PROTECTED_RATIO) {}
 
     size_t get_capacity() const {
       return capacity;
@@ -1064,14 +1094,21 @@ private:
     }
 
     size_t get_current_contents_extents() const {
-      return lru.size();
+      return probation.size() + protected_lru.size();
     }
 
     void remove_from_lru(CachedExtent &extent) {
       assert(extent.is_clean() && !extent.is_placeholder());
 
       if (extent.primary_ref_list_hook.is_linked()) {
-	lru.erase(lru.s_iterator_to(extent));
+	if (extent.lru_protected) {
+	  protected_lru.erase(protected_lru.s_iterator_to(extent));
+	  assert(protected_contents >= extent.get_length());
+	  protected_contents -= extent.get_length();
+	  extent.lru_protected = false;
+	} else {
+	  probation.erase(probation.s_iterator_to(extent));
+	}
 	assert(contents >= extent.get_length());
 	contents -= extent.get_length();
 	intrusive_ptr_release(&extent);
@@ -1081,20 +1118,30 @@ private:
     void move_to_top(CachedExtent &extent) {
       assert(extent.is_clean() && !extent.is_placeholder());
 
-      if (extent.primary_ref_list_hook.is_linked()) {
-	lru.erase(lru.s_iterator_to(extent));
-	intrusive_ptr_release(&extent);
-	assert(contents >= extent.get_length());
-	contents -= extent.get_length();
+      if (!extent.primary_ref_list_hook.is_linked()) {
+	add_to_lru(extent);
+	return;
+      }
+      if (extent.lru_protected) {
+	protected_lru.erase(protected_lru.s_iterator_to(extent));
+	protected_lru.push_back(extent);
+      } else {
+	// second access, promote
+	probation.erase(probation.s_iterator_to(extent));
+	extent.lru_protected = true;
+	protected_lru.push_back(extent);
+	protected_contents += extent.get_length();
+	trim_to_capacity();
       }
-      add_to_lru(extent);
     }
 
     void clear() {
       LOG_PREFIX(Cache::LRU::clear);
-      for (auto iter = lru.begin(); iter != lru.end();) {
-	SUBDEBUG(seastore_cache, "clearing {}", *iter);
-	remove_from_lru(*(iter++));
+      for (auto *segment : {&probation, &protected_lru}) {
+	for (auto iter = segment->begin(); iter != segment->end();) {
+	  SUBDEBUG(seastore_cache, "clearing {}", *iter);
+	  remove_from_lru(*(iter++));
+	}
       }
     }
 
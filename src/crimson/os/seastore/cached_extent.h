@@ -461,6 +461,10 @@ private:
     CachedExtent,
     primary_ref_list_member_options>;
 
+  /// whether a clean extent linked via primary_ref_list_hook is in the
+  /// protected segment of Cache::LRU rather than the probationary one
+  bool lru_protected = false;
+
   /**
    * dirty_from_or_retired_at
    *
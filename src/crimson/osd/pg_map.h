@@ -5,6 +5,7 @@
 
 #include <map>
 #include <algorithm>
+#include <unordered_map>
 
 #include <seastar/core/future.hh>
 #include <seastar/core/shared_future.hh>
@@ -92,7 +93,8 @@ public:
 
 private:
   std::map<core_id_t, unsigned> core_to_num_pgs;
-  std::map<spg_t, core_id_t> pg_to_core;
+  // looked up for every client op dispatched from the primary core
+  std::unordered_map<spg_t, core_id_t> pg_to_core;
 };
 
 /**
@@ -482,7 +482,9 @@ int CrushTester::test(CephContext* cct)
 
   if (output_choose_tries)
     crush.start_choose_profile();
-  
+
+  // the map does not change from here on; share one crush workspace
+  CrushWrapper::Workspace ws;
   for (int r = min_rule; r < crush.get_max_rules() && r <= max_rule; r++) {
     ldout(cct, 20) << "rule: " << r << dendl;
 
@@ -581,7 +583,7 @@ int CrushTester::test(CephContext* cct)
             if (pool_id != -1) {
               real_x = crush_hash32_2(CRUSH_HASH_RJENKINS1, x, (uint32_t)pool_id);
             }
-            crush.do_rule(r, real_x, out, nr, weight, 0);
+            crush.do_rule(r, real_x, out, nr, weight, 0, ws);
           } else {
             if (output_mappings)
 	      err << "RNG"; // prepend RNG to placement output to denote simulation
@@ -1527,6 +1527,66 @@ public:
       out[i] = rawout[i];
   }
 
+  /**
+   * Scratch space that do_rule() can keep between calls.
+   *
+   * Setting up the per-bucket workspace costs time proportional to the
+   * size of the map, which dominates mapping a single input on large
+   * maps.  Callers that map many inputs in a row pass one of these to
+   * pay for it, and for the choose_args lookup, only once.  It must
+   * not outlive the map, nor be used across changes to it.
+   */
+  class Workspace {
+    friend class CrushWrapper;
+    const crush_map *map = nullptr;
+    int maxout = 0;
+    std::vector<char> work;
+    std::vector<int> rawout;
+    bool have_arg_map = false;
+    uint64_t choose_args_index = 0;
+    crush_choose_arg_map arg_map;
+  };
+
+  template<typename WeightVector>
+  void do_rule(int rule, int x, std::vector<int>& out, int maxout,
+	       const WeightVector& weight,
+	       uint64_t choose_args_index,
+	       Workspace& ws) const {
+    if (ws.map != crush || ws.maxout < maxout) {
+      ws.map = crush;
+      ws.maxout = maxout;
+      // vector storage is suitably aligned for the crush_work structs
+      ws.work.resize(crush_work_size(crush, maxout));
+      crush_init_workspace(crush, ws.work.data());
+      ws.rawout.resize(maxout);
+      ws.have_arg_map = false;
+    }
+    if (!ws.have_arg_map || ws.choose_args_index != choose_args_index) {
+      ws.arg_map = choose_args_get_with_fallback(choose_args_index);
+      ws.choose_args_index = choose_args_index;
+      ws.have_arg_map = true;
+    }
+    int numrep = crush_do_rule(crush, rule, x, ws.rawout.data(), maxout,
+			       std::data(weight), std::size(weight),
+			       ws.work.data(), ws.arg_map.args);
+    if (numrep < 0)
+      numrep = 0;
+    out.assign(ws.rawout.begin(), ws.rawout.begin() + numrep);
+  }
+
+  /// map each of xs through rule; out[i] is the result for xs[i]
+  template<typename WeightVector>
+  void do_rule_batch(int rule, const std::vector<int>& xs,
+		     std::vector<std::vector<int>>& out, int maxout,
+		     const WeightVector& weight,
+		     uint64_t choose_args_index) const {
+    Workspace ws;
+    out.resize(xs.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+      do_rule(rule, xs[i], out[i], maxout, weight, choose_args_index, ws);
+    }
+  }
+
   int _choose_type_stack(
     CephContext *cct,
     const std::vector<std::pair<int,int>>& stack,
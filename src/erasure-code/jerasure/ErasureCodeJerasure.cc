@@ -137,6 +137,68 @@ int ErasureCodeJerasure::decode_chunks(const set<int> &want_to_read,
   return jerasure_decode(erasures, data, coding, blocksize);
 }
 
+int ErasureCodeJerasure::matrix_decode(int *matrix, int *erasures,
+				       char **data, char **coding,
+				       int blocksize)
+{
+  std::vector<int> erased(k + m, 0);
+  int num_erased = 0;
+  for (int *e = erasures; *e != -1; ++e) {
+    if (!erased[*e]) {
+      erased[*e] = 1;
+      num_erased++;
+    }
+  }
+  if (num_erased > m)
+    return -1;
+
+  int edd = 0;
+  int lastdrive = k;
+  for (int i = 0; i < k; i++) {
+    if (erased[i]) {
+      edd++;
+      lastdrive = i;
+    }
+  }
+  if (erased[k])
+    lastdrive = k;
+
+  decoding_matrix_t decoding;
+  if (edd > 1 || (edd > 0 && erased[k])) {
+    if (!decoding_cache.find(erased, decoding)) {
+      decoding.matrix.resize(k * k);
+      decoding.dm_ids.resize(k);
+      if (jerasure_make_decoding_matrix(k, m, w, matrix, erased.data(),
+					decoding.matrix.data(),
+					decoding.dm_ids.data()) < 0)
+	return -1;
+      decoding_cache.add(erased, decoding);
+    }
+  }
+
+  for (int i = 0; edd > 0 && i < lastdrive; i++) {
+    if (erased[i]) {
+      jerasure_matrix_dotprod(k, w, decoding.matrix.data() + i * k,
+			      decoding.dm_ids.data(), i, data, coding,
+			      blocksize);
+      edd--;
+    }
+  }
+  if (edd > 0) {
+    std::vector<int> tmpids(k);
+    for (int i = 0; i < k; i++)
+      tmpids[i] = (i < lastdrive) ? i : i + 1;
+    jerasure_matrix_dotprod(k, w, matrix, tmpids.data(), lastdrive,
+			    data, coding, blocksize);
+  }
+  for (int i = 0; i < m; i++) {
+    if (erased[k + i])
+      jerasure_matrix_dotprod(k, w, matrix + i * k, NULL, i + k,
+			      data, coding, blocksize);
+  }
+  return 0;
+}
+
 bool ErasureCodeJerasure::is_prime(int value)
 {
   int prime55[] = {
@@ -167,8 +229,7 @@ int ErasureCodeJerasureReedSolomonVandermonde::jerasure_decode(int *erasures,
                                                                 char **coding,
                                                                 int blocksize)
 {
-  return jerasure_matrix_decode(k, m, w, matrix, 1,
-				erasures, data, coding, blocksize);
+  return matrix_decode(matrix, erasures, data, coding, blocksize);
 }
 
 unsigned ErasureCodeJerasureReedSolomonVandermonde::get_alignment() const
@@ -218,7 +279,7 @@ int ErasureCodeJerasureReedSolomonRAID6::jerasure_decode(int *erasures,
 							 char **coding,
 							 int blocksize)
 {
-  return jerasure_matrix_decode(k, m, w, matrix, 1, erasures, data, coding, blocksize);
+  return matrix_decode(matrix, erasures, data, coding, blocksize);
 }
 
 unsigned ErasureCodeJerasureReedSolomonRAID6::get_alignment() const
@@ -18,6 +18,9 @@
 #ifndef CEPH_ERASURE_CODE_JERASURE_H
 #define CEPH_ERASURE_CODE_JERASURE_H
 
+#include <vector>
+
+#include "common/lru_map.h"
 #include "erasure-code/ErasureCode.h"
 
 class ErasureCodeJerasure : public ceph::ErasureCode {
@@ -77,6 +80,19 @@ public:
   static bool is_prime(int value);
 protected:
   virtual int parse(ceph::ErasureCodeProfile &profile, std::ostream *ss);
+
+  // decoding matrices by erasure pattern, so that repeated decodes of the
+  // same set of missing chunks do not invert the coding matrix again
+  struct decoding_matrix_t {
+    std::vector<int> matrix;
+    std::vector<int> dm_ids;
+  };
+  static constexpr int DECODING_CACHE_SIZE = 2516;
+  lru_map<std::vector<int>, decoding_matrix_t> decoding_cache{DECODING_CACHE_SIZE};
+
+  /// equivalent to jerasure_matrix_decode() with row_k_ones set
+  int matrix_decode(int *matrix, int *erasures,
+		    char **data, char **coding, int blocksize);
 };
 class ErasureCodeJerasureReedSolomonVandermonde : public ErasureCodeJerasure {
 public:
@@ -82,6 +82,23 @@ std::string quote(std::string value) { return "\"" + value + "\""; }
 
 bool is_hyphen(char ch) { return ch == '-'; }
 
+// perf dump and perf schema have the same groups and counters, so a change
+// in the shape of the dump means the cached schema is stale
+static bool schema_matches_dump(const json_object &schema,
+                                const json_object &dump) {
+  if (schema.size() != dump.size()) {
+    return false;
+  }
+  for (auto &group : schema) {
+    auto *dump_group = dump.if_contains(group.key());
+    if (!dump_group || !dump_group->is_object() ||
+        dump_group->get_object().size() != group.value().as_object().size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void DaemonMetricCollector::dump_asok_metrics() {
   BlockTimer timer(__FILE__, __FUNCTION__);
 
@@ -96,6 +113,7 @@ void DaemonMetricCollector::dump_asok_metrics() {
     builder =
         std::unique_ptr<UnorderedMetricsBuilder>(new UnorderedMetricsBuilder());
   }
+  auto prio_limit = g_conf().get_val<int64_t>("exporter_prio_limit");
   for (auto &[daemon_name, sock_client] : clients) {
     bool ok;
     sock_client.ping(&ok);
@@ -109,40 +127,57 @@ void DaemonMetricCollector::dump_asok_metrics() {
       failures++;
       continue;
     }
-    std::string perf_schema_response =
-        asok_request(sock_client, "perf schema", daemon_name);
-    if (perf_schema_response.size() == 0) {
-      failures++;
-      continue;
-    }
-    std::string config_show =
-        asok_request(sock_client, "config show", daemon_name);
-    if (config_show.size() == 0) {
-      failures++;
-      continue;
+    json_object dump = boost::json::parse(perf_dump_response).as_object();
+    auto cached = daemon_cache.find(daemon_name);
+    if (cached == daemon_cache.end() ||
+        !schema_matches_dump(cached->second.schema, dump)) {
+      std::string perf_schema_response =
+          asok_request(sock_client, "perf schema", daemon_name);
+      if (perf_schema_response.size() == 0) {
+        daemon_cache.erase(daemon_name);
+        failures++;
+        continue;
+      }
+      std::string config_show =
+          asok_request(sock_client, "config show", daemon_name);
+      if (config_show.size() == 0) {
+        daemon_cache.erase(daemon_name);
+        failures++;
+        continue;
+      }
+      json_object pid_file_json = boost::json::parse(config_show).as_object();
+      daemon_cache_t entry;
+      entry.pid_path =
+          boost_string_to_std(pid_file_json["pid_file"].as_string());
+      entry.schema = boost::json::parse(perf_schema_response).as_object();
+      cached = daemon_cache.insert_or_assign(daemon_name, std::move(entry)).first;
+      if (!cached->second.pid_path.size()) {
+        dout(1) << "pid path is empty; process metrics won't be fetched for: "
+                << daemon_name << dendl;
+      }
     }
-    json_object pid_file_json = boost::json::parse(config_show).as_object();
-    std::string pid_path =
-        boost_string_to_std(pid_file_json["pid_file"].as_string());
+    const std::string &pid_path = cached->second.pid_path;
     std::string pid_str = read_file_to_string(pid_path);
-    if (!pid_path.size()) {
-      dout(1) << "pid path is empty; process metrics won't be fetched for: "
-              << daemon_name << dendl;
-    }
     if (!pid_str.empty()) {
       daemon_pids.push_back({daemon_name, std::stoi(pid_str)});
     }
-    json_object dump = boost::json::parse(perf_dump_response).as_object();
-    json_object schema = boost::json::parse(perf_schema_response).as_object();
-    for (auto &perf : schema) {
+    for (auto &perf : cached->second.schema) {
       std::string perf_group = {perf.key().begin(), perf.key().end()};
-      json_object perf_group_object = perf.value().as_object();
+      const json_object &perf_group_object = perf.value().as_object();
+      auto *dump_group_value = dump.if_contains(perf.key());
+      if (!dump_group_value || !dump_group_value->is_object()) {
+        continue;
+      }
+      const json_object &dump_group = dump_group_value->get_object();
       for (auto &perf_counter : perf_group_object) {
         std::string perf_name = {perf_counter.key().begin(),
                                  perf_counter.key().end()};
-        json_object perf_info = perf_counter.value().as_object();
-        auto prio_limit = g_conf().get_val<int64_t>("exporter_prio_limit");
-        if (perf_info["priority"].as_int64() < prio_limit) {
+        const json_object &perf_info = perf_counter.value().as_object();
+        if (perf_info.at("priority").as_int64() < prio_limit) {
+          continue;
+        }
+        auto *perf_values = dump_group.if_contains(perf_counter.key());
+        if (!perf_values) {
           continue;
         }
         std::string name = "ceph_" + perf_group + "_" + perf_name;
@@ -153,8 +188,7 @@ void DaemonMetricCollector::dump_asok_metrics() {
         labels_t labels = labels_and_name.first;
         name = labels_and_name.second;
 
-        json_value perf_values = dump[perf_group].as_object()[perf_name];
-        dump_asok_metric(perf_info, perf_values, name, labels);
+        dump_asok_metric(perf_info, *perf_values, name, labels);
       }
     }
   }
@@ -294,21 +328,21 @@ DaemonMetricCollector::get_labels_and_metric_name(std::string daemon_name,
 perf_values can be either a int/double or a json_object. Since
    json_value is a wrapper of both we use that class.
  */
-void DaemonMetricCollector::dump_asok_metric(json_object perf_info,
-                                             json_value perf_values,
+void DaemonMetricCollector::dump_asok_metric(const json_object &perf_info,
+                                             const json_value &perf_values,
                                              std::string name,
                                              labels_t labels) {
-  int64_t type = perf_info["type"].as_int64();
+  int64_t type = perf_info.at("type").as_int64();
   std::string metric_type =
-      boost_string_to_std(perf_info["metric_type"].as_string());
+      boost_string_to_std(perf_info.at("metric_type").as_string());
   std::string description =
-      boost_string_to_std(perf_info["description"].as_string());
+      boost_string_to_std(perf_info.at("description").as_string());
 
   if (type & PERFCOUNTER_LONGRUNAVG) {
-    int64_t count = perf_values.as_object()["avgcount"].as_int64();
+    int64_t count = perf_values.as_object().at("avgcount").as_int64();
     add_metric(builder, count, name + "_count", description, metric_type,
                labels);
-    json_value sum_value = perf_values.as_object()["sum"];
+    json_value sum_value = perf_values.as_object().at("sum");
     add_double_or_int_metric(builder, sum_value, name + "_sum", description,
                              metric_type, labels);
   } else if (type & PERFCOUNTER_TIME) {
@@ -346,6 +380,14 @@ void DaemonMetricCollector::update_sockets() {
       }
     }
   }
+  // forget daemons whose socket went away
+  for (auto it = daemon_cache.begin(); it != daemon_cache.end();) {
+    if (clients.count(it->first)) {
+      ++it;
+    } else {
+      it = daemon_cache.erase(it);
+    }
+  }
 }
 
 void OrderedMetricsBuilder::add(std::string value, std::string name,
@@ -40,12 +40,19 @@ private:
   std::string metrics;
   std::mutex metrics_mutex;
   std::unique_ptr<MetricsBuilder> builder;
+  // per-daemon admin socket responses that rarely change; refetched when a
+  // perf dump no longer lines up with the cached schema
+  struct daemon_cache_t {
+    boost::json::object schema;
+    std::string pid_path;
+  };
+  std::map<std::string, daemon_cache_t> daemon_cache;
   void update_sockets();
   void request_loop(boost::asio::steady_timer &timer);
 
   void dump_asok_metrics();
-  void dump_asok_metric(boost::json::object perf_info,
-                        boost::json::value perf_values, std::string name,
+  void dump_asok_metric(const boost::json::object &perf_info,
+                        const boost::json::value &perf_values, std::string name,
                         labels_t labels);
   std::pair<labels_t, std::string>
   get_labels_and_metric_name(std::string daemon_name, std::string metric_name);
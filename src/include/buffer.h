@@ -370,6 +370,11 @@ struct error_code;
 
     ~ptr_node() = default;
 
+    // nodes come and go with every append and splice; each thread keeps
+    // a few freed ones around instead of going back to malloc
+    static void* operator new(std::size_t size);
+    static void operator delete(void* p);
+
     static std::unique_ptr<ptr_node, disposer>
     create(ceph::unique_leakable_ptr<raw> r) {
       return create_hypercombined(std::move(r));
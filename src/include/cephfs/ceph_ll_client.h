@@ -14,6 +14,7 @@
 #ifndef CEPH_CEPH_LL_CLIENT_H
 #define CEPH_CEPH_LL_CLIENT_H
 #include <stdint.h>
+#include <stdbool.h>
 
 #ifdef _WIN32
 #include "include/win32/fs_compat.h"
@@ -119,6 +120,37 @@ struct ceph_statx {
 #define FALLOC_FL_PUNCH_HOLE 0x02
 #endif
 
+/**
+ * ceph_ll_io_info: a read or write submitted with
+ * ceph_ll_nonblocking_readv_writev()
+ *
+ * @callback: called from a client thread once the I/O is complete
+ * @priv: private info for the caller, not touched by the client
+ * @fh: open filehandle; must stay open until @callback has been called
+ * @iov, @iovcnt: buffers; must stay valid until @callback has been called
+ * @off: file offset
+ * @result: set before @callback: bytes transferred or negative error code
+ * @write: write rather than read
+ * @fsync: fsync the file after a successful write
+ * @syncdataonly: with @fsync, only sync data (fdatasync)
+ *
+ * A request sees the effects of the requests submitted before it on the
+ * same filehandle.  Callbacks of reads that do not depend on each other
+ * may run out of order.
+ */
+struct ceph_ll_io_info {
+  void (*callback)(struct ceph_ll_io_info *cb_info);
+  void *priv;
+  struct Fh *fh;
+  const struct iovec *iov;
+  int iovcnt;
+  int64_t off;
+  int64_t result;
+  bool write;
+  bool fsync;
+  bool syncdataonly;
+};
+
 /** ceph_deleg_cb_t: Delegation recalls
  *
  * Called when there is an outstanding Delegation and there is conflicting
@@ -40,7 +40,7 @@ extern "C" {
 
 #define LIBCEPHFS_VER_MAJOR 10
 #define LIBCEPHFS_VER_MINOR 0
-#define LIBCEPHFS_VER_EXTRA 3
+#define LIBCEPHFS_VER_EXTRA 4
 
 #define LIBCEPHFS_VERSION(maj, min, extra) ((maj << 16) + (min << 8) + extra)
 #define LIBCEPHFS_VERSION_CODE LIBCEPHFS_VERSION(LIBCEPHFS_VER_MAJOR, LIBCEPHFS_VER_MINOR, LIBCEPHFS_VER_EXTRA)
@@ -1879,6 +1879,25 @@ int64_t ceph_ll_readv(struct ceph_mount_info *cmount, struct Fh *fh,
 		      const struct iovec *iov, int iovcnt, int64_t off);
 int64_t ceph_ll_writev(struct ceph_mount_info *cmount, struct Fh *fh,
 		       const struct iovec *iov, int iovcnt, int64_t off);
+
+/**
+ * Submit a read or write without waiting for it.
+ *
+ * io_info->callback is called with io_info->result set once the I/O
+ * described by @io_info is done.  Reads, and buffered writes that already
+ * hold the capabilities they need, complete from the client's OSD and
+ * cache callbacks; requests that have to block are handed to one of the
+ * client_ll_async_io_threads workers.  This lets a caller keep many
+ * requests in flight without dedicating a thread to each.  Taking a
+ * capability reference may still briefly wait on the client lock.
+ *
+ * @param cmount the ceph mount handle to use.
+ * @param io_info the request; must stay valid until its callback runs.
+ * @returns 0 if the request was queued, or a negative error code, in
+ *          which case the callback is not called.
+ */
+int64_t ceph_ll_nonblocking_readv_writev(struct ceph_mount_info *cmount,
+					 struct ceph_ll_io_info *io_info);
 int ceph_ll_close(struct ceph_mount_info *cmount, struct Fh* filehandle);
 int ceph_ll_iclose(struct ceph_mount_info *cmount, struct Inode *in, int mode);
 /**
@@ -50,6 +50,37 @@ static inline uint32_t ceph_crc32c(uint32_t crc, unsigned char const *data, unsi
   return ceph_crc32c_func(crc, data, length);
 }
 
+/**
+ * crc32c of a concatenation, from the crcs of its parts
+ *
+ * @param crc_a crc32c of the first part, with whatever initial value
+ * @param crc_b crc32c of the second part with initial value 0
+ * @param length_b length of the second part
+ * @return the crc32c of both parts, as if computed in one pass
+ */
+static inline uint32_t ceph_crc32c_combine(uint32_t crc_a, uint32_t crc_b,
+					   unsigned length_b)
+{
+  return crc_b ^ ceph_crc32c(crc_a, 0, length_b);
+}
+
+/**
+ * calculate crc32c of several independent buffers
+ *
+ * Same results as calling ceph_crc32c() on each buffer in turn, but
+ * implementations may interleave the buffers to keep the crc unit busy,
+ * which mostly pays off for buffers too short for the single-buffer
+ * kernel's own interleaving.
+ *
+ * @param count number of buffers
+ * @param crcs initial values in, results out
+ * @param data buffers (a NULL buffer is treated as zero-filled)
+ * @param lengths buffer lengths
+ */
+void ceph_crc32c_multi(unsigned count, uint32_t *crcs,
+		       unsigned char const *const *data,
+		       unsigned const *lengths);
+
 #ifdef __cplusplus
 }
 #endif
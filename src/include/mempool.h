@@ -105,6 +105,14 @@ BlueStore::Onode, we need to do
 (This is just because we need to name some static variables and we
 can't use :: in a variable name.)
 
+Classes with many small, long lived instances (e.g. cache entries) can
+use MEMPOOL_DEFINE_OBJECT_SLAB_FACTORY instead.  It has the same
+signature and accounting, but carves the objects out of 64KB slabs,
+which are handed back to the system once all of their objects are
+freed.  This avoids one heap allocation per object and the
+fragmentation that comes with it.  The pool's bytes count whole slabs,
+so they include the room not (yet) used by any object.
+
 XXX Note: the new operator hard-codes the allocation size to the size of the
 object given in MEMPOOL_DEFINE_OBJECT_FACTORY. For this reason, you cannot
 incorporate mempools into a base class without also defining a helper/factory
@@ -409,6 +417,164 @@ public:
 };
 
 
+// Fixed size object allocator backing MEMPOOL_DEFINE_OBJECT_SLAB_FACTORY.
+//
+// Objects are carved out of slab_bytes sized, slab_bytes aligned slabs, so
+// the slab of an object is found by masking its address.  Slabs with free
+// room are kept per arena (arenas are picked the same way as mempool
+// shards, i.e. by thread) and each arena caches at most one empty slab,
+// any other slab is released as soon as its last object is.  Items are
+// accounted per object, bytes per slab, so that the pool also shows the
+// free room and headers of the slabs it holds.
+template<pool_index_t pool_ix, typename T, size_t slab_bytes = 64 * 1024>
+class slab_allocator {
+  struct free_item_t {
+    free_item_t *next;
+  };
+  struct arena_t;
+  struct slab_t {
+    arena_t *arena;
+    slab_t *prev = nullptr;   ///< in arena_t::partial
+    slab_t *next = nullptr;
+    free_item_t *free = nullptr;
+    size_t used = 0;
+    size_t carved = 0;        ///< items handed out at least once
+
+    explicit slab_t(arena_t *a) : arena(a) {}
+    char *items() {
+      return reinterpret_cast<char*>(this) + header_bytes;
+    }
+  };
+  struct arena_t {
+    std::mutex lock;
+    slab_t *partial = nullptr; ///< slabs with room, most recent first
+    size_t slabs = 0;
+  } __attribute__ ((aligned (128)));
+
+  static constexpr size_t header_bytes =
+    (sizeof(slab_t) + alignof(T) - 1) / alignof(T) * alignof(T);
+  static_assert(sizeof(T) >= sizeof(free_item_t),
+		"slab items must be able to hold a free list link");
+  static_assert((slab_bytes & (slab_bytes - 1)) == 0,
+		"slab size must be a power of two");
+
+  pool_t *pool;
+  type_t *type = nullptr;
+  arena_t arenas[num_shards];
+
+  static void link(arena_t *a, slab_t *s) {
+    s->prev = nullptr;
+    s->next = a->partial;
+    if (a->partial) {
+      a->partial->prev = s;
+    }
+    a->partial = s;
+  }
+  static void unlink(arena_t *a, slab_t *s) {
+    if (s->prev) {
+      s->prev->next = s->next;
+    } else {
+      a->partial = s->next;
+    }
+    if (s->next) {
+      s->next->prev = s->prev;
+    }
+    s->prev = s->next = nullptr;
+  }
+
+public:
+  static constexpr size_t items_per_slab = (slab_bytes - header_bytes) / sizeof(T);
+  static_assert(items_per_slab >= 8, "object too big for the slab size");
+
+  explicit slab_allocator(bool force_register) {
+    pool = &get_pool(pool_ix);
+    if (debug_mode || force_register) {
+      type = pool->get_type(typeid(T), sizeof(T));
+    }
+  }
+
+  T* allocate() {
+    shard_t *shard = pool->pick_a_shard();
+    shard->items += 1;
+    if (type) {
+      type->items += 1;
+    }
+    arena_t *a = &arenas[pool_t::pick_a_shard_int()];
+    std::lock_guard<std::mutex> l(a->lock);
+    slab_t *s = a->partial;
+    if (!s) {
+      void *mem = nullptr;
+      if (::posix_memalign(&mem, slab_bytes, slab_bytes)) {
+	shard->items -= 1;
+	if (type) {
+	  type->items -= 1;
+	}
+	throw std::bad_alloc();
+      }
+      shard->bytes += slab_bytes;
+      s = new (mem) slab_t(a);
+      ++a->slabs;
+      link(a, s);
+    }
+    void *r;
+    if (s->free) {
+      r = s->free;
+      s->free = s->free->next;
+    } else {
+      // carve lazily so that a fresh slab only touches the pages in use
+      ceph_assert(s->carved < items_per_slab);
+      r = s->items() + s->carved++ * sizeof(T);
+    }
+    if (++s->used == items_per_slab) {
+      unlink(a, s);
+    }
+    return reinterpret_cast<T*>(r);
+  }
+
+  void deallocate(T* p) {
+    shard_t *shard = pool->pick_a_shard();
+    shard->items -= 1;
+    if (type) {
+      type->items -= 1;
+    }
+    slab_t *s = reinterpret_cast<slab_t*>(
+      reinterpret_cast<uintptr_t>(p) & ~(uintptr_t)(slab_bytes - 1));
+    arena_t *a = s->arena;
+    slab_t *release = nullptr;
+    {
+      std::lock_guard<std::mutex> l(a->lock);
+      auto item = reinterpret_cast<free_item_t*>(p);
+      item->next = s->free;
+      s->free = item;
+      if (s->used-- == items_per_slab) {
+	link(a, s);
+      }
+      if (s->used == 0 && (a->partial != s || s->next)) {
+	// keep the only slab with room around, release any other empty one
+	unlink(a, s);
+	--a->slabs;
+	release = s;
+      }
+    }
+    if (release) {
+      shard->bytes -= slab_bytes;
+      release->~slab_t();
+      ::free(release);
+    }
+  }
+
+  /// number of slabs currently allocated by all arenas
+  size_t get_num_slabs() {
+    size_t n = 0;
+    for (auto& a : arenas) {
+      std::lock_guard<std::mutex> l(a.lock);
+      n += a.slabs;
+    }
+    return n;
+  }
+};
+
+
 // Namespace mempool
 
 #define P(x)								\
@@ -554,4 +720,19 @@ bool operator!=(const std::vector<T, mempool::pool_allocator<pool_index, T>>& lh
     return mempool::pool::alloc_##factoryname.deallocate((obj*)p, 1);	\
   }
 
+// Same as MEMPOOL_DEFINE_OBJECT_FACTORY but objects are carved out of
+// slabs, see slab_allocator.
+#define MEMPOOL_DEFINE_OBJECT_SLAB_FACTORY(obj,factoryname,pool)	\
+  namespace mempool {							\
+    namespace pool {							\
+      slab_allocator<id, obj> slab_alloc_##factoryname{true};		\
+    }									\
+  }									\
+  void *obj::operator new(size_t size) {				\
+    return mempool::pool::slab_alloc_##factoryname.allocate();		\
+  }									\
+  void obj::operator delete(void *p)  {					\
+    return mempool::pool::slab_alloc_##factoryname.deallocate((obj*)p); \
+  }
+
 #endif
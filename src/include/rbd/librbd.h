@@ -32,7 +32,7 @@ extern "C" {
 #include "features.h"
 
 #define LIBRBD_VER_MAJOR 1
-#define LIBRBD_VER_MINOR 18
+#define LIBRBD_VER_MINOR 19
 #define LIBRBD_VER_EXTRA 0
 
 #define LIBRBD_VERSION(maj, min, extra) ((maj << 16) + (min << 8) + extra)
@@ -40,6 +40,7 @@ extern "C" {
 #define LIBRBD_VERSION_CODE LIBRBD_VERSION(LIBRBD_VER_MAJOR, LIBRBD_VER_MINOR, LIBRBD_VER_EXTRA)
 
 #define LIBRBD_SUPPORTS_AIO_FLUSH 1
+#define LIBRBD_SUPPORTS_AIO_BATCH 1
 #define LIBRBD_SUPPORTS_AIO_OPEN 1
 #define LIBRBD_SUPPORTS_COMPARE_AND_WRITE 1
 #define LIBRBD_SUPPORTS_COMPARE_AND_WRITE_IOVEC 1
@@ -375,6 +376,19 @@ enum {
   RBD_WRITE_ZEROES_FLAG_THICK_PROVISION = (1U<<0), /* fully allocated zeroed extent */
 };
 
+typedef enum {
+    RBD_AIO_BATCH_OP_READ  = 0,
+    RBD_AIO_BATCH_OP_WRITE = 1
+} rbd_aio_batch_op_type_t;
+
+typedef struct {
+    rbd_aio_batch_op_type_t type;
+    uint64_t off;
+    const struct iovec *iov;
+    int iovcnt;
+    rbd_completion_t c;
+} rbd_aio_batch_op_t;
+
 typedef enum {
     RBD_ENCRYPTION_FORMAT_LUKS1 = 0,
     RBD_ENCRYPTION_FORMAT_LUKS2 = 1,
@@ -1231,6 +1245,17 @@ CEPH_RBD_API int rbd_aio_readv(rbd_image_t image, const struct iovec *iov,
                                int iovcnt, uint64_t off, rbd_completion_t c);
 CEPH_RBD_API int rbd_aio_discard(rbd_image_t image, uint64_t off, uint64_t len,
                                  rbd_completion_t c);
+/*
+ * Submit a batch of vectored reads and writes, each with its own
+ * completion.  The batch is issued in image offset order so that
+ * neighbouring requests reach the object dispatcher back to back and can
+ * be merged by the I/O scheduler; requests within a batch are not ordered
+ * with respect to each other.  If any entry is invalid, -EINVAL is
+ * returned and nothing is submitted.
+ */
+CEPH_RBD_API int rbd_aio_submit_batch(rbd_image_t image,
+                                      const rbd_aio_batch_op_t *ops,
+                                      size_t num_ops);
 CEPH_RBD_API int rbd_aio_writesame(rbd_image_t image, uint64_t off, size_t len,
                                    const char *buf, size_t data_len,
                                    rbd_completion_t c, int op_flags);
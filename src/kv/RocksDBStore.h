@@ -10,6 +10,7 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <atomic>
 #include <boost/scoped_ptr.hpp>
 #include "rocksdb/write_batch.h"
 #include "rocksdb/perf_context.h"
@@ -32,6 +33,7 @@
 enum {
   l_rocksdb_first = 34300,
   l_rocksdb_get_latency,
+  l_rocksdb_multiget_keys,
   l_rocksdb_submit_latency,
   l_rocksdb_submit_sync_latency,
   l_rocksdb_compact,
@@ -120,6 +122,10 @@ private:
     uint32_t hash_l;  //< first character to take for hash calc.
     uint32_t hash_h;  //< last character to take for hash calc.
     std::vector<rocksdb::ColumnFamilyHandle *> handles;
+    /// point lookups, to tell how well the column filter pays off
+    std::atomic<uint64_t> lookups = {0};
+    std::atomic<uint64_t> negative_lookups = {0};
+    std::atomic<uint64_t> lookup_key_bytes = {0};
   };
   std::unordered_map<std::string, prefix_shards> cf_handles;
   std::unordered_map<uint32_t, std::string> cf_ids_to_prefix;
@@ -133,6 +139,7 @@ private:
   rocksdb::ColumnFamilyHandle *get_cf_handle(const std::string& prefix, const std::string& key);
   rocksdb::ColumnFamilyHandle *get_cf_handle(const std::string& prefix, const char* key, size_t keylen);
   rocksdb::ColumnFamilyHandle *get_cf_handle(const std::string& prefix, const IteratorBounds& bounds);
+  void note_lookup(const std::string& prefix, size_t keylen, bool found);
 
   int submit_common(rocksdb::WriteOptions& woptions, KeyValueDB::Transaction t);
   int install_cf_mergeop(const std::string &cf_name, rocksdb::ColumnFamilyOptions *cf_opt);
@@ -171,6 +178,9 @@ private:
   int update_column_family_options(const std::string& base_name,
 				   const std::string& more_options,
 				   rocksdb::ColumnFamilyOptions* cf_opt);
+  void apply_auto_filter(const std::string& base_name,
+			 const std::string& block_cache_opt,
+			 rocksdb::ColumnFamilyOptions* cf_opt);
   // manage async compactions
   ceph::mutex compact_queue_lock =
     ceph::make_mutex("RocksDBStore::compact_thread_lock");
@@ -519,7 +529,7 @@ err:
 
   WholeSpaceIterator get_wholespace_iterator(IteratorOpts opts = 0) override;
 private:
-  WholeSpaceIterator get_default_cf_iterator();
+  WholeSpaceIterator get_default_cf_iterator(IteratorOpts opts = 0);
 
   using cf_deleter_t = std::function<void(rocksdb::ColumnFamilyHandle*)>;
   using columns_t = std::map<std::string,
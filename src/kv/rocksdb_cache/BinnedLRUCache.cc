@@ -102,21 +102,25 @@ void BinnedLRUHandleTable::Resize() {
 }
 
 BinnedLRUCacheShard::BinnedLRUCacheShard(CephContext *c, size_t capacity, bool strict_capacity_limit,
-                             double high_pri_pool_ratio)
+                             double high_pri_pool_ratio, double probation_ratio)
     : cct(c),
       capacity_(0),
       high_pri_pool_usage_(0),
       strict_capacity_limit_(strict_capacity_limit),
       high_pri_pool_ratio_(high_pri_pool_ratio),
       high_pri_pool_capacity_(0),
+      probation_ratio_(probation_ratio),
+      probation_usage_(0),
       usage_(0),
       lru_usage_(0),
+      misses_(0),
       age_bins(1) {
   shift_bins();
   // Make empty circular linked list
   lru_.next = &lru_;
   lru_.prev = &lru_;
   lru_low_pri_ = &lru_;
+  lru_probation_ = &lru_;
   SetCapacity(capacity);
 }
 
@@ -197,16 +201,35 @@ size_t BinnedLRUCacheShard::GetHighPriPoolUsage() const {
   return high_pri_pool_usage_;
 }
 
+size_t BinnedLRUCacheShard::GetProbationUsage() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return probation_usage_;
+}
+
+void BinnedLRUCacheShard::GetMissStats(uint64_t *misses, uint64_t *entries) const {
+  std::lock_guard<std::mutex> l(mutex_);
+  *misses = misses_;
+  *entries = table_.GetElems();
+}
+
 void BinnedLRUCacheShard::LRU_Remove(BinnedLRUHandle* e) {
   ceph_assert(e->next != nullptr);
   ceph_assert(e->prev != nullptr);
   if (lru_low_pri_ == e) {
     lru_low_pri_ = e->prev;
   }
+  if (lru_probation_ == e) {
+    lru_probation_ = e->prev;
+  }
   e->next->prev = e->prev;
   e->prev->next = e->next;
   e->prev = e->next = nullptr;
   lru_usage_ -= e->charge;
+  if (e->InProbation()) {
+    ceph_assert(probation_usage_ >= e->charge);
+    probation_usage_ -= e->charge;
+    e->SetInProbation(false);
+  }
   if (e->InHighPriPool()) {
     ceph_assert(high_pri_pool_usage_ >= e->charge);
     high_pri_pool_usage_ -= e->charge;
@@ -230,6 +253,21 @@ void BinnedLRUCacheShard::LRU_Insert(BinnedLRUHandle* e) {
     e->SetInHighPriPool(true);
     high_pri_pool_usage_ += e->charge;
     MaintainPoolSize();
+  } else if (probation_ratio_ > 0 && !e->HasHit()) {
+    // Insert "e" to the head of the probationary segment; it only gets
+    // ahead of the protected entries once it is looked up again.
+    e->next = lru_probation_->next;
+    e->prev = lru_probation_;
+    e->prev->next = e;
+    e->next->prev = e;
+    e->SetInHighPriPool(false);
+    e->SetInProbation(true);
+    if (lru_low_pri_ == lru_probation_) {
+      lru_low_pri_ = e;
+    }
+    lru_probation_ = e;
+    probation_usage_ += e->charge;
+    *(e->age_bin) += e->charge;
   } else {
     // Insert "e" to the head of low-pri pool. Note that when
     // high_pri_pool_ratio is 0, head of low-pri pool is also head of LRU list.
@@ -242,6 +280,9 @@ void BinnedLRUCacheShard::LRU_Insert(BinnedLRUHandle* e) {
     *(e->age_bin) += e->charge;
   }
   lru_usage_ += e->charge;
+  if (probation_ratio_ > 0) {
+    MaintainProbationSize();
+  }
 }
 
 uint64_t BinnedLRUCacheShard::sum_bins(uint32_t start, uint32_t end) const {
@@ -269,6 +310,21 @@ void BinnedLRUCacheShard::MaintainPoolSize() {
   }
 }
 
+void BinnedLRUCacheShard::MaintainProbationSize() {
+  double protected_capacity =
+    (capacity_ - high_pri_pool_capacity_) * (1.0 - probation_ratio_);
+  ceph_assert(lru_usage_ >= high_pri_pool_usage_ + probation_usage_);
+  size_t protected_usage = lru_usage_ - high_pri_pool_usage_ - probation_usage_;
+  while (protected_usage > protected_capacity && lru_probation_ != lru_low_pri_) {
+    // Demote the oldest protected entry.
+    lru_probation_ = lru_probation_->next;
+    ceph_assert(lru_probation_ != &lru_);
+    lru_probation_->SetInProbation(true);
+    protected_usage -= lru_probation_->charge;
+    probation_usage_ += lru_probation_->charge;
+  }
+}
+
 void BinnedLRUCacheShard::EvictFromLRU(size_t charge,
                                  ceph::autovector<BinnedLRUHandle*>* deleted) {
   while (usage_ + charge > capacity_ && lru_.next != &lru_) {
@@ -314,6 +370,8 @@ rocksdb::Cache::Handle* BinnedLRUCacheShard::Lookup(const rocksdb::Slice& key, u
     }
     e->refs++;
     e->SetHit();
+  } else {
+    ++misses_;
   }
   return reinterpret_cast<rocksdb::Cache::Handle*>(e);
 }
@@ -503,8 +561,9 @@ std::string BinnedLRUCacheShard::GetPrintableOptions() const {
   char buffer[kBufferSize];
   {
     std::lock_guard<std::mutex> l(mutex_);
-    snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
-             high_pri_pool_ratio_);
+    snprintf(buffer, kBufferSize,
+             "    high_pri_pool_ratio: %.3lf\n    probation_ratio: %.3lf\n",
+             high_pri_pool_ratio_, probation_ratio_);
   }
   return std::string(buffer);
 }
@@ -530,9 +589,11 @@ BinnedLRUCache::BinnedLRUCache(CephContext *c,
     throw std::bad_alloc();
   } 
   size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
+  double probation_ratio = c->_conf->rocksdb_cache_probation_ratio;
   for (int i = 0; i < num_shards_; i++) {
     new (&shards_[i])
-        BinnedLRUCacheShard(c, per_shard, strict_capacity_limit, high_pri_pool_ratio);
+        BinnedLRUCacheShard(c, per_shard, strict_capacity_limit, high_pri_pool_ratio,
+                            probation_ratio);
   }
 }
 
@@ -682,6 +743,23 @@ uint64_t BinnedLRUCache::sum_bins(uint32_t start, uint32_t end) const {
   return bytes;
 }
 
+bool BinnedLRUCache::get_miss_stats(uint64_t *misses, uint64_t *bytes_per_miss,
+                                    uint64_t *resident_bytes) const {
+  uint64_t entries = 0;
+  *misses = 0;
+  *resident_bytes = 0;
+  for (int s = 0; s < num_shards_; s++) {
+    uint64_t m, e;
+    shards_[s].GetMissStats(&m, &e);
+    *misses += m;
+    entries += e;
+    *resident_bytes += shards_[s].GetUsage();
+  }
+  // lookups miss by key, count each as an average sized entry
+  *bytes_per_miss = *resident_bytes / std::max<uint64_t>(entries, 1);
+  return true;
+}
+
 uint32_t BinnedLRUCache::get_bin_count() const {
   uint32_t result = 0;
   if (num_shards_ > 0) {
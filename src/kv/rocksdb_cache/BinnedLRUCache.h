@@ -71,6 +71,8 @@ struct BinnedLRUHandle {
   //   in_cache:    whether this entry is referenced by the hash table.
   //   is_high_pri: whether this entry is high priority entry.
   //   in_high_pri_pool: whether this entry is in high-pri pool.
+  //   has_hit:     whether this entry has been looked up since insertion.
+  //   in_probation: whether this entry is in the probationary segment.
   char flags;
 
   uint32_t hash;     // Hash of key(); used for fast sharding and comparisons
@@ -91,6 +93,7 @@ struct BinnedLRUHandle {
   bool IsHighPri() { return flags & 2; }
   bool InHighPriPool() { return flags & 4; }
   bool HasHit() { return flags & 8; }
+  bool InProbation() { return flags & 16; }
 
   void SetInCache(bool in_cache) {
     if (in_cache) {
@@ -118,6 +121,14 @@ struct BinnedLRUHandle {
 
   void SetHit() { flags |= 8; }
 
+  void SetInProbation(bool in_probation) {
+    if (in_probation) {
+      flags |= 16;
+    } else {
+      flags &= ~16;
+    }
+  }
+
   void Free() {
     ceph_assert((refs == 1 && InCache()) || (refs == 0 && !InCache()));
     if (deleter) {
@@ -141,6 +152,7 @@ class BinnedLRUHandleTable {
   BinnedLRUHandle* Lookup(const rocksdb::Slice& key, uint32_t hash);
   BinnedLRUHandle* Insert(BinnedLRUHandle* h);
   BinnedLRUHandle* Remove(const rocksdb::Slice& key, uint32_t hash);
+  uint32_t GetElems() const { return elems_; }
 
   template <typename T>
   void ApplyToAllCacheEntries(T func) {
@@ -174,7 +186,7 @@ class BinnedLRUHandleTable {
 class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
  public:
   BinnedLRUCacheShard(CephContext *c, size_t capacity, bool strict_capacity_limit,
-                double high_pri_pool_ratio);
+                double high_pri_pool_ratio, double probation_ratio = 0.0);
   virtual ~BinnedLRUCacheShard();
 
   // Separate from constructor so caller can easily make an array of BinnedLRUCache
@@ -232,6 +244,12 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Retrieves high pri pool usage
   size_t GetHighPriPoolUsage() const;
 
+  // Retrieves probationary segment usage
+  size_t GetProbationUsage() const;
+
+  // Retrieves the lookup misses so far and the number of cached entries
+  void GetMissStats(uint64_t *misses, uint64_t *entries) const;
+
   // Rotate the bins
   void shift_bins();
 
@@ -253,6 +271,10 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // high-pri pool is no larger than the size specify by high_pri_pool_pct.
   void MaintainPoolSize();
 
+  // Demote the oldest protected low-pri entries to the probationary segment
+  // until the protected part fits in what is left by the probation ratio.
+  void MaintainProbationSize();
+
   // Just reduce the reference count by 1.
   // Return true if last reference
   bool Unref(BinnedLRUHandle* e);
@@ -279,6 +301,13 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Remember the value to avoid recomputing each time.
   double high_pri_pool_capacity_;
 
+  // Share of the low-pri capacity kept for entries that were never hit
+  // since insertion, 0 disables the probationary segment.
+  double probation_ratio_;
+
+  // Memory size for entries in the probationary segment.
+  size_t probation_usage_;
+
   // Dummy head of LRU list.
   // lru.prev is newest entry, lru.next is oldest entry.
   // LRU contains items which can be evicted, ie reference only by cache
@@ -287,6 +316,11 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Pointer to head of low-pri pool in LRU list.
   BinnedLRUHandle* lru_low_pri_;
 
+  // Pointer to head of the probationary segment, which makes up the oldest
+  // end of the low-pri pool. Entries that have not been hit since they were
+  // inserted go there, so a one-time scan only ever evicts its own blocks.
+  BinnedLRUHandle* lru_probation_;
+
   // ------------^^^^^^^^^^^^^-----------
   // Not frequently modified data members
   // ------------------------------------
@@ -306,6 +340,9 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Memory size for entries residing only in the LRU list
   size_t lru_usage_;
 
+  // Lookups that found nothing
+  uint64_t misses_;
+
   // mutex_ protects the following state.
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
@@ -350,6 +387,8 @@ class BinnedLRUCache : public ShardedCache {
   uint64_t sum_bins(uint32_t start, uint32_t end) const;
   uint32_t get_bin_count() const;
   void set_bin_count(uint32_t count);
+  virtual bool get_miss_stats(uint64_t *misses, uint64_t *bytes_per_miss,
+                              uint64_t *resident_bytes) const;
 
   virtual std::string get_cache_name() const {
     return "RocksDB Binned LRU Cache";
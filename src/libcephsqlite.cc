@@ -440,6 +440,7 @@ enoent_retry:
   io->rs->set_lock_timeout(cct->_conf.get_val<std::chrono::milliseconds>("cephsqlite_lock_renewal_timeout"));
   io->rs->set_lock_interval(cct->_conf.get_val<std::chrono::milliseconds>("cephsqlite_lock_renewal_interval"));
   io->rs->set_blocklist_the_dead(cct->_conf.get_val<bool>("cephsqlite_blocklist_dead_locker"));
+  io->rs->set_readahead(cct->_conf.get_val<Option::size_t>("cephsqlite_readahead"));
 
   return 0;
 }
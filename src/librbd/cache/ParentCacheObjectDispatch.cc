@@ -2,6 +2,7 @@
 // vim: ts=8 sw=2 smarttab
 
 #include "common/errno.h"
+#include "common/safe_io.h"
 #include "include/neorados/RADOS.hpp"
 #include "librbd/ImageCtx.h"
 #include "librbd/Utils.h"
@@ -13,6 +14,9 @@
 #include "osd/osd_types.h"
 #include "osdc/WritebackHandler.h"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <vector>
 
 #define dout_subsys ceph_subsys_rbd
@@ -146,12 +150,27 @@ void ParentCacheObjectDispatch<I>::handle_read_cache(
     return;
   }
 
+  // open the cache file once for all extents of the object
+  int fd = TEMP_FAILURE_RETRY(::open(file_path.c_str(), O_RDONLY|O_CLOEXEC));
+  struct stat st;
+  if (fd < 0 || ::fstat(fd, &st) < 0) {
+    ldout(m_image_ctx->cct, 5) << "failed to open cache file " << file_path
+                               << ": " << cpp_strerror(errno) << dendl;
+    if (fd >= 0) {
+      VOID_TEMP_FAILURE_RETRY(::close(fd));
+    }
+    *dispatch_result = io::DISPATCH_RESULT_CONTINUE;
+    on_dispatched->complete(0);
+    return;
+  }
+
   int read_len = 0;
   for (auto& extent: *extents) {
     // try to read from parent image cache
-    int r = read_object(file_path, &extent.bl, extent.offset, extent.length,
-                        on_dispatched);
+    int r = read_object(fd, st.st_size, &extent.bl, extent.offset,
+                        extent.length);
     if (r < 0) {
+      VOID_TEMP_FAILURE_RETRY(::close(fd));
       // cache read error, fall back to read rados
       for (auto& read_extent: *extents) {
         // clear read bufferlists
@@ -167,6 +186,7 @@ void ParentCacheObjectDispatch<I>::handle_read_cache(
 
     read_len += r;
   }
+  VOID_TEMP_FAILURE_RETRY(::close(fd));
 
   *dispatch_result = io::DISPATCH_RESULT_COMPLETE;
   on_dispatched->complete(read_len);
@@ -238,20 +258,25 @@ void ParentCacheObjectDispatch<I>::create_cache_session(Context* on_finish,
 
 template <typename I>
 int ParentCacheObjectDispatch<I>::read_object(
-    std::string file_path, ceph::bufferlist* read_data, uint64_t offset,
-    uint64_t length, Context *on_finish) {
-
+    int fd, uint64_t file_size, ceph::bufferlist* read_data, uint64_t offset,
+    uint64_t length) {
   auto *cct = m_image_ctx->cct;
-  ldout(cct, 20) << "file path: " << file_path << dendl;
+  ldout(cct, 20) << "offset=" << offset << ", length=" << length << dendl;
+
+  if (offset >= file_size) {
+    return 0;
+  }
+  length = std::min(length, file_size - offset);
 
-  std::string error;
-  int ret = read_data->pread_file(file_path.c_str(), offset, length, &error);
+  ceph::bufferptr bp(length);
+  ssize_t ret = safe_pread(fd, bp.c_str(), length, offset);
   if (ret < 0) {
-    ldout(cct, 5) << "read from file return error: " << error
-                  << "file path= " << file_path
+    ldout(cct, 5) << "read from file return error: " << cpp_strerror(ret)
                   << dendl;
     return ret;
   }
+  bp.set_length(ret);
+  read_data->push_back(std::move(bp));
   return read_data->length();
 }
 
@@ -47,9 +47,6 @@ int BlockCrypto<T>::crypt(ceph::bufferlist* data, uint64_t image_offset,
   unsigned char* iv = (unsigned char*)alloca(m_iv_size);
   memset(iv, 0, m_iv_size);
 
-  bufferlist src = *data;
-  data->clear();
-
   auto ctx = m_data_cryptor->get_context(mode);
   if (ctx == nullptr) {
     lderr(m_cct) << "unable to get crypt context" << dendl;
@@ -60,6 +57,35 @@ int BlockCrypto<T>::crypt(ceph::bufferlist* data, uint64_t image_offset,
       m_data_cryptor->return_context(ctx, mode); });
 
   auto sector_number = image_offset / 512;
+  if (mode == CipherMode::CIPHER_MODE_DEC && can_crypt_in_place(*data)) {
+    // plaintext is written back over the ciphertext, skipping the copy
+    for (auto& buf : data->mut_buffers()) {
+      auto buf_ptr = reinterpret_cast<unsigned char*>(buf.c_str());
+      for (uint32_t off = 0; off < buf.length(); off += m_block_size) {
+        auto block_offset_le = ceph_le64(sector_number);
+        memcpy(iv, &block_offset_le, sizeof(block_offset_le));
+        auto r = m_data_cryptor->init_context(ctx, iv, m_iv_size);
+        if (r != 0) {
+          lderr(m_cct) << "unable to init cipher's IV" << dendl;
+          return r;
+        }
+
+        r = m_data_cryptor->update_context(
+              ctx, buf_ptr + off, buf_ptr + off, m_block_size);
+        if (r < 0) {
+          lderr(m_cct) << "crypt update failed" << dendl;
+          return r;
+        }
+        sector_number += m_block_size / 512;
+      }
+    }
+    data->invalidate_crc();
+    return 0;
+  }
+
+  bufferlist src = *data;
+  data->clear();
+
   auto appender = data->get_contiguous_appender(src.length());
   unsigned char* out_buf_ptr = nullptr;
   unsigned char* leftover_block = (unsigned char*)alloca(m_block_size);
@@ -116,6 +142,17 @@ int BlockCrypto<T>::crypt(ceph::bufferlist* data, uint64_t image_offset,
   return 0;
 }
 
+template <typename T>
+bool BlockCrypto<T>::can_crypt_in_place(const ceph::bufferlist& data) const {
+  // only buffers nobody else references, each holding whole crypto blocks
+  for (auto& buf : data.buffers()) {
+    if (buf.raw_nref() != 1 || buf.length() % m_block_size != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template <typename T>
 int BlockCrypto<T>::encrypt(ceph::bufferlist* data, uint64_t image_offset) {
   return crypt(data, image_offset, CipherMode::CIPHER_MODE_ENC);
@@ -50,6 +50,7 @@ private:
     uint32_t m_iv_size;
 
     int crypt(ceph::bufferlist* data, uint64_t image_offset, CipherMode mode);
+    bool can_crypt_in_place(const ceph::bufferlist& data) const;
 };
 
 } // namespace crypto
@@ -143,7 +143,11 @@ void ImageCopyRequest<I>::send_object_copies() {
   {
     std::lock_guard locker{m_lock};
     auto max_ops = m_src_image_ctx->config.template get_val<uint64_t>(
-      "rbd_concurrent_management_ops");
+      "rbd_deep_copy_concurrent_ops");
+    if (max_ops == 0) {
+      max_ops = m_src_image_ctx->config.template get_val<uint64_t>(
+        "rbd_concurrent_management_ops");
+    }
 
     // attempt to schedule at least 'max_ops' initial requests where
     // some objects might be skipped if fast-diff notes no change
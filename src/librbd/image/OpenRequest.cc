@@ -262,6 +262,10 @@ void OpenRequest<I>::send_v2_get_initial_metadata() {
   cls_client::get_size_start(&op, CEPH_NOSNAP);
   cls_client::get_object_prefix_start(&op);
   cls_client::get_features_start(&op, true);
+  cls_client::get_create_timestamp_start(&op);
+  cls_client::get_access_timestamp_start(&op);
+  cls_client::get_modify_timestamp_start(&op);
+  cls_client::get_data_pool_start(&op);
 
   using klass = OpenRequest<I>;
   librados::AioCompletion *comp = create_rados_callback<
@@ -294,6 +298,25 @@ Context *OpenRequest<I>::handle_v2_get_initial_metadata(int *result) {
                                               &incompatible_features);
   }
 
+  if (*result >= 0) {
+    *result = cls_client::get_create_timestamp_finish(
+      &it, &m_image_ctx->create_timestamp);
+  }
+
+  if (*result >= 0) {
+    *result = cls_client::get_access_timestamp_finish(
+      &it, &m_image_ctx->access_timestamp);
+  }
+
+  if (*result >= 0) {
+    *result = cls_client::get_modify_timestamp_finish(
+      &it, &m_image_ctx->modify_timestamp);
+  }
+
+  if (*result >= 0) {
+    *result = cls_client::get_data_pool_finish(&it, &m_data_pool_id);
+  }
+
   if (*result < 0) {
     lderr(cct) << "failed to retrieve initial metadata: "
                << cpp_strerror(*result) << dendl;
@@ -304,7 +327,7 @@ Context *OpenRequest<I>::handle_v2_get_initial_metadata(int *result) {
   if (m_image_ctx->test_features(RBD_FEATURE_STRIPINGV2)) {
     send_v2_get_stripe_unit_count();
   } else {
-    send_v2_get_create_timestamp();
+    send_v2_init_layout();
   }
 
   return nullptr;
@@ -349,137 +372,23 @@ Context *OpenRequest<I>::handle_v2_get_stripe_unit_count(int *result) {
     return nullptr;
   }
 
-  send_v2_get_create_timestamp();
-  return nullptr;
-}
-
-template <typename I>
-void OpenRequest<I>::send_v2_get_create_timestamp() {
-  CephContext *cct = m_image_ctx->cct;
-  ldout(cct, 10) << this << " " << __func__ << dendl;
-
-  librados::ObjectReadOperation op;
-  cls_client::get_create_timestamp_start(&op);
-
-  using klass = OpenRequest<I>;
-  librados::AioCompletion *comp = create_rados_callback<
-    klass, &klass::handle_v2_get_create_timestamp>(this);
-  m_out_bl.clear();
-  m_image_ctx->md_ctx.aio_operate(m_image_ctx->header_oid, comp, &op,
-                                  &m_out_bl);
-  comp->release();
-}
-
-template <typename I>
-Context *OpenRequest<I>::handle_v2_get_create_timestamp(int *result) {
-  CephContext *cct = m_image_ctx->cct;
-  ldout(cct, 10) << this << " " << __func__ << ": r=" << *result << dendl;
-
-  if (*result == 0) {
-    auto it = m_out_bl.cbegin();
-    *result = cls_client::get_create_timestamp_finish(&it,
-        &m_image_ctx->create_timestamp);
-  }
-  if (*result < 0 && *result != -EOPNOTSUPP) {
-    lderr(cct) << "failed to retrieve create_timestamp: "
-               << cpp_strerror(*result)
-               << dendl;
-    send_close_image(*result);
-    return nullptr;
-  }
-
-  send_v2_get_access_modify_timestamp();
+  send_v2_init_layout();
   return nullptr;
 }
 
 template <typename I>
-void OpenRequest<I>::send_v2_get_access_modify_timestamp() {
+void OpenRequest<I>::send_v2_init_layout() {
   CephContext *cct = m_image_ctx->cct;
   ldout(cct, 10) << this << " " << __func__ << dendl;
 
-  librados::ObjectReadOperation op;
-  cls_client::get_access_timestamp_start(&op);
-  cls_client::get_modify_timestamp_start(&op);
-  //TODO: merge w/ create timestamp query after luminous EOLed
-
-  using klass = OpenRequest<I>;
-  librados::AioCompletion *comp = create_rados_callback<
-    klass, &klass::handle_v2_get_access_modify_timestamp>(this);
-  m_out_bl.clear();
-  m_image_ctx->md_ctx.aio_operate(m_image_ctx->header_oid, comp, &op,
-                                  &m_out_bl);
-  comp->release();
-}
-
-template <typename I>
-Context *OpenRequest<I>::handle_v2_get_access_modify_timestamp(int *result) {
-  CephContext *cct = m_image_ctx->cct;
-  ldout(cct, 10) << this << " " << __func__ << ": r=" << *result << dendl;
-
-  if (*result == 0) {
-    auto it = m_out_bl.cbegin();
-    *result = cls_client::get_access_timestamp_finish(&it,
-        &m_image_ctx->access_timestamp);
-    if (*result == 0) 
-      *result = cls_client::get_modify_timestamp_finish(&it,
-        &m_image_ctx->modify_timestamp);
-  }
-  if (*result < 0 && *result != -EOPNOTSUPP) {
-    lderr(cct) << "failed to retrieve access/modify_timestamp: "
-               << cpp_strerror(*result)
-               << dendl;
-    send_close_image(*result);
-    return nullptr;
-  }
-
-  send_v2_get_data_pool();
-  return nullptr;
-}
-
-template <typename I>
-void OpenRequest<I>::send_v2_get_data_pool() {
-  CephContext *cct = m_image_ctx->cct;
-  ldout(cct, 10) << this << " " << __func__ << dendl;
-
-  librados::ObjectReadOperation op;
-  cls_client::get_data_pool_start(&op);
-
-  using klass = OpenRequest<I>;
-  librados::AioCompletion *comp = create_rados_callback<
-    klass, &klass::handle_v2_get_data_pool>(this);
-  m_out_bl.clear();
-  m_image_ctx->md_ctx.aio_operate(m_image_ctx->header_oid, comp, &op,
-                                  &m_out_bl);
-  comp->release();
-}
-
-template <typename I>
-Context *OpenRequest<I>::handle_v2_get_data_pool(int *result) {
-  CephContext *cct = m_image_ctx->cct;
-  ldout(cct, 10) << this << " " << __func__ << ": r=" << *result << dendl;
-
-  int64_t data_pool_id = -1;
-  if (*result == 0) {
-    auto it = m_out_bl.cbegin();
-    *result = cls_client::get_data_pool_finish(&it, &data_pool_id);
-  } else if (*result == -EOPNOTSUPP) {
-    *result = 0;
-  }
-
-  if (*result < 0) {
-    lderr(cct) << "failed to read data pool: " << cpp_strerror(*result)
-               << dendl;
-    send_close_image(*result);
-    return nullptr;
-  }
-
+  int64_t data_pool_id = m_data_pool_id;
   if (data_pool_id != -1) {
-    *result = util::create_ioctx(m_image_ctx->md_ctx, "data pool", data_pool_id,
-                                 {}, &m_image_ctx->data_ctx);
-    if (*result < 0) {
-      if (*result != -ENOENT) {
-        send_close_image(*result);
-        return nullptr;
+    int r = util::create_ioctx(m_image_ctx->md_ctx, "data pool", data_pool_id,
+                               {}, &m_image_ctx->data_ctx);
+    if (r < 0) {
+      if (r != -ENOENT) {
+        send_close_image(r);
+        return;
       }
       m_image_ctx->data_ctx.close();
     } else {
@@ -491,7 +400,6 @@ Context *OpenRequest<I>::handle_v2_get_data_pool(int *result) {
 
   m_image_ctx->init_layout(data_pool_id);
   send_refresh();
-  return nullptr;
 }
 
 template <typename I>
@@ -52,13 +52,7 @@ private:
    *            V2_GET_STRIPE_UNIT_COUNT (skip if   |
    *                |                     disabled) |
    *                v                               |
-   *            V2_GET_CREATE_TIMESTAMP             |
-   *                |                               |
-   *                v                               |
-   *            V2_GET_ACCESS_MODIFIY_TIMESTAMP     |
-   *                |                               |
-   *                v                               |
-   *            V2_GET_DATA_POOL --------------> REFRESH
+   *            V2_INIT_LAYOUT ----------------> REFRESH
    *                                                |
    *                                                v
    *                                             INIT_PLUGIN_REGISTRY
@@ -90,6 +84,8 @@ private:
   bufferlist m_out_bl;
   int m_error_result;
 
+  int64_t m_data_pool_id = -1;
+
   void send_v1_detect_header();
   Context *handle_v1_detect_header(int *result);
 
@@ -111,14 +107,7 @@ private:
   void send_v2_get_stripe_unit_count();
   Context *handle_v2_get_stripe_unit_count(int *result);
 
-  void send_v2_get_create_timestamp();
-  Context *handle_v2_get_create_timestamp(int *result);
-
-  void send_v2_get_access_modify_timestamp();
-  Context *handle_v2_get_access_modify_timestamp(int *result);
-
-  void send_v2_get_data_pool();
-  Context *handle_v2_get_data_pool(int *result);
+  void send_v2_init_layout();
 
   void send_refresh();
   Context *handle_refresh(int *result);
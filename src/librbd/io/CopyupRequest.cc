@@ -174,6 +174,15 @@ void CopyupRequest<I>::read_from_parent() {
     return;
   }
 
+  trim_parent_read();
+  if (m_image_extents.empty()) {
+    ldout(cct, 20) << "parent extents fully overwritten" << dendl;
+
+    m_image_ctx->asio_engine->post(
+      [this]() { handle_read_from_parent(-ENOENT); });
+    return;
+  }
+
   auto comp = AioCompletion::create_and_start<
     CopyupRequest<I>,
     &CopyupRequest<I>::handle_read_from_parent>(
@@ -216,6 +225,15 @@ void CopyupRequest<I>::handle_read_from_parent(int r) {
     m_lock.unlock();
     m_image_ctx->image_lock.unlock_shared();
 
+    if (r == -ERESTART) {
+      // a snapshot was created while the trimmed parent read was in
+      // flight -- the write-ops will re-issue the copyup in full
+      ldout(cct, 5) << "trimmed parent read requires full copy-up, "
+                    << "restarting" << dendl;
+      finish(r);
+      return;
+    }
+
     lderr(m_image_ctx->cct) << "failed to prepare copyup data: "
                             << cpp_strerror(r) << dendl;
     finish(r);
@@ -665,6 +683,72 @@ void CopyupRequest<I>::compute_deep_copy_snap_ids() {
     });
 }
 
+template <typename I>
+void CopyupRequest<I>::trim_parent_read() {
+  ceph_assert(ceph_mutex_is_locked(m_image_ctx->image_lock));
+  auto cct = m_image_ctx->cct;
+
+  // only a copyup that will be immediately followed by its write-ops to
+  // the HEAD revision can skip reading the parent extents that the
+  // write-ops overwrite. Encrypted images need to re-encrypt whole
+  // blocks so they always read the full parent extents.
+  if (!m_image_ctx->snapc.snaps.empty() ||
+      m_image_ctx->encryption_format != nullptr ||
+      m_image_area != ImageArea::DATA) {
+    return;
+  }
+
+  Extents write_object_extents;
+  {
+    std::lock_guard locker{m_lock};
+    if (m_pending_requests.empty() || m_write_object_extents.empty()) {
+      return;
+    }
+
+    write_object_extents.reserve(m_write_object_extents.num_intervals());
+    for (auto [offset, length] : m_write_object_extents) {
+      write_object_extents.emplace_back(offset, length);
+    }
+  }
+
+  auto [write_image_extents, area] = util::object_to_area_extents(
+    m_image_ctx, m_object_no, write_object_extents);
+  if (area != m_image_area) {
+    return;
+  }
+
+  interval_set<uint64_t> read_extents;
+  for (auto [offset, length] : m_image_extents) {
+    if (length > 0) {
+      read_extents.union_insert(offset, length);
+    }
+  }
+
+  interval_set<uint64_t> overwritten_extents;
+  for (auto [offset, length] : write_image_extents) {
+    if (length > 0) {
+      overwritten_extents.union_insert(offset, length);
+    }
+  }
+
+  interval_set<uint64_t> intersection;
+  intersection.intersection_of(read_extents, overwritten_extents);
+  if (intersection.empty()) {
+    return;
+  }
+  read_extents.subtract(intersection);
+
+  ldout(cct, 20) << "image_extents=" << m_image_extents << ", "
+                 << "trimmed_image_extents=" << read_extents << dendl;
+
+  m_image_extents.clear();
+  m_image_extents.reserve(read_extents.num_intervals());
+  for (auto [offset, length] : read_extents) {
+    m_image_extents.emplace_back(offset, length);
+  }
+  m_parent_read_trimmed = true;
+}
+
 template <typename I>
 void CopyupRequest<I>::convert_copyup_extent_map() {
   auto cct = m_image_ctx->cct;
@@ -699,6 +783,10 @@ int CopyupRequest<I>::prepare_copyup_data() {
   bool copy_on_read = m_pending_requests.empty();
   bool maybe_deep_copyup = !m_image_ctx->snapc.snaps.empty();
   if (copy_on_read || maybe_deep_copyup) {
+    if (m_parent_read_trimmed) {
+      return -ERESTART;
+    }
+
     // stand-alone copyup that will not be overwritten until HEAD revision
     ldout(cct, 20) << "processing full copy-up" << dendl;
 
@@ -91,6 +91,7 @@ private:
   bool m_copyup_required = true;
   bool m_copyup_is_zero = true;
   bool m_deep_copied = false;
+  bool m_parent_read_trimmed = false;
 
   Extents m_copyup_extent_map;
   ceph::bufferlist m_copyup_data;
@@ -133,6 +134,7 @@ private:
   bool is_deep_copy() const;
 
   void compute_deep_copy_snap_ids();
+  void trim_parent_read();
   void convert_copyup_extent_map();
   int prepare_copyup_data();
 };
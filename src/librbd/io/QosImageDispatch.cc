@@ -290,10 +290,17 @@ bool QosImageDispatch<I>::needs_throttle(
   }
   *dispatch_result = DISPATCH_RESULT_CONTINUE;
 
+  // throttles without a limit are all passed with a single flag update,
+  // which is the whole job when QoS is not configured for the image
   auto qos_enabled_flag = m_qos_enabled_flag;
+  all_qos_flags_set = set_throttle_flag(
+    image_dispatch_flags, IMAGE_DISPATCH_FLAG_QOS_MASK & ~qos_enabled_flag);
+  if (all_qos_flags_set) {
+    return false;
+  }
+
   for (auto [flag, throttle] : m_throttles) {
     if ((qos_enabled_flag & flag) == 0) {
-      all_qos_flags_set = set_throttle_flag(image_dispatch_flags, flag);
       continue;
     }
 
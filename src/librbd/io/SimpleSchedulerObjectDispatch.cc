@@ -66,10 +66,21 @@ bool SimpleSchedulerObjectDispatch<I>::ObjectRequests::try_delay_request(
     int op_flags, int object_dispatch_flags, Context* on_dispatched) {
   if (!m_delayed_requests.empty()) {
     if (!m_io_context || *m_io_context != *io_context ||
-        op_flags != m_op_flags || data.length() == 0 ||
-        intersects(object_off, data.length())) {
+        op_flags != m_op_flags || data.length() == 0) {
       return false;
     }
+
+    if (intersects(object_off, data.length())) {
+      // never merge into a delayed zero length write
+      if (!m_merge_overlapping ||
+          m_delayed_request_extents.range_end() == UINT64_MAX) {
+        return false;
+      }
+
+      m_object_dispatch_flags |= object_dispatch_flags;
+      merge_overlapping_request(object_off, std::move(data), on_dispatched);
+      return true;
+    }
   } else {
     m_io_context = io_context;
     m_op_flags = op_flags;
@@ -143,6 +154,60 @@ void SimpleSchedulerObjectDispatch<I>::ObjectRequests::try_merge_delayed_request
   m_delayed_requests.erase(iter2);
 }
 
+template <typename I>
+void SimpleSchedulerObjectDispatch<I>::ObjectRequests::merge_overlapping_request(
+    uint64_t object_off, ceph::bufferlist&& data, Context* on_dispatched) {
+  uint64_t object_end = object_off + data.length();
+  m_delayed_request_extents.union_insert(object_off, data.length());
+
+  // find the first delayed request that overlaps the new one
+  auto iter = m_delayed_requests.lower_bound(object_off);
+  if (iter != m_delayed_requests.begin()) {
+    auto prev = std::prev(iter);
+    if (prev->first + prev->second.data.length() > object_off) {
+      iter = prev;
+    }
+  }
+
+  // the new data replaces the overlapped portions of the delayed
+  // requests since it was issued after them
+  uint64_t merged_off = object_off;
+  ceph::bufferlist prefix;
+  ceph::bufferlist suffix;
+  std::list<Context *> requests;
+  while (iter != m_delayed_requests.end() && iter->first < object_end) {
+    auto off = iter->first;
+    auto &merged_requests = iter->second;
+    auto end = off + merged_requests.data.length();
+    if (off < object_off) {
+      prefix.substr_of(merged_requests.data, 0, object_off - off);
+      merged_off = off;
+    }
+    if (end > object_end) {
+      suffix.substr_of(merged_requests.data, object_end - off,
+                       end - object_end);
+    }
+    requests.splice(requests.end(), merged_requests.requests);
+    iter = m_delayed_requests.erase(iter);
+  }
+  requests.push_back(on_dispatched);
+
+  prefix.claim_append(data);
+  prefix.claim_append(suffix);
+
+  auto new_iter = m_delayed_requests.insert(
+    {merged_off, {std::move(prefix), std::move(requests)}}).first;
+
+  auto next = new_iter;
+  if (++next != m_delayed_requests.end()) {
+    try_merge_delayed_requests(new_iter, next);
+  }
+  if (new_iter != m_delayed_requests.begin()) {
+    auto prev = new_iter;
+    try_merge_delayed_requests(--prev, new_iter);
+  }
+}
+
 template <typename I>
 void SimpleSchedulerObjectDispatch<I>::ObjectRequests::dispatch_delayed_requests(
     I *image_ctx, LatencyStats *latency_stats, ceph::mutex *latency_stats_lock) {
@@ -183,7 +248,9 @@ SimpleSchedulerObjectDispatch<I>::SimpleSchedulerObjectDispatch(
     m_lock(ceph::make_mutex(librbd::util::unique_lock_name(
       "librbd::io::SimpleSchedulerObjectDispatch::lock", this))),
     m_max_delay(image_ctx->config.template get_val<uint64_t>(
-      "rbd_io_scheduler_simple_max_delay")) {
+      "rbd_io_scheduler_simple_max_delay")),
+    m_merge_overlapping(image_ctx->config.template get_val<bool>(
+      "rbd_io_scheduler_simple_merge_overlapping")) {
   CephContext *cct = m_image_ctx->cct;
   ldout(cct, 5) << "ictx=" << image_ctx << dendl;
 
@@ -432,7 +499,8 @@ template <typename I>
 void SimpleSchedulerObjectDispatch<I>::register_in_flight_request(
     uint64_t object_no, const utime_t &start_time, Context **on_finish) {
   auto res = m_requests.insert(
-      {object_no, std::make_shared<ObjectRequests>(object_no)});
+      {object_no, std::make_shared<ObjectRequests>(object_no,
+                                                   m_merge_overlapping)});
   ceph_assert(res.second);
   auto it = res.first;
 
@@ -128,7 +128,8 @@ private:
   public:
     using clock_t = ceph::real_clock;
 
-    ObjectRequests(uint64_t object_no) : m_object_no(object_no) {
+    ObjectRequests(uint64_t object_no, bool merge_overlapping)
+      : m_object_no(object_no), m_merge_overlapping(merge_overlapping) {
     }
 
     uint64_t get_object_no() const {
@@ -173,6 +174,7 @@ private:
 
   private:
     uint64_t m_object_no;
+    bool m_merge_overlapping;
     uint64_t m_dispatch_seq = 0;
     clock_t::time_point m_dispatch_time;
     IOContext m_io_context;
@@ -184,6 +186,9 @@ private:
     void try_merge_delayed_requests(
         typename std::map<uint64_t, MergedRequests>::iterator &iter,
         typename std::map<uint64_t, MergedRequests>::iterator &iter2);
+    void merge_overlapping_request(uint64_t object_off,
+                                   ceph::bufferlist&& data,
+                                   Context* on_dispatched);
   };
 
   typedef std::shared_ptr<ObjectRequests> ObjectRequestsRef;
@@ -197,6 +202,7 @@ private:
   SafeTimer *m_timer;
   ceph::mutex *m_timer_lock;
   uint64_t m_max_delay;
+  bool m_merge_overlapping;
   uint64_t m_dispatch_seq = 0;
 
   Requests m_requests;
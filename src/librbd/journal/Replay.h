@@ -118,6 +118,8 @@ private:
   };
 
   ImageCtxT &m_image_ctx;
+  const uint64_t m_in_flight_io_high_water_mark;
+  const uint64_t m_in_flight_io_low_water_mark;
 
   ceph::mutex m_lock = ceph::make_mutex("Replay<I>::m_lock");
 
@@ -6267,6 +6267,62 @@ extern "C" int rbd_aio_readv(rbd_image_t image, const struct iovec *iov,
   return r;
 }
 
+extern "C" int rbd_aio_submit_batch(rbd_image_t image,
+                                    const rbd_aio_batch_op_t *ops,
+                                    size_t num_ops)
+{
+  librbd::ImageCtx *ictx = (librbd::ImageCtx *)image;
+
+  // validate the whole batch up front so it is submitted all or nothing
+  std::vector<std::pair<size_t, size_t>> order;  // (index, length)
+  order.reserve(num_ops);
+  for (size_t i = 0; i < num_ops; ++i) {
+    const auto& op = ops[i];
+    size_t len;
+    if (op.c == nullptr ||
+        (op.type != RBD_AIO_BATCH_OP_READ &&
+         op.type != RBD_AIO_BATCH_OP_WRITE) ||
+        get_iovec_length(op.iov, op.iovcnt, len) < 0) {
+      return -EINVAL;
+    }
+    order.emplace_back(i, len);
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [ops](const auto& a, const auto& b) {
+                     return ops[a.first].off < ops[b.first].off;
+                   });
+
+  for (auto& [i, len] : order) {
+    const auto& op = ops[i];
+    auto comp = reinterpret_cast<librbd::RBD::AioCompletion *>(op.c);
+    auto aio_completion = get_aio_completion(comp);
+    if (op.type == RBD_AIO_BATCH_OP_WRITE) {
+      tracepoint(librbd, aio_write_enter, ictx, ictx->name.c_str(),
+                 ictx->snap_name.c_str(), ictx->read_only, op.off, len, NULL,
+                 comp->pc);
+      auto bl = iovec_to_bufferlist(ictx, op.iov, op.iovcnt, aio_completion);
+      librbd::api::Io<>::aio_write(
+        *ictx, aio_completion, op.off, len, std::move(bl), 0, true);
+      tracepoint(librbd, aio_write_exit, 0);
+    } else {
+      tracepoint(librbd, aio_read_enter, ictx, ictx->name.c_str(),
+                 ictx->snap_name.c_str(), ictx->read_only, op.off, len, NULL,
+                 comp->pc);
+      librbd::io::ReadResult read_result;
+      if (op.iovcnt == 1) {
+        read_result = librbd::io::ReadResult(
+          static_cast<char *>(op.iov[0].iov_base), op.iov[0].iov_len);
+      } else {
+        read_result = librbd::io::ReadResult(op.iov, op.iovcnt);
+      }
+      librbd::api::Io<>::aio_read(
+        *ictx, aio_completion, op.off, len, std::move(read_result), 0, true);
+      tracepoint(librbd, aio_read_exit, 0);
+    }
+  }
+  return 0;
+}
+
 extern "C" int rbd_flush(rbd_image_t image)
 {
   librbd::ImageCtx *ictx = (librbd::ImageCtx *)image;
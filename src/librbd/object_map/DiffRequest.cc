@@ -189,10 +189,36 @@ void DiffRequest<I>::handle_load_object_map(int r) {
 
   uint64_t overlap = std::min(m_object_map.size(), prev_object_diff_state_size);
   auto it = m_object_map.begin();
-  auto overlap_end_it = it + overlap;
   auto diff_it = m_object_diff_state->begin();
   uint64_t i = 0;
-  for (; it != overlap_end_it; ++it, ++diff_it, ++i) {
+
+  // both maps pack four objects per byte -- bytes where no object can
+  // change state (nonexistent objects that are already holes, clean
+  // objects that already have data) are skipped without decoding each
+  // object, which is most of the map when diffing a mostly idle image
+  auto map_byte_it = m_object_map.get_data().cbegin();
+  auto diff_byte_it = m_object_diff_state->get_data().cbegin();
+  while (i < overlap) {
+    if (i % 4 == 0) {
+      uint64_t skip_start = i;
+      while (i + 4 <= overlap) {
+        uint8_t map_byte = *map_byte_it;
+        uint8_t states_low = map_byte & 0x55;
+        if (states_low != ((map_byte >> 1) & 0x55) ||
+            states_low != (static_cast<uint8_t>(*diff_byte_it) & 0x55)) {
+          break;
+        }
+        ++map_byte_it;
+        ++diff_byte_it;
+        i += 4;
+      }
+      if (i != skip_start) {
+        it = m_object_map.begin() + i;
+        diff_it = m_object_diff_state->begin() + i;
+        continue;
+      }
+    }
+
     uint8_t object_map_state = *it;
     uint8_t prev_object_diff_state = *diff_it;
     if (object_map_state == OBJECT_EXISTS ||
@@ -212,6 +238,13 @@ void DiffRequest<I>::handle_load_object_map(int r) {
                    << "->" << static_cast<uint32_t>(*diff_it) << " ("
                    << static_cast<uint32_t>(object_map_state) << ")"
                    << dendl;
+
+    ++it;
+    ++diff_it;
+    if (++i % 4 == 0) {
+      ++map_byte_it;
+      ++diff_byte_it;
+    }
   }
   ldout(cct, 20) << "computed overlap diffs" << dendl;
 
@@ -7,6 +7,7 @@
 #include "librbd/AsyncObjectThrottle.h"
 #include "librbd/ExclusiveLock.h"
 #include "librbd/ImageCtx.h"
+#include "librbd/ObjectMap.h"
 #include "librbd/Utils.h"
 #include "librbd/deep_copy/ObjectCopyRequest.h"
 #include "librbd/io/AsyncOperation.h"
@@ -49,6 +50,18 @@ public:
       return -ERESTART;
     }
 
+    if (is_within_overlap_bounds()) {
+      std::shared_lock image_locker{image_ctx.image_lock};
+      if (image_ctx.object_map != nullptr &&
+          !image_ctx.object_map->object_may_not_exist(m_object_no)) {
+        // can skip because the object has already been copied up
+        // (e.g. by a write from the live workload or by an interrupted
+        // migration execute)
+        ldout(cct, 20) << "skipping existing object " << m_object_no << dendl;
+        return 1;
+      }
+    }
+
     start_async_op();
     return 0;
   }
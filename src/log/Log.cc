@@ -262,8 +262,12 @@ void Log::submit_entry(Entry&& e)
     m_cond_loggers.wait(lock);
   }
 
+  // the flusher only sleeps once it has drained m_new; while it is busy
+  // there is nobody to wake, so spare every logger the futex call
+  bool was_empty = m_new.empty();
   m_new.emplace_back(std::move(e));
-  m_cond_flusher.notify_all();
+  if (was_empty)
+    m_cond_flusher.notify_all();
   m_queue_mutex_holder = 0;
 }
 
@@ -378,8 +378,10 @@ public:
   SimpleLock lock; // FIXME referenced containers not in mempool
   LocalLockC versionlock; // FIXME referenced containers not in mempool
 
-  mempool::mds_co::map<client_t,ClientLease*> client_lease_map;
-  std::map<int, std::unique_ptr<BatchOp>> batch_ops;
+  // both are empty for almost every cached dentry; compact_map keeps
+  // that case down to a single pointer
+  mempool::mds_co::compact_map<client_t,ClientLease*> client_lease_map;
+  compact_map<int, std::unique_ptr<BatchOp>> batch_ops;
 
 
 protected:
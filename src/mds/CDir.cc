@@ -1558,7 +1558,7 @@ void CDir::fetch(std::string_view dname, snapid_t last,
 
   // FIXME: to fetch a snap dentry, we need to get omap key in range
   //       [(name, last), (name, CEPH_NOSNAP))
-  if (!dname.empty() && last == CEPH_NOSNAP && !g_conf().get_val<bool>("mds_dir_prefetch")) {
+  if (!dname.empty() && last == CEPH_NOSNAP && !should_prefetch()) {
     dentry_key_t key(last, dname, inode->hash_dentry_name(dname));
     fetch_keys({key}, c);
     return;
@@ -1583,6 +1583,26 @@ void CDir::fetch(std::string_view dname, snapid_t last,
   mdcache->mds->balancer->hit_dir(this, META_POP_FETCH);
 }
 
+bool CDir::should_prefetch() const
+{
+  if (!g_conf().get_val<bool>("mds_dir_prefetch"))
+    return false;
+
+  // loading a whole huge dirfrag to resolve a single name costs far more
+  // than the keyed read.  The fnode is not loaded yet, so estimate the
+  // size of this frag from the directory's total entry count.
+  auto max_entries = g_conf().get_val<uint64_t>("mds_dir_prefetch_max_entries");
+  if (max_entries == 0)
+    return true;
+  uint64_t est = inode->get_inode()->dirstat.size() >> frag.bits();
+  if (est > max_entries) {
+    dout(10) << __func__ << " ~" << est << " entries > " << max_entries
+	     << ", fetching by key" << dendl;
+    return false;
+  }
+  return true;
+}
+
 void CDir::fetch_keys(const std::vector<dentry_key_t>& keys, MDSContext *c)
 {
   dout(10) << __func__ << " " << keys.size() << " keys on " << *this << dendl;
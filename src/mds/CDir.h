@@ -484,6 +484,7 @@ public:
     fetch("", CEPH_NOSNAP, c, ignore_authpinnability);
   }
   void fetch_keys(const std::vector<dentry_key_t>& keys, MDSContext *c);
+  bool should_prefetch() const;
 
 #if 0  // unused?
   void wait_for_commit(Context *c, version_t v=0);
@@ -922,6 +922,20 @@ void MDBalancer::try_rebalance(balance_state_t& state)
   multimap<double, CDir*> import_pop_map;
   multimap<mds_rank_t, pair<CDir*, double> > import_from_map;
 
+  // forget imports whose cooldown has expired, and the ones we no
+  // longer hold
+  const auto now = clock::now();
+  const auto cooldown = g_conf().get_val<std::chrono::seconds>("mds_bal_import_cooldown");
+  for (auto p = recent_imports.begin(); p != recent_imports.end(); ) {
+    CDir *dir = mds->mdcache->get_dirfrag(p->first);
+    if (!dir || !dir->is_subtree_root() || !dir->is_auth() ||
+	now - p->second >= cooldown) {
+      p = recent_imports.erase(p);
+    } else {
+      ++p;
+    }
+  }
+
   for (auto& dir : mds->mdcache->get_fullauth_subtrees()) {
     CInode *diri = dir->get_inode();
     if (diri->is_mdsdir())
@@ -930,6 +944,12 @@ void MDBalancer::try_rebalance(balance_state_t& state)
       continue;
     if (dir->is_freezing() || dir->is_frozen())
       continue;  // export pbly already in progress
+    if (in_import_cooldown(dir, now)) {
+      // still settling in; moving it again right away is what makes
+      // subtrees thrash between ranks
+      dout(15) << "  skipping recent import " << *dir << dendl;
+      continue;
+    }
 
     mds_rank_t from = diri->authority().first;
     double pop = dir->pop_auth_subtree.meta_load();
@@ -1361,6 +1381,10 @@ void MDBalancer::add_import(CDir *dir)
 {
   dirfrag_load_vec_t subload = dir->pop_auth_subtree;
 
+  if (g_conf().get_val<std::chrono::seconds>("mds_bal_import_cooldown").count() > 0) {
+    recent_imports[dir->dirfrag()] = clock::now();
+  }
+
   while (true) {
     dir = dir->inode->get_parent_dir();
     if (!dir) break;
@@ -1402,6 +1426,15 @@ void MDBalancer::adjust_pop_for_rename(CDir *pdir, CDir *dir, bool inc)
   }
 }
 
+bool MDBalancer::in_import_cooldown(CDir *dir, time now) const
+{
+  auto it = recent_imports.find(dir->dirfrag());
+  if (it == recent_imports.end())
+    return false;
+  auto cooldown = g_conf().get_val<std::chrono::seconds>("mds_bal_import_cooldown");
+  return now - it->second < cooldown;
+}
+
 void MDBalancer::handle_mds_failure(mds_rank_t who)
 {
   if (0 == who) {
@@ -147,6 +147,11 @@ private:
   // dirfrags that already have one in flight.
   std::set<dirfrag_t> split_pending, merge_pending;
 
+  // When each subtree we hold was imported, so that the balancer does
+  // not bounce a subtree straight back out (mds_bal_import_cooldown).
+  std::map<dirfrag_t, time> recent_imports;
+  bool in_import_cooldown(CDir *dir, time now) const;
+
   // per-epoch scatter/gathered info
   std::map<mds_rank_t, mds_load_t> mds_load;
   std::map<mds_rank_t, double> mds_meta_load;
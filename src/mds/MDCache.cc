@@ -9345,18 +9345,28 @@ void MDCache::open_ino_batch_submit()
   dout(10) << __func__ << dendl;
   open_ino_batch = false;
 
+  // past this many wanted dentries, reading the whole dirfrag is cheaper
+  // than an omap lookup with a huge key list
+  const uint64_t full_fetch_keys =
+    g_conf().get_val<uint64_t>("mds_open_ino_batch_full_fetch_keys");
+
   for (auto& [dir, p] : open_ino_batched_fetch) {
-    CInode *in = dir->inode;
-    std::vector<dentry_key_t> keys;
-    for (auto& dname : p.first)
-      keys.emplace_back(CEPH_NOSNAP, dname, in->hash_dentry_name(dname));
-    dir->fetch_keys(keys,
-	  new MDSInternalContextWrapper(mds,
-	    new LambdaContext([this, waiters = std::move(p.second)](int r) mutable {
-	      mds->queue_waiters_front(waiters);
-	    })
-	  )
-	);
+    auto fin = new MDSInternalContextWrapper(mds,
+	new LambdaContext([this, waiters = std::move(p.second)](int r) mutable {
+	  mds->queue_waiters_front(waiters);
+	})
+      );
+    if (full_fetch_keys && p.first.size() >= full_fetch_keys) {
+      dout(10) << __func__ << " fetching whole " << *dir << " for "
+	       << p.first.size() << " dentries" << dendl;
+      dir->fetch(fin);
+    } else {
+      CInode *in = dir->inode;
+      std::vector<dentry_key_t> keys;
+      for (auto& dname : p.first)
+	keys.emplace_back(CEPH_NOSNAP, dname, in->hash_dentry_name(dname));
+      dir->fetch_keys(keys, fin);
+    }
     if (mds->logger)
       mds->logger->inc(l_mds_openino_dir_fetch);
   }
@@ -424,8 +424,7 @@ bool MDRequestImpl::can_batch()
 
 std::unique_ptr<BatchOp> MDRequestImpl::release_batch_op()
 {
-  int mask = client_request->head.args.getattr.mask;
-  auto it = batch_op_map->find(mask);
+  auto it = batch_op_map->find(batch_mask);
   std::unique_ptr<BatchOp> bop = std::move(it->second);
   batch_op_map->erase(it);
   return bop;
@@ -18,6 +18,7 @@
 #include "include/interval_set.h"
 #include "include/elist.h"
 #include "include/filepath.h"
+#include "include/compact_map.h"
 
 #include "MDSCacheObject.h"
 #include "MDSContext.h"
@@ -446,7 +447,10 @@ struct MDRequestImpl : public MutationImpl {
   // indicates how may retries of request have been made
   int retry = 0;
 
-  std::map<int, std::unique_ptr<BatchOp> > *batch_op_map = nullptr;
+  compact_map<int, std::unique_ptr<BatchOp> > *batch_op_map = nullptr;
+  // key of our entry in *batch_op_map: the getattr mask the batch head
+  // locks for, a superset of the mask of every request in the batch
+  int batch_mask = 0;
 
   // indicator for vxattr osdmap update
   bool waited_for_osdmap = false;
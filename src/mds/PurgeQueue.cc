@@ -376,7 +376,12 @@ uint32_t PurgeQueue::_calculate_ops(const PurgeItem &item) const
     const uint64_t num = (item.size > 0) ?
       Striper::get_num_objects(item.layout, item.size) : 1;
 
-    ops_required = num;
+    // Filer::purge_range() never has more than filer_max_purge_ops
+    // deletes of one file outstanding.  Charging every object of a
+    // large file would let it take the whole budget and purge large
+    // files strictly one at a time.
+    ops_required = std::min<uint64_t>(
+      num, std::max<uint64_t>(cct->_conf->filer_max_purge_ops, 1));
 
     // Account for deletions for old pools
     if (item.action != PurgeItem::TRUNCATE_FILE) {
@@ -601,6 +606,7 @@ void PurgeQueue::_execute_item(
                               in_flight.size());
   logger->set(l_pq_executing_high_water, files_high_water);
   auto ops = _calculate_ops(item);
+  in_flight_ops[expire_to] = ops;
   ops_in_flight += ops;
   logger->set(l_pq_executing_ops, ops_in_flight);
   ops_high_water = std::max(ops_high_water, ops_in_flight);
@@ -664,6 +670,7 @@ void PurgeQueue::_execute_item(
     ops_high_water = std::max(ops_high_water, ops_in_flight);
     logger->set(l_pq_executing_ops_high_water, ops_high_water);
     in_flight.erase(expire_to);
+    in_flight_ops.erase(expire_to);
     logger->set(l_pq_executing, in_flight.size());
     files_high_water = std::max<uint64_t>(files_high_water,
                                 in_flight.size());
@@ -710,7 +717,10 @@ void PurgeQueue::_execute_item_complete(
     pending_expire.insert(expire_to);
   }
 
-  ops_in_flight -= _calculate_ops(iter->second);
+  auto ops_iter = in_flight_ops.find(expire_to);
+  ceph_assert(ops_iter != in_flight_ops.end());
+  ops_in_flight -= ops_iter->second;
+  in_flight_ops.erase(ops_iter);
   logger->set(l_pq_executing_ops, ops_in_flight);
   ops_high_water = std::max(ops_high_water, ops_in_flight);
   logger->set(l_pq_executing_ops_high_water, ops_high_water);
@@ -219,6 +219,9 @@ private:
 
   // Map of Journaler offset to PurgeItem
   std::map<uint64_t, PurgeItem> in_flight;
+  // Journaler offset -> ops charged to ops_in_flight for that item, so
+  // completion gives back what was taken even if the limits changed
+  std::map<uint64_t, uint32_t> in_flight_ops;
 
   std::set<uint64_t> pending_expire;
 
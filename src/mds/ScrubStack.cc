@@ -234,6 +234,31 @@ void ScrubStack::kick_off_scrubs()
       ceph_assert(0 == "dentry in scrub stack");
     }
   }
+
+  prefetch_dirfrags();
+}
+
+void ScrubStack::prefetch_dirfrags()
+{
+  uint64_t max = g_conf().get_val<uint64_t>("mds_scrub_dirfrag_prefetch");
+  if (!max)
+    return;
+
+  // dirfrags are queued at the top of the stack, so only the leading
+  // run of dirfrags is considered
+  uint64_t fetching = 0;
+  for (auto it = scrub_stack.begin(); !it.end() && fetching < max; ++it) {
+    CDir *dir = dynamic_cast<CDir*>(*it);
+    if (!dir)
+      break;
+    if (!dir->is_auth() || dir->is_complete())
+      continue;
+    if (!dir->state_test(CDir::STATE_FETCHING)) {
+      dout(20) << __func__ << " " << *dir << dendl;
+      dir->fetch(nullptr, true); // already auth pinned
+    }
+    fetching++;
+  }
 }
 
 bool ScrubStack::validate_inode_auth(CInode *in)
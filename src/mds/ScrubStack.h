@@ -179,6 +179,12 @@ private:
    * forword scrub to auth mds.
    */
   bool validate_inode_auth(CInode *in);
+  /**
+   * Start fetching incomplete dirfrags waiting in the stack, up to
+   * mds_scrub_dirfrag_prefetch of them, so their omap reads overlap
+   * with the scrub operations already in progress.
+   */
+  void prefetch_dirfrags();
 
   /**
    * Scrub a file inode.
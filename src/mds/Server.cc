@@ -97,6 +97,7 @@ public:
       mdr->batch_op_map = &mdr->dn[0].back()->batch_ops;
     else
       mdr->batch_op_map = &mdr->in[0]->batch_ops;
+    mdr->batch_mask = mdr->client_request->head.args.getattr.mask;
   }
   void add_request(const ceph::ref_t<MDRequestImpl>& r) override {
     batch_reqs.push_back(r);
@@ -109,6 +110,7 @@ public:
 	continue;
 
       r->batch_op_map = mdr->batch_op_map;
+      r->batch_mask = mdr->batch_mask;
       mdr->batch_op_map = nullptr;
       mdr = r;
       return mdr;
@@ -2519,8 +2521,7 @@ void Server::dispatch_client_request(MDRequestRef& mdr)
     //if the mdr is a "batch_op" and it has followers, pick a follower as
     //the new "head of the batch ops" and go on processing the new one.
     if (mdr->is_batch_head()) {
-      int mask = mdr->client_request->head.args.getattr.mask;
-      auto it = mdr->batch_op_map->find(mask);
+      auto it = mdr->batch_op_map->find(mdr->batch_mask);
       auto new_batch_head = it->second->find_new_head();
       if (!new_batch_head) {
 	mdr->batch_op_map->erase(it);
@@ -3909,9 +3910,12 @@ void Server::handle_client_getattr(MDRequestRef& mdr, bool is_lookup)
     return;
   }
 
-  bool want_auth = false;
   int mask = req->head.args.getattr.mask;
-  if (mask & CEPH_STAT_RSTAT)
+  // a batch head locks for every request riding on it; a head promoted
+  // from the followers inherits the mask of the batch
+  int lock_mask = mdr->is_batch_head() ? mdr->batch_mask : mask;
+  bool want_auth = false;
+  if (lock_mask & CEPH_STAT_RSTAT)
     want_auth = true; // set want_auth for CEPH_STAT_RSTAT mask
 
   if (!mdr->is_batch_head() && mdr->can_batch()) {
@@ -3924,26 +3928,29 @@ void Server::handle_client_getattr(MDRequestRef& mdr, bool is_lookup)
 
     if (r < 0) {
       // fall-thru. let rdlock_path_pin_ref() check again.
-    } else if (is_lookup) {
-      CDentry* dn = mdr->dn[0].back();
-      mdr->pin(dn);
-      auto em = dn->batch_ops.emplace(std::piecewise_construct, std::forward_as_tuple(mask), std::forward_as_tuple());
-      if (em.second) {
-	em.first->second = std::make_unique<Batch_Getattr_Lookup>(this, mdr);
-      } else {
-	dout(20) << __func__ << ": LOOKUP op, wait for previous same getattr ops to respond. " << *mdr << dendl;
-	em.first->second->add_request(mdr);
-	return;
-      }
     } else {
-      CInode *in = mdr->in[0];
-      mdr->pin(in);
-      auto em = in->batch_ops.emplace(std::piecewise_construct, std::forward_as_tuple(mask), std::forward_as_tuple());
-      if (em.second) {
-	em.first->second = std::make_unique<Batch_Getattr_Lookup>(this, mdr);
+      auto& batch_ops = is_lookup ? mdr->dn[0].back()->batch_ops
+				  : mdr->in[0]->batch_ops;
+      if (is_lookup)
+	mdr->pin(mdr->dn[0].back());
+      else
+	mdr->pin(mdr->in[0]);
+      // prefer an in-flight request for the same mask, else any whose
+      // mask covers ours: its locks and reply trace serve us as well
+      auto it = batch_ops.find(mask);
+      if (it == batch_ops.end()) {
+	for (it = batch_ops.begin(); it != batch_ops.end(); ++it) {
+	  if ((it->first & mask) == mask)
+	    break;
+	}
+      }
+      if (it == batch_ops.end()) {
+	batch_ops.emplace(mask, std::make_unique<Batch_Getattr_Lookup>(this, mdr));
       } else {
-	dout(20) << __func__ << ": GETATTR op, wait for previous same getattr ops to respond. " << *mdr << dendl;
-	em.first->second->add_request(mdr);
+	dout(20) << __func__ << ": " << (is_lookup ? "LOOKUP" : "GETATTR")
+		 << " op, wait for previous getattr ops (mask " << ccap_string(it->first)
+		 << ") to respond. " << *mdr << dendl;
+	it->second->add_request(mdr);
 	return;
       }
     }
@@ -3970,13 +3977,13 @@ void Server::handle_client_getattr(MDRequestRef& mdr, bool is_lookup)
 
   // FIXME
   MutationImpl::LockOpVec lov;
-  if ((mask & CEPH_CAP_LINK_SHARED) && !(issued & CEPH_CAP_LINK_EXCL))
+  if ((lock_mask & CEPH_CAP_LINK_SHARED) && !(issued & CEPH_CAP_LINK_EXCL))
     lov.add_rdlock(&ref->linklock);
-  if ((mask & CEPH_CAP_AUTH_SHARED) && !(issued & CEPH_CAP_AUTH_EXCL))
+  if ((lock_mask & CEPH_CAP_AUTH_SHARED) && !(issued & CEPH_CAP_AUTH_EXCL))
     lov.add_rdlock(&ref->authlock);
-  if ((mask & CEPH_CAP_XATTR_SHARED) && !(issued & CEPH_CAP_XATTR_EXCL))
+  if ((lock_mask & CEPH_CAP_XATTR_SHARED) && !(issued & CEPH_CAP_XATTR_EXCL))
     lov.add_rdlock(&ref->xattrlock);
-  if ((mask & CEPH_CAP_FILE_SHARED) && !(issued & CEPH_CAP_FILE_EXCL)) {
+  if ((lock_mask & CEPH_CAP_FILE_SHARED) && !(issued & CEPH_CAP_FILE_EXCL)) {
     // Don't wait on unstable filelock if client is allowed to read file size.
     // This can reduce the response time of getattr in the case that multiple
     // clients do stat(2) and there are writers.
@@ -392,6 +392,9 @@ void SessionMap::save(MDSContext *onsave, version_t needv)
   object_t oid = get_object_name();
   object_locator_t oloc(mds->get_metadata_pool());
 
+  C_GatherBuilder gather(g_ceph_context,
+			 new C_OnFinisher(new C_IO_SM_Save(this, version),
+					  mds->finisher));
   ObjectOperation op;
 
   /* Compose OSD OMAP transaction for full write */
@@ -402,13 +405,15 @@ void SessionMap::save(MDSContext *onsave, version_t needv)
   /* If we loaded a legacy sessionmap, then erase the old data.  If
    * an old-versioned MDS tries to read it, it'll fail out safely
    * with an end_of_buffer exception */
-  if (loaded_legacy) {
+  const bool legacy_upgrade = loaded_legacy;
+  if (legacy_upgrade) {
     dout(4) << __func__ << " erasing legacy sessionmap" << dendl;
     op.truncate(0);
     loaded_legacy = false;  // only need to truncate once.
   }
 
   dout(20) << " updating keys:" << dendl;
+  const uint32_t kpo = g_conf()->mds_sessionmap_keys_per_op;
   map<string, bufferlist> to_set;
   for(std::set<entity_name_t>::iterator i = dirty_sessions.begin();
       i != dirty_sessions.end(); ++i) {
@@ -432,6 +437,18 @@ void SessionMap::save(MDSContext *onsave, version_t needv)
       to_set[std::string(css->strv())] = bl;
 
       session->clear_dirty_completed_requests();
+
+      /* Send full batches ahead of the op carrying the header.  It's never
+       * a problem to have an overly-fresh copy of a session on disk, so
+       * these may land first; removals stay with the header. */
+      if (!legacy_upgrade && kpo && to_set.size() >= kpo) {
+	ObjectOperation batch_op;
+	batch_op.omap_set(to_set);
+	to_set.clear();
+	mds->objecter->mutate(oid, oloc, batch_op, snapc,
+			      ceph::real_clock::now(), 0,
+			      gather.new_sub());
+      }
     } else {
       dout(20) << "  " << name << " (ignoring)" << dendl;
     }
@@ -459,8 +476,8 @@ void SessionMap::save(MDSContext *onsave, version_t needv)
   mds->objecter->mutate(oid, oloc, op, snapc,
 			ceph::real_clock::now(),
 			0,
-			new C_OnFinisher(new C_IO_SM_Save(this, version),
-					 mds->finisher));
+			gather.new_sub());
+  gather.activate();
 }
 
 void SessionMap::_save_finish(version_t v)
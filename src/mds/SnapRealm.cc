@@ -67,7 +67,7 @@ SnapRealm::SnapRealm(MDCache *c, CInode *in) :
  * get list of snaps for this realm.  we must include parents' snaps
  * for the intervals during which they were our parent.
  */
-void SnapRealm::build_snap_set() const
+void SnapRealm::build_snap_set(set<snapid_t> *past) const
 {
   dout(10) << "build_snap_set on " << *this << dendl;
 
@@ -83,13 +83,13 @@ void SnapRealm::build_snap_set() const
     cached_snaps.insert(p.first);
 
   if (!srnode.past_parent_snaps.empty()) {
-    set<snapid_t> snaps = mdcache->mds->snapclient->filter(srnode.past_parent_snaps);
-    if (!snaps.empty()) {
-      snapid_t last = *snaps.rbegin();
+    *past = mdcache->mds->snapclient->filter(srnode.past_parent_snaps);
+    if (!past->empty()) {
+      snapid_t last = *past->rbegin();
       cached_seq = std::max(cached_seq, last);
       cached_last_created = std::max(cached_last_created, last);
     }
-    cached_snaps.insert(snaps.begin(), snaps.end());
+    cached_snaps.insert(past->begin(), past->end());
   }
 
   snapid_t parent_seq = parent ? parent->get_newest_seq() : snapid_t(0);
@@ -130,9 +130,11 @@ void SnapRealm::check_cache() const
   if (!cached_subvolume_ino && srnode.is_subvolume())
     cached_subvolume_ino = inode->ino();
 
-  build_snap_set();
+  // past parent snaps still alive; shared by the snap set and the trace
+  set<snapid_t> past;
+  build_snap_set(&past);
 
-  build_snap_trace();
+  build_snap_trace(past);
   
   dout(10) << "check_cache rebuilt " << cached_snaps
 	   << " seq " << seq
@@ -385,7 +387,7 @@ const bufferlist& SnapRealm::get_snap_trace() const
   return cached_snap_trace;
 }
 
-void SnapRealm::build_snap_trace() const
+void SnapRealm::build_snap_trace(const set<snapid_t>& past_snaps) const
 {
   cached_snap_trace.clear();
 
@@ -404,20 +406,14 @@ void SnapRealm::build_snap_trace() const
   if (parent) {
     info.h.parent = parent->inode->ino();
 
-    set<snapid_t> past;
-    if (!srnode.past_parent_snaps.empty()) {
-      past = mdcache->mds->snapclient->filter(srnode.past_parent_snaps);
-      if (srnode.is_parent_global()) {
-	auto p = past.lower_bound(srnode.current_parent_since);
-	past.erase(p, past.end());
-      }
-    }
+    auto past_end = past_snaps.end();
+    if (srnode.is_parent_global())
+      past_end = past_snaps.lower_bound(srnode.current_parent_since);
 
-    if (!past.empty()) {
-      info.prior_parent_snaps.reserve(past.size());
-      for (set<snapid_t>::reverse_iterator p = past.rbegin(); p != past.rend(); ++p)
+    if (past_end != past_snaps.begin()) {
+      for (auto p = std::make_reverse_iterator(past_end); p != past_snaps.rend(); ++p)
 	info.prior_parent_snaps.push_back(*p);
-      dout(10) << "build_snap_trace prior_parent_snaps from [1," << *past.rbegin() << "] "
+      dout(10) << "build_snap_trace prior_parent_snaps from [1," << info.prior_parent_snaps.front() << "] "
 	       << info.prior_parent_snaps << dendl;
     }
   }
@@ -41,11 +41,11 @@ public:
     return !srnode.past_parent_snaps.empty();
   }
 
-  void build_snap_set() const;
+  void build_snap_set(std::set<snapid_t> *past) const;
   void get_snap_info(std::map<snapid_t, const SnapInfo*>& infomap, snapid_t first=0, snapid_t last=CEPH_NOSNAP);
 
   const ceph::buffer::list& get_snap_trace() const;
-  void build_snap_trace() const;
+  void build_snap_trace(const std::set<snapid_t>& past) const;
 
   std::string_view get_snapname(snapid_t snapid, inodeno_t atino);
   snapid_t resolve_snapname(std::string_view name, inodeno_t atino, snapid_t first=0, snapid_t last=CEPH_NOSNAP);
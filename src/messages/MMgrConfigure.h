@@ -25,7 +25,7 @@
  */
 class MMgrConfigure : public Message {
 private:
-  static constexpr int HEAD_VERSION = 4;
+  static constexpr int HEAD_VERSION = 5;
   static constexpr int COMPAT_VERSION = 1;
 
 public:
@@ -38,6 +38,10 @@ public:
 
   boost::optional<MetricConfigMessage> metric_config_message;
 
+  // If set, the client may omit unchanged counter values from the
+  // packed data of its MMgrReports (packed encoding v2)
+  bool delta_reports = false;
+
   void decode_payload() override
   {
     using ceph::decode;
@@ -52,6 +56,9 @@ public:
     if (header.version >= 4) {
       decode(metric_config_message, p);
     }
+    if (header.version >= 5) {
+      decode(delta_reports, p);
+    }
   }
 
   void encode_payload(uint64_t features) override {
@@ -65,12 +72,17 @@ public:
       boost::optional<MetricConfigMessage> empty;
       encode(empty, payload);
     }
+    encode(delta_reports, payload);
   }
 
   std::string_view get_type_name() const override { return "mgrconfigure"; }
   void print(std::ostream& out) const override {
     out << get_type_name() << "(period=" << stats_period
-			   << ", threshold=" << stats_threshold << ")";
+			   << ", threshold=" << stats_threshold;
+    if (delta_reports) {
+      out << ", delta";
+    }
+    out << ")";
   }
 
 private:
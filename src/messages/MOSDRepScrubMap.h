@@ -23,7 +23,7 @@
 
 class MOSDRepScrubMap final : public MOSDFastDispatchOp {
 public:
-  static constexpr int HEAD_VERSION = 2;
+  static constexpr int HEAD_VERSION = 3;
   static constexpr int COMPAT_VERSION = 1;
 
   spg_t pgid;            // primary spg_t
@@ -31,6 +31,9 @@ public:
   pg_shard_t from;   // whose scrubmap this is
   ceph::buffer::list scrub_map_bl;
   bool preempted = false;
+  /// how long the sender's scrub read budget asks the primary to wait
+  /// before requesting the next chunk
+  uint32_t budget_delay_ms = 0;
 
   epoch_t get_map_epoch() const override {
     return map_epoch;
@@ -56,7 +59,11 @@ public:
   void print(std::ostream& out) const override {
     out << "rep_scrubmap(" << pgid << " e" << map_epoch
 	<< " from shard " << from
-	<< (preempted ? " PREEMPTED":"") << ")";
+	<< (preempted ? " PREEMPTED":"");
+    if (budget_delay_ms) {
+      out << " delay " << budget_delay_ms << "ms";
+    }
+    out << ")";
   }
 
   void encode_payload(uint64_t features) override {
@@ -65,6 +72,7 @@ public:
     encode(map_epoch, payload);
     encode(from, payload);
     encode(preempted, payload);
+    encode(budget_delay_ms, payload);
   }
   void decode_payload() override {
     using ceph::decode;
@@ -75,6 +83,9 @@ public:
     if (header.version >= 2) {
       decode(preempted, p);
     }
+    if (header.version >= 3) {
+      decode(budget_delay_ms, p);
+    }
   }
 private:
   template<class T, typename... Args>
@@ -185,8 +185,110 @@ void ActivePyModules::update_cache_metrics() {
     perfcounter->set(l_mgr_cache_miss, hit_miss_ratio.second);
 }
 
+std::shared_ptr<const std::string> ActivePyModules::find_snapshot(
+  const std::string &what,
+  version_t version)
+{
+  std::lock_guard l(snapshot_lock);
+  auto i = map_snapshots.find(what);
+  if (i == map_snapshots.end() || i->second.version != version) {
+    return nullptr;
+  }
+  return i->second.json;
+}
+
+void ActivePyModules::store_snapshot(
+  const std::string &what,
+  version_t version,
+  std::shared_ptr<const std::string> json)
+{
+  std::lock_guard l(snapshot_lock);
+  auto& snap = map_snapshots[what];
+  // a concurrent caller may have stored a newer map already
+  if (!snap.json || snap.version <= version) {
+    snap.version = version;
+    snap.json = std::move(json);
+  }
+}
+
+/**
+ * Serve the large per-map dumps from a JSON snapshot of the current
+ * OSDMap epoch or PGMap version.  The dump itself is done without the
+ * GIL, so other modules keep running while it is built, and it is only
+ * rebuilt when the underlying map changes.  The snapshot is handed to
+ * python as bytes, which MgrModule.get() decodes into fresh objects.
+ *
+ * @return nullptr if @c what is not served from snapshots
+ */
+PyObject *ActivePyModules::get_python_snapshot(const std::string &what)
+{
+  const bool osdmap_key = (what == "osd_map" ||
+                           what == "osd_map_tree" ||
+                           what == "osd_map_crush");
+  const bool pgmap_key = (what == "pg_dump" ||
+                          what == "pg_stats" ||
+                          what == "pool_stats" ||
+                          what == "osd_stats");
+  if (!osdmap_key && !pgmap_key) {
+    return nullptr;
+  }
+
+  std::shared_ptr<const std::string> json;
+  {
+    without_gil_t no_gil;
+    auto dump = [&](version_t version, auto&& dump_fn) {
+      json = find_snapshot(what, version);
+      if (json) {
+        return;
+      }
+      JSONFormatter jf;
+      jf.open_object_section("");
+      dump_fn(&jf);
+      jf.close_section();
+      std::ostringstream ss;
+      jf.flush(ss);
+      json = std::make_shared<const std::string>(std::move(ss).str());
+      store_snapshot(what, version, json);
+    };
+    if (osdmap_key) {
+      cluster_state.with_osdmap([&](const OSDMap &osd_map) {
+        dump(osd_map.get_epoch(), [&](Formatter *f) {
+          if (what == "osd_map") {
+            osd_map.dump(f, g_ceph_context);
+          } else if (what == "osd_map_tree") {
+            osd_map.print_tree(f, nullptr);
+          } else {
+            osd_map.crush->dump(f);
+          }
+        });
+      });
+    } else {
+      cluster_state.with_pgmap([&](const PGMap &pg_map) {
+        dump(pg_map.get_version(), [&](Formatter *f) {
+          if (what == "pg_dump") {
+            pg_map.dump(f, false);
+          } else if (what == "pg_stats") {
+            pg_map.dump_pg_stats(f, false);
+          } else if (what == "pool_stats") {
+            pg_map.dump_pool_stats(f);
+          } else {
+            pg_map.dump_osd_stats(f, false);
+          }
+        });
+      });
+    }
+  }
+  return PyBytes_FromStringAndSize(json->data(), json->size());
+}
+
 PyObject *ActivePyModules::cacheable_get_python(const std::string &what)
 {
+  if (g_conf().get_val<bool>("mgr_map_snapshot_cache")) {
+    if (PyObject *obj = get_python_snapshot(what); obj) {
+      return obj;
+    }
+  }
+
   uint64_t ttl_seconds = g_conf().get_val<uint64_t>("mgr_ttl_cache_expire_seconds");
   if(ttl_seconds > 0) {
     ttl_cache.set_ttl(ttl_seconds);
@@ -57,6 +57,15 @@ class ActivePyModules
   Client   &client;
   Finisher &finisher;
   TTLCache<std::string, PyObject*> ttl_cache;
+
+  // JSON snapshots of the large cluster maps, keyed by name and tagged
+  // with the OSDMap epoch / PGMap version they were dumped from
+  struct map_snapshot_t {
+    version_t version = 0;
+    std::shared_ptr<const std::string> json;
+  };
+  ceph::mutex snapshot_lock = ceph::make_mutex("ActivePyModules::snapshot_lock");
+  std::map<std::string, map_snapshot_t> map_snapshots;
 public:
   Finisher cmd_finisher;
 private:
@@ -83,6 +92,7 @@ public:
   Objecter  &get_objecter() {return objecter;}
   Client    &get_client() {return client;}
   PyObject *cacheable_get_python(const std::string &what);
+  PyObject *get_python_snapshot(const std::string &what);
   PyObject *get_python(const std::string &what);
   PyObject *get_server_python(const std::string &hostname);
   PyObject *list_servers_python();
@@ -226,5 +236,9 @@ public:
 
   bool inject_python_on() const;
   void update_cache_metrics();
+  std::shared_ptr<const std::string> find_snapshot(const std::string &what,
+                                                   version_t version);
+  void store_snapshot(const std::string &what, version_t version,
+                      std::shared_ptr<const std::string> json);
 };
 
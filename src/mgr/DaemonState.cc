@@ -396,7 +396,15 @@ void DaemonPerfCounters::update(const MMgrReport& report)
 
   // Parse packed data according to declared set of types
   auto p = report.packed.cbegin();
-  DECODE_START(1, p);
+  DECODE_START(2, p);
+  uint32_t num_changed = 0;
+  uint32_t skip = 0;
+  if (struct_v >= 2) {
+    decode(num_changed, p);
+    if (num_changed) {
+      decode(skip, p);
+    }
+  }
   for (const auto &t_path : session->declared_types) {
     const auto &t = types.at(t_path);
     auto instances_it = instances.find(t_path);
@@ -406,17 +414,48 @@ void DaemonPerfCounters::update(const MMgrReport& report)
     if (instances_it == instances.end()) {
       instances_it = instances.insert({t_path, t.type}).first;
     }
+    auto& instance = instances_it->second;
     uint64_t val = 0;
     uint64_t avgcount = 0;
     uint64_t avgcount2 = 0;
 
+    if (struct_v >= 2) {
+      if (num_changed == 0 || skip > 0) {
+        // unchanged since the last report: carry the last value forward
+        // so rates computed over the buffer stay correct
+        if (num_changed) {
+          --skip;
+        }
+        if (t.type & PERFCOUNTER_LONGRUNAVG) {
+          if (!instance.get_data_avg().empty()) {
+            const auto& last = instance.get_latest_data_avg();
+            instance.push_avg(now, last.s, last.c);
+          }
+        } else if (!instance.get_data().empty()) {
+          instance.push(now, instance.get_latest_data().v);
+        }
+        continue;
+      }
+      decode(val, p);
+      if (t.type & PERFCOUNTER_LONGRUNAVG) {
+        decode(avgcount, p);
+        instance.push_avg(now, val, avgcount);
+      } else {
+        instance.push(now, val);
+      }
+      if (--num_changed) {
+        decode(skip, p);
+      }
+      continue;
+    }
+
     decode(val, p);
     if (t.type & PERFCOUNTER_LONGRUNAVG) {
       decode(avgcount, p);
       decode(avgcount2, p);
-      instances_it->second.push_avg(now, val, avgcount);
+      instance.push_avg(now, val, avgcount);
     } else {
-      instances_it->second.push(now, val);
+      instance.push(now, val);
     }
   }
   DECODE_FINISH(p);
@@ -340,9 +340,19 @@ void MgrClient::_send_report()
       report->undeclare_types.push_back(path);
       ldout(cct,20) << " undeclare " << path << dendl;
       session->declared.erase(path);
+      session->last_sent.erase(path);
     };
 
-    ENCODE_START(1, 1, report->packed);
+    // With delta reports, only counters whose value moved since the
+    // last report are sent, each prefixed by the number of declared
+    // counters skipped before it.  The mgr carries the others forward.
+    const bool delta = delta_reports;
+    uint32_t skipped = 0;
+    uint32_t num_changed = 0;
+    ceph::buffer::list values;
+
+    const __u8 packed_v = delta ? 2 : 1;
+    ENCODE_START(packed_v, packed_v, report->packed);
 
     // Find counters that no longer exist, and undeclare them
     for (auto p = session->declared.begin(); p != session->declared.end(); ) {
@@ -383,19 +393,50 @@ void MgrClient::_send_report()
 	session->declared.insert(path);
       }
 
-      encode(static_cast<uint64_t>(data.u64), report->packed);
+      std::pair<uint64_t, uint64_t> cur;
+      if (data.type & PERFCOUNTER_LONGRUNAVG) {
+        cur = perf_counters.read_avg(data);
+      } else {
+        cur = {perf_counters.read_u64(data), 0};
+      }
+
+      if (!delta) {
+        encode(cur.first, report->packed);
+        if (data.type & PERFCOUNTER_LONGRUNAVG) {
+          encode(cur.second, report->packed);
+          encode(cur.second, report->packed);
+        }
+        continue;
+      }
+
+      auto [last, inserted] = session->last_sent.try_emplace(path, cur);
+      if (!inserted && last->second == cur) {
+        ++skipped;
+        continue;
+      }
+      last->second = cur;
+      encode(skipped, values);
+      encode(cur.first, values);
       if (data.type & PERFCOUNTER_LONGRUNAVG) {
-        encode(static_cast<uint64_t>(data.avgcount), report->packed);
-        encode(static_cast<uint64_t>(data.avgcount2), report->packed);
+        encode(cur.second, values);
       }
+      skipped = 0;
+      ++num_changed;
+    }
+    if (delta) {
+      encode(num_changed, report->packed);
+      report->packed.claim_append(values);
     }
     ENCODE_FINISH(report->packed);
 
     ldout(cct, 20) << "sending " << session->declared.size() << " counters ("
                       "of possible " << by_path.size() << "), "
 		   << report->declare_types.size() << " new, "
-                   << report->undeclare_types.size() << " removed"
-                   << dendl;
+                   << report->undeclare_types.size() << " removed";
+    if (delta) {
+      *_dout << ", " << num_changed << " changed";
+    }
+    *_dout << dendl;
   });
 
   ldout(cct, 20) << "encoded " << report->packed.length() << " bytes" << dendl;
@@ -460,6 +501,14 @@ bool MgrClient::handle_mgr_configure(ref_t<MMgrConfigure> m)
     stats_threshold = m->stats_threshold;
   }
 
+  if (delta_reports != m->delta_reports) {
+    ldout(cct, 4) << "delta reports " << (m->delta_reports ? "on" : "off")
+		  << dendl;
+    delta_reports = m->delta_reports;
+    // the next report carries every value again
+    session->last_sent.clear();
+  }
+
   if (!m->osd_perf_metric_queries.empty()) {
     handle_config_payload(m->osd_perf_metric_queries);
   } else if (m->metric_config_message) {
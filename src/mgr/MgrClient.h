@@ -43,6 +43,10 @@ class MgrSessionState
   // Which performance counters have we already transmitted schema for?
   std::set<std::string> declared;
 
+  // Values last transmitted for each declared counter, used to omit
+  // unchanged counters when the mgr accepts delta reports
+  std::map<std::string, std::pair<uint64_t, uint64_t>> last_sent;
+
   // Our connection to the mgr
   ConnectionRef con;
 };
@@ -72,6 +76,7 @@ protected:
 
   uint32_t stats_period = 0;
   uint32_t stats_threshold = 0;
+  bool delta_reports = false;
   SafeTimer timer;
 
   CommandTable<MgrCommand> command_table;
@@ -49,6 +49,29 @@ static ostream& _prefix(std::ostream *_dout, Monitor &mon) {
 		<< ").mgrstat ";
 }
 
+// A version committed as a PGMapDigestDelta starts with this struct_v
+// rather than a PGMapDigest's.  It doubles as the compat version, which is
+// above anything PGMapDigest::decode accepts, so a monitor that does not know
+// about deltas fails to decode it instead of misreading it.
+static constexpr __u8 DIGEST_DELTA_V = 100;
+
+static bool is_digest_delta(bufferlist::const_iterator p)
+{
+  __u8 struct_v;
+  decode(struct_v, p);
+  return struct_v == DIGEST_DELTA_V;
+}
+
+static void decode_digest_delta(bufferlist::const_iterator& p,
+				version_t *full_version,
+				PGMapDigestDelta *delta)
+{
+  DECODE_START(DIGEST_DELTA_V, p);
+  decode(*full_version, p);
+  decode(*delta, p);
+  DECODE_FINISH(p);
+}
+
 MgrStatMonitor::MgrStatMonitor(Monitor &mn, Paxos &p, const string& service_name)
   : PaxosService(mn, p, service_name)
 {
@@ -66,6 +89,16 @@ void MgrStatMonitor::create_initial()
   encode(service_map, pending_service_map_bl, CEPH_FEATURES_ALL);
 }
 
+void MgrStatMonitor::load_digest(version_t full_version)
+{
+  bufferlist bl;
+  get_version(full_version, bl);
+  ceph_assert(bl.length());
+  auto p = bl.cbegin();
+  ceph_assert(!is_digest_delta(p));
+  decode(digest, p);
+}
+
 void MgrStatMonitor::update_from_paxos(bool *need_bootstrap)
 {
   version = get_last_committed();
@@ -77,7 +110,36 @@ void MgrStatMonitor::update_from_paxos(bool *need_bootstrap)
     ceph_assert(bl.length());
     try {
       auto p = bl.cbegin();
-      decode(digest, p);
+      if (is_digest_delta(p)) {
+	version_t full_version;
+	PGMapDigestDelta delta;
+	decode_digest_delta(p, &full_version, &delta);
+	// replay the deltas on top of what we already have if the chain
+	// covers it, otherwise start over from the chain's full digest
+	version_t v = digest_version;
+	if (v < full_version || v >= version) {
+	  load_digest(full_version);
+	  v = full_version;
+	}
+	dout(20) << __func__ << " applying deltas " << v + 1 << ".." << version
+		 << " over full digest v" << full_version << dendl;
+	for (++v; v < version; ++v) {
+	  bufferlist dbl;
+	  get_version(v, dbl);
+	  auto q = dbl.cbegin();
+	  version_t fv;
+	  PGMapDigestDelta d;
+	  decode_digest_delta(q, &fv, &d);
+	  ceph_assert(fv == full_version);
+	  d.apply(digest);
+	}
+	delta.apply(digest);
+	digest_full_version = full_version;
+      } else {
+	decode(digest, p);
+	digest_full_version = version;
+      }
+      digest_version = version;
       decode(service_map, p);
       if (!p.end()) {
 	decode(progress_events, p);
@@ -90,6 +152,7 @@ void MgrStatMonitor::update_from_paxos(bool *need_bootstrap)
     catch (ceph::buffer::error& e) {
       derr << "failed to decode mgrstat state; luminous dev version? "
 	   << e.what() << dendl;
+      digest_version = 0;
     }
   }
   check_subs();
@@ -152,7 +215,21 @@ void MgrStatMonitor::encode_pending(MonitorDBStore::TransactionRef t)
   ++version;
   dout(10) << " " << version << dendl;
   bufferlist bl;
-  encode(pending_digest, bl, mon.get_quorum_con_features());
+  if (g_conf().get_val<bool>("mon_mgrstat_digest_deltas") &&
+      digest_version && digest_version == version - 1 &&
+      version - digest_full_version <
+        (version_t)g_conf()->paxos_stash_full_interval) {
+    PGMapDigestDelta delta;
+    delta.diff(digest, pending_digest);
+    ENCODE_START(DIGEST_DELTA_V, DIGEST_DELTA_V, bl);
+    encode(digest_full_version, bl);
+    encode(delta, bl, mon.get_quorum_con_features());
+    ENCODE_FINISH(bl);
+    dout(20) << __func__ << " delta against full v" << digest_full_version
+	     << ", " << bl.length() << " bytes" << dendl;
+  } else {
+    encode(pending_digest, bl, mon.get_quorum_con_features());
+  }
   ceph_assert(pending_service_map_bl.length());
   bl.append(pending_service_map_bl);
   encode(pending_progress_events, bl);
@@ -164,9 +241,10 @@ void MgrStatMonitor::encode_pending(MonitorDBStore::TransactionRef t)
 
 version_t MgrStatMonitor::get_trim_to() const
 {
-  // we don't actually need *any* old states, but keep a few.
+  // we don't actually need *any* old states, but keep a few, as well as
+  // the full digest the latest deltas are applied to.
   if (version > 5) {
-    return version - 5;
+    return std::min(version - 5, digest_full_version);
   }
   return 0;
 }
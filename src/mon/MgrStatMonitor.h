@@ -12,6 +12,8 @@ class MgrStatMonitor : public PaxosService {
   // live version
   version_t version = 0;
   PGMapDigest digest;
+  version_t digest_version = 0;       ///< version digest was loaded from
+  version_t digest_full_version = 0;  ///< last version holding a full digest
   ServiceMap service_map;
   std::map<std::string,ProgressEvent> progress_events;
 
@@ -29,6 +31,7 @@ public:
   void on_shutdown() override {}
 
   void create_initial() override;
+  void load_digest(version_t full_version);
   void update_from_paxos(bool *need_bootstrap) override;
   void create_pending() override;
   void encode_pending(MonitorDBStore::TransactionRef t) override;
@@ -462,6 +462,7 @@ OSDMonitor::OSDMonitor(
    cct(cct),
    inc_osd_cache(g_conf()->mon_osd_cache_size),
    full_osd_cache(g_conf()->mon_osd_cache_size),
+   map_sender(cct, "osdmap_sender", "mon_osdmap_snd"),
    has_osdmap_manifest(false),
    mapper(mn.cct, &mn.cpu_tp)
 {
@@ -846,6 +847,7 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
     tx_size += full_bl.length();
 
     bufferlist orig_full_bl;
+    bool reset_to_canonical = false;
     get_version_full(osdmap.epoch, orig_full_bl);
     if (orig_full_bl.length()) {
       // the primary provided the full map
@@ -870,6 +872,7 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
 
 	osdmap = OSDMap();
 	osdmap.decode(orig_full_bl);
+	reset_to_canonical = true;
 
 	dout(20) << __func__ << " canonical full osdmap:\n";
 	JSONFormatter jf(true);
@@ -909,6 +912,13 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
         osd_epochs.erase(osd);
       }
     }
+    // keep it so that start_mapping() can remap only what it touched,
+    // unless we had to throw our own result away for the canonical map
+    if (reset_to_canonical) {
+      mapping_inc.reset();
+    } else {
+      mapping_inc = std::make_unique<OSDMap::Incremental>(std::move(inc));
+    }
   }
 
   if (t) {
@@ -1071,8 +1081,13 @@ void OSDMonitor::start_mapping()
   }
   if (!osdmap.get_pools().empty()) {
     auto fin = new C_UpdateCreatingPGs(this, osdmap.get_epoch());
+    const OSDMap::Incremental *inc = nullptr;
+    if (mapping_inc && mapping_inc->epoch == osdmap.get_epoch()) {
+      inc = mapping_inc.get();
+    }
     mapping_job = mapping.start_update(osdmap, mapper,
-				       g_conf()->mon_osd_mapping_pgs_per_chunk);
+				       g_conf()->mon_osd_mapping_pgs_per_chunk,
+				       inc);
     dout(10) << __func__ << " started mapping job " << mapping_job.get()
 	     << " at " << fin->start << dendl;
     mapping_job->set_finish_event(fin);
@@ -1129,11 +1144,18 @@ void OSDMonitor::on_active()
 void OSDMonitor::on_restart()
 {
   last_osd_report.clear();
+  // elections, restarts and store syncs all come through here
+  map_sender_cancel();
 }
 
 void OSDMonitor::on_shutdown()
 {
   dout(10) << __func__ << dendl;
+  if (map_sender_started) {
+    map_sender_cancel();
+    map_sender.stop();
+    map_sender_started = false;
+  }
   if (mapping_job) {
     dout(10) << __func__ << " canceling previous mapping_job " << mapping_job.get()
 	     << dendl;
@@ -2320,6 +2342,13 @@ version_t OSDMonitor::get_trim_to() const
       else
 	floor = 0;
     }
+    {
+      std::lock_guard l(map_sender_lock);
+      if (!map_sender_pinned.empty() && *map_sender_pinned.begin() < floor) {
+	floor = *map_sender_pinned.begin();
+	dout(10) << __func__ << " map_sender pinned " << floor << dendl;
+      }
+    }
     if (floor > get_first_committed()) {
       dout(10) << __func__ << " trim_to = " << floor << dendl;
       return floor;
@@ -4498,6 +4527,111 @@ MOSDMap *OSDMonitor::build_incremental(epoch_t from, epoch_t to, uint64_t featur
   return m;
 }
 
+void OSDMonitor::queue_send_incremental(epoch_t first, epoch_t last,
+					MonSession *session, uint64_t features)
+{
+  dout(10) << __func__ << " [" << first << ".." << last << "] to "
+	   << session->name << dendl;
+  if (!map_sender_started) {
+    map_sender.start();
+    map_sender_started = true;
+  }
+  {
+    std::lock_guard l(map_sender_lock);
+    map_sender_pinned.insert(first);
+  }
+  // everything the job needs from the current state is captured here; the
+  // job itself only reads the store and inc_osd_cache.  the pin only holds
+  // off our own trims while we lead: a peon applies the leader's trims and
+  // a sync clears the store, so the job has to cope with epochs vanishing
+  // under it (see map_sender_rewind()).
+  map_sender.queue(new LambdaContext(
+    [this, first, last, session = ceph::ref_t<MonSession>(session),
+     con = session->con, features,
+     gen = map_sender_gen.load(),
+     fsid = mon.monmap->fsid,
+     oldest = get_first_committed(),
+     newest = osdmap.get_epoch(),
+     quorum_features = mon.get_quorum_con_features(),
+     max = std::max<epoch_t>(g_conf()->osd_map_message_max, 1)](int) {
+      for (epoch_t from = first; from <= last; ) {
+	epoch_t to = std::min<epoch_t>(from + max - 1, last);
+	MOSDMap *m = new MOSDMap(fsid, features);
+	m->oldest_map = oldest;
+	m->newest_map = newest;
+	int err = 0;
+	for (epoch_t e = to; e >= from; e--) {
+	  if (gen != map_sender_gen) {
+	    err = -ECANCELED;
+	    break;
+	  }
+	  bufferlist bl;
+	  err = get_version(e, features, quorum_features, bl);
+	  if (err == 0 && bl.length() == 0) {
+	    err = -ENOENT;
+	  }
+	  if (err < 0) {
+	    break;
+	  }
+	  m->incremental_maps[e] = std::move(bl);
+	}
+	if (err < 0) {
+	  m->put();
+	  map_sender_rewind(session, from, err);
+	  break;
+	}
+	con->send_message(m);
+	from = to + 1;
+      }
+      std::lock_guard l(map_sender_lock);
+      map_sender_pinned.erase(map_sender_pinned.find(first));
+    }));
+}
+
+void OSDMonitor::map_sender_rewind(ceph::ref_t<MonSession> session,
+				   epoch_t from, int err)
+{
+  // called from map_sender: maps from 'from' on never went out.  rewind the
+  // session under the monitor lock so that its subscription asks for them
+  // again; if they have been trimmed meanwhile, send_incremental() starts
+  // it off with a full map instead.
+  dout(1) << __func__ << " " << session->name << " stopped at " << from
+	  << ": " << cpp_strerror(err) << dendl;
+  mon.finisher.queue(new C_MonContext{&mon, [this, session, from](int) {
+    std::lock_guard l{mon.lock};
+    if (session->closed) {
+      return;
+    }
+    if (session->osd_epoch >= from) {
+      session->osd_epoch = from - 1;
+    }
+    auto p = session->sub_map.find("osdmap");
+    if (p != session->sub_map.end()) {
+      Subscription *sub = p->second;
+      if (sub->next > from) {
+	sub->next = from;
+      }
+      if (is_active()) {
+	check_osdmap_sub(sub);
+      }
+    } else if (is_active()) {
+      send_incremental(from, session.get(), true);
+    }
+  }});
+}
+
+void OSDMonitor::map_sender_cancel()
+{
+  // drop queued and running jobs; they rewind their sessions, which pick
+  // the maps up again once we are active
+  if (!map_sender_started) {
+    return;
+  }
+  dout(10) << __func__ << dendl;
+  ++map_sender_gen;
+  map_sender.wait_for_empty();
+}
+
 void OSDMonitor::send_full(MonOpRequestRef op)
 {
   op->mark_osdmon_event(__func__);
@@ -4570,6 +4704,17 @@ void OSDMonitor::send_incremental(epoch_t first,
     first++;
   }
 
+  if (!req && first <= osdmap.get_epoch() &&
+      g_conf().get_val<bool>("mon_osd_map_send_async")) {
+    epoch_t last = osdmap.get_epoch();
+    if (onetime) {
+      last = std::min<epoch_t>(first + g_conf()->osd_map_message_max - 1, last);
+    }
+    queue_send_incremental(first, last, session, features);
+    session->osd_epoch = last;
+    return;
+  }
+
   while (first <= osdmap.get_epoch()) {
     epoch_t last = std::min<epoch_t>(first + g_conf()->osd_map_message_max - 1,
 				     osdmap.get_epoch());
@@ -4637,6 +4782,14 @@ void OSDMonitor::reencode_full_map(bufferlist& bl, uint64_t features)
 
 int OSDMonitor::get_version(version_t ver, uint64_t features, bufferlist& bl)
 {
+  return get_version(ver, features, mon.get_quorum_con_features(), bl);
+}
+
+int OSDMonitor::get_version(version_t ver, uint64_t features,
+			    uint64_t quorum_features, bufferlist& bl)
+{
+  // may be called from map_sender without the monitor lock: only use the
+  // store, inc_osd_cache and the arguments here
   uint64_t significant_features = OSDMap::get_significant_features(features);
   if (inc_osd_cache.lookup({ver, significant_features}, &bl)) {
     return 0;
@@ -4650,7 +4803,7 @@ int OSDMonitor::get_version(version_t ver, uint64_t features, bufferlist& bl)
   // reencode once and then cache the (identical) result under both
   // feature masks.
   if (significant_features !=
-      OSDMap::get_significant_features(mon.get_quorum_con_features())) {
+      OSDMap::get_significant_features(quorum_features)) {
     reencode_incremental_map(bl, features);
   }
   inc_osd_cache.add_bytes({ver, significant_features}, bl);
@@ -4856,6 +5009,12 @@ void OSDMonitor::check_osdmap_sub(Subscription *sub)
   dout(10) << __func__ << " " << sub << " next " << sub->next
 	   << (sub->onetime ? " (onetime)":" (ongoing)") << dendl;
   if (sub->next <= osdmap.get_epoch()) {
+    if (defer_osdmap_sub(sub)) {
+      dout(20) << __func__ << " " << sub << " left to gossip since "
+	       << sub->deferred << dendl;
+      return;
+    }
+    sub->deferred = utime_t();
     if (sub->next >= 1)
       send_incremental(sub->next, sub->session, sub->incremental_onetime);
     else
@@ -4867,6 +5026,38 @@ void OSDMonitor::check_osdmap_sub(Subscription *sub)
   }
 }
 
+bool OSDMonitor::defer_osdmap_sub(Subscription *sub)
+{
+  // With mon_osdmap_gossip_seeds set, only about that many up OSDs with an
+  // ongoing subscription get each new epoch from us; the others normally
+  // pick it up from their heartbeat peers (OSDService::maybe_share_map()).
+  // Their subscription stays pending, and once mon_osdmap_gossip_grace has
+  // passed they get everything since in a single message rather than one
+  // message per epoch.
+  auto seeds = g_conf().get_val<uint64_t>("mon_osdmap_gossip_seeds");
+  if (!seeds ||
+      sub->onetime ||
+      sub->next <= 1 ||
+      !sub->session->name.is_osd()) {
+    return false;
+  }
+  int osd = sub->session->name.num();
+  if (!osdmap.is_up(osd)) {
+    return false;
+  }
+  unsigned stride = std::max<unsigned>(1, osdmap.get_num_up_osds() / seeds);
+  if ((osd + osdmap.get_epoch()) % stride == 0) {
+    return false;  // a seed for this epoch
+  }
+  utime_t now = ceph_clock_now();
+  if (sub->deferred == utime_t()) {
+    sub->deferred = now;
+    return true;
+  }
+  auto grace = g_conf().get_val<std::chrono::seconds>("mon_osdmap_gossip_grace");
+  return now - sub->deferred < utime_t(grace);
+}
+
 void OSDMonitor::check_pg_creates_subs()
 {
   if (!osdmap.get_num_up_osds()) {
@@ -5119,6 +5310,11 @@ void OSDMonitor::tick()
     }
   }
 
+  // pick up the subscriptions left to osdmap gossip for too long
+  if (g_conf().get_val<uint64_t>("mon_osdmap_gossip_seeds")) {
+    check_osdmap_subs();
+  }
+
   if (!mon.is_leader()) return;
 
   bool do_propose = false;
@@ -5417,7 +5613,8 @@ namespace {
     CSUM_TYPE, CSUM_MAX_BLOCK, CSUM_MIN_BLOCK, FINGERPRINT_ALGORITHM,
     PG_AUTOSCALE_MODE, PG_NUM_MIN, TARGET_SIZE_BYTES, TARGET_SIZE_RATIO,
     PG_AUTOSCALE_BIAS, DEDUP_TIER, DEDUP_CHUNK_ALGORITHM, 
-    DEDUP_CDC_CHUNK_SIZE, POOL_EIO, BULK, PG_NUM_MAX };
+    DEDUP_CDC_CHUNK_SIZE, POOL_EIO, BULK, PG_NUM_MAX,
+    MCLOCK_RES, MCLOCK_WGT, MCLOCK_LIM };
 
   std::set<osd_pool_get_choices>
     subtract_second_from_first(const std::set<osd_pool_get_choices>& first,
@@ -6167,7 +6364,10 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
       {"dedup_tier", DEDUP_TIER},
       {"dedup_chunk_algorithm", DEDUP_CHUNK_ALGORITHM},
       {"dedup_cdc_chunk_size", DEDUP_CDC_CHUNK_SIZE},
-      {"bulk", BULK}
+      {"bulk", BULK},
+      {"mclock_res", MCLOCK_RES},
+      {"mclock_wgt", MCLOCK_WGT},
+      {"mclock_lim", MCLOCK_LIM}
     };
 
     typedef std::set<osd_pool_get_choices> choices_set_t;
@@ -6397,6 +6597,9 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	  case DEDUP_TIER:
 	  case DEDUP_CHUNK_ALGORITHM:
 	  case DEDUP_CDC_CHUNK_SIZE:
+	  case MCLOCK_RES:
+	  case MCLOCK_WGT:
+	  case MCLOCK_LIM:
             pool_opts_t::key_t key = pool_opts_t::get_opt_desc(i->first).key;
             if (p->opts.is_set(key)) {
               if(*it == CSUM_TYPE) {
@@ -6560,6 +6763,9 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	  case DEDUP_TIER:
 	  case DEDUP_CHUNK_ALGORITHM:
 	  case DEDUP_CDC_CHUNK_SIZE:
+	  case MCLOCK_RES:
+	  case MCLOCK_WGT:
+	  case MCLOCK_LIM:
 	    for (i = ALL_CHOICES.begin(); i != ALL_CHOICES.end(); ++i) {
 	      if (i->second == *it)
 		break;
@@ -8911,6 +9117,16 @@ int OSDMonitor::prepare_command_pool_set(const cmdmap_t& cmdmap,
         ss << "error parsing int value '" << val << "': " << interr;
         return -EINVAL;
       }
+    } else if (var == "mclock_res" || var == "mclock_wgt" ||
+	       var == "mclock_lim") {
+      if (interr.length()) {
+        ss << "error parsing int value '" << val << "': " << interr;
+        return -EINVAL;
+      }
+      if (!unset && (n < 0 || (var == "mclock_wgt" && n == 0))) {
+        ss << var << " must be " << (var == "mclock_wgt" ? "> 0" : ">= 0");
+        return -EINVAL;
+      }
     }
 
     pool_opts_t::opt_desc_t desc = pool_opts_t::get_opt_desc(var);
@@ -28,6 +28,7 @@
 
 #include "include/types.h"
 #include "include/encoding.h"
+#include "common/Finisher.h"
 #include "common/simple_cache.hpp"
 #include "common/PriorityCache.h"
 #include "msg/Messenger.h"
@@ -233,6 +234,23 @@ public:
   osdmap_cache_t inc_osd_cache;
   osdmap_cache_t full_osd_cache;
 
+  /**
+   * Builds and sends the MOSDMaps for osdmap subscriptions without holding
+   * the monitor lock; the incrementals come from the store and inc_osd_cache,
+   * which can both be read concurrently.  It is a single ordered thread, so
+   * each session still gets its maps in epoch order.  Queued jobs pin their
+   * first epoch in map_sender_pinned so the leader's get_trim_to() keeps
+   * those maps; peons and syncs can still remove them, in which case the
+   * job stops and rewinds the session.  Bumping map_sender_gen cancels all
+   * outstanding jobs.
+   */
+  Finisher map_sender;
+  bool map_sender_started = false;
+  std::atomic<uint64_t> map_sender_gen = 0;
+  mutable ceph::mutex map_sender_lock =
+    ceph::make_mutex("OSDMonitor::map_sender_lock");
+  std::multiset<epoch_t> map_sender_pinned;
+
   bool has_osdmap_manifest;
   osdmap_manifest_t osdmap_manifest;
 
@@ -385,6 +403,8 @@ private:
   ParallelPGMapper mapper;                        ///< for background pg work
   OSDMapMapping mapping;                          ///< pg <-> osd mappings
   std::unique_ptr<ParallelPGMapper::Job> mapping_job;  ///< background mapping job
+  /// the incremental that produced the current osdmap, if we applied one
+  std::unique_ptr<OSDMap::Incremental> mapping_inc;
   void start_mapping();
 
   void update_logger();
@@ -404,6 +424,11 @@ private:
   // ...
   MOSDMap *build_latest_full(uint64_t features);
   MOSDMap *build_incremental(epoch_t first, epoch_t last, uint64_t features);
+  void queue_send_incremental(epoch_t first, epoch_t last,
+			      MonSession *session, uint64_t features);
+  void map_sender_rewind(ceph::ref_t<MonSession> session, epoch_t from,
+			 int err);
+  void map_sender_cancel();
   void send_full(MonOpRequestRef op);
   void send_incremental(MonOpRequestRef op, epoch_t first);
 public:
@@ -750,6 +775,8 @@ public:
 
   int get_version(version_t ver, ceph::buffer::list& bl) override;
   int get_version(version_t ver, uint64_t feature, ceph::buffer::list& bl);
+  int get_version(version_t ver, uint64_t feature, uint64_t quorum_features,
+		  ceph::buffer::list& bl);
 
   int get_version_full(version_t ver, uint64_t feature, ceph::buffer::list& bl);
   int get_version_full(version_t ver, ceph::buffer::list& bl) override;
@@ -764,6 +791,7 @@ public:
   void print_nodes(ceph::Formatter *f);
 
   void check_osdmap_sub(Subscription *sub);
+  bool defer_osdmap_sub(Subscription *sub);
   void check_pg_creates_sub(Subscription *sub);
 
   void do_application_enable(int64_t pool_id, const std::string &app_name,
@@ -97,6 +97,101 @@ void PGMapDigest::decode(bufferlist::const_iterator& p)
   DECODE_FINISH(p);
 }
 
+void PGMapDigestDelta::diff(const PGMapDigest& from, const PGMapDigest& to)
+{
+  num_pg = to.num_pg;
+  num_osd = to.num_osd;
+  num_pg_active = to.num_pg_active;
+  num_pg_unknown = to.num_pg_unknown;
+  pg_sum = to.pg_sum;
+  osd_sum = to.osd_sum;
+  osd_last_seq = to.osd_last_seq;
+  pg_sum_delta = to.pg_sum_delta;
+  stamp_delta = to.stamp_delta;
+  avail_space_by_rule = to.avail_space_by_rule;
+
+  pg_pool_sum.diff(from.pg_pool_sum, to.pg_pool_sum);
+  num_pg_by_state.diff(from.num_pg_by_state, to.num_pg_by_state);
+  num_pg_by_osd.diff(from.num_pg_by_osd, to.num_pg_by_osd);
+  num_pg_by_pool.diff(from.num_pg_by_pool, to.num_pg_by_pool);
+  per_pool_sum_delta.diff(from.per_pool_sum_delta, to.per_pool_sum_delta);
+  per_pool_sum_deltas_stamps.diff(from.per_pool_sum_deltas_stamps,
+				  to.per_pool_sum_deltas_stamps);
+  purged_snaps.diff(from.purged_snaps, to.purged_snaps);
+  osd_sum_by_class.diff(from.osd_sum_by_class, to.osd_sum_by_class);
+}
+
+void PGMapDigestDelta::apply(PGMapDigest& digest) const
+{
+  digest.num_pg = num_pg;
+  digest.num_osd = num_osd;
+  digest.num_pg_active = num_pg_active;
+  digest.num_pg_unknown = num_pg_unknown;
+  digest.pg_sum = pg_sum;
+  digest.osd_sum = osd_sum;
+  digest.osd_last_seq = osd_last_seq;
+  digest.pg_sum_delta = pg_sum_delta;
+  digest.stamp_delta = stamp_delta;
+  digest.avail_space_by_rule = avail_space_by_rule;
+
+  pg_pool_sum.apply(digest.pg_pool_sum);
+  num_pg_by_state.apply(digest.num_pg_by_state);
+  num_pg_by_osd.apply(digest.num_pg_by_osd);
+  num_pg_by_pool.apply(digest.num_pg_by_pool);
+  per_pool_sum_delta.apply(digest.per_pool_sum_delta);
+  per_pool_sum_deltas_stamps.apply(digest.per_pool_sum_deltas_stamps);
+  purged_snaps.apply(digest.purged_snaps);
+  osd_sum_by_class.apply(digest.osd_sum_by_class);
+}
+
+void PGMapDigestDelta::encode(bufferlist& bl, uint64_t features) const
+{
+  ENCODE_START(1, 1, bl);
+  encode(num_pg, bl);
+  encode(num_pg_active, bl);
+  encode(num_pg_unknown, bl);
+  encode(num_osd, bl);
+  encode(pg_sum, bl, features);
+  encode(osd_sum, bl, features);
+  encode(osd_last_seq, bl);
+  encode(pg_sum_delta, bl, features);
+  encode(stamp_delta, bl);
+  encode(avail_space_by_rule, bl);
+  pg_pool_sum.encode(bl, features);
+  num_pg_by_state.encode(bl, features);
+  num_pg_by_osd.encode(bl, features);
+  num_pg_by_pool.encode(bl, features);
+  per_pool_sum_delta.encode(bl, features);
+  per_pool_sum_deltas_stamps.encode(bl, features);
+  purged_snaps.encode(bl, features);
+  osd_sum_by_class.encode(bl, features);
+  ENCODE_FINISH(bl);
+}
+
+void PGMapDigestDelta::decode(bufferlist::const_iterator& p)
+{
+  DECODE_START(1, p);
+  decode(num_pg, p);
+  decode(num_pg_active, p);
+  decode(num_pg_unknown, p);
+  decode(num_osd, p);
+  decode(pg_sum, p);
+  decode(osd_sum, p);
+  decode(osd_last_seq, p);
+  decode(pg_sum_delta, p);
+  decode(stamp_delta, p);
+  decode(avail_space_by_rule, p);
+  pg_pool_sum.decode(p);
+  num_pg_by_state.decode(p);
+  num_pg_by_osd.decode(p);
+  num_pg_by_pool.decode(p);
+  per_pool_sum_delta.decode(p);
+  per_pool_sum_deltas_stamps.decode(p);
+  purged_snaps.decode(p);
+  osd_sum_by_class.decode(p);
+  DECODE_FINISH(p);
+}
+
 void PGMapDigest::dump(ceph::Formatter *f) const
 {
   f->dump_unsigned("num_pg", num_pg);
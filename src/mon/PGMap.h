@@ -54,6 +54,11 @@ public:
     int32_t acting = 0;
     int32_t up_not_acting = 0;
     int32_t primary = 0;
+    bool operator==(const pg_count& o) const {
+      return acting == o.acting &&
+	up_not_acting == o.up_not_acting &&
+	primary == o.primary;
+    }
     void encode(ceph::buffer::list& bl) const {
       using ceph::encode;
       encode(acting, bl);
@@ -230,6 +235,100 @@ public:
 WRITE_CLASS_ENCODER(PGMapDigest::pg_count);
 WRITE_CLASS_ENCODER_FEATURES(PGMapDigest);
 
+/**
+ * The difference between two PGMapDigests.
+ *
+ * MgrStatMonitor commits these instead of the whole digest, which on a big
+ * cluster is dominated by the per-pool and per-osd containers that mostly
+ * do not change from one report to the next.  The aggregates are carried
+ * whole; the containers only carry the entries that were added or changed
+ * plus the keys that went away.
+ */
+class PGMapDigestDelta {
+public:
+  template<typename K, typename V>
+  struct map_delta_t {
+    std::map<K,V> changed;   ///< added or modified entries
+    std::set<K> removed;
+
+    template<typename M>
+    void diff(const M& from, const M& to) {
+      for (auto& [k, v] : to) {
+	auto p = from.find(k);
+	if (p == from.end() || !same(p->second, v)) {
+	  changed.emplace(k, v);
+	}
+      }
+      for (auto& [k, v] : from) {
+	if (!to.count(k)) {
+	  removed.insert(k);
+	}
+      }
+    }
+    /// compare what would go on the wire; operator== on some of the
+    /// value types (osd_stat_t) skips fields such as os_alerts
+    static bool same(const V& a, const V& b) {
+      using ceph::encode;
+      ceph::buffer::list abl, bbl;
+      encode(a, abl, CEPH_FEATURES_ALL);
+      encode(b, bbl, CEPH_FEATURES_ALL);
+      return abl.contents_equal(bbl);
+    }
+    template<typename M>
+    void apply(M& m) const {
+      for (auto& k : removed) {
+	m.erase(k);
+      }
+      for (auto& [k, v] : changed) {
+	m[k] = v;
+      }
+    }
+    bool empty() const {
+      return changed.empty() && removed.empty();
+    }
+    void encode(ceph::buffer::list& bl, uint64_t features) const {
+      using ceph::encode;
+      encode(changed, bl, features);
+      encode(removed, bl);
+    }
+    void decode(ceph::buffer::list::const_iterator& p) {
+      using ceph::decode;
+      decode(changed, p);
+      decode(removed, p);
+    }
+  };
+
+  // aggregates
+  int64_t num_pg = 0, num_osd = 0;
+  int64_t num_pg_active = 0;
+  int64_t num_pg_unknown = 0;
+  pool_stat_t pg_sum;
+  osd_stat_t osd_sum;
+  mempool::pgmap::vector<uint64_t> osd_last_seq;
+  pool_stat_t pg_sum_delta;
+  utime_t stamp_delta;
+  std::map<int, int64_t> avail_space_by_rule;
+
+  // containers
+  map_delta_t<int32_t,pool_stat_t> pg_pool_sum;
+  map_delta_t<uint64_t,int32_t> num_pg_by_state;
+  map_delta_t<int32_t,PGMapDigest::pg_count> num_pg_by_osd;
+  map_delta_t<int64_t,int64_t> num_pg_by_pool;
+  map_delta_t<int64_t,std::pair<pool_stat_t,utime_t>> per_pool_sum_delta;
+  map_delta_t<int64_t,utime_t> per_pool_sum_deltas_stamps;
+  map_delta_t<int64_t,interval_set<snapid_t>> purged_snaps;
+  map_delta_t<std::string,osd_stat_t> osd_sum_by_class;
+
+  /// Build the delta that turns @p from into @p to
+  void diff(const PGMapDigest& from, const PGMapDigest& to);
+  /// Turn the digest this delta was built from into the one it was built to
+  void apply(PGMapDigest& digest) const;
+
+  void encode(ceph::buffer::list& bl, uint64_t features) const;
+  void decode(ceph::buffer::list::const_iterator& p);
+};
+WRITE_CLASS_ENCODER_FEATURES(PGMapDigestDelta);
+
 class PGMap : public PGMapDigest {
 public:
   MEMPOOL_CLASS_HELPERS();
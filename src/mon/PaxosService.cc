@@ -188,6 +188,26 @@ bool PaxosService::should_propose(double& delay)
 
 
 void PaxosService::propose_pending()
+{
+  dout(10) << __func__ << dendl;
+  queue_pending();
+
+  if (g_conf()->paxos_batch_service_proposals) {
+    // Other services that are only holding off to gather more updates ride
+    // along in this round instead of each needing a round of their own.
+    for (auto& svc : mon.paxos_service) {
+      if (svc.get() != this && svc->proposal_timer && svc->is_writeable()) {
+	dout(10) << __func__ << " batching " << svc->get_service_name()
+		 << dendl;
+	svc->queue_pending();
+      }
+    }
+  }
+
+  paxos.trigger_propose();
+}
+
+void PaxosService::queue_pending()
 {
   dout(10) << __func__ << dendl;
   ceph_assert(have_pending);
@@ -249,7 +269,6 @@ void PaxosService::propose_pending()
     }
   };
   paxos.queue_pending_finisher(new C_Committed(this));
-  paxos.trigger_propose();
 }
 
 bool PaxosService::should_stash_full()
@@ -232,6 +232,17 @@ public:
    */
   void propose_pending();
 
+private:
+  /**
+   * Encode our pending value into the pending Paxos transaction and queue
+   * our commit callback, without triggering the proposal itself.
+   *
+   * propose_pending() uses this to fold the pending values of services
+   * waiting on their proposal_timer into the same round.
+   */
+  void queue_pending();
+
+public:
   /**
    * Let others request us to propose.
    *
@@ -39,7 +39,8 @@ struct Subscription {
   version_t next;
   bool onetime;
   bool incremental_onetime;  // has CEPH_FEATURE_INCSUBOSDMAP
-  
+  utime_t deferred;  // when we started leaving this sub to osdmap gossip
+
   Subscription(MonSession *s, const std::string& t) : session(s), type(t), type_item(this),
 						 next(0), onetime(false), incremental_onetime(false) {}
 };
@@ -272,6 +273,7 @@ struct MonSessionMap {
     sub->next = start;
     sub->onetime = onetime;
     sub->incremental_onetime = onetime && incremental_onetime;
+    sub->deferred = utime_t();
   }
 
   void remove_sub(Subscription *sub) {
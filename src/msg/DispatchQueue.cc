@@ -16,6 +16,8 @@
 #include "DispatchQueue.h"
 #include "Messenger.h"
 #include "common/ceph_context.h"
+#include "common/perf_counters.h"
+#include "common/perf_counters_collection.h"
 
 #define dout_subsys ceph_subsys_ms
 #include "common/debug.h"
@@ -30,12 +32,73 @@ using ceph::ref_t;
 #undef dout_prefix
 #define dout_prefix *_dout << "-- " << msgr->get_myaddrs() << " "
 
+enum {
+  l_dq_type_first = 93000,
+  l_dq_type_wait,
+  l_dq_type_dispatch,
+  l_dq_type_last,
+};
+
+DispatchQueue::DispatchQueue(CephContext *cct, Messenger *msgr,
+			     std::string &name)
+  : cct(cct), msgr(msgr), name(name),
+    next_id(1),
+    local_delivery_lock(ceph::make_mutex("Messenger::DispatchQueue::local_delivery_lock" + name)),
+    stop_local_delivery(false),
+    local_delivery_thread(this),
+    dispatch_throttler(cct, std::string("msgr_dispatch_throttler-") + name,
+		       cct->_conf->ms_dispatch_throttle_bytes),
+    stop(false)
+{
+  unsigned num_shards = std::max<uint64_t>(1, cct->_conf->ms_dispatch_shards);
+  for (unsigned i = 0; i < num_shards; ++i) {
+    shards.emplace_back(std::make_unique<Shard>(cct, this, i, name));
+  }
+}
+
+DispatchQueue::~DispatchQueue()
+{
+  for (auto& sh : shards) {
+    ceph_assert(sh->mqueue.empty());
+    ceph_assert(sh->marrival.empty());
+  }
+  ceph_assert(local_messages.empty());
+  for (auto& [type, logger] : type_perf) {
+    cct->get_perfcounters_collection()->remove(logger);
+    delete logger;
+  }
+}
+
+PerfCounters *DispatchQueue::get_type_perf(const ref_t<Message>& m)
+{
+  std::lock_guard l{type_perf_lock};
+  auto p = type_perf.find(m->get_type());
+  if (p != type_perf.end()) {
+    return p->second;
+  }
+  PerfCountersBuilder plb(
+    cct,
+    "msgr_dispatch_queue-" + name + "-" +
+      std::string(m->get_type_name()),
+    l_dq_type_first, l_dq_type_last);
+  plb.add_time_avg(l_dq_type_wait, "wait",
+		   "Time messages spent queued for the dispatch thread");
+  plb.add_time_avg(l_dq_type_dispatch, "dispatch",
+		   "Time spent in the dispatch handler");
+  PerfCounters *logger = plb.create_perf_counters();
+  cct->get_perfcounters_collection()->add(logger);
+  type_perf[m->get_type()] = logger;
+  return logger;
+}
+
 double DispatchQueue::get_max_age(utime_t now) const {
-  std::lock_guard l{lock};
-  if (marrival.empty())
-    return 0;
-  else
-    return (now - marrival.begin()->first);
+  double max_age = 0;
+  for (auto& sh : shards) {
+    std::lock_guard l{sh->lock};
+    if (!sh->marrival.empty())
+      max_age = std::max<double>(max_age, now - sh->marrival.begin()->first);
+  }
+  return max_age;
 }
 
 uint64_t DispatchQueue::pre_dispatch(const ref_t<Message>& m)
@@ -82,18 +145,19 @@ void DispatchQueue::fast_preprocess(const ref_t<Message>& m)
 
 void DispatchQueue::enqueue(const ref_t<Message>& m, int priority, uint64_t id)
 {
-  std::lock_guard l{lock};
+  Shard& sh = shard_of(m->get_connection().get());
+  std::lock_guard l{sh.lock};
   if (stop) {
     return;
   }
   ldout(cct,20) << "queue " << m << " prio " << priority << dendl;
-  add_arrival(m);
+  sh.add_arrival(m);
   if (priority >= CEPH_MSG_PRIO_LOW) {
-    mqueue.enqueue_strict(id, priority, QueueItem(m));
+    sh.mqueue.enqueue_strict(id, priority, QueueItem(m));
   } else {
-    mqueue.enqueue(id, priority, m->get_cost(), QueueItem(m));
+    sh.mqueue.enqueue(id, priority, m->get_cost(), QueueItem(m));
   }
-  cond.notify_all();
+  sh.cond.notify_all();
 }
 
 void DispatchQueue::local_delivery(const ref_t<Message>& m, int priority)
@@ -153,14 +217,15 @@ void DispatchQueue::dispatch_throttle_release(uint64_t msize)
  * end of the queue. If the queue is empty; it's removed.
  * The message is then delivered and the process starts again.
  */
-void DispatchQueue::entry()
+void DispatchQueue::entry(unsigned shard)
 {
-  std::unique_lock l{lock};
+  Shard& sh = *shards[shard];
+  std::unique_lock l{sh.lock};
   while (true) {
-    while (!mqueue.empty()) {
-      QueueItem qitem = mqueue.dequeue();
+    while (!sh.mqueue.empty()) {
+      QueueItem qitem = sh.mqueue.dequeue();
       if (!qitem.is_code())
-	remove_arrival(qitem.get_message());
+	sh.remove_arrival(qitem.get_message());
       l.unlock();
 
       if (qitem.is_code()) {
@@ -196,6 +261,14 @@ void DispatchQueue::entry()
 	const ref_t<Message>& m = qitem.get_message();
 	if (stop) {
 	  ldout(cct,10) << " stop flag set, discarding " << m << " " << *m << dendl;
+	} else if (cct->_conf->ms_dispatch_type_perf_counters) {
+	  PerfCounters *logger = get_type_perf(m);
+	  auto start = ceph::mono_clock::now();
+	  logger->tinc(l_dq_type_wait, start - qitem.get_stamp());
+	  uint64_t msize = pre_dispatch(m);
+	  msgr->ms_deliver_dispatch(m);
+	  post_dispatch(m, msize);
+	  logger->tinc(l_dq_type_dispatch, ceph::mono_clock::now() - start);
 	} else {
 	  uint64_t msize = pre_dispatch(m);
 	  msgr->ms_deliver_dispatch(m);
@@ -209,34 +282,46 @@ void DispatchQueue::entry()
       break;
 
     // wait for something to be put on queue
-    cond.wait(l);
+    sh.cond.wait(l);
   }
 }
 
 void DispatchQueue::discard_queue(uint64_t id) {
-  std::lock_guard l{lock};
-  std::list<QueueItem> removed;
-  mqueue.remove_by_class(id, &removed);
-  for (auto i = removed.begin(); i != removed.end(); ++i) {
-    ceph_assert(!(i->is_code())); // We don't discard id 0, ever!
-    const ref_t<Message>& m = i->get_message();
-    remove_arrival(m);
-    dispatch_throttle_release(m->get_dispatch_throttle_size());
+  // the id is the connection's, but not the connection itself, so look
+  // everywhere; this only happens on session resets
+  for (auto& sh : shards) {
+    std::lock_guard l{sh->lock};
+    std::list<QueueItem> removed;
+    sh->mqueue.remove_by_class(id, &removed);
+    for (auto i = removed.begin(); i != removed.end(); ++i) {
+      ceph_assert(!(i->is_code())); // We don't discard id 0, ever!
+      const ref_t<Message>& m = i->get_message();
+      sh->remove_arrival(m);
+      dispatch_throttle_release(m->get_dispatch_throttle_size());
+    }
   }
 }
 
 void DispatchQueue::start()
 {
   ceph_assert(!stop);
-  ceph_assert(!dispatch_thread.is_started());
-  dispatch_thread.create("ms_dispatch");
+  ceph_assert(!is_started());
+  for (unsigned i = 0; i < shards.size(); ++i) {
+    std::string tname = "ms_dispatch";
+    if (i) {
+      tname += "-" + std::to_string(i);
+    }
+    shards[i]->dispatch_thread.create(tname.c_str());
+  }
   local_delivery_thread.create("ms_local");
 }
 
 void DispatchQueue::wait()
 {
   local_delivery_thread.join();
-  dispatch_thread.join();
+  for (auto& sh : shards) {
+    sh->dispatch_thread.join();
+  }
 }
 
 void DispatchQueue::discard_local()
@@ -252,10 +337,10 @@ void DispatchQueue::shutdown()
     stop_local_delivery = true;
     local_delivery_cond.notify_all();
   }
-  // stop my dispatch thread
-  {
-    std::scoped_lock l{lock};
+  // stop my dispatch threads
+  for (auto& sh : shards) {
+    std::scoped_lock l{sh->lock};
     stop = true;
-    cond.notify_all();
+    sh->cond.notify_all();
   }
 }
@@ -17,7 +17,9 @@
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <queue>
+#include <vector>
 #include <boost/intrusive_ptr.hpp>
 #include "include/ceph_assert.h"
 #include "include/common_fwd.h"
@@ -25,6 +27,7 @@
 #include "common/ceph_mutex.h"
 #include "common/Thread.h"
 #include "common/PrioritizedQueue.h"
+#include "common/ceph_time.h"
 
 #include "Message.h"
 
@@ -42,6 +45,7 @@ class DispatchQueue {
     int type;
     ConnectionRef con;
     ceph::ref_t<Message> m;
+    ceph::mono_time stamp = ceph::mono_clock::now();
   public:
     explicit QueueItem(const ceph::ref_t<Message>& m) : type(-1), con(0), m(m) {}
     QueueItem(int type, Connection *con) : type(type), con(con), m(0) {}
@@ -60,48 +64,86 @@ class DispatchQueue {
       ceph_assert(is_code());
       return con.get();
     }
+    ceph::mono_time get_stamp() const {
+      return stamp;
+    }
   };
 
   CephContext *cct;
   Messenger *msgr;
-  mutable ceph::mutex lock;
-  ceph::condition_variable cond;
-
-  PrioritizedQueue<QueueItem, uint64_t> mqueue;
-
-  std::set<std::pair<double, ceph::ref_t<Message>>> marrival;
-  std::map<ceph::ref_t<Message>, decltype(marrival)::iterator> marrival_map;
-  void add_arrival(const ceph::ref_t<Message>& m) {
-    marrival_map.insert(
-      make_pair(
-	m,
-	marrival.insert(std::make_pair(m->get_recv_stamp(), m)).first
-	)
-      );
-  }
-  void remove_arrival(const ceph::ref_t<Message>& m) {
-    auto it = marrival_map.find(m);
-    ceph_assert(it != marrival_map.end());
-    marrival.erase(it->second);
-    marrival_map.erase(it);
-  }
-
-  std::atomic<uint64_t> next_id;
-
-  enum { D_CONNECT = 1, D_ACCEPT, D_BAD_REMOTE_RESET, D_BAD_RESET, D_CONN_REFUSED, D_NUM_CODES };
+  const std::string name;
 
   /**
-   * The DispatchThread runs dispatch_entry to empty out the dispatch_queue.
+   * The DispatchThread runs entry() to empty out its shard of the queue.
    */
   class DispatchThread : public Thread {
     DispatchQueue *dq;
+    unsigned shard;
   public:
-    explicit DispatchThread(DispatchQueue *dq) : dq(dq) {}
+    DispatchThread(DispatchQueue *dq, unsigned shard) : dq(dq), shard(shard) {}
     void *entry() override {
-      dq->entry();
+      dq->entry(shard);
       return 0;
     }
-  } dispatch_thread;
+  };
+
+  /**
+   * Items of one connection always land on the same shard, so that its
+   * messages and connection events keep their order. Each shard has its own
+   * lock and thread; with ms_dispatch_shards = 1 there is a single
+   * dispatch thread, as dispatchers that are not safe to call concurrently
+   * expect.
+   */
+  struct Shard {
+    mutable ceph::mutex lock;
+    ceph::condition_variable cond;
+
+    PrioritizedQueue<QueueItem, uint64_t> mqueue;
+
+    std::set<std::pair<double, ceph::ref_t<Message>>> marrival;
+    std::map<ceph::ref_t<Message>, decltype(marrival)::iterator> marrival_map;
+    void add_arrival(const ceph::ref_t<Message>& m) {
+      marrival_map.insert(
+	make_pair(
+	  m,
+	  marrival.insert(std::make_pair(m->get_recv_stamp(), m)).first
+	  )
+	);
+    }
+    void remove_arrival(const ceph::ref_t<Message>& m) {
+      auto it = marrival_map.find(m);
+      ceph_assert(it != marrival_map.end());
+      marrival.erase(it->second);
+      marrival_map.erase(it);
+    }
+
+    DispatchThread dispatch_thread;
+
+    Shard(CephContext *cct, DispatchQueue *dq, unsigned i,
+	  const std::string &name)
+      : lock(ceph::make_mutex("Messenger::DispatchQueue::lock" + name +
+			      (i ? "-" + std::to_string(i) : ""))),
+	mqueue(cct->_conf->ms_pq_max_tokens_per_priority,
+	       cct->_conf->ms_pq_min_cost),
+	dispatch_thread(dq, i)
+    {}
+  };
+  std::vector<std::unique_ptr<Shard>> shards;
+
+  Shard& shard_of(const Connection *con) {
+    if (shards.size() == 1) {
+      return *shards[0];
+    }
+    // Connection pointers are allocation aligned, and std::hash of a
+    // pointer is the pointer itself: mix the bits before picking a shard
+    uint64_t h = reinterpret_cast<uintptr_t>(con) >> 4;
+    h = (h * 0x9e3779b97f4a7c15ull) >> 32;
+    return *shards[h % shards.size()];
+  }
+
+  std::atomic<uint64_t> next_id;
+
+  enum { D_CONNECT = 1, D_ACCEPT, D_BAD_REMOTE_RESET, D_BAD_RESET, D_CONN_REFUSED, D_NUM_CODES };
 
   ceph::mutex local_delivery_lock;
   ceph::condition_variable local_delivery_cond;
@@ -117,15 +159,34 @@ class DispatchQueue {
     }
   } local_delivery_thread;
 
+  /// per message type queue wait and dispatch times (if
+  /// ms_dispatch_type_perf_counters), created as types are first seen
+  ceph::mutex type_perf_lock =
+    ceph::make_mutex("Messenger::DispatchQueue::type_perf_lock");
+  std::map<int, PerfCounters*> type_perf;
+  PerfCounters *get_type_perf(const ceph::ref_t<Message>& m);
+
   uint64_t pre_dispatch(const ceph::ref_t<Message>& m);
   void post_dispatch(const ceph::ref_t<Message>& m, uint64_t msize);
 
+  void queue_code(int code, Connection *con) {
+    Shard& sh = shard_of(con);
+    std::lock_guard l{sh.lock};
+    if (stop)
+      return;
+    sh.mqueue.enqueue_strict(
+      0,
+      CEPH_MSG_PRIO_HIGHEST,
+      QueueItem(code, con));
+    sh.cond.notify_all();
+  }
+
  public:
 
   /// Throttle preventing us from building up a big backlog waiting for dispatch
   Throttle dispatch_throttler;
 
-  bool stop;
+  std::atomic<bool> stop;
   void local_delivery(const ceph::ref_t<Message>& m, int priority);
   void local_delivery(Message* m, int priority) {
     return local_delivery(ceph::ref_t<Message>(m, false), priority); /* consume ref */
@@ -135,8 +196,12 @@ class DispatchQueue {
   double get_max_age(utime_t now) const;
 
   int get_queue_len() const {
-    std::lock_guard l{lock};
-    return mqueue.length();
+    int len = 0;
+    for (auto& sh : shards) {
+      std::lock_guard l{sh->lock};
+      len += sh->mqueue.length();
+    }
+    return len;
   }
 
   /**
@@ -147,54 +212,19 @@ class DispatchQueue {
   void dispatch_throttle_release(uint64_t msize);
 
   void queue_connect(Connection *con) {
-    std::lock_guard l{lock};
-    if (stop)
-      return;
-    mqueue.enqueue_strict(
-      0,
-      CEPH_MSG_PRIO_HIGHEST,
-      QueueItem(D_CONNECT, con));
-    cond.notify_all();
+    queue_code(D_CONNECT, con);
   }
   void queue_accept(Connection *con) {
-    std::lock_guard l{lock};
-    if (stop)
-      return;
-    mqueue.enqueue_strict(
-      0,
-      CEPH_MSG_PRIO_HIGHEST,
-      QueueItem(D_ACCEPT, con));
-    cond.notify_all();
+    queue_code(D_ACCEPT, con);
   }
   void queue_remote_reset(Connection *con) {
-    std::lock_guard l{lock};
-    if (stop)
-      return;
-    mqueue.enqueue_strict(
-      0,
-      CEPH_MSG_PRIO_HIGHEST,
-      QueueItem(D_BAD_REMOTE_RESET, con));
-    cond.notify_all();
+    queue_code(D_BAD_REMOTE_RESET, con);
   }
   void queue_reset(Connection *con) {
-    std::lock_guard l{lock};
-    if (stop)
-      return;
-    mqueue.enqueue_strict(
-      0,
-      CEPH_MSG_PRIO_HIGHEST,
-      QueueItem(D_BAD_RESET, con));
-    cond.notify_all();
+    queue_code(D_BAD_RESET, con);
   }
   void queue_refused(Connection *con) {
-    std::lock_guard l{lock};
-    if (stop)
-      return;
-    mqueue.enqueue_strict(
-      0,
-      CEPH_MSG_PRIO_HIGHEST,
-      QueueItem(D_CONN_REFUSED, con));
-    cond.notify_all();
+    queue_code(D_CONN_REFUSED, con);
   }
 
   bool can_fast_dispatch(const ceph::cref_t<Message> &m) const;
@@ -213,30 +243,15 @@ class DispatchQueue {
     return next_id++;
   }
   void start();
-  void entry();
+  void entry(unsigned shard);
   void wait();
   void shutdown();
-  bool is_started() const {return dispatch_thread.is_started();}
-
-  DispatchQueue(CephContext *cct, Messenger *msgr, std::string &name)
-    : cct(cct), msgr(msgr),
-      lock(ceph::make_mutex("Messenger::DispatchQueue::lock" + name)),
-      mqueue(cct->_conf->ms_pq_max_tokens_per_priority,
-	     cct->_conf->ms_pq_min_cost),
-      next_id(1),
-      dispatch_thread(this),
-      local_delivery_lock(ceph::make_mutex("Messenger::DispatchQueue::local_delivery_lock" + name)),
-      stop_local_delivery(false),
-      local_delivery_thread(this),
-      dispatch_throttler(cct, std::string("msgr_dispatch_throttler-") + name,
-                         cct->_conf->ms_dispatch_throttle_bytes),
-      stop(false)
-    {}
-  ~DispatchQueue() {
-    ceph_assert(mqueue.empty());
-    ceph_assert(marrival.empty());
-    ceph_assert(local_messages.empty());
+  bool is_started() const {
+    return shards[0]->dispatch_thread.is_started();
   }
+
+  DispatchQueue(CephContext *cct, Messenger *msgr, std::string &name);
+  ~DispatchQueue();
 };
 
 #endif
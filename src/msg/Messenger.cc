@@ -35,10 +35,11 @@ uint64_t Messenger::get_random_nonce()
 
 Messenger *Messenger::create(CephContext *cct, const std::string &type,
 			     entity_name_t name, std::string lname,
-			     uint64_t nonce)
+			     uint64_t nonce, const std::string &stack_group)
 {
   if (type == "random" || type.find("async") != std::string::npos)
-    return new AsyncMessenger(cct, name, type, std::move(lname), nonce);
+    return new AsyncMessenger(cct, name, type, std::move(lname), nonce,
+			      stack_group);
   lderr(cct) << "unrecognized ms_type '" << type << "'" << dendl;
   return nullptr;
 }
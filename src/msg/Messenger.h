@@ -159,12 +159,15 @@ public:
    * @param name entity name to register
    * @param lname logical name of the messenger in this process (e.g., "client")
    * @param nonce nonce value to uniquely identify this instance on the current host
+   * @param stack_group if not empty, the name of a separate set of network
+   * workers this messenger should run on (async messengers only)
    */
   static Messenger *create(CephContext *cct,
                            const std::string &type,
                            entity_name_t name,
 			   std::string lname,
-                           uint64_t nonce);
+                           uint64_t nonce,
+                           const std::string &stack_group = "");
 
   static uint64_t get_random_nonce();
   static uint64_t get_pid_nonce();
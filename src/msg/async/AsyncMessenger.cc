@@ -193,6 +193,8 @@ void Processor::accept()
       if (r == 0) {
 	ldout(msgr->cct, 10) << __func__ << " accepted incoming on sd "
 			     << cli_socket.fd() << dendl;
+	if (!msgr->get_stack()->support_local_listen_table())
+	  w = msgr->get_stack()->place_accepted(w, cli_socket.fd());
 
 	msgr->add_accept(
 	  w, std::move(cli_socket),
@@ -252,9 +254,10 @@ struct StackSingleton {
   std::shared_ptr<NetworkStack> stack;
 
   explicit StackSingleton(CephContext *c): cct(c) {}
-  void ready(std::string &type) {
+  void ready(std::string &type, const std::string &group = "",
+	     unsigned num_workers = 0) {
     if (!stack)
-      stack = NetworkStack::create(cct, type);
+      stack = NetworkStack::create(cct, type, group, num_workers);
   }
   ~StackSingleton() {
     stack->stop();
@@ -278,7 +281,8 @@ class C_handle_reap : public EventCallback {
  */
 
 AsyncMessenger::AsyncMessenger(CephContext *cct, entity_name_t name,
-                               const std::string &type, std::string mname, uint64_t _nonce)
+                               const std::string &type, std::string mname, uint64_t _nonce,
+                               const std::string &stack_group)
   : SimplePolicyMessenger(cct, name),
     dispatch_queue(cct, this, mname),
     nonce(_nonce)
@@ -289,9 +293,23 @@ AsyncMessenger::AsyncMessenger(CephContext *cct, entity_name_t name,
   else if (type.find("dpdk") != std::string::npos)
     transport_type = "dpdk";
 
-  auto single = &cct->lookup_or_create_singleton_object<StackSingleton>(
-    "AsyncMessenger::NetworkStack::" + transport_type, true, cct);
-  single->ready(transport_type);
+  StackSingleton *single;
+  if (stack_group.empty() || transport_type != "posix") {
+    if (!stack_group.empty()) {
+      ldout(cct, 1) << __func__ << " separate " << stack_group
+		    << " network stack is not supported with "
+		    << transport_type << ", using the main one" << dendl;
+    }
+    single = &cct->lookup_or_create_singleton_object<StackSingleton>(
+      "AsyncMessenger::NetworkStack::" + transport_type, true, cct);
+    single->ready(transport_type);
+  } else {
+    single = &cct->lookup_or_create_singleton_object<StackSingleton>(
+      "AsyncMessenger::NetworkStack::" + transport_type + "::" + stack_group,
+      true, cct);
+    single->ready(transport_type, stack_group,
+		  cct->_conf->ms_async_heartbeat_op_threads);
+  }
   stack = single->stack.get();
   stack->start();
   local_worker = stack->get_worker();
@@ -80,9 +80,12 @@ public:
    * @param name The name to assign ourselves
    * _nonce A unique ID to use for this AsyncMessenger. It should not
    * be a value that will be repeated if the daemon restarts.
+   * @param stack_group if not empty, run on a separate network stack of
+   * that name, shared only with the messengers of the same group
    */
   AsyncMessenger(CephContext *cct, entity_name_t name, const std::string &type,
-                 std::string mname, uint64_t _nonce);
+                 std::string mname, uint64_t _nonce,
+                 const std::string &stack_group = "");
 
   /**
    * Destroy the AsyncMessenger. Pretty simple since all the work is done
@@ -108,12 +108,14 @@ std::ostream& EventCenter::_event_prefix(std::ostream *_dout)
                 << " time_id=" << time_event_next_id << ").";
 }
 
-int EventCenter::init(int nevent, unsigned center_id, const std::string &type)
+int EventCenter::init(int nevent, unsigned center_id, const std::string &type,
+		      const std::string &group)
 {
   // can't init multi times
   ceph_assert(this->nevent == 0);
 
   this->type = type;
+  this->group = group;
   this->center_id = center_id;
 
   if (type == "dpdk") {
@@ -149,6 +151,8 @@ int EventCenter::init(int nevent, unsigned center_id, const std::string &type)
 
   file_events.resize(nevent);
   this->nevent = nevent;
+  busy_poll_window = std::chrono::microseconds(
+    cct->_conf->ms_async_busy_poll_us);
 
   if (!driver->need_wakeup())
     return 0;
@@ -212,7 +216,7 @@ void EventCenter::set_owner()
   if (!global_centers) {
     global_centers = &cct->lookup_or_create_singleton_object<
       EventCenter::AssociatedCenters>(
-	"AsyncMessenger::EventCenter::global_center::" + type, true);
+	"AsyncMessenger::EventCenter::global_center::" + type + group, true);
     ceph_assert(global_centers);
     global_centers->centers[center_id] = this;
     if (driver->need_wakeup()) {
@@ -406,6 +410,12 @@ int EventCenter::process_events(unsigned timeout_microseconds,  ceph::timespan *
   }
 
   bool blocking = pollers.empty() && !external_num_events.load();
+  if (blocking && busy_poll_window != ceph::timespan::zero() &&
+      ceph::mono_clock::now() - last_event_at < busy_poll_window) {
+    // there was activity moments ago: spin rather than going to sleep,
+    // to save the wakeup latency if more comes in
+    blocking = false;
+  }
   if (!blocking)
     timeout_microseconds = 0;
   tv.tv_sec = timeout_microseconds / 1000000;
@@ -464,6 +474,9 @@ int EventCenter::process_events(unsigned timeout_microseconds,  ceph::timespan *
       numevents += pollers[i]->poll();
   }
 
+  if (numevents && busy_poll_window != ceph::timespan::zero()) {
+    last_event_at = ceph::mono_clock::now();
+  }
   if (working_dur)
     *working_dur = ceph::mono_clock::now() - working_start;
   return numevents;
@@ -158,6 +158,7 @@ class EventCenter {
  private:
   CephContext *cct;
   std::string type;
+  std::string group;  ///< the network stack we belong to, if not the main one
   int nevent;
   // Used only to external event
   pthread_t owner = 0;
@@ -179,6 +180,10 @@ class EventCenter {
   EventCallbackRef notify_handler;
   unsigned center_id;
   AssociatedCenters *global_centers = nullptr;
+  /// keep polling without blocking for this long after the last event
+  /// (ms_async_busy_poll_us)
+  ceph::timespan busy_poll_window{0};
+  ceph::mono_time last_event_at;
 
   int process_time_events();
   FileEvent *_get_file_event(int fd) {
@@ -196,7 +201,8 @@ class EventCenter {
   ~EventCenter();
   std::ostream& _event_prefix(std::ostream *_dout);
 
-  int init(int nevent, unsigned center_id, const std::string &type);
+  int init(int nevent, unsigned center_id, const std::string &type,
+	   const std::string &group = "");
   void set_owner();
   pthread_t get_owner() const { return owner; }
   unsigned get_id() const { return center_id; }
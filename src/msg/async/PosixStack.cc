@@ -339,3 +339,38 @@ PosixNetworkStack::PosixNetworkStack(CephContext *c)
     : NetworkStack(c)
 {
 }
+
+Worker *PosixNetworkStack::place_accepted(Worker *w, int fd)
+{
+#ifdef SO_INCOMING_CPU
+  if (worker_cpus.empty()) {
+    return w;
+  }
+  // the cpu the nic steers this flow to (RSS/RPS); handling the socket
+  // there keeps the softirq and the protocol work on the same cache
+  int cpu = -1;
+  socklen_t len = sizeof(cpu);
+  if (::getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) < 0) {
+    return w;
+  }
+  Worker *near = get_worker_near_cpu(cpu);
+  if (!near || near == w) {
+    if (near) {
+      --near->references;
+    }
+    return w;
+  }
+  // locality is not worth piling every flow of a busy queue on one worker
+  if (near->references > 2 * w->references.load() + 1) {
+    --near->references;
+    return w;
+  }
+  ldout(cct, 20) << __func__ << " sd " << fd << " incoming on cpu " << cpu
+		 << ", moving from worker " << w->id << " to " << near->id
+		 << dendl;
+  --w->references;
+  return near;
+#else
+  return w;
+#endif
+}
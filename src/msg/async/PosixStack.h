@@ -47,6 +47,8 @@ class PosixNetworkStack : public NetworkStack {
  public:
   explicit PosixNetworkStack(CephContext *c);
 
+  Worker *place_accepted(Worker *w, int fd) override;
+
   void spawn_worker(std::function<void ()> &&func) override {
     threads.emplace_back(std::move(func));
   }
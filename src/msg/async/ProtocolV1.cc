@@ -2063,6 +2063,7 @@ CtPtr ProtocolV1::handle_connect_message_2() {
 		<< " len " << auth_bl_copy.length()
 		<< dendl;
   bool more = (bool)auth_meta->authorizer_challenge;
+  const auto start = ceph::mono_clock::now();
   int r = messenger->auth_server->handle_auth_request(
     connection,
     am.get(),
@@ -2070,6 +2071,8 @@ CtPtr ProtocolV1::handle_connect_message_2() {
     am->auth_method,
     auth_bl_copy,
     &authorizer_reply);
+  connection->logger->tinc(l_msgr_handle_auth_request_lat,
+			   ceph::mono_clock::now() - start);
   if (r < 0) {
     connection->lock.lock();
     if (state != ACCEPTING_WAIT_CONNECT_MSG_AUTH) {
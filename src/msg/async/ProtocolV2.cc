@@ -557,7 +557,16 @@ ssize_t ProtocolV2::write_message(Message *m, bool more) {
                  << " off=" << header2.data_off
                  << dendl;
   ssize_t total_send_size = connection->outgoing_bl.length();
-  ssize_t rc = connection->_try_send(more);
+  ssize_t rc = 0;
+  if (more &&
+      total_send_size < (ssize_t)cct->_conf->ms_async_send_cork_bytes) {
+    // more messages are about to be written: let their frames join this
+    // one in a single send
+    ldout(cct, 20) << __func__ << " corking " << total_send_size
+		   << " bytes" << dendl;
+  } else {
+    rc = connection->_try_send(more);
+  }
   if (rc < 0) {
     ldout(cct, 1) << __func__ << " error sending " << m << ", "
                   << cpp_strerror(rc) << dendl;
@@ -654,9 +663,13 @@ void ProtocolV2::write_event() {
     }
 
     auto start = ceph::mono_clock::now();
+    const uint64_t cork_bytes = cct->_conf->ms_async_send_cork_bytes;
     bool more;
     do {
-      if (connection->is_queued()) {
+      // while corking (see write_message()), already queued frames are
+      // flushed along with the next message
+      if (connection->is_queued() &&
+	  connection->outgoing_bl.length() >= cork_bytes) {
 	if (r = connection->_try_send(); r!= 0) {
 	  // either fails to send or not all queued buffer is sent
 	  break;
@@ -1189,8 +1202,20 @@ CtPtr ProtocolV2::read_frame_segment() {
   rx_buffer_t rx_buffer;
   uint16_t align = rx_frame_asm.get_segment_align(seg_idx);
   try {
-    rx_buffer = ceph::buffer::ptr_node::create(ceph::buffer::create_aligned(
-        onwire_len, align));
+    if (unsigned head = get_data_segment_head(seg_idx, onwire_len); head) {
+      // Lay the data out the way the sender's data_off has it (like msgr1
+      // does), so that e.g. a write to an offset that is not page aligned
+      // lands at the same in-page offset and the object store does not
+      // have to copy it to realign it.
+      ceph::bufferptr ptr(ceph::buffer::create_aligned(
+        CEPH_PAGE_SIZE + onwire_len - head, CEPH_PAGE_SIZE));
+      ptr.set_offset(CEPH_PAGE_SIZE - head);
+      ptr.set_length(onwire_len);
+      rx_buffer = ceph::buffer::ptr_node::create(std::move(ptr));
+    } else {
+      rx_buffer = ceph::buffer::ptr_node::create(ceph::buffer::create_aligned(
+          onwire_len, align));
+    }
   } catch (const ceph::buffer::bad_alloc&) {
     // Catching because of potential issues with satisfying alignment.
     ldout(cct, 1) << __func__ << " can't allocate aligned rx_buffer"
@@ -1203,6 +1228,30 @@ CtPtr ProtocolV2::read_frame_segment() {
   return READ_RXBUF(std::move(rx_buffer), handle_read_frame_segment);
 }
 
+unsigned ProtocolV2::get_data_segment_head(size_t seg_idx,
+					   uint32_t onwire_len) const {
+  if (next_tag != Tag::MESSAGE ||
+      seg_idx != SegmentIndex::Msg::DATA ||
+      rx_frame_asm.get_segment_align(seg_idx) !=
+        segment_t::PAGE_SIZE_ALIGNMENT ||
+      session_stream_handlers.rx ||
+      session_compression_handlers.rx) {
+    // the received bytes are not the message data itself
+    return 0;
+  }
+  const auto& header_bl = rx_segments_data[SegmentIndex::Msg::HEADER];
+  if (header_bl.length() < sizeof(ceph_msg_header2)) {
+    return 0;
+  }
+  ceph_msg_header2 header2;
+  header_bl.cbegin().copy(sizeof(header2), reinterpret_cast<char*>(&header2));
+  const unsigned in_page = header2.data_off & ~CEPH_PAGE_MASK;
+  if (!in_page) {
+    return 0;
+  }
+  return std::min<unsigned>(CEPH_PAGE_SIZE - in_page, onwire_len);
+}
+
 CtPtr ProtocolV2::handle_read_frame_segment(rx_buffer_t &&rx_buffer, int r) {
   ldout(cct, 20) << __func__ << " r=" << r << dendl;
 
@@ -2241,10 +2290,13 @@ CtPtr ProtocolV2::_handle_auth_request(ceph::bufferlist& auth_payload, bool more
   ceph::bufferlist reply;
   auto am = auth_meta;
   connection->lock.unlock();
+  const auto start = ceph::mono_clock::now();
   int r = messenger->auth_server->handle_auth_request(
     connection, am.get(),
     more, am->auth_method, auth_payload,
     &reply);
+  connection->logger->tinc(l_msgr_handle_auth_request_lat,
+                           ceph::mono_clock::now() - start);
   connection->lock.lock();
   if (state != AUTH_ACCEPTING && state != AUTH_ACCEPTING_MORE) {
     ldout(cct, 1) << __func__
@@ -180,6 +180,9 @@ private:
   Ct<ProtocolV2> *finish_server_auth();
   Ct<ProtocolV2> *handle_read_frame_preamble_main(rx_buffer_t &&buffer, int r);
   Ct<ProtocolV2> *read_frame_segment();
+  /// bytes of the data segment to place before the next page boundary, to
+  /// match the sender's data_off. 0 for a plain page-aligned buffer.
+  unsigned get_data_segment_head(size_t seg_idx, uint32_t onwire_len) const;
   Ct<ProtocolV2> *handle_read_frame_segment(rx_buffer_t &&rx_buffer, int r);
   Ct<ProtocolV2> *_handle_read_frame_segment();
   Ct<ProtocolV2> *handle_read_frame_epilogue_main(rx_buffer_t &&buffer, int r);
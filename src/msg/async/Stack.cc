@@ -19,6 +19,7 @@
 #include "include/compat.h"
 #include "common/Cond.h"
 #include "common/errno.h"
+#include "common/numa.h"
 #include "PosixStack.h"
 #ifdef HAVE_RDMA
 #include "rdma/RDMAStack.h"
@@ -38,6 +39,20 @@ std::function<void ()> NetworkStack::add_thread(Worker* w)
 {
   return [this, w]() {
       rename_thread(w->id);
+      if (w->id < worker_cpus.size() && worker_cpus[w->id] >= 0) {
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(worker_cpus[w->id], &cpus);
+	int r = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	if (r) {
+	  lderr(cct) << __func__ << " failed to pin worker " << w->id
+		     << " to cpu " << worker_cpus[w->id] << ": "
+		     << cpp_strerror(r) << dendl;
+	  // keep placement away from a worker that does not run there
+	  std::lock_guard l(pool_spin);
+	  worker_cpus[w->id] = -1;
+	}
+      }
       const unsigned EventMaxWaitUs = 30000000;
       w->center.set_owner();
       ldout(cct, 10) << __func__ << " starting" << dendl;
@@ -61,7 +76,9 @@ std::function<void ()> NetworkStack::add_thread(Worker* w)
 }
 
 std::shared_ptr<NetworkStack> NetworkStack::create(CephContext *c,
-						   const std::string &t)
+						   const std::string &t,
+						   const std::string &group,
+						   unsigned num_workers)
 {
   std::shared_ptr<NetworkStack> stack = nullptr;
 
@@ -83,7 +100,10 @@ std::shared_ptr<NetworkStack> NetworkStack::create(CephContext *c,
     return nullptr;
   }
   
-  unsigned num_workers = c->_conf->ms_async_op_threads;
+  stack->group = group;
+  if (!num_workers) {
+    num_workers = c->_conf->ms_async_op_threads;
+  }
   ceph_assert(num_workers > 0);
   if (num_workers >= EventCenter::MAX_EVENTCENTER) {
     ldout(c, 0) << __func__ << " max thread limit is "
@@ -95,15 +115,57 @@ std::shared_ptr<NetworkStack> NetworkStack::create(CephContext *c,
   const int InitEventNumber = 5000;
   for (unsigned worker_id = 0; worker_id < num_workers; ++worker_id) {
     Worker *w = stack->create_worker(c, worker_id);
-    int ret = w->center.init(InitEventNumber, worker_id, t);
+    int ret = w->center.init(InitEventNumber, worker_id, t, group);
     if (ret)
       throw std::system_error(-ret, std::generic_category());
     stack->workers.push_back(w);
   }
+  stack->set_worker_affinity(c->_conf->ms_async_affinity_cores);
 
   return stack;
 }
 
+void NetworkStack::set_worker_affinity(const std::string &cores)
+{
+  if (cores.empty()) {
+    return;
+  }
+  size_t cpu_set_size;
+  cpu_set_t cpu_set;
+  if (parse_cpu_set_list(cores.c_str(), &cpu_set_size, &cpu_set) < 0) {
+    lderr(cct) << __func__ << " unable to parse ms_async_affinity_cores '"
+	       << cores << "'" << dendl;
+    return;
+  }
+  std::set<int> cpus = cpu_set_to_set(cpu_set_size, &cpu_set);
+  if (cpus.empty()) {
+    return;
+  }
+  std::vector<int> cpu_list(cpus.begin(), cpus.end());
+  worker_cpus.resize(workers.size());
+  for (unsigned i = 0; i < workers.size(); ++i) {
+    worker_cpus[i] = cpu_list[i % cpu_list.size()];
+    ldout(cct, 10) << __func__ << " worker " << i << " -> cpu "
+		   << worker_cpus[i] << dendl;
+  }
+
+  // remember which node each cpu sits on so that connections arriving on
+  // a cpu no worker is pinned to can still stay on the local node
+  cpu_node.assign(CPU_SETSIZE, -1);
+  for (int node = 0; ; ++node) {
+    size_t node_cpu_set_size;
+    cpu_set_t node_cpu_set;
+    if (get_numa_node_cpu_set(node, &node_cpu_set_size, &node_cpu_set) < 0) {
+      break;
+    }
+    for (int cpu : cpu_set_to_set(node_cpu_set_size, &node_cpu_set)) {
+      if (cpu >= 0 && cpu < (int)cpu_node.size()) {
+	cpu_node[cpu] = node;
+      }
+    }
+  }
+}
+
 NetworkStack::NetworkStack(CephContext *c)
   : cct(c)
 {}
@@ -155,6 +217,45 @@ Worker* NetworkStack::get_worker()
   return current_best;
 }
 
+Worker* NetworkStack::get_worker_near_cpu(int cpu)
+{
+  if (worker_cpus.empty() || cpu < 0) {
+    return nullptr;
+  }
+  int node = cpu < (int)cpu_node.size() ? cpu_node[cpu] : -1;
+  Worker *same_cpu = nullptr, *same_node = nullptr;
+  unsigned same_cpu_load = std::numeric_limits<unsigned>::max();
+  unsigned same_node_load = same_cpu_load;
+
+  pool_spin.lock();
+  for (Worker* worker : workers) {
+    int wcpu = worker_cpus[worker->id];
+    if (wcpu < 0) {
+      continue;
+    }
+    unsigned worker_load = worker->references.load();
+    if (wcpu == cpu) {
+      if (worker_load < same_cpu_load) {
+	same_cpu = worker;
+	same_cpu_load = worker_load;
+      }
+    } else if (node >= 0 && wcpu < (int)cpu_node.size() &&
+	       cpu_node[wcpu] == node) {
+      if (worker_load < same_node_load) {
+	same_node = worker;
+	same_node_load = worker_load;
+      }
+    }
+  }
+  pool_spin.unlock();
+
+  Worker *best = same_cpu ? same_cpu : same_node;
+  if (best) {
+    ++best->references;
+  }
+  return best;
+}
+
 void NetworkStack::stop()
 {
   std::lock_guard lk(pool_spin);
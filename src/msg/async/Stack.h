@@ -207,6 +207,7 @@ enum {
 
   l_msgr_send_messages_queue_lat,
   l_msgr_handle_ack_lat,
+  l_msgr_handle_auth_request_lat,
 
   l_msgr_recv_encrypted_bytes,
   l_msgr_send_encrypted_bytes,
@@ -253,6 +254,7 @@ class Worker {
 
     plb.add_time_avg(l_msgr_send_messages_queue_lat, "msgr_send_messages_queue_lat", "Network sent messages lat");
     plb.add_time_avg(l_msgr_handle_ack_lat, "msgr_handle_ack_lat", "Connection handle ack lat");
+    plb.add_time_avg(l_msgr_handle_auth_request_lat, "msgr_handle_auth_request_lat", "Connection handle auth request (authorizer verification) lat");
 
     plb.add_u64_counter(l_msgr_recv_encrypted_bytes, "msgr_recv_encrypted_bytes", "Network received encrypted bytes", NULL, 0, unit_t(UNIT_BYTES));
     plb.add_u64_counter(l_msgr_send_encrypted_bytes, "msgr_send_encrypted_bytes", "Network sent encrypted bytes", NULL, 0, unit_t(UNIT_BYTES));
@@ -313,13 +315,29 @@ class NetworkStack {
   virtual void rename_thread(unsigned id) {
     static constexpr int TASK_COMM_LEN = 16;
     char tp_name[TASK_COMM_LEN];
-    sprintf(tp_name, "msgr-worker-%u", id);
+    snprintf(tp_name, sizeof(tp_name), "%s-worker-%u",
+	     group.empty() ? "msgr" : group.c_str(), id);
     ceph_pthread_setname(pthread_self(), tp_name);
   }
 
  protected:
   CephContext *cct;
   std::vector<Worker*> workers;
+  /// set for stacks running apart from the main one (e.g. "hb")
+  std::string group;
+  /// cpu each worker is pinned to (ms_async_affinity_cores), -1 if unpinned.
+  /// sized before the workers start; entries only change under pool_spin
+  std::vector<int> worker_cpus;
+  /// numa node of each cpu, only filled in when workers are pinned
+  std::vector<int> cpu_node;
+
+  /**
+   * pick the least loaded worker pinned to @p cpu, or failing that one
+   * pinned to a cpu on the same numa node. The returned worker has its
+   * reference taken; nullptr if there is no such worker.
+   */
+  Worker *get_worker_near_cpu(int cpu);
+  void set_worker_affinity(const std::string &cores);
 
   explicit NetworkStack(CephContext *c);
  public:
@@ -330,8 +348,14 @@ class NetworkStack {
       delete w;
   }
 
+  /**
+   * @param group if not empty, the stack gets its own workers and event
+   *        centers, separate from those of the main stack of that type
+   * @param num_workers defaults to ms_async_op_threads
+   */
   static std::shared_ptr<NetworkStack> create(
-    CephContext *c, const std::string &type);
+    CephContext *c, const std::string &type,
+    const std::string &group = "", unsigned num_workers = 0);
 
   // backend need to override this method if backend doesn't support shared
   // listen table.
@@ -348,6 +372,12 @@ class NetworkStack {
   Worker *get_worker(unsigned worker_id) {
     return workers[worker_id];
   }
+  /**
+   * give the stack a chance to move a just accepted connection, handed to
+   * @p w, over to a worker closer to the cpu its packets arrive on.
+   * Returns the worker to use; references are moved along with it.
+   */
+  virtual Worker *place_accepted(Worker *w, int fd) { return w; }
   void drain();
   unsigned get_num_worker() const {
     return workers.size();
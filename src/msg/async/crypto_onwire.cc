@@ -19,6 +19,12 @@ static constexpr const std::size_t AESGCM_IV_LEN{12};
 static constexpr const std::size_t AESGCM_TAG_LEN{16};
 static constexpr const std::size_t AESGCM_BLOCK_LEN{16};
 
+// Plaintext buffers shorter than this are gathered before being encrypted:
+// the bulk AES-GCM code of the crypto library only kicks in for longer
+// runs, and an encoded message is typically made of many tiny buffers.
+static constexpr const std::size_t GATHER_MAX_BUF_LEN{512};
+static constexpr const std::size_t GATHER_LEN{8192};
+
 struct nonce_t {
   ceph_le32 fixed;
   ceph_le64 counter;
@@ -112,19 +118,41 @@ void AES128GCM_OnWireTxHandler::authenticated_encrypt_update(
               plaintext.length());
   auto filler = buffer.append_hole(plaintext.length());
 
-  for (const auto& plainbuf : plaintext.buffers()) {
+  auto encrypt = [this, &filler](const char* in, std::size_t len) {
     int update_len = 0;
 
     if(1 != EVP_EncryptUpdate(ectx.get(),
 	reinterpret_cast<unsigned char*>(filler.c_str()),
 	&update_len,
-	reinterpret_cast<const unsigned char*>(plainbuf.c_str()),
-	plainbuf.length())) {
+	reinterpret_cast<const unsigned char*>(in),
+	len)) {
       throw std::runtime_error("EVP_EncryptUpdate failed");
     }
     ceph_assert_always(update_len >= 0);
-    ceph_assert(static_cast<unsigned>(update_len) == plainbuf.length());
+    ceph_assert(static_cast<unsigned>(update_len) == len);
     filler.advance(update_len);
+  };
+
+  std::array<char, GATHER_LEN> gather;
+  std::size_t gathered = 0;
+  for (const auto& plainbuf : plaintext.buffers()) {
+    if (plainbuf.length() < GATHER_MAX_BUF_LEN) {
+      if (gathered + plainbuf.length() > gather.size()) {
+	encrypt(gather.data(), gathered);
+	gathered = 0;
+      }
+      ::memcpy(gather.data() + gathered, plainbuf.c_str(), plainbuf.length());
+      gathered += plainbuf.length();
+      continue;
+    }
+    if (gathered) {
+      encrypt(gather.data(), gathered);
+      gathered = 0;
+    }
+    encrypt(plainbuf.c_str(), plainbuf.length());
+  }
+  if (gathered) {
+    encrypt(gather.data(), gathered);
   }
 
   ldout(cct, 15) << __func__
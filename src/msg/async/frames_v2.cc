@@ -98,6 +98,42 @@ uint64_t FrameAssembler::get_frame_onwire_len() const {
   return onwire_len;
 }
 
+void FrameAssembler::calc_segment_crcs(bufferlist segment_bls[],
+                                       uint32_t crcs[]) const {
+  if (!m_with_data_crc) {
+    std::fill(crcs, crcs + m_descs.size(), 0);
+    return;
+  }
+  // short contiguous segments (the header and front of most messages) are
+  // checksummed together, so that the crc unit can work on them at once;
+  // anything else goes through bufferlist::crc32c and its per-raw cache,
+  // which e.g. saves work when the same data goes to several replicas
+  unsigned count = 0;
+  size_t idx[MAX_NUM_SEGMENTS];
+  uint32_t batch_crcs[MAX_NUM_SEGMENTS];
+  const unsigned char* data[MAX_NUM_SEGMENTS];
+  unsigned lengths[MAX_NUM_SEGMENTS];
+  for (size_t i = 0; i < m_descs.size(); i++) {
+    auto& bl = segment_bls[i];
+    if (bl.length() > 0 && bl.length() < 1024 && bl.get_num_buffers() == 1) {
+      idx[count] = i;
+      batch_crcs[count] = -1;
+      data[count] = reinterpret_cast<const unsigned char*>(
+        bl.front().c_str());
+      lengths[count] = bl.length();
+      count++;
+    } else {
+      crcs[i] = bl.crc32c(-1);
+    }
+  }
+  if (count) {
+    ceph_crc32c_multi(count, batch_crcs, data, lengths);
+    for (unsigned j = 0; j < count; j++) {
+      crcs[idx[j]] = batch_crcs[j];
+    }
+  }
+}
+
 bufferlist FrameAssembler::asm_crc_rev0(const preamble_block_t& preamble,
                                         bufferlist segment_bls[]) const {
   epilogue_crc_rev0_block_t epilogue;
@@ -106,9 +142,11 @@ bufferlist FrameAssembler::asm_crc_rev0(const preamble_block_t& preamble,
 
   bufferlist frame_bl(sizeof(preamble) + sizeof(epilogue));
   frame_bl.append(reinterpret_cast<const char*>(&preamble), sizeof(preamble));
+  uint32_t crcs[MAX_NUM_SEGMENTS];
+  calc_segment_crcs(segment_bls, crcs);
   for (size_t i = 0; i < m_descs.size(); i++) {
     ceph_assert(segment_bls[i].length() == m_descs[i].logical_len);
-    epilogue.crc_values[i] = m_with_data_crc ? segment_bls[i].crc32c(-1) : 0;
+    epilogue.crc_values[i] = crcs[i];
     if (segment_bls[i].length() > 0) {
       frame_bl.claim_append(segment_bls[i]);
     }
@@ -159,11 +197,12 @@ bufferlist FrameAssembler::asm_crc_rev1(const preamble_block_t& preamble,
   bufferlist frame_bl(sizeof(preamble) + FRAME_CRC_SIZE + sizeof(epilogue));
   frame_bl.append(reinterpret_cast<const char*>(&preamble), sizeof(preamble));
 
+  uint32_t crcs[MAX_NUM_SEGMENTS];
+  calc_segment_crcs(segment_bls, crcs);
   ceph_assert(segment_bls[0].length() == m_descs[0].logical_len);
   if (segment_bls[0].length() > 0) {
-    uint32_t crc = m_with_data_crc ? segment_bls[0].crc32c(-1) : 0;
     frame_bl.claim_append(segment_bls[0]);
-    encode(crc, frame_bl);
+    encode(crcs[0], frame_bl);
   }
   if (m_descs.size() == 1) {
     return frame_bl;  // no epilogue if only one segment
@@ -171,8 +210,7 @@ bufferlist FrameAssembler::asm_crc_rev1(const preamble_block_t& preamble,
 
   for (size_t i = 1; i < m_descs.size(); i++) {
     ceph_assert(segment_bls[i].length() == m_descs[i].logical_len);
-    epilogue.crc_values[i - 1] =
-            m_with_data_crc ? segment_bls[i].crc32c(-1) : 0;
+    epilogue.crc_values[i - 1] = crcs[i];
     if (segment_bls[i].length() > 0) {
       frame_bl.claim_append(segment_bls[i]);
     }
@@ -524,6 +562,14 @@ void FrameAssembler::asm_compress(bufferlist segment_bls[]) {
       }
   }
 
+  // small or already dense payloads may come out larger than they went in;
+  // the frame flag is per frame, so just send those uncompressed.
+  if (!abort &&
+      m_compression->tx->get_final_size() >=
+        m_compression->tx->get_initial_size()) {
+    abort = true;
+  }
+
   if (!abort) {
     m_compression->tx->done();
 
@@ -338,6 +338,9 @@ private:
 
   void asm_compress(bufferlist segment_bls[]);
 
+  // crc32c(-1) of each segment, or zeros without data crcs
+  void calc_segment_crcs(bufferlist segment_bls[], uint32_t crcs[]) const;
+
   bufferlist asm_crc_rev0(const preamble_block_t& preamble,
                           bufferlist segment_bls[]) const;
   bufferlist asm_secure_rev0(const preamble_block_t& preamble,
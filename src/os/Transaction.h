@@ -562,6 +562,33 @@ public:
     data_bl.append(other.data_bl);
   }
 
+  /// append a transaction we own: its buffers are moved, not shared
+  void append(Transaction&& other) {
+    if (data.ops == 0 && op_bl.length() == 0 && data_bl.length() == 0 &&
+	coll_index.empty() && object_index.empty()) {
+      // nothing to renumber, take other's buffers as they are
+      uint32_t fadvise_flags = data.fadvise_flags;
+      data = std::move(other.data);
+      data.fadvise_flags = data.fadvise_flags | fadvise_flags;
+      coll_index = std::move(other.coll_index);
+      object_index = std::move(other.object_index);
+      coll_id = other.coll_id;
+      object_id = other.object_id;
+      other.coll_id = 0;
+      other.object_id = 0;
+      op_bl = std::move(other.op_bl);
+      data_bl = std::move(other.data_bl);
+      on_applied.splice(on_applied.end(), other.on_applied);
+      on_commit.splice(on_commit.end(), other.on_commit);
+      on_applied_sync.splice(on_applied_sync.end(), other.on_applied_sync);
+      return;
+    }
+    ceph::buffer::list other_data_bl;
+    other_data_bl.swap(other.data_bl);
+    append(other);
+    data_bl.claim_append(other_data_bl);
+  }
+
   /** Inquires about the Transaction as a whole. */
 
   /// How big is the encoded Transaction buffer?
@@ -859,6 +886,29 @@ public:
     }
     data.ops = data.ops + 1;
   }
+  /// write, moving the data buffers into the transaction
+  void write(const coll_t& cid, const ghobject_t& oid, uint64_t off, uint64_t len,
+	     ceph::buffer::list&& write_data, uint32_t flags = 0) {
+    using ceph::encode;
+    uint32_t orig_len = data_bl.length();
+    Op* _op = _get_next_op();
+    _op->op = OP_WRITE;
+    _op->cid = _get_coll_id(cid);
+    _op->oid = _get_object_id(oid);
+    _op->off = off;
+    _op->len = len;
+
+    ceph_assert(len == write_data.length());
+    encode((__u32)len, data_bl);
+    data_bl.claim_append(write_data);
+    data.fadvise_flags = data.fadvise_flags | flags;
+    if (len > data.largest_data_len) {
+	data.largest_data_len = len;
+	data.largest_data_off = off;
+	data.largest_data_off_in_data_bl = orig_len + sizeof(__u32);
+    }
+    data.ops = data.ops + 1;
+  }
   /**
    * zero out the indicated byte range within an object. Some
    * ObjectStore instances may optimize this to release the
@@ -253,6 +253,8 @@ void BlueFS::_init_logger()
 		    PerfCountersBuilder::PRIO_CRITICAL, unit_t(UNIT_BYTES));
   b.add_u64_counter(l_bluefs_files_written_wal, "files_written_wal",
 		    "Files written to WAL");
+  b.add_u64_counter(l_bluefs_wal_presized, "wal_presized",
+		    "WAL files zero-filled to bluefs_wal_prealloc_size on create");
   b.add_u64_counter(l_bluefs_files_written_sst, "files_written_sst",
 		    "Files written to SSTs");
   b.add_u64_counter(l_bluefs_bytes_written_wal, "bytes_written_wal",
@@ -3569,6 +3571,17 @@ int BlueFS::_flush_F(FileWriter *h, bool force, bool *flushed)
 	     << h->file->fnode << dendl;
     return 0;
   }
+  if (h->presize) {
+    uint64_t presize = std::exchange(h->presize, 0);
+    if (h->pos == 0 && h->file->fnode.size == 0) {
+      int r = _presize_wal(h, presize);
+      if (r < 0) {
+	// not fatal, the file simply grows on append as usual
+	dout(1) << __func__ << " unable to presize " << h->file->fnode.ino
+		<< ": " << cpp_strerror(r) << dendl;
+      }
+    }
+  }
   dout(10) << __func__ << " " << h << " 0x"
            << std::hex << offset << "~" << length << std::dec
 	   << " to " << h->file->fnode << dendl;
@@ -3883,6 +3896,73 @@ int BlueFS::preallocate(FileRef f, uint64_t off, uint64_t len)/*_LF*/
   return 0;
 }
 
+// Give a fresh WAL file its full size up front and zero it, so that
+// appends up to that size neither allocate nor grow fnode.size and an
+// fsync comes down to flushing the data and the bdev, without a BlueFS
+// log round trip.  RocksDB skips the zeroed tail on recovery the same way
+// it does for mmap-preallocated logs; close trims the file to what was
+// actually written.  Called from the first flush with only the writer's
+// lock held, so the zeroing stalls nobody but that writer.
+int BlueFS::_presize_wal(FileWriter *h, uint64_t len)
+{
+  ceph_assert(ceph_mutex_is_locked(h->lock));
+  FileRef f = h->file;
+  ceph_assert(f->fnode.ino > 1);
+  ceph_assert(f->fnode.size == 0);
+  {
+    std::lock_guard ll(log.lock);
+    std::lock_guard fl(f->lock);
+    vselector->sub_usage(f->vselector_hint, f->fnode);
+    int r = _allocate(vselector->select_prefer_bdev(f->vselector_hint),
+		      len, 0, &f->fnode);
+    vselector->add_usage(f->vselector_hint, f->fnode);
+    if (r < 0) {
+      return r;
+    }
+  }
+
+  // fnode.size is still 0, so readers cannot reach these extents and the
+  // zeroing needs neither log.lock nor the file lock.  it must be stable
+  // before the size that exposes it is logged.
+  const uint64_t chunk = std::min<uint64_t>(len, 1ull << 20);
+  bufferptr z = buffer::create_page_aligned(chunk);
+  z.zero();
+  std::array<bool, MAX_BDEV> devs;
+  devs.fill(false);
+  for (auto& e : f->fnode.extents) {
+    for (uint64_t done = 0; done < e.length; ) {
+      uint64_t l = std::min(chunk, e.length - done);
+      bufferlist bl;
+      bl.append(z, 0, l);
+      int r = bdev[e.bdev]->write(e.offset + done, bl, false, h->write_hint);
+      if (r < 0) {
+	derr << __func__ << " failed to zero 0x" << std::hex
+	     << e.offset + done << "~" << l << std::dec << " on bdev "
+	     << (int)e.bdev << ": " << cpp_strerror(r) << dendl;
+	return r;
+      }
+      done += l;
+    }
+    devs[e.bdev] = true;
+  }
+  _flush_bdev(devs);
+
+  std::lock_guard ll(log.lock);
+  std::lock_guard fl(f->lock);
+  vselector->sub_usage(f->vselector_hint, f->fnode.size);
+  f->fnode.size = f->fnode.get_allocated();
+  vselector->add_usage(f->vselector_hint, f->fnode.size);
+  log.t.op_file_update_inc(f->fnode);
+  // the first fsync has to push this (and the file creation) to the log
+  f->is_dirty = true;
+  h->presized = true;
+  if (logger) {
+    logger->inc(l_bluefs_wal_presized);
+  }
+  dout(10) << __func__ << " " << h << " " << f->fnode << dendl;
+  return 0;
+}
+
 void BlueFS::sync_metadata(bool avoid_compact)/*_LNF_NF_LD_D*/
 {
   bool can_skip_flush;
@@ -4011,6 +4091,11 @@ int BlueFS::open_for_write(
     if (logger && !overwrite) {
       logger->inc(l_bluefs_files_written_wal);
     }
+    if (!overwrite) {
+      // done by the first flush, not here: open_for_write should not do
+      // I/O on behalf of the writer
+      (*h)->presize = cct->_conf->bluefs_wal_prealloc_size;
+    }
   } else if (boost::algorithm::ends_with(filename, ".sst")) {
     (*h)->writer_type = BlueFS::WRITER_SST;
     if (logger) {
@@ -33,6 +33,7 @@ enum {
   l_bluefs_log_compactions,
   l_bluefs_logged_bytes,
   l_bluefs_files_written_wal,
+  l_bluefs_wal_presized,
   l_bluefs_files_written_sst,
   l_bluefs_bytes_written_wal,
   l_bluefs_bytes_written_sst,
@@ -210,6 +211,8 @@ public:
   public:
     int writer_type = 0;    ///< WRITER_*
     int write_hint = WRITE_LIFE_NOT_SET;
+    uint64_t presize = 0;   ///< zero-fill this much on the first flush
+    bool presized = false;  ///< zero-filled ahead by _presize_wal()
 
     ceph::mutex lock = ceph::make_mutex("BlueFS::FileWriter::lock");
     std::array<IOContext*,MAX_BDEV> iocv; ///< for each bdev
@@ -494,6 +497,7 @@ private:
   void _flush_bdev(std::array<bool, MAX_BDEV>& dirty_bdevs);  // this is safe to call without a lock
 
   int _preallocate(FileRef f, uint64_t off, uint64_t len);
+  int _presize_wal(FileWriter *h, uint64_t len);
   int _truncate(FileWriter *h, uint64_t off);
 
   int64_t _read(
@@ -227,7 +227,7 @@ class BlueRocksWritableFile : public rocksdb::WritableFile {
     size_t block_size;
     size_t last_allocated_block;
     GetPreallocationStatus(&block_size, &last_allocated_block);
-    if (last_allocated_block > 0) {
+    if (last_allocated_block > 0 || h->presized) {
       int r = fs->truncate(h, h->pos);
       if (r < 0)
 	return err_to_status(r);
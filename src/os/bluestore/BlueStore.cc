@@ -73,17 +73,18 @@
 using bid_t = decltype(BlueStore::Blob::id);
 
 // bluestore_cache_onode
-MEMPOOL_DEFINE_OBJECT_FACTORY(BlueStore::Onode, bluestore_onode,
-			      bluestore_cache_onode);
+// cached metadata objects are many and long lived, keep them in slabs
+MEMPOOL_DEFINE_OBJECT_SLAB_FACTORY(BlueStore::Onode, bluestore_onode,
+				   bluestore_cache_onode);
 
 MEMPOOL_DEFINE_OBJECT_FACTORY(BlueStore::Buffer, bluestore_buffer,
 			      bluestore_cache_buffer);
-MEMPOOL_DEFINE_OBJECT_FACTORY(BlueStore::Extent, bluestore_extent,
-			      bluestore_extent);
-MEMPOOL_DEFINE_OBJECT_FACTORY(BlueStore::Blob, bluestore_blob,
-			      bluestore_blob);
-MEMPOOL_DEFINE_OBJECT_FACTORY(BlueStore::SharedBlob, bluestore_shared_blob,
-			      bluestore_shared_blob);
+MEMPOOL_DEFINE_OBJECT_SLAB_FACTORY(BlueStore::Extent, bluestore_extent,
+				   bluestore_extent);
+MEMPOOL_DEFINE_OBJECT_SLAB_FACTORY(BlueStore::Blob, bluestore_blob,
+				   bluestore_blob);
+MEMPOOL_DEFINE_OBJECT_SLAB_FACTORY(BlueStore::SharedBlob, bluestore_shared_blob,
+				   bluestore_shared_blob);
 
 // bluestore_txc
 MEMPOOL_DEFINE_OBJECT_FACTORY(BlueStore::TransContext, bluestore_transcontext,
@@ -1787,6 +1788,15 @@ void BlueStore::BufferSpace::read(
   uint32_t want_bytes = length;
   uint32_t end = offset + length;
 
+  // WRITING buffers are added with the collection lock held exclusively
+  // and we run under it shared; anything else racing in is a clean copy of
+  // what is on disk.  Either way an empty space is a plain miss.
+  if (num_buffers.load(std::memory_order_acquire) == 0) {
+    cache->logger->inc(l_bluestore_buffer_miss_bytes, want_bytes);
+    cache->logger->inc(l_bluestore_buffer_lockless_misses);
+    return;
+  }
+
   {
     std::lock_guard l(cache->lock);
     for (auto i = _data_lower_bound(offset);
@@ -1805,7 +1815,6 @@ void BlueStore::BufferSpace::read(
 	  uint32_t skip = offset - b->offset;
 	  uint32_t l = min(length, b->length - skip);
 	  res[offset].substr_of(b->data, skip, l);
-	  res_intervals.insert(offset, l);
 	  offset += l;
 	  length -= l;
 	  if (!b->is_writing()) {
@@ -1826,11 +1835,9 @@ void BlueStore::BufferSpace::read(
         }
         if (b->length > length) {
 	  res[offset].substr_of(b->data, 0, length);
-	  res_intervals.insert(offset, length);
           break;
         } else {
 	  res[offset].append(b->data);
-	  res_intervals.insert(offset, b->length);
           if (b->length == length)
             break;
 	  offset += b->length;
@@ -1839,6 +1846,10 @@ void BlueStore::BufferSpace::read(
       }
     }
   }
+  // build the interval set after dropping the lock, it allocates
+  for (auto& [off, bl] : res) {
+    res_intervals.insert(off, bl.length());
+  }
 
   uint64_t hit_bytes = res_intervals.size();
   ceph_assert(hit_bytes <= want_bytes);
@@ -1866,6 +1877,7 @@ void BlueStore::BufferSpace::_finish_write(BufferCacheShard* cache, uint64_t seq
       writing.erase(i++);
       ldout(cache->cct, 20) << __func__ << " discard " << *b << dendl;
       buffer_map.erase(b->offset);
+      num_buffers.store(buffer_map.size(), std::memory_order_release);
     } else {
       b->state = Buffer::STATE_CLEAN;
       writing.erase(i++);
@@ -1988,6 +2000,12 @@ BlueStore::OnodeRef BlueStore::OnodeSpace::lookup(const ghobject_t& oid)
   return o;
 }
 
+bool BlueStore::OnodeSpace::contains(const ghobject_t& oid)
+{
+  std::lock_guard l(cache->lock);
+  return onode_map.count(oid) > 0;
+}
+
 void BlueStore::OnodeSpace::clear()
 {
   std::lock_guard l(cache->lock);
@@ -2466,11 +2484,65 @@ BlueStore::OldExtent* BlueStore::OldExtent::create(CollectionRef c,
 #undef dout_context
 #define dout_context onode->c->store->cct
 
-BlueStore::ExtentMap::ExtentMap(Onode *o, size_t inline_shard_prealloc_size)
+BlueStore::ExtentMap::ExtentMap(Onode *o, size_t inline_shard_prealloc_size,
+				 uint32_t flat_index_max)
   : onode(o),
+    flat_index_max(flat_index_max),
+    flat_index_active(flat_index_max > 0),
     inline_bl(inline_shard_prealloc_size) {
 }
 
+BlueStore::extent_map_t::iterator BlueStore::ExtentMap::insert_extent(
+  Extent *le)
+{
+  auto r = extent_map.insert(*le);
+  if (flat_index_active && r.second) {
+    if (extent_map.size() > flat_index_max) {
+      // grew past the threshold; fall back to the tree alone
+      decltype(flat_index)().swap(flat_index);
+      flat_index_active = false;
+    } else {
+      auto p = std::lower_bound(
+	flat_index.begin(), flat_index.end(), le->logical_offset,
+	[](const flat_extent_t& a, uint32_t o) { return a.first < o; });
+      flat_index.emplace(p, le->logical_offset, le);
+    }
+  }
+  return r.first;
+}
+
+void BlueStore::ExtentMap::rm(extent_map_t::iterator p)
+{
+  if (flat_index_active) {
+    auto q = std::lower_bound(
+      flat_index.begin(), flat_index.end(), p->logical_offset,
+      [](const flat_extent_t& a, uint32_t o) { return a.first < o; });
+    ceph_assert(q != flat_index.end() && q->second == &*p);
+    flat_index.erase(q);
+  }
+  extent_map.erase_and_dispose(p, DeleteDisposer());
+  if (!flat_index_active && flat_index_max &&
+      extent_map.size() <= flat_index_max / 2) {
+    // only come back once well below the threshold so that a map hovering
+    // around it doesn't rebuild on every other write
+    rebuild_flat_index();
+  }
+}
+
+void BlueStore::ExtentMap::rebuild_flat_index()
+{
+  flat_index.clear();
+  flat_index_active = flat_index_max && extent_map.size() <= flat_index_max;
+  if (!flat_index_active) {
+    decltype(flat_index)().swap(flat_index);
+    return;
+  }
+  flat_index.reserve(extent_map.size());
+  for (auto& e : extent_map) {
+    flat_index.emplace_back(e.logical_offset, &e);
+  }
+}
+
 void BlueStore::ExtentMap::dump(Formatter* f) const
 {
   f->open_array_section("extents");
@@ -2558,7 +2630,7 @@ void BlueStore::ExtentMap::dup(BlueStore* b, TransContext* txc,
 
     Extent* ne = new Extent(e.logical_offset + skip_front + dstoff - srcoff,
       e.blob_offset + skip_front, e.length - skip_front - skip_back, cb);
-    newo->extent_map.extent_map.insert(*ne);
+    newo->extent_map.insert_extent(ne);
     ne->blob->get_ref(c.get(), ne->blob_offset, ne->length);
     // fixme: we may leave parts of new blob unreferenced that could
     // be freed (relative to the shared_blob).
@@ -3269,7 +3341,7 @@ BlueStore::Extent* BlueStore::ExtentMap::ExtentDecoderFull::get_next_extent()
 
 void BlueStore::ExtentMap::ExtentDecoderFull::add_extent(BlueStore::Extent* le)
 {
-  extent_map.extent_map.insert(*le);
+  extent_map.insert_extent(le);
 }
 
 unsigned BlueStore::ExtentMap::decode_some(bufferlist& bl)
@@ -3419,9 +3491,26 @@ BlueStore::extent_map_t::iterator BlueStore::ExtentMap::find(
   return extent_map.find(dummy);
 }
 
+BlueStore::Extent *BlueStore::ExtentMap::_flat_seek_lextent(
+  uint64_t offset) const
+{
+  ceph_assert(flat_index.size() == extent_map.size());
+  auto p = std::lower_bound(
+    flat_index.begin(), flat_index.end(), offset,
+    [](const flat_extent_t& a, uint64_t o) { return a.first < o; });
+  if (p != flat_index.begin() && (p - 1)->second->logical_end() > offset) {
+    --p;
+  }
+  return p == flat_index.end() ? nullptr : p->second;
+}
+
 BlueStore::extent_map_t::iterator BlueStore::ExtentMap::seek_lextent(
   uint64_t offset)
 {
+  if (flat_index_active) {
+    Extent *e = _flat_seek_lextent(offset);
+    return e ? extent_map.iterator_to(*e) : extent_map.end();
+  }
   Extent dummy(offset);
   auto fp = extent_map.lower_bound(dummy);
   if (fp != extent_map.begin()) {
@@ -3436,6 +3525,10 @@ BlueStore::extent_map_t::iterator BlueStore::ExtentMap::seek_lextent(
 BlueStore::extent_map_t::const_iterator BlueStore::ExtentMap::seek_lextent(
   uint64_t offset) const
 {
+  if (flat_index_active) {
+    const Extent *e = _flat_seek_lextent(offset);
+    return e ? extent_map.iterator_to(*e) : extent_map.end();
+  }
   Extent dummy(offset);
   auto fp = extent_map.lower_bound(dummy);
   if (fp != extent_map.begin()) {
@@ -3595,7 +3688,7 @@ BlueStore::Extent *BlueStore::ExtentMap::set_lextent(
   }
 
   Extent *le = new Extent(logical_offset, blob_offset, length, b);
-  extent_map.insert(*le);
+  insert_extent(le);
   if (spans_shard(logical_offset, length)) {
     request_reshard(logical_offset, logical_offset + length);
   }
@@ -3624,7 +3717,7 @@ BlueStore::BlobRef BlueStore::ExtentMap::split_blob(
       // split extent
       size_t left = pos - ep->logical_offset;
       Extent *ne = new Extent(pos, 0, ep->length - left, rb);
-      extent_map.insert(*ne);
+      insert_extent(ne);
       ep->length = left;
       dout(30) << __func__ << "  split " << *ep << dendl;
       dout(30) << __func__ << "     to " << *ne << dendl;
@@ -4118,6 +4211,44 @@ BlueStore::OnodeRef BlueStore::Collection::get_onode(
   return onode_space.add_onode(oid, o);
 }
 
+void BlueStore::Collection::preload_onodes(const std::vector<ghobject_t>& oids)
+{
+  ceph_assert(ceph_mutex_is_wlocked(lock));
+
+  spg_t pgid;
+  bool is_pg = cid.is_pg(&pgid);
+  std::map<string, const ghobject_t*> want;
+  for (auto& oid : oids) {
+    // strays are left for get_onode() to complain about
+    if (is_pg && !oid.match(cnode.bits, pgid.ps())) {
+      continue;
+    }
+    if (onode_space.contains(oid)) {
+      continue;
+    }
+    string key;
+    get_object_key(store->cct, oid, &key);
+    want.emplace(std::move(key), &oid);
+  }
+  if (want.size() < 2) {
+    return; // nothing to batch, get_onode() will do
+  }
+
+  std::set<string> keys;
+  for (auto& w : want) {
+    keys.emplace_hint(keys.end(), w.first);
+  }
+  std::map<string, bufferlist> found;
+  store->db->get(PREFIX_OBJ, keys, &found);
+  ldout(store->cct, 20) << __func__ << " " << found.size() << " of "
+			<< keys.size() << " onodes found" << dendl;
+  for (auto& [key, v] : found) {
+    const ghobject_t& oid = *want[key];
+    OnodeRef o(Onode::create_decode(this, oid, key, v, true));
+    onode_space.add_onode(oid, o);
+  }
+}
+
 void BlueStore::Collection::split_cache(
   Collection *dest)
 {
@@ -4163,9 +4294,16 @@ void BlueStore::Collection::split_cache(
       // move over shared blobs and buffers.  cover shared blobs from
       // both extent map and spanning blob map (the full extent map
       // may not be faulted in)
+      // adjacent extents usually share a blob, so skip the repeats here
+      // rather than revisiting them below.
       vector<SharedBlob*> sbvec;
+      sbvec.reserve(o->extent_map.extent_map.size() +
+		    o->extent_map.spanning_blob_map.size());
       for (auto& e : o->extent_map.extent_map) {
-	sbvec.push_back(e.blob->shared_blob.get());
+	SharedBlob *sb = e.blob->shared_blob.get();
+	if (sbvec.empty() || sbvec.back() != sb) {
+	  sbvec.push_back(sb);
+	}
       }
       for (auto& b : o->extent_map.spanning_blob_map) {
 	sbvec.push_back(b.second->shared_blob.get());
@@ -4301,6 +4439,7 @@ void *BlueStore::MempoolThread::entry()
       interval_stats_trim = true;
 
       if (pcm != nullptr) {
+        pcm->set_adaptive(store->cct->_conf->bluestore_cache_autotune_adaptive);
         pcm->balance();
       }
 
@@ -4634,7 +4773,8 @@ BlueStore::BlueStore(CephContext *cct,
 #endif
     min_alloc_size(_min_alloc_size),
     min_alloc_size_order(std::countr_zero(_min_alloc_size)),
-    mempool_thread(this)
+    mempool_thread(this),
+    fsck_thread(this)
 {
   _init_logger();
   cct->_conf.add_observer(this);
@@ -5106,6 +5246,11 @@ void BlueStore::_init_logger()
   b.add_time_avg(l_bluestore_read_lat, "read_lat",
 		 "Average read latency",
 		 "r_l", PerfCountersBuilder::PRIO_CRITICAL);
+  b.add_u64_counter(l_bluestore_readahead_count, "readahead_count",
+		    "Prefetches issued for sequential read streams");
+  b.add_u64_counter(l_bluestore_readahead_bytes, "readahead_bytes",
+		    "Bytes prefetched for sequential read streams",
+		    NULL, 0, unit_t(UNIT_BYTES));
   //****************************************
 
   // kv_thread latencies
@@ -5159,6 +5304,15 @@ void BlueStore::_init_logger()
 		    NULL,
 		    PerfCountersBuilder::PRIO_DEBUGONLY,
 		    unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluestore_write_realigned_ops, "write_realigned_ops",
+		    "Device writes whose data had to be copied for alignment",
+		    NULL,
+		    PerfCountersBuilder::PRIO_DEBUGONLY);
+  b.add_u64_counter(l_bluestore_write_realigned_bytes, "write_realigned_bytes",
+		    "Sum for bytes of device writes that had to be realigned",
+		    NULL,
+		    PerfCountersBuilder::PRIO_DEBUGONLY,
+		    unit_t(UNIT_BYTES));
   b.add_u64_counter(l_bluestore_write_penalty_read_ops, "write_penalty_read_ops",
 		    "Sum for write penalty read ops");
   b.add_u64_counter(l_bluestore_write_new, "write_new",
@@ -5211,6 +5365,8 @@ void BlueStore::_init_logger()
   b.add_time_avg(l_bluestore_compress_lat, "compress_lat",
 	    "Average compress latency",
 	    "_cpl", PerfCountersBuilder::PRIO_USEFUL);
+  b.add_time_avg(l_bluestore_compress_batch_lat, "compress_batch_lat",
+	    "Average latency of compressing all blobs of a write together");
   b.add_time_avg(l_bluestore_decompress_lat, "decompress_lat",
 	    "Average decompress latency",
 	    "dcpl", PerfCountersBuilder::PRIO_USEFUL);
@@ -5218,6 +5374,8 @@ void BlueStore::_init_logger()
 	    "Sum for beneficial compress ops");
   b.add_u64_counter(l_bluestore_compress_rejected_count, "compress_rejected_count",
 	    "Sum for compress ops rejected due to low net gain of space");
+  b.add_u64_counter(l_bluestore_compress_skipped_count, "compress_skipped_count",
+	    "Sum for writes not compressed because recent data did not compress");
   //****************************************
 
   // onode cache stats
@@ -5262,6 +5420,11 @@ void BlueStore::_init_logger()
 	    NULL,
 	    PerfCountersBuilder::PRIO_DEBUGONLY,
 	    unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluestore_buffer_lockless_misses,
+	    "buffer_lockless_misses",
+	    "Cache lookups answered without taking the cache shard lock",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY);
   //****************************************
 
   // internal stats
@@ -5318,6 +5481,16 @@ void BlueStore::_init_logger()
     "tr_l", PerfCountersBuilder::PRIO_USEFUL);
   //****************************************
 
+  // incremental fsck
+  //****************************************
+  b.add_u64_counter(l_bluestore_fsck_incremental_passes, "fsck_incremental_passes",
+    "Completed incremental fsck passes");
+  b.add_u64_counter(l_bluestore_fsck_incremental_objects, "fsck_incremental_objects",
+    "Objects rechecked by incremental fsck");
+  b.add_u64_counter(l_bluestore_fsck_incremental_errors, "fsck_incremental_errors",
+    "Errors found by incremental fsck");
+  //****************************************
+
   // Resulting size axis configuration for op histograms, values are in bytes
   PerfHistogramCommon::axis_config_d alloc_hist_x_axis_config{
     "Given size (bytes)",
@@ -7781,6 +7954,7 @@ int BlueStore::_mount()
 #endif
 
   mempool_thread.init();
+  fsck_thread.init();
 
   if ((!per_pool_stat_collection || per_pool_omap != OMAP_PER_PG) &&
     cct->_conf->bluestore_fsck_quick_fix_on_mount == true) {
@@ -7810,6 +7984,7 @@ int BlueStore::umount()
   ceph_assert(alloc);
 
   if (!_kv_only) {
+    fsck_thread.shutdown();
     mempool_thread.shutdown();
 #ifdef HAVE_LIBZBD
     if (bdev->is_smr()) {
@@ -10069,6 +10244,256 @@ out_scan:
   return repair ? errors + warnings - (int)repaired : errors;
 }
 
+void BlueStore::_fsck_note_committed(const deque<TransContext*>& txcs)
+{
+  uint64_t max = cct->_conf->bluestore_fsck_incremental_max_pending;
+  std::lock_guard l(fsck_dirty_lock);
+  for (auto txc : txcs) {
+    for (auto& o : txc->onodes) {
+      if (fsck_dirty.size() >= max && !fsck_dirty.count(o->oid)) {
+	++fsck_dirty_dropped;
+	continue;
+      }
+      fsck_dirty.emplace(o->oid, o->c->cid);
+    }
+  }
+}
+
+int64_t BlueStore::_fsck_check_onode_online(
+  CollectionRef& c,
+  const ghobject_t& oid)
+{
+  string key;
+  get_object_key(cct, oid, &key);
+  std::shared_lock l(c->lock);
+  bufferlist value;
+  if (db->get(PREFIX_OBJ, key, &value) < 0) {
+    return 0; // removed since
+  }
+
+  int64_t errors = 0;
+  OnodeRef o;
+  try {
+    o.reset(Onode::create_decode(c, oid, key, value));
+    // load the shards straight from the db rather than via fault_range(),
+    // which asserts on a missing shard
+    for (auto& s : o->extent_map.shards) {
+      string skey;
+      get_extent_shard_key(o->key, s.shard_info->offset, &skey);
+      bufferlist v;
+      if (db->get(PREFIX_OBJ, skey, &v) < 0) {
+	derr << "fsck error: " << oid << " missing shard 0x" << std::hex
+	     << s.shard_info->offset << std::dec << dendl;
+	++errors;
+	continue;
+      }
+      if (v.length() != s.shard_info->bytes) {
+	derr << "fsck error: " << oid << " shard 0x" << std::hex
+	     << s.shard_info->offset << " is 0x" << v.length()
+	     << " bytes, onode expects 0x" << s.shard_info->bytes
+	     << std::dec << dendl;
+	++errors;
+	continue;
+      }
+      s.extents = o->extent_map.decode_some(v);
+      s.loaded = true;
+      if (s.shard_info->offset >= o->onode.size) {
+	derr << "fsck error: " << oid << " shard 0x" << std::hex
+	     << s.shard_info->offset << " past EOF at 0x" << o->onode.size
+	     << std::dec << dendl;
+	++errors;
+      }
+    }
+  } catch (ceph::buffer::error& e) {
+    derr << "fsck error: " << oid << " failed to decode onode: "
+	 << e.what() << dendl;
+    ++errors;
+    o.reset();
+  }
+
+  if (o) {
+    uint64_t pos = 0;
+    uint64_t dev_size = bdev->get_size();
+    mempool::bluestore_fsck::map<BlobRef,
+      bluestore_blob_use_tracker_t> ref_map;
+    for (auto& l : o->extent_map.extent_map) {
+      if (l.logical_offset < pos) {
+	derr << "fsck error: " << oid << " lextent at 0x"
+	     << std::hex << l.logical_offset
+	     << " overlaps with the previous, which ends at 0x" << pos
+	     << std::dec << dendl;
+	++errors;
+      }
+      if (o->extent_map.spans_shard(l.logical_offset, l.length)) {
+	derr << "fsck error: " << oid << " lextent at 0x"
+	     << std::hex << l.logical_offset << "~" << l.length
+	     << " spans a shard boundary"
+	     << std::dec << dendl;
+	++errors;
+      }
+      pos = l.logical_offset + l.length;
+      const bluestore_blob_t& blob = l.blob->get_blob();
+      auto& ref = ref_map[l.blob];
+      if (ref.is_empty()) {
+	ref.init(blob.get_logical_length(),
+		 blob.get_release_size(min_alloc_size));
+      }
+      ref.get(l.blob_offset, l.length);
+    }
+    for (auto& [b, ref] : ref_map) {
+      const bluestore_blob_t& blob = b->get_blob();
+      if (!b->get_blob_use_tracker().equal(ref)) {
+	derr << "fsck error: " << oid << " blob " << *b
+	     << " doesn't match expected ref_map " << ref << dendl;
+	++errors;
+      }
+      for (auto& e : blob.get_extents()) {
+	if (e.is_valid() && e.end() > dev_size) {
+	  derr << "fsck error: " << oid << " blob " << blob
+	       << " extent " << e << " past end of device 0x"
+	       << std::hex << dev_size << std::dec << dendl;
+	  ++errors;
+	}
+      }
+      if (blob.is_shared()) {
+	auto sbid = b->shared_blob->get_sbid();
+	if (sbid == 0 || sbid > blobid_max) {
+	  derr << "fsck error: " << oid << " blob " << blob
+	       << " has invalid sbid 0x" << std::hex << sbid
+	       << std::dec << dendl;
+	  ++errors;
+	  continue;
+	}
+	string sbkey;
+	bufferlist v;
+	get_shared_blob_key(sbid, &sbkey);
+	if (db->get(PREFIX_SHARED_BLOB, sbkey, &v) < 0) {
+	  derr << "fsck error: " << oid << " blob " << blob
+	       << " references missing shared blob 0x" << std::hex << sbid
+	       << std::dec << dendl;
+	  ++errors;
+	}
+      }
+    }
+    for (auto& [id, b] : o->extent_map.spanning_blob_map) {
+      if (ref_map.count(b) == 0) {
+	derr << "fsck error: " << oid << " stray spanning blob " << id
+	     << dendl;
+	++errors;
+      }
+    }
+  }
+
+  if (errors) {
+    // the keys above come from separate lookups; a commit that raced
+    // with them can look like damage, so only believe what is still
+    // there with the very same onode
+    bufferlist now;
+    if (db->get(PREFIX_OBJ, key, &now) < 0 || !now.contents_equal(value)) {
+      dout(10) << __func__ << " " << oid << " changed while being checked"
+	       << dendl;
+      return 0;
+    }
+  }
+  return errors;
+}
+
+int64_t BlueStore::_fsck_incremental_pass()
+{
+  mempool::bluestore_fsck::map<ghobject_t, coll_t> dirty;
+  uint64_t dropped;
+  {
+    std::lock_guard l(fsck_dirty_lock);
+    dirty.swap(fsck_dirty);
+    dropped = fsck_dirty_dropped;
+    fsck_dirty_dropped = 0;
+  }
+  if (dirty.empty() && !dropped) {
+    return 0;
+  }
+  uint64_t epoch = fsck_epoch + 1;
+  dout(10) << __func__ << " epoch " << epoch << " checking " << dirty.size()
+	   << " objects" << dendl;
+  if (dropped) {
+    dout(1) << __func__ << " " << dropped << " commits since the last pass"
+	    << " were not tracked (bluestore_fsck_incremental_max_pending);"
+	    << " only a full fsck covers them" << dendl;
+  }
+
+  uint64_t rate = cct->_conf->bluestore_fsck_incremental_objects_per_sec;
+  auto start = mono_clock::now();
+  uint64_t checked = 0;
+  int64_t errors = 0;
+  for (auto& [oid, cid] : dirty) {
+    CollectionRef c = _get_collection(cid);
+    if (c) {
+      errors += _fsck_check_onode_online(c, oid);
+      ++checked;
+    }
+    if (rate &&
+	!fsck_thread.sleep_until(
+	  start + ceph::make_timespan((double)checked / rate))) {
+      dout(10) << __func__ << " interrupted" << dendl;
+      return errors;
+    }
+  }
+  logger->inc(l_bluestore_fsck_incremental_passes);
+  logger->inc(l_bluestore_fsck_incremental_objects, checked);
+
+  if (errors) {
+    logger->inc(l_bluestore_fsck_incremental_errors, errors);
+    derr << __func__ << " epoch " << epoch << " found " << errors
+	 << " errors in " << checked << " objects" << dendl;
+    stringstream ss;
+    ss << "incremental fsck found " << errors << " errors, "
+       << "total " << logger->get(l_bluestore_fsck_incremental_errors)
+       << "; run a full fsck";
+    _set_fsck_incremental_alert(ss.str());
+  }
+
+  // checkpoint: persist the epoch and when it completed
+  fsck_epoch = epoch;
+  KeyValueDB::Transaction t = db->get_transaction();
+  bufferlist bl;
+  encode(epoch, bl);
+  encode(ceph_clock_now(), bl);
+  encode(checked, bl);
+  encode(errors, bl);
+  t->set(PREFIX_SUPER, "fsck_epoch", bl);
+  db->submit_transaction(t);
+  dout(10) << __func__ << " epoch " << epoch << " done, " << checked
+	   << " objects in " << (mono_clock::now() - start) << dendl;
+  return errors;
+}
+
+void *BlueStore::FsckThread::entry()
+{
+  {
+    bufferlist bl;
+    if (store->db->get(PREFIX_SUPER, "fsck_epoch", &bl) >= 0) {
+      auto p = bl.cbegin();
+      decode(store->fsck_epoch, p);
+    }
+    // anything committed before the mount is left to a full fsck
+    std::lock_guard l(store->fsck_dirty_lock);
+    store->fsck_dirty.clear();
+    store->fsck_dirty_dropped = 0;
+  }
+  std::unique_lock l{lock};
+  while (!stop) {
+    double interval = store->cct->_conf->bluestore_fsck_incremental_interval;
+    // poll the option while disabled
+    cond.wait_for(l, ceph::make_timespan(interval > 0 ? interval : 5));
+    if (stop || interval <= 0) {
+      continue;
+    }
+    l.unlock();
+    store->_fsck_incremental_pass();
+    l.lock();
+  }
+  return NULL;
+}
+
 /// methods to inject various errors fsck can repair
 void BlueStore::inject_broken_shared_blob_key(const string& key,
 				  const bufferlist& bl)
@@ -10686,6 +11111,11 @@ void BlueStore::_update_logger()
   logger->set(l_bluestore_blobs, num_blobs);
   logger->set(l_bluestore_buffers, num_buffers);
   logger->set(l_bluestore_buffer_bytes, num_buffer_bytes);
+  if (bdev) {
+    logger->set(l_bluestore_write_realigned_ops, bdev->get_realigned_writes());
+    logger->set(l_bluestore_write_realigned_bytes,
+		bdev->get_realigned_write_bytes());
+  }
 }
 
 // ---------------
@@ -10824,6 +11254,8 @@ int BlueStore::read(
     r = _do_read(c, o, offset, length, bl, op_flags);
     if (r == -EIO) {
       logger->inc(l_bluestore_read_eio);
+    } else if (r > 0) {
+      _do_readahead(c, o, offset, r, op_flags);
     }
   }
 
@@ -11225,6 +11657,60 @@ int BlueStore::_do_read(
   return r;
 }
 
+void BlueStore::_do_readahead(
+  Collection *c,
+  OnodeRef& o,
+  uint64_t offset,
+  size_t length,
+  uint32_t op_flags)
+{
+  uint64_t max_bytes = _use_rotational_settings() ?
+    cct->_conf->bluestore_readahead_max_bytes_hdd :
+    cct->_conf->bluestore_readahead_max_bytes_ssd;
+  if (max_bytes == 0 ||
+      (op_flags & (CEPH_OSD_OP_FLAG_FADVISE_DONTNEED |
+		   CEPH_OSD_OP_FLAG_FADVISE_NOCACHE |
+		   CEPH_OSD_OP_FLAG_BYPASS_CLEAN_CACHE))) {
+    return;
+  }
+  // never let one stream claim more than a small slice of what the
+  // cache shard is currently given, so prefetched data cannot wash out
+  // the rest of it when the cache is under pressure
+  max_bytes = std::min<uint64_t>(max_bytes, c->cache->max / 16);
+  uint64_t min_bytes = std::min<uint64_t>(
+    cct->_conf->bluestore_readahead_min_bytes, max_bytes);
+  if (max_bytes < block_size) {
+    return;
+  }
+
+  Readahead::extent_t ra;
+  {
+    std::lock_guard l(c->readahead_lock);
+    if (!c->readahead || c->readahead_oid != o->oid) {
+      c->readahead = std::make_unique<Readahead>();
+      c->readahead->set_trigger_requests(
+	cct->_conf->bluestore_readahead_trigger_requests);
+      c->readahead->set_alignments({min_alloc_size});
+      c->readahead_oid = o->oid;
+    }
+    c->readahead->set_min_readahead_size(min_bytes);
+    c->readahead->set_max_readahead_size(max_bytes);
+    ra = c->readahead->update(offset, length, o->onode.size);
+  }
+  if (ra.second == 0) {
+    return;
+  }
+  dout(20) << __func__ << " " << o->oid << " prefetch 0x" << std::hex
+	   << ra.first << "~" << ra.second << std::dec << dendl;
+  bufferlist bl;
+  int r = _do_read(c, o, ra.first, ra.second, bl,
+		   CEPH_OSD_OP_FLAG_FADVISE_WILLNEED);
+  if (r > 0) {
+    logger->inc(l_bluestore_readahead_count);
+    logger->inc(l_bluestore_readahead_bytes, r);
+  }
+}
+
 int BlueStore::_verify_csum(OnodeRef& o,
 			    const bluestore_blob_t* blob, uint64_t blob_xoffset,
 			    const bufferlist& bl,
@@ -12101,15 +12587,22 @@ int BlueStore::omap_get_values(
     const string& prefix = o->get_omap_prefix();
     o->get_omap_key(string(), &final_key);
     size_t base_key_len = final_key.size();
-    for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p) {
+    // look all keys up in one batch; the omap prefix keeps them in the
+    // same order as the user keys
+    set<string> final_keys;
+    for (auto& k : keys) {
       final_key.resize(base_key_len); // keep prefix
-      final_key += *p;
-      bufferlist val;
-      if (db->get(prefix, final_key, &val) >= 0) {
-	dout(30) << __func__ << "  got " << pretty_binary_string(final_key)
-		 << " -> " << *p << dendl;
-	out->insert(make_pair(*p, val));
-      }
+      final_key += k;
+      final_keys.emplace_hint(final_keys.end(), final_key);
+    }
+    map<string, bufferlist> vals;
+    db->get(prefix, final_keys, &vals);
+    for (auto& [k, v] : vals) {
+      ceph_assert(k.size() >= base_key_len);
+      string user_key = k.substr(base_key_len);
+      dout(30) << __func__ << "  got " << pretty_binary_string(k)
+	       << " -> " << user_key << dendl;
+      out->emplace_hint(out->end(), std::move(user_key), std::move(v));
     }
   }
  out:
@@ -13203,6 +13696,14 @@ void BlueStore::_kv_start()
   finisher.start();
   kv_sync_thread.create("bstore_kv_sync");
   kv_finalize_thread.create("bstore_kv_final");
+  auto lanes = cct->_conf.get_val<uint64_t>("bluestore_kv_sync_lanes");
+  if (lanes > 1) {
+    dout(10) << __func__ << " starting " << lanes << " kv sync lanes" << dendl;
+    for (uint64_t i = 0; i < lanes; ++i) {
+      kv_sync_lanes.emplace_back(std::make_unique<KVSyncLane>(this));
+      kv_sync_lanes.back()->create("bstore_kv_lane");
+    }
+  }
 }
 
 void BlueStore::_kv_stop()
@@ -13226,6 +13727,18 @@ void BlueStore::_kv_stop()
   }
   kv_sync_thread.join();
   kv_finalize_thread.join();
+  if (!kv_sync_lanes.empty()) {
+    {
+      std::lock_guard l(kv_lanes_lock);
+      kv_lanes_stop = true;
+      kv_lanes_cond.notify_all();
+    }
+    for (auto& lane : kv_sync_lanes) {
+      lane->join();
+    }
+    kv_sync_lanes.clear();
+    kv_lanes_stop = false;
+  }
   ceph_assert(removed_collections.empty());
   {
     std::lock_guard l(kv_lock);
@@ -13355,9 +13868,14 @@ void BlueStore::_kv_sync_thread()
       // it.  in either case, we increase the max in the earlier txn
       // we submit.
       uint64_t new_nid_max = 0, new_blobid_max = 0;
+      // with kv sync lanes the front txc is not necessarily submitted
+      // first, so bump the max values through a txn of their own.
+      KeyValueDB::Transaction maxt =
+	kv_submitting.empty() ? synct :
+	kv_sync_lanes.empty() ? kv_submitting.front()->t :
+	db->get_transaction();
       if (nid_last + cct->_conf->bluestore_nid_prealloc/2 > nid_max) {
-	KeyValueDB::Transaction t =
-	  kv_submitting.empty() ? synct : kv_submitting.front()->t;
+	KeyValueDB::Transaction t = maxt;
 	new_nid_max = nid_last + cct->_conf->bluestore_nid_prealloc;
 	bufferlist bl;
 	encode(new_nid_max, bl);
@@ -13365,8 +13883,7 @@ void BlueStore::_kv_sync_thread()
 	dout(10) << __func__ << " new_nid_max " << new_nid_max << dendl;
       }
       if (blobid_last + cct->_conf->bluestore_blobid_prealloc/2 > blobid_max) {
-	KeyValueDB::Transaction t =
-	  kv_submitting.empty() ? synct : kv_submitting.front()->t;
+	KeyValueDB::Transaction t = maxt;
 	new_blobid_max = blobid_last + cct->_conf->bluestore_blobid_prealloc;
 	bufferlist bl;
 	encode(new_blobid_max, bl);
@@ -13374,18 +13891,20 @@ void BlueStore::_kv_sync_thread()
 	dout(10) << __func__ << " new_blobid_max " << new_blobid_max << dendl;
       }
 
-      for (auto txc : kv_committing) {
-	throttle.log_state_latency(*txc, logger, l_bluestore_state_kv_queued_lat);
-	if (txc->get_state() == TransContext::STATE_KV_QUEUED) {
-	  ++kv_submitted;
-	  _txc_apply_kv(txc, false);
-	  --txc->osr->kv_committing_serially;
-	} else {
-	  ceph_assert(txc->get_state() == TransContext::STATE_KV_SUBMITTED);
+      if (kv_sync_lanes.empty()) {
+	for (auto txc : kv_committing) {
+	  if (_kv_sync_apply_txc(txc)) {
+	    ++kv_submitted;
+	  }
 	}
-	if (txc->had_ios) {
-	  --txc->osr->txc_with_unstable_io;
+      } else {
+	if (maxt != synct && (new_nid_max || new_blobid_max)) {
+	  int r = cct->_conf->bluestore_debug_omit_kv_commit ? 0 :
+	    db->submit_transaction(maxt);
+	  ceph_assert(r == 0);
 	}
+	kv_submitted += kv_submitting.size();
+	_kv_sync_lanes_apply(kv_committing);
       }
 
       // release throttle *before* we commit.  this allows new ops
@@ -13414,6 +13933,10 @@ void BlueStore::_kv_sync_thread()
       int r = cct->_conf->bluestore_debug_omit_kv_commit ? 0 : db->submit_transaction_sync(synct);
       ceph_assert(r == 0);
 
+      if (cct->_conf->bluestore_fsck_incremental_interval > 0) {
+	_fsck_note_committed(kv_committing);
+      }
+
 #ifdef WITH_BLKIN
       for (auto txc : kv_committing) {
         if (txc->trace) {
@@ -13512,6 +14035,69 @@ void BlueStore::_kv_sync_thread()
   kv_sync_started = false;
 }
 
+bool BlueStore::_kv_sync_apply_txc(TransContext *txc)
+{
+  bool submitted = false;
+  throttle.log_state_latency(*txc, logger, l_bluestore_state_kv_queued_lat);
+  if (txc->get_state() == TransContext::STATE_KV_QUEUED) {
+    _txc_apply_kv(txc, false);
+    --txc->osr->kv_committing_serially;
+    submitted = true;
+  } else {
+    ceph_assert(txc->get_state() == TransContext::STATE_KV_SUBMITTED);
+  }
+  if (txc->had_ios) {
+    --txc->osr->txc_with_unstable_io;
+  }
+  return submitted;
+}
+
+void BlueStore::_kv_sync_lanes_apply(const deque<TransContext*>& committing)
+{
+  // an OpSequencer always maps to the same lane, which keeps the order of
+  // its txcs; different sequencers are submitted concurrently.
+  std::unique_lock l{kv_lanes_lock};
+  ceph_assert(kv_lanes_pending == 0);
+  for (auto txc : committing) {
+    auto& lane = kv_sync_lanes[txc->osr->get_sequencer_id() %
+			       kv_sync_lanes.size()];
+    if (lane->q.empty()) {
+      ++kv_lanes_pending;
+    }
+    lane->q.push_back(txc);
+  }
+  dout(20) << __func__ << " " << committing.size() << " txcs on "
+	   << kv_lanes_pending << " lanes" << dendl;
+  kv_lanes_cond.notify_all();
+  kv_lanes_done_cond.wait(l, [this] { return kv_lanes_pending == 0; });
+}
+
+void BlueStore::_kv_sync_lane_thread(KVSyncLane *lane)
+{
+  dout(10) << __func__ << " start" << dendl;
+  std::unique_lock l{kv_lanes_lock};
+  while (true) {
+    if (lane->q.empty()) {
+      if (kv_lanes_stop)
+	break;
+      kv_lanes_cond.wait(l);
+      continue;
+    }
+    deque<TransContext*> q;
+    q.swap(lane->q);
+    l.unlock();
+    for (auto txc : q) {
+      _kv_sync_apply_txc(txc);
+    }
+    l.lock();
+    ceph_assert(kv_lanes_pending > 0);
+    if (--kv_lanes_pending == 0) {
+      kv_lanes_done_cond.notify_all();
+    }
+  }
+  dout(10) << __func__ << " finish" << dendl;
+}
+
 void BlueStore::_kv_finalize_thread()
 {
   deque<TransContext*> kv_committed;
@@ -13541,6 +14127,10 @@ void BlueStore::_kv_finalize_thread()
 
       auto start = mono_clock::now();
 
+      // anything submitted while finalizing this cycle (deferred batches
+      // of all sequencers, mostly) goes to the device in one go
+      bdev->aio_submit_plug();
+
       while (!kv_committed.empty()) {
 	TransContext *txc = kv_committed.front();
 	ceph_assert(txc->get_state() == TransContext::STATE_KV_SUBMITTED);
@@ -13566,6 +14156,11 @@ void BlueStore::_kv_finalize_thread()
 	}
       }
 
+      bdev->aio_submit_unplug();
+      if (cct->_conf.get_val<bool>("bluestore_kv_finalize_reap_aio")) {
+	bdev->aio_reap();
+      }
+
       // this is as good a place as any ...
       _reap_collections();
 
@@ -13767,6 +14362,7 @@ void BlueStore::_clean_some(ghobject_t oid, uint32_t zone)
 	   << std::dec << dendl;
   OpSequencer *osr = c->osr.get();
   TransContext *txc = _txc_create(c, osr, nullptr);
+  txc->zoned_cleaning = true;
 
   spg_t pgid;
   if (c->cid.is_pg(&pgid)) {
@@ -13860,6 +14456,33 @@ void BlueStore::deferred_try_submit()
     }
   }
 
+  if (cct->_conf->bluestore_deferred_submit_lba_order && osrs.size() > 1) {
+    // issue the batches of all sequencers as one ascending sweep over the
+    // device instead of in queue order; the key is only a hint since a
+    // pending batch may still grow until we submit it
+    vector<pair<uint64_t, OpSequencerRef>> sorted;
+    sorted.reserve(osrs.size());
+    for (auto& osr : osrs) {
+      uint64_t first = std::numeric_limits<uint64_t>::max();
+      osr->deferred_lock.lock();
+      if (osr->deferred_pending && !osr->deferred_pending->iomap.empty()) {
+	first = osr->deferred_pending->iomap.begin()->first;
+      }
+      osr->deferred_lock.unlock();
+      sorted.emplace_back(first, std::move(osr));
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+		     [](const auto& a, const auto& b) {
+		       return a.first < b.first;
+		     });
+    for (size_t i = 0; i < sorted.size(); ++i) {
+      osrs[i] = std::move(sorted[i].second);
+    }
+  }
+
+  // stage all batches and hand them to the device in one go, giving the
+  // block layer a chance to merge adjacent extents of different sequencers
+  bdev->aio_submit_plug();
   for (auto& osr : osrs) {
     osr->deferred_lock.lock();
     if (osr->deferred_pending) {
@@ -13875,6 +14498,7 @@ void BlueStore::deferred_try_submit()
       dout(20) << __func__ << "  osr " << osr << " has no pending" << dendl;
     }
   }
+  bdev->aio_submit_unplug();
 
   {
     std::lock_guard l(deferred_lock);
@@ -14267,6 +14891,47 @@ void BlueStore::_txc_aio_submit(TransContext *txc)
   bdev->aio_submit(&txc->ioc);
 }
 
+void BlueStore::_txc_preload_onodes(Transaction *t,
+				    const vector<CollectionRef>& cvec)
+{
+  // group the objects by the collection of the first op touching them;
+  // creates are skipped as there is nothing to load for those
+  map<Collection*, vector<ghobject_t>> by_coll;
+  vector<bool> seen;
+  Transaction::iterator i = t->begin();
+  seen.resize(i.objects.size());
+  while (i.have_op()) {
+    Transaction::Op *op = i.decode_op();
+    switch (op->op) {
+    case Transaction::OP_NOP:
+    case Transaction::OP_CREATE:
+    case Transaction::OP_RMCOLL:
+    case Transaction::OP_MKCOLL:
+    case Transaction::OP_SPLIT_COLLECTION:
+    case Transaction::OP_SPLIT_COLLECTION2:
+    case Transaction::OP_MERGE_COLLECTION:
+    case Transaction::OP_COLL_HINT:
+    case Transaction::OP_COLL_SETATTR:
+    case Transaction::OP_COLL_RMATTR:
+    case Transaction::OP_COLL_RENAME:
+      continue;
+    }
+    if (op->oid >= seen.size() || seen[op->oid] ||
+	op->cid >= cvec.size() || !cvec[op->cid]) {
+      continue;
+    }
+    seen[op->oid] = true;
+    by_coll[cvec[op->cid].get()].push_back(i.get_oid(op->oid));
+  }
+  for (auto& [c, oids] : by_coll) {
+    if (oids.size() < 2) {
+      continue;
+    }
+    std::unique_lock l(c->lock);
+    c->preload_onodes(oids);
+  }
+}
+
 void BlueStore::_txc_add_transaction(TransContext *txc, Transaction *t)
 {
   Transaction::iterator i = t->begin();
@@ -14282,6 +14947,12 @@ void BlueStore::_txc_add_transaction(TransContext *txc, Transaction *t)
   
   vector<OnodeRef> ovec(i.objects.size());
 
+  // the usual object + pgmeta pair never has two onodes to fetch, the
+  // pgmeta one is always hot
+  if (i.objects.size() > 2 && cct->_conf->bluestore_txc_preload_onodes) {
+    _txc_preload_onodes(t, cvec);
+  }
+
   for (int pos = 0; i.have_op(); ++pos) {
     Transaction::Op *op = i.decode_op();
     int r = 0;
@@ -14695,7 +15366,9 @@ void BlueStore::_pad_zeros(
     ceph_assert(back_pad == 0);
     back_pad = chunk_size - back_copy;
     ceph_assert(back_copy <= length);
-    bufferptr tail(chunk_size);
+    // page aligned like the front pad, so that the device doesn't have
+    // to copy it again for O_DIRECT
+    bufferptr tail = ceph::buffer::create_small_page_aligned(chunk_size);
     bl->begin(length - back_copy).copy(back_copy, tail.c_str());
     tail.zero(back_copy, back_pad, false);
     bufferlist old;
@@ -15551,18 +16224,44 @@ int BlueStore::_do_alloc_write(
   // and the condition is : (data_size < deferred).
 
   auto max_bsize = std::max(wctx->target_blob_size, min_alloc_size);
+
+  // compress all blobs in one go, so that an accelerator can have all of
+  // them in flight at once
+  std::vector<Compressor::compress_job_t> comp_jobs;
+  if (c) {
+    for (auto& wi : wctx->writes) {
+      if (wi.blob_length > min_alloc_size) {
+	ceph_assert(wi.b_off == 0);
+	ceph_assert(wi.blob_length == wi.bl.length());
+	comp_jobs.emplace_back();
+	comp_jobs.back().in = &wi.bl;
+      }
+    }
+  }
+  if (!comp_jobs.empty()) {
+    auto start = mono_clock::now();
+    // FIXME: memory alignment here is bad
+    c->compress_batch(comp_jobs);
+    log_latency("compress_batch@_do_alloc_write",
+      l_bluestore_compress_batch_lat,
+      mono_clock::now() - start,
+      cct->_conf->bluestore_log_op_age );
+  }
+  auto comp_job = comp_jobs.begin();
+  unsigned comp_attempts = 0;
+  unsigned comp_rejected = 0;
   for (auto& wi : wctx->writes) {
     if (c && wi.blob_length > min_alloc_size) {
-      auto start = mono_clock::now();
-
-      // compress
-      ceph_assert(wi.b_off == 0);
-      ceph_assert(wi.blob_length == wi.bl.length());
-
-      // FIXME: memory alignment here is bad
-      bufferlist t;
-      std::optional<int32_t> compressor_message;
-      int r = c->compress(wi.bl, t, compressor_message);
+      ++comp_attempts;
+      ceph_assert(comp_job != comp_jobs.end());
+      auto& job = *comp_job++;
+      log_latency("compress@_do_alloc_write",
+	l_bluestore_compress_lat,
+	job.lat,
+	cct->_conf->bluestore_log_op_age );
+      bufferlist& t = job.out;
+      std::optional<int32_t>& compressor_message = job.compressor_message;
+      int r = job.r;
       uint64_t want_len_raw = wi.blob_length * crr;
       uint64_t want_len = p2roundup(want_len_raw, min_alloc_size);
       bool rejected = false;
@@ -15608,6 +16307,7 @@ int BlueStore::_do_alloc_write(
 		 << ", leaving uncompressed"
 		 << dendl;
 	logger->inc(l_bluestore_compress_rejected_count);
+	++comp_rejected;
 	need += wi.blob_length;
 	data_size += wi.bl.length();
       } else {
@@ -15623,24 +16323,31 @@ int BlueStore::_do_alloc_write(
 		 << ", leaving uncompressed"
 		 << std::dec << dendl;
 	logger->inc(l_bluestore_compress_rejected_count);
+	++comp_rejected;
 	need += wi.blob_length;
 	data_size += wi.bl.length();
       }
-      log_latency("compress@_do_alloc_write",
-	l_bluestore_compress_lat,
-        mono_clock::now() - start,
-	cct->_conf->bluestore_log_op_age );
     } else {
       need += wi.blob_length;
       data_size += wi.bl.length();
     }
   }
+  if (comp_attempts) {
+    _note_compression_result(coll.get(), comp_attempts, comp_rejected);
+  }
   PExtentVector prealloc;
   prealloc.reserve(2 * wctx->writes.size());
   int64_t prealloc_left = 0;
+  int64_t alloc_hint = 0;
+#ifdef HAVE_LIBZBD
+  if (bdev->is_smr() && wctx->cold &&
+      cct->_conf->bluestore_zoned_hot_cold_separation) {
+    alloc_hint = ZonedAllocator::HINT_COLD;
+  }
+#endif
   prealloc_left = alloc->allocate(
     need, min_alloc_size, need,
-    0, &prealloc);
+    alloc_hint, &prealloc);
   if (prealloc_left < 0 || prealloc_left < (int64_t)need) {
     derr << __func__ << " failed to allocate 0x" << std::hex << need
          << " allocated 0x " << (prealloc_left < 0 ? 0 : prealloc_left)
@@ -16010,6 +16717,17 @@ void BlueStore::_choose_write_options(
      (cm == Compressor::COMP_PASSIVE &&
       (alloc_hints & CEPH_OSD_ALLOC_HINT_FLAG_COMPRESSIBLE)));
 
+  // don't keep paying for compression attempts on a stream of data that
+  // does not compress; forced compression is left alone
+  if (wctx->compress && cm != Compressor::COMP_FORCE &&
+      c->comp_skip_writes > 0) {
+    --c->comp_skip_writes;
+    wctx->compress = false;
+    logger->inc(l_bluestore_compress_skipped_count);
+    dout(20) << __func__ << " backing off compression, "
+	     << c->comp_skip_writes << " writes to go" << dendl;
+  }
+
   if ((alloc_hints & CEPH_OSD_ALLOC_HINT_FLAG_SEQUENTIAL_READ) &&
       (alloc_hints & CEPH_OSD_ALLOC_HINT_FLAG_RANDOM_READ) == 0 &&
       (alloc_hints & (CEPH_OSD_ALLOC_HINT_FLAG_IMMUTABLE |
@@ -16074,6 +16792,31 @@ void BlueStore::_choose_write_options(
            << std::dec << dendl;
 }
 
+void BlueStore::_note_compression_result(
+  Collection *c,
+  unsigned attempts,
+  unsigned rejected)
+{
+  uint32_t threshold = cct->_conf->bluestore_compression_backoff_threshold;
+  if (threshold == 0 || rejected < attempts) {
+    c->comp_rejected_writes = 0;
+    c->comp_backoff = 0;
+    return;
+  }
+  // after a back-off a single rejected probe is enough to back off again
+  if (++c->comp_rejected_writes < threshold && c->comp_backoff == 0) {
+    return;
+  }
+  // back off exponentially while the data keeps refusing to compress
+  uint32_t backoff_max = cct->_conf->bluestore_compression_backoff_max;
+  c->comp_backoff = std::min(
+    c->comp_backoff ? c->comp_backoff * 2 : threshold, backoff_max);
+  c->comp_skip_writes = c->comp_backoff;
+  c->comp_rejected_writes = 0;
+  dout(10) << __func__ << " " << c->cid << " data does not compress,"
+	   << " skipping the next " << c->comp_backoff << " writes" << dendl;
+}
+
 int BlueStore::_do_gc(
   TransContext *txc,
   CollectionRef& c,
@@ -16167,6 +16910,16 @@ int BlueStore::_do_write(
 
   WriteContext wctx;
   _choose_write_options(c, o, fadvise_flags, &wctx);
+#ifdef HAVE_LIBZBD
+  // data that survived a zone cleaning, or that the client says will
+  // stay, goes to the cold zones; everything else is considered hot
+  wctx.cold = txc->zoned_cleaning ||
+    ((o->onode.alloc_hint_flags &
+      (CEPH_OSD_ALLOC_HINT_FLAG_IMMUTABLE |
+       CEPH_OSD_ALLOC_HINT_FLAG_LONGLIVED |
+       CEPH_OSD_ALLOC_HINT_FLAG_APPEND_ONLY)) &&
+     !(o->onode.alloc_hint_flags & CEPH_OSD_ALLOC_HINT_FLAG_SHORTLIVED));
+#endif
   o->extent_map.fault_range(db, offset, length);
   _do_write_data(txc, c, o, offset, length, bl, &wctx);
   r = _do_alloc_write(txc, c, o, &wctx);
@@ -17692,6 +18445,11 @@ void BlueStore::_log_alerts(osd_alert_list_t& alerts)
 {
   std::lock_guard l(qlock);
 
+  if (!fsck_incremental_alert.empty()) {
+    alerts.emplace(
+      "BLUESTORE_FSCK_INCREMENTAL_ERRORS",
+      fsck_incremental_alert);
+  }
   if (!spurious_read_errors_alert.empty() &&
       cct->_conf->bluestore_warn_on_spurious_read_errors) {
     alerts.emplace(
@@ -18673,7 +19431,7 @@ int calc_allocator_image_trailer_size()
 }
 
 //-----------------------------------------------------------------------------------
-int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes)
+int BlueStore::__restore_allocator(std::vector<extent_t>* extents, uint64_t *num, uint64_t *bytes)
 {
   if (cct->_conf->bluestore_debug_inject_allocation_from_file_failure > 0) {
      boost::mt11213b rng(time(NULL));
@@ -18737,57 +19495,62 @@ int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t
   }
 
   // then read the payload (extents list) using a recycled buffer
-  extent_t        buffer[MAX_EXTENTS_IN_BUFFER]; // 64KB
+  // every chunk of extents is followed by its crc, so read both in one go
+  struct {
+    extent_t extents[MAX_EXTENTS_IN_BUFFER]; // 64KB
+    uint32_t crc;
+  } __attribute__((packed)) chunk;
   uint32_t        crc                = -1;
   int             trailer_size       = calc_allocator_image_trailer_size();
   uint64_t        extent_count       = 0;
   uint64_t        extents_bytes_left = file_size - (header_size + trailer_size + sizeof(crc));
+  // the image is written as a sorted list, stage it in a flat array which
+  // the caller feeds to the allocator once the whole image is verified
+  extents->reserve(extents_bytes_left / sizeof(extent_t));
   while (extents_bytes_left) {
-    int req_bytes  = std::min(extents_bytes_left, static_cast<uint64_t>(sizeof(buffer)));
-    int read_bytes = bluefs->read(p_handle.get(), offset, req_bytes, nullptr, (char*)buffer);
-    if (read_bytes != req_bytes) {
-      derr << "Failed bluefs->read()::read_bytes=" << read_bytes << ", req_bytes=" << req_bytes << dendl;
+    int req_bytes  = std::min(extents_bytes_left, static_cast<uint64_t>(sizeof(chunk.extents)));
+    int read_bytes = bluefs->read(p_handle.get(), offset, req_bytes + sizeof(crc), nullptr, (char*)&chunk);
+    if (read_bytes != req_bytes + (int)sizeof(crc)) {
+      derr << "Failed bluefs->read()::read_bytes=" << read_bytes << ", req_bytes=" << req_bytes + sizeof(crc) << dendl;
       return -1;
     }
 
     offset             += read_bytes;
-    extents_bytes_left -= read_bytes;
+    extents_bytes_left -= req_bytes;
+    if (extents_bytes_left) {
+      extents_bytes_left -= sizeof(crc);
+    }
+
+    uint32_t calc_crc = ceph_crc32c(crc, (const uint8_t*)chunk.extents, req_bytes);
+    // the crc follows the extents, which may end before the buffer does
+    memcpy(&crc, (char*)chunk.extents + req_bytes, sizeof(crc));
+    crc = CEPHTOH_32(crc);
+    if (crc != calc_crc) {
+      derr << "data crc mismatch!!! crc=" << crc << ", calc_crc=" << calc_crc << dendl;
+      derr << "extents_bytes_left=" << extents_bytes_left << ", offset=" << offset << ", extent_count=" << extent_count << dendl;
+      return -1;
+    }
 
-    const unsigned  num_extent_in_buffer = read_bytes/sizeof(extent_t);
-    const extent_t *p_end                = buffer + num_extent_in_buffer;
-    for (const extent_t *p_ext = buffer; p_ext < p_end; p_ext++) {
+    const unsigned  num_extent_in_buffer = req_bytes/sizeof(extent_t);
+    const extent_t *p_end                = chunk.extents + num_extent_in_buffer;
+    for (const extent_t *p_ext = chunk.extents; p_ext < p_end; p_ext++) {
       uint64_t offset = CEPHTOH_64(p_ext->offset);
       uint64_t length = CEPHTOH_64(p_ext->length);
       read_alloc_size += length;
 
       if (length > 0) {
-	allocator->init_add_free(offset, length);
+	if (!extents->empty() &&
+	    extents->back().offset + extents->back().length == offset) {
+	  extents->back().length += length;
+	} else {
+	  extents->push_back({offset, length});
+	}
 	extent_count ++;
       } else {
 	derr << "extent with zero length at idx=" << extent_count << dendl;
 	return -1;
       }
     }
-
-    uint32_t calc_crc = ceph_crc32c(crc, (const uint8_t*)buffer, read_bytes);
-    read_bytes        = bluefs->read(p_handle.get(), offset, sizeof(crc), nullptr, (char*)&crc);
-    if (read_bytes == sizeof(crc) ) {
-      crc     = CEPHTOH_32(crc);
-      if (crc != calc_crc) {
-	derr << "data crc mismatch!!! crc=" << crc << ", calc_crc=" << calc_crc << dendl;
-	derr << "extents_bytes_left=" << extents_bytes_left << ", offset=" << offset << ", extent_count=" << extent_count << dendl;
-	return -1;
-      }
-
-      offset += read_bytes;
-      if (extents_bytes_left) {
-	extents_bytes_left -= read_bytes;
-      }
-    } else {
-      derr << "Failed bluefs->read() for crc::read_bytes=" << read_bytes << ", req_bytes=" << sizeof(crc) << dendl;
-      return -1;
-    }
-
   }
 
   // finally, read the trailer and verify it is in good shape and that we got all the extents
@@ -18833,17 +19596,20 @@ int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t
 int BlueStore::restore_allocator(Allocator* dest_allocator, uint64_t *num, uint64_t *bytes)
 {
   utime_t    start = ceph_clock_now();
-  auto temp_allocator = unique_ptr<Allocator>(create_bitmap_allocator(bdev->get_size()));
-  int ret = __restore_allocator(temp_allocator.get(), num, bytes);
+  // nothing reaches dest_allocator unless the whole image checks out, so a
+  // failed restore can still fall back to the recovery from onodes
+  std::vector<extent_t> extents;
+  int ret = __restore_allocator(&extents, num, bytes);
   if (ret != 0) {
     return ret;
   }
 
-  uint64_t num_entries = 0;
-  dout(5) << " calling copy_allocator(bitmap_allocator -> shared_alloc.a)" << dendl;
-  copy_allocator(temp_allocator.get(), dest_allocator, &num_entries);
+  dout(5) << " feeding " << extents.size() << " extents to shared_alloc.a" << dendl;
+  for (const auto& e : extents) {
+    dest_allocator->init_add_free(e.offset, e.length);
+  }
   utime_t duration = ceph_clock_now() - start;
-  dout(5) << "restored in " << duration << " seconds, num_entries=" << num_entries << dendl;
+  dout(5) << "restored in " << duration << " seconds, num_entries=" << extents.size() << dendl;
   return ret;
 }
 
@@ -46,6 +46,7 @@
 #include "common/Throttle.h"
 #include "common/perf_counters.h"
 #include "common/PriorityCache.h"
+#include "common/Readahead.h"
 #include "compressor/Compressor.h"
 #include "os/ObjectStore.h"
 
@@ -61,6 +62,7 @@ class Allocator;
 class FreelistManager;
 class BlueStoreRepairer;
 class SimpleBitmap;
+struct extent_t;
 //#define DEBUG_CACHE
 //#define DEBUG_DEFERRED
 
@@ -113,6 +115,8 @@ enum {
   l_bluestore_read_eio,
   l_bluestore_reads_with_retries,
   l_bluestore_read_lat,
+  l_bluestore_readahead_count,
+  l_bluestore_readahead_bytes,
   //****************************************
 
   // kv_thread latencies
@@ -136,6 +140,8 @@ enum {
   l_bluestore_write_small_pre_read,
 
   l_bluestore_write_pad_bytes,
+  l_bluestore_write_realigned_ops,
+  l_bluestore_write_realigned_bytes,
   l_bluestore_write_penalty_read_ops,
   l_bluestore_write_new,
 
@@ -156,9 +162,11 @@ enum {
   l_bluestore_compressed_allocated,
   l_bluestore_compressed_original,
   l_bluestore_compress_lat,
+  l_bluestore_compress_batch_lat,
   l_bluestore_decompress_lat,
   l_bluestore_compress_success_count,
   l_bluestore_compress_rejected_count,
+  l_bluestore_compress_skipped_count,
   //****************************************
 
   // onode cache stats
@@ -179,6 +187,7 @@ enum {
   l_bluestore_buffer_bytes,
   l_bluestore_buffer_hit_bytes,
   l_bluestore_buffer_miss_bytes,
+  l_bluestore_buffer_lockless_misses,
   //****************************************
 
   // internal stats
@@ -210,6 +219,13 @@ enum {
   l_bluestore_truncate_lat,
   //****************************************
 
+  // incremental fsck
+  //****************************************
+  l_bluestore_fsck_incremental_passes,
+  l_bluestore_fsck_incremental_objects,
+  l_bluestore_fsck_incremental_errors,
+  //****************************************
+
   // allocation stats
   //****************************************
   l_bluestore_allocate_hist,
@@ -367,6 +383,11 @@ public:
     // few IOs in flight to the same Blob at the same time).
     state_list_t writing;   ///< writing buffers, sorted by seq, ascending
 
+    /// buffer_map.size(), published under cache->lock on every insert and
+    /// erase.  read() checks it first so that lookups on blobs without any
+    /// cached data never touch the cache shard lock.
+    std::atomic<uint32_t> num_buffers = {0};
+
     ~BufferSpace() {
       ceph_assert(buffer_map.empty());
       ceph_assert(writing.empty());
@@ -375,6 +396,7 @@ public:
     void _add_buffer(BufferCacheShard* cache, Buffer* b, int level, Buffer* near) {
       cache->_audit("_add_buffer start");
       buffer_map[b->offset].reset(b);
+      num_buffers.store(buffer_map.size(), std::memory_order_release);
       if (b->is_writing()) {
         // we might get already cached data for which resetting mempool is inppropriate
         // hence calling try_assign_to_mempool
@@ -411,6 +433,7 @@ public:
 	cache->_rm(p->second.get());
       }
       buffer_map.erase(p);
+      num_buffers.store(buffer_map.size(), std::memory_order_release);
       cache->_audit("_rm_buffer end");
     }
 
@@ -867,6 +890,15 @@ public:
     blob_map_t spanning_blob_map;   ///< blobs that span shards
     typedef boost::intrusive_ptr<Onode> OnodeRef;
 
+    /// sorted (logical_offset, Extent) mirror of a small extent_map.  While
+    /// active, seek_lextent() bisects this flat array instead of walking
+    /// the rb-tree.  logical_offset of a linked Extent never changes, so
+    /// only insert_extent()/rm()/clear() need to keep it in sync.
+    typedef std::pair<uint32_t, Extent*> flat_extent_t;
+    mempool::bluestore_cache_meta::vector<flat_extent_t> flat_index;
+    uint32_t flat_index_max = 0;    ///< max extents to index, 0 = disabled
+    bool flat_index_active = false;
+
     struct Shard {
       bluestore_onode_t::shard_info *shard_info = nullptr;
       unsigned extents = 0;  ///< count extents in this shard
@@ -903,13 +935,16 @@ public:
       void operator()(Extent *e) { delete e; }
     };
 
-    ExtentMap(Onode *o, size_t inline_shard_prealloc_size);
+    ExtentMap(Onode *o, size_t inline_shard_prealloc_size,
+	      uint32_t flat_index_max);
     ~ExtentMap() {
       extent_map.clear_and_dispose(DeleteDisposer());
     }
 
     void clear() {
       extent_map.clear_and_dispose(DeleteDisposer());
+      flat_index.clear();
+      flat_index_active = flat_index_max > 0;
       shards.clear();
       inline_bl.clear();
       clear_needs_reshard();
@@ -1034,19 +1069,26 @@ public:
     /// for seek_lextent test
     extent_map_t::iterator find(uint64_t offset);
 
+    /// flat_index lookup behind seek_lextent(); nullptr if past the end
+    Extent *_flat_seek_lextent(uint64_t offset) const;
+
     /// seek to the first lextent including or after offset
     extent_map_t::iterator seek_lextent(uint64_t offset);
     extent_map_t::const_iterator seek_lextent(uint64_t offset) const;
 
+    /// link an Extent into extent_map (and flat_index, if active)
+    extent_map_t::iterator insert_extent(Extent *le);
+
     /// add a new Extent
     void add(uint32_t lo, uint32_t o, uint32_t l, BlobRef& b) {
-      extent_map.insert(*new Extent(lo, o, l, b));
+      insert_extent(new Extent(lo, o, l, b));
     }
 
     /// remove (and delete) an Extent
-    void rm(extent_map_t::iterator p) {
-      extent_map.erase_and_dispose(p, DeleteDisposer());
-    }
+    void rm(extent_map_t::iterator p);
+
+    /// (re)build flat_index if the map is small enough, drop it otherwise
+    void rebuild_flat_index();
 
     bool has_any_lextents(uint64_t offset, uint64_t length);
 
@@ -1216,7 +1258,9 @@ public:
         cached(false),
 	extent_map(this,
 	  c->store->cct->_conf->
-	    bluestore_extent_map_inline_shard_prealloc_size) {
+	    bluestore_extent_map_inline_shard_prealloc_size,
+	  c->store->cct->_conf->
+	    bluestore_extent_map_flat_index_max) {
     }
     Onode(Collection* c, const ghobject_t& o,
       const std::string& k)
@@ -1227,7 +1271,9 @@ public:
         cached(false),
         extent_map(this,
 	  c->store->cct->_conf->
-	    bluestore_extent_map_inline_shard_prealloc_size) {
+	    bluestore_extent_map_inline_shard_prealloc_size,
+	  c->store->cct->_conf->
+	    bluestore_extent_map_flat_index_max) {
     }
     Onode(Collection* c, const ghobject_t& o,
       const char* k)
@@ -1238,7 +1284,9 @@ public:
         cached(false),
         extent_map(this,
 	  c->store->cct->_conf->
-	    bluestore_extent_map_inline_shard_prealloc_size) {
+	    bluestore_extent_map_inline_shard_prealloc_size,
+	  c->store->cct->_conf->
+	    bluestore_extent_map_flat_index_max) {
     }
     Onode(CephContext* cct)
       : c(nullptr),
@@ -1246,7 +1294,9 @@ public:
         cached(false),
         extent_map(this,
 	  cct->_conf->
-	    bluestore_extent_map_inline_shard_prealloc_size) {
+	    bluestore_extent_map_inline_shard_prealloc_size,
+	  cct->_conf->
+	    bluestore_extent_map_flat_index_max) {
     }
     static void decode_raw(
       BlueStore::Onode* on,
@@ -1483,6 +1533,8 @@ private:
 
     OnodeRef add_onode(const ghobject_t& oid, OnodeRef& o);
     OnodeRef lookup(const ghobject_t& o);
+    /// like lookup(), minus the pin and the hit/miss accounting
+    bool contains(const ghobject_t& o);
     void rename(OnodeRef& o, const ghobject_t& old_oid,
 		const ghobject_t& new_oid,
 		const mempool::bluestore_cache_meta::string& new_okey);
@@ -1519,10 +1571,26 @@ private:
     pool_opts_t pool_opts;
     ContextQueue *commit_queue;
 
+    // compression back-off for incompressible data, under lock:
+    // writes in a row whose blobs all failed to compress, the current
+    // back-off length and the writes still to go uncompressed
+    uint32_t comp_rejected_writes = 0;
+    uint32_t comp_backoff = 0;
+    uint32_t comp_skip_writes = 0;
+
+    // sequential read detection; one stream, reset when another object
+    // is read
+    ceph::mutex readahead_lock =
+      ceph::make_mutex("BlueStore::Collection::readahead_lock");
+    ghobject_t readahead_oid;
+    std::unique_ptr<Readahead> readahead;
+
     OnodeCacheShard* get_onode_cache() const {
       return onode_space.cache;
     }
     OnodeRef get_onode(const ghobject_t& oid, bool create, bool is_createop=false);
+    /// fetch the onodes of all uncached oids with a single batched kv get
+    void preload_onodes(const std::vector<ghobject_t>& oids);
 
     // the terminology is confusing here, sorry!
     //
@@ -1777,6 +1845,7 @@ private:
     // cleaning with less metadata than a ref for every extent.
     std::map<std::pair<OnodeRef, uint32_t>, uint64_t> new_zone_offset_refs;
     std::map<std::pair<OnodeRef, uint32_t>, uint64_t> old_zone_offset_refs;
+    bool zoned_cleaning = false;  ///< relocating live data for the zone cleaner
 #endif
     
     std::set<SharedBlobRef> shared_blobs;  ///< these need to be updated/written
@@ -2164,6 +2233,17 @@ private:
       return NULL;
     }
   };
+  /// submits the kv transactions of the OpSequencers it owns, see
+  /// bluestore_kv_sync_lanes
+  struct KVSyncLane : public Thread {
+    BlueStore *store;
+    std::deque<TransContext*> q;  ///< protected by kv_lanes_lock
+    explicit KVSyncLane(BlueStore *s) : store(s) {}
+    void *entry() override {
+      store->_kv_sync_lane_thread(this);
+      return NULL;
+    }
+  };
 
 #ifdef HAVE_LIBZBD
   struct ZonedCleanerThread : public Thread {
@@ -2272,6 +2352,13 @@ private:
   std::deque<DeferredBatch*> deferred_stable_to_finalize; ///< pending finalization
   bool kv_finalize_in_progress = false;
 
+  std::vector<std::unique_ptr<KVSyncLane>> kv_sync_lanes; ///< empty unless lanes > 1
+  ceph::mutex kv_lanes_lock = ceph::make_mutex("BlueStore::kv_lanes_lock");
+  ceph::condition_variable kv_lanes_cond;       ///< work for lanes
+  ceph::condition_variable kv_lanes_done_cond;  ///< kv_lanes_pending drained
+  unsigned kv_lanes_pending = 0;  ///< lanes with work in the current cycle
+  bool kv_lanes_stop = false;
+
 #ifdef HAVE_LIBZBD
   ZonedCleanerThread zoned_cleaner_thread;
   ceph::mutex zoned_cleaner_lock = ceph::make_mutex("BlueStore::zoned_cleaner_lock");
@@ -2536,6 +2623,13 @@ private:
       double get_bytes_per_onode() const {
         return (double)_get_used_bytes() / (double)_get_num_onodes();
       }
+      virtual bool get_miss_stats(uint64_t *misses, uint64_t *bytes_per_miss,
+                                  uint64_t *resident_bytes) const {
+        *misses = store->logger->get(l_bluestore_onode_misses);
+        *bytes_per_miss = get_bytes_per_onode();
+        *resident_bytes = _get_used_bytes();
+        return true;
+      }
     };
     std::shared_ptr<MetaCache> meta_cache;
 
@@ -2572,6 +2666,13 @@ private:
       virtual std::string get_cache_name() const {
         return "BlueStore Data Cache";
       }
+      virtual bool get_miss_stats(uint64_t *misses, uint64_t *bytes_per_miss,
+                                  uint64_t *resident_bytes) const {
+        *misses = store->logger->get(l_bluestore_buffer_miss_bytes);
+        *bytes_per_miss = 1;
+        *resident_bytes = _get_used_bytes();
+        return true;
+      }
     };
     std::shared_ptr<DataCache> data_cache;
 
@@ -2599,6 +2700,43 @@ private:
     void _resize_shards(bool interval_stats);
   } mempool_thread;
 
+  // background incremental fsck: objects committed since the last pass
+  // are rechecked every bluestore_fsck_incremental_interval seconds
+  struct FsckThread : public Thread {
+    BlueStore *store;
+
+    ceph::condition_variable cond;
+    ceph::mutex lock = ceph::make_mutex("BlueStore::FsckThread::lock");
+    bool stop = false;
+
+    explicit FsckThread(BlueStore *s) : store(s) {}
+    void *entry() override;
+    void init() {
+      stop = false;
+      create("bstore_fsck");
+    }
+    void shutdown() {
+      lock.lock();
+      stop = true;
+      cond.notify_all();
+      lock.unlock();
+      join();
+    }
+    /// sleep until t; false if we are stopping
+    bool sleep_until(ceph::mono_clock::time_point t) {
+      std::unique_lock l{lock};
+      return !cond.wait_until(l, t, [this] { return stop; });
+    }
+  } fsck_thread;
+
+  ceph::mutex fsck_dirty_lock = ceph::make_mutex("BlueStore::fsck_dirty_lock");
+  /// objects committed since the last incremental pass
+  mempool::bluestore_fsck::map<ghobject_t, coll_t> fsck_dirty;
+  /// commits not tracked because fsck_dirty was full
+  uint64_t fsck_dirty_dropped = 0;
+  /// last completed incremental pass, persisted as super key fsck_epoch
+  uint64_t fsck_epoch = 0;
+
 #ifdef WITH_BLKIN
   ZTracer::Endpoint trace_endpoint {"0.0.0.0", 0, "BlueStore"};
 #endif
@@ -2716,6 +2854,8 @@ private:
 			    TrackedOpRef osd_op=TrackedOpRef());
   void _txc_update_store_statfs(TransContext *txc);
   void _txc_add_transaction(TransContext *txc, Transaction *t);
+  void _txc_preload_onodes(Transaction *t,
+			   const std::vector<CollectionRef>& cvec);
   void _txc_calc_cost(TransContext *txc);
   void _txc_write_nodes(TransContext *txc, KeyValueDB::Transaction t);
   void _txc_state_proc(TransContext *txc);
@@ -2741,6 +2881,9 @@ private:
   void _kv_start();
   void _kv_stop();
   void _kv_sync_thread();
+  bool _kv_sync_apply_txc(TransContext *txc);
+  void _kv_sync_lanes_apply(const std::deque<TransContext*>& committing);
+  void _kv_sync_lane_thread(KVSyncLane *lane);
   void _kv_finalize_thread();
 
 #ifdef HAVE_LIBZBD
@@ -2805,6 +2948,13 @@ private:
   int _fsck(FSCKDepth depth, bool repair);
   int _fsck_on_open(BlueStore::FSCKDepth depth, bool repair);
 
+  /// remember the objects of committed txcs for the next incremental pass
+  void _fsck_note_committed(const std::deque<TransContext*>& txcs);
+  /// recheck the objects changed since the last pass; returns errors found
+  int64_t _fsck_incremental_pass();
+  /// check the on-disk onode of a live object; returns errors found
+  int64_t _fsck_check_onode_online(CollectionRef& c, const ghobject_t& oid);
+
   void _buffer_cache_write(
     TransContext *txc,
     BlobRef b,
@@ -3092,6 +3242,14 @@ private:
     uint32_t op_flags = 0,
     uint64_t retry_count = 0);
 
+  /// prefetch into the buffer cache if c sees a sequential read stream
+  void _do_readahead(
+    Collection *c,
+    OnodeRef& o,
+    uint64_t offset,
+    size_t len,
+    uint32_t op_flags);
+
   int _do_readv(
     Collection *c,
     OnodeRef& o,
@@ -3343,6 +3501,7 @@ private:
   std::string no_per_pg_omap_alert;
   std::string disk_size_mismatch_alert;
   std::string spurious_read_errors_alert;
+  std::string fsck_incremental_alert;
 
   void _log_alerts(osd_alert_list_t& alerts);
   bool _set_compression_alert(bool cmode, const char* s) {
@@ -3379,6 +3538,10 @@ private:
     std::lock_guard l(qlock);
     spurious_read_errors_alert = s;
   }
+  void _set_fsck_incremental_alert(const std::string& s) {
+    std::lock_guard l(qlock);
+    fsck_incremental_alert = s;
+  }
 
 private:
 
@@ -3401,6 +3564,7 @@ private:
     bool compress = false;          ///< compressed write
     uint64_t target_blob_size = 0;  ///< target (max) blob size
     unsigned csum_order = 0;        ///< target checksum chunk order
+    bool cold = false;              ///< data expected to stay (zoned placement)
 
     old_extent_map_t old_extents;   ///< must deref these blobs
     interval_set<uint64_t> extents_to_gc; ///< extents for garbage collection
@@ -3450,6 +3614,7 @@ private:
       compress = other.compress;
       target_blob_size = other.target_blob_size;
       csum_order = other.csum_order;
+      cold = other.cold;
     }
     void write(
       uint64_t loffs,
@@ -3524,6 +3689,8 @@ private:
                              OnodeRef& o,
                              uint32_t fadvise_flags,
                              WriteContext *wctx);
+  void _note_compression_result(Collection *c, unsigned attempts,
+				unsigned rejected);
 
   int _do_gc(TransContext *txc,
              CollectionRef& c,
@@ -3828,7 +3995,7 @@ private:
   int  copy_allocator(Allocator* src_alloc, Allocator *dest_alloc, uint64_t* p_num_entries);
   int  store_allocator(Allocator* allocator);
   int  invalidate_allocation_file_on_bluefs();
-  int  __restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes);
+  int  __restore_allocator(std::vector<extent_t>* extents, uint64_t *num, uint64_t *bytes);
   int  restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes);
   int  read_allocation_from_drive_on_startup();
   int  reconstruct_allocations(SimpleBitmap *smbmp, read_alloc_stats_t &stats);
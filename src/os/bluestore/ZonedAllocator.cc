@@ -34,7 +34,8 @@ ZonedAllocator::ZonedAllocator(CephContext* cct,
       zone_size(_zone_size),
       first_seq_zone_num(_first_sequential_zone),
       starting_zone_num(first_seq_zone_num),
-      num_zones(size / zone_size)
+      num_zones(size / zone_size),
+      cold_zone_num(first_seq_zone_num)
 {
   ldout(cct, 10) << " size 0x" << std::hex << size
 		 << ", zone size 0x" << zone_size << std::dec
@@ -46,6 +47,8 @@ ZonedAllocator::ZonedAllocator(CephContext* cct,
   ceph_assert(size % zone_size == 0);
 
   zone_states.resize(num_zones);
+  zone_temps.resize(num_zones, TEMP_NONE);
+  zone_last_write.resize(num_zones, ceph::mono_clock::now());
 }
 
 ZonedAllocator::~ZonedAllocator()
@@ -63,33 +66,22 @@ int64_t ZonedAllocator::allocate(
 
   ceph_assert(want_size % 4096 == 0);
 
+  uint8_t temp = hint == HINT_COLD ? TEMP_COLD : TEMP_HOT;
+  uint64_t& cursor = temp == TEMP_COLD ? cold_zone_num : starting_zone_num;
   ldout(cct, 10) << " trying to allocate 0x"
-		 << std::hex << want_size << std::dec << dendl;
+		 << std::hex << want_size << std::dec
+		 << (temp == TEMP_COLD ? " cold" : " hot") << dendl;
 
-  uint64_t left = num_zones - first_seq_zone_num;
-  uint64_t zone_num = starting_zone_num;
-  for ( ; left > 0; ++zone_num, --left) {
-    if (zone_num == num_zones) {
-      zone_num = first_seq_zone_num;
+  // first look for room among the zones of our own temperature, and
+  // only mix with the other stream when nothing else is left
+  uint64_t zone_num = num_zones;
+  for (bool mix : {false, true}) {
+    zone_num = find_zone(want_size, cursor, temp, mix);
+    if (zone_num < num_zones) {
+      break;
     }
-    if (zone_num == cleaning_zone) {
-      ldout(cct, 10) << " skipping zone 0x" << std::hex << zone_num
-		     << " because we are cleaning it" << std::dec << dendl;
-      continue;
-    }
-    if (!fits(want_size, zone_num)) {
-      ldout(cct, 10) << " skipping zone 0x" << std::hex << zone_num
-		     << " because there is not enough space: "
-		     << " want_size = 0x" << want_size
-		     << " available = 0x" << get_remaining_space(zone_num)
-		     << std::dec
-		     << dendl;
-      continue;
-    }
-    break;
   }
-
-  if (left == 0) {
+  if (zone_num == num_zones) {
     ldout(cct, 10) << " failed to allocate" << dendl;
     return -ENOSPC;
   }
@@ -103,8 +95,12 @@ int64_t ZonedAllocator::allocate(
 
   increment_write_pointer(zone_num, want_size);
   num_sequential_free -= want_size;
+  zone_temps[zone_num] = temp;
+  zone_last_write[zone_num] = ceph::mono_clock::now();
   if (get_remaining_space(zone_num) == 0) {
-    starting_zone_num = zone_num + 1;
+    cursor = zone_num + 1;
+  } else {
+    cursor = zone_num;
   }
 
   ldout(cct, 10) << " allocated 0x" << std::hex << offset << "~" << want_size
@@ -116,6 +112,43 @@ int64_t ZonedAllocator::allocate(
   return want_size;
 }
 
+uint64_t ZonedAllocator::find_zone(
+  uint64_t want_size,
+  uint64_t cursor,
+  uint8_t temp,
+  bool mix)
+{
+  uint64_t left = num_zones - first_seq_zone_num;
+  uint64_t zone_num = cursor;
+  for ( ; left > 0; ++zone_num, --left) {
+    if (zone_num >= num_zones) {
+      zone_num = first_seq_zone_num;
+    }
+    if (zone_num == cleaning_zone) {
+      ldout(cct, 10) << " skipping zone 0x" << std::hex << zone_num
+		     << " because we are cleaning it" << std::dec << dendl;
+      continue;
+    }
+    if (!mix &&
+	get_write_pointer(zone_num) > 0 &&
+	zone_temps[zone_num] != TEMP_NONE &&
+	zone_temps[zone_num] != temp) {
+      continue;
+    }
+    if (!fits(want_size, zone_num)) {
+      ldout(cct, 10) << " skipping zone 0x" << std::hex << zone_num
+		     << " because there is not enough space: "
+		     << " want_size = 0x" << want_size
+		     << " available = 0x" << get_remaining_space(zone_num)
+		     << std::dec
+		     << dendl;
+      continue;
+    }
+    return zone_num;
+  }
+  return num_zones;
+}
+
 void ZonedAllocator::release(const interval_set<uint64_t>& release_set)
 {
   std::lock_guard l(lock);
@@ -171,8 +204,10 @@ int64_t ZonedAllocator::pick_zone_to_clean(float min_score, uint64_t min_saved)
   std::lock_guard l(lock);
   int32_t best = -1;
   float best_score = 0.0;
+  double best_value = 0.0;
+  auto now = ceph::mono_clock::now();
   for (size_t i = first_seq_zone_num; i < num_zones; ++i) {
-    // value (score) = benefit / cost
+    // score = bytes saved / bytes moved, the threshold for cleaning at all
     //    benefit = how much net free space we'll get (dead bytes)
     //    cost = how many bytes we'll have to rewrite (live bytes)
     // avoid divide by zero on a zone with no live bytes
@@ -185,29 +220,36 @@ int64_t ZonedAllocator::pick_zone_to_clean(float min_score, uint64_t min_saved)
 		     << " score " << score
 		     << dendl;
     }
-    if (zone_states[i].num_dead_bytes < min_saved) {
+    if (zone_states[i].num_dead_bytes < min_saved ||
+	score < min_score) {
       continue;
     }
-    if (best < 0 || score > best_score) {
+    // the zones we are still writing into only get emptier: leave them
+    if ((i == starting_zone_num || i == cold_zone_num) &&
+	get_remaining_space(i) > 0) {
+      continue;
+    }
+    // among the candidates pick by cost-benefit, (1 - u) * age / (1 + u)
+    // with u the live fraction: data that has been left alone for a long
+    // time is likely to stay, so a cold zone pays off at a higher u than
+    // a hot one that is still emptying by itself
+    double u = (double)zone_states[i].get_num_live_bytes() / zone_size;
+    double age = std::max(
+      ceph::to_seconds<double>(now - zone_last_write[i]), 1.0);
+    double value = (1.0 - u) * age / (1.0 + u);
+    if (best < 0 || value > best_value) {
       best = i;
       best_score = score;
+      best_value = value;
     }
   }
-  if (best_score >= min_score) {
-    ldout(cct, 10) << " zone 0x" << std::hex << best << " with score " << best_score
-		   << ": 0x" << zone_states[best].num_dead_bytes
-		   << " dead and 0x"
-		   << zone_states[best].write_pointer - zone_states[best].num_dead_bytes
-		   << " live bytes" << std::dec << dendl;
-  } else if (best > 0) {
+  if (best >= 0) {
     ldout(cct, 10) << " zone 0x" << std::hex << best << " with score " << best_score
 		   << ": 0x" << zone_states[best].num_dead_bytes
 		   << " dead and 0x"
 		   << zone_states[best].write_pointer - zone_states[best].num_dead_bytes
 		   << " live bytes" << std::dec
-		   << " but below min_score " << min_score
-		   << dendl;
-    best = -1;
+		   << ", cost-benefit " << best_value << dendl;
   } else {
     ldout(cct, 10) << " no zones found that are good cleaning candidates" << dendl;
   }
@@ -218,6 +260,7 @@ void ZonedAllocator::reset_zone(uint32_t zone)
 {
   num_sequential_free += zone_states[zone].write_pointer;
   zone_states[zone].reset();
+  zone_temps[zone] = TEMP_NONE;
 }
 
 bool ZonedAllocator::low_on_space(void)
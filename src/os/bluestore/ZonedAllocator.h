@@ -15,6 +15,7 @@
 
 #include "Allocator.h"
 #include "common/ceph_mutex.h"
+#include "common/ceph_time.h"
 #include "include/btree_map.h"
 #include "include/interval_set.h"
 #include "include/mempool.h"
@@ -41,6 +42,21 @@ class ZonedAllocator : public Allocator {
   std::atomic<uint32_t> cleaning_zone = -1;
   std::vector<zone_state_t> zone_states;
 
+public:
+  // allocate() hints: hot and cold data are written to separate open
+  // zones so that zones tend to die (or stay live) as a whole
+  enum temp_t : uint8_t {
+    TEMP_NONE = 0,  ///< empty zone, or zone written before mount
+    TEMP_HOT,
+    TEMP_COLD,
+  };
+  static constexpr int64_t HINT_COLD = -1;
+private:
+  uint64_t cold_zone_num;            ///< cursor of the cold stream
+  std::vector<uint8_t> zone_temps;   ///< temp_t of the data in each zone
+  /// last allocation from each zone, the age used by the cleaner
+  std::vector<ceph::mono_time> zone_last_write;
+
   inline uint64_t get_offset(uint64_t zone_num) const {
     return zone_num * zone_size + get_write_pointer(zone_num);
   }
@@ -115,6 +131,10 @@ public:
 
 private:
   bool low_on_space(void);
+  /// first zone from cursor on that fits want_size and, unless mix,
+  /// holds no data of the other temperature; num_zones if none
+  uint64_t find_zone(uint64_t want_size, uint64_t cursor, uint8_t temp,
+		     bool mix);
 };
 
 #endif
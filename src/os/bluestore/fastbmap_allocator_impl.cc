@@ -8,6 +8,98 @@
 
 #include "fastbmap_allocator_impl.h"
 
+#ifndef NON_CEPH_BUILD
+#include "arch/probe.h"
+#include "arch/intel.h"
+#include "arch/arm.h"
+#endif
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+size_t find_nonclear_slot_generic(const slot_t* slots, size_t pos, size_t end)
+{
+  while (pos < end && slots[pos] == all_slot_clear) {
+    ++pos;
+  }
+  return pos;
+}
+
+#ifndef NON_CEPH_BUILD
+#if defined(__x86_64__) && defined(__GNUC__)
+__attribute__((target("avx2")))
+static size_t find_nonclear_slot_avx2(const slot_t* slots,
+  size_t pos, size_t end)
+{
+  // 4 slots at a time
+  for (; pos + 4 <= end; pos += 4) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)(slots + pos));
+    if (!_mm256_testz_si256(v, v)) {
+      break;
+    }
+  }
+  return find_nonclear_slot_generic(slots, pos, end);
+}
+
+__attribute__((target("avx512f")))
+static size_t find_nonclear_slot_avx512(const slot_t* slots,
+  size_t pos, size_t end)
+{
+  // a whole slotset (one cache line) at a time
+  for (; pos + slots_per_slotset <= end; pos += slots_per_slotset) {
+    __m512i v = _mm512_loadu_si512((const void*)(slots + pos));
+    __mmask8 m = _mm512_test_epi64_mask(v, v);
+    if (m) {
+      return pos + __builtin_ctz(m);
+    }
+  }
+  return find_nonclear_slot_generic(slots, pos, end);
+}
+#elif defined(__aarch64__)
+static size_t find_nonclear_slot_neon(const slot_t* slots,
+  size_t pos, size_t end)
+{
+  // 4 slots at a time
+  for (; pos + 4 <= end; pos += 4) {
+    uint64x2_t v = vorrq_u64(vld1q_u64(slots + pos), vld1q_u64(slots + pos + 2));
+    if (vgetq_lane_u64(v, 0) | vgetq_lane_u64(v, 1)) {
+      break;
+    }
+  }
+  return find_nonclear_slot_generic(slots, pos, end);
+}
+#endif
+#endif // NON_CEPH_BUILD
+
+/*
+ * choose best implementation based on the CPU architecture.
+ */
+static find_nonclear_slot_func_t choose_find_nonclear_slot()
+{
+#ifndef NON_CEPH_BUILD
+  // make sure we've probed cpu features; this might depend on the
+  // link order of this file relative to arch/probe.cc.
+  ceph_arch_probe();
+#if defined(__x86_64__) && defined(__GNUC__)
+  if (ceph_arch_intel_avx512f) {
+    return find_nonclear_slot_avx512;
+  }
+  if (ceph_arch_intel_avx2) {
+    return find_nonclear_slot_avx2;
+  }
+#elif defined(__aarch64__)
+  if (ceph_arch_neon) {
+    return find_nonclear_slot_neon;
+  }
+#endif
+#endif // NON_CEPH_BUILD
+  return find_nonclear_slot_generic;
+}
+
+find_nonclear_slot_func_t find_nonclear_slot = choose_find_nonclear_slot();
+
 uint64_t AllocatorLevel::l0_dives = 0;
 uint64_t AllocatorLevel::l0_iterations = 0;
 uint64_t AllocatorLevel::l0_inner_iterations = 0;
@@ -141,9 +233,18 @@ void AllocatorLevel01Loose::_analyze_partials(uint64_t pos_start,
 
   uint64_t next_free_l1_pos = 0;
   for (auto pos = pos_start / d; pos < pos_end / d; ++pos) {
+    // skip fully used slots at once, entry by entry they would just
+    // reset prev_tail
+    auto next_pos = find_nonclear_slot(l1.data(), pos, pos_end / d);
+    if (next_pos != pos) {
+      prev_tail = empty_tail;
+      l1_pos += (next_pos - pos) * d;
+      pos = next_pos;
+      if (pos >= pos_end / d) {
+        break;
+      }
+    }
     slot_t slot_val = l1[pos];
-    // FIXME minor: code below can be optimized to check slot_val against
-    // all_slot_set(_clear) value
 
     for (auto c = 0; c < d; c++) {
       switch (slot_val & L1_ENTRY_MASK) {
@@ -450,13 +551,16 @@ bool AllocatorLevel01Loose::_allocate_l1(uint64_t length,
   } else {
     uint64_t l0_w = slots_per_slotset * d0;
 
+    auto idx_end = l1_pos_end / d1;
     for (auto idx = l1_pos_start / d1;
-      idx < l1_pos_end / d1 && length > *allocated;
+      idx < idx_end && length > *allocated;
       ++idx) {
+      idx = find_nonclear_slot(l1.data(), idx, idx_end);
+      if (idx >= idx_end) {
+        break;
+      }
       slot_t& slot_val = l1[idx];
-      if (slot_val == all_slot_clear) {
-        continue;
-      } else if (slot_val == all_slot_set) {
+      if (slot_val == all_slot_set) {
         uint64_t to_alloc = std::min(length - *allocated,
           l1_granularity * d1);
         *allocated += to_alloc;
@@ -56,9 +56,9 @@ static const slot_t all_slot_clear = 0;
 inline size_t find_next_set_bit(slot_t slot_val, size_t start_pos)
 {
 #ifdef __GNUC__
-  if (start_pos == 0) {
-    start_pos = __builtin_ffsll(slot_val);
-    return start_pos ? start_pos - 1 : bits_per_slot;
+  if (start_pos < bits_per_slot) {
+    auto pos = __builtin_ffsll(slot_val >> start_pos);
+    return pos ? start_pos + pos - 1 : bits_per_slot;
   }
 #endif
   slot_t mask = slot_t(1) << start_pos;
@@ -69,6 +69,17 @@ inline size_t find_next_set_bit(slot_t slot_val, size_t start_pos)
   return start_pos;
 }
 
+// Returns the index of the first slot within [pos, end) which isn't
+// all_slot_clear or end if there is no such one.
+// Fully allocated L0 slots and fully used L1 slots are both all_slot_clear
+// hence this is the hot path when scanning a filled-up (and fragmented)
+// device. The implementation (scalar, AVX2, AVX-512 or NEON) is chosen
+// at runtime depending on the CPU capabilities.
+typedef size_t (*find_nonclear_slot_func_t)(const slot_t* slots,
+  size_t pos, size_t end);
+size_t find_nonclear_slot_generic(const slot_t* slots, size_t pos, size_t end);
+extern find_nonclear_slot_func_t find_nonclear_slot;
+
 
 class AllocatorLevel
 {
@@ -204,14 +215,17 @@ class AllocatorLevel01Loose : public AllocatorLevel01
 
     uint64_t need_entries = (length - *allocated) / l0_granularity;
 
-    for (auto idx = l0_pos0 / d0; (idx < l0_pos1 / d0) && (length > *allocated);
+    auto idx_end = l0_pos1 / d0;
+    for (auto idx = l0_pos0 / d0; (idx < idx_end) && (length > *allocated);
       ++idx) {
       ++l0_iterations;
+      idx = find_nonclear_slot(l0.data(), idx, idx_end);
+      if (idx >= idx_end) {
+        break;
+      }
       slot_t& slot_val = l0[idx];
       auto base = idx * d0;
-      if (slot_val == all_slot_clear) {
-        continue;
-      } else if (slot_val == all_slot_set) {
+      if (slot_val == all_slot_set) {
         uint64_t to_alloc = std::min(need_entries, d0);
         *allocated += to_alloc * l0_granularity;
 	++alloc_fragments;
@@ -235,19 +249,21 @@ class AllocatorLevel01Loose : public AllocatorLevel01
         (next_pos - free_pos) < need_entries) {
 	++l0_inner_iterations;
 
-        if (0 == (slot_val & (slot_t(1) << next_pos))) {
-          auto to_alloc = (next_pos - free_pos);
-          *allocated += to_alloc * l0_granularity;
-	  ++alloc_fragments;
-          need_entries -= to_alloc;
-	  _fragment_and_emplace(max_length, (base + free_pos) * l0_granularity,
-	    to_alloc * l0_granularity, res);
-          _mark_alloc_l0(base + free_pos, base + next_pos);
-          free_pos = find_next_set_bit(slot_val, next_pos + 1);
-          next_pos = free_pos + 1;
-        } else {
-          ++next_pos;
+        // the first allocated entry past the free run at free_pos
+        next_pos = find_next_set_bit(~slot_val, free_pos);
+        if (next_pos >= bits_per_slot ||
+          (next_pos - free_pos) >= need_entries) {
+          break;
         }
+        auto to_alloc = (next_pos - free_pos);
+        *allocated += to_alloc * l0_granularity;
+	++alloc_fragments;
+        need_entries -= to_alloc;
+	_fragment_and_emplace(max_length, (base + free_pos) * l0_granularity,
+	  to_alloc * l0_granularity, res);
+        _mark_alloc_l0(base + free_pos, base + next_pos);
+        free_pos = find_next_set_bit(slot_val, next_pos + 1);
+        next_pos = free_pos + 1;
       }
       if (need_entries && free_pos < bits_per_slot) {
         auto to_alloc = std::min(need_entries, d0 - free_pos);
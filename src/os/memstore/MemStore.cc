@@ -1481,10 +1481,22 @@ int MemStore::_merge_collection(const coll_t& cid, uint32_t bits, coll_t dest)
 
 namespace {
 struct BufferlistObject : public MemStore::Object {
+  // writes splice the caller's buffers in without copying, so a small
+  // fragment can pin the much larger message buffer it was cut from.  the
+  // object is compacted once the raw memory it pins exceeds this multiple
+  // of its size.  the copy is then paid for by the waste it frees and does
+  // not come back until as much waste builds up again.
+  static constexpr uint64_t MAX_PINNED_RATIO = 2;
+  // backstop for writes that never pin more than they use: past this many
+  // fragments the object is compacted anyway, which also bounds the cost of
+  // get_pinned_bytes()
+  static constexpr unsigned MAX_FRAGMENTS = 1024;
+
   ceph::spinlock mutex;
   ceph::buffer::list data;
 
   size_t get_size() const override { return data.length(); }
+  static uint64_t get_pinned_bytes(const ceph::buffer::list& bl);
 
   int read(uint64_t offset, uint64_t len, ceph::buffer::list &bl) override;
   int write(uint64_t offset, const ceph::buffer::list &bl) override;
@@ -1507,6 +1519,26 @@ struct BufferlistObject : public MemStore::Object {
 };
 }
 // BufferlistObject
+uint64_t BufferlistObject::get_pinned_bytes(const ceph::buffer::list& bl)
+{
+  // several fragments may share one raw buffer, count each only once
+  std::vector<std::pair<const char*, unsigned>> raws;
+  raws.reserve(bl.get_num_buffers());
+  for (auto& p : bl.buffers()) {
+    raws.emplace_back(p.raw_c_str(), p.raw_length());
+  }
+  std::sort(raws.begin(), raws.end());
+  uint64_t pinned = 0;
+  const char* last = nullptr;
+  for (auto& [raw, len] : raws) {
+    if (raw != last) {
+      pinned += len;
+      last = raw;
+    }
+  }
+  return pinned;
+}
+
 int BufferlistObject::read(uint64_t offset, uint64_t len,
                                      ceph::buffer::list &bl)
 {
@@ -1541,6 +1573,10 @@ int BufferlistObject::write(uint64_t offset, const ceph::buffer::list &src)
     newdata.append(tail);
   }
 
+  if (newdata.get_num_buffers() > MAX_FRAGMENTS ||
+      get_pinned_bytes(newdata) > MAX_PINNED_RATIO * newdata.length()) {
+    newdata.rebuild();
+  }
   data = std::move(newdata);
   return 0;
 }
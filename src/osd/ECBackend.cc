@@ -1048,19 +1048,38 @@ void ECBackend::handle_sub_read(
         dout(25) << __func__ << " case2: going to do fragmented read." << dendl;
         int subchunk_size =
           sinfo.get_chunk_size() / ec_impl->get_sub_chunk_count();
-        bool error = false;
-        for (int m = 0; m < (int)j->get<1>() && !error;
+        std::vector<std::pair<uint64_t, uint64_t>> ranges;
+        bool ascending = true;
+        for (int m = 0; m < (int)j->get<1>();
              m += sinfo.get_chunk_size()) {
           for (auto &&k:op.subchunks.find(i->first)->second) {
+            uint64_t off = j->get<0>() + m + (k.first)*subchunk_size;
+            if (!ranges.empty() &&
+                off < ranges.back().first + ranges.back().second) {
+              ascending = false;
+            }
+            ranges.emplace_back(off, (k.second)*subchunk_size);
+          }
+        }
+        const ghobject_t oid(i->first, ghobject_t::NO_GEN, shard);
+        struct stat st;
+        if (ascending && (r = store->stat(ch, oid, &st)) >= 0) {
+          // hand all sub-chunk ranges to the store as one vectored read;
+          // clip them to the object like individual reads would be
+          interval_set<uint64_t> extents;
+          for (auto &&[off, len] : ranges) {
+            if (off < (uint64_t)st.st_size) {
+              extents.insert(off, std::min<uint64_t>(len, st.st_size - off));
+            }
+          }
+          if (!extents.empty()) {
+            r = store->readv(ch, oid, extents, bl, j->get<2>());
+          }
+        } else if (!ascending) {
+          for (auto &&[off, len] : ranges) {
             bufferlist bl0;
-            r = store->read(
-                ch,
-                ghobject_t(i->first, ghobject_t::NO_GEN, shard),
-                j->get<0>() + m + (k.first)*subchunk_size,
-                (k.second)*subchunk_size,
-                bl0, j->get<2>());
+            r = store->read(ch, oid, off, len, bl0, j->get<2>());
             if (r < 0) {
-              error = true;
               break;
             }
             bl.claim_append(bl0);
@@ -1203,6 +1222,12 @@ void ECBackend::handle_sub_read_reply(
     return;
   }
   ReadOp &rop = iter->second;
+  if (auto sent = rop.sent_at.find(from); sent != rop.sent_at.end()) {
+    note_sub_read_latency(
+      from.osd,
+      std::chrono::duration<double>(
+	ceph::mono_clock::now() - sent->second).count());
+  }
   for (auto i = op.buffers_read.begin();
        i != op.buffers_read.end();
        ++i) {
@@ -1285,7 +1310,7 @@ void ECBackend::handle_sub_read_reply(
 	  // If we don't have enough copies, try other pg_shard_ts if available.
 	  // During recovery there may be multiple osds with copies of the same shard,
 	  // so getting EIO from one may result in multiple passes through this code path.
-	  if (!rop.do_redundant_reads) {
+	  if (!rop.do_redundant_reads || rop.hedged) {
 	    int r = send_all_remaining_reads(iter->first, rop);
 	    if (r == 0) {
 	      // We changed the rop's to_read and not incrementing is_complete
@@ -1358,6 +1383,9 @@ void ECBackend::complete_read_op(ReadOp &rop, RecoveryMessages *m)
     shard_to_read_map[*iter].erase(rop.tid);
   }
   rop.in_progress.clear();
+  if (rop.hedge_timer) {
+    get_parent()->cancel_backend_timer(rop.hedge_timer);
+  }
   tid_to_read_map.erase(rop.tid);
 }
 
@@ -1479,6 +1507,9 @@ void ECBackend::on_change()
        i != tid_to_read_map.end();
        ++i) {
     dout(10) << __func__ << ": cancelling " << i->second << dendl;
+    if (i->second.hedge_timer) {
+      get_parent()->cancel_backend_timer(i->second.hedge_timer);
+    }
     for (map<hobject_t, read_request_t>::iterator j =
 	   i->second.to_read.begin();
 	 j != i->second.to_read.end();
@@ -1647,10 +1678,17 @@ int ECBackend::get_min_avail_to_read_shards(
 
   get_all_avail_shards(hoid, error_shards, have, shards, for_recovery);
 
+  // The plugin picks which of the available shards to read.  Locality
+  // aware plugins (lrc, shec) return the smallest set that can rebuild
+  // want, e.g. only the surviving members of the local group for a single
+  // lost lrc shard, so do not widen need beyond what they asked for when
+  // recovering.
   map<int, vector<pair<int, int>>> need;
   int r = ec_impl->minimum_to_decode(want, have, &need);
   if (r < 0)
     return r;
+  dout(20) << __func__ << " " << hoid << " want " << want
+	   << " have " << have << " need " << need << dendl;
 
   if (do_redundant_reads) {
       vector<pair<int, int>> subchunks_list;
@@ -1742,6 +1780,7 @@ void ECBackend::start_read_op(
     op.trace.event("start ec read");
   }
   do_read_op(op);
+  maybe_schedule_hedge(op);
 }
 
 void ECBackend::do_read_op(ReadOp &op)
@@ -1789,10 +1828,12 @@ void ECBackend::do_read_op(ReadOp &op)
 
   std::vector<std::pair<int, Message*>> m;
   m.reserve(messages.size());
+  auto now = ceph::mono_clock::now();
   for (map<pg_shard_t, ECSubRead>::iterator i = messages.begin();
        i != messages.end();
        ++i) {
     op.in_progress.insert(i->first);
+    op.sent_at[i->first] = now;
     shard_to_read_map[i->first].insert(op.tid);
     i->second.tid = tid;
     MOSDECSubOpRead *msg = new MOSDECSubOpRead;
@@ -2480,6 +2521,98 @@ int ECBackend::send_all_remaining_reads(
   return 0;
 }
 
+void ECBackend::note_sub_read_latency(int osd, double lat)
+{
+  auto [it, inserted] = sub_read_lat.emplace(osd, lat);
+  if (!inserted) {
+    it->second += (lat - it->second) / 8;
+  }
+}
+
+void ECBackend::maybe_schedule_hedge(ReadOp &rop)
+{
+  double min_delay = cct->_conf->osd_ec_hedged_read_min_delay;
+  // only single-object client reads; recovery and fast_read already
+  // pick their shards deliberately
+  if (min_delay <= 0 ||
+      rop.for_recovery ||
+      rop.do_redundant_reads ||
+      rop.to_read.size() != 1 ||
+      rop.in_progress.empty()) {
+    return;
+  }
+  double delay = min_delay;
+  for (auto &shard : rop.in_progress) {
+    auto it = sub_read_lat.find(shard.osd);
+    if (it != sub_read_lat.end()) {
+      delay = std::max(
+	delay,
+	it->second * cct->_conf->osd_ec_hedged_read_latency_multiplier);
+    }
+  }
+  dout(20) << __func__ << " tid " << rop.tid << " in " << delay << "s" << dendl;
+  ceph_tid_t tid = rop.tid;
+  rop.hedge_timer = get_parent()->schedule_backend_timer(
+    delay,
+    new LambdaContext([this, tid](int) {
+      hedge_read_op(tid);
+    }));
+}
+
+void ECBackend::hedge_read_op(ceph_tid_t tid)
+{
+  auto iter = tid_to_read_map.find(tid);
+  if (iter == tid_to_read_map.end()) {
+    // already complete
+    return;
+  }
+  ReadOp &rop = iter->second;
+  rop.hedge_timer = nullptr;
+  if (rop.hedged || rop.do_redundant_reads || rop.in_progress.empty()) {
+    return;
+  }
+  ceph_assert(rop.to_read.size() == 1);
+  const hobject_t &hoid = rop.to_read.begin()->first;
+  read_request_t &req = rop.to_read.begin()->second;
+
+  set<pg_shard_t> error_shards;
+  for (auto &p : rop.complete[hoid].errors) {
+    error_shards.insert(p.first);
+  }
+  set<int> have;
+  map<shard_id_t, pg_shard_t> shards;
+  get_all_avail_shards(hoid, error_shards, have, shards, false);
+
+  // one extra shard for every sub-read that is still outstanding
+  const set<pg_shard_t> &asked = rop.obj_to_source[hoid];
+  vector<pair<int, int>> subchunks;
+  subchunks.push_back(make_pair(0, ec_impl->get_sub_chunk_count()));
+  map<pg_shard_t, vector<pair<int, int>>> extra;
+  for (auto &[shard, pg_shard] : shards) {
+    if (extra.size() >= rop.in_progress.size()) {
+      break;
+    }
+    if (!asked.count(pg_shard)) {
+      extra.emplace(pg_shard, subchunks);
+    }
+  }
+  if (extra.empty()) {
+    dout(10) << __func__ << " tid " << tid << " no spare shards for "
+	     << hoid << dendl;
+    return;
+  }
+  dout(10) << __func__ << " tid " << tid << " outstanding " << rop.in_progress
+	   << " hedging with " << extra << dendl;
+  get_parent()->get_logger()->inc(l_osd_ec_hedged_read);
+
+  // the outstanding sub-reads already carry any attrs request
+  req.need = std::move(extra);
+  req.want_attrs = false;
+  rop.hedged = true;
+  rop.do_redundant_reads = true;
+  do_read_op(rop);
+}
+
 int ECBackend::objects_get_attrs(
   const hobject_t &hoid,
   map<string, bufferlist, less<>> *out)
@@ -2563,7 +2696,9 @@ int ECBackend::be_deep_scrub(
     o.read_error = true;
     return 0;
   }
-  if (r > 0) {
+  // with overwrites there is no stored chunk hash to check against (see
+  // below), so the read itself is all the verification we get
+  if (r > 0 && !get_parent()->get_pool().allows_ecoverwrites()) {
     pos.data_hash << bl;
   }
   pos.data_pos += r;
@@ -386,6 +386,13 @@ public:
 
     std::set<pg_shard_t> in_progress;
 
+    // when each sub-read was sent, for the per-OSD latency estimate
+    std::map<pg_shard_t, ceph::mono_time> sent_at;
+    // true once extra shards have been asked to cover slow sub-reads
+    bool hedged = false;
+    // pending hedge timer, cancelled when the op completes first
+    Context *hedge_timer = nullptr;
+
     ReadOp(
       int priority,
       ceph_tid_t tid,
@@ -432,6 +439,21 @@ public:
     const hobject_t &hoid,
     ReadOp &rop);
 
+  /**
+   * Hedged reads
+   *
+   * A plain (non fast_read) client read only asks the minimum set of
+   * shards.  If some of them have not replied within a few multiples of
+   * their usual latency we ask as many additional shards as are still
+   * outstanding and complete the read as soon as enough have come back;
+   * the late replies are then dropped like those of an over-provisioned
+   * fast_read.
+   */
+  std::map<int, double> sub_read_lat;  ///< per-osd ewma, seconds
+  void note_sub_read_latency(int osd, double lat);
+  void maybe_schedule_hedge(ReadOp &rop);
+  void hedge_read_op(ceph_tid_t tid);
+
 
   /**
    * Client writes
@@ -46,15 +46,26 @@ void encode_and_write(
   ECUtil::HashInfoRef hinfo,
   extent_map &written,
   map<shard_id_t, ObjectStore::Transaction> *transactions,
-  DoutPrefixProvider *dpp) {
+  DoutPrefixProvider *dpp,
+  const set<int> &unchanged = set<int>()) {
   const uint64_t before_size = hinfo->get_total_logical_size(sinfo);
   ceph_assert(sinfo.logical_offset_is_stripe_aligned(offset));
   ceph_assert(sinfo.logical_offset_is_stripe_aligned(bl.length()));
   ceph_assert(bl.length());
 
+  // when appending, let encode() extend the shard hashes while each stripe
+  // is still in cache rather than crc'ing the shards in a second pass
+  const bool appending = offset >= before_size;
+  map<int, uint32_t> crcs;
+  if (appending && hinfo->has_chunk_hash()) {
+    for (auto shard : want) {
+      crcs[shard] = hinfo->get_chunk_hash(shard);
+    }
+  }
+
   map<int, bufferlist> buffers;
   int r = ECUtil::encode(
-    sinfo, ecimpl, bl, want, &buffers);
+    sinfo, ecimpl, bl, want, &buffers, crcs.empty() ? nullptr : &crcs);
   ceph_assert(r == 0);
 
   written.insert(offset, bl.length(), bl);
@@ -64,15 +75,21 @@ void encode_and_write(
 		     << offset + bl.length()
 		     << dendl;
 
-  if (offset >= before_size) {
+  if (appending) {
     ceph_assert(offset == before_size);
-    hinfo->append(
+    hinfo->append_hashes(
       sinfo.aligned_logical_offset_to_chunk_offset(offset),
-      buffers);
+      buffers.begin()->second.length(),
+      crcs);
   }
 
   for (auto &&i : *transactions) {
     ceph_assert(buffers.count(i.first));
+    if (unchanged.count(i.first)) {
+      ldpp_dout(dpp, 20) << __func__ << ": shard " << i.first
+			 << " unchanged, not rewriting" << dendl;
+      continue;
+    }
     bufferlist &enc_bl = buffers[i.first];
     if (offset >= before_size) {
       i.second.set_alloc_hint(
@@ -479,6 +496,7 @@ void ECTransaction::generate_transactions(
       }
 
       uint32_t fadvise_flags = 0;
+      extent_set modified;  // logical ranges the op itself changes
       for (auto &&extent: op.buffer_updates) {
 	using BufferUpdate = PGTransaction::ObjectOperation::BufferUpdate;
 	bufferlist bl;
@@ -504,6 +522,7 @@ void ECTransaction::generate_transactions(
 			   << make_pair(off, len)
 			   << dendl;
 	ceph_assert(len > 0);
+	modified.union_insert(off, len);
 	if (off > new_size) {
 	  ceph_assert(off > append_after);
 	  bl.prepend_zero(off - new_size);
@@ -558,6 +577,16 @@ void ECTransaction::generate_transactions(
       ldpp_dout(dpp, 20) << __func__ << ": to_overwrite: "
 			 << to_overwrite
 			 << dendl;
+      // A partial overwrite re-encodes whole stripes, but the data chunks
+      // it does not touch come back exactly as they were read, so only the
+      // touched data shards and the parity shards need the new bytes.
+      // Rollback still clones every shard, below, so it stays uniform.
+      // Objects whose shards were just recreated or cloned in this
+      // transaction are written in full.
+      const bool skip_unchanged = !op.deletes_first() && !op.has_source();
+      const auto &chunk_mapping = ecimpl->get_chunk_mapping();
+      const uint64_t chunk_size = sinfo.get_chunk_size();
+      const unsigned data_chunks = ecimpl->get_data_chunk_count();
       for (auto &&extent: to_overwrite) {
 	ceph_assert(extent.get_off() + extent.get_len() <= append_after);
 	ceph_assert(sinfo.logical_offset_is_stripe_aligned(extent.get_off()));
@@ -588,6 +617,21 @@ void ECTransaction::generate_transactions(
 	      restore_from);
 	  }
 	}
+	set<int> unchanged;
+	if (skip_unchanged) {
+	  for (unsigned j = 0; j < data_chunks; ++j) {
+	    bool touched = false;
+	    for (uint64_t s = extent.get_off();
+		 !touched && s < extent.get_off() + extent.get_len();
+		 s += sinfo.get_stripe_width()) {
+	      touched = modified.intersects(s + j * chunk_size, chunk_size);
+	    }
+	    if (!touched) {
+	      unchanged.insert(
+		chunk_mapping.size() > j ? chunk_mapping[j] : (int)j);
+	    }
+	  }
+	}
 	encode_and_write(
 	  pgid,
 	  oid,
@@ -600,7 +644,8 @@ void ECTransaction::generate_transactions(
 	  hinfo,
 	  written,
 	  transactions,
-	  dpp);
+	  dpp,
+	  unchanged);
       }
 
       auto to_append = to_write.intersect(
@@ -2,10 +2,14 @@
 
 #include <errno.h>
 #include "include/encoding.h"
+#include "include/crc32c.h"
+#include "erasure-code/ErasureCode.h"
 #include "ECUtil.h"
 
 using namespace std;
 using ceph::bufferlist;
+using ceph::bufferptr;
+using ceph::ErasureCode;
 using ceph::ErasureCodeInterfaceRef;
 using ceph::Formatter;
 
@@ -31,6 +35,12 @@ int ECUtil::decode(
   if (total_data_size == 0)
     return 0;
 
+  // align each shard once rather than letting the plugin realign every
+  // chunk sliced out of it
+  for (auto &&i : to_decode) {
+    i.second.rebuild_aligned(ErasureCode::SIMD_ALIGN);
+  }
+
   for (uint64_t i = 0; i < total_data_size; i += sinfo.get_chunk_size()) {
     map<int, bufferlist> chunks;
     for (map<int, bufferlist>::iterator j = to_decode.begin();
@@ -72,6 +82,7 @@ int ECUtil::decode(
   set<int> avail;
   for (auto &&i : to_decode) {
     ceph_assert(i.second.length() != 0);
+    i.second.rebuild_aligned(ErasureCode::SIMD_ALIGN);
     avail.insert(i.first);
   }
 
@@ -120,22 +131,13 @@ int ECUtil::decode(
   return 0;
 }
 
-int ECUtil::encode(
-  const stripe_info_t &sinfo,
+static int encode_by_stripe(
+  const ECUtil::stripe_info_t &sinfo,
   ErasureCodeInterfaceRef &ec_impl,
   bufferlist &in,
   const set<int> &want,
   map<int, bufferlist> *out) {
-
   uint64_t logical_size = in.length();
-
-  ceph_assert(logical_size % sinfo.get_stripe_width() == 0);
-  ceph_assert(out);
-  ceph_assert(out->empty());
-
-  if (logical_size == 0)
-    return 0;
-
   for (uint64_t i = 0; i < logical_size; i += sinfo.get_stripe_width()) {
     map<int, bufferlist> encoded;
     bufferlist buf;
@@ -149,6 +151,95 @@ int ECUtil::encode(
       (*out)[i->first].claim_append(i->second);
     }
   }
+  return 0;
+}
+
+/*
+ * Every plugin's encode() is encode_prepare() followed by an in place
+ * encode_chunks(), and encode_prepare() allocates (and usually copies
+ * into) k + m fresh aligned chunks for each stripe.  For a multi-stripe
+ * write that is most of the cost, and leaves each shard as a list of
+ * chunk sized fragments.  Instead, allocate each shard once for the
+ * whole extent, transpose the data into the data shards in a single
+ * pass, and run encode_chunks() on per-stripe views of those buffers.
+ */
+int ECUtil::encode(
+  const stripe_info_t &sinfo,
+  ErasureCodeInterfaceRef &ec_impl,
+  bufferlist &in,
+  const set<int> &want,
+  map<int, bufferlist> *out,
+  map<int, uint32_t> *crcs) {
+
+  uint64_t logical_size = in.length();
+
+  ceph_assert(logical_size % sinfo.get_stripe_width() == 0);
+  ceph_assert(out);
+  ceph_assert(out->empty());
+
+  if (logical_size == 0)
+    return 0;
+
+  const uint64_t stripe_width = sinfo.get_stripe_width();
+  const uint64_t chunk_size = sinfo.get_chunk_size();
+  const unsigned k = ec_impl->get_data_chunk_count();
+  const unsigned n = ec_impl->get_chunk_count();
+  if (stripe_width != k * chunk_size ||
+      ec_impl->get_chunk_size(stripe_width) != chunk_size ||
+      chunk_size % ErasureCode::SIMD_ALIGN != 0) {
+    encode_by_stripe(sinfo, ec_impl, in, want, out);
+    if (crcs) {
+      for (auto shard : want) {
+	uint32_t &crc = crcs->at(shard);
+	crc = (*out)[shard].crc32c(crc);
+      }
+    }
+  } else {
+    const vector<int> &mapping = ec_impl->get_chunk_mapping();
+    auto chunk_index = [&mapping](unsigned i) {
+      return mapping.size() > i ? mapping[i] : (int)i;
+    };
+    const uint64_t stripes = logical_size / stripe_width;
+    map<int, bufferptr> shards;
+    for (unsigned i = 0; i < n; ++i) {
+      shards.emplace(
+	chunk_index(i),
+	buffer::create_aligned(stripes * chunk_size, ErasureCode::SIMD_ALIGN));
+    }
+
+    // one stripe at a time: transpose, encode and checksum while the
+    // stripe is still in cache
+    auto p = in.cbegin();
+    for (uint64_t s = 0; s < stripes; ++s) {
+      for (unsigned i = 0; i < k; ++i) {
+	p.copy(chunk_size, shards[chunk_index(i)].c_str() + s * chunk_size);
+      }
+      map<int, bufferlist> encoded;
+      for (auto &&[shard, bp] : shards) {
+	encoded[shard].push_back(bufferptr(bp, s * chunk_size, chunk_size));
+      }
+      int r = ec_impl->encode_chunks(want, &encoded);
+      ceph_assert(r == 0);
+      for (auto shard : want) {
+	// plugins encode in place; cope with one that hands back its own
+	// buffer anyway
+	bufferlist &bl = encoded[shard];
+	ceph_assert(bl.length() == chunk_size);
+	char *dst = shards[shard].c_str() + s * chunk_size;
+	if (!bl.is_contiguous() || bl.c_str() != dst) {
+	  bl.begin().copy(chunk_size, dst);
+	}
+	if (crcs) {
+	  uint32_t &crc = crcs->at(shard);
+	  crc = ceph_crc32c(crc, (const unsigned char*)dst, chunk_size);
+	}
+      }
+    }
+
+    for (auto shard : want) {
+      (*out)[shard].push_back(std::move(shards[shard]));
+    }
+  }
 
   for (map<int, bufferlist>::iterator i = out->begin();
        i != out->end();
@@ -179,6 +270,20 @@ void ECUtil::HashInfo::append(uint64_t old_size,
   total_chunk_size += size_to_append;
 }
 
+void ECUtil::HashInfo::append_hashes(uint64_t old_size,
+				     uint64_t size_to_append,
+				     const map<int, uint32_t> &new_hashes) {
+  ceph_assert(old_size == total_chunk_size);
+  if (has_chunk_hash()) {
+    ceph_assert(new_hashes.size() == cumulative_shard_hashes.size());
+    for (auto &&[shard, hash] : new_hashes) {
+      ceph_assert((unsigned)shard < cumulative_shard_hashes.size());
+      cumulative_shard_hashes[shard] = hash;
+    }
+  }
+  total_chunk_size += size_to_append;
+}
+
 void ECUtil::HashInfo::encode(bufferlist &bl) const
 {
   ENCODE_START(1, 1, bl);
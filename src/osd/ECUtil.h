@@ -91,12 +91,15 @@ int decode(
   std::map<int, ceph::buffer::list> &to_decode,
   std::map<int, ceph::buffer::list*> &out);
 
+/// if crcs is given, it holds a crc32c seed for every shard in want and
+/// is updated to the crc32c of that shard's encoded output
 int encode(
   const stripe_info_t &sinfo,
   ceph::ErasureCodeInterfaceRef &ec_impl,
   ceph::buffer::list &in,
   const std::set<int> &want,
-  std::map<int, ceph::buffer::list> *out);
+  std::map<int, ceph::buffer::list> *out,
+  std::map<int, uint32_t> *crcs = nullptr);
 
 class HashInfo {
   uint64_t total_chunk_size = 0;
@@ -109,6 +112,10 @@ public:
   explicit HashInfo(unsigned num_chunks) :
     cumulative_shard_hashes(num_chunks, -1) {}
   void append(uint64_t old_size, std::map<int, ceph::buffer::list> &to_append);
+  /// append size_to_append bytes per shard whose cumulative hashes were
+  /// already computed, e.g. by ECUtil::encode()
+  void append_hashes(uint64_t old_size, uint64_t size_to_append,
+		     const std::map<int, uint32_t> &new_hashes);
   void clear() {
     total_chunk_size = 0;
     cumulative_shard_hashes = std::vector<uint32_t>(
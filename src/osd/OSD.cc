@@ -128,6 +128,7 @@
 #include "common/LogClient.h"
 #include "common/AsyncReserver.h"
 #include "common/HeartbeatMap.h"
+#include "common/Thread.h"
 #include "common/admin_socket.h"
 #include "common/ceph_context.h"
 
@@ -526,6 +527,7 @@ void OSDService::shutdown()
 
   publish_map(OSDMapRef());
   next_osdmap = OSDMapRef();
+  _ring_clear();
 }
 
 void OSDService::init()
@@ -1566,13 +1568,41 @@ OSDMapRef OSDService::_add_map(OSDMap *o)
   if (existed) {
     delete o;
   }
+  _ring_insert(l);
   return l;
 }
 
+void OSDService::_ring_insert(const OSDMapRef& m)
+{
+  epoch_t e = m->get_epoch();
+  // old maps pulled back in from disk (e.g. for past intervals) must not
+  // push a recent epoch out of its slot
+  if (e + MAP_RING_SIZE <= map_ring_newest) {
+    return;
+  }
+  map_ring_newest = std::max(map_ring_newest, e);
+  std::atomic_store(&map_ring[e % MAP_RING_SIZE], m);
+}
+
+void OSDService::_ring_clear()
+{
+  std::lock_guard l(map_cache_lock);
+  for (auto& slot : map_ring) {
+    std::atomic_store(&slot, OSDMapRef());
+  }
+  map_ring_newest = 0;
+}
+
 OSDMapRef OSDService::try_get_map(epoch_t epoch)
 {
+  OSDMapRef retval = _ring_lookup(epoch);
+  if (retval) {
+    dout(30) << "get_map " << epoch << " -cached" << dendl;
+    logger->inc(l_osd_map_cache_hit);
+    return retval;
+  }
   std::lock_guard l(map_cache_lock);
-  OSDMapRef retval = map_cache.lookup(epoch);
+  retval = map_cache.lookup(epoch);
   if (retval) {
     dout(30) << "get_map " << epoch << " -cached" << dendl;
     logger->inc(l_osd_map_cache_hit);
@@ -1709,14 +1739,14 @@ void OSDService::queue_recovery_context(
       e));
 }
 
-void OSDService::queue_for_snap_trim(PG *pg)
+void OSDService::queue_for_snap_trim(PG *pg, uint64_t cost_bytes)
 {
   dout(10) << "queueing " << *pg << " for snaptrim" << dendl;
   enqueue_back(
     OpSchedulerItem(
       unique_ptr<OpSchedulerItem::OpQueueable>(
 	new PGSnapTrim(pg->get_pgid(), pg->get_osdmap_epoch())),
-      cct->_conf->osd_snap_trim_cost,
+      std::max<uint64_t>(cct->_conf->osd_snap_trim_cost, cost_bytes),
       cct->_conf->osd_snap_trim_priority,
       ceph_clock_now(),
       0,
@@ -2341,6 +2371,7 @@ OSD::OSD(CephContext *cct_,
                                            cct->_conf->osd_op_history_duration);
   op_tracker.set_history_slow_op_size_and_threshold(cct->_conf->osd_op_history_slow_op_size,
                                                     cct->_conf->osd_op_history_slow_op_threshold);
+  op_tracker.set_history_sample_rate(cct->_conf->osd_op_history_sample_rate);
   ObjectCleanRegions::set_max_num_intervals(cct->_conf->osd_object_clean_region_max_num_intervals);
 #ifdef WITH_BLKIN
   std::stringstream ss;
@@ -2956,8 +2987,10 @@ will start to track new ops received afterwards.";
     int64_t osize = cmd_getval_or<int64_t>(cmdmap, "object_size", 0);
     int64_t onum = cmd_getval_or<int64_t>(cmdmap, "object_num", 0);
     double elapsed = 0.0;
+    std::vector<double> commit_lat;
 
-    ret = run_osd_bench_test(count, bsize, osize, onum, &elapsed, ss);
+    ret = run_osd_bench_test(count, bsize, osize, onum, &elapsed, ss,
+			     &commit_lat);
     if (ret != 0) {
       goto out;
     }
@@ -2970,6 +3003,23 @@ will start to track new ops received afterwards.";
     f->dump_float("elapsed_sec", elapsed);
     f->dump_float("bytes_per_sec", rate);
     f->dump_float("iops", iops);
+    if (!commit_lat.empty()) {
+      // ObjectStore transaction latency, from queueing to on_commit
+      std::sort(commit_lat.begin(), commit_lat.end());
+      auto pct = [&commit_lat](double p) {
+	size_t i = std::min(commit_lat.size() - 1,
+			    static_cast<size_t>(p / 100.0 * commit_lat.size()));
+	return commit_lat[i];
+      };
+      f->open_object_section("commit_latency_sec");
+      f->dump_float("min", commit_lat.front());
+      f->dump_float("p50", pct(50));
+      f->dump_float("p90", pct(90));
+      f->dump_float("p99", pct(99));
+      f->dump_float("p99.9", pct(99.9));
+      f->dump_float("max", commit_lat.back());
+      f->close_section();
+    }
     f->close_section();
   }
 
@@ -3248,7 +3298,8 @@ int OSD::run_osd_bench_test(
   int64_t osize,
   int64_t onum,
   double *elapsed,
-  ostream &ss)
+  ostream &ss,
+  std::vector<double> *commit_lat)
 {
   int ret = 0;
   srand(time(NULL) % (unsigned long) -1);
@@ -3340,6 +3391,21 @@ int OSD::run_osd_bench_test(
     }
   }
 
+  // per-transaction commit latencies, filled in from the commit callbacks.
+  // the callbacks may still be running on a finisher after flush_commit()
+  // returns, so they share ownership of the state and are waited for below
+  struct commit_lat_t {
+    ceph::mutex lock = ceph::make_mutex("OSD::run_osd_bench_test::commit_lat");
+    ceph::condition_variable cond;
+    std::vector<double> lat;
+    uint64_t pending = 0;
+  };
+  std::shared_ptr<commit_lat_t> lat_state;
+  if (commit_lat) {
+    lat_state = std::make_shared<commit_lat_t>();
+    lat_state->lat.reserve(count / bsize + 1);
+  }
+
   bufferlist bl;
   utime_t start = ceph_clock_now();
   for (int64_t pos = 0; pos < count; pos += bsize) {
@@ -3359,6 +3425,21 @@ int OSD::run_osd_bench_test(
     hobject_t soid(sobject_t(oid, 0));
     ObjectStore::Transaction t;
     t.write(coll_t::meta(), ghobject_t(soid), offset, bsize, bl);
+    if (lat_state) {
+      {
+	std::lock_guard l{lat_state->lock};
+	++lat_state->pending;
+      }
+      t.register_on_commit(new LambdaContext(
+	[lat_state, queued = ceph::mono_clock::now()](int) {
+	  std::lock_guard l{lat_state->lock};
+	  lat_state->lat.push_back(
+	    std::chrono::duration<double>(ceph::mono_clock::now() - queued).count());
+	  if (--lat_state->pending == 0) {
+	    lat_state->cond.notify_all();
+	  }
+	}));
+    }
     store->queue_transaction(service.meta_ch, std::move(t), nullptr);
     if (!onum || !osize) {
       cleanupt.remove(coll_t::meta(), ghobject_t(soid));
@@ -3375,6 +3456,12 @@ int OSD::run_osd_bench_test(
   utime_t end = ceph_clock_now();
   *elapsed = end - start;
 
+  if (lat_state) {
+    std::unique_lock l{lat_state->lock};
+    lat_state->cond.wait(l, [&] { return lat_state->pending == 0; });
+    commit_lat->swap(lat_state->lat);
+  }
+
   // clean up
   store->queue_transaction(service.meta_ch, std::move(cleanupt), nullptr);
   {
@@ -3505,21 +3592,20 @@ float OSD::get_osd_recovery_sleep()
   if (!store_is_rotational && !journal_is_rotational)
     return cct->_conf->osd_recovery_sleep_ssd;
   else if (store_is_rotational && !journal_is_rotational)
-    return cct->_conf.get_val<double>("osd_recovery_sleep_hybrid");
+    return cct->_conf->osd_recovery_sleep_hybrid;
   else
     return cct->_conf->osd_recovery_sleep_hdd;
 }
 
 float OSD::get_osd_delete_sleep()
 {
-  float osd_delete_sleep = cct->_conf.get_val<double>("osd_delete_sleep");
-  if (osd_delete_sleep > 0)
-    return osd_delete_sleep;
+  if (cct->_conf->osd_delete_sleep > 0)
+    return cct->_conf->osd_delete_sleep;
   if (!store_is_rotational && !journal_is_rotational)
-    return cct->_conf.get_val<double>("osd_delete_sleep_ssd");
+    return cct->_conf->osd_delete_sleep_ssd;
   if (store_is_rotational && !journal_is_rotational)
-    return cct->_conf.get_val<double>("osd_delete_sleep_hybrid");
-  return cct->_conf.get_val<double>("osd_delete_sleep_hdd");
+    return cct->_conf->osd_delete_sleep_hybrid;
+  return cct->_conf->osd_delete_sleep_hdd;
 }
 
 int OSD::get_recovery_max_active()
@@ -3534,14 +3620,13 @@ int OSD::get_recovery_max_active()
 
 float OSD::get_osd_snap_trim_sleep()
 {
-  float osd_snap_trim_sleep = cct->_conf.get_val<double>("osd_snap_trim_sleep");
-  if (osd_snap_trim_sleep > 0)
-    return osd_snap_trim_sleep;
+  if (cct->_conf->osd_snap_trim_sleep > 0)
+    return cct->_conf->osd_snap_trim_sleep;
   if (!store_is_rotational && !journal_is_rotational)
-    return cct->_conf.get_val<double>("osd_snap_trim_sleep_ssd");
+    return cct->_conf->osd_snap_trim_sleep_ssd;
   if (store_is_rotational && !journal_is_rotational)
-    return cct->_conf.get_val<double>("osd_snap_trim_sleep_hybrid");
-  return cct->_conf.get_val<double>("osd_snap_trim_sleep_hdd");
+    return cct->_conf->osd_snap_trim_sleep_hybrid;
+  return cct->_conf->osd_snap_trim_sleep_hdd;
 }
 
 int OSD::init()
@@ -5038,7 +5123,9 @@ void OSD::load_pgs()
     derr << "failed to list pgs: " << cpp_strerror(-r) << dendl;
   }
 
-  int num = 0;
+  // instantiate pgs first; reading their state from the store is the slow
+  // part and is done below, possibly in parallel
+  vector<PGRef> pgs;
   for (vector<coll_t>::iterator it = ls.begin();
        it != ls.end();
        ++it) {
@@ -5096,15 +5183,22 @@ void OSD::load_pgs()
 
     pg->lock();
     pg->ch = store->open_collection(pg->coll);
+    pg->unlock();
+    pgs.push_back(std::move(pg));
+  }
 
-    // read pg state, log
-    pg->read_state(store.get());
+  // read pg state, log
+  _load_pgs_read_state(pgs);
 
+  int num = 0;
+  for (auto& pg : pgs) {
+    const spg_t pgid = pg->get_pgid();
+    pg->lock();
     if (pg->dne())  {
-      dout(10) << "load_pgs " << *it << " deleting dne" << dendl;
+      dout(10) << "load_pgs " << pg->coll << " deleting dne" << dendl;
       pg->ch = nullptr;
       pg->unlock();
-      recursive_remove_collection(cct, store.get(), pgid, *it);
+      recursive_remove_collection(cct, store.get(), pgid, pg->coll);
       continue;
     }
     {
@@ -5122,6 +5216,39 @@ void OSD::load_pgs()
   dout(0) << __func__ << " opened " << num << " pgs" << dendl;
 }
 
+void OSD::_load_pgs_read_state(const vector<PGRef>& pgs)
+{
+  // PGs are independent at this point: each only touches its own
+  // collection and the (const) osdmap it was instantiated with.
+  const unsigned num_threads = std::min<size_t>(
+    cct->_conf->osd_load_pgs_threads, pgs.size());
+  std::atomic<size_t> next = {0};
+  auto read_some = [&] {
+    for (size_t i = next++; i < pgs.size(); i = next++) {
+      auto& pg = pgs[i];
+      pg->lock();
+      pg->read_state(store.get());
+      pg->unlock();
+    }
+  };
+  if (num_threads <= 1) {
+    read_some();
+    return;
+  }
+  dout(10) << __func__ << " reading " << pgs.size() << " pgs with "
+	   << num_threads << " threads" << dendl;
+  auto start = ceph::mono_clock::now();
+  vector<std::thread> threads;
+  for (unsigned i = 0; i < num_threads; ++i) {
+    threads.push_back(make_named_thread("load_pgs", read_some));
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  dout(0) << __func__ << " read " << pgs.size() << " pgs in "
+	  << ceph::mono_clock::now() - start << dendl;
+}
+
 
 PGRef OSD::handle_pg_create_info(const OSDMapRef& osdmap,
 				 const PGCreateInfo *info)
@@ -8023,7 +8150,13 @@ void OSD::handle_osd_map(MOSDMap *m)
       t.write(coll_t::meta(), oid, 0, bl.length(), bl);
 
       OSDMap *o = new OSDMap;
-      if (e > 1) {
+      if (auto prev = added_maps.find(e - 1); prev != added_maps.end()) {
+	// the previous epoch came in with this message and is not
+	// committed yet; copy it rather than re-decode its full map.  this
+	// is the common case when catching up on a long run of incrementals.
+	// the crc check below still covers the result.
+	o->deepish_copy_from(*prev->second);
+      } else if (e > 1) {
 	bufferlist obl;
         bool got = get_map_bl(e - 1, obl);
 	if (!got) {
@@ -9657,6 +9790,7 @@ const char** OSD::get_tracked_conf_keys() const
     "osd_op_history_duration",
     "osd_op_history_slow_op_size",
     "osd_op_history_slow_op_threshold",
+    "osd_op_history_sample_rate",
     "osd_enable_op_tracker",
     "osd_map_cache_size",
     "osd_pg_epoch_max_lag_factor",
@@ -9754,6 +9888,9 @@ void OSD::handle_conf_change(const ConfigProxy& conf,
     op_tracker.set_history_slow_op_size_and_threshold(cct->_conf->osd_op_history_slow_op_size,
                                                       cct->_conf->osd_op_history_slow_op_threshold);
   }
+  if (changed.count("osd_op_history_sample_rate")) {
+    op_tracker.set_history_sample_rate(cct->_conf->osd_op_history_sample_rate);
+  }
   if (changed.count("osd_enable_op_tracker")) {
       op_tracker.set_tracking(cct->_conf->osd_enable_op_tracker);
   }
@@ -10303,6 +10440,7 @@ void OSDShard::consume_map(
   dout(10) << new_osdmap->get_epoch()
            << " (was " << (old_osdmap ? old_osdmap->get_epoch() : 0) << ")"
 	   << dendl;
+  scheduler->consume_map(*new_osdmap);
   int queued = 0;
 
   // check slots
@@ -10667,13 +10805,24 @@ void OSD::ShardedOpWQ::_add_slot_waiter(
   }
 }
 
+namespace {
+bool is_txn_batchable(const OpSchedulerItem& qi)
+{
+  if (qi.get_op_type() != OpSchedulerItem::op_type_t::client_op) {
+    return false;
+  }
+  std::optional<OpRequestRef> op = qi.maybe_get_op();
+  return op && (*op)->get_req()->get_type() == CEPH_MSG_OSD_OP;
+}
+}
+
 #undef dout_prefix
 #define dout_prefix *_dout << "osd." << osd->whoami << " op_wq(" << shard_index << ") "
 
 void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
 {
   uint32_t shard_index = thread_index % osd->num_shards;
-  auto& sdata = osd->shards[shard_index];
+  OSDShard *sdata = osd->shards[shard_index];
   ceph_assert(sdata);
 
   // If all threads of shards do oncommits, there is a out-of-order
@@ -10682,9 +10831,27 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   // callback.
   bool is_smallest_thread_index = thread_index < osd->num_shards;
 
+  // With nothing to do on our own shard, run an item for a backlogged
+  // one instead.  The item goes through the victim's pg slot exactly as
+  // if one of its own threads had dequeued it, so per-PG ordering is
+  // unchanged; we never run the victim's oncommits.
+  bool stolen = false;
+  if (osd->cct->_conf->osd_op_shard_work_stealing) {
+    if (OSDShard *victim = _steal_victim(sdata, is_smallest_thread_index)) {
+      dout(20) << __func__ << " shard " << shard_index << " idle, stealing from "
+	       << victim->shard_id << dendl;
+      sdata = victim;
+      is_smallest_thread_index = false;
+      stolen = true;
+    }
+  }
+
   // peek at spg_t
-  sdata->shard_lock.lock();
-  if (sdata->scheduler->empty() &&
+  if (!stolen) {
+    sdata->shard_lock.lock();
+  }
+  if (!stolen &&
+      sdata->scheduler->empty() &&
       (!is_smallest_thread_index || sdata->context_queue.empty())) {
     std::unique_lock wait_lock{sdata->sdata_wait_lock};
     if (is_smallest_thread_index && !sdata->context_queue.empty()) {
@@ -10694,7 +10861,9 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
       dout(20) << __func__ << " empty q, waiting" << dendl;
       osd->cct->get_heartbeat_map()->clear_timeout(hb);
       sdata->shard_lock.unlock();
+      ++sdata->idle_threads;
       sdata->sdata_cond.wait(wait_lock);
+      --sdata->idle_threads;
       wait_lock.unlock();
       sdata->shard_lock.lock();
       if (sdata->scheduler->empty() &&
@@ -10747,6 +10916,11 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
     // If the work item is scheduled in the future, wait until
     // the time returned in the dequeue response before retrying.
     if (auto when_ready = std::get_if<double>(&work_item)) {
+      if (stolen) {
+	// the victim's own threads will wait for it
+	sdata->shard_lock.unlock();
+	return;
+      }
       if (is_smallest_thread_index) {
         sdata->shard_lock.unlock();
         handle_oncommits(oncommits);
@@ -10776,6 +10950,9 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
 
   // Access the stored item
   auto item = std::move(std::get<OpSchedulerItem>(work_item));
+  if (stolen) {
+    osd->logger->inc(l_osd_op_wq_steal);
+  }
   if (osd->is_stopping()) {
     sdata->shard_lock.unlock();
     for (auto c : oncommits) {
@@ -10992,7 +11169,15 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   delete f;
   *_dout << dendl;
 
-  qi.run(osd, sdata, pg, tp_handle);
+  if (pg && osd->cct->_conf->osd_op_txn_batch_max > 1 &&
+      is_txn_batchable(qi)) {
+    _run_txn_batch(sdata, token, pg, std::move(qi), tp_handle);
+  } else {
+    auto cost = qi.get_cost();
+    auto start = ceph::mono_clock::now();
+    qi.run(osd, sdata, pg, tp_handle);
+    sdata->scheduler->note_service_time(cost, ceph::mono_clock::now() - start);
+  }
 
   {
 #ifdef WITH_LTTNG
@@ -11008,6 +11193,89 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   handle_oncommits(oncommits);
 }
 
+void OSD::ShardedOpWQ::_run_txn_batch(
+  OSDShard *sdata,
+  spg_t token,
+  PGRef& pg,
+  OpSchedulerItem&& first,
+  ThreadPool::TPHandle &handle)
+{
+  // Other threads that dequeued ops for this pg while we held its lock
+  // parked them on the slot and are blocked on the pg lock.  Run those
+  // here instead; they find the slot empty once they get the lock and
+  // go back to the scheduler.
+  const uint32_t shard_index = sdata->shard_id;
+  const uint64_t max = osd->cct->_conf->osd_op_txn_batch_max;
+  pg->begin_txn_batch();
+  osd->dequeue_op(pg, *first.maybe_get_op(), handle);
+  for (uint64_t n = 1; n < max; ++n) {
+    std::optional<OpRequestRef> op;
+    {
+      std::lock_guard l{sdata->shard_lock};
+      auto q = sdata->pg_slots.find(token);
+      if (q == sdata->pg_slots.end()) {
+	break;
+      }
+      OSDShardPGSlot *slot = q->second.get();
+      if (slot->pg != pg ||
+	  slot->to_process.empty() ||
+	  !is_txn_batchable(slot->to_process.front())) {
+	break;
+      }
+      op = slot->to_process.front().maybe_get_op();
+      slot->to_process.pop_front();
+    }
+    dout(20) << __func__ << " " << token << " batching " << *(*op)->get_req() << dendl;
+    handle.reset_tp_timeout();
+    osd->dequeue_op(pg, *op, handle);
+  }
+  pg->end_txn_batch();
+  pg->unlock();
+}
+
+OSDShard *OSD::ShardedOpWQ::_steal_victim(OSDShard *home,
+					  bool is_smallest_thread_index)
+{
+  {
+    std::lock_guard l{home->shard_lock};
+    if (!home->scheduler->empty() ||
+	(is_smallest_thread_index && !home->context_queue.empty())) {
+      return nullptr;
+    }
+  }
+  const uint32_t n = osd->num_shards;
+  for (uint32_t i = 1; i < n; ++i) {
+    OSDShard *victim = osd->shards[(home->shard_id + i) % n];
+    // a shard with a parked thread of its own is not overloaded
+    if (victim->idle_threads > 0) {
+      continue;
+    }
+    if (!victim->shard_lock.try_lock()) {
+      continue;
+    }
+    if (!victim->scheduler->empty()) {
+      return victim;
+    }
+    victim->shard_lock.unlock();
+  }
+  return nullptr;
+}
+
+void OSD::ShardedOpWQ::_wake_thief(OSDShard *busy)
+{
+  const uint32_t n = osd->num_shards;
+  for (uint32_t i = 1; i < n; ++i) {
+    OSDShard *idle = osd->shards[(busy->shard_id + i) % n];
+    if (idle->idle_threads == 0) {
+      continue;
+    }
+    std::lock_guard l{idle->sdata_wait_lock};
+    idle->sdata_cond.notify_one();
+    osd->logger->inc(l_osd_op_wq_steal_wake);
+    return;
+  }
+}
+
 void OSD::ShardedOpWQ::_enqueue(OpSchedulerItem&& item) {
   if (unlikely(m_fast_shutdown) ) {
     // stop enqueing when we are in the middle of a fast shutdown
@@ -11040,6 +11308,12 @@ void OSD::ShardedOpWQ::_enqueue(OpSchedulerItem&& item) {
       sdata->sdata_cond.notify_one();
     }
   }
+
+  // items are piling up behind busy threads; let an idle shard help
+  if (!empty && sdata->idle_threads == 0 &&
+      osd->cct->_conf->osd_op_shard_work_stealing) {
+    _wake_thief(sdata);
+  }
 }
 
 void OSD::ShardedOpWQ::_enqueue_front(OpSchedulerItem&& item)
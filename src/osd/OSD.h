@@ -40,6 +40,7 @@
 
 #include "osd/scheduler/OpScheduler.h"
 
+#include <array>
 #include <atomic>
 #include <map>
 #include <memory>
@@ -510,7 +511,7 @@ public:
 
   AsyncReserver<spg_t, Finisher> snap_reserver;
   void queue_recovery_context(PG *pg, GenContext<ThreadPool::TPHandle&> *c);
-  void queue_for_snap_trim(PG *pg);
+  void queue_for_snap_trim(PG *pg, uint64_t cost_bytes = 0);
   void queue_for_scrub(PG* pg, Scrub::scrub_prio_t with_priority);
 
   void queue_scrub_after_repair(PG* pg, Scrub::scrub_prio_t with_priority);
@@ -671,6 +672,23 @@ public:
   SimpleLRU<epoch_t, ceph::buffer::list> map_bl_cache;
   SimpleLRU<epoch_t, ceph::buffer::list> map_bl_inc_cache;
 
+  // epoch-indexed window over the most recently added maps, so that the
+  // common lookup of a recent epoch from the op shards does not have to
+  // take map_cache_lock.  Slots are replaced with std::atomic_store (see
+  // _osdmap below); a slot only answers for the epoch it actually holds.
+  static constexpr unsigned MAP_RING_SIZE = 32;
+  std::array<OSDMapRef, MAP_RING_SIZE> map_ring;
+  epoch_t map_ring_newest = 0;  ///< protected by map_cache_lock
+  OSDMapRef _ring_lookup(epoch_t e) const {
+    OSDMapRef m = std::atomic_load(&map_ring[e % MAP_RING_SIZE]);
+    if (m && m->get_epoch() == e) {
+      return m;
+    }
+    return OSDMapRef();
+  }
+  void _ring_insert(const OSDMapRef& m);   ///< map_cache_lock must be held
+  void _ring_clear();
+
   OSDMapRef try_get_map(epoch_t e);
   OSDMapRef get_map(epoch_t e) {
     OSDMapRef ret(try_get_map(e));
@@ -964,6 +982,8 @@ struct OSDShard {
   ceph::mutex sdata_wait_lock;
   ceph::condition_variable sdata_cond;
   int waiting_threads = 0;
+  /// threads parked on an empty queue; candidates for work stealing
+  std::atomic<int> idle_threads = {0};
 
   ceph::mutex osdmap_lock;  ///< protect shard_osdmap updates vs users w/o shard_lock
   OSDMapRef shard_osdmap;
@@ -1573,6 +1593,20 @@ protected:
     /// try to do some work
     void _process(uint32_t thread_index, ceph::heartbeat_handle_d *hb) override;
 
+    /// find a backlogged shard to help out; returns it with shard_lock held
+    OSDShard *_steal_victim(OSDShard *home, bool is_smallest_thread_index);
+    /// kick an idle thread of another shard so it can steal from @p busy
+    void _wake_thief(OSDShard *busy);
+
+    /// run @p first and any client ops queued behind it on the same pg
+    /// slot under one pg lock hold, group-committing their transactions
+    void _run_txn_batch(
+      OSDShard *sdata,
+      spg_t token,
+      PGRef& pg,
+      OpSchedulerItem&& first,
+      ThreadPool::TPHandle &handle);
+
     void stop_for_fast_shutdown();
 
     /// enqueue a new item
@@ -1765,6 +1799,7 @@ protected:
   void resume_creating_pg();
 
   void load_pgs();
+  void _load_pgs_read_state(const std::vector<PGRef>& pgs);
 
   epoch_t last_pg_create_epoch;
 
@@ -2000,7 +2035,8 @@ private:
                          int64_t osize,
                          int64_t onum,
                          double *elapsed,
-                         std::ostream& ss);
+                         std::ostream& ss,
+                         std::vector<double> *commit_lat = nullptr);
   void mon_cmd_set_config(const std::string &key, const std::string &val);
   bool unsupported_objstore_for_qos();
 
@@ -2605,7 +2605,8 @@ void OSDMap::_remove_nonexistent_osds(const pg_pool_t& pool,
 void OSDMap::_pg_to_raw_osds(
   const pg_pool_t& pool, pg_t pg,
   vector<int> *osds,
-  ps_t *ppps) const
+  ps_t *ppps,
+  CrushWrapper::Workspace *ws) const
 {
   // map to osds[]
   ps_t pps = pool.raw_pg_to_pps(pg);  // placement ps
@@ -2613,8 +2614,12 @@ void OSDMap::_pg_to_raw_osds(
 
   // what crush rule?
   int ruleno = pool.get_crush_rule();
-  if (ruleno >= 0)
-    crush->do_rule(ruleno, pps, *osds, size, osd_weight, pg.pool());
+  if (ruleno >= 0) {
+    if (ws)
+      crush->do_rule(ruleno, pps, *osds, size, osd_weight, pg.pool(), *ws);
+    else
+      crush->do_rule(ruleno, pps, *osds, size, osd_weight, pg.pool());
+  }
 
   _remove_nonexistent_osds(pool, *osds);
 
@@ -2858,7 +2863,8 @@ void OSDMap::pg_to_raw_up(pg_t pg, vector<int> *up, int *primary) const
 void OSDMap::_pg_to_up_acting_osds(
   const pg_t& pg, vector<int> *up, int *up_primary,
   vector<int> *acting, int *acting_primary,
-  bool raw_pg_to_pg) const
+  bool raw_pg_to_pg,
+  CrushWrapper::Workspace *ws) const
 {
   const pg_pool_t *pool = get_pg_pool(pg.pool());
   if (!pool ||
@@ -2881,7 +2887,7 @@ void OSDMap::_pg_to_up_acting_osds(
   ps_t pps;
   _get_temp_osds(*pool, pg, &_acting, &_acting_primary);
   if (_acting.empty() || up || up_primary) {
-    _pg_to_raw_osds(*pool, pg, &raw, &pps);
+    _pg_to_raw_osds(*pool, pg, &raw, &pps, ws);
     _apply_upmap(*pool, pg, &raw);
     _raw_to_up_osds(*pool, raw, &_up);
     _up_primary = _pick_primary(_up);
@@ -4959,7 +4965,7 @@ int OSDMap::calc_pg_upmaps(
 
   float stddev = 0;
   map<int,float> osd_deviation;       // osd, deviation(pgs)
-  multimap<float,int> deviation_osd;  // deviation(pgs), osd
+  deviation_osd_t deviation_osd;      // deviation(pgs), osd
   float cur_max_deviation = calc_deviations(cct, pgs_by_osd, osd_weight, pgs_per_weight,
 				      	    osd_deviation, deviation_osd, stddev);
 
@@ -4977,9 +4983,21 @@ int OSDMap::calc_pg_upmaps(
     cct->_conf.get_val<bool>("osd_calc_pg_upmaps_aggressively_fast");
   auto local_fallback_retries =
     cct->_conf.get_val<uint64_t>("osd_calc_pg_upmaps_local_fallback_retries");
-    
+  auto max_time =
+    cct->_conf.get_val<std::chrono::seconds>("osd_calc_pg_upmaps_max_time");
+  auto deadline = ceph::mono_clock::now() + max_time;
+
+  // edits to pgs_by_osd and osd_deviation made by the change being tested
+  pg_moves_t moves;
+  map<int,std::optional<float>> old_osd_deviation;
+
   while (max--) {
     ldout(cct, 30) << "Top of loop #" << max+1 << dendl;
+    if (max_time.count() && ceph::mono_clock::now() >= deadline) {
+      ldout(cct, 10) << __func__ << " break due to osd_calc_pg_upmaps_max_time "
+                     << max_time << dendl;
+      break;
+    }
     // build overfull and underfull
     set<int> overfull;
     set<int> more_overfull;
@@ -5015,7 +5033,7 @@ int OSDMap::calc_pg_upmaps(
 
     set<pg_t> to_unmap;
     map<pg_t, mempool::osdmap::vector<pair<int32_t,int32_t>>> to_upmap;
-    auto temp_pgs_by_osd = pgs_by_osd;
+    ceph_assert(moves.empty());
     // always start with fullest, break if we find any changes to make
     for (auto p = deviation_osd.rbegin(); p != deviation_osd.rend(); ++p) {
       if (skip_overfull && !underfull.empty()) {
@@ -5064,7 +5082,7 @@ int OSDMap::calc_pg_upmaps(
       }
       // look for remaps we can un-remap
       if (try_drop_remap_overfull(cct, pgs, tmp_osd_map, osd,
-				  temp_pgs_by_osd, to_unmap, to_upmap))
+				  pgs_by_osd, moves, to_unmap, to_upmap))
 	goto test_change;
 
       // try upmap
@@ -5122,7 +5140,7 @@ int OSDMap::calc_pg_upmaps(
           // definitely make distribution of PGs converging to
           // the perfect status.
 	  add_remap_pair(cct, orig[pos], out[pos], pg, (size_t)pg_pool_size, 
-	  		 osd, existing, temp_pgs_by_osd,
+	  		 osd, existing, pgs_by_osd, moves,
 			 new_upmap_items, to_upmap);
           goto test_change;
 	}
@@ -5160,7 +5178,7 @@ int OSDMap::calc_pg_upmaps(
       // look for remaps we can un-remap
       candidates_t candidates = build_candidates(cct, tmp_osd_map, to_skip,
       						 only_pools, aggressive, p_seed);
-      if (try_drop_remap_underfull(cct, candidates, osd, temp_pgs_by_osd,
+      if (try_drop_remap_underfull(cct, candidates, osd, pgs_by_osd, moves,
           to_unmap, to_upmap)) {
 	goto test_change;
       }
@@ -5189,13 +5207,21 @@ int OSDMap::calc_pg_upmaps(
     // test change, apply if change is good
     ceph_assert(to_unmap.size() || to_upmap.size());
     float new_stddev = 0;
-    map<int,float> temp_osd_deviation;
-    multimap<float,int> temp_deviation_osd;
-    float cur_max_deviation = calc_deviations(cct, temp_pgs_by_osd, osd_weight,
-    					      pgs_per_weight, temp_osd_deviation,
-					      temp_deviation_osd, new_stddev);
+    float cur_max_deviation = update_deviations(cct, pgs_by_osd, osd_weight,
+						pgs_per_weight, moves,
+						osd_deviation, old_osd_deviation,
+						new_stddev);
     ldout(cct, 10) << " stddev " << stddev << " -> " << new_stddev << dendl;
     if (new_stddev >= stddev) {
+      // roll back
+      moves.undo(pgs_by_osd);
+      for (auto& [oid, odev] : old_osd_deviation) {
+        if (odev)
+          osd_deviation[oid] = *odev;
+        else
+          osd_deviation.erase(oid);
+      }
+      old_osd_deviation.clear();
       if (!aggressive) {
         ldout(cct, 10) << " break because stddev is not decreasing"
                        << " and aggressive mode is not enabled"
@@ -5226,9 +5252,15 @@ int OSDMap::calc_pg_upmaps(
     // ready to go
     ceph_assert(new_stddev < stddev);
     stddev = new_stddev;
-    pgs_by_osd = temp_pgs_by_osd;
-    osd_deviation = temp_osd_deviation;
-    deviation_osd = temp_deviation_osd;
+    for (auto& [oid, odev] : old_osd_deviation) {
+      if (odev)
+        deviation_osd.erase(make_pair(*odev, oid));
+      auto p = osd_deviation.find(oid);
+      if (p != osd_deviation.end())
+        deviation_osd.insert(make_pair(p->second, oid));
+    }
+    old_osd_deviation.clear();
+    moves.clear();
     n_changes++;
 
 
@@ -5368,7 +5400,7 @@ float OSDMap::calc_deviations (
   const map<int,float>& osd_weight,
   float pgs_per_weight,
   map<int,float>& osd_deviation,
-  multimap<float,int>& deviation_osd,
+  deviation_osd_t& deviation_osd,
   float& stddev)  // return current max deviation
 {
   //
@@ -5401,9 +5433,106 @@ float OSDMap::calc_deviations (
   return cur_max_deviation;
 }
 
+float OSDMap::update_deviations (
+  CephContext *cct,
+  const map<int,set<pg_t>>& pgs_by_osd,
+  const map<int,float>& osd_weight,
+  float pgs_per_weight,
+  const pg_moves_t& moves,
+  map<int,float>& osd_deviation,
+  map<int,std::optional<float>>& old_osd_deviation,
+  float& stddev)  // return new max deviation
+{
+  //
+  // Incremental version of calc_deviations: recompute the deviation of the
+  // OSDs touched by <moves> only, saving their previous values in
+  // old_osd_deviation so the caller can either roll them back or apply them to
+  // deviation_osd.  stddev and the max deviation are then summed over
+  // osd_deviation, which has the same keys and order as pgs_by_osd, so the
+  // result is identical to what calc_deviations would return.
+  //
+  for (auto oid : moves.get_osds()) {
+    auto p = osd_deviation.find(oid);
+    if (p != osd_deviation.end()) {
+      old_osd_deviation.emplace(oid, p->second);
+    } else {
+      old_osd_deviation.emplace(oid, std::nullopt);
+    }
+    auto q = pgs_by_osd.find(oid);
+    ceph_assert(q != pgs_by_osd.end());
+    // make sure osd is still there (belongs to this crush-tree)
+    ceph_assert(osd_weight.count(oid));
+    float target = osd_weight.at(oid) * pgs_per_weight;
+    float deviation = (float)q->second.size() - target;
+    ldout(cct, 20) << " osd." << oid
+                   << "\tpgs " << q->second.size()
+                   << "\ttarget " << target
+                   << "\tdeviation " << deviation
+                   << dendl;
+    osd_deviation[oid] = deviation;
+  }
+  ceph_assert(osd_deviation.size() == pgs_by_osd.size());
+
+  float cur_max_deviation = 0.0;
+  stddev = 0.0;
+  for (auto& [oid, deviation] : osd_deviation) {
+    stddev += deviation * deviation;
+    if (fabsf(deviation) > cur_max_deviation)
+      cur_max_deviation = fabsf(deviation);
+  }
+  return cur_max_deviation;
+}
+
+void OSDMap::pg_moves_t::move(
+  map<int,set<pg_t>>& pgs_by_osd,
+  pg_t pg,
+  int from,
+  int to)
+{
+  auto [f, f_created] = pgs_by_osd.try_emplace(from);
+  if (f_created)
+    ops.emplace_back(CREATED, from, pg);
+  if (f->second.erase(pg))
+    ops.emplace_back(ERASED, from, pg);
+  auto [t, t_created] = pgs_by_osd.try_emplace(to);
+  if (t_created)
+    ops.emplace_back(CREATED, to, pg);
+  if (t->second.insert(pg).second)
+    ops.emplace_back(INSERTED, to, pg);
+}
+
+void OSDMap::pg_moves_t::undo(map<int,set<pg_t>>& pgs_by_osd)
+{
+  for (auto i = ops.rbegin(); i != ops.rend(); ++i) {
+    auto& [op, osd, pg] = *i;
+    switch (op) {
+    case ERASED:
+      pgs_by_osd[osd].insert(pg);
+      break;
+    case INSERTED:
+      pgs_by_osd[osd].erase(pg);
+      break;
+    case CREATED:
+      ceph_assert(pgs_by_osd[osd].empty());
+      pgs_by_osd.erase(osd);
+      break;
+    }
+  }
+  ops.clear();
+}
+
+set<int> OSDMap::pg_moves_t::get_osds() const
+{
+  set<int> osds;
+  for (auto& [op, osd, pg] : ops) {
+    osds.insert(osd);
+  }
+  return osds;
+}
+
 void OSDMap::fill_overfull_underfull (
   CephContext *cct,
-  const std::multimap<float,int>& deviation_osd,
+  const deviation_osd_t& deviation_osd,
   int max_deviation,
   std::set<int>& overfull,
   std::set<int>& more_overfull,
@@ -5506,14 +5635,16 @@ bool OSDMap::try_drop_remap_overfull(
   const std::vector<pg_t>& pgs,
   const OSDMap& tmp_osd_map,
   int osd,
-  map<int,std::set<pg_t>>& temp_pgs_by_osd,
+  map<int,std::set<pg_t>>& pgs_by_osd,
+  pg_moves_t& moves,
   set<pg_t>& to_unmap,
   map<pg_t, mempool::osdmap::vector<pair<int32_t,int32_t>>>& to_upmap)
 {
   //
   // This function tries to drop existimg upmap items which map data to overfull 
-  // OSDs. It updates temp_pgs_by_osd, to_unmap and to_upmap and rerturns true 
-  // if it found an item that can be dropped, false if not. 
+  // OSDs. It updates pgs_by_osd (recording the edits in moves), to_unmap and
+  // to_upmap and returns true if it found an item that can be dropped, false
+  // if not.
   //
   for (auto pg : pgs) {
     auto p = tmp_osd_map.pg_upmap_items.find(pg);
@@ -5531,8 +5662,7 @@ bool OSDMap::try_drop_remap_overfull(
                        << " which remapped " << pg
                        << " into overfull osd." << osd
                        << dendl;
-        temp_pgs_by_osd[um_to].erase(pg);
-        temp_pgs_by_osd[um_from].insert(pg);
+        moves.move(pgs_by_osd, pg, um_to, um_from);
         } else {
           new_upmap_items.push_back(um_pair);
         }
@@ -5563,14 +5693,16 @@ bool OSDMap::try_drop_remap_underfull(
     CephContext *cct,
     const candidates_t& candidates,
     int osd,
-    map<int,std::set<pg_t>>& temp_pgs_by_osd,
+    map<int,std::set<pg_t>>& pgs_by_osd,
+    pg_moves_t& moves,
     set<pg_t>& to_unmap,
     map<pg_t, mempool::osdmap::vector<std::pair<int32_t,int32_t>>>& to_upmap)
 {
   // 
   // This function tries to drop existimg upmap items which map data from underfull
-  // OSDs. It updates temp_pgs_by_osd, to_unmap and to_upmap and rerturns true 
-  // if it found an item that can be dropped, false if not. 
+  // OSDs. It updates pgs_by_osd (recording the edits in moves), to_unmap and
+  // to_upmap and returns true if it found an item that can be dropped, false
+  // if not.
   //
   for (auto& [pg, um_pairs] : candidates) {
     mempool::osdmap::vector<pair<int32_t,int32_t>> new_upmap_items;
@@ -5584,8 +5716,7 @@ bool OSDMap::try_drop_remap_underfull(
                        << " which remapped " << pg
                        << " out from underfull osd." << osd
                        << dendl;
-        temp_pgs_by_osd[um_to].erase(pg);
-        temp_pgs_by_osd[um_from].insert(pg);
+        moves.move(pgs_by_osd, pg, um_to, um_from);
       } else {
         new_upmap_items.push_back(ump);
       }
@@ -5622,7 +5753,8 @@ void OSDMap::add_remap_pair(
   size_t pg_pool_size,
   int osd,
   set<int>& existing,
-  map<int,set<pg_t>>& temp_pgs_by_osd,
+  map<int,set<pg_t>>& pgs_by_osd,
+  pg_moves_t& moves,
   mempool::osdmap::vector<pair<int32_t,int32_t>> new_upmap_items,
   map<pg_t, mempool::osdmap::vector<pair<int32_t,int32_t>>>& to_upmap) 
 {
@@ -5636,8 +5768,7 @@ void OSDMap::add_remap_pair(
                  << dendl;
   existing.insert(orig);
   existing.insert(out);
-  temp_pgs_by_osd[orig].erase(pg);
-  temp_pgs_by_osd[out].insert(pg);
+  moves.move(pgs_by_osd, pg, orig, out);
   ceph_assert(new_upmap_items.size() < pg_pool_size);
   new_upmap_items.push_back(make_pair(orig, out));
   // append new remapping pairs slowly
@@ -5653,7 +5784,7 @@ int OSDMap::find_best_remap (
   const vector<int>& orig,
   const vector<int>& out,
   const set<int>& existing,
-  const map<int,float> osd_deviation) 
+  const map<int,float>& osd_deviation)
 {
   //
   // Find the best remap from the suggestions in orig and out - the best remap 
@@ -29,6 +29,8 @@
 #include <set>
 #include <map>
 #include <memory>
+#include <optional>
+#include <tuple>
 
 #include <boost/smart_ptr/local_shared_ptr.hpp>
 #include "include/btree_map.h"
@@ -1206,7 +1208,8 @@ private:
   void _pg_to_raw_osds(
     const pg_pool_t& pool, pg_t pg,
     std::vector<int> *osds,
-    ps_t *ppps) const;
+    ps_t *ppps,
+    CrushWrapper::Workspace *ws = nullptr) const;
   int _pick_primary(const std::vector<int>& osds) const;
   void _remove_nonexistent_osds(const pg_pool_t& pool, std::vector<int>& osds) const;
 
@@ -1235,7 +1238,8 @@ private:
    */
   void _pg_to_up_acting_osds(const pg_t& pg, std::vector<int> *up, int *up_primary,
                              std::vector<int> *acting, int *acting_primary,
-			     bool raw_pg_to_pg = true) const;
+			     bool raw_pg_to_pg = true,
+			     CrushWrapper::Workspace *ws = nullptr) const;
 
 public:
   /***
@@ -1271,6 +1275,14 @@ public:
                             std::vector<int> *acting, int *acting_primary) const {
     _pg_to_up_acting_osds(pg, up, up_primary, acting, acting_primary);
   }
+  /// as above, reusing ws for the crush computation; see
+  /// CrushWrapper::Workspace.  For mapping many pgs in a row.
+  void pg_to_up_acting_osds(pg_t pg, std::vector<int> *up, int *up_primary,
+                            std::vector<int> *acting, int *acting_primary,
+			    CrushWrapper::Workspace& ws) const {
+    _pg_to_up_acting_osds(pg, up, up_primary, acting, acting_primary, true,
+			  &ws);
+  }
   void pg_to_up_acting_osds(pg_t pg, std::vector<int>& up, std::vector<int>& acting) const {
     int up_primary, acting_primary;
     pg_to_up_acting_osds(pg, &up, &up_primary, &acting, &acting_primary);
@@ -1490,19 +1502,52 @@ private:
     std::map<int,float>& osds_weight
   );  // return total weight of all OSDs
 
+  // (deviation, osd), ordered by deviation and then by osd id
+  typedef std::set<std::pair<float,int>> deviation_osd_t;
+
+  // The edits a candidate change makes to pgs_by_osd.  calc_pg_upmaps applies
+  // them in place and rolls them back if the change is rejected, rather than
+  // copying pgs_by_osd for every candidate.
+  struct pg_moves_t {
+    enum op_t { ERASED, INSERTED, CREATED };
+    std::vector<std::tuple<op_t, int, pg_t>> ops;  // op, osd, pg
+
+    void move(std::map<int,std::set<pg_t>>& pgs_by_osd,
+	      pg_t pg, int from, int to);
+    void undo(std::map<int,std::set<pg_t>>& pgs_by_osd);
+    std::set<int> get_osds() const;
+    bool empty() const {
+      return ops.empty();
+    }
+    void clear() {
+      ops.clear();
+    }
+  };
+
   float calc_deviations (
     CephContext *cct,
     const std::map<int,std::set<pg_t>>& pgs_by_osd,
     const std::map<int,float>& osd_weight,
     float pgs_per_weight,
     std::map<int,float>& osd_deviation,
-    std::multimap<float,int>& deviation_osd,
+    deviation_osd_t& deviation_osd,
     float& stddev
   );  // return current max deviation
 
+  float update_deviations (
+    CephContext *cct,
+    const std::map<int,std::set<pg_t>>& pgs_by_osd,
+    const std::map<int,float>& osd_weight,
+    float pgs_per_weight,
+    const pg_moves_t& moves,
+    std::map<int,float>& osd_deviation,
+    std::map<int,std::optional<float>>& old_osd_deviation,
+    float& stddev
+  );  // return new max deviation
+
   void fill_overfull_underfull (
     CephContext *cct,
-    const std::multimap<float,int>& deviation_osd,
+    const deviation_osd_t& deviation_osd,
     int max_deviation,
     std::set<int>& overfull,
     std::set<int>& more_overfull,
@@ -1528,7 +1573,8 @@ private:
     const std::vector<pg_t>& pgs,
     const OSDMap& tmp_osd_map,
     int osd,
-    std::map<int,std::set<pg_t>>& temp_pgs_by_osd,
+    std::map<int,std::set<pg_t>>& pgs_by_osd,
+    pg_moves_t& moves,
     std::set<pg_t>& to_unmap,
     std::map<pg_t, mempool::osdmap::vector<std::pair<int32_t,int32_t>>>& to_upmap
   );
@@ -1540,7 +1586,8 @@ bool try_drop_remap_underfull(
     CephContext *cct,
     const candidates_t& candidates,
     int osd,
-    std::map<int,std::set<pg_t>>& temp_pgs_by_osd,
+    std::map<int,std::set<pg_t>>& pgs_by_osd,
+    pg_moves_t& moves,
     std::set<pg_t>& to_unmap,
     std::map<pg_t, mempool::osdmap::vector<std::pair<int32_t,int32_t>>>& to_upmap
   );
@@ -1553,7 +1600,8 @@ bool try_drop_remap_underfull(
     size_t pg_pool_size,
     int osd,
     std::set<int>& existing,
-    std::map<int,std::set<pg_t>>& temp_pgs_by_osd,
+    std::map<int,std::set<pg_t>>& pgs_by_osd,
+    pg_moves_t& moves,
     mempool::osdmap::vector<std::pair<int32_t,int32_t>> new_upmap_items,
     std::map<pg_t, mempool::osdmap::vector<std::pair<int32_t,int32_t>>>& to_upmap
   );
@@ -1563,7 +1611,7 @@ bool try_drop_remap_underfull(
     const std::vector<int>& orig,
     const std::vector<int>& out,
     const std::set<int>& existing,
-    const std::map<int,float> osd_deviation
+    const std::map<int,float>& osd_deviation
   );
 
   candidates_t build_candidates(
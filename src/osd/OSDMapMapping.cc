@@ -8,6 +8,8 @@
 
 #include "common/debug.h"
 
+#include <set>
+
 using std::vector;
 
 MEMPOOL_DEFINE_OBJECT_FACTORY(OSDMapMapping, osdmapmapping,
@@ -114,17 +116,162 @@ void OSDMapMapping::_update_range(
   ceph_assert(i != pools.end());
   ceph_assert(pg_begin <= pg_end);
   ceph_assert(pg_end <= i->second.pg_num);
+  CrushWrapper::Workspace ws;
   for (unsigned ps = pg_begin; ps < pg_end; ++ps) {
     std::vector<int> up, acting;
     int up_primary, acting_primary;
     osdmap.pg_to_up_acting_osds(
       pg_t(ps, pool),
-      &up, &up_primary, &acting, &acting_primary);
+      &up, &up_primary, &acting, &acting_primary, ws);
     i->second.set(ps, std::move(up), up_primary,
 		  std::move(acting), acting_primary);
   }
 }
 
+void OSDMapMapping::_update_pgs(
+  const OSDMap& osdmap,
+  const std::vector<pg_t>& pgs)
+{
+  CrushWrapper::Workspace ws;
+  for (auto& pgid : pgs) {
+    auto i = pools.find(pgid.pool());
+    ceph_assert(i != pools.end());
+    ceph_assert(pgid.ps() < i->second.pg_num);
+    std::vector<int> up, acting;
+    int up_primary, acting_primary;
+    osdmap.pg_to_up_acting_osds(
+      pgid, &up, &up_primary, &acting, &acting_primary, ws);
+    i->second.set(pgid.ps(), std::move(up), up_primary,
+		  std::move(acting), acting_primary);
+  }
+}
+
+bool OSDMapMapping::_get_affected_pgs(
+  const OSDMap& osdmap,
+  const OSDMap::Incremental& inc,
+  std::vector<pg_t> *pgs) const
+{
+  if (epoch == 0 ||
+      inc.epoch != osdmap.get_epoch() ||
+      epoch + 1 != inc.epoch) {
+    return false;
+  }
+  // anything that changes what crush returns can move any pg
+  if (inc.fullmap.length() ||
+      inc.crush.length() ||
+      inc.new_max_osd >= 0 ||
+      !inc.new_weight.empty() ||
+      !inc.new_up_client.empty()) {
+    return false;
+  }
+
+  // osds whose pgs need remapping: those that went down or away, whose
+  // pgs we can find in the table, and those whose primary affinity
+  // changed.  An osd coming up or into existence may appear in pgs
+  // that do not list it today, so we cannot narrow that down.
+  std::set<int> osds;
+  for (auto& [osd, state] : inc.new_state) {
+    unsigned s = state ? state : CEPH_OSD_UP;
+    if (!(s & (CEPH_OSD_UP | CEPH_OSD_EXISTS))) {
+      continue;
+    }
+    if (osdmap.is_up(osd) ||
+	((s & CEPH_OSD_EXISTS) && osdmap.exists(osd))) {
+      return false;
+    }
+    osds.insert(osd);
+  }
+  for (auto& [osd, aff] : inc.new_primary_affinity) {
+    osds.insert(osd);
+  }
+
+  std::set<pg_t> affected;
+  const auto& new_pools = inc.new_pools;
+  auto add = [&](const pg_t& pgid) {
+    auto pool = osdmap.get_pg_pool(pgid.pool());
+    if (pool && pgid.ps() < pool->get_pg_num() &&
+	!new_pools.count(pgid.pool())) {
+      affected.insert(pgid);
+    }
+  };
+  for (auto& i : inc.new_pg_temp) {
+    add(i.first);
+  }
+  for (auto& i : inc.new_primary_temp) {
+    add(i.first);
+  }
+  for (auto& i : inc.new_pg_upmap) {
+    add(i.first);
+  }
+  for (auto& pgid : inc.old_pg_upmap) {
+    add(pgid);
+  }
+  for (auto& i : inc.new_pg_upmap_items) {
+    add(i.first);
+  }
+  for (auto& pgid : inc.old_pg_upmap_items) {
+    add(pgid);
+  }
+  for (auto& i : inc.new_pg_upmap_primary) {
+    add(i.first);
+  }
+  for (auto& pgid : inc.old_pg_upmap_primary) {
+    add(pgid);
+  }
+
+  if (!osds.empty()) {
+    for (auto& [poolid, pm] : pools) {
+      if (new_pools.count(poolid) || !osdmap.have_pg_pool(poolid)) {
+	continue;
+      }
+      const size_t row_size = pm.row_size();
+      for (unsigned ps = 0; ps < pm.pg_num; ++ps) {
+	const int32_t *row = &pm.table[row_size * ps];
+	bool hit = osds.count(row[0]) || osds.count(row[1]);
+	for (int i = 0; !hit && i < row[2]; ++i) {
+	  hit = osds.count(row[4 + i]);
+	}
+	for (int i = 0; !hit && i < row[3]; ++i) {
+	  hit = osds.count(row[4 + pm.size + i]);
+	}
+	if (hit) {
+	  affected.insert(pg_t(ps, poolid));
+	}
+      }
+    }
+  }
+
+  pgs->assign(affected.begin(), affected.end());
+  // pools that are new or changed are redone in full
+  for (auto& [poolid, pool] : new_pools) {
+    for (unsigned ps = 0; ps < pool.get_pg_num(); ++ps) {
+      pgs->push_back(pg_t(ps, poolid));
+    }
+  }
+  return true;
+}
+
+std::unique_ptr<OSDMapMapping::MappingJob> OSDMapMapping::start_update(
+  const OSDMap& map,
+  ParallelPGMapper& mapper,
+  unsigned pgs_per_item,
+  const OSDMap::Incremental *inc)
+{
+  // decide before the job resizes our tables for the new map
+  std::vector<pg_t> pgs;
+  bool partial = inc && _get_affected_pgs(map, *inc, &pgs);
+  std::unique_ptr<MappingJob> job(new MappingJob(&map, this));
+  if (!partial) {
+    mapper.queue(job.get(), pgs_per_item, {});
+  } else if (!pgs.empty()) {
+    mapper.queue(job.get(), pgs_per_item, pgs);
+  } else {
+    // nothing moved, but we are now current as of this epoch
+    job->complete();
+  }
+  return job;
+}
+
 // ---------------------------
 
 void ParallelPGMapper::Job::finish_one()
@@ -9,11 +9,10 @@
 #include <map>
 
 #include "osd/osd_types.h"
+#include "osd/OSDMap.h"
 #include "common/WorkQueue.h"
 #include "common/Cond.h"
 
-class OSDMap;
-
 /// work queue to perform work on batches of pgids on multiple CPUs
 class ParallelPGMapper {
 public:
@@ -271,6 +270,11 @@ private:
     const OSDMap& map,
     int64_t pool,
     unsigned pg_begin, unsigned pg_end);
+  void _update_pgs(const OSDMap& map, const std::vector<pg_t>& pgs);
+
+  bool _get_affected_pgs(const OSDMap& osdmap,
+			 const OSDMap::Incremental& inc,
+			 std::vector<pg_t> *pgs) const;
 
   void _build_rmap(const OSDMap& osdmap);
 
@@ -289,7 +293,9 @@ private:
       : Job(osdmap), mapping(m) {
       mapping->_start(*osdmap);
     }
-    void process(const std::vector<pg_t>& pgs) override {}
+    void process(const std::vector<pg_t>& pgs) override {
+      mapping->_update_pgs(*osdmap, pgs);
+    }
     void process(int64_t pool, unsigned ps_begin, unsigned ps_end) override {
       mapping->_update_range(*osdmap, pool, ps_begin, ps_end);
     }
@@ -348,14 +354,19 @@ public:
 
   void update(const OSDMap& map, pg_t pgid);
 
+  /**
+   * Bring the mapping up to date with @p map.
+   *
+   * If we are current as of the epoch before it and @p inc is the
+   * incremental that produced it, only the pgs that the incremental can
+   * have moved are recomputed; changes to crush, osd weights or osds
+   * coming up still remap everything.
+   */
   std::unique_ptr<MappingJob> start_update(
     const OSDMap& map,
     ParallelPGMapper& mapper,
-    unsigned pgs_per_item) {
-    std::unique_ptr<MappingJob> job(new MappingJob(&map, this));
-    mapper.queue(job.get(), pgs_per_item, {});
-    return job;
-  }
+    unsigned pgs_per_item,
+    const OSDMap::Incremental *inc = nullptr);
 
   epoch_t get_epoch() const {
     return epoch;
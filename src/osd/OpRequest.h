@@ -47,7 +47,7 @@ public:
   bool need_skip_promote() const { return op_info.need_skip_promote(); }
   bool allows_returnvec() const { return op_info.allows_returnvec(); }
 
-  std::vector<OpInfo::ClassInfo> classes() const {
+  const std::vector<OpInfo::ClassInfo>& classes() const {
     return op_info.get_classes();
   }
 
@@ -258,12 +258,27 @@ void PG::unlock() const
 {
   //generic_dout(0) << this << " " << info.pgid << " unlock" << dendl;
   ceph_assert(!recovery_state.debug_has_dirty_state());
+  ceph_assert(txn_batch.empty());
 #ifndef CEPH_DEBUG_MUTEX
   locked_by = {};
 #endif
   _lock.unlock();
 }
 
+void PG::submit_txn_batch()
+{
+  if (!txn_batch.empty()) {
+    dout(20) << __func__ << " " << txn_batch.size() << " transactions" << dendl;
+    if (txn_batch.size() > 1) {
+      osd->logger->inc(l_osd_op_txn_batched, txn_batch.size());
+    }
+    osd->store->queue_transactions(ch, txn_batch, txn_batch_op, NULL);
+    txn_batch.clear();
+  }
+  txn_batch_heads.clear();
+  txn_batch_op.reset();
+}
+
 std::ostream& PG::gen_prefix(std::ostream& out) const
 {
   OSDMapRef mapref = recovery_state.get_osdmap();
@@ -199,6 +199,26 @@ public:
 
   ObjectStore::CollectionHandle ch;
 
+  // -- group commit --
+  // While a batch is open (see OSD::ShardedOpWQ::_process) local
+  // transactions are collected instead of queued, and go to the store as a
+  // single submission.  Only ever open while the pg lock is held.
+  bool txn_batch_open = false;
+  std::vector<ObjectStore::Transaction> txn_batch;
+  std::set<hobject_t> txn_batch_heads;  ///< heads touched by ops in the batch
+  OpRequestRef txn_batch_op;
+
+  void begin_txn_batch() {
+    ceph_assert(!txn_batch_open);
+    txn_batch_open = true;
+  }
+  /// queue everything collected so far; the batch stays open
+  void submit_txn_batch();
+  void end_txn_batch() {
+    submit_txn_batch();
+    txn_batch_open = false;
+  }
+
   // -- methods --
   std::ostream& gen_prefix(std::ostream& out) const override;
   CephContext *get_cct() const override {
@@ -209,37 +209,37 @@ void PGBackend::rollback(
     void append(uint64_t old_size) override {
       ObjectStore::Transaction temp;
       pg->rollback_append(hoid, old_size, &temp);
-      temp.append(t);
+      temp.append(std::move(t));
       temp.swap(t);
     }
     void setattrs(map<string, std::optional<bufferlist> > &attrs) override {
       ObjectStore::Transaction temp;
       pg->rollback_setattrs(hoid, attrs, &temp);
-      temp.append(t);
+      temp.append(std::move(t));
       temp.swap(t);
     }
     void rmobject(version_t old_version) override {
       ObjectStore::Transaction temp;
       pg->rollback_stash(hoid, old_version, &temp);
-      temp.append(t);
+      temp.append(std::move(t));
       temp.swap(t);
     }
     void try_rmobject(version_t old_version) override {
       ObjectStore::Transaction temp;
       pg->rollback_try_stash(hoid, old_version, &temp);
-      temp.append(t);
+      temp.append(std::move(t));
       temp.swap(t);
     }
     void create() override {
       ObjectStore::Transaction temp;
       pg->rollback_create(hoid, &temp);
-      temp.append(t);
+      temp.append(std::move(t));
       temp.swap(t);
     }
     void update_snaps(const set<snapid_t> &snaps) override {
       ObjectStore::Transaction temp;
       pg->get_parent()->pgb_set_object_snap_mapping(hoid, snaps, &temp);
-      temp.append(t);
+      temp.append(std::move(t));
       temp.swap(t);
     }
     void rollback_extents(
@@ -247,7 +247,7 @@ void PGBackend::rollback(
       const vector<pair<uint64_t, uint64_t> > &extents) override {
       ObjectStore::Transaction temp;
       pg->rollback_extents(gen, extents, hoid, &temp);
-      temp.append(t);
+      temp.append(std::move(t));
       temp.swap(t);
     }
   };
@@ -255,7 +255,7 @@ void PGBackend::rollback(
   ceph_assert(entry.mod_desc.can_rollback());
   RollbackVisitor vis(entry.soid, this);
   entry.mod_desc.visit(&vis);
-  t->append(vis.t);
+  t->append(std::move(vis.t));
 }
 
 struct Trimmer : public ObjectModDesc::Visitor {
@@ -262,6 +262,13 @@ typedef std::shared_ptr<const OSDMap> OSDMapRef;
      virtual void schedule_recovery_work(
        GenContext<ThreadPool::TPHandle&> *c) = 0;
 
+     /// run c under the pg lock after delay seconds, unless the pg resets.
+     /// returns a handle for cancel_backend_timer(), nullptr if not queued
+     virtual Context *schedule_backend_timer(
+       double delay, Context *c) = 0;
+     /// drop a timer that has not fired yet; c is deleted without running
+     virtual void cancel_backend_timer(Context *handle) = 0;
+
      virtual pg_shard_t whoami_shard() const = 0;
      int whoami() const {
        return whoami_shard().osd;
@@ -873,7 +873,17 @@ void PGLog::_write_log_and_missing(
 		     << " write_from_dups=" << write_from_dups
 		     << " trimmed_dups.size()=" << trimmed_dups.size() << dendl;
   set<string> to_remove;
-  to_remove.swap(trimmed_dups);
+  if (!trimmed_dups.empty()) {
+    // dups are only ever trimmed from the old end, so the trimmed keys are
+    // one contiguous range; don't spell it out key by key
+    ldpp_dout(dpp, 10) << __func__ << " remove trimmed dups "
+		       << *trimmed_dups.begin() << " to "
+		       << *trimmed_dups.rbegin() << dendl;
+    t.omap_rmkeyrange(
+      coll, log_oid,
+      *trimmed_dups.begin(), *trimmed_dups.rbegin() + '\0');
+    trimmed_dups.clear();
+  }
   for (auto& t : trimmed) {
     string key = t.get_key_name();
     if (log_keys_debug) {
@@ -1405,14 +1405,20 @@ public:
     bool tolerate_divergent_missing_log,
     bool debug_verify_stored_missing = false
     ) {
-    return read_log_and_missing(
+    eversion_t dups_trim_to;
+    read_log_and_missing(
       cct, store, ch, pgmeta_oid, info,
       log, missing, oss,
       tolerate_divergent_missing_log,
       &clear_divergent_priors,
       this,
       (pg_log_debug ? &log_keys_debug : nullptr),
-      debug_verify_stored_missing);
+      debug_verify_stored_missing,
+      &dups_trim_to);
+    if (dups_trim_to != eversion_t()) {
+      // drop the on-disk keys of the dups we did not load
+      mark_dirty_to_dups(dups_trim_to);
+    }
   }
 
   template <typename missing_type>
@@ -1429,11 +1435,13 @@ public:
     bool *clear_divergent_priors = nullptr,
     const DoutPrefixProvider *dpp = nullptr,
     std::set<std::string> *log_keys_debug = nullptr,
-    bool debug_verify_stored_missing = false
+    bool debug_verify_stored_missing = false,
+    eversion_t *dups_trim_to = nullptr ///< [out] if set, keep only tracked dups
     ) {
     ldpp_dout(dpp, 10) << "read_log_and_missing coll " << ch->cid
 		       << " " << pgmeta_oid << dendl;
     size_t total_dups = 0;
+    size_t dropped_dups = 0;
 
     // legacy?
     struct stat st;
@@ -1498,6 +1506,14 @@ public:
 			      << dendl;
 	  }
 	  dups.push_back(dup);
+	  // Only the newest osd_pg_log_dups_tracked dups are ever consulted,
+	  // so don't hold an inflated backlog in memory while loading it;
+	  // the caller clears the older keys on the next write.
+	  if (dups_trim_to &&
+	      dups.size() > cct->_conf->osd_pg_log_dups_tracked) {
+	    dups.pop_front();
+	    ++dropped_dups;
+	  }
 	} else {
 	  pg_log_entry_t e;
 	  e.decode_with_checksum(bp);
@@ -1513,6 +1529,13 @@ public:
 	}
       }
     }
+    if (dropped_dups) {
+      ldpp_dout(dpp, 0) << "read_log_and_missing not loading " << dropped_dups
+			<< " dups beyond osd_pg_log_dups_tracked="
+			<< cct->_conf->osd_pg_log_dups_tracked
+			<< "; they will be removed" << dendl;
+      *dups_trim_to = dups.empty() ? eversion_t::max() : dups.front().version;
+    }
     if (info.pgid.is_no_shard()) {
       // replicated pool pg does not persist this key
       assert(on_disk_rollback_info_trimmed_to == eversion_t());
@@ -528,6 +528,29 @@ void PrimaryLogPG::schedule_recovery_work(
   osd->queue_recovery_context(this, c);
 }
 
+Context *PrimaryLogPG::schedule_backend_timer(double delay, Context *c)
+{
+  epoch_t e = get_osdmap_epoch();
+  PGRef pgref(this);
+  auto cb = new LambdaContext(
+    [this, pgref, e, c = std::unique_ptr<Context>(c)](int r) mutable {
+      std::scoped_lock locker{*this};
+      if (!pg_has_reset_since(e)) {
+	c.release()->complete(0);
+      }
+    });
+  std::lock_guard l{osd->sleep_lock};
+  return osd->sleep_timer.add_event_after(delay, cb);
+}
+
+void PrimaryLogPG::cancel_backend_timer(Context *handle)
+{
+  // once fired the event is no longer found here, and the callback will
+  // find its work gone when it gets the pg lock
+  std::lock_guard l{osd->sleep_lock};
+  osd->sleep_timer.cancel_event(handle);
+}
+
 void PrimaryLogPG::replica_clear_repop_obc(
   const vector<pg_log_entry_t> &logv,
   ObjectStore::Transaction &t)
@@ -1759,6 +1782,12 @@ PrimaryLogPG::PrimaryLogPG(OSDService *o, OSDMapRef curmap,
     pgbackend->get_is_recoverable_predicate());
   snap_trimmer_machine.initiate();
 
+  // keep frequently used object contexts (e.g. bucket index or directory
+  // objects) from being pushed out by streams of objects used only once
+  object_contexts.set_hot_size(
+    cct->_conf->osd_pg_object_context_cache_count *
+    cct->_conf->osd_pg_object_context_cache_hot_ratio);
+
   m_scrubber = make_unique<PrimaryLogScrub>(this);
 }
 
@@ -1991,6 +2020,23 @@ void PrimaryLogPG::do_op(OpRequestRef& op)
 
   const hobject_t head = m->get_hobj().get_head();
 
+  if (txn_batch_open) {
+    // reads go to the store, so anything this op may read must not be
+    // sitting in the unsubmitted batch
+    bool conflict = m->has_flag(CEPH_OSD_FLAG_PGOP) ||
+      txn_batch_heads.count(head);
+    for (auto& osd_op : m->ops) {
+      if (osd_op.op.op == CEPH_OSD_OP_COPY_FROM ||
+	  osd_op.op.op == CEPH_OSD_OP_COPY_FROM2) {
+	conflict = true;
+      }
+    }
+    if (conflict) {
+      submit_txn_batch();
+    }
+    txn_batch_heads.insert(head);
+  }
+
   if (!info.pgid.pgid.contains(
 	info.pgid.pgid.get_split_bits(pool.info.get_pg_num()), head)) {
     derr << __func__ << " " << info.pgid.pgid << " does not contain "
@@ -2360,6 +2406,9 @@ void PrimaryLogPG::do_op(OpRequestRef& op)
     }
     if (!op->hitset_inserted) {
       hit_set->insert(oid);
+      if (access_sketch) {
+	access_sketch->add(std::hash<hobject_t>{}(oid));
+      }
       op->hitset_inserted = true;
       if (hit_set->is_full() ||
           hit_set_start_stamp + pool.info.hit_set_period <= m->get_recv_stamp()) {
@@ -4312,7 +4361,9 @@ void PrimaryLogPG::execute_ctx(OpContext *ctx)
   // no need to capture PG ref, repop cancel will handle that
   // Can capture the ctx by pointer, it's owned by the repop
   ctx->register_on_commit(
-    [m, ctx, this](){
+    [m, ctx, this, submitted = ceph_clock_now()](){
+      // store submit, kv commit and replica acks
+      osd->logger->tinc(l_osd_op_commit_lat, ceph_clock_now() - submitted);
       if (ctx->op)
 	log_op_stats(*ctx->op, ctx->bytes_written, ctx->bytes_read);
 
@@ -5827,7 +5878,15 @@ int PrimaryLogPG::do_read(OpContext *ctx, OSDOp& osd_op) {
 
     ctx->op_finishers[ctx->current_osd_subop_num].reset(
       new ReadFinisher(osd_op));
+  } else if (auto recent = find_recent_read(
+	       ctx, op.extent.offset, op.extent.length); recent) {
+    osd_op.outdata.append(*recent);
+    op.extent.length = recent->length();
+    osd->logger->inc(l_osd_op_r_coalesced);
+    dout(10) << " read of " << op.extent.length << " bytes from obj " << soid
+	     << " shared with a recent one" << dendl;
   } else {
+    const uint64_t requested_length = op.extent.length;
     int r = pgbackend->objects_read_sync(
       soid, op.extent.offset, op.extent.length, op.flags, &osd_op.outdata);
     // whole object?  can we verify the checksum?
@@ -5845,9 +5904,11 @@ int PrimaryLogPG::do_read(OpContext *ctx, OSDOp& osd_op) {
     if (r == -EIO) {
       r = rep_repair_primary_object(soid, ctx);
     }
-    if (r >= 0)
+    if (r >= 0) {
       op.extent.length = r;
-    else if (r == -EAGAIN) {
+      note_recent_read(ctx, op.extent.offset, requested_length,
+		       osd_op.outdata);
+    } else if (r == -EAGAIN) {
       result = -EAGAIN;
     } else {
       result = r;
@@ -5863,6 +5924,69 @@ int PrimaryLogPG::do_read(OpContext *ctx, OSDOp& osd_op) {
   return result;
 }
 
+const bufferlist *PrimaryLogPG::find_recent_read(
+  OpContext *ctx, uint64_t off, uint64_t len)
+{
+  if (recent_reads.empty() || !ctx->op || ctx->op->may_write()) {
+    // a read following a write in the same op must see that write
+    return nullptr;
+  }
+  const auto& oi = ctx->new_obs.oi;
+  auto p = recent_reads.find(recent_read_key_t{oi.soid, off, len});
+  if (p == recent_reads.end()) {
+    return nullptr;
+  }
+  const double window = cct->_conf->osd_read_coalesce_window;
+  if (p->second.version != oi.version ||
+      p->second.stamp + window < ceph_clock_now()) {
+    recent_reads_bytes -= p->second.data.length();
+    recent_reads.erase(p);
+    return nullptr;
+  }
+  return &p->second.data;
+}
+
+void PrimaryLogPG::note_recent_read(
+  OpContext *ctx, uint64_t off, uint64_t len, const bufferlist& data)
+{
+  const double window = cct->_conf->osd_read_coalesce_window;
+  const uint64_t max_bytes = cct->_conf->osd_read_coalesce_max_bytes;
+  if (window <= 0 || !ctx->op || ctx->op->may_write() ||
+      data.length() > max_bytes) {
+    return;
+  }
+  const auto now = ceph_clock_now();
+  trim_recent_reads(now, max_bytes - data.length());
+  auto& rr = recent_reads[recent_read_key_t{ctx->new_obs.oi.soid, off, len}];
+  recent_reads_bytes -= rr.data.length();
+  rr.version = ctx->new_obs.oi.version;
+  rr.stamp = now;
+  rr.data = data;  // shares the buffers
+  recent_reads_bytes += rr.data.length();
+}
+
+void PrimaryLogPG::trim_recent_reads(utime_t now, uint64_t max_bytes)
+{
+  const double window = cct->_conf->osd_read_coalesce_window;
+  for (auto p = recent_reads.begin(); p != recent_reads.end(); ) {
+    if (p->second.stamp + window < now) {
+      recent_reads_bytes -= p->second.data.length();
+      p = recent_reads.erase(p);
+    } else {
+      ++p;
+    }
+  }
+  while (recent_reads_bytes > max_bytes) {
+    auto oldest = std::min_element(
+      recent_reads.begin(), recent_reads.end(),
+      [](const auto& a, const auto& b) {
+	return a.second.stamp < b.second.stamp;
+      });
+    recent_reads_bytes -= oldest->second.data.length();
+    recent_reads.erase(oldest);
+  }
+}
+
 int PrimaryLogPG::do_sparse_read(OpContext *ctx, OSDOp& osd_op) {
   dout(20) << __func__ << dendl;
   auto& op = osd_op.op;
@@ -7674,10 +7798,10 @@ int PrimaryLogPG::do_osd_ops(OpContext *ctx, vector<OSDOp>& ops)
 	    ch, ghobject_t(soid)
 	    );
 	  ceph_assert(iter);
+	  const uint64_t max_bytes = cct->_conf->osd_max_omap_bytes_per_request;
 	  iter->upper_bound(start_after);
 	  for (num = 0; iter->valid(); ++num, iter->next()) {
-	    if (num >= max_return ||
-		bl.length() >= cct->_conf->osd_max_omap_bytes_per_request) {
+	    if (num >= max_return || bl.length() >= max_bytes) {
 	      truncated = true;
 	      break;
 	    }
@@ -7724,19 +7848,25 @@ int PrimaryLogPG::do_osd_ops(OpContext *ctx, vector<OSDOp>& ops)
             result = -ENOENT;
             goto fail;
           }
-	  iter->upper_bound(start_after);
-	  if (filter_prefix > start_after) iter->lower_bound(filter_prefix);
-	  for (num = 0;
-	       iter->valid() &&
-		 iter->key().substr(0, filter_prefix.size()) == filter_prefix;
-	       ++num, iter->next()) {
-	    dout(20) << "Found key " << iter->key() << dendl;
-	    if (num >= max_return ||
-		bl.length() >= cct->_conf->osd_max_omap_bytes_per_request) {
+	  const uint64_t max_bytes = cct->_conf->osd_max_omap_bytes_per_request;
+	  // seek once, straight to the later of the cursor and the prefix
+	  if (filter_prefix > start_after) {
+	    iter->lower_bound(filter_prefix);
+	  } else {
+	    iter->upper_bound(start_after);
+	  }
+	  for (num = 0; iter->valid(); ++num, iter->next()) {
+	    // key() hands back a copy; fetch it once per entry
+	    const string key = iter->key();
+	    if (key.compare(0, filter_prefix.size(), filter_prefix) != 0) {
+	      break;
+	    }
+	    dout(20) << "Found key " << key << dendl;
+	    if (num >= max_return || bl.length() >= max_bytes) {
 	      truncated = true;
 	      break;
 	    }
-	    encode(iter->key(), bl);
+	    encode(key, bl);
 	    encode(iter->value(), bl);
 	  }
 	} // else return empty out_set
@@ -11623,6 +11753,7 @@ void PrimaryLogPG::submit_log_entries(
       };
       t.register_on_commit(
 	new OnComplete{this, rep_tid, get_osdmap_epoch()});
+      submit_txn_batch();
       int r = osd->store->queue_transaction(ch, std::move(t), NULL);
       ceph_assert(r == 0);
       op_applied(info.last_update);
@@ -13102,6 +13233,8 @@ void PrimaryLogPG::on_change(ObjectStore::Transaction &t)
   // NOTE: we actually assert that all currently live references are dead
   // by the time the flush for the next interval completes.
   object_contexts.clear();
+  recent_reads.clear();
+  recent_reads_bytes = 0;
 
   // should have been cleared above by finishing all of the degraded objects
   ceph_assert(objects_blocked_on_degraded_snap.empty());
@@ -13630,11 +13763,30 @@ int PrimaryLogPG::prep_object_replica_pushes(
   return 1;
 }
 
+unsigned PrimaryLogPG::recovery_op_cost(
+  const ObjectContextRef& obc,
+  unsigned *batched)
+{
+  // Small objects are bound by the push round trip rather than by
+  // bandwidth, so let up to osd_recovery_small_object_batch of them
+  // ride on a single op; they end up packed into the same MOSDPGPush
+  // and applied in one transaction on the peer.  Omap size is not
+  // known up front, so objects with omap always take a full op.
+  const unsigned batch = cct->_conf->osd_recovery_small_object_batch;
+  if (batch <= 1 || !obc ||
+      obc->obs.oi.is_omap() ||
+      obc->obs.oi.size > cct->_conf->osd_recovery_small_object_size) {
+    return 1;
+  }
+  return ((*batched)++ % batch) == 0 ? 1 : 0;
+}
+
 uint64_t PrimaryLogPG::recover_replicas(uint64_t max, ThreadPool::TPHandle &handle,
   bool *work_started)
 {
   dout(10) << __func__ << "(" << max << ")" << dendl;
   uint64_t started = 0;
+  unsigned batched = 0;
 
   PGBackend::RecoveryHandle *h = pgbackend->open_recovery_op();
 
@@ -13733,7 +13885,12 @@ uint64_t PrimaryLogPG::recover_replicas(uint64_t max, ThreadPool::TPHandle &hand
 
       dout(10) << __func__ << ": recover_object_replicas(" << soid << ")" << dendl;
       map<hobject_t,pg_missing_item>::const_iterator r = m.get_items().find(soid);
-      started += prep_object_replica_pushes(soid, r->second.need, h, work_started);
+      if (prep_object_replica_pushes(soid, r->second.need, h, work_started)) {
+	auto rec = recovering.find(soid);
+	started += recovery_op_cost(
+	  rec != recovering.end() ? rec->second : ObjectContextRef(),
+	  &batched);
+      }
     }
   }
 
@@ -13842,6 +13999,7 @@ uint64_t PrimaryLogPG::recover_backfill(
   update_range(&backfill_info, handle);
 
   unsigned ops = 0;
+  unsigned batched = 0;
   vector<boost::tuple<hobject_t, eversion_t, pg_shard_t> > to_remove;
   set<hobject_t> add_to_stat;
 
@@ -13999,7 +14157,7 @@ uint64_t PrimaryLogPG::recover_backfill(
 	    dout(0) << __func__ << " Error " << r << " trying to backfill " << backfill_info.begin << dendl;
 	    break;
 	  }
-	  ops++;
+	  ops += recovery_op_cost(obc, &batched);
 	} else {
 	  *work_started = true;
 	  dout(20) << "backfill blocking on " << backfill_info.begin
@@ -14373,6 +14531,7 @@ void PrimaryLogPG::hit_set_clear()
   dout(20) << __func__ << dendl;
   hit_set.reset();
   hit_set_start_stamp = utime_t();
+  access_sketch.reset();
 }
 
 void PrimaryLogPG::hit_set_setup()
@@ -14397,6 +14556,12 @@ void PrimaryLogPG::hit_set_setup()
   // FIXME: discard any previous data for now
   hit_set_create();
 
+  if (const uint32_t width = cct->_conf->osd_agent_sketch_width; !width) {
+    access_sketch.reset();
+  } else if (!access_sketch || access_sketch->get_width() < width) {
+    access_sketch.emplace(width);
+  }
+
   // include any writes we know about from the pg log.  this doesn't
   // capture reads, but it is better than nothing!
   hit_set_apply_log();
@@ -15391,6 +15556,15 @@ void PrimaryLogPG::agent_estimate_temp(const hobject_t& oid, int *temp)
   ceph_assert(hit_set);
   ceph_assert(temp);
   *temp = 0;
+  if (access_sketch) {
+    // 'osd_agent_sketch_hot_count' recent accesses make an object as hot
+    // as it gets
+    const unsigned hot_count = cct->_conf->osd_agent_sketch_hot_count;
+    const unsigned hits = std::min(
+      access_sketch->estimate(std::hash<hobject_t>{}(oid)), hot_count);
+    *temp = 1000000ull * hits / hot_count;
+    return;
+  }
   if (hit_set->contains(oid))
     *temp = 1000000;
   unsigned i = 0;
@@ -15605,7 +15779,8 @@ PrimaryLogPG::AwaitAsyncWork::AwaitAsyncWork(my_context ctx)
 {
   auto *pg = context< SnapTrimmer >().pg;
   context< SnapTrimmer >().log_enter(state_name);
-  context< SnapTrimmer >().pg->osd->queue_for_snap_trim(pg);
+  context< SnapTrimmer >().pg->osd->queue_for_snap_trim(
+    pg, context<Trimming>().last_batch_bytes);
   pg->state_set(PG_STATE_SNAPTRIM);
   pg->state_clear(PG_STATE_SNAPTRIM_ERROR);
   pg->publish_stats_to_osd();
@@ -15628,7 +15803,16 @@ boost::statechart::result PrimaryLogPG::AwaitAsyncWork::react(const DoSnapWork&)
   ldout(pg->cct, 10) << "AwaitAsyncWork: trimming snap " << snap_to_trim << dendl;
 
   vector<hobject_t> to_trim;
-  unsigned max = pg->cct->_conf->osd_pg_max_concurrent_snap_trims;
+  const unsigned max_concurrent =
+    pg->cct->_conf->osd_pg_max_concurrent_snap_trims;
+  const uint64_t batch_bytes = pg->cct->_conf->osd_snap_trim_batch_bytes;
+  unsigned max = max_concurrent;
+  if (batch_bytes) {
+    // small clones are trimmed in larger rounds, bounded by the byte
+    // budget below
+    max = std::max<unsigned>(
+      max, pg->cct->_conf->osd_snap_trim_batch_max_objects);
+  }
   // we need to look for at least 1 snaptrim, otherwise we'll misinterpret
   // the ENOENT below and erase snap_to_trim.
   ceph_assert(max > 0);
@@ -15676,7 +15860,16 @@ boost::statechart::result PrimaryLogPG::AwaitAsyncWork::react(const DoSnapWork&)
   }
   ceph_assert(!to_trim.empty());
 
+  uint64_t trimmed_bytes = 0;
   for (auto &&object: to_trim) {
+    if (in_flight.size() >= max_concurrent &&
+	(!batch_bytes || trimmed_bytes >= batch_bytes)) {
+      // the rest stay mapped and are picked up by the next round
+      ldout(pg->cct, 10) << "AwaitAsyncWork batch is full: "
+			 << in_flight.size() << " objects, "
+			 << trimmed_bytes << " bytes" << dendl;
+      break;
+    }
     // Get next
     ldout(pg->cct, 10) << "AwaitAsyncWork react trimming " << object << dendl;
     OpContextUPtr ctx;
@@ -15703,6 +15896,7 @@ boost::statechart::result PrimaryLogPG::AwaitAsyncWork::react(const DoSnapWork&)
     }
 
     in_flight.insert(object);
+    trimmed_bytes += ctx->obc->obs.oi.size;
     ctx->register_on_success(
       [pg, object, &in_flight]() {
 	ceph_assert(in_flight.find(object) != in_flight.end());
@@ -15719,6 +15913,9 @@ boost::statechart::result PrimaryLogPG::AwaitAsyncWork::react(const DoSnapWork&)
     pg->simple_opc_submit(std::move(ctx));
   }
 
+  if (batch_bytes) {
+    context<Trimming>().last_batch_bytes = trimmed_bytes;
+  }
   return transit< WaitRepops >();
 }
 
@@ -26,6 +26,7 @@
 #include "TierAgentState.h"
 #include "messages/MOSDOpReply.h"
 #include "common/Checksummer.h"
+#include "common/frequency_sketch.h"
 #include "common/sharedptr_registry.hpp"
 #include "common/shared_cache.hpp"
 #include "ReplicatedBackend.h"
@@ -358,10 +359,27 @@ public:
   }
   void queue_transaction(ObjectStore::Transaction&& t,
 			 OpRequestRef op) override {
+    if (txn_batch_open) {
+      txn_batch.push_back(std::move(t));
+      if (op) {
+	txn_batch_op = op;
+      }
+      return;
+    }
     osd->store->queue_transaction(ch, std::move(t), op);
   }
   void queue_transactions(std::vector<ObjectStore::Transaction>& tls,
 			  OpRequestRef op) override {
+    if (txn_batch_open) {
+      for (auto& t : tls) {
+	txn_batch.push_back(std::move(t));
+      }
+      tls.clear();
+      if (op) {
+	txn_batch_op = op;
+      }
+      return;
+    }
     osd->store->queue_transactions(ch, tls, op, NULL);
   }
   epoch_t get_interval_start_epoch() const override {
@@ -544,6 +562,9 @@ public:
 
   void schedule_recovery_work(
     GenContext<ThreadPool::TPHandle&> *c) override;
+  Context *schedule_backend_timer(
+    double delay, Context *c) override;
+  void cancel_backend_timer(Context *handle) override;
 
   pg_shard_t whoami_shard() const override {
     return pg_whoami;
@@ -944,6 +965,9 @@ protected:
   // hot/cold tracking
   HitSetRef hit_set;        ///< currently accumulating HitSet
   utime_t hit_set_start_stamp;    ///< time the current HitSet started recording
+  /// recent access frequencies, if osd_agent_sketch_width is set. Lets the
+  /// agent estimate temperatures without scanning the HitSet archives.
+  std::optional<ceph::common::frequency_sketch> access_sketch;
 
 
   void hit_set_clear();     ///< discard any HitSet state
@@ -1132,6 +1156,8 @@ protected:
   int prep_object_replica_deletes(const hobject_t& soid, eversion_t v,
 				  PGBackend::RecoveryHandle *h,
 				  bool *work_started);
+  /// recovery op slots an object takes; small objects share one slot
+  unsigned recovery_op_cost(const ObjectContextRef& obc, unsigned *batched);
 
   void finish_degraded_object(const hobject_t oid);
 
@@ -1395,6 +1421,28 @@ protected:
   friend struct C_ExtentCmpRead;
 
   int do_read(OpContext *ctx, OSDOp& osd_op);
+
+  /**
+   * Recently read extents of replicated objects, shared with identical
+   * reads of the same object version arriving within
+   * osd_read_coalesce_window seconds, so that a burst of clients reading
+   * one hot extent costs a single store read.
+   */
+  struct recent_read_t {
+    eversion_t version;
+    utime_t stamp;
+    ceph::buffer::list data;
+  };
+  using recent_read_key_t = std::tuple<hobject_t, uint64_t, uint64_t>;
+  std::map<recent_read_key_t, recent_read_t> recent_reads;
+  uint64_t recent_reads_bytes = 0;
+
+  const ceph::buffer::list *find_recent_read(
+    OpContext *ctx, uint64_t off, uint64_t len);
+  void note_recent_read(
+    OpContext *ctx, uint64_t off, uint64_t len,
+    const ceph::buffer::list& data);
+  void trim_recent_reads(utime_t now, uint64_t max_bytes);
   int do_sparse_read(OpContext *ctx, OSDOp& osd_op);
   int do_writesame(OpContext *ctx, OSDOp& osd_op);
 
@@ -1606,6 +1654,8 @@ private:
 
     std::set<hobject_t> in_flight;
     snapid_t snap_to_trim;
+    /// clone bytes trimmed by the last round (osd_snap_trim_batch_bytes)
+    uint64_t last_batch_bytes = 0;
 
     explicit Trimming(my_context ctx)
       : my_base(ctx),
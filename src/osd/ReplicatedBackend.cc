@@ -649,6 +649,10 @@ int ReplicatedBackend::be_deep_scrub(
 
   ceph_assert(poid == pos.ls[pos.pos]);
   if (!pos.data_done()) {
+    // the store checks its own csums on read, so reading is enough to
+    // find media errors; only the cross-replica digest is given up
+    const bool store_verified = store->has_builtin_csum() &&
+      cct->_conf->osd_deep_scrub_store_verified;
     if (pos.data_pos == 0) {
       pos.data_hash = bufferhash(-1);
     }
@@ -667,7 +671,7 @@ int ReplicatedBackend::be_deep_scrub(
       o.read_error = true;
       return 0;
     }
-    if (r > 0) {
+    if (r > 0 && !store_verified) {
       pos.data_hash << bl;
     }
     pos.data_pos += r;
@@ -678,10 +682,15 @@ int ReplicatedBackend::be_deep_scrub(
     }
     // done with bytes
     pos.data_pos = -1;
-    o.digest = pos.data_hash.digest();
-    o.digest_present = true;
-    dout(20) << __func__ << "  " << poid << " done with data, digest 0x"
-	     << std::hex << o.digest << std::dec << dendl;
+    if (store_verified) {
+      dout(20) << __func__ << "  " << poid << " done with data, verified by store"
+	       << dendl;
+    } else {
+      o.digest = pos.data_hash.digest();
+      o.digest_present = true;
+      dout(20) << __func__ << "  " << poid << " done with data, digest 0x"
+	       << std::hex << o.digest << std::dec << dendl;
+    }
   }
 
   // omap header
@@ -941,7 +950,8 @@ Message * ReplicatedBackend::generate_subop(
   hobject_t discard_temp_oid,
   const bufferlist &log_entries,
   std::optional<pg_hit_set_history_t> &hset_hist,
-  ObjectStore::Transaction &op_t,
+  const bufferlist &op_t_bl,
+  uint32_t op_t_data_off,
   pg_shard_t peer,
   const pg_info_t &pinfo)
 {
@@ -960,8 +970,8 @@ Message * ReplicatedBackend::generate_subop(
     ObjectStore::Transaction t;
     encode(t, wr->get_data());
   } else {
-    encode(op_t, wr->get_data());
-    wr->get_header().data_off = op_t.get_data_alignment();
+    wr->get_data().append(op_t_bl);
+    wr->get_header().data_off = op_t_data_off;
   }
 
   wr->logbl = log_entries;
@@ -1011,9 +1021,13 @@ void ReplicatedBackend::issue_op(
       op->op->mark_sub_op_sent(ss.str());
     }
 
-    // avoid doing the same work in generate_subop
+    // avoid doing the same work in generate_subop; every replica's
+    // message shares the buffers of these
     bufferlist logs;
     encode(log_entries, logs);
+    bufferlist op_t_bl;
+    encode(op_t, op_t_bl);
+    uint32_t op_t_data_off = op_t.get_data_alignment();
 
     for (const auto& shard : get_parent()->get_acting_recovery_backfill_shards()) {
       if (shard == parent->whoami_shard()) continue;
@@ -1031,7 +1045,8 @@ void ReplicatedBackend::issue_op(
 	  discard_temp_oid,
 	  logs,
 	  hset_hist,
-	  op_t,
+	  op_t_bl,
+	  op_t_data_off,
 	  shard,
 	  pinfo);
       if (op->op && op->op->pg_trace)
@@ -1237,7 +1252,7 @@ void ReplicatedBackend::calc_head_subsets(
     return;
   }
 
-  if (cloning.num_intervals() > g_conf().get_val<uint64_t>("osd_recover_clone_overlap_limit")) {
+  if (cloning.num_intervals() > cct->_conf->osd_recover_clone_overlap_limit) {
     dout(10) << "skipping clone, too many holes" << dendl;
     get_parent()->release_locks(manager);
     clone_subsets.clear();
@@ -1327,7 +1342,7 @@ void ReplicatedBackend::calc_clone_subsets(
 	     << " overlap " << next << dendl;
   }
 
-  if (cloning.num_intervals() > g_conf().get_val<uint64_t>("osd_recover_clone_overlap_limit")) {
+  if (cloning.num_intervals() > cct->_conf->osd_recover_clone_overlap_limit) {
     dout(10) << "skipping clone, too many holes" << dendl;
     get_parent()->release_locks(manager);
     clone_subsets.clear();
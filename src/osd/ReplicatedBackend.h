@@ -386,7 +386,8 @@ private:
     hobject_t discard_temp_oid,
     const ceph::buffer::list &log_entries,
     std::optional<pg_hit_set_history_t> &hset_history,
-    ObjectStore::Transaction &op_t,
+    const ceph::buffer::list &op_t_bl,
+    uint32_t op_t_data_off,
     pg_shard_t peer,
     const pg_info_t &pinfo);
   void issue_op(
@@ -118,14 +118,25 @@ void Notify::do_timeout()
   _watchers.swap(watchers);
   lock.unlock();
 
+  // All watchers of a notify hang off the same object and thus the same
+  // pg, so take the pg lock once rather than once per watcher; objects
+  // with thousands of watchers otherwise bounce it on every timeout.
+  NotifyRef me = self.lock();
+  boost::intrusive_ptr<PrimaryLogPG> locked_pg;
   for (auto i = _watchers.begin(); i != _watchers.end(); ++i) {
     boost::intrusive_ptr<PrimaryLogPG> pg((*i)->get_pg());
-    pg->lock();
+    if (pg != locked_pg) {
+      if (locked_pg)
+	locked_pg->unlock();
+      pg->lock();
+      locked_pg = pg;
+    }
     if (!(*i)->is_discarded()) {
-      (*i)->cancel_notify(self.lock());
+      (*i)->cancel_notify(me);
     }
-    pg->unlock();
   }
+  if (locked_pg)
+    locked_pg->unlock();
 }
 
 void Notify::register_cb()
@@ -79,7 +79,7 @@ public:
     const pg_t &pg,
     const OSDMap &osdmap);
 
-  std::vector<ClassInfo> get_classes() const {
+  const std::vector<ClassInfo>& get_classes() const {
     return classes;
   }
 };
@@ -125,6 +125,8 @@ PerfCounters *build_osd_logger(CephContext *cct) {
     "Latency of IO before calling queue(before really queue into ShardedOpWq)"); // client io before queue op_wq latency
   osd_plb.add_time_avg(l_osd_op_before_dequeue_op_lat, "op_before_dequeue_op_lat",
     "Latency of IO before calling dequeue_op(already dequeued and get PG lock)"); // client io before dequeue_op latency
+  osd_plb.add_time_avg(l_osd_op_commit_lat, "op_commit_latency",
+    "Latency of client writes from submission to the PG backend until committed on all replicas");
 
   osd_plb.add_u64_counter(
     l_osd_sop, "subop", "Suboperations");
@@ -278,6 +280,22 @@ PerfCounters *build_osd_logger(CephContext *cct) {
   osd_plb.add_u64_counter(
     l_osd_pg_biginfo, "osd_pg_biginfo", "PG updated its biginfo attr");
 
+  osd_plb.add_u64_counter(
+    l_osd_op_wq_steal, "op_wq_steal",
+    "Work items run by a thread of another, idle op shard");
+  osd_plb.add_u64_counter(
+    l_osd_op_wq_steal_wake, "op_wq_steal_wake",
+    "Idle op shard threads woken to help a backlogged shard");
+  osd_plb.add_u64_counter(
+    l_osd_op_txn_batched, "op_txn_batched",
+    "Client op transactions submitted to the store together with others");
+  osd_plb.add_u64_counter(
+    l_osd_ec_hedged_read, "ec_hedged_read",
+    "EC reads sent to extra shards after a slow sub-read");
+  osd_plb.add_u64_counter(
+    l_osd_op_r_coalesced, "op_r_coalesced",
+    "Client reads served from a recent identical read of the same object");
+
   return osd_plb.create_perf_counters();
 }
  
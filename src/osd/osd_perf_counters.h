@@ -38,6 +38,7 @@ enum {
 
   l_osd_op_before_queue_op_lat,
   l_osd_op_before_dequeue_op_lat,
+  l_osd_op_commit_lat,
 
   l_osd_sop,
   l_osd_sop_inb,
@@ -118,6 +119,12 @@ enum {
   l_osd_pg_fastinfo,
   l_osd_pg_biginfo,
 
+  l_osd_op_wq_steal,
+  l_osd_op_wq_steal_wake,
+  l_osd_op_txn_batched,
+  l_osd_ec_hedged_read,
+  l_osd_op_r_coalesced,
+
   l_osd_last,
 };
 
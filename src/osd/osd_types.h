@@ -1078,6 +1078,9 @@ public:
     DEDUP_CHUNK_ALGORITHM,
     DEDUP_CDC_CHUNK_SIZE,
     PG_NUM_MAX, // max pg_num
+    MCLOCK_RES, // mclock reservation (iops per osd) for the pool's client ops
+    MCLOCK_WGT, // mclock weight
+    MCLOCK_LIM, // mclock limit (iops per osd)
   };
 
   enum type_t {
@@ -2690,6 +2693,16 @@ struct pool_stat_t {
 };
 WRITE_CLASS_ENCODER_FEATURES(pool_stat_t)
 
+inline bool operator==(const pool_stat_t& l, const pool_stat_t& r) {
+  return l.stats == r.stats &&
+    l.store_stats == r.store_stats &&
+    l.log_size == r.log_size &&
+    l.ondisk_log_size == r.ondisk_log_size &&
+    l.up == r.up &&
+    l.acting == r.acting &&
+    l.num_store_stats == r.num_store_stats;
+}
+
 
 // -----------------------------------------
 
@@ -21,6 +21,8 @@
 #include "mon/MonClient.h"
 #include "osd/scheduler/OpSchedulerItem.h"
 
+class OSDMap;
+
 namespace ceph::osd::scheduler {
 
 using client = uint64_t;
@@ -54,6 +56,12 @@ public:
   // Apply config changes to the scheduler (if any)
   virtual void update_configuration() = 0;
 
+  // Feedback on how long a dequeued item of the given cost took to run
+  virtual void note_service_time(uint64_t cost, ceph::timespan t) {}
+
+  // Pick up scheduling parameters carried by a new osdmap (if any)
+  virtual void consume_map(const OSDMap &osdmap) {}
+
   // Destructor
   virtual ~OpScheduler() {};
 };
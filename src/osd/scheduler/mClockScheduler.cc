@@ -17,6 +17,7 @@
 #include <functional>
 
 #include "osd/scheduler/mClockScheduler.h"
+#include "osd/OSDMap.h"
 #include "common/dout.h"
 
 namespace dmc = crimson::dmclock;
@@ -54,6 +55,7 @@ mClockScheduler::mClockScheduler(CephContext *cct,
   set_max_osd_capacity();
   set_osd_mclock_cost_per_io();
   set_osd_mclock_cost_per_byte();
+  set_cost_calibration();
   set_mclock_profile();
   enable_mclock_profile_settings();
   client_registry.update_from_config(cct->_conf);
@@ -79,9 +81,46 @@ void mClockScheduler::ClientRegistry::update_from_config(const ConfigProxy &conf
     conf.get_val<uint64_t>("osd_mclock_scheduler_background_best_effort_lim"));
 }
 
+void mClockScheduler::ClientRegistry::update_from_osdmap(
+  const OSDMap &osdmap,
+  uint32_t num_shards,
+  const ConfigProxy &conf)
+{
+  pools_with_qos.clear();
+  for (auto &[id, pool] : osdmap.get_pools()) {
+    if (!pool.opts.is_set(pool_opts_t::MCLOCK_RES) &&
+	!pool.opts.is_set(pool_opts_t::MCLOCK_WGT) &&
+	!pool.opts.is_set(pool_opts_t::MCLOCK_LIM)) {
+      continue;
+    }
+    int64_t res = 0;
+    int64_t wgt = conf.get_val<uint64_t>("osd_mclock_scheduler_client_wgt");
+    int64_t lim = 0;
+    pool.opts.get(pool_opts_t::MCLOCK_RES, &res);
+    pool.opts.get(pool_opts_t::MCLOCK_WGT, &wgt);
+    pool.opts.get(pool_opts_t::MCLOCK_LIM, &lim);
+    // the pool values are per osd, the queue is per shard
+    double shard_res = std::max<int64_t>(res, 0) / double(num_shards);
+    double shard_lim = std::max<int64_t>(lim, 0) / double(num_shards);
+    double shard_wgt = std::max<int64_t>(wgt, 1);
+    auto [i, inserted] = pool_client_infos.try_emplace(
+      id, shard_res, shard_wgt, shard_lim);
+    if (!inserted) {
+      i->second.update(shard_res, shard_wgt, shard_lim);
+    }
+    pools_with_qos.insert(id);
+  }
+}
+
 const dmc::ClientInfo *mClockScheduler::ClientRegistry::get_external_client(
   const client_profile_id_t &client) const
 {
+  if (client.profile_id) {
+    auto p = pool_client_infos.find(
+      static_cast<int64_t>(client.profile_id - 1));
+    if (p != pool_client_infos.end())
+      return &(p->second);
+  }
   auto ret = external_client_infos.find(client);
   if (ret == external_client_infos.end())
     return &default_external_client_info;
@@ -402,6 +441,97 @@ int mClockScheduler::calc_scaled_cost(int item_cost)
   return std::max(scaled_cost, 1);
 }
 
+void mClockScheduler::CostCalibrator::add_sample(
+  uint64_t cost, double secs, uint64_t window)
+{
+  std::lock_guard l(lock);
+  // exponential decay keeps roughly the last 'window' samples relevant
+  const double keep = 1.0 - 1.0 / window;
+  const double x = cost;
+  n = n * keep + 1;
+  sum_x = sum_x * keep + x;
+  sum_y = sum_y * keep + secs;
+  sum_xx = sum_xx * keep + x * x;
+  sum_xy = sum_xy * keep + x * secs;
+  ++total_samples;
+  if (++since_fit < window) {
+    return;
+  }
+  since_fit = 0;
+
+  double b = 0;
+  const double denom = n * sum_xx - sum_x * sum_x;
+  if (denom > 1e-9 * n * sum_xx) {
+    b = std::max(0.0, (n * sum_xy - sum_x * sum_y) / denom);
+  }
+  per_byte = b;
+  per_io = std::max(0.0, (sum_y - b * sum_x) / n);
+  updated = true;
+}
+
+bool mClockScheduler::CostCalibrator::take_fit(
+  double *_per_io, double *_per_byte)
+{
+  if (!updated.exchange(false)) {
+    return false;
+  }
+  std::lock_guard l(lock);
+  *_per_io = per_io;
+  *_per_byte = per_byte;
+  return true;
+}
+
+void mClockScheduler::CostCalibrator::dump(ceph::Formatter &f) const
+{
+  std::lock_guard l(lock);
+  f.dump_unsigned("samples", total_samples);
+  f.dump_float("cost_per_io_usec", per_io * 1e6);
+  f.dump_float("cost_per_byte_usec", per_byte * 1e6);
+}
+
+void mClockScheduler::set_cost_calibration()
+{
+  cost_auto_calibrate =
+    cct->_conf.get_val<bool>("osd_mclock_cost_auto_calibrate");
+  cost_calibration_samples =
+    cct->_conf.get_val<uint64_t>("osd_mclock_cost_calibration_samples");
+}
+
+void mClockScheduler::note_service_time(uint64_t cost, ceph::timespan t)
+{
+  if (!cost_auto_calibrate) {
+    return;
+  }
+  calibrator.add_sample(
+    cost,
+    std::chrono::duration<double>(t).count(),
+    cost_calibration_samples);
+}
+
+void mClockScheduler::maybe_apply_calibration()
+{
+  double per_io, per_byte;
+  if (!calibrator.take_fit(&per_io, &per_byte) || !cost_auto_calibrate) {
+    return;
+  }
+  // same units set_osd_mclock_cost_per_{io,byte} use: seconds for
+  // HDDs, milliseconds for SSDs
+  if (!is_rotational) {
+    per_io *= 1000;
+    per_byte *= 1000;
+  }
+  dout(10) << __func__ << " cost_per_io " << osd_mclock_cost_per_io
+           << " -> " << per_io << ", cost_per_byte "
+           << osd_mclock_cost_per_byte << " -> " << per_byte << dendl;
+  osd_mclock_cost_per_io = per_io;
+  osd_mclock_cost_per_byte = per_byte;
+}
+
+void mClockScheduler::consume_map(const OSDMap &osdmap)
+{
+  client_registry.update_from_osdmap(osdmap, num_shards, cct->_conf);
+}
+
 void mClockScheduler::update_configuration()
 {
   // Apply configuration change. The expectation is that
@@ -430,6 +560,14 @@ void mClockScheduler::dump(ceph::Formatter &f) const
   f.open_object_section("mClockQueues");
   f.dump_string("queues", display_queues());
   f.close_section();
+
+  f.open_object_section("cost_model");
+  f.dump_float("osd_mclock_cost_per_io", osd_mclock_cost_per_io);
+  f.dump_float("osd_mclock_cost_per_byte", osd_mclock_cost_per_byte);
+  f.open_object_section("calibration");
+  calibrator.dump(f);
+  f.close_section();
+  f.close_section();
 }
 
 void mClockScheduler::enqueue(OpSchedulerItem&& item)
@@ -440,6 +578,7 @@ void mClockScheduler::enqueue(OpSchedulerItem&& item)
   if (op_scheduler_class::immediate == id.class_id) {
     immediate.push_front(std::move(item));
   } else {
+    maybe_apply_calibration();
     int cost = calc_scaled_cost(item.get_cost());
     item.set_qos_cost(cost);
     dout(20) << __func__ << " " << id
@@ -524,6 +663,8 @@ const char** mClockScheduler::get_tracked_conf_keys() const
     "osd_mclock_max_capacity_iops_hdd",
     "osd_mclock_max_capacity_iops_ssd",
     "osd_mclock_profile",
+    "osd_mclock_cost_auto_calibrate",
+    "osd_mclock_cost_calibration_samples",
     NULL
   };
   return KEYS;
@@ -533,14 +674,20 @@ void mClockScheduler::handle_conf_change(
   const ConfigProxy& conf,
   const std::set<std::string> &changed)
 {
+  if (changed.count("osd_mclock_cost_auto_calibrate") ||
+      changed.count("osd_mclock_cost_calibration_samples")) {
+    set_cost_calibration();
+  }
   if (changed.count("osd_mclock_cost_per_io_usec") ||
       changed.count("osd_mclock_cost_per_io_usec_hdd") ||
-      changed.count("osd_mclock_cost_per_io_usec_ssd")) {
+      changed.count("osd_mclock_cost_per_io_usec_ssd") ||
+      changed.count("osd_mclock_cost_auto_calibrate")) {
     set_osd_mclock_cost_per_io();
   }
   if (changed.count("osd_mclock_cost_per_byte_usec") ||
       changed.count("osd_mclock_cost_per_byte_usec_hdd") ||
-      changed.count("osd_mclock_cost_per_byte_usec_ssd")) {
+      changed.count("osd_mclock_cost_per_byte_usec_ssd") ||
+      changed.count("osd_mclock_cost_auto_calibrate")) {
     set_osd_mclock_cost_per_byte();
   }
   if (changed.count("osd_mclock_max_capacity_iops_hdd") ||
@@ -15,8 +15,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <ostream>
 #include <map>
+#include <set>
 #include <vector>
 
 #include "boost/variant.hpp"
@@ -24,6 +26,7 @@
 #include "dmclock/src/dmclock_server.h"
 
 #include "osd/scheduler/OpScheduler.h"
+#include "common/ceph_mutex.h"
 #include "common/config.h"
 #include "common/ceph_context.h"
 #include "common/mClockPriorityQueue.h"
@@ -81,6 +84,37 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
   double osd_mclock_cost_per_io;
   double osd_mclock_cost_per_byte;
   std::string mclock_profile = "high_client_ops";
+
+  /**
+   * Online estimate of osd_mclock_cost_per_io/_per_byte
+   *
+   * A decaying least squares fit of op service time against op cost
+   * (bytes), fed by the worker threads and picked up by enqueue().
+   */
+  class CostCalibrator {
+    mutable ceph::mutex lock =
+      ceph::make_mutex("mClockScheduler::CostCalibrator::lock");
+    double n = 0, sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+    uint64_t since_fit = 0;
+    uint64_t total_samples = 0;
+    double per_io = 0;   // seconds
+    double per_byte = 0; // seconds
+    std::atomic<bool> updated = false;
+  public:
+    void add_sample(uint64_t cost, double secs, uint64_t window);
+    // true if a new fit is available since the last call
+    bool take_fit(double *per_io, double *per_byte);
+    void dump(ceph::Formatter &f) const;
+  } calibrator;
+
+  // osd_mclock_cost_auto_calibrate / _calibration_samples, read by the
+  // worker threads without the shard lock
+  std::atomic<bool> cost_auto_calibrate = false;
+  std::atomic<uint64_t> cost_calibration_samples = 1000;
+  void set_cost_calibration();
+
+  // Adopt the calibrator's latest fit, if any
+  void maybe_apply_calibration();
   struct ClientAllocs {
     uint64_t res;
     uint64_t wgt;
@@ -119,24 +153,51 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
     crimson::dmclock::ClientInfo default_external_client_info = {1, 1, 1};
     std::map<client_profile_id_t,
 	     crimson::dmclock::ClientInfo> external_client_infos;
+    // pools with mclock_{res,wgt,lim} set.  dmclock keeps pointers to
+    // these, so entries are updated in place and never erased.
+    std::map<int64_t, crimson::dmclock::ClientInfo> pool_client_infos;
+    std::set<int64_t> pools_with_qos;
     const crimson::dmclock::ClientInfo *get_external_client(
       const client_profile_id_t &client) const;
   public:
     void update_from_config(const ConfigProxy &conf);
+    void update_from_osdmap(const OSDMap &osdmap, uint32_t num_shards,
+			    const ConfigProxy &conf);
+    bool has_pool_qos(int64_t pool) const {
+      return pools_with_qos.count(pool);
+    }
     const crimson::dmclock::ClientInfo *get_info(
       const scheduler_id_t &id) const;
   } client_registry;
 
+  // the last argument is the branching factor of dmclock's reservation,
+  // limit and proportion heaps; a 4-ary heap halves their depth and keeps
+  // each sift's children adjacent, which matters with many active clients
   using mclock_queue_t = crimson::dmclock::PullPriorityQueue<
     scheduler_id_t,
     OpSchedulerItem,
     true,
     true,
-    2>;
+    4>;
   mclock_queue_t scheduler;
   std::list<OpSchedulerItem> immediate;
 
-  static scheduler_id_t get_scheduler_id(const OpSchedulerItem &item) {
+  // profile 0 is the shared client profile, pool N uses profile N + 1
+  static profile_id_t pool_profile_id(int64_t pool) {
+    return static_cast<profile_id_t>(pool) + 1;
+  }
+
+  scheduler_id_t get_scheduler_id(const OpSchedulerItem &item) const {
+    if (item.get_scheduler_class() == op_scheduler_class::client) {
+      int64_t pool = item.get_ordering_token().pool();
+      if (pool >= 0 && client_registry.has_pool_qos(pool)) {
+	// all of the pool's clients share its allocation
+	return scheduler_id_t{
+	  op_scheduler_class::client,
+	  client_profile_id_t{0, pool_profile_id(pool)}
+	};
+      }
+    }
     return scheduler_id_t{
       item.get_scheduler_class(),
 	client_profile_id_t{
@@ -211,6 +272,10 @@ public:
   // Update data associated with the modified mclock config key(s)
   void update_configuration() final;
 
+  void note_service_time(uint64_t cost, ceph::timespan t) final;
+
+  void consume_map(const OSDMap &osdmap) final;
+
   const char** get_tracked_conf_keys() const final;
   void handle_conf_change(const ConfigProxy& conf,
 			  const std::set<std::string> &changed) final;
@@ -573,6 +573,37 @@ double ScrubQueue::scrub_sleep_time(bool must_scrub) const
   return std::max(extended_sleep, regular_sleep_period);
 }
 
+void ScrubQueue::charge_scrub_read(uint64_t bytes)
+{
+  const uint64_t rate = conf()->osd_scrub_max_bytes_per_sec;
+  if (!rate || !bytes) {
+    return;
+  }
+
+  auto now_is = time_now();
+  std::lock_guard l{budget_lock};
+  if (budget_available_at < now_is) {
+    // unused budget does not accumulate
+    budget_available_at = now_is;
+  }
+  budget_available_at += double(bytes) / double(rate);
+  dout(20) << __func__ << ": " << bytes << " bytes. Budget available at "
+	   << budget_available_at << dendl;
+}
+
+double ScrubQueue::scrub_budget_delay() const
+{
+  if (!conf()->osd_scrub_max_bytes_per_sec) {
+    return 0.0;
+  }
+  auto now_is = time_now();
+  std::lock_guard l{budget_lock};
+  if (budget_available_at <= now_is) {
+    return 0.0;
+  }
+  return double(budget_available_at - now_is);
+}
+
 bool ScrubQueue::scrub_load_below_threshold() const
 {
   double loadavgs[3];
@@ -399,6 +399,19 @@ class ScrubQueue {
   double scrub_sleep_time(bool must_scrub) const;  /// \todo (future) return
 						   /// milliseconds
 
+  /**
+   * The OSD-wide deep-scrub read budget (osd_scrub_max_bytes_per_sec).
+   *
+   * All chunks read by this OSD - for its own PGs or on behalf of a primary -
+   * are charged against a single virtual clock, which is pushed forward by
+   * 'bytes / rate' for every chunk. The delay returned by
+   * scrub_budget_delay() is the time left until that clock catches up with
+   * the wall clock, so that concurrent scrubs on the same device share the
+   * bandwidth instead of each running at full speed.
+   */
+  void charge_scrub_read(uint64_t bytes);
+  double scrub_budget_delay() const;  ///< seconds
+
   /**
    *  called every heartbeat to update the "daily" load average
    *
@@ -464,6 +477,13 @@ class ScrubQueue {
   ScrubQContainer collect_ripe_jobs(ScrubQContainer& group, utime_t time_now);
 
 
+  /// guards 'budget_available_at'
+  mutable ceph::mutex budget_lock =
+    ceph::make_mutex("ScrubQueue::budget_lock");
+
+  /// when the read budget would allow the next chunk to be read
+  utime_t budget_available_at;
+
   /// scrub resources management lock (guarding scrubs_local & scrubs_remote)
   mutable ceph::mutex resource_lock =
     ceph::make_mutex("ScrubQueue::resource_lock");
@@ -853,9 +853,13 @@ void PgScrubber::add_delayed_scheduling()
 
   milliseconds sleep_time{0ms};
   if (m_needs_sleep) {
-    double scrub_sleep =
-      1000.0 * m_osds->get_scrub_services().scrub_sleep_time(m_flags.required);
-    sleep_time = milliseconds{int64_t(scrub_sleep)};
+    auto& scrub_services = m_osds->get_scrub_services();
+    double scrub_sleep = 1000.0 * std::max(
+	scrub_services.scrub_sleep_time(m_flags.required),
+	scrub_services.scrub_budget_delay());
+    sleep_time =
+      std::max(milliseconds{int64_t(scrub_sleep)}, m_replicas_budget_delay);
+    m_replicas_budget_delay = 0ms;
   }
   dout(15) << __func__ << " sleep: " << sleep_time.count() << "ms. needed? "
 	   << m_needs_sleep << dendl;
@@ -1222,6 +1226,16 @@ int PgScrubber::build_scrub_map_chunk(ScrubMap& map,
   ceph_assert(pos.done());
   repair_oinfo_oid(map);
 
+  if (deep) {
+    // charge the data read for this chunk against the OSD's scrub budget
+    uint64_t chunk_bytes{0};
+    for (auto it = map.objects.lower_bound(start);
+	 it != map.objects.end() && it->first < end; ++it) {
+      chunk_bytes += it->second.size;
+    }
+    m_osds->get_scrub_services().charge_scrub_read(chunk_bytes);
+  }
+
   dout(20) << __func__ << " done, got " << map.objects.size() << " items"
 	   << dendl;
   return 0;
@@ -1546,6 +1560,8 @@ ScrubMachineListener::MsgAndEpoch PgScrubber::prep_replica_map_msg(
     m_pg_whoami);
 
   reply->preempted = (was_preempted == PreemptionNoted::preempted);
+  reply->budget_delay_ms = static_cast<uint32_t>(
+    1000.0 * m_osds->get_scrub_services().scrub_budget_delay());
   ::encode(replica_scrubmap, reply->get_data());
 
   return ScrubMachineListener::MsgAndEpoch{reply, m_replica_min_epoch};
@@ -1613,6 +1629,10 @@ void PgScrubber::map_from_replica(OpRequestRef op)
     preemption_data.do_preempt();
   }
 
+  // pace the next chunk by the most loaded of the participating OSDs
+  m_replicas_budget_delay = std::max(
+    m_replicas_budget_delay, milliseconds{m->budget_delay_ms});
+
   if (m_maps_status.are_all_maps_available()) {
     dout(15) << __func__ << " all repl-maps available" << dendl;
     m_osds->queue_scrub_got_repl_maps(m_pg, m_pg->is_scrub_blocking_ops());
@@ -2398,6 +2418,7 @@ void PgScrubber::reset_internal_state()
   replica_scrubmap_pos.reset();
   m_needs_sleep = true;
   m_sleep_started_at = utime_t{};
+  m_replicas_budget_delay = 0ms;
 
   m_active = false;
   clear_queued_or_active();
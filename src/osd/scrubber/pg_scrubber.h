@@ -737,6 +737,11 @@ class PgScrubber : public ScrubPgIF,
 
   utime_t m_sleep_started_at;
 
+  /// the longest read-budget delay reported by a replica for the last
+  /// chunk (see osd_scrub_max_bytes_per_sec). Consumed by
+  /// add_delayed_scheduling().
+  std::chrono::milliseconds m_replicas_budget_delay{0};
+
 
   // 'optional', as 'ReplicaReservations' & 'LocalReservation' are
   // 'RAII-designed' to guarantee un-reserving when deleted.
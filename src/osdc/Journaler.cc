@@ -545,6 +545,13 @@ void Journaler::_finish_flush(int r, uint64_t start, ceph::real_time stamp)
   else
     safe_pos = min_next_safe_pos;
 
+  // a deferred flush goes out now, carrying everything appended while
+  // the previous write was in flight
+  if (flush_deferred && pending_safe.empty()) {
+    flush_deferred = false;
+    _do_flush();
+  }
+
   ldout(cct, 10) << "_finish_flush safe from " << start
 		 << ", pending_safe " << pending_safe
 		 << ", (prezeroing/prezero)/write/flush/safe positions now "
@@ -759,6 +766,11 @@ void Journaler::_flush(C_OnFinisher *onsafe)
     if (onsafe) {
       onsafe->complete(0);
     }
+  } else if (_should_defer_flush()) {
+    ldout(cct, 10) << "_flush deferring " << flush_pos << "~" << write_buf.length()
+		   << " behind in-flight writes " << pending_safe << dendl;
+    flush_deferred = true;
+    _wait_for_flush(onsafe);
   } else {
     _do_flush();
     _wait_for_flush(onsafe);
@@ -770,6 +782,21 @@ void Journaler::_flush(C_OnFinisher *onsafe)
   }
 }
 
+/*
+ * Group commit: while a journal write is in flight, a small flush is
+ * held back and issued when that write completes, so that a burst of
+ * events turns into a few large writes instead of one per event.  An
+ * idle journal still flushes immediately, and a flush never waits
+ * longer than the write ahead of it.
+ */
+bool Journaler::_should_defer_flush() const
+{
+  auto coalesce = cct->_conf.get_val<Option::size_t>("journaler_flush_coalesce_bytes");
+  return coalesce > 0 &&
+    !pending_safe.empty() &&
+    write_buf.length() < coalesce;
+}
+
 bool Journaler::_write_head_needed()
 {
   return last_wrote_head + seconds(cct->_conf.get_val<int64_t>("journaler_write_head_interval"))
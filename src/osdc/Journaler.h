@@ -317,7 +317,12 @@ private:
   // when safe through given offset
   std::map<uint64_t, std::list<Context*> > waitfor_safe;
 
+  // a flush was requested while a write was in flight and held back so
+  // that it goes out as one larger write when that write completes
+  bool flush_deferred = false;
+
   void _flush(C_OnFinisher *onsafe);
+  bool _should_defer_flush() const;
   void _do_flush(unsigned amount=0);
   void _finish_flush(int r, uint64_t start, ceph::real_time stamp);
   class C_Flush;
@@ -1276,7 +1276,7 @@ void ObjectCacher::bh_write_commit(int64_t poolid, sobject_t oid,
     finish_contexts(cct, ls, r);
 }
 
-void ObjectCacher::flush(ZTracer::Trace *trace, loff_t amount)
+void ObjectCacher::flush(ZTracer::Trace *trace, loff_t amount, int *max_count)
 {
   ceph_assert(trace != nullptr);
   ceph_assert(ceph_mutex_is_locked(lock));
@@ -1291,17 +1291,19 @@ void ObjectCacher::flush(ZTracer::Trace *trace, loff_t amount)
    * lru_dirty.lru_get_next_expire() again.
    */
   int64_t left = amount;
-  while (amount == 0 || left > 0) {
+  while ((amount == 0 || left > 0) && (!max_count || *max_count > 0)) {
     BufferHead *bh = static_cast<BufferHead*>(
       bh_lru_dirty.lru_get_next_expire());
     if (!bh) break;
     if (bh->last_write > cutoff) break;
 
     if (scattered_write) {
-      bh_write_adjacencies(bh, cutoff, amount > 0 ? &left : NULL, NULL);
+      bh_write_adjacencies(bh, cutoff, amount > 0 ? &left : NULL, max_count);
     } else {
       left -= bh->length();
       bh_write(bh, *trace);
+      if (max_count)
+	--*max_count;
     }
   }
 }
@@ -1843,6 +1845,23 @@ void ObjectCacher::C_WaitForWrite::finish(int r)
   m_onfinish->complete(r);
 }
 
+bool ObjectCacher::write_would_block(uint64_t len) const
+{
+  ceph_assert(ceph_mutex_is_locked(lock));
+  if (!block_writes_upfront)
+    return false;
+  // write-thru waits for its own flush
+  if (max_dirty == 0)
+    return true;
+  // same test as _maybe_wait_for_writeback(), with this write's bytes and
+  // buffer head already counted as dirty
+  uint64_t max_dirty_bh = max_dirty >> BUFFER_MEMORY_WEIGHT;
+  return ((uint64_t)(get_stat_dirty() + get_stat_tx()) + len >=
+	  max_dirty + get_stat_dirty_waiting()) ||
+    (dirty_or_tx_bh.size() + 1 >=
+     max_dirty_bh + get_stat_nr_dirty_waiters());
+}
+
 void ObjectCacher::_maybe_wait_for_writeback(uint64_t len,
 					     ZTracer::Trace *trace)
 {
@@ -1962,18 +1981,20 @@ void ObjectCacher::flusher_entry()
       trace.event("start");
     }
 
+    // bound the writeback started under the lock in both cases, so a
+    // large dirty backlog does not stall readers and writers
+    int max = MAX_FLUSH_UNDER_LOCK;
     if (actual > 0 && (uint64_t) actual > target_dirty) {
       // flush some dirty pages
       ldout(cct, 10) << "flusher " << get_stat_dirty() << " dirty + "
 		     << get_stat_dirty_waiting() << " dirty_waiting > target "
 		     << target_dirty << ", flushing some dirty bhs" << dendl;
-      flush(&trace, actual - target_dirty);
+      flush(&trace, actual - target_dirty, &max);
     } else {
       // check tail of lru for old dirty items
       ceph::real_time cutoff = ceph::real_clock::now();
       cutoff -= max_dirty_age;
       BufferHead *bh = 0;
-      int max = MAX_FLUSH_UNDER_LOCK;
       while ((bh = static_cast<BufferHead*>(bh_lru_dirty.
 					    lru_get_next_expire())) != 0 &&
 	     bh->last_write <= cutoff &&
@@ -1986,13 +2007,13 @@ void ObjectCacher::flusher_entry()
 	  --max;
 	}
       }
-      if (!max) {
-	// back off the lock to avoid starving other threads
-        trace.event("backoff");
-	l.unlock();
-	l.lock();
-	continue;
-      }
+    }
+    if (max <= 0) {
+      // back off the lock to avoid starving other threads
+      trace.event("backoff");
+      l.unlock();
+      l.lock();
+      continue;
     }
 
     trace.event("finish");
@@ -541,7 +541,7 @@ class ObjectCacher {
 			    int64_t *amount, int *max_count);
 
   void trim();
-  void flush(ZTracer::Trace *trace, loff_t amount=0);
+  void flush(ZTracer::Trace *trace, loff_t amount=0, int *max_count=nullptr);
 
   /**
    * flush a range of buffers
@@ -619,6 +619,8 @@ class ObjectCacher {
 	     ZTracer::Trace *parent_trace = nullptr);
   bool is_cached(ObjectSet *oset, std::vector<ObjectExtent>& extents,
 		 snapid_t snapid);
+  // would writex() of len bytes have to wait for writeback?
+  bool write_would_block(uint64_t len) const;
 
 private:
   // write blocking
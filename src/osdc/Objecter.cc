@@ -174,6 +174,7 @@ enum {
   l_osdc_osd_session_open,
   l_osdc_osd_session_close,
   l_osdc_osd_laggy,
+  l_osdc_op_adaptive_replica_read,
 
   l_osdc_osdop_omap_wr,
   l_osdc_osdop_omap_rd,
@@ -369,6 +370,9 @@ void Objecter::init()
     pcb.add_u64_counter(l_osdc_osd_session_close, "osd_session_close",
 			"Sessions closed");
     pcb.add_u64(l_osdc_osd_laggy, "osd_laggy", "Laggy OSD sessions");
+    pcb.add_u64_counter(l_osdc_op_adaptive_replica_read,
+			"op_adaptive_replica_read",
+			"Balanced reads sent to a non-primary chosen by latency");
 
     pcb.add_u64_counter(l_osdc_osdop_omap_wr, "omap_wr",
 			"OSD OMAP write operations");
@@ -411,6 +415,7 @@ void Objecter::start(const OSDMap* o)
   start_tick();
   if (o) {
     osdmap->deepish_copy_from(*o);
+    invalidate_pg_mapping(osdmap->get_epoch(), nullptr);
     prune_pg_mapping(osdmap->get_pools());
   } else if (osdmap->get_epoch() == 0) {
     _maybe_request_map();
@@ -1158,6 +1163,51 @@ void Objecter::_scan_requests(
   }
 }
 
+void Objecter::invalidate_pg_mapping(epoch_t epoch,
+				     const OSDMap::Incremental *inc)
+{
+  std::lock_guard l{pg_mapping_lock};
+  if (!inc ||
+      inc->fullmap.length() ||
+      inc->crush.length() ||
+      inc->new_max_osd >= 0 ||
+      !inc->new_up_client.empty() ||
+      !inc->new_state.empty() ||
+      !inc->new_weight.empty() ||
+      !inc->new_primary_affinity.empty()) {
+    // anything may have moved
+    pg_mapping_valid_since = epoch;
+    pool_mapping_valid_since.clear();
+    return;
+  }
+  auto invalidate_pool = [&](int64_t pool) {
+    pool_mapping_valid_since[pool] = epoch;
+  };
+  for (auto& p : inc->new_pools) {
+    invalidate_pool(p.first);
+  }
+  for (auto pool : inc->old_pools) {
+    invalidate_pool(pool);
+  }
+  auto invalidate_pgs = [&](const auto& pgs) {
+    for (auto& p : pgs) {
+      if constexpr (std::is_same_v<std::decay_t<decltype(p)>, pg_t>) {
+	invalidate_pool(p.pool());
+      } else {
+	invalidate_pool(p.first.pool());
+      }
+    }
+  };
+  invalidate_pgs(inc->new_pg_temp);
+  invalidate_pgs(inc->new_primary_temp);
+  invalidate_pgs(inc->new_pg_upmap);
+  invalidate_pgs(inc->old_pg_upmap);
+  invalidate_pgs(inc->new_pg_upmap_items);
+  invalidate_pgs(inc->old_pg_upmap_items);
+  invalidate_pgs(inc->new_pg_upmap_primary);
+  invalidate_pgs(inc->old_pg_upmap_primary);
+}
+
 void Objecter::handle_osd_map(MOSDMap *m)
 {
   ceph::shunique_lock sul(rwlock, acquire_unique);
@@ -1208,6 +1258,7 @@ void Objecter::handle_osd_map(MOSDMap *m)
 			<< dendl;
 	  OSDMap::Incremental inc(m->incremental_maps[e]);
 	  osdmap->apply_incremental(inc);
+	  invalidate_pg_mapping(osdmap->get_epoch(), &inc);
 
           emit_blocklist_events(inc);
 
@@ -1220,6 +1271,7 @@ void Objecter::handle_osd_map(MOSDMap *m)
 
           emit_blocklist_events(*osdmap, *new_osdmap);
           osdmap = std::move(new_osdmap);
+	  invalidate_pg_mapping(osdmap->get_epoch(), nullptr);
 
 	  logger->inc(l_osdc_map_full);
 	}
@@ -1280,6 +1332,7 @@ void Objecter::handle_osd_map(MOSDMap *m)
 	ldout(cct, 3) << "handle_osd_map decoding full epoch "
 		      << m->get_last() << dendl;
 	osdmap->decode(m->maps[m->get_last()]);
+	invalidate_pg_mapping(osdmap->get_epoch(), nullptr);
         prune_pg_mapping(osdmap->get_pools());
 
 	_scan_requests(homeless_session, false, false, NULL,
@@ -1913,11 +1966,69 @@ void Objecter::_reopen_session(OSDSession *s)
   logger->inc(l_osdc_osd_session_open);
 }
 
+void Objecter::_note_read_latency(int osd, ceph::timespan lat)
+{
+  // the clock is coarse; don't let fast osds collapse to zero
+  double secs = std::max(std::chrono::duration<double>(lat).count(), 0.001);
+  std::lock_guard l(read_lat_lock);
+  auto [p, inserted] = osd_read_lat.emplace(osd, secs);
+  if (!inserted) {
+    p->second += (secs - p->second) / 8;
+  }
+}
+
+unsigned Objecter::_pick_adaptive_read_replica(const std::vector<int>& acting)
+{
+  std::vector<double> w(acting.size(), 0.0);
+  {
+    std::lock_guard l(read_lat_lock);
+    double sum = 0;
+    unsigned known = 0;
+    for (unsigned i = 0; i < acting.size(); ++i) {
+      auto p = osd_read_lat.find(acting[i]);
+      if (p != osd_read_lat.end()) {
+	w[i] = p->second;
+	sum += p->second;
+	++known;
+      }
+    }
+    if (!known) {
+      return rand() % acting.size();
+    }
+    // osds we have not read from yet look average, so they get sampled
+    for (auto& i : w) {
+      if (i == 0.0) {
+	i = sum / known;
+      }
+    }
+  }
+  // Pick proportionally to inverse latency rather than always taking the
+  // fastest, so that a slow osd keeps getting the odd read and its
+  // estimate recovers once it does.
+  double total = 0;
+  for (auto& i : w) {
+    i = 1.0 / i;
+    total += i;
+  }
+  double r = total * (rand() / ((double)RAND_MAX + 1.0));
+  for (unsigned i = 0; i < w.size(); ++i) {
+    if (r < w[i]) {
+      return i;
+    }
+    r -= w[i];
+  }
+  return w.size() - 1;
+}
+
 void Objecter::close_session(OSDSession *s)
 {
   // rwlock is locked unique
 
   ldout(cct, 10) << "close_session for osd." << s->osd << dendl;
+  {
+    std::lock_guard l(read_lat_lock);
+    osd_read_lat.erase(s->osd);
+  }
   if (s->con) {
     s->con->set_priv(NULL);
     s->con->mark_down();
@@ -2463,8 +2574,18 @@ void Objecter::_op_submit(Op *op, shunique_lock<ceph::shared_mutex>& sul, ceph_t
 
   _session_op_assign(s, op);
 
+  // Only build the message under the session lock; encoding and handing
+  // it to the messenger happen after we let go of it, so that threads
+  // submitting to the same OSD do not serialize on s->lock.  We keep
+  // rwlock, so no map change can resend the op in between, and a reply
+  // cannot arrive before the message is sent.
+  MOSDOp *m = nullptr;
+  ConnectionRef con;
   if (need_send) {
-    _send_op(op);
+    m = _prepare_send_op(op);
+    if (m) {
+      con = s->con;
+    }
   }
 
   // Last chance to touch Op here, after giving up session lock it can
@@ -2478,6 +2599,9 @@ void Objecter::_op_submit(Op *op, shunique_lock<ceph::shared_mutex>& sul, ceph_t
   op = NULL;
 
   sl.unlock();
+  if (m) {
+    con->send_message(m);
+  }
   put_session(s);
 
   ldout(cct, 5) << num_in_flight << " in flight" << dendl;
@@ -2959,7 +3083,17 @@ int Objecter::_calc_target(op_target_t *t, Connection *con, bool any_change)
         !is_write && pi->is_replicated() && t->acting.size() > 1) {
       int osd;
       ceph_assert(is_read && t->acting[0] == acting_primary);
-      if (t->flags & CEPH_OSD_FLAG_BALANCE_READS) {
+      if ((t->flags & CEPH_OSD_FLAG_BALANCE_READS) &&
+	  cct->_conf->objecter_balance_reads_adaptive) {
+	unsigned p = _pick_adaptive_read_replica(t->acting);
+	if (p) {
+	  t->used_replica = true;
+	  logger->inc(l_osdc_op_adaptive_replica_read);
+	}
+	osd = t->acting[p];
+	ldout(cct, 10) << " chose osd." << osd << " of " << t->acting
+		       << " by read latency" << dendl;
+      } else if (t->flags & CEPH_OSD_FLAG_BALANCE_READS) {
 	int p = rand() % t->acting.size();
 	if (p)
 	  t->used_replica = true;
@@ -3242,6 +3376,16 @@ Objecter::MOSDOp *Objecter::_prepare_osd_op(Op *op)
 }
 
 void Objecter::_send_op(Op *op)
+{
+  // rwlock is locked
+  // op->session->lock is locked
+  MOSDOp *m = _prepare_send_op(op);
+  if (m) {
+    op->session->con->send_message(m);
+  }
+}
+
+Objecter::MOSDOp *Objecter::_prepare_send_op(Op *op)
 {
   // rwlock is locked
   // op->session->lock is locked
@@ -3265,7 +3409,7 @@ void Objecter::_send_op(Op *op)
 	ldout(cct, 10) << __func__ << " backoff " << op->target.actual_pgid
 		       << " id " << q->second.id << " on " << hoid
 		       << ", queuing " << op << " tid " << op->tid << dendl;
-	return;
+	return nullptr;
       }
     }
   }
@@ -3311,7 +3455,7 @@ void Objecter::_send_op(Op *op)
   if (op->trace.valid()) {
     m->trace.init("op msg", nullptr, &op->trace);
   }
-  op->session->con->send_message(m);
+  return m;
 }
 
 int Objecter::calc_op_budget(const bc::small_vector_base<OSDOp>& ops)
@@ -3568,6 +3712,11 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
   }
   logger->inc(l_osdc_op_reply);
   logger->tinc(l_osdc_op_latency, ceph::coarse_mono_time::clock::now() - op->stamp);
+  if ((op->target.flags & CEPH_OSD_FLAG_READ) &&
+      !(op->target.flags & CEPH_OSD_FLAG_WRITE) &&
+      cct->_conf->objecter_balance_reads_adaptive) {
+    _note_read_latency(s->osd, ceph::coarse_mono_clock::now() - op->stamp);
+  }
   logger->set(l_osdc_op_inflight, num_in_flight);
 
   /* get it before we call _finish_op() */
@@ -1649,6 +1649,16 @@ public:
 
   std::atomic<bool> initialized{false};
 
+private:
+  // smoothed read latency per osd as seen by this client (seconds); feeds
+  // the replica choice for balanced reads with objecter_balance_reads_adaptive
+  ceph::mutex read_lat_lock = ceph::make_mutex("Objecter::read_lat_lock");
+  std::map<int, double> osd_read_lat;
+
+  void _note_read_latency(int osd, ceph::timespan lat);
+  unsigned _pick_adaptive_read_replica(const std::vector<int>& acting);
+public:
+
 private:
   std::atomic<uint64_t> last_tid{0};
   std::atomic<unsigned> inflight_ops{0};
@@ -1680,6 +1690,11 @@ private:
     ceph::make_shared_mutex("Objecter::pg_mapping_lock");
   // pool -> pg mapping
   std::map<int64_t, std::vector<pg_mapping_t>> pg_mappings;
+  // mappings computed at or after these epochs are still current; most
+  // maps change nothing that placement depends on, so entries can outlive
+  // the epoch they were computed in
+  epoch_t pg_mapping_valid_since = 0;
+  std::map<int64_t, epoch_t> pool_mapping_valid_since;
 
   // convenient accessors
   bool lookup_pg_mapping(const pg_t& pg, epoch_t epoch, std::vector<int> *up,
@@ -1692,9 +1707,16 @@ private:
     auto& mapping_array = it->second;
     if (pg.ps() >= mapping_array.size())
       return false;
-    if (mapping_array[pg.ps()].epoch != epoch) // stale
-      return false;
     auto& pg_mapping = mapping_array[pg.ps()];
+    epoch_t valid_since = pg_mapping_valid_since;
+    if (auto p = pool_mapping_valid_since.find(pg.pool());
+        p != pool_mapping_valid_since.end()) {
+      valid_since = std::max(valid_since, p->second);
+    }
+    if (pg_mapping.epoch == 0 ||
+        pg_mapping.epoch < valid_since ||
+        pg_mapping.epoch > epoch) // stale
+      return false;
     *up = pg_mapping.up;
     *up_primary = pg_mapping.up_primary;
     *acting = pg_mapping.acting;
@@ -1707,6 +1729,9 @@ private:
     ceph_assert(pg.ps() < mapping_array.size());
     mapping_array[pg.ps()] = std::move(pg_mapping);
   }
+  /// drop cached mappings the given map change may have moved; with
+  /// no incremental (a full map), drop all of them
+  void invalidate_pg_mapping(epoch_t epoch, const OSDMap::Incremental *inc);
   void prune_pg_mapping(const mempool::osdmap::map<int64_t,pg_pool_t>& pools) {
     std::lock_guard l{pg_mapping_lock};
     for (auto& pool : pools) {
@@ -1725,6 +1750,14 @@ private:
       }
       it++;
     }
+    for (auto it = pool_mapping_valid_since.begin();
+         it != pool_mapping_valid_since.end(); ) {
+      if (!pools.count(it->first)) {
+        pool_mapping_valid_since.erase(it++);
+        continue;
+      }
+      it++;
+    }
   }
 
 public:
@@ -1740,7 +1773,9 @@ private:
 
   mutable ceph::shared_mutex rwlock =
 	   ceph::make_shared_mutex("Objecter::rwlock");
-  ceph::timer<ceph::coarse_mono_clock> timer;
+  // Mostly op timeouts that are cancelled long before they are due, so
+  // a wheel beats keeping them sorted.
+  ceph::wheel_timer<ceph::coarse_mono_clock> timer;
 
   PerfCounters* logger = nullptr;
 
@@ -1983,17 +2018,18 @@ public:
       complete(std::move(onfinish), ec, r);
     }
 
-    Op(const object_t& o, const object_locator_t& ol,  osdc_opvec&& _ops,
-       int f, std::unique_ptr<OpComp>&& fin,
-       version_t *ov, int *offset = nullptr,
-       ZTracer::Trace *parent_trace = nullptr) :
+    // out_bl, out_handler, out_rval and out_ec are left empty for the
+    // caller to swap in from an ObjectOperation, instead of allocating
+    // them here only to be replaced
+    struct unsized_outs_t {};
+
+    template <typename OnFinish>
+    Op(unsized_outs_t, const object_t& o, const object_locator_t& ol,
+       osdc_opvec&& _ops, int f, OnFinish&& fin, version_t *ov,
+       int *offset = nullptr, ZTracer::Trace *parent_trace = nullptr) :
       target(o, ol, f),
       ops(std::move(_ops)),
-      out_bl(ops.size(), nullptr),
-      out_handler(ops.size()),
-      out_rval(ops.size(), nullptr),
-      out_ec(ops.size(), nullptr),
-      onfinish(std::move(fin)),
+      onfinish(std::forward<OnFinish>(fin)),
       objver(ov),
       data_offset(offset) {
       if (target.base_oloc.key == o)
@@ -2004,44 +2040,29 @@ public:
       }
     }
 
+    Op(const object_t& o, const object_locator_t& ol,  osdc_opvec&& _ops,
+       int f, std::unique_ptr<OpComp>&& fin,
+       version_t *ov, int *offset = nullptr,
+       ZTracer::Trace *parent_trace = nullptr) :
+      Op(unsized_outs_t{}, o, ol, std::move(_ops), f, std::move(fin), ov,
+	 offset, parent_trace) {
+      size_outs();
+    }
+
     Op(const object_t& o, const object_locator_t& ol, osdc_opvec&& _ops,
        int f, Context* fin, version_t *ov, int *offset = nullptr,
        ZTracer::Trace *parent_trace = nullptr) :
-      target(o, ol, f),
-      ops(std::move(_ops)),
-      out_bl(ops.size(), nullptr),
-      out_handler(ops.size()),
-      out_rval(ops.size(), nullptr),
-      out_ec(ops.size(), nullptr),
-      onfinish(fin),
-      objver(ov),
-      data_offset(offset) {
-      if (target.base_oloc.key == o)
-	target.base_oloc.key.clear();
-      if (parent_trace && parent_trace->valid()) {
-        trace.init("op", nullptr, parent_trace);
-        trace.event("start");
-      }
+      Op(unsized_outs_t{}, o, ol, std::move(_ops), f, fin, ov, offset,
+	 parent_trace) {
+      size_outs();
     }
 
     Op(const object_t& o, const object_locator_t& ol, osdc_opvec&&  _ops,
        int f, fu2::unique_function<OpSig>&& fin, version_t *ov, int *offset = nullptr,
        ZTracer::Trace *parent_trace = nullptr) :
-      target(o, ol, f),
-      ops(std::move(_ops)),
-      out_bl(ops.size(), nullptr),
-      out_handler(ops.size()),
-      out_rval(ops.size(), nullptr),
-      out_ec(ops.size(), nullptr),
-      onfinish(std::move(fin)),
-      objver(ov),
-      data_offset(offset) {
-      if (target.base_oloc.key == o)
-	target.base_oloc.key.clear();
-      if (parent_trace && parent_trace->valid()) {
-        trace.init("op", nullptr, parent_trace);
-        trace.event("start");
-      }
+      Op(unsized_outs_t{}, o, ol, std::move(_ops), f, std::move(fin), ov,
+	 offset, parent_trace) {
+      size_outs();
     }
 
     bool operator<(const Op& other) const {
@@ -2049,6 +2070,13 @@ public:
     }
 
   private:
+    void size_outs() {
+      out_bl.resize(ops.size(), nullptr);
+      out_handler.resize(ops.size());
+      out_rval.resize(ops.size(), nullptr);
+      out_ec.resize(ops.size(), nullptr);
+    }
+
     ~Op() override {
       trace.event("finish");
     }
@@ -2455,6 +2483,8 @@ public:
   ceph::timespan osd_timeout;
 
   MOSDOp *_prepare_osd_op(Op *op);
+  /// build the message for op, or nullptr if the op is held by a backoff
+  MOSDOp *_prepare_send_op(Op *op);
   void _send_op(Op *op);
   void _send_op_account(Op *op);
   void _cancel_linger_op(Op *op);
@@ -2918,7 +2948,8 @@ public:
     Context *oncommit, version_t *objver = NULL,
     osd_reqid_t reqid = osd_reqid_t(),
     ZTracer::Trace *parent_trace = nullptr) {
-    Op *o = new Op(oid, oloc, std::move(op.ops), flags | global_op_flags |
+    Op *o = new Op(Op::unsized_outs_t{},
+		   oid, oloc, std::move(op.ops), flags | global_op_flags |
 		   CEPH_OSD_FLAG_WRITE, oncommit, objver,
 		   nullptr, parent_trace);
     o->priority = op.priority;
@@ -2951,7 +2982,8 @@ public:
 	      std::unique_ptr<Op::OpComp>&& oncommit,
 	      version_t *objver = NULL, osd_reqid_t reqid = osd_reqid_t(),
 	      ZTracer::Trace *parent_trace = nullptr) {
-    Op *o = new Op(oid, oloc, std::move(op.ops), flags | global_op_flags |
+    Op *o = new Op(Op::unsized_outs_t{},
+		   oid, oloc, std::move(op.ops), flags | global_op_flags |
 		   CEPH_OSD_FLAG_WRITE, std::move(oncommit), objver,
 		   nullptr, parent_trace);
     o->priority = op.priority;
@@ -2974,7 +3006,8 @@ public:
     int *data_offset = NULL,
     uint64_t features = 0,
     ZTracer::Trace *parent_trace = nullptr) {
-    Op *o = new Op(oid, oloc, std::move(op.ops), flags | global_op_flags |
+    Op *o = new Op(Op::unsized_outs_t{},
+		   oid, oloc, std::move(op.ops), flags | global_op_flags |
 		   CEPH_OSD_FLAG_READ, onack, objver,
 		   data_offset, parent_trace);
     o->priority = op.priority;
@@ -3010,7 +3043,8 @@ public:
 	    int flags, std::unique_ptr<Op::OpComp>&& onack,
 	    version_t *objver = nullptr, int *data_offset = nullptr,
 	    uint64_t features = 0, ZTracer::Trace *parent_trace = nullptr) {
-    Op *o = new Op(oid, oloc, std::move(op.ops), flags | global_op_flags |
+    Op *o = new Op(Op::unsized_outs_t{},
+		   oid, oloc, std::move(op.ops), flags | global_op_flags |
 		   CEPH_OSD_FLAG_READ, std::move(onack), objver,
 		   data_offset, parent_trace);
     o->priority = op.priority;
@@ -3036,7 +3070,7 @@ public:
     ObjectOperation& op, ceph::buffer::list *pbl, int flags,
     Context *onack, epoch_t *reply_epoch,
     int *ctx_budget) {
-    Op *o = new Op(object_t(), oloc,
+    Op *o = new Op(Op::unsized_outs_t{}, object_t(), oloc,
 		   std::move(op.ops),
 		   flags | global_op_flags | CEPH_OSD_FLAG_READ |
 		   CEPH_OSD_FLAG_IGNORE_OVERLAY,
@@ -3075,7 +3109,7 @@ public:
     ObjectOperation& op, ceph::buffer::list *pbl, int flags,
     std::unique_ptr<Op::OpComp>&& onack, epoch_t *reply_epoch, int *ctx_budget) {
     ceph_tid_t tid;
-    Op *o = new Op(object_t(), oloc,
+    Op *o = new Op(Op::unsized_outs_t{}, object_t(), oloc,
 		   std::move(op.ops),
 		   flags | global_op_flags | CEPH_OSD_FLAG_READ |
 		   CEPH_OSD_FLAG_IGNORE_OVERLAY,
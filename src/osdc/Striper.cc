@@ -130,6 +130,7 @@ void Striper::file_to_extents(CephContext *cct, const char *object_format,
                   &lightweight_object_extents);
 
   // convert lightweight object extents to heavyweight version
+  const auto oloc = OSDMap::file_to_object_locator(*layout);
   extents.reserve(lightweight_object_extents.size());
   for (auto& lightweight_object_extent : lightweight_object_extents) {
     auto& object_extent = extents.emplace_back(
@@ -138,7 +139,7 @@ void Striper::file_to_extents(CephContext *cct, const char *object_format,
       lightweight_object_extent.offset, lightweight_object_extent.length,
       lightweight_object_extent.truncate_size);
 
-    object_extent.oloc = OSDMap::file_to_object_locator(*layout);
+    object_extent.oloc = oloc;
     object_extent.buffer_extents.reserve(
       lightweight_object_extent.buffer_extents.size());
     object_extent.buffer_extents.insert(
@@ -161,6 +162,7 @@ void Striper::file_to_extents(
                   &lightweight_object_extents);
 
   // convert lightweight object extents to heavyweight version
+  const auto oloc = OSDMap::file_to_object_locator(*layout);
   for (auto& lightweight_object_extent : lightweight_object_extents) {
     auto oid = format_oid(object_format, lightweight_object_extent.object_no);
     auto& object_extent = object_extents[oid].emplace_back(
@@ -168,7 +170,7 @@ void Striper::file_to_extents(
       lightweight_object_extent.offset, lightweight_object_extent.length,
       lightweight_object_extent.truncate_size);
 
-      object_extent.oloc = OSDMap::file_to_object_locator(*layout);
+      object_extent.oloc = oloc;
       object_extent.buffer_extents.reserve(
         lightweight_object_extent.buffer_extents.size());
       object_extent.buffer_extents.insert(
@@ -238,8 +240,13 @@ void Striper::file_to_extents(
 		   << dendl;
 
     striper::LightweightObjectExtent* ex = nullptr;
-    auto it = std::upper_bound(object_extents->begin(), object_extents->end(),
-                               objectno, OrderByObject());
+    // extents are usually generated in ascending object order (always so
+    // for stripe_count == 1), so check the tail before searching
+    auto it = (object_extents->empty() ||
+               object_extents->back().object_no < objectno) ?
+      object_extents->end() :
+      std::upper_bound(object_extents->begin(), object_extents->end(),
+                       objectno, OrderByObject());
     striper::LightweightObjectExtents::reverse_iterator rev_it(it);
     if (rev_it == object_extents->rend() ||
         rev_it->object_no != objectno ||
@@ -229,6 +229,18 @@ void D3nDataCache::put(bufferlist& bl, unsigned int len, std::string& oid)
       ldout(cct, 10) << "D3nDataCache: NOTE: data put in cache already issued, no rewrite" << dendl;
       return;
     }
+    const uint64_t admission_threshold = cct->_conf->rgw_d3n_l1_admission_threshold;
+    if (admission_threshold > 1) {
+      if (d3n_admission_counts.size() >= d3n_admission_max_tracked) {
+        d3n_admission_counts.clear();
+      }
+      auto& misses = d3n_admission_counts[oid];
+      if (++misses < admission_threshold) {
+        ldout(cct, 20) << "D3nDataCache: " << __func__ << "(): not admitting oid=" << oid << ", misses=" << misses << dendl;
+        return;
+      }
+      d3n_admission_counts.erase(oid);
+    }
     d3n_outstanding_write_list.insert(oid);
   }
   {
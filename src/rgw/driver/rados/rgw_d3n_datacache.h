@@ -64,6 +64,11 @@ struct D3nDataCache {
 private:
   std::unordered_map<std::string, D3nChunkDataInfo*> d3n_cache_map;
   std::set<std::string> d3n_outstanding_write_list;
+  // misses seen so far on chunks that are not yet admitted; reset
+  // whenever it grows past d3n_admission_max_tracked so that old
+  // counts age out
+  std::unordered_map<std::string, uint32_t> d3n_admission_counts;
+  static constexpr size_t d3n_admission_max_tracked = 65536;
   std::mutex d3n_cache_lock;
   std::mutex d3n_eviction_lock;
 
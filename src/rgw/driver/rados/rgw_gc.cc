@@ -73,20 +73,20 @@ std::tuple<int, std::optional<cls_rgw_obj_chain>> RGWGC::send_split_chain(const
     cls_rgw_obj_chain broken_chain;
     ldpp_dout(this, 20) << "RGWGC::send_split_chain - rgw_max_chunk_size is: " << cct->_conf->rgw_max_chunk_size << dendl;
 
-    for (auto it = chain.objs.begin(); it != chain.objs.end(); it++) {
+    // the encoded size is additive over the chain's objects, so keep a running
+    // estimate instead of re-encoding the whole partial chain for every object
+    cls_rgw_gc_set_entry_op op;
+    op.info.tag = tag;
+    const size_t base_encoded_size = op.estimate_encoded_size();
+    size_t total_encoded_size = base_encoded_size;
+
+    for (auto it = chain.objs.begin(); it != chain.objs.end(); ++it) {
       ldpp_dout(this, 20) << "RGWGC::send_split_chain - adding obj with name: " << it->key << dendl;
-      broken_chain.objs.emplace_back(*it);
-      cls_rgw_gc_obj_info info;
-      info.tag = tag;
-      info.chain = broken_chain;
-      cls_rgw_gc_set_entry_op op;
-      op.info = info;
-      size_t total_encoded_size = op.estimate_encoded_size();
-      ldpp_dout(this, 20) << "RGWGC::send_split_chain - total_encoded_size is: " << total_encoded_size << dendl;
-
-      if (total_encoded_size > cct->_conf->rgw_max_chunk_size) { //dont add to chain, and send to gc
-        broken_chain.objs.pop_back();
-        --it;
+      const size_t obj_encoded_size = it->estimate_encoded_size();
+      ldpp_dout(this, 20) << "RGWGC::send_split_chain - total_encoded_size is: " << total_encoded_size + obj_encoded_size << dendl;
+
+      if (!broken_chain.objs.empty() &&
+          total_encoded_size + obj_encoded_size > cct->_conf->rgw_max_chunk_size) { //dont add to chain, and send to gc
         ldpp_dout(this, 20) << "RGWGC::send_split_chain - more than, dont add to broken chain and send chain" << dendl;
         auto ret = send_chain(broken_chain, tag);
         if (ret < 0) {
@@ -95,7 +95,10 @@ std::tuple<int, std::optional<cls_rgw_obj_chain>> RGWGC::send_split_chain(const
           return {ret, {broken_chain}};
         }
         broken_chain.objs.clear();
+        total_encoded_size = base_encoded_size;
       }
+      broken_chain.objs.emplace_back(*it);
+      total_encoded_size += obj_encoded_size;
     }
     if (!broken_chain.objs.empty()) { //when the chain is smaller than or equal to rgw_max_chunk_size
       ldpp_dout(this, 20) << "RGWGC::send_split_chain - sending leftover objects" << dendl;
@@ -578,8 +581,11 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
   string next_marker;
   bool truncated;
   IoCtx *ctx = new IoCtx;
+  // keep the ioctx across listing chunks; tail objects of consecutive
+  // entries are nearly always in the same data pool
+  string last_pool;
+  const int max = cct->_conf->rgw_gc_max_list_chunk;
   do {
-    int max = 100;
     std::list<cls_rgw_gc_obj_info> entries;
 
     int ret = 0;
@@ -627,7 +633,6 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
 
     marker = next_marker;
 
-    string last_pool;
     std::list<cls_rgw_gc_obj_info>::iterator iter;
     for (iter = entries.begin(); iter != entries.end(); ++iter) {
       cls_rgw_gc_obj_info& info = *iter;
@@ -14,6 +14,8 @@
 #include "rgw_perf_counters.h"
 #include "common/dout.h"
 #include <chrono>
+#include <mutex>
+#include <unordered_map>
 
 #define dout_subsys ceph_subsys_rgw
 
@@ -73,6 +75,14 @@ class Manager : public DoutPrefixProvider {
 
   CephContext *get_cct() const override { return cct; }
   unsigned get_subsys() const override { return dout_subsys; }
+
+  // push endpoints created while processing a single batch of queue entries
+  // entries of a queue usually share the same endpoint, so they are created
+  // once per batch instead of once per entry
+  struct endpoint_cache_t {
+    std::mutex lock;
+    std::unordered_map<std::string, RGWPubSubEndpoint::Ptr> endpoints;
+  };
   std::ostream& gen_prefix(std::ostream& out) const override { return out << "rgw notify: "; }
 
   // read the list of queues from the queue list object
@@ -161,7 +171,7 @@ class Manager : public DoutPrefixProvider {
 
   // processing of a specific entry
   // return whether processing was successfull (true) or not (false)
-  bool process_entry(const cls_queue_entry& entry, yield_context yield) {
+  bool process_entry(const cls_queue_entry& entry, endpoint_cache_t& endpoint_cache, yield_context yield) {
     event_entry_t event_entry;
     auto iter = entry.data.cbegin();
     try {
@@ -171,12 +181,26 @@ class Manager : public DoutPrefixProvider {
       return false;
     }
     try {
-      // TODO move endpoint creation to queue level
-      const auto push_endpoint = RGWPubSubEndpoint::create(event_entry.push_endpoint, event_entry.arn_topic,
-          RGWHTTPArgs(event_entry.push_endpoint_args, this), 
-          cct);
-      ldpp_dout(this, 20) << "INFO: push endpoint created: " << event_entry.push_endpoint <<
-        " for entry: " << entry.marker << dendl;
+      RGWPubSubEndpoint* push_endpoint;
+      {
+        // endpoint creation does not yield, so the lock is never held across a suspension
+        std::lock_guard lock_guard(endpoint_cache.lock);
+        const auto key = event_entry.push_endpoint + '\0' + event_entry.push_endpoint_args + '\0' + event_entry.arn_topic;
+        auto& cached = endpoint_cache.endpoints[key];
+        if (!cached) {
+          try {
+            cached = RGWPubSubEndpoint::create(event_entry.push_endpoint, event_entry.arn_topic,
+                RGWHTTPArgs(event_entry.push_endpoint_args, this),
+                cct);
+          } catch (...) {
+            endpoint_cache.endpoints.erase(key);
+            throw;
+          }
+          ldpp_dout(this, 20) << "INFO: push endpoint created: " << event_entry.push_endpoint <<
+            " for entry: " << entry.marker << dendl;
+        }
+        push_endpoint = cached.get();
+      }
       const auto ret = push_endpoint->send_to_completion_async(cct, event_entry.event, optional_yield(io_context, yield));
       if (ret < 0) {
         ldpp_dout(this, 5) << "WARNING: push entry: " << entry.marker << " to endpoint: " << event_entry.push_endpoint 
@@ -304,6 +328,7 @@ class Manager : public DoutPrefixProvider {
       auto has_error = false;
       auto remove_entries = false;
       auto entry_idx = 1U;
+      endpoint_cache_t endpoint_cache;
       tokens_waiter waiter(io_context);
       for (auto& entry : entries) {
         if (has_error) {
@@ -311,9 +336,9 @@ class Manager : public DoutPrefixProvider {
           break;
         }
         // TODO pass entry pointer instead of by-value
-        spawn::spawn(yield, [this, &queue_name, entry_idx, total_entries, &end_marker, &remove_entries, &has_error, &waiter, entry](yield_context yield) {
+        spawn::spawn(yield, [this, &queue_name, entry_idx, total_entries, &end_marker, &remove_entries, &has_error, &waiter, &endpoint_cache, entry](yield_context yield) {
             const auto token = waiter.make_token();
-            if (process_entry(entry, yield)) {
+            if (process_entry(entry, endpoint_cache, yield)) {
               ldpp_dout(this, 20) << "INFO: processing of entry: " << 
                 entry.marker << " (" << entry_idx << "/" << total_entries << ") from: " << queue_name << " ok" << dendl;
               remove_entries = true;
@@ -1783,6 +1783,11 @@ int RGWRados::Bucket::List::list_objects_ordered(
   // until we return at least one entry
   constexpr uint16_t SOFT_MAX_ATTEMPTS = 8;
 
+  // shards that have returned all of their remaining entries to us
+  // and had them all consumed; since the marker only moves forward
+  // there is no need to ask them again on later attempts
+  std::set<int> exhausted_shards;
+
   rgw_obj_index_key prev_marker;
   for (uint16_t attempt = 1; /* empty */; ++attempt) {
     ldpp_dout(dpp, 20) << __func__ <<
@@ -1815,7 +1820,8 @@ int RGWRados::Bucket::List::list_objects_ordered(
 					   &cls_filtered,
 					   &cur_marker,
                                            y,
-					   params.force_check_filter);
+					   params.force_check_filter,
+					   &exhausted_shards);
     if (r < 0) {
       return r;
     }
@@ -6583,8 +6589,9 @@ int RGWRados::Object::Read::iterate(const DoutPrefixProvider *dpp, int64_t ofs,
   CephContext *cct = store->ctx();
   const uint64_t chunk_size = cct->_conf->rgw_get_obj_max_req_size;
   const uint64_t window_size = cct->_conf->rgw_get_obj_window_size;
+  const uint64_t max_window_size = cct->_conf->rgw_get_obj_max_window_size;
 
-  auto aio = rgw::make_throttle(window_size, y);
+  auto aio = rgw::make_throttle(window_size, y, max_window_size);
   get_obj_data data(store, cb, &*aio, ofs, y);
 
   int r = store->iterate_obj(dpp, source->get_ctx(), source->get_bucket_info(),
@@ -8593,7 +8600,8 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
 				      bool* cls_filtered,
 				      rgw_obj_index_key* last_entry,
                                       optional_yield y,
-				      RGWBucketListNameFilter force_check_filter)
+				      RGWBucketListNameFilter force_check_filter,
+				      std::set<int>* exhausted_shards)
 {
   const bool bitx = cct->_conf->rgw_bucket_index_transaction_instrumentation;
 
@@ -8631,6 +8639,21 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     return r;
   }
 
+  if (exhausted_shards && !exhausted_shards->empty()) {
+    const size_t total_shards = shard_oids.size();
+    for (int s : *exhausted_shards) {
+      shard_oids.erase(s);
+    }
+    if (shard_oids.empty()) {
+      // every shard has already handed back everything past the marker
+      *is_truncated = false;
+      return 0;
+    }
+    ldpp_dout(dpp, 20) << __func__ <<
+      ": skipping " << total_shards - shard_oids.size() <<
+      " exhausted shard(s)" << dendl;
+  }
+
   const uint32_t shard_count = shard_oids.size();
   if (shard_count == 0) {
     ldpp_dout(dpp, 0) << "ERROR: " << __func__ <<
@@ -8878,7 +8901,8 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
   for (const auto& t : results_trackers) {
     if (!t.at_end() || t.is_truncated()) {
       *is_truncated = true;
-      break;
+    } else if (exhausted_shards) {
+      exhausted_shards->insert(t.shard_idx);
     }
   }
 
@@ -1419,7 +1419,8 @@ public:
 			      bool* cls_filtered,
 			      rgw_obj_index_key *last_entry,
                               optional_yield y,
-			      RGWBucketListNameFilter force_check_filter = {});
+			      RGWBucketListNameFilter force_check_filter = {},
+			      std::set<int>* exhausted_shards = nullptr);
   int cls_bucket_list_unordered(const DoutPrefixProvider *dpp,
                                 RGWBucketInfo& bucket_info,
                                 const rgw::bucket_index_layout_generation& idx_layout,
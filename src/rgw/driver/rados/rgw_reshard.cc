@@ -182,6 +182,85 @@ public:
 }; // class BucketReshardShard
 
 
+// lists the entries of one source bucket index shard, keeping the read
+// of the next page in flight while the caller works through the
+// current one
+class BucketReshardSourceShard {
+  RGWRados::BucketShard bs;
+  const uint32_t max_entries;
+  std::string marker;
+  librados::AioCompletion *c = nullptr;
+  rgw_cls_bi_list_ret next;
+  int next_ret = 0;
+
+  int issue_next() {
+    librados::ObjectReadOperation op;
+    cls_rgw_bi_list(op, std::string(), marker, max_entries, &next, &next_ret);
+
+    c = librados::Rados::aio_create_completion(nullptr, nullptr);
+    auto& ref = bs.bucket_obj.get_ref();
+    int ret = ref.pool.ioctx().aio_operate(ref.obj.oid, c, &op, nullptr);
+    if (ret < 0) {
+      c->release();
+      c = nullptr;
+    }
+    return ret;
+  }
+
+public:
+  BucketReshardSourceShard(RGWRados *store, uint32_t _max_entries) :
+    bs(store), max_entries(_max_entries)
+  {}
+
+  ~BucketReshardSourceShard() {
+    if (c) {
+      c->wait_for_complete();
+      c->release();
+    }
+  }
+
+  int init(const DoutPrefixProvider *dpp, const RGWBucketInfo& bucket_info,
+           const rgw::bucket_index_layout_generation& index, int shard_id) {
+    int ret = bs.init(dpp, bucket_info, index, shard_id);
+    if (ret < 0) {
+      ldpp_dout(dpp, 5) << "bs.init() returned ret=" << ret << dendl;
+      return ret;
+    }
+    return issue_next();
+  }
+
+  int get_next(std::list<rgw_cls_bi_entry> *entries, bool *is_truncated) {
+    ceph_assert(c);
+    c->wait_for_complete();
+    int ret = c->get_return_value();
+    c->release();
+    c = nullptr;
+
+    entries->clear();
+    if (ret == -ENOENT) {
+      *is_truncated = false;
+      return 0;
+    }
+    if (ret < 0) {
+      return ret;
+    }
+    if (next_ret < 0) {
+      return next_ret;
+    }
+
+    entries->swap(next.entries);
+    *is_truncated = next.is_truncated;
+    if (!entries->empty()) {
+      marker = entries->back().idx;
+    }
+    if (*is_truncated) {
+      return issue_next();
+    }
+    return 0;
+  }
+}; // class BucketReshardSourceShard
+
+
 class BucketReshardManager {
   rgw::sal::RadosStore *store;
   deque<librados::AioCompletion *> completions;
@@ -828,11 +907,17 @@ int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& curr
   for (int i = 0; i < num_source_shards; ++i) {
     bool is_truncated = true;
     marker.clear();
-    const std::string null_object_filter; // empty string since we're not filtering by object
+    // the next page of the source shard is read while this one is
+    // being sorted into the target shards
+    BucketReshardSourceShard source_shard(store->getRados(), max_entries);
+    int ret = source_shard.init(dpp, bucket_info, current, i);
+    if (ret < 0) {
+      derr << "ERROR: bi_list(): " << cpp_strerror(-ret) << dendl;
+      return ret;
+    }
     while (is_truncated) {
-      entries.clear();
-      int ret = store->getRados()->bi_list(dpp, bucket_info, i, null_object_filter, marker, max_entries, &entries, &is_truncated);
-      if (ret < 0 && ret != -ENOENT) {
+      ret = source_shard.get_next(&entries, &is_truncated);
+      if (ret < 0) {
         derr << "ERROR: bi_list(): " << cpp_strerror(-ret) << dendl;
         return ret;
       }
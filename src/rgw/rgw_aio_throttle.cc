@@ -45,6 +45,7 @@ AioResultList BlockingAioThrottle::get(const RGWSI_RADOS::Obj& obj,
   } else {
     // wait for the write size to become available
     pending_size += p->cost;
+    try_grow_window();
     if (!is_available()) {
       ceph_assert(waiter == Wait::None);
       waiter = Wait::Available;
@@ -135,6 +136,7 @@ AioResultList YieldingAioThrottle::get(const RGWSI_RADOS::Obj& obj,
   } else {
     // wait for the write size to become available
     pending_size += p->cost;
+    try_grow_window();
     if (!is_available()) {
       ceph_assert(waiter == Wait::None);
       ceph_assert(!completion);
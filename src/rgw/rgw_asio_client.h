@@ -51,6 +51,15 @@ class ClientIO : public io::RestfulClient,
     return write_data(buf, len);
   }
 
+  size_t send_body_buffers(const ceph::bufferlist& bl) override {
+    return write_buffers(bl);
+  }
+
+  /* Send all the buffers of @bl with one gathering write. On success
+   * returns the number of bytes written. On failure throws
+   * rgw::io::Exception. */
+  virtual size_t write_buffers(const ceph::bufferlist& bl) = 0;
+
   RGWEnv& get_env() noexcept override {
     return env;
   }
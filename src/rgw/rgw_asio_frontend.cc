@@ -83,11 +83,11 @@ class StreamIO : public rgw::asio::ClientIO {
         buffer(buffer)
   {}
 
-  size_t write_data(const char* buf, size_t len) override {
+  template <typename ConstBufferSequence>
+  size_t write(const ConstBufferSequence& buffers) {
     boost::system::error_code ec;
     timeout.start();
-    auto bytes = boost::asio::async_write(stream, boost::asio::buffer(buf, len),
-                                          yield[ec]);
+    auto bytes = boost::asio::async_write(stream, buffers, yield[ec]);
     timeout.cancel();
     if (ec) {
       ldout(cct, 4) << "write_data failed: " << ec.message() << dendl;
@@ -100,6 +100,19 @@ class StreamIO : public rgw::asio::ClientIO {
     return bytes;
   }
 
+  size_t write_data(const char* buf, size_t len) override {
+    return write(boost::asio::buffer(buf, len));
+  }
+
+  size_t write_buffers(const ceph::bufferlist& bl) override {
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.reserve(bl.get_num_buffers());
+    for (const auto& ptr : bl.buffers()) {
+      buffers.emplace_back(ptr.c_str(), ptr.length());
+    }
+    return write(buffers);
+  }
+
   size_t recv_body(char* buf, size_t max) override {
     auto& message = parser.get();
     auto& body_remaining = message.body();
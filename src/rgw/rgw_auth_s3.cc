@@ -901,8 +901,22 @@ static sha256_digest_t
 get_v4_signing_key(CephContext* const cct,
                    const std::string_view& credential_scope,
                    const std::string_view& secret_access_key,
-                   const DoutPrefixProvider *dpp)
+                   const DoutPrefixProvider *dpp,
+                   SigningKeyCache* const signing_keys = nullptr,
+                   const std::string_view& access_key_id = {})
 {
+  const bool use_cache = signing_keys && signing_keys->enabled();
+  sha256_digest_t secret_hash;
+  if (use_cache) {
+    secret_hash = calc_hash_sha256(secret_access_key);
+    sha256_digest_t cached;
+    if (signing_keys->find(access_key_id, credential_scope, secret_hash,
+                           cached)) {
+      ldpp_dout(dpp, 20) << "using cached signing key" << dendl;
+      return cached;
+    }
+  }
+
   std::string_view date, region, service;
   std::tie(date, region, service) = parse_cred_scope(credential_scope);
 
@@ -920,6 +934,10 @@ get_v4_signing_key(CephContext* const cct,
   ldpp_dout(dpp, 10) << "service_k = " << service_k << dendl;
   ldpp_dout(dpp, 10) << "signing_k = " << signing_key << dendl;
 
+  if (use_cache) {
+    signing_keys->add(access_key_id, credential_scope, secret_hash,
+                      signing_key);
+  }
   return signing_key;
 }
 
@@ -937,9 +955,12 @@ get_v4_signature(const std::string_view& credential_scope,
                  CephContext* const cct,
                  const std::string_view& secret_key,
                  const AWSEngine::VersionAbstractor::string_to_sign_t& string_to_sign,
-                 const DoutPrefixProvider *dpp)
+                 const DoutPrefixProvider *dpp,
+                 SigningKeyCache* const signing_keys,
+                 const std::string_view& access_key_id)
 {
-  auto signing_key = get_v4_signing_key(cct, credential_scope, secret_key, dpp);
+  auto signing_key = get_v4_signing_key(cct, credential_scope, secret_key, dpp,
+                                        signing_keys, access_key_id);
 
   /* The server-side generated digest for comparison. */
   const auto digest = calc_hmac_sha256(signing_key, string_to_sign);
@@ -1234,6 +1255,8 @@ AWSv4ComplMulti::create(const req_state* const s,
                         std::string_view date,
                         std::string_view credential_scope,
                         std::string_view seed_signature,
+                        SigningKeyCache* const signing_keys,
+                        std::string_view access_key_id,
                         const boost::optional<std::string>& secret_key)
 {
   if (!secret_key) {
@@ -1244,7 +1267,8 @@ AWSv4ComplMulti::create(const req_state* const s,
   }
 
   const auto signing_key = \
-    rgw::auth::s3::get_v4_signing_key(s->cct, credential_scope, *secret_key, s);
+    rgw::auth::s3::get_v4_signing_key(s->cct, credential_scope, *secret_key, s,
+                                      signing_keys, access_key_id);
 
   return std::make_shared<AWSv4ComplMulti>(s,
                                            std::move(date),
@@ -371,6 +371,8 @@ public:
                           std::string_view date,
                           std::string_view credential_scope,
                           std::string_view seed_signature,
+                          SigningKeyCache* signing_keys,
+                          std::string_view access_key_id,
                           const boost::optional<std::string>& secret_key);
 
 };
@@ -635,7 +637,9 @@ get_v4_signature(const std::string_view& credential_scope,
                  CephContext* const cct,
                  const std::string_view& secret_key,
                  const AWSEngine::VersionAbstractor::string_to_sign_t& string_to_sign,
-                 const DoutPrefixProvider *dpp);
+                 const DoutPrefixProvider *dpp,
+                 SigningKeyCache* signing_keys = nullptr,
+                 const std::string_view& access_key_id = {});
 
 extern AWSEngine::VersionAbstractor::server_signature_t
 get_v2_signature(CephContext*,
@@ -10,16 +10,27 @@
 
 using namespace std;
 
+std::vector<std::unique_lock<ceph::shared_mutex>> ObjectCache::lock_all()
+{
+  std::vector<std::unique_lock<ceph::shared_mutex>> locks;
+  locks.reserve(num_shards);
+  for (auto& shard : shards) {
+    locks.emplace_back(shard.lock);
+  }
+  return locks;
+}
+
 int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, uint32_t mask, rgw_cache_entry_info *cache_info)
 {
+  Shard& shard = get_shard(name);
 
-  std::shared_lock rl{lock};
-  std::unique_lock wl{lock, std::defer_lock}; // may be promoted to write lock
+  std::shared_lock rl{shard.lock};
+  std::unique_lock wl{shard.lock, std::defer_lock}; // may be promoted to write lock
   if (!enabled) {
     return -ENOENT;
   }
-  auto iter = cache_map.find(name);
-  if (iter == cache_map.end()) {
+  auto iter = shard.cache_map.find(name);
+  if (iter == shard.cache_map.end()) {
     ldpp_dout(dpp, 10) << "cache get: name=" << name << " : miss" << dendl;
     if (perfcounter) {
       perfcounter->inc(l_rgw_cache_miss);
@@ -33,12 +44,12 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
     rl.unlock();
     wl.lock(); // write lock for expiration
     // check that wasn't already removed by other thread
-    iter = cache_map.find(name);
-    if (iter != cache_map.end()) {
+    iter = shard.cache_map.find(name);
+    if (iter != shard.cache_map.end()) {
       for (auto &kv : iter->second.chained_entries)
         kv.first->invalidate(kv.second);
-      remove_lru(name, iter->second.lru_iter);
-      cache_map.erase(iter);
+      remove_lru(shard, name, iter->second.lru_iter);
+      shard.cache_map.erase(iter);
     }
     if (perfcounter) {
       perfcounter->inc(l_rgw_cache_miss);
@@ -48,14 +59,14 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
 
   ObjectCacheEntry *entry = &iter->second;
 
-  if (lru_counter - entry->lru_promotion_ts > lru_window) {
-    ldpp_dout(dpp, 20) << "cache get: touching lru, lru_counter=" << lru_counter
+  if (shard.lru_counter - entry->lru_promotion_ts > lru_window) {
+    ldpp_dout(dpp, 20) << "cache get: touching lru, lru_counter=" << shard.lru_counter
                    << " promotion_ts=" << entry->lru_promotion_ts << dendl;
     rl.unlock();
     wl.lock(); // write lock for touch_lru()
     /* need to redo this because entry might have dropped off the cache */
-    iter = cache_map.find(name);
-    if (iter == cache_map.end()) {
+    iter = shard.cache_map.find(name);
+    if (iter == shard.cache_map.end()) {
       ldpp_dout(dpp, 10) << "lost race! cache get: name=" << name << " : miss" << dendl;
       if(perfcounter) perfcounter->inc(l_rgw_cache_miss);
       return -ENOENT;
@@ -63,8 +74,8 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
 
     entry = &iter->second;
     /* check again, we might have lost a race here */
-    if (lru_counter - entry->lru_promotion_ts > lru_window) {
-      touch_lru(dpp, name, *entry, iter->second.lru_iter);
+    if (shard.lru_counter - entry->lru_promotion_ts > lru_window) {
+      touch_lru(dpp, shard, name, *entry, iter->second.lru_iter);
     }
   }
 
@@ -99,7 +110,17 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
                                     std::initializer_list<rgw_cache_entry_info*> cache_info_entries,
 				    RGWChainedCache::Entry *chained_entry)
 {
-  std::unique_lock l{lock};
+  // lock every shard involved, in shard order
+  std::array<bool, num_shards> involved{};
+  for (auto cache_info : cache_info_entries) {
+    involved[shard_index(cache_info->cache_locator)] = true;
+  }
+  std::vector<std::unique_lock<ceph::shared_mutex>> locks;
+  for (size_t i = 0; i < num_shards; ++i) {
+    if (involved[i]) {
+      locks.emplace_back(shards[i].lock);
+    }
+  }
 
   if (!enabled) {
     return false;
@@ -111,6 +132,7 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
   for (auto cache_info : cache_info_entries) {
     ldpp_dout(dpp, 10) << "chain_cache_entry: cache_locator="
 		   << cache_info->cache_locator << dendl;
+    auto& cache_map = get_shard(cache_info->cache_locator).cache_map;
     auto iter = cache_map.find(cache_info->cache_locator);
     if (iter == cache_map.end()) {
       ldpp_dout(dpp, 20) << "chain_cache_entry: couldn't find cache locator" << dendl;
@@ -141,7 +163,8 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
 
 void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, rgw_cache_entry_info *cache_info)
 {
-  std::unique_lock l{lock};
+  Shard& shard = get_shard(name);
+  std::unique_lock l{shard.lock};
 
   if (!enabled) {
     return;
@@ -150,11 +173,11 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
   ldpp_dout(dpp, 10) << "cache put: name=" << name << " info.flags=0x"
                  << std::hex << info.flags << std::dec << dendl;
 
-  auto [iter, inserted] = cache_map.emplace(name, ObjectCacheEntry{});
+  auto [iter, inserted] = shard.cache_map.emplace(name, ObjectCacheEntry{});
   ObjectCacheEntry& entry = iter->second;
   entry.info.time_added = ceph::coarse_mono_clock::now();
   if (inserted) {
-    entry.lru_iter = lru.end();
+    entry.lru_iter = shard.lru.end();
   }
   ObjectCacheInfo& target = entry.info;
 
@@ -163,7 +186,7 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
   entry.chained_entries.clear();
   entry.gen++;
 
-  touch_lru(dpp, name, entry, entry.lru_iter);
+  touch_lru(dpp, shard, name, entry, entry.lru_iter);
 
   target.status = info.status;
 
@@ -218,14 +241,15 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
 // negative lookup. It must only invalidate.
 bool ObjectCache::invalidate_remove(const DoutPrefixProvider *dpp, const string& name)
 {
-  std::unique_lock l{lock};
+  Shard& shard = get_shard(name);
+  std::unique_lock l{shard.lock};
 
   if (!enabled) {
     return false;
   }
 
-  auto iter = cache_map.find(name);
-  if (iter == cache_map.end())
+  auto iter = shard.cache_map.find(name);
+  if (iter == shard.cache_map.end())
     return false;
 
   ldpp_dout(dpp, 10) << "removing " << name << " from cache" << dendl;
@@ -235,15 +259,22 @@ bool ObjectCache::invalidate_remove(const DoutPrefixProvider *dpp, const string&
     kv.first->invalidate(kv.second);
   }
 
-  remove_lru(name, iter->second.lru_iter);
-  cache_map.erase(iter);
+  remove_lru(shard, name, iter->second.lru_iter);
+  shard.cache_map.erase(iter);
   return true;
 }
 
-void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, ObjectCacheEntry& entry,
+void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, Shard& shard,
+			    const string& name, ObjectCacheEntry& entry,
 			    std::list<string>::iterator& lru_iter)
 {
-  while (lru_size > (size_t)cct->_conf->rgw_cache_lru_size) {
+  auto& lru = shard.lru;
+  auto& cache_map = shard.cache_map;
+  // rgw_cache_lru_size is split evenly across the shards
+  const size_t lru_size = cct->_conf->rgw_cache_lru_size;
+  const size_t lru_max =
+    lru_size / num_shards + (lru_size % num_shards ? 1 : 0);
+  while (shard.lru_size > lru_max) {
     auto iter = lru.begin();
     if ((*iter).compare(name) == 0) {
       /*
@@ -260,12 +291,12 @@ void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, O
       cache_map.erase(map_iter);
     }
     lru.pop_front();
-    lru_size--;
+    shard.lru_size--;
   }
 
   if (lru_iter == lru.end()) {
     lru.push_back(name);
-    lru_size++;
+    shard.lru_size++;
     lru_iter--;
     ldpp_dout(dpp, 10) << "adding " << name << " to cache LRU end" << dendl;
   } else {
@@ -276,19 +307,19 @@ void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, O
     --lru_iter;
   }
 
-  lru_counter++;
-  entry.lru_promotion_ts = lru_counter;
+  shard.lru_counter++;
+  entry.lru_promotion_ts = shard.lru_counter;
 }
 
-void ObjectCache::remove_lru(const string& name,
+void ObjectCache::remove_lru(Shard& shard, const string& name,
 			     std::list<string>::iterator& lru_iter)
 {
-  if (lru_iter == lru.end())
+  if (lru_iter == shard.lru.end())
     return;
 
-  lru.erase(lru_iter);
-  lru_size--;
-  lru_iter = lru.end();
+  shard.lru.erase(lru_iter);
+  shard.lru_size--;
+  lru_iter = shard.lru.end();
 }
 
 void ObjectCache::invalidate_lru(ObjectCacheEntry& entry)
@@ -302,7 +333,7 @@ void ObjectCache::invalidate_lru(ObjectCacheEntry& entry)
 
 void ObjectCache::set_enabled(bool status)
 {
-  std::unique_lock l{lock};
+  auto l = lock_all();
 
   enabled = status;
 
@@ -313,18 +344,20 @@ void ObjectCache::set_enabled(bool status)
 
 void ObjectCache::invalidate_all()
 {
-  std::unique_lock l{lock};
+  auto l = lock_all();
 
   do_invalidate_all();
 }
 
 void ObjectCache::do_invalidate_all()
 {
-  cache_map.clear();
-  lru.clear();
+  for (auto& shard : shards) {
+    shard.cache_map.clear();
+    shard.lru.clear();
 
-  lru_size = 0;
-  lru_counter = 0;
+    shard.lru_size = 0;
+    shard.lru_counter = 0;
+  }
   lru_window = 0;
 
   for (auto& cache : chained_cache) {
@@ -333,12 +366,12 @@ void ObjectCache::do_invalidate_all()
 }
 
 void ObjectCache::chain_cache(RGWChainedCache *cache) {
-  std::unique_lock l{lock};
+  auto l = lock_all();
   chained_cache.push_back(cache);
 }
 
 void ObjectCache::unchain_cache(RGWChainedCache *cache) {
-  std::unique_lock l{lock};
+  auto l = lock_all();
 
   auto iter = chained_cache.begin();
   for (; iter != chained_cache.end(); ++iter) {
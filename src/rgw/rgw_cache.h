@@ -3,9 +3,13 @@
 
 #pragma once
 
+#include <array>
+#include <utility>
+#include <list>
 #include <string>
 #include <map>
 #include <unordered_map>
+#include <vector>
 #include "include/types.h"
 #include "include/utime.h"
 #include "include/ceph_assert.h"
@@ -159,28 +163,58 @@ struct ObjectCacheEntry {
 };
 
 class ObjectCache {
-  std::unordered_map<std::string, ObjectCacheEntry> cache_map;
-  std::list<std::string> lru;
-  unsigned long lru_size;
-  unsigned long lru_counter;
+  // entries are spread over independently locked shards, each with its
+  // own LRU, so that lookups of different keys don't contend
+  static constexpr size_t num_shards = 16;
+
+  struct Shard {
+    std::unordered_map<std::string, ObjectCacheEntry> cache_map;
+    std::list<std::string> lru;
+    unsigned long lru_size = 0;
+    unsigned long lru_counter = 0;
+    // lockdep tracks locks by name, and lock_all() holds all of them at
+    // once, so every shard needs its own
+    ceph::shared_mutex lock;
+    explicit Shard(size_t i)
+      : lock(ceph::make_shared_mutex("ObjectCache::Shard::" + std::to_string(i)))
+    {}
+  };
+  std::array<Shard, num_shards> shards;
+  template<size_t... I>
+  static std::array<Shard, num_shards> make_shards(std::index_sequence<I...>) {
+    return {Shard(I)...};
+  }
+
+  // per shard, like lru_counter
   unsigned long lru_window;
-  ceph::shared_mutex lock = ceph::make_shared_mutex("ObjectCache");
   CephContext *cct;
 
+  // protected by all the shard locks; lock_all() takes them in order
   std::vector<RGWChainedCache *> chained_cache;
 
   bool enabled;
   ceph::timespan expiry;
 
-  void touch_lru(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheEntry& entry,
-		 std::list<std::string>::iterator& lru_iter);
-  void remove_lru(const std::string& name, std::list<std::string>::iterator& lru_iter);
+  size_t shard_index(const std::string& name) const {
+    return std::hash<std::string>{}(name) % num_shards;
+  }
+  Shard& get_shard(const std::string& name) {
+    return shards[shard_index(name)];
+  }
+  std::vector<std::unique_lock<ceph::shared_mutex>> lock_all();
+
+  void touch_lru(const DoutPrefixProvider *dpp, Shard& shard, const std::string& name,
+		 ObjectCacheEntry& entry, std::list<std::string>::iterator& lru_iter);
+  void remove_lru(Shard& shard, const std::string& name,
+		  std::list<std::string>::iterator& lru_iter);
   void invalidate_lru(ObjectCacheEntry& entry);
 
   void do_invalidate_all();
 
 public:
-  ObjectCache() : lru_size(0), lru_counter(0), lru_window(0), cct(NULL), enabled(false) { }
+  ObjectCache()
+    : shards(make_shards(std::make_index_sequence<num_shards>{})),
+      lru_window(0), cct(NULL), enabled(false) { }
   ~ObjectCache();
   int get(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheInfo& bl, uint32_t mask, rgw_cache_entry_info *cache_info);
   std::optional<ObjectCacheInfo> get(const DoutPrefixProvider *dpp, const std::string& name) {
@@ -191,10 +225,13 @@ public:
 
   template<typename F>
   void for_each(const F& f) {
-    std::shared_lock l{lock};
-    if (enabled) {
+    for (auto& shard : shards) {
+      std::shared_lock l{shard.lock};
+      if (!enabled) {
+        return;
+      }
       auto now  = ceph::coarse_mono_clock::now();
-      for (const auto& [name, entry] : cache_map) {
+      for (const auto& [name, entry] : shard.cache_map) {
         if (expiry.count() && (now - entry.info.time_added) < expiry) {
           f(name, entry);
         }
@@ -206,7 +243,7 @@ public:
   bool invalidate_remove(const DoutPrefixProvider *dpp, const std::string& name);
   void set_ctx(CephContext *_cct) {
     cct = _cct;
-    lru_window = cct->_conf->rgw_cache_lru_size / 2;
+    lru_window = cct->_conf->rgw_cache_lru_size / num_shards / 2;
     expiry = std::chrono::seconds(cct->_conf.get_val<uint64_t>(
 						"rgw_cache_expiry_interval"));
   }
@@ -369,6 +369,7 @@ class LCObjsLister {
   vector<rgw_bucket_dir_entry>::iterator obj_iter;
   rgw_bucket_dir_entry pre_obj;
   int64_t delay_ms;
+  uint64_t list_cnt;
 
 public:
   LCObjsLister(rgw::sal::Driver* _driver, rgw::sal::Bucket* _bucket) :
@@ -376,6 +377,7 @@ public:
     list_params.list_versions = bucket->versioned();
     list_params.allow_unordered = true;
     delay_ms = driver->ctx()->_conf.get_val<int64_t>("rgw_lc_thread_delay");
+    list_cnt = driver->ctx()->_conf.get_val<uint64_t>("rgw_lc_list_cnt");
   }
 
   void set_prefix(const string& p) {
@@ -388,7 +390,7 @@ public:
   }
 
   int fetch(const DoutPrefixProvider *dpp) {
-    int ret = bucket->list(dpp, list_params, 1000, list_results, null_yield);
+    int ret = bucket->list(dpp, list_params, list_cnt, list_results, null_yield);
     if (ret < 0) {
       return ret;
     }
@@ -822,6 +824,7 @@ int RGWLC::handle_multipart_expiration(rgw::sal::Bucket* target,
   rgw::sal::Bucket::ListParams params;
   rgw::sal::Bucket::ListResults results;
   auto delay_ms = cct->_conf.get_val<int64_t>("rgw_lc_thread_delay");
+  auto list_cnt = cct->_conf.get_val<uint64_t>("rgw_lc_list_cnt");
   params.list_versions = false;
   /* lifecycle processing does not depend on total order, so can
    * take advantage of unordered listing optimizations--such as
@@ -877,7 +880,7 @@ int RGWLC::handle_multipart_expiration(rgw::sal::Bucket* target,
     params.prefix = prefix_iter->first;
     do {
       results.objs.clear();
-      ret = target->list(this, params, 1000, results, null_yield);
+      ret = target->list(this, params, list_cnt, results, null_yield);
       if (ret < 0) {
           if (ret == (-ENOENT))
             return 0;
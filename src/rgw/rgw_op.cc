@@ -3903,6 +3903,15 @@ int RGWPutObj::get_lua_filter(std::unique_ptr<rgw::sal::DataProcessor>* filter,
   return 0;
 }
 
+// hash each buffer of the list in place rather than flattening it with
+// c_str(), which copies multi-segment (e.g. copy-source) chunks
+static void hash_data(MD5& hash, const bufferlist& bl)
+{
+  for (const auto& bp : bl.buffers()) {
+    hash.Update((const unsigned char *)bp.c_str(), bp.length());
+  }
+}
+
 void RGWPutObj::execute(optional_yield y)
 {
   char supplied_md5_bin[CEPH_CRYPTO_MD5_DIGESTSIZE + 1];
@@ -4154,7 +4163,7 @@ void RGWPutObj::execute(optional_yield y)
     }
 
     if (need_calc_md5) {
-      hash.Update((const unsigned char *)data.c_str(), data.length());
+      hash_data(hash, data);
     }
 
     /* update torrrent */
@@ -4484,7 +4493,7 @@ void RGWPostObj::execute(optional_yield y)
         break;
       }
 
-      hash.Update((const unsigned char *)data.c_str(), data.length());
+      hash_data(hash, data);
       op_ret = filter->process(std::move(data), ofs);
       if (op_ret < 0) {
         return;
@@ -7597,7 +7606,7 @@ int RGWBulkUploadOp::handle_file(const std::string_view path,
       op_ret = len;
       return op_ret;
     } else if (len > 0) {
-      hash.Update((const unsigned char *)data.c_str(), data.length());
+      hash_data(hash, data);
       op_ret = filter->process(std::move(data), ofs);
       if (op_ret < 0) {
         ldpp_dout(this, 20) << "filter->process() returned ret=" << op_ret << dendl;
@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <chrono>
 #include <thread>
 #include <condition_variable>
@@ -145,11 +146,18 @@ class RateLimiterEntry {
 class RateLimiter {
 
   static constexpr size_t map_size = 2000000; // will create it with the closest upper prime number
-  std::shared_mutex insert_lock;
+  // entries are spread over shards so that lookups of different keys
+  // don't serialize on one insert lock
+  static constexpr size_t num_shards = 64;
   std::atomic_bool& replacing;
   std::condition_variable& cv;
   typedef std::unordered_map<std::string, RateLimiterEntry> hash_map;
-  hash_map ratelimit_entries{map_size};
+  struct Shard {
+    std::shared_mutex insert_lock;
+    hash_map ratelimit_entries{map_size / num_shards};
+  };
+  std::array<Shard, num_shards> shards;
+  std::atomic<size_t> num_entries = 0;
   static bool is_read_op(const std::string_view method) {
     if (method == "GET" || method == "HEAD")
     {
@@ -160,20 +168,25 @@ class RateLimiter {
 
     // find or create an entry, and return its iterator
   auto& find_or_create(const std::string& key) {
-    std::shared_lock rlock(insert_lock);
-    if (ratelimit_entries.size() > 0.9 * map_size && replacing == false)
+    if (num_entries > 0.9 * map_size && replacing == false)
     {
       replacing = true;
       cv.notify_all();
     }
-    auto ret = ratelimit_entries.find(key);
+    auto& shard = shards[std::hash<std::string>{}(key) % num_shards];
+    std::shared_lock rlock(shard.insert_lock);
+    auto ret = shard.ratelimit_entries.find(key);
     rlock.unlock();
-    if (ret == ratelimit_entries.end())
+    if (ret == shard.ratelimit_entries.end())
     {
-      std::unique_lock wlock(insert_lock);
-      ret = ratelimit_entries.emplace(std::piecewise_construct,
+      std::unique_lock wlock(shard.insert_lock);
+      bool inserted;
+      std::tie(ret, inserted) = shard.ratelimit_entries.emplace(std::piecewise_construct,
                                  std::forward_as_tuple(key),
-                                 std::forward_as_tuple()).first;
+                                 std::forward_as_tuple());
+      if (inserted) {
+        ++num_entries;
+      }
     }
     return ret->second;
   }
@@ -190,7 +203,9 @@ class RateLimiter {
       : replacing(replacing), cv(cv)
     {
       // prevents rehash, so no iterators invalidation
-      ratelimit_entries.max_load_factor(1000);
+      for (auto& shard : shards) {
+        shard.ratelimit_entries.max_load_factor(1000);
+      }
     };
 
     bool should_rate_limit(const char *method, const std::string& key, ceph::coarse_real_time curr_timestamp, const RGWRateLimitInfo* ratelimit_info) {
@@ -223,7 +238,10 @@ class RateLimiter {
       it.decrease_bytes(is_read, amount, info);
     }
     void clear() {
-      ratelimit_entries.clear();
+      for (auto& shard : shards) {
+        shard.ratelimit_entries.clear();
+      }
+      num_entries = 0;
     }
 };
 // This class purpose is to hold 2 RateLimiter instances, one active and one passive.
@@ -750,9 +750,7 @@ void dump_range(req_state* const s,
 }
 
 
-int dump_body(req_state* const s,
-              const char* const buf,
-              const size_t len)
+static void ratelimit_body(req_state* const s, const size_t len)
 {
   bool healthchk = false;
   // we dont want to limit health checks
@@ -764,6 +762,13 @@ int dump_body(req_state* const s,
     if(!rgw::sal::Bucket::empty(s->bucket.get()))
       s->ratelimit_data->decrease_bytes(method, s->ratelimit_bucket_marker, len, &s->bucket_ratelimit);
   }
+}
+
+int dump_body(req_state* const s,
+              const char* const buf,
+              const size_t len)
+{
+  ratelimit_body(s, len);
   try {
     return RESTFUL_IO(s)->send_body(buf, len);
   } catch (rgw::io::Exception& e) {
@@ -773,7 +778,27 @@ int dump_body(req_state* const s,
 
 int dump_body(req_state* const s, /* const */ ceph::buffer::list& bl)
 {
-  return dump_body(s, bl.c_str(), bl.length());
+  return dump_body(s, bl, 0, bl.length());
+}
+
+int dump_body(req_state* const s, const ceph::buffer::list& bl,
+              size_t ofs, size_t len)
+{
+  /* hand the buffers of the list over as they are, so the front-end can
+   * write them in one go, instead of flattening it with c_str(), which
+   * would copy the data of multi-segment lists */
+  ceph::buffer::list range;
+  if (ofs == 0 && len == bl.length()) {
+    range = bl;
+  } else {
+    range.substr_of(bl, ofs, len);
+  }
+  ratelimit_body(s, len);
+  try {
+    return RESTFUL_IO(s)->send_body_buffers(range);
+  } catch (rgw::io::Exception& e) {
+    return -e.code().value();
+  }
 }
 
 int dump_body(req_state* const s, const std::string& str)
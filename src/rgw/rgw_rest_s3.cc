@@ -561,7 +561,7 @@ done:
 
 send_data:
   if (get_data && !op_ret) {
-    int r = dump_body(s, bl.c_str() + bl_ofs, bl_len);
+    int r = dump_body(s, bl, bl_ofs, bl_len);
     if (r < 0)
       return r;
   }
@@ -5637,7 +5637,9 @@ AWSGeneralAbstractor::get_auth_data_v4(const req_state* const s,
                                      std::placeholders::_1,
                                      std::placeholders::_2,
                                      std::placeholders::_3,
-                                     s);
+                                     s,
+                                     &signing_keys,
+                                     access_key_id);
 
   /* Requests authenticated with the Query Parameters are treated as unsigned.
    * From "Authenticating Requests: Using Query Parameters (AWS Signature
@@ -5759,6 +5761,8 @@ AWSGeneralAbstractor::get_auth_data_v4(const req_state* const s,
                                           date,
                                           credential_scope,
                                           client_signature,
+                                          &signing_keys,
+                                          access_key_id,
                                           std::placeholders::_1);
       return {
         access_key_id,
@@ -5898,7 +5902,9 @@ AWSBrowserUploadAbstractor::get_auth_data_v4(const req_state* const s) const
                                      std::placeholders::_1,
                                      std::placeholders::_2,
                                      std::placeholders::_3,
-                                     s);
+                                     s,
+                                     &signing_keys,
+                                     access_key_id);
 
   return {
     access_key_id,
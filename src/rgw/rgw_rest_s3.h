@@ -11,6 +11,7 @@
 #include <boost/container/static_vector.hpp>
 #include <boost/crc.hpp>
 
+#include "common/lru_map.h"
 #include "common/sstring.hh"
 #include "rgw_op.h"
 #include "rgw_rest.h"
@@ -993,8 +994,65 @@ public:
 };
 
 
+/* AWSv4 signing keys derived for recently seen credentials. A signing key
+ * depends only on the secret and the credential scope, so requests signed
+ * with the same credential on the same day can share it. Entries are keyed
+ * on the access key id and the scope; a hash of the secret is kept next to
+ * the key so that a rotated secret misses instead of matching a stale key. */
+class SigningKeyCache {
+  struct entry_t {
+    sha256_digest_t secret_hash;
+    sha256_digest_t signing_key;
+  };
+
+  const size_t max_size;
+  lru_map<std::string, entry_t> keys;
+
+  static std::string make_key(const std::string_view& access_key_id,
+                              const std::string_view& credential_scope) {
+    std::string key;
+    key.reserve(access_key_id.size() + 1 + credential_scope.size());
+    key.append(access_key_id);
+    key.push_back('\0');
+    key.append(credential_scope);
+    return key;
+  }
+
+public:
+  explicit SigningKeyCache(CephContext* const cct)
+    : max_size(cct->_conf.get_val<uint64_t>("rgw_s3_signing_key_cache_size")),
+      keys(max_size) {
+  }
+
+  bool enabled() const {
+    return max_size > 0;
+  }
+
+  bool find(const std::string_view& access_key_id,
+            const std::string_view& credential_scope,
+            const sha256_digest_t& secret_hash,
+            sha256_digest_t& signing_key) {
+    entry_t e;
+    if (!keys.find(make_key(access_key_id, credential_scope), e) ||
+        e.secret_hash != secret_hash) {
+      return false;
+    }
+    signing_key = e.signing_key;
+    return true;
+  }
+
+  void add(const std::string_view& access_key_id,
+           const std::string_view& credential_scope,
+           const sha256_digest_t& secret_hash,
+           const sha256_digest_t& signing_key) {
+    entry_t e{secret_hash, signing_key};
+    keys.add(make_key(access_key_id, credential_scope), e);
+  }
+};
+
 class AWSGeneralAbstractor : public AWSEngine::VersionAbstractor {
   CephContext* const cct;
+  mutable SigningKeyCache signing_keys;
 
   virtual boost::optional<std::string>
   get_v4_canonical_headers(const req_info& info,
@@ -1006,7 +1064,8 @@ class AWSGeneralAbstractor : public AWSEngine::VersionAbstractor {
 
 public:
   explicit AWSGeneralAbstractor(CephContext* const cct)
-    : cct(cct) {
+    : cct(cct),
+      signing_keys(cct) {
   }
 
   auth_data_t get_auth_data(const req_state* s) const override;
@@ -1028,11 +1087,14 @@ class AWSBrowserUploadAbstractor : public AWSEngine::VersionAbstractor {
                        static_cast<std::string::size_type>(bl.length()));
   }
 
+  mutable SigningKeyCache signing_keys;
+
   auth_data_t get_auth_data_v2(const req_state* s) const;
   auth_data_t get_auth_data_v4(const req_state* s) const;
 
 public:
-  explicit AWSBrowserUploadAbstractor(CephContext*) {
+  explicit AWSBrowserUploadAbstractor(CephContext* const cct)
+    : signing_keys(cct) {
   }
 
   auth_data_t get_auth_data(const req_state* s) const override;
@@ -544,6 +544,7 @@ int RGWSelectObj_ObjStore_S3::range_request(int64_t ofs, int64_t len, void* buff
   range_parsed = false;
   RGWGetObj::parse_range();
   requested_buffer.clear();
+  requested_buffer.reserve(len);
   m_request_range = len;
   ldout(s->cct, 10) << "S3select: calling execute(async):" << " request-offset :" << ofs << " request-length :" << len << " buffer size : " << requested_buffer.size() << dendl;
   RGWGetObj::execute(y);
@@ -598,18 +599,12 @@ int RGWSelectObj_ObjStore_S3::parquet_processing(bufferlist& bl, off_t ofs, off_
       end_header(s, this, "application/xml", CHUNKED_TRANSFER_ENCODING);
     }
     chunk_number++;
-    size_t append_in_callback = 0;
-    int part_no = 1;
-    //concat the requested buffer
-    for (auto& it : bl.buffers()) {
-      if(it.length() == 0) {
-        ldout(s->cct, 10) << "S3select: get zero-buffer while appending request-buffer " << dendl;
-      }
-      append_in_callback += it.length();
-      ldout(s->cct, 10) << "S3select: part " << part_no++ << " it.length() = " << it.length() << dendl;
-      requested_buffer.append(&(it)[0]+ofs, len);
-    }
-    ldout(s->cct, 10) << "S3select:append_in_callback = " << append_in_callback << dendl;
+    //concat the requested range of the callback buffer; it may span
+    //several segments, so copy through an iterator rather than per segment
+    auto bl_iter = bl.cbegin();
+    bl_iter += ofs;
+    bl_iter.copy(len, requested_buffer);
+    ldout(s->cct, 10) << "S3select:append_in_callback = " << len << " out of " << bl.get_num_buffers() << " segments" << dendl;
     if (requested_buffer.size() < m_request_range) {
       ldout(s->cct, 10) << "S3select: need another round buffe-size: " << requested_buffer.size() << " request range length:" << m_request_range << dendl;
       return 0;
@@ -20,6 +20,7 @@
  */
 
 #include <limits.h>
+#include <thread>
 #include <errno.h>
 #include <sys/uio.h>
 
@@ -1941,6 +1942,38 @@ TEST(BufferList, push_back) {
   }
 }
 
+TEST(BufferList, ptr_node_reuse_across_threads) {
+  // nodes allocated by one thread and freed by another end up in the
+  // freeing thread's cache; make sure lists built from them stay sound
+  std::vector<bufferlist> lists(64);
+  for (unsigned i = 0; i < lists.size(); ++i) {
+    for (unsigned j = 0; j < 8; ++j) {
+      bufferptr ptr(16);
+      memset(ptr.c_str(), 'a' + j, ptr.length());
+      lists[i].push_back(std::move(ptr));
+    }
+  }
+  std::thread t([&lists] {
+    lists.clear();
+    for (unsigned round = 0; round < 4; ++round) {
+      bufferlist bl;
+      for (unsigned j = 0; j < 300; ++j) {
+	bl.push_back(bufferptr(1));
+      }
+      EXPECT_EQ(300u, bl.get_num_buffers());
+    }
+  });
+  t.join();
+  bufferlist bl;
+  for (unsigned j = 0; j < 8; ++j) {
+    bufferptr ptr(16);
+    memset(ptr.c_str(), 'a' + j, ptr.length());
+    bl.push_back(std::move(ptr));
+  }
+  EXPECT_EQ(8u, bl.get_num_buffers());
+  EXPECT_EQ('h', bl.buffers().back()[0]);
+}
+
 TEST(BufferList, is_contiguous) {
   bufferlist bl;
   EXPECT_TRUE(bl.is_contiguous());
@@ -412,3 +412,84 @@ TEST(ClsNumOps, Div) {
 
   ASSERT_EQ(0, destroy_one_pool_pp(pool_name, cluster));
 }
+
+TEST(ClsNumOps, Sum) {
+  Rados cluster;
+  std::string pool_name = get_temp_pool_name();
+  ASSERT_EQ("", create_one_pool_pp(pool_name, cluster));
+  IoCtx ioctx;
+  cluster.ioctx_create(pool_name.c_str(), ioctx);
+
+  double total = -1;
+  uint64_t count = 1;
+
+  // summing a non-existing object fails
+
+  ASSERT_EQ(-ENOENT, rados::cls::numops::sum(&ioctx, "myobject", "",
+                                             &total, &count));
+
+  std::map<std::string, bufferlist> omap;
+  omap["a.1"].append("1.5");
+  omap["a.2"].append("2");
+  omap["a.3"].append("-0.5");
+  omap["b.1"].append("100");
+  ASSERT_EQ(0, ioctx.omap_set("myobject", omap));
+
+  // only keys with the given prefix are summed
+
+  ASSERT_EQ(0, rados::cls::numops::sum(&ioctx, "myobject", "a.",
+                                       &total, &count));
+  EXPECT_EQ(3.0, total);
+  EXPECT_EQ(3u, count);
+
+  ASSERT_EQ(0, rados::cls::numops::sum(&ioctx, "myobject", "",
+                                       &total, &count));
+  EXPECT_EQ(103.0, total);
+  EXPECT_EQ(4u, count);
+
+  ASSERT_EQ(0, rados::cls::numops::sum(&ioctx, "myobject", "c.",
+                                       &total, &count));
+  EXPECT_EQ(0.0, total);
+  EXPECT_EQ(0u, count);
+
+  // a non-numeric value makes the sum fail
+
+  omap.clear();
+  omap["a.4"].append("some-non-numeric-text");
+  ASSERT_EQ(0, ioctx.omap_set("myobject", omap));
+
+  ASSERT_EQ(-EBADMSG, rados::cls::numops::sum(&ioctx, "myobject", "a.",
+                                              &total, &count));
+
+  // the total keeps full double precision
+
+  omap.clear();
+  omap["p.1"].append("0.1");
+  omap["p.2"].append("0.2");
+  ASSERT_EQ(0, ioctx.omap_set("myobject", omap));
+
+  ASSERT_EQ(0, rados::cls::numops::sum(&ioctx, "myobject", "p.",
+                                       &total, &count));
+  EXPECT_EQ(0.1 + 0.2, total);
+  EXPECT_EQ(2u, count);
+
+  // a sum spanning several ops gives the same result
+
+  omap.clear();
+  for (int i = 0; i < 25; i++) {
+    omap["n." + std::to_string(1000 + i)].append(std::to_string(i));
+  }
+  ASSERT_EQ(0, ioctx.omap_set("myobject", omap));
+
+  ASSERT_EQ(0, rados::cls::numops::sum(&ioctx, "myobject", "n.",
+                                       &total, &count, 10));
+  EXPECT_EQ(300.0, total);
+  EXPECT_EQ(25u, count);
+
+  ASSERT_EQ(0, rados::cls::numops::sum(&ioctx, "myobject", "n.",
+                                       &total, &count, 5));
+  EXPECT_EQ(300.0, total);
+  EXPECT_EQ(25u, count);
+
+  ASSERT_EQ(0, destroy_one_pool_pp(pool_name, cluster));
+}
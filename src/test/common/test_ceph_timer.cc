@@ -23,11 +23,11 @@
 using namespace std::literals;
 
 namespace {
-template<typename TC>
+template<typename TC, template<typename> class Timer = ceph::timer>
 void run_some()
 {
   static constexpr auto MAX_FUTURES = 5;
-  ceph::timer<TC> timer;
+  Timer<TC> timer;
   std::vector<std::future<void>> futures;
   for (auto i = 0; i < MAX_FUTURES; ++i) {
     auto t = TC::now() + 2s;
@@ -41,10 +41,10 @@ void run_some()
     f.get();
 }
 
-template<typename TC>
+template<typename TC, template<typename> class Timer = ceph::timer>
 void run_orderly()
 {
-  ceph::timer<TC> timer;
+  Timer<TC> timer;
 
   std::future<typename TC::time_point> first;
   std::future<typename TC::time_point> second;
@@ -97,10 +97,10 @@ struct Destructo {
   }
 };
 
-template<typename TC>
+template<typename TC, template<typename> class Timer = ceph::timer>
 void cancel_all()
 {
-  ceph::timer<TC> timer;
+  Timer<TC> timer;
   static constexpr auto MAX_FUTURES = 5;
   std::vector<std::future<void>> futures;
   for (auto i = 0; i < MAX_FUTURES; ++i) {
@@ -113,10 +113,10 @@ void cancel_all()
     f.get();
 }
 
-template<typename TC>
+template<typename TC, template<typename> class Timer = ceph::timer>
 void cancellation()
 {
-  ceph::timer<TC> timer;
+  Timer<TC> timer;
   {
     std::promise<void> p;
     auto f = p.get_future();
@@ -133,6 +133,53 @@ void cancellation()
     EXPECT_FALSE(timer.cancel_event(e));
   }
 }
+
+template<typename TC>
+void wheel_adjust()
+{
+  ceph::wheel_timer<TC> timer;
+  std::promise<typename TC::time_point> p;
+  auto f = p.get_future();
+  auto e = timer.add_event(100s, [p = std::move(p)]() mutable {
+				   p.set_value(TC::now());
+				 });
+  const auto start = TC::now();
+  EXPECT_TRUE(timer.adjust_event(e, 1s));
+  EXPECT_GE(f.get(), start + 1s);
+  EXPECT_FALSE(timer.cancel_event(e));
+}
+
+template<typename TC>
+void wheel_many()
+{
+  // Most events are cancelled before they are due; the rest, a few laps
+  // of the wheel apart, must each run once and never early.
+  ceph::wheel_timer<TC, 8> timer(std::chrono::duration_cast<
+				 typename TC::duration>(1ms));
+  static constexpr auto MAX_EVENTS = 1000;
+  std::vector<std::uint64_t> ids;
+  std::vector<std::future<typename TC::time_point>> futures;
+  std::vector<typename TC::time_point> deadlines;
+  for (auto i = 0; i < MAX_EVENTS; ++i) {
+    const auto when = TC::now() + 100ms + (i % 10) * 5ms;
+    if (i % 10 == 0) {
+      std::promise<typename TC::time_point> p;
+      futures.push_back(p.get_future());
+      deadlines.push_back(when);
+      timer.add_event(when, [p = std::move(p)]() mutable {
+			      p.set_value(TC::now());
+			    });
+    } else {
+      ids.push_back(timer.add_event(when, Destructo(std::promise<void>())));
+    }
+  }
+  for (auto id : ids) {
+    EXPECT_TRUE(timer.cancel_event(id));
+  }
+  for (std::size_t i = 0; i < futures.size(); ++i) {
+    EXPECT_GE(futures[i].get(), deadlines[i]);
+  }
+}
 }
 
 TEST(RunSome, Steady)
@@ -161,3 +208,37 @@ TEST(CancelAll, Wall)
 {
   cancel_all<std::chrono::system_clock>();
 }
+
+TEST(RunSome, WheelSteady)
+{
+  run_some<std::chrono::steady_clock, ceph::wheel_timer>();
+}
+TEST(RunSome, WheelWall)
+{
+  run_some<std::chrono::system_clock, ceph::wheel_timer>();
+}
+
+TEST(RunOrderly, WheelSteady)
+{
+  run_orderly<std::chrono::steady_clock, ceph::wheel_timer>();
+}
+
+TEST(CancelAll, WheelSteady)
+{
+  cancel_all<std::chrono::steady_clock, ceph::wheel_timer>();
+}
+
+TEST(Cancellation, WheelSteady)
+{
+  cancellation<std::chrono::steady_clock, ceph::wheel_timer>();
+}
+
+TEST(Wheel, Adjust)
+{
+  wheel_adjust<std::chrono::steady_clock>();
+}
+
+TEST(Wheel, Many)
+{
+  wheel_many<std::chrono::steady_clock>();
+}
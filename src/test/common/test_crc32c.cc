@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <string.h>
+#include <vector>
 
 #include "include/types.h"
 #include "include/crc32c.h"
@@ -44,6 +45,38 @@ TEST(Crc32c, Big) {
   free(a);
 }
 
+TEST(Crc32c, Combine) {
+  const char *a = "foo bar baz";
+  const char *b = "whiz bang boom";
+  std::string ab = std::string(a) + b;
+  uint32_t crc_a = ceph_crc32c(1234, (unsigned char *)a, strlen(a));
+  uint32_t crc_b = ceph_crc32c(0, (unsigned char *)b, strlen(b));
+  ASSERT_EQ(ceph_crc32c(1234, (unsigned char *)ab.data(), ab.size()),
+	    ceph_crc32c_combine(crc_a, crc_b, strlen(b)));
+}
+
+TEST(Crc32c, Multi) {
+  // lengths straddle the 8 byte stride and the 1K single-buffer cutoff,
+  // with a zero-filled (NULL) buffer mixed in
+  const unsigned lengths[] = {0, 1, 7, 8, 13, 100, 511, 1023, 1024, 3000, 64};
+  const unsigned count = sizeof(lengths) / sizeof(lengths[0]);
+  std::vector<std::vector<unsigned char>> bufs(count);
+  const unsigned char *data[count];
+  uint32_t crcs[count];
+  for (unsigned i = 0; i < count; i++) {
+    bufs[i].resize(lengths[i]);
+    for (unsigned j = 0; j < lengths[i]; j++) {
+      bufs[i][j] = (unsigned char)(i * 31 + j * 7);
+    }
+    data[i] = i == 5 ? nullptr : bufs[i].data();
+    crcs[i] = i * 1000;
+  }
+  ceph_crc32c_multi(count, crcs, data, lengths);
+  for (unsigned i = 0; i < count; i++) {
+    ASSERT_EQ(ceph_crc32c(i * 1000, data[i], lengths[i]), crcs[i]) << i;
+  }
+}
+
 TEST(Crc32c, Performance) {
   int len = 1000 * 1024 * 1024;
   char *a = (char *)malloc(len);
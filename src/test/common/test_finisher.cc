@@ -0,0 +1,110 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+#include "common/Finisher.h"
+#include "common/ceph_context.h"
+#include "global/global_context.h"
+#include "include/Context.h"
+
+namespace {
+
+class SharedFinisherTest : public ::testing::Test {
+protected:
+  static constexpr unsigned THREADS = 2;
+
+  void SetUp() override {
+    g_ceph_context->_conf.set_val_or_die("finisher_shared_threads",
+					 std::to_string(THREADS));
+  }
+  void TearDown() override {
+    g_ceph_context->_conf.set_val_or_die("finisher_shared_threads", "0");
+  }
+
+  FinisherPool& get_pool() {
+    return g_ceph_context->lookup_or_create_singleton_object<FinisherPool>(
+      "finisher_pool", false, g_ceph_context, THREADS);
+  }
+};
+
+} // anonymous namespace
+
+TEST_F(SharedFinisherTest, in_order)
+{
+  constexpr int FINISHERS = 4;
+  constexpr int CONTEXTS = 1000;
+  std::vector<std::unique_ptr<Finisher>> finishers;
+  std::vector<std::vector<int>> done(FINISHERS);
+  for (int f = 0; f < FINISHERS; f++) {
+    finishers.emplace_back(std::make_unique<Finisher>(g_ceph_context));
+    finishers.back()->start();
+  }
+  for (int i = 0; i < CONTEXTS; i++) {
+    for (int f = 0; f < FINISHERS; f++) {
+      finishers[f]->queue(new LambdaContext([&done, f, i](int) {
+	done[f].push_back(i);
+      }));
+    }
+  }
+  for (auto& f : finishers) {
+    f->wait_for_empty();
+    f->stop();
+  }
+  for (int f = 0; f < FINISHERS; f++) {
+    ASSERT_EQ(CONTEXTS, (int)done[f].size());
+    for (int i = 0; i < CONTEXTS; i++) {
+      ASSERT_EQ(i, done[f][i]);
+    }
+  }
+  ASSERT_EQ(THREADS, get_pool().get_num_running());
+}
+
+TEST_F(SharedFinisherTest, stop_drains_queue)
+{
+  std::atomic<int> done = 0;
+  Finisher finisher(g_ceph_context);
+  finisher.start();
+  for (int i = 0; i < 100; i++) {
+    finisher.queue(new LambdaContext([&done](int) { ++done; }));
+  }
+  finisher.stop();
+  ASSERT_EQ(100, done);
+}
+
+TEST_F(SharedFinisherTest, fork)
+{
+  std::atomic<int> done = 0;
+  Finisher finisher(g_ceph_context);
+  finisher.start();
+  finisher.queue(new LambdaContext([&done](int) { ++done; }));
+  finisher.wait_for_empty();
+
+  g_ceph_context->notify_pre_fork();
+  ASSERT_EQ(0u, get_pool().get_num_running());
+  pid_t pid = fork();
+  ASSERT_LE(0, pid);
+  g_ceph_context->notify_post_fork();
+  if (pid == 0) {
+    // the child gets its own threads and can keep using the finisher
+    finisher.queue(new LambdaContext([&done](int) { ++done; }));
+    finisher.wait_for_empty();
+    _exit(done == 2 && get_pool().get_num_running() == THREADS ? 0 : 1);
+  }
+  int status;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(0, WEXITSTATUS(status));
+
+  ASSERT_EQ(THREADS, get_pool().get_num_running());
+  finisher.queue(new LambdaContext([&done](int) { ++done; }));
+  finisher.wait_for_empty();
+  finisher.stop();
+  ASSERT_EQ(2, done);
+}
@@ -0,0 +1,64 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "gtest/gtest.h"
+
+#include "common/frequency_sketch.h"
+
+using ceph::common::frequency_sketch;
+
+TEST(FrequencySketch, width)
+{
+  ASSERT_EQ(1u, frequency_sketch(0).get_width());
+  ASSERT_EQ(1024u, frequency_sketch(1000).get_width());
+  ASSERT_EQ(1024u, frequency_sketch(1024).get_width());
+}
+
+TEST(FrequencySketch, estimate)
+{
+  frequency_sketch sketch(1024, 1000000);
+  for (uint64_t k = 0; k < 100; ++k) {
+    for (uint64_t n = 0; n < k % 10; ++n) {
+      sketch.add(k);
+    }
+  }
+  for (uint64_t k = 0; k < 100; ++k) {
+    // count-min never under-estimates
+    ASSERT_GE(sketch.estimate(k), k % 10);
+  }
+  // with few keys in a wide sketch, collisions in all rows are rare
+  unsigned exact = 0;
+  for (uint64_t k = 0; k < 100; ++k) {
+    exact += (sketch.estimate(k) == k % 10);
+  }
+  ASSERT_GE(exact, 95u);
+  ASSERT_EQ(0u, sketch.estimate(123456789));
+}
+
+TEST(FrequencySketch, saturate)
+{
+  frequency_sketch sketch(16, 1000000);
+  for (int i = 0; i < 1000; ++i) {
+    sketch.add(42);
+  }
+  ASSERT_EQ(255u, sketch.estimate(42));
+}
+
+TEST(FrequencySketch, aging)
+{
+  frequency_sketch sketch(64, 100);
+  for (int i = 0; i < 40; ++i) {
+    sketch.add(1);
+  }
+  ASSERT_GE(sketch.estimate(1), 40u);
+
+  // the 100th addition halves all counters
+  for (int i = 0; i < 60; ++i) {
+    sketch.add(1000 + i);
+  }
+  ASSERT_LE(sketch.estimate(1), 20u + 10u);
+  ASSERT_GE(sketch.estimate(1), 20u);
+
+  sketch.clear();
+  ASSERT_EQ(0u, sketch.estimate(1));
+}
@@ -0,0 +1,192 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "common/PriorityCache.h"
+#include "global/global_context.h"
+
+using namespace PriorityCache;
+
+namespace {
+
+constexpr uint64_t MEM = 1ull << 30;
+
+// Wants nothing at the regular priorities, so balance() hands everything
+// out at Priority::LAST by the (possibly adapted) ratios.
+struct FakeCache : public PriCache {
+  std::string name;
+  double ratio;
+  bool has_stats;
+  int64_t bytes[Priority::LAST+1] = {0};
+  int64_t committed = 0;
+  uint64_t misses = 0;
+  uint64_t bytes_per_miss = 1;
+  uint64_t resident = 1 << 20;
+
+  FakeCache(std::string n, double r, bool s = true)
+    : name(n), ratio(r), has_stats(s) {}
+
+  int64_t request_cache_bytes(Priority pri, uint64_t total) const override {
+    return 0;
+  }
+  int64_t get_cache_bytes(Priority pri) const override {
+    return bytes[pri];
+  }
+  int64_t get_cache_bytes() const override {
+    int64_t total = 0;
+    for (int i = 0; i < Priority::LAST+1; i++) {
+      total += bytes[i];
+    }
+    return total;
+  }
+  void set_cache_bytes(Priority pri, int64_t b) override {
+    bytes[pri] = b;
+  }
+  void add_cache_bytes(Priority pri, int64_t b) override {
+    bytes[pri] += b;
+  }
+  int64_t commit_cache_size(uint64_t total) override {
+    committed = get_cache_bytes();
+    return committed;
+  }
+  int64_t get_committed_size() const override {
+    return committed;
+  }
+  double get_cache_ratio() const override {
+    return ratio;
+  }
+  void set_cache_ratio(double r) override {
+    ratio = r;
+  }
+  std::string get_cache_name() const override {
+    return name;
+  }
+  void shift_bins() override {}
+  void import_bins(const std::vector<uint64_t> &bins) override {}
+  void set_bins(Priority pri, uint64_t end_bin) override {}
+  uint64_t get_bins(Priority pri) const override {
+    return 0;
+  }
+  bool get_miss_stats(uint64_t *m, uint64_t *bpm,
+                      uint64_t *r) const override {
+    *m = misses;
+    *bpm = bytes_per_miss;
+    *r = resident;
+    return has_stats;
+  }
+
+  int64_t share() const {
+    return bytes[Priority::LAST];
+  }
+};
+
+std::unique_ptr<Manager> make_manager(bool adaptive) {
+  auto m = std::make_unique<Manager>(g_ceph_context, MEM, MEM, MEM, false,
+                                     "test-pricache");
+  m->set_adaptive(adaptive);
+  return m;
+}
+
+} // anonymous namespace
+
+TEST(PriorityCache, fixed_ratios)
+{
+  auto a = std::make_shared<FakeCache>("a", 0.5);
+  auto b = std::make_shared<FakeCache>("b", 0.5);
+  auto m = make_manager(false);
+  m->insert("a", a, true);
+  m->insert("b", b, true);
+  for (int i = 0; i < 4; i++) {
+    a->misses += 100000;
+    m->balance();
+  }
+  EXPECT_NEAR(MEM / 2, a->share(), 1);
+  EXPECT_NEAR(MEM / 2, b->share(), 1);
+  EXPECT_EQ(a->share(), a->get_committed_size());
+}
+
+TEST(PriorityCache, adaptive_shifts_to_missing_cache)
+{
+  auto a = std::make_shared<FakeCache>("a", 0.5);
+  auto b = std::make_shared<FakeCache>("b", 0.5);
+  auto m = make_manager(true);
+  m->insert("a", a, true);
+  m->insert("b", b, true);
+  // the first balance only records where the miss counters start
+  a->misses = b->misses = 1000;
+  m->balance();
+  EXPECT_NEAR(MEM / 2, a->share(), 1);
+
+  a->misses += 100000;
+  b->misses += 1000;
+  m->balance();
+  EXPECT_GT(a->share(), b->share());
+  // the scored caches still share what their ratios added up to
+  EXPECT_NEAR(MEM, a->share() + b->share(), 2);
+
+  // an idle interval keeps the last weights
+  int64_t last = a->share();
+  m->balance();
+  EXPECT_EQ(last, a->share());
+
+  // once b misses as much as a did, the split moves back
+  b->misses += 400000;
+  m->balance();
+  EXPECT_LT(a->share(), last);
+}
+
+TEST(PriorityCache, adaptive_is_bounded)
+{
+  auto a = std::make_shared<FakeCache>("a", 0.5);
+  auto b = std::make_shared<FakeCache>("b", 0.5);
+  auto m = make_manager(true);
+  m->insert("a", a, true);
+  m->insert("b", b, true);
+  m->balance();
+  // b never misses, but must not be starved
+  for (int i = 0; i < 100; i++) {
+    a->misses += 100000;
+    m->balance();
+  }
+  EXPECT_GT(b->share(), (int64_t)(MEM / 10));
+  EXPECT_LT(a->share(), (int64_t)(MEM * 9 / 10));
+}
+
+TEST(PriorityCache, adaptive_compares_bytes)
+{
+  // a counts missed items of 4k each, b counts missed bytes: the same
+  // amount of missed data must weigh the same
+  auto a = std::make_shared<FakeCache>("a", 0.5);
+  auto b = std::make_shared<FakeCache>("b", 0.5);
+  a->bytes_per_miss = 4096;
+  auto m = make_manager(true);
+  m->insert("a", a, true);
+  m->insert("b", b, true);
+  m->balance();
+  for (int i = 0; i < 4; i++) {
+    a->misses += 10;
+    b->misses += 10 * 4096;
+    m->balance();
+  }
+  EXPECT_NEAR(MEM / 2, a->share(), 1);
+  EXPECT_NEAR(MEM / 2, b->share(), 1);
+}
+
+TEST(PriorityCache, adaptive_keeps_unscored_ratio)
+{
+  auto a = std::make_shared<FakeCache>("a", 0.4);
+  auto b = std::make_shared<FakeCache>("b", 0.4);
+  auto c = std::make_shared<FakeCache>("c", 0.2, false);
+  auto m = make_manager(true);
+  m->insert("a", a, true);
+  m->insert("b", b, true);
+  m->insert("c", c, true);
+  m->balance();
+  a->misses += 100000;
+  m->balance();
+  EXPECT_GT(a->share(), b->share());
+  EXPECT_NEAR(MEM / 5, c->share(), 1);
+}
@@ -395,6 +395,43 @@ TEST(SharedCache_all, lru) {
   ASSERT_TRUE(cache.lookup(0).get());
 }
 
+TEST(SharedCache_all, lru_hot) {
+  const size_t SIZE = 5;
+  SharedLRU<int, int> cache(NULL, SIZE);
+  cache.set_hot_size(2);
+
+  // 0 and 1 are hit twice, and make it to the hot segment
+  for (int i = 0; i < 2; ++i) {
+    cache.add(i, new int(i));
+    ASSERT_TRUE(cache.lookup(i).get());
+  }
+  // a scan through used-once entries does not evict them
+  for (int i = 2; i < 4 * (int)SIZE; ++i) {
+    cache.add(i, new int(i));
+  }
+  ASSERT_TRUE(cache.lookup(0).get());
+  ASSERT_TRUE(cache.lookup(1).get());
+  ASSERT_EQ((int)SIZE, cache.get_count());
+
+  // once demoted from the hot segment, an entry is evicted again
+  ASSERT_TRUE(cache.lookup(4 * SIZE - 1).get());
+  ASSERT_TRUE(cache.lookup(4 * SIZE - 2).get());
+  for (int i = 4 * SIZE; i < 8 * (int)SIZE; ++i) {
+    cache.add(i, new int(i));
+  }
+  ASSERT_FALSE(cache.lookup(0));
+  ASSERT_FALSE(cache.lookup(1));
+  ASSERT_TRUE(cache.lookup(4 * SIZE - 1).get());
+
+  // disabling the hot segment makes it a plain LRU again
+  cache.set_hot_size(0);
+  for (int i = 8 * SIZE; i < 10 * (int)SIZE; ++i) {
+    cache.add(i, new int(i));
+  }
+  ASSERT_FALSE(cache.lookup(4 * SIZE - 1));
+  ASSERT_EQ((int)SIZE, cache.get_count());
+}
+
 // Local Variables:
 // compile-command: "cd ../.. ; make unittest_shared_cache && ./unittest_shared_cache # --gtest_filter=*.* --log-to-stderr=true"
 // End:
@@ -90,6 +90,26 @@ TEST_P(CompressorTest, small_round_trip)
        << " with " << GetParam() << std::endl;
 }
 
+TEST_P(CompressorTest, compress_batch)
+{
+  std::vector<bufferlist> origs(8);
+  std::vector<Compressor::compress_job_t> jobs(origs.size());
+  for (unsigned i = 0; i < origs.size(); ++i) {
+    while (origs[i].length() < 65536 * (i + 1)) {
+      origs[i].append("This is a short string.  There are many strings like it but this one is mine.");
+    }
+    jobs[i].in = &origs[i];
+  }
+  compressor->compress_batch(jobs);
+  for (unsigned i = 0; i < origs.size(); ++i) {
+    ASSERT_EQ(0, jobs[i].r);
+    bufferlist decompressed;
+    int r = compressor->decompress(jobs[i].out, decompressed, jobs[i].compressor_message);
+    ASSERT_EQ(0, r);
+    ASSERT_TRUE(decompressed.contents_equal(origs[i]));
+  }
+}
+
 TEST_P(CompressorTest, big_round_trip_repeated)
 {
   unsigned len = 1048576 * 4;
@@ -1453,6 +1453,60 @@ TEST_F(CrushWrapperTest, try_remap_rule) {
   }
 }
 
+TEST_F(CrushWrapperTest, do_rule_workspace) {
+  CrushWrapper c;
+  c.create();
+  c.set_type_name(0, "osd");
+  c.set_type_name(1, "host");
+  c.set_type_name(2, "root");
+  int bno;
+  ASSERT_EQ(0, c.add_bucket(0, CRUSH_BUCKET_STRAW2, CRUSH_HASH_DEFAULT,
+			    2, 0, NULL, NULL, &bno));
+  c.set_item_name(bno, "default");
+  c.set_max_devices(40);
+  for (int osd = 0; osd < 40; ++osd) {
+    map<string,string> loc;
+    loc["host"] = "host" + stringify(osd / 5);
+    loc["root"] = "default";
+    c.insert_item(cct, osd, 1.0 + (osd % 3), "osd." + stringify(osd), loc);
+  }
+  c.finalize();
+
+  ostringstream err;
+  int firstn = c.add_simple_rule("firstn", "default", "host", "",
+				 "firstn", 0, &err);
+  ASSERT_LE(0, firstn);
+  int indep = c.add_simple_rule("indep", "default", "host", "",
+				"indep", 0, &err);
+  ASSERT_LE(0, indep);
+
+  vector<__u32> weight(40, 0x10000);
+  weight[7] = 0;
+  weight[12] = 0x8000;
+
+  // one workspace reused across rules, sizes and inputs must give the
+  // same answers as a fresh one every time
+  CrushWrapper::Workspace ws;
+  vector<int> xs;
+  for (int x = 0; x < 1000; ++x) {
+    xs.push_back(x * 7919);
+  }
+  for (int rule : {firstn, indep}) {
+    for (int size : {3, 6, 2}) {
+      vector<vector<int>> batch;
+      c.do_rule_batch(rule, xs, batch, size, weight, 0);
+      ASSERT_EQ(xs.size(), batch.size());
+      for (size_t i = 0; i < xs.size(); ++i) {
+	vector<int> expected, out;
+	c.do_rule(rule, xs[i], expected, size, weight, 0);
+	c.do_rule(rule, xs[i], out, size, weight, 0, ws);
+	ASSERT_EQ(expected, out) << "rule " << rule << " x " << xs[i];
+	ASSERT_EQ(expected, batch[i]) << "rule " << rule << " x " << xs[i];
+      }
+    }
+  }
+}
+
 // Local Variables:
 // compile-command: "cd ../../../build ; make -j4 unittest_crush_wrapper && valgrind --tool=memcheck bin/unittest_crush_wrapper"
 // End:
@@ -658,3 +658,24 @@ TEST_F(CRUSHTest, straw2_reweight) {
     cout << "     vs " << estddev << std::endl;
   }
 }
+
+TEST(CRUSH, hash32_3_multi) {
+  // the batched hash must agree bit for bit with the scalar one, for
+  // full batches of lanes and for the leftover tail alike
+  __s32 ids[41];
+  __u32 out[41];
+  for (int i = 0; i < 41; ++i) {
+    ids[i] = i % 2 ? -1 - i * 7919 : i * 104729;
+  }
+  for (unsigned n = 0; n <= 41; ++n) {
+    for (__u32 x : {0u, 1u, 0x12345678u, 0xffffffffu}) {
+      for (__u32 r : {0u, 3u, 1000u}) {
+	crush_hash32_3_multi(CRUSH_HASH_RJENKINS1, x, ids, r, out, n);
+	for (unsigned i = 0; i < n; ++i) {
+	  ASSERT_EQ(crush_hash32_3(CRUSH_HASH_RJENKINS1, x, ids[i], r), out[i])
+	    << "n " << n << " i " << i << " x " << x << " r " << r;
+	}
+      }
+    }
+  }
+}
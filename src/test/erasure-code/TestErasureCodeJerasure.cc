@@ -126,6 +126,16 @@ TYPED_TEST(ErasureCodeTest, encode_decode)
       EXPECT_EQ(0, memcmp(decoded[0].c_str(), in.c_str(), length));
       EXPECT_EQ(0, memcmp(decoded[1].c_str(), in.c_str() + length,
 			  in.length() - length));
+
+      // the same erasures again, possibly from a cached decoding matrix
+      map<int, bufferlist> decoded_again;
+      EXPECT_EQ(0, jerasure._decode(set<int>(want_to_decode, want_to_decode+2),
+				    degraded,
+				    &decoded_again));
+      EXPECT_EQ(4u, decoded_again.size());
+      EXPECT_EQ(0, memcmp(decoded_again[0].c_str(), in.c_str(), length));
+      EXPECT_EQ(0, memcmp(decoded_again[1].c_str(), in.c_str() + length,
+			  in.length() - length));
     }
   }
 }
@@ -601,6 +601,45 @@ TEST(ErasureCodeLrc, minimum_to_decode)
   }
 }
 
+TEST(ErasureCodeLrc, minimum_to_decode_local_group)
+{
+  // k=4 m=2 l=3 generates the layers
+  //
+  //   DDc_DDc_  global
+  //   DDDc____  local group of chunks 0-3
+  //   ____DDDc  local group of chunks 4-7
+  //
+  // recovering a single lost chunk must only read the survivors of its
+  // own local group, which is the plan ECBackend passes on for recovery
+  ErasureCodeLrc lrc(g_conf().get_val<std::string>("erasure_code_dir"));
+  ErasureCodeProfile profile;
+  profile["k"] = "4";
+  profile["m"] = "2";
+  profile["l"] = "3";
+  EXPECT_EQ(0, lrc.init(profile, &cerr));
+  ASSERT_EQ(8u, lrc.get_chunk_count());
+  const set<int> groups[] = { {0, 1, 2, 3}, {4, 5, 6, 7} };
+  for (const auto &group : groups) {
+    for (int lost : group) {
+      set<int> want_to_read = { lost };
+      set<int> available_chunks;
+      for (int i = 0; i < (int)lrc.get_chunk_count(); i++) {
+	if (i != lost)
+	  available_chunks.insert(i);
+      }
+      map<int, vector<pair<int, int>>> minimum;
+      EXPECT_EQ(0, lrc.minimum_to_decode(want_to_read, available_chunks,
+					 &minimum));
+      set<int> expected = group;
+      expected.erase(lost);
+      set<int> read;
+      for (const auto &[shard, subchunks] : minimum)
+	read.insert(shard);
+      EXPECT_EQ(expected, read) << "lost chunk " << lost;
+    }
+  }
+}
+
 TEST(ErasureCodeLrc, encode_decode)
 {
   ErasureCodeLrc lrc(g_conf().get_val<std::string>("erasure_code_dir"));
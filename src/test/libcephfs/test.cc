@@ -38,6 +38,7 @@
 #endif
 
 #include <fmt/format.h>
+#include <future>
 #include <map>
 #include <vector>
 #include <thread>
@@ -1297,6 +1298,82 @@ TEST(LibCephFS, LlreadvLlwritev) {
   ceph_shutdown(cmount);
 }
 
+static void nonblocking_io_done(struct ceph_ll_io_info *io_info)
+{
+  static_cast<std::promise<int64_t>*>(io_info->priv)->set_value(io_info->result);
+}
+
+TEST(LibCephFS, LlNonblockingReadvWritev) {
+  struct ceph_mount_info *cmount;
+  ASSERT_EQ(ceph_create(&cmount, NULL), 0);
+  ASSERT_EQ(ceph_conf_read_file(cmount, NULL), 0);
+  ASSERT_EQ(0, ceph_conf_parse_env(cmount, NULL));
+  ASSERT_EQ(ceph_mount(cmount, NULL), 0);
+
+  int mypid = getpid();
+  char filename[256];
+
+  sprintf(filename, "test_llnonblockingreadvwritevfile%u", mypid);
+
+  Inode *root, *file;
+  ASSERT_EQ(ceph_ll_lookup_root(cmount, &root), 0);
+
+  Fh *fh;
+  struct ceph_statx stx;
+  UserPerm *perms = ceph_mount_perms(cmount);
+
+  ASSERT_EQ(ceph_ll_create(cmount, root, filename, 0666,
+		    O_RDWR|O_CREAT|O_TRUNC, &file, &fh, &stx, 0, 0, perms), 0);
+
+  char out0[] = "hello ";
+  char out1[] = "world\n";
+  struct iovec iov_out[2] = {
+	{out0, sizeof(out0)},
+	{out1, sizeof(out1)},
+  };
+  char in0[sizeof(out0)];
+  char in1[sizeof(out1)];
+  struct iovec iov_in[2] = {
+	{in0, sizeof(in0)},
+	{in1, sizeof(in1)},
+  };
+  ssize_t nwritten = iov_out[0].iov_len + iov_out[1].iov_len;
+  ssize_t nread = iov_in[0].iov_len + iov_in[1].iov_len;
+
+  // both are queued before either is waited for; requests on one
+  // filehandle complete in order, so the read sees the write
+  std::promise<int64_t> wrote, read;
+  struct ceph_ll_io_info wr_info = {};
+  wr_info.callback = nonblocking_io_done;
+  wr_info.priv = &wrote;
+  wr_info.fh = fh;
+  wr_info.iov = iov_out;
+  wr_info.iovcnt = 2;
+  wr_info.write = true;
+  wr_info.fsync = true;
+  struct ceph_ll_io_info rd_info = {};
+  rd_info.callback = nonblocking_io_done;
+  rd_info.priv = &read;
+  rd_info.fh = fh;
+  rd_info.iov = iov_in;
+  rd_info.iovcnt = 2;
+
+  ASSERT_EQ(0, ceph_ll_nonblocking_readv_writev(cmount, &wr_info));
+  ASSERT_EQ(0, ceph_ll_nonblocking_readv_writev(cmount, &rd_info));
+  ASSERT_EQ(nwritten, wrote.get_future().get());
+  ASSERT_EQ(nread, read.get_future().get());
+  ASSERT_EQ(0, strncmp((const char*)iov_in[0].iov_base, (const char*)iov_out[0].iov_base, iov_out[0].iov_len));
+  ASSERT_EQ(0, strncmp((const char*)iov_in[1].iov_base, (const char*)iov_out[1].iov_base, iov_out[1].iov_len));
+
+  // no callback, no request
+  struct ceph_ll_io_info bad_info = {};
+  bad_info.fh = fh;
+  ASSERT_EQ(-EINVAL, ceph_ll_nonblocking_readv_writev(cmount, &bad_info));
+
+  ceph_ll_close(cmount, fh);
+  ceph_shutdown(cmount);
+}
+
 TEST(LibCephFS, StripeUnitGran) {
   struct ceph_mount_info *cmount;
   ASSERT_EQ(ceph_create(&cmount, NULL), 0);
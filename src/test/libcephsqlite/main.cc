@@ -32,6 +32,7 @@
 
 #include "common/ceph_argparse.h"
 #include "common/ceph_crypto.h"
+#include "common/ceph_json.h"
 #include "common/ceph_time.h"
 #include "common/common_init.h"
 #include "common/debug.h"
@@ -381,6 +382,76 @@ out:
   ASSERT_EQ(0, rc);
 }
 
+TEST_F(CephSQLiteTest, StriperReadahead) {
+  static const size_t page = 4096;
+  static const size_t window = 16*page;
+  librados::IoCtx ioctx;
+  std::shared_ptr<PerfCounters> logger;
+  ASSERT_EQ(0, cluster.ioctx_create(pool.c_str(), ioctx));
+  ASSERT_EQ(0, SimpleRADOSStriper::config_logger(cct.get(), "striper_readahead_test", &logger));
+  auto counter = [&logger](const char* name) {
+    JSONFormatter f;
+    logger->dump_formatted(&f, false, name);
+    std::stringstream ss;
+    f.flush(ss);
+    JSONParser p;
+    EXPECT_TRUE(p.parse(ss.str().c_str(), ss.str().length()));
+    uint64_t v = 0;
+    JSONDecoder::decode_json(name, v, p.find_obj("striper_readahead_test"));
+    return v;
+  };
+
+  auto rs = std::make_unique<SimpleRADOSStriper>(ioctx, get_name() + ".ra");
+  rs->set_logger(logger);
+  rs->set_readahead(window);
+  ASSERT_EQ(0, rs->create());
+  ASSERT_EQ(0, rs->open());
+  ASSERT_EQ(0, rs->lock(1000));
+
+  std::string data(8*window, '\0');
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = (char)(i / page);
+  }
+  ASSERT_EQ((ssize_t)data.size(), rs->write(data.data(), data.size(), 0));
+  ASSERT_EQ(0, rs->flush());
+
+  char buf[page];
+  /* random reads never trigger read-ahead */
+  for (uint64_t off : {5*page, 2*page, 9*page, 1*page}) {
+    ASSERT_EQ((ssize_t)page, rs->read(buf, page, off));
+    ASSERT_EQ(0, memcmp(buf, data.data()+off, page));
+  }
+  ASSERT_EQ(0u, counter("readahead"));
+
+  /* a single adjacent read is not a scan yet... */
+  ASSERT_EQ((ssize_t)page, rs->read(buf, page, 2*page));
+  ASSERT_EQ(0, memcmp(buf, data.data()+2*page, page));
+  ASSERT_EQ(0u, counter("readahead"));
+
+  /* ...but the second one in a row is */
+  ASSERT_EQ((ssize_t)page, rs->read(buf, page, 3*page));
+  ASSERT_EQ(0, memcmp(buf, data.data()+3*page, page));
+  ASSERT_EQ(1u, counter("readahead"));
+
+  /* the rest of the window is served from memory, then it is refilled */
+  for (uint64_t off = 4*page; off < 3*page + 2*window; off += page) {
+    ASSERT_EQ((ssize_t)page, rs->read(buf, page, off));
+    ASSERT_EQ(0, memcmp(buf, data.data()+off, page));
+  }
+  ASSERT_EQ(2u, counter("readahead"));
+  ASSERT_EQ(2*window/page - 2, counter("readahead_hit"));
+
+  /* a write into the window drops it */
+  std::string page_of_ff(page, '\xff');
+  uint64_t off = 3*page + 2*window - page;
+  ASSERT_EQ((ssize_t)page, rs->write(page_of_ff.data(), page, off));
+  ASSERT_EQ((ssize_t)page, rs->read(buf, page, off));
+  ASSERT_EQ(0, memcmp(buf, page_of_ff.data(), page));
+  ASSERT_EQ(2u, counter("readahead"));
+
+  ASSERT_EQ(0, rs->remove());
+}
+
 TEST_F(CephSQLiteTest, InsertExclusiveRate) {
   using clock = ceph::coarse_mono_clock;
   using time = ceph::coarse_mono_time;
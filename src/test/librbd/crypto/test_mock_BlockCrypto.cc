@@ -113,6 +113,34 @@ TEST_F(TestMockCryptoBlockCrypto, Encrypt) {
   ASSERT_EQ(data.length(), 8192);
 }
 
+TEST_F(TestMockCryptoBlockCrypto, DecryptInPlace) {
+  uint32_t image_offset = 0x1230 * 512;
+
+  ceph::bufferlist data;
+  data.append(std::string(4096, '1'));
+  data.append(std::string(4096, '2'));
+  data.rebuild();
+  auto data_ptr = reinterpret_cast<const unsigned char*>(data.c_str());
+
+  expect_get_context(CipherMode::CIPHER_MODE_DEC);
+  expect_init_context(std::string("\x30\x12\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 16));
+  _set_last_expectation(
+          EXPECT_CALL(*cryptor, update_context(_, data_ptr, _, 4096))
+          .With(::testing::Args<1, 2>(::testing::Eq()))
+          .After(*expectation_set).WillOnce(Return(4096)));
+  expect_init_context(std::string("\x38\x12\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 16));
+  _set_last_expectation(
+          EXPECT_CALL(*cryptor, update_context(_, data_ptr + 4096, _, 4096))
+          .With(::testing::Args<1, 2>(::testing::Eq()))
+          .After(*expectation_set).WillOnce(Return(4096)));
+  expect_return_context(CipherMode::CIPHER_MODE_DEC);
+
+  ASSERT_EQ(0, bc->decrypt(&data, image_offset));
+
+  ASSERT_EQ(data.length(), 8192);
+  ASSERT_EQ(data_ptr, reinterpret_cast<const unsigned char*>(data.c_str()));
+}
+
 TEST_F(TestMockCryptoBlockCrypto, UnalignedImageOffset) {
   ceph::bufferlist data;
   data.append(std::string(4096, '1'));
@@ -1237,11 +1237,11 @@ TEST_F(TestMockIoCopyupRequest, ProcessCopyup) {
 
   InSequence seq;
 
-  std::string data(4096, '1');
-  expect_read_parent(mock_parent_image_ctx, {{0, 4096}}, data, 0);
+  std::string data(3072, '1');
+  expect_read_parent(mock_parent_image_ctx, {{1024, 3072}}, data, 0);
 
   bufferlist in_prepare_bl;
-  in_prepare_bl.append(std::string(3072, '1'));
+  in_prepare_bl.append(data);
   bufferlist out_prepare_bl;
   out_prepare_bl.substr_of(in_prepare_bl, 0, 1024);
   expect_prepare_copyup(
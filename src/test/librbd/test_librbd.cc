@@ -4735,6 +4735,67 @@ TEST_F(TestLibRBD, TestScatterGatherIO)
   rados_ioctx_destroy(ioctx);
 }
 
+TEST_F(TestLibRBD, TestAioSubmitBatch)
+{
+  rados_ioctx_t ioctx;
+  rados_ioctx_create(_cluster, m_pool_name.c_str(), &ioctx);
+
+  rbd_image_t image;
+  int order = 0;
+  std::string name = get_temp_image_name();
+  uint64_t size = 20 << 20;
+
+  ASSERT_EQ(0, create_image(ioctx, name.c_str(), size, &order));
+  ASSERT_EQ(0, rbd_open(ioctx, name.c_str(), &image, NULL));
+
+  std::string first("first chunk ");
+  std::string second("second chunk");
+  struct iovec first_iov = {.iov_base = &first[0], .iov_len = first.size()};
+  struct iovec second_iov = {.iov_base = &second[0], .iov_len = second.size()};
+
+  rbd_completion_t comps[2];
+  rbd_aio_create_completion(NULL, NULL, &comps[0]);
+  rbd_aio_create_completion(NULL, NULL, &comps[1]);
+
+  // submitted out of offset order; a bad entry rejects the whole batch
+  rbd_aio_batch_op_t writes[] = {
+    {RBD_AIO_BATCH_OP_WRITE, first.size(), &second_iov, 1, comps[1]},
+    {RBD_AIO_BATCH_OP_WRITE, 0, &first_iov, 0, comps[0]}
+  };
+  ASSERT_EQ(-EINVAL, rbd_aio_submit_batch(image, writes, 2));
+  writes[1].iovcnt = 1;
+  ASSERT_EQ(0, rbd_aio_submit_batch(image, writes, 2));
+  for (auto comp : comps) {
+    ASSERT_EQ(0, rbd_aio_wait_for_complete(comp));
+    ASSERT_EQ(0, rbd_aio_get_return_value(comp));
+    rbd_aio_release(comp);
+  }
+
+  std::string read_buffer(first.size() + second.size(), '1');
+  struct iovec read_iovs[] = {
+    {.iov_base = &read_buffer[0], .iov_len = first.size()},
+    {.iov_base = &read_buffer[first.size()], .iov_len = second.size()}
+  };
+  rbd_aio_create_completion(NULL, NULL, &comps[0]);
+  rbd_aio_create_completion(NULL, NULL, &comps[1]);
+  rbd_aio_batch_op_t reads[] = {
+    {RBD_AIO_BATCH_OP_READ, 0, &read_iovs[0], 1, comps[0]},
+    {RBD_AIO_BATCH_OP_READ, first.size(), &read_iovs[1], 1, comps[1]}
+  };
+  ASSERT_EQ(0, rbd_aio_submit_batch(image, reads, 2));
+  for (auto comp : comps) {
+    ASSERT_EQ(0, rbd_aio_wait_for_complete(comp));
+    ASSERT_EQ(12, rbd_aio_get_return_value(comp));
+    rbd_aio_release(comp);
+  }
+  ASSERT_EQ(first + second, read_buffer);
+
+  ASSERT_PASSED(validate_object_map, image);
+  ASSERT_EQ(0, rbd_close(image));
+
+  rados_ioctx_destroy(ioctx);
+}
+
 TEST_F(TestLibRBD, TestEmptyDiscard)
 {
   rados_ioctx_t ioctx;
@@ -167,3 +167,58 @@ TEST(pgmap, dump_object_stat_sum_2)
   ASSERT_EQ(percentify(0), tbl.get(0, col++));
   ASSERT_EQ(stringify(byte_u_t(avail/pool.size)), tbl.get(0, col++));
 }
+
+TEST(pgmap, digest_delta)
+{
+  PGMapDigest from;
+  from.num_pg = 3;
+  from.pg_pool_sum[1].stats.sum.num_objects = 10;
+  from.pg_pool_sum[2].stats.sum.num_objects = 20;
+  from.pg_pool_sum[3].stats.sum.num_objects = 30;
+  from.num_pg_by_pool[1] = 1;
+  from.num_pg_by_pool[2] = 1;
+  from.num_pg_by_pool[3] = 1;
+  from.num_pg_by_osd[0].acting = 3;
+  from.osd_sum_by_class["hdd"].num_osds = 1;
+  from.purged_snaps[1].insert(snapid_t(1), 2);
+
+  // pool 3 goes away, pool 4 shows up, pool 1 changes; pool 2 stays put
+  PGMapDigest to = from;
+  to.num_pg_active = 3;
+  to.pg_pool_sum.erase(3);
+  to.num_pg_by_pool.erase(3);
+  to.purged_snaps.erase(1);
+  to.pg_pool_sum[1].stats.sum.num_objects = 11;
+  to.pg_pool_sum[4].stats.sum.num_objects = 40;
+  to.num_pg_by_pool[4] = 1;
+  to.osd_sum_by_class["ssd"].num_osds = 1;
+  // osd_stat_t::operator== ignores alerts, the delta must not
+  to.osd_sum_by_class["hdd"].os_alerts[0]["BLUESTORE_SLOW_OP_ALERT"] = "slow";
+
+  PGMapDigestDelta delta;
+  delta.diff(from, to);
+  ASSERT_EQ(2u, delta.pg_pool_sum.changed.size());
+  ASSERT_EQ(1u, delta.pg_pool_sum.changed.count(1));
+  ASSERT_EQ(1u, delta.pg_pool_sum.changed.count(4));
+  ASSERT_EQ(std::set<int32_t>{3}, delta.pg_pool_sum.removed);
+  ASSERT_TRUE(delta.num_pg_by_osd.empty());
+  ASSERT_EQ(std::set<int64_t>{1}, delta.purged_snaps.removed);
+  ASSERT_EQ(2u, delta.osd_sum_by_class.changed.size());
+
+  bufferlist bl;
+  encode(delta, bl, CEPH_FEATURES_ALL);
+  PGMapDigestDelta decoded;
+  auto p = bl.cbegin();
+  decode(decoded, p);
+
+  PGMapDigest applied = from;
+  decoded.apply(applied);
+  ASSERT_EQ(to.num_pg_active, applied.num_pg_active);
+  ASSERT_EQ(to.pg_pool_sum, applied.pg_pool_sum);
+  ASSERT_EQ(to.num_pg_by_pool, applied.num_pg_by_pool);
+  ASSERT_EQ(to.num_pg_by_osd, applied.num_pg_by_osd);
+  ASSERT_EQ(to.osd_sum_by_class, applied.osd_sum_by_class);
+  ASSERT_EQ(to.osd_sum_by_class["hdd"].os_alerts,
+	    applied.osd_sum_by_class["hdd"].os_alerts);
+  ASSERT_EQ(to.purged_snaps, applied.purged_snaps);
+}
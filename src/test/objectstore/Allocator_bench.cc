@@ -13,6 +13,7 @@
 #include "include/stringify.h"
 #include "include/Context.h"
 #include "os/bluestore/Allocator.h"
+#include "os/bluestore/fastbmap_allocator_impl.h"
 
 #include <boost/random/uniform_int.hpp>
 typedef boost::mt11213b gen_type;
@@ -328,6 +329,22 @@ TEST_P(AllocTest, test_alloc_bench_10_300)
   doOverwriteTest(capacity, prefill, overwrite);
 }
 
+// same as test_alloc_bench_90_300 but with the scalar slot scan, to compare
+// against the runtime-selected (SIMD) one for bitmap based allocators
+TEST_P(AllocTest, test_alloc_bench_90_300_scalar_scan)
+{
+  if (string(GetParam()) != "bitmap" && string(GetParam()) != "hybrid") {
+    GTEST_SKIP() << "not using fastbmap";
+  }
+  auto saved = find_nonclear_slot;
+  find_nonclear_slot = find_nonclear_slot_generic;
+  uint64_t capacity = uint64_t(1024) * 1024 * 1024 * 1024;
+  auto prefill = capacity - capacity / 10;
+  auto overwrite = capacity * 3;
+  doOverwriteTest(capacity, prefill, overwrite);
+  find_nonclear_slot = saved;
+}
+
 TEST_P(AllocTest, mempoolAccounting)
 {
   uint64_t bytes = mempool::bluestore_alloc::allocated_bytes();
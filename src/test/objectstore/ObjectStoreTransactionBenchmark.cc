@@ -43,6 +43,8 @@ class Transaction {
   };
   static Tick write_ticks, setattr_ticks, omap_setkeys_ticks, omap_rmkey_ticks;
   static Tick encode_ticks, decode_ticks, iterate_ticks;
+  static Tick write_move_ticks, append_move_ticks;
+  static Tick replica_encode_each_ticks, replica_encode_once_ticks;
 
   void write(coll_t cid, const ghobject_t& oid, uint64_t off, uint64_t len,
              const bufferlist& data) {
@@ -50,6 +52,17 @@ class Transaction {
     t.write(cid, oid, off, len, data);
     write_ticks.add(Cycles::rdtsc() - start_time);
   }
+  void write_move(coll_t cid, const ghobject_t& oid, uint64_t off, uint64_t len,
+                  bufferlist&& data) {
+    uint64_t start_time = Cycles::rdtsc();
+    t.write(cid, oid, off, len, std::move(data));
+    write_move_ticks.add(Cycles::rdtsc() - start_time);
+  }
+  void append_move(Transaction&& other) {
+    uint64_t start_time = Cycles::rdtsc();
+    t.append(std::move(other.t));
+    append_move_ticks.add(Cycles::rdtsc() - start_time);
+  }
   void setattr(coll_t cid, const ghobject_t& oid, const string &name,
                bufferlist& val) {
     uint64_t start_time = Cycles::rdtsc();
@@ -83,6 +96,28 @@ class Transaction {
     decode_ticks.add(Cycles::rdtsc() - start_time);
   }
 
+  // what the primary does to ship the transaction to its replicas:
+  // encode it for every message, or once with every message sharing
+  // the encoded buffers
+  void apply_encode_replicas(unsigned replicas) {
+    std::vector<bufferlist> msgs(replicas);
+    uint64_t start_time = Cycles::rdtsc();
+    for (auto& m : msgs) {
+      t.encode(m);
+    }
+    replica_encode_each_ticks.add(Cycles::rdtsc() - start_time);
+
+    msgs.clear();
+    msgs.resize(replicas);
+    start_time = Cycles::rdtsc();
+    bufferlist bl;
+    t.encode(bl);
+    for (auto& m : msgs) {
+      m.append(bl);
+    }
+    replica_encode_once_ticks.add(Cycles::rdtsc() - start_time);
+  }
+
   void apply_iterate() {
     uint64_t start_time = Cycles::rdtsc();
     ObjectStore::Transaction::iterator i = t.begin();
@@ -134,6 +169,10 @@ class Transaction {
     cerr << " encode op: " << Cycles::to_microseconds(Transaction::encode_ticks.ticks) << "us count: " << Transaction::encode_ticks.count << std::endl;
     cerr << " decode op: " << Cycles::to_microseconds(Transaction::decode_ticks.ticks) << "us count: " << Transaction::decode_ticks.count << std::endl;
     cerr << " iterate op: " << Cycles::to_microseconds(Transaction::iterate_ticks.ticks) << "us count: " << Transaction::iterate_ticks.count << std::endl;
+    cerr << " write (move) op: " << Cycles::to_microseconds(write_move_ticks.ticks) << "us count: " << write_move_ticks.count << std::endl;
+    cerr << " append (move) op: " << Cycles::to_microseconds(append_move_ticks.ticks) << "us count: " << append_move_ticks.count << std::endl;
+    cerr << " replica encode (each) op: " << Cycles::to_microseconds(replica_encode_each_ticks.ticks) << "us count: " << replica_encode_each_ticks.count << std::endl;
+    cerr << " replica encode (once) op: " << Cycles::to_microseconds(replica_encode_once_ticks.ticks) << "us count: " << replica_encode_once_ticks.count << std::endl;
   }
 };
 
@@ -221,6 +260,30 @@ class PerfCase {
     }
     return ticks;
   }
+
+  // a replicated 4k write the way the primary builds it: the data is
+  // moved into the transaction, the pg log update is appended, and the
+  // result is shipped to the replicas
+  uint64_t rados_write_4k_replicated(int times, unsigned replicas) {
+    uint64_t ticks = 0;
+    uint64_t len = Kib *4;
+    for (int i = 0; i < times; i++) {
+      Transaction t;
+      Transaction log_t;
+      ghobject_t oid = create_object();
+      bufferlist bl = data["4k"];
+      map<string, bufferlist> pglog_attrset;
+      pglog_attrset[pglog_attr] = data[pglog_attr];
+      uint64_t start_time = Cycles::rdtsc();
+      t.write_move(cid, oid, 0, len, std::move(bl));
+      t.setattr(cid, oid, attr, data[attr]);
+      log_t.omap_setkeys(meta_cid, pglog_oid, pglog_attrset);
+      t.append_move(std::move(log_t));
+      t.apply_encode_replicas(replicas);
+      ticks += Cycles::rdtsc() - start_time;
+    }
+    return ticks;
+  }
 };
 const string PerfCase::info_epoch_attr("11.40_epoch");
 const string PerfCase::info_info_attr("11.40_info");
@@ -233,9 +296,11 @@ const ghobject_t PerfCase::pglog_oid(hobject_t(sobject_t(object_t("cid_pglog"),
 const ghobject_t PerfCase::info_oid(hobject_t(sobject_t(object_t("infos"), 0)));
 Transaction::Tick Transaction::write_ticks, Transaction::setattr_ticks, Transaction::omap_setkeys_ticks, Transaction::omap_rmkey_ticks;
 Transaction::Tick Transaction::encode_ticks, Transaction::decode_ticks, Transaction::iterate_ticks;
+Transaction::Tick Transaction::write_move_ticks, Transaction::append_move_ticks;
+Transaction::Tick Transaction::replica_encode_each_ticks, Transaction::replica_encode_once_ticks;
 
 void usage(const string &name) {
-  cerr << "Usage: " << name << " [times] "
+  cerr << "Usage: " << name << " [times] [replicas]"
        << std::endl;
 }
 
@@ -257,10 +322,14 @@ int main(int argc, char **argv)
   }
 
   uint64_t times = atoi(args[0]);
+  unsigned replicas = args.size() > 1 ? atoi(args[1]) : 2;
   PerfCase c;
   uint64_t ticks = c.rados_write_4k(times);
+  uint64_t replicated_ticks = c.rados_write_4k_replicated(times, replicas);
   Transaction::dump_stat();
   cerr << " Total rados op " << times << " run time " << Cycles::to_microseconds(ticks) << "us." << std::endl;
+  cerr << " Total replicated rados op " << times << " (" << replicas << " replicas) run time "
+       << Cycles::to_microseconds(replicated_ticks) << "us." << std::endl;
 
   return 0;
 }
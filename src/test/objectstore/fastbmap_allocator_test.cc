@@ -1064,3 +1064,34 @@ TEST(TestAllocatorLevel01, test_claim_free_l2)
   ASSERT_EQ(0x15000,
     al2.debug_get_free());
 }
+
+TEST(TestAllocatorLevel01, test_find_nonclear_slot)
+{
+  std::vector<slot_t> slots(1024, all_slot_clear);
+  auto check = [&](size_t pos, size_t end) {
+    ASSERT_EQ(find_nonclear_slot_generic(slots.data(), pos, end),
+      find_nonclear_slot(slots.data(), pos, end));
+  };
+  for (size_t end = 0; end <= 67; ++end) {
+    for (size_t pos = 0; pos <= end; ++pos) {
+      check(pos, end);
+    }
+  }
+  ASSERT_EQ(1024u, find_nonclear_slot(slots.data(), 0, 1024));
+
+  // every single position, every start and every (unaligned) end around it
+  for (size_t i = 0; i < 80; ++i) {
+    slots[i] = slot_t(1) << (i % bits_per_slot);
+    for (size_t pos = 0; pos <= i + 1; ++pos) {
+      for (size_t end = pos; end < 90; ++end) {
+        check(pos, end);
+      }
+    }
+    ASSERT_EQ(i, find_nonclear_slot(slots.data(), 0, 1024));
+    slots[i] = all_slot_clear;
+  }
+  slots[1000] = all_slot_set;
+  ASSERT_EQ(1000u, find_nonclear_slot(slots.data(), 3, 1024));
+  ASSERT_EQ(1000u, find_nonclear_slot(slots.data(), 1000, 1001));
+  ASSERT_EQ(999u, find_nonclear_slot(slots.data(), 3, 999));
+}
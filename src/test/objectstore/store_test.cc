@@ -1266,6 +1266,201 @@ TEST_P(StoreTest, CompressionTest) {
   doCompressionTest();
 }
 
+TEST_P(StoreTest, CompressionBackoffTest) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  SetVal(g_conf(), "bluestore_compression_algorithm", "snappy");
+  SetVal(g_conf(), "bluestore_compression_mode", "aggressive");
+  SetVal(g_conf(), "bluestore_compression_backoff_threshold", "2");
+  SetVal(g_conf(), "bluestore_compression_backoff_max", "4");
+  g_ceph_context->_conf.apply_changes(nullptr);
+
+  coll_t cid;
+  auto ch = store->create_new_collection(cid);
+  ghobject_t hoid(hobject_t(sobject_t("Object 1", CEPH_NOSNAP)));
+  int r;
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+
+  const PerfCounters* logger = store->get_perf_counters();
+  auto skipped = [&]() {
+    return logger->get(l_bluestore_compress_skipped_count);
+  };
+  auto write_random = [&](uint64_t off) {
+    std::string data(0x20000, 0);
+    for (auto& c : data) {
+      c = rand();
+    }
+    bufferlist bl;
+    bl.append(data);
+    ObjectStore::Transaction t;
+    t.write(cid, hoid, off, bl.length(), bl);
+    ASSERT_EQ(queue_transaction(store, ch, std::move(t)), 0);
+  };
+
+  auto base = skipped();
+  // two rejected writes in a row start a back-off of two writes
+  write_random(0);
+  write_random(0x20000);
+  ASSERT_EQ(skipped(), base);
+  write_random(0x40000);
+  write_random(0x60000);
+  ASSERT_EQ(skipped(), base + 2);
+  // the probe fails as well, the back-off doubles
+  write_random(0x80000);
+  ASSERT_EQ(skipped(), base + 2);
+  for (unsigned i = 0; i < 4; ++i) {
+    write_random(0xa0000 + i * 0x20000);
+  }
+  ASSERT_EQ(skipped(), base + 6);
+
+  {
+    ObjectStore::Transaction t;
+    t.remove(cid, hoid);
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  SetVal(g_conf(), "bluestore_compression_mode", "none");
+  SetVal(g_conf(), "bluestore_compression_backoff_threshold", "16");
+  SetVal(g_conf(), "bluestore_compression_backoff_max", "1024");
+  g_ceph_context->_conf.apply_changes(nullptr);
+}
+
+TEST_P(StoreTest, ReadaheadTest) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  SetVal(g_conf(), "bluestore_readahead_trigger_requests", "2");
+  SetVal(g_conf(), "bluestore_readahead_max_bytes_hdd", "1048576");
+  SetVal(g_conf(), "bluestore_readahead_max_bytes_ssd", "1048576");
+  g_ceph_context->_conf.apply_changes(nullptr);
+
+  coll_t cid;
+  auto ch = store->create_new_collection(cid);
+  ghobject_t hoid(hobject_t(sobject_t("Object 1", CEPH_NOSNAP)));
+  ghobject_t hoid2(hobject_t(sobject_t("Object 2", CEPH_NOSNAP)));
+  const uint64_t object_size = 0x400000;
+  const uint64_t chunk = 0x10000;
+  bufferlist orig;
+  orig.append(std::string(object_size, 'a'));
+  int r;
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    t.write(cid, hoid, 0, orig.length(), orig);
+    t.write(cid, hoid2, 0, orig.length(), orig);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  // start from a cold cache
+  ch.reset();
+  ASSERT_EQ(0, store->umount());
+  ASSERT_EQ(0, store->mount());
+  ch = store->open_collection(cid);
+
+  const PerfCounters* logger = store->get_perf_counters();
+  auto base = logger->get(l_bluestore_readahead_count);
+  // random reads never prefetch
+  for (uint64_t off : {0x300000ull, 0x40000ull, 0x200000ull}) {
+    bufferlist bl;
+    ASSERT_EQ((int)chunk, store->read(ch, hoid2, off, chunk, bl));
+  }
+  ASSERT_EQ(logger->get(l_bluestore_readahead_count), base);
+  // a sequential stream does, reads back the same data, and the read
+  // right after the first prefetch is served from the cache
+  bool checked_hit = false;
+  for (uint64_t off = 0; off < object_size; off += chunk) {
+    bool prefetched = logger->get(l_bluestore_readahead_count) > base;
+    auto hits = logger->get(l_bluestore_buffer_hit_bytes);
+    auto misses = logger->get(l_bluestore_buffer_miss_bytes);
+    bufferlist bl;
+    ASSERT_EQ((int)chunk, store->read(ch, hoid, off, chunk, bl));
+    bufferlist expected;
+    expected.substr_of(orig, off, chunk);
+    ASSERT_TRUE(bl_eq(expected, bl));
+    if (prefetched && !checked_hit) {
+      ASSERT_EQ(misses, logger->get(l_bluestore_buffer_miss_bytes));
+      ASSERT_EQ(hits + chunk, logger->get(l_bluestore_buffer_hit_bytes));
+      checked_hit = true;
+    }
+  }
+  ASSERT_TRUE(checked_hit);
+  ASSERT_GT(logger->get(l_bluestore_readahead_bytes), 0u);
+
+  {
+    ObjectStore::Transaction t;
+    t.remove(cid, hoid);
+    t.remove(cid, hoid2);
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  SetVal(g_conf(), "bluestore_readahead_trigger_requests", "4");
+  SetVal(g_conf(), "bluestore_readahead_max_bytes_hdd", "0");
+  SetVal(g_conf(), "bluestore_readahead_max_bytes_ssd", "0");
+  g_ceph_context->_conf.apply_changes(nullptr);
+}
+
+TEST_P(StoreTest, IncrementalFsckTest) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  SetVal(g_conf(), "bluestore_fsck_incremental_interval", "0.1");
+  SetVal(g_conf(), "bluestore_fsck_incremental_objects_per_sec", "0");
+  g_ceph_context->_conf.apply_changes(nullptr);
+
+  coll_t cid;
+  auto ch = store->create_new_collection(cid);
+  int r;
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  const PerfCounters* logger = store->get_perf_counters();
+  auto objects = logger->get(l_bluestore_fsck_incremental_objects);
+  auto errors = logger->get(l_bluestore_fsck_incremental_errors);
+  std::vector<ghobject_t> oids;
+  for (unsigned i = 0; i < 16; ++i) {
+    oids.emplace_back(hobject_t(sobject_t("Object " + stringify(i), CEPH_NOSNAP)));
+    bufferlist bl;
+    bl.append(std::string(0x10000 * (i + 1), 'a' + i));
+    ObjectStore::Transaction t;
+    t.write(cid, oids.back(), 0, bl.length(), bl);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  // the thread polls the (initially disabled) interval every 5 seconds
+  for (unsigned i = 0; i < 200 &&
+	 logger->get(l_bluestore_fsck_incremental_objects) < objects + oids.size();
+       ++i) {
+    usleep(50000);
+  }
+  ASSERT_GE(logger->get(l_bluestore_fsck_incremental_objects),
+	    objects + oids.size());
+  ASSERT_EQ(logger->get(l_bluestore_fsck_incremental_errors), errors);
+
+  {
+    ObjectStore::Transaction t;
+    for (auto& oid : oids) {
+      t.remove(cid, oid);
+    }
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  SetVal(g_conf(), "bluestore_fsck_incremental_interval", "0");
+  SetVal(g_conf(), "bluestore_fsck_incremental_objects_per_sec", "1000");
+  g_ceph_context->_conf.apply_changes(nullptr);
+}
+
 TEST_P(StoreTest, SimpleObjectTest) {
   int r;
   coll_t cid;
@@ -8426,6 +8621,105 @@ TEST_P(StoreTestSpecificAUSize, DeferredDifferentChunks) {
   }
 }
 
+TEST_P(StoreTestSpecificAUSize, DeferredSubmitOrder) {
+
+  if (string(GetParam()) != "bluestore")
+    return;
+  if (smr) {
+    cout << "SKIP: no deferred" << std::endl;
+    return;
+  }
+
+  // deferred batches of several sequencers flushed together: in queue
+  // order, sorted by offset, and sorted and plugged into one io_uring
+  // submit (bdev_ioring_batch_submit, falls back to libaio if io_uring
+  // is not available)
+  struct submit_mode_t {
+    const char *lba_order;
+    const char *batch_submit;
+  };
+  const submit_mode_t modes[] = {
+    {"false", "false"},
+    {"true", "false"},
+    {"true", "true"},
+  };
+  const size_t alloc_size = 4096;
+  const unsigned num_colls = 8;
+  const size_t obj_size = 16 * alloc_size;
+  StartDeferred(alloc_size);
+  SetVal(g_conf(), "bluestore_prefer_deferred_size", "65536");
+  SetVal(g_conf(), "bluestore_deferred_batch_ops", "64");
+  g_conf().apply_changes(nullptr);
+
+  int r;
+  vector<coll_t> cids;
+  for (unsigned c = 0; c < num_colls; ++c) {
+    cids.push_back(coll_t(spg_t(pg_t(c, 1), shard_id_t::NO_SHARD)));
+  }
+  ghobject_t hoid(hobject_t("test", "", CEPH_NOSNAP, 0, 1, ""));
+  {
+    for (auto& cid : cids) {
+      auto ch = store->create_new_collection(cid);
+      ObjectStore::Transaction t;
+      t.create_collection(cid, 0);
+      bufferlist bl;
+      bl.append(std::string(obj_size, 'a'));
+      t.write(cid, hoid, 0, bl.length(), bl);
+      r = queue_transaction(store, ch, std::move(t));
+      ASSERT_EQ(r, 0);
+    }
+  }
+
+  char fill = 'b';
+  for (auto& mode : modes) {
+    SetVal(g_conf(), "bluestore_deferred_submit_lba_order", mode.lba_order);
+    SetVal(g_conf(), "bdev_ioring", mode.batch_submit);
+    SetVal(g_conf(), "bdev_ioring_batch_submit", mode.batch_submit);
+    g_conf().apply_changes(nullptr);
+    CloseAndReopen();
+
+    // the last collection's object sits highest on the device, so queue
+    // them from there down to give the sort something to do
+    for (unsigned c = num_colls; c-- > 0; ) {
+      auto ch = store->open_collection(cids[c]);
+      ObjectStore::Transaction t;
+      bufferlist bl;
+      bl.append(std::string(alloc_size, fill));
+      t.write(cids[c], hoid, c % 16 * alloc_size, bl.length(), bl,
+	      CEPH_OSD_OP_FLAG_FADVISE_NOCACHE);
+      r = queue_transaction(store, ch, std::move(t));
+      ASSERT_EQ(r, 0);
+    }
+    ASSERT_EQ(store->get_perf_counters()->get(
+		l_bluestore_issued_deferred_writes), num_colls);
+    // umount flushes the pending batches of all sequencers at once
+    CloseAndReopen();
+    for (unsigned c = 0; c < num_colls; ++c) {
+      auto ch = store->open_collection(cids[c]);
+      bufferlist bl;
+      r = store->read(ch, hoid, c % 16 * alloc_size, alloc_size, bl);
+      ASSERT_EQ(r, (int)alloc_size);
+      bufferlist expected;
+      expected.append(std::string(alloc_size, fill));
+      ASSERT_TRUE(bl_eq(expected, bl)) << "lba_order " << mode.lba_order
+				       << " batch_submit "
+				       << mode.batch_submit;
+    }
+    ++fill;
+  }
+
+  {
+    for (auto& cid : cids) {
+      auto ch = store->open_collection(cid);
+      ObjectStore::Transaction t;
+      t.remove(cid, hoid);
+      t.remove_collection(cid);
+      r = queue_transaction(store, ch, std::move(t));
+      ASSERT_EQ(r, 0);
+    }
+  }
+}
+
 TEST_P(StoreTestSpecificAUSize, BlobReuseOnOverwriteReverse) {
 
   if (string(GetParam()) != "bluestore")
@@ -0,0 +1,110 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "global/global_context.h"
+#include "kv/rocksdb_cache/BinnedLRUCache.h"
+
+using namespace std;
+using rocksdb_cache::BinnedLRUCacheShard;
+
+namespace {
+
+void no_delete(const rocksdb::Slice&, void*) {}
+
+uint32_t hash_of(const string& key) {
+  return std::hash<string>{}(key);
+}
+
+// every entry has a charge of 1, so usages below count entries
+unique_ptr<BinnedLRUCacheShard> make_shard(size_t capacity,
+					   double probation_ratio) {
+  return make_unique<BinnedLRUCacheShard>(
+    g_ceph_context, capacity, false, 0.0, probation_ratio);
+}
+
+void insert(BinnedLRUCacheShard& shard, const string& key) {
+  ASSERT_TRUE(shard.Insert(key, hash_of(key), nullptr, 1, &no_delete,
+			   nullptr, rocksdb::Cache::Priority::LOW).ok());
+}
+
+// look the key up and drop the reference again; false if it was evicted
+bool touch(BinnedLRUCacheShard& shard, const string& key) {
+  auto h = shard.Lookup(key, hash_of(key));
+  if (!h) {
+    return false;
+  }
+  shard.Release(h);
+  return true;
+}
+
+} // anonymous namespace
+
+TEST(BinnedLRUCache, probation_promotion)
+{
+  auto shard = make_shard(10, 0.5);
+  for (auto& k : {"a", "b", "c", "d", "e"}) {
+    insert(*shard, k);
+  }
+  // nothing has been read again yet
+  ASSERT_EQ(5u, shard->GetProbationUsage());
+  ASSERT_TRUE(touch(*shard, "a"));
+  ASSERT_TRUE(touch(*shard, "b"));
+  ASSERT_EQ(3u, shard->GetProbationUsage());
+  ASSERT_EQ(5u, shard->GetUsage());
+  shard->EraseUnRefEntries();
+}
+
+TEST(BinnedLRUCache, probation_demotion)
+{
+  // the protected segment may hold 10 * (1 - 0.5) = 5 entries
+  auto shard = make_shard(10, 0.5);
+  for (int i = 0; i < 8; ++i) {
+    insert(*shard, to_string(i));
+    ASSERT_TRUE(touch(*shard, to_string(i)));
+  }
+  ASSERT_EQ(8u, shard->GetUsage());
+  ASSERT_EQ(3u, shard->GetProbationUsage());
+  // the oldest protected entries went back to probation, so they are the
+  // first to go
+  for (int i = 0; i < 5; ++i) {
+    insert(*shard, "scan" + to_string(i));
+  }
+  ASSERT_FALSE(touch(*shard, "0"));
+  ASSERT_TRUE(touch(*shard, "7"));
+  shard->EraseUnRefEntries();
+}
+
+TEST(BinnedLRUCache, probation_keeps_hot_entries)
+{
+  auto shard = make_shard(10, 0.25);
+  insert(*shard, "hot");
+  ASSERT_TRUE(touch(*shard, "hot"));
+  // a one-time pass over many more entries than fit
+  for (int i = 0; i < 100; ++i) {
+    insert(*shard, "scan" + to_string(i));
+  }
+  ASSERT_EQ(10u, shard->GetUsage());
+  ASSERT_TRUE(touch(*shard, "hot"));
+  ASSERT_FALSE(touch(*shard, "scan0"));
+  shard->EraseUnRefEntries();
+}
+
+TEST(BinnedLRUCache, no_probation)
+{
+  // ratio 0 is the plain LRU: the scan pushes the hot entry out
+  auto shard = make_shard(10, 0.0);
+  insert(*shard, "hot");
+  ASSERT_TRUE(touch(*shard, "hot"));
+  for (int i = 0; i < 100; ++i) {
+    insert(*shard, "scan" + to_string(i));
+  }
+  ASSERT_EQ(0u, shard->GetProbationUsage());
+  ASSERT_EQ(10u, shard->GetUsage());
+  ASSERT_FALSE(touch(*shard, "hot"));
+  ASSERT_TRUE(touch(*shard, "scan99"));
+  shard->EraseUnRefEntries();
+}
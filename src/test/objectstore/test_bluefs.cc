@@ -1112,6 +1112,74 @@ TEST(BlueFS, truncate_fsync) {
   }
 }
 
+TEST(BlueFS, wal_presize) {
+  uint64_t size = 1048576 * 128;
+  TempBdev bdev{size};
+  const uint64_t presize = 1048576;
+  ConfSaver conf(g_ceph_context->_conf);
+  conf.SetVal("bluefs_wal_prealloc_size", stringify(presize).c_str());
+
+  BlueFS fs(g_ceph_context);
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_DB, bdev.path, false, 1048576));
+  uuid_d fsid;
+  ASSERT_EQ(0, fs.mkfs(fsid, { BlueFS::BDEV_DB, false, false }));
+  ASSERT_EQ(0, fs.mount());
+  ASSERT_EQ(0, fs.mkdir("db.wal"));
+  auto *logger = fs.get_perf_counters();
+  const std::string rec(1000, 'w');
+  uint64_t fsize = 0;
+  {
+    BlueFS::FileWriter *h;
+    ASSERT_EQ(0, fs.open_for_write("db.wal", "000001.log", &h, false));
+    // the zero-fill waits for the first flush
+    ASSERT_FALSE(h->presized);
+    ASSERT_EQ(0u, logger->get(l_bluefs_wal_presized));
+
+    h->append(rec.c_str(), rec.length());
+    ASSERT_EQ(0, fs.fsync(h));
+    ASSERT_TRUE(h->presized);
+    ASSERT_EQ(1u, logger->get(l_bluefs_wal_presized));
+    ASSERT_EQ(0, fs.stat("db.wal", "000001.log", &fsize, nullptr));
+    ASSERT_EQ(presize, fsize);
+    // appends within the presized range must not touch the metadata log
+    uint64_t logged = logger->get(l_bluefs_logged_bytes);
+    for (unsigned i = 1; i < 100; ++i) {
+      h->append(rec.c_str(), rec.length());
+      ASSERT_EQ(0, fs.fsync(h));
+    }
+    ASSERT_EQ(logged, logger->get(l_bluefs_logged_bytes));
+
+    // what BlueRocksWritableFile::Close() does for presized files
+    ASSERT_EQ(0, fs.truncate(h, h->pos));
+    ASSERT_EQ(0, fs.fsync(h));
+    fs.close_writer(h);
+  }
+  {
+    // other files are left alone
+    BlueFS::FileWriter *h;
+    ASSERT_EQ(0, fs.open_for_write("db.wal", "000001.sst", &h, false));
+    h->append(rec.c_str(), rec.length());
+    ASSERT_EQ(0, fs.fsync(h));
+    ASSERT_FALSE(h->presized);
+    fs.close_writer(h);
+  }
+  fs.umount();
+
+  ASSERT_EQ(0, fs.mount());
+  ASSERT_EQ(0, fs.stat("db.wal", "000001.log", &fsize, nullptr));
+  ASSERT_EQ(100 * rec.length(), fsize);
+  BlueFS::FileReader *r;
+  ASSERT_EQ(0, fs.open_for_read("db.wal", "000001.log", &r));
+  bufferlist bl;
+  ASSERT_EQ((int64_t)fsize, fs.read(r, 0, fsize, &bl, NULL));
+  for (unsigned i = 0; i < 100; ++i) {
+    ASSERT_EQ(0, memcmp(bl.c_str() + i * rec.length(), rec.c_str(),
+			rec.length()));
+  }
+  delete r;
+  fs.umount();
+}
+
 TEST(BlueFS, test_shared_alloc) {
   uint64_t size = 1048576 * 128;
   TempBdev bdev_slow{size};
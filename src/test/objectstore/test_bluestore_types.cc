@@ -1125,14 +1125,15 @@ TEST(ExtentMap, seek_lextent)
   auto coll = ceph::make_ref<BlueStore::Collection>(&store, oc, bc, coll_t());
   BlueStore::Onode onode(coll.get(), ghobject_t(), "");
   BlueStore::ExtentMap em(&onode,
-    g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size);
+    g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size,
+    g_ceph_context->_conf->bluestore_extent_map_flat_index_max);
   BlueStore::BlobRef br(new BlueStore::Blob);
   br->shared_blob = new BlueStore::SharedBlob(coll.get());
 
   ASSERT_EQ(em.extent_map.end(), em.seek_lextent(0));
   ASSERT_EQ(em.extent_map.end(), em.seek_lextent(100));
 
-  em.extent_map.insert(*new BlueStore::Extent(100, 0, 100, br));
+  em.insert_extent(new BlueStore::Extent(100, 0, 100, br));
   auto a = em.find(100);
   ASSERT_EQ(a, em.seek_lextent(0));
   ASSERT_EQ(a, em.seek_lextent(99));
@@ -1141,7 +1142,7 @@ TEST(ExtentMap, seek_lextent)
   ASSERT_EQ(a, em.seek_lextent(199));
   ASSERT_EQ(em.extent_map.end(), em.seek_lextent(200));
 
-  em.extent_map.insert(*new BlueStore::Extent(200, 0, 100, br));
+  em.insert_extent(new BlueStore::Extent(200, 0, 100, br));
   auto b = em.find(200);
   ASSERT_EQ(a, em.seek_lextent(0));
   ASSERT_EQ(a, em.seek_lextent(99));
@@ -1152,7 +1153,7 @@ TEST(ExtentMap, seek_lextent)
   ASSERT_EQ(b, em.seek_lextent(299));
   ASSERT_EQ(em.extent_map.end(), em.seek_lextent(300));
 
-  em.extent_map.insert(*new BlueStore::Extent(400, 0, 100, br));
+  em.insert_extent(new BlueStore::Extent(400, 0, 100, br));
   auto d = em.find(400);
   ASSERT_EQ(a, em.seek_lextent(0));
   ASSERT_EQ(a, em.seek_lextent(99));
@@ -1168,6 +1169,61 @@ TEST(ExtentMap, seek_lextent)
   ASSERT_EQ(em.extent_map.end(), em.seek_lextent(500));
 }
 
+TEST(ExtentMap, flat_index)
+{
+  BlueStore store(g_ceph_context, "", 4096);
+  BlueStore::OnodeCacheShard *oc = BlueStore::OnodeCacheShard::create(
+    g_ceph_context, "lru", NULL);
+  BlueStore::BufferCacheShard *bc = BlueStore::BufferCacheShard::create(
+    g_ceph_context, "lru", NULL);
+
+  auto coll = ceph::make_ref<BlueStore::Collection>(&store, oc, bc, coll_t());
+  BlueStore::Onode onode(coll.get(), ghobject_t(), "");
+  BlueStore::ExtentMap em(&onode,
+    g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size,
+    4);
+  BlueStore::BlobRef br(new BlueStore::Blob);
+  br->shared_blob = new BlueStore::SharedBlob(coll.get());
+
+  auto check = [&]() {
+    for (uint64_t o = 0; o < 1000; o += 25) {
+      auto p = em.extent_map.begin();
+      while (p != em.extent_map.end() && p->logical_end() <= o) {
+	++p;
+      }
+      ASSERT_EQ(p, em.seek_lextent(o));
+    }
+  };
+
+  ASSERT_TRUE(em.flat_index_active);
+  check();
+  // out of order, with holes
+  for (uint32_t lo : {400, 100, 700, 200}) {
+    em.insert_extent(new BlueStore::Extent(lo, 0, 50, br));
+    ASSERT_TRUE(em.flat_index_active);
+    ASSERT_EQ(em.extent_map.size(), em.flat_index.size());
+    check();
+  }
+  // past the threshold the tree alone is used
+  em.insert_extent(new BlueStore::Extent(900, 0, 100, br));
+  ASSERT_FALSE(em.flat_index_active);
+  ASSERT_TRUE(em.flat_index.empty());
+  check();
+  em.rm(em.find(700));
+  em.rm(em.find(100));
+  ASSERT_FALSE(em.flat_index_active);
+  check();
+  // and the index comes back once the map is at half of it
+  em.rm(em.find(400));
+  ASSERT_TRUE(em.flat_index_active);
+  ASSERT_EQ(2u, em.flat_index.size());
+  check();
+  em.clear();
+  ASSERT_TRUE(em.flat_index_active);
+  ASSERT_TRUE(em.flat_index.empty());
+  ASSERT_EQ(em.extent_map.end(), em.seek_lextent(0));
+}
+
 TEST(ExtentMap, has_any_lextents)
 {
   BlueStore store(g_ceph_context, "", 4096);
@@ -1178,7 +1234,8 @@ TEST(ExtentMap, has_any_lextents)
   auto coll = ceph::make_ref<BlueStore::Collection>(&store, oc, bc, coll_t());
   BlueStore::Onode onode(coll.get(), ghobject_t(), "");
   BlueStore::ExtentMap em(&onode,
-    g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size);
+    g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size,
+    g_ceph_context->_conf->bluestore_extent_map_flat_index_max);
   BlueStore::BlobRef b(new BlueStore::Blob);
   b->shared_blob = new BlueStore::SharedBlob(coll.get());
 
@@ -1186,7 +1243,7 @@ TEST(ExtentMap, has_any_lextents)
   ASSERT_FALSE(em.has_any_lextents(0, 1000));
   ASSERT_FALSE(em.has_any_lextents(1000, 1000));
 
-  em.extent_map.insert(*new BlueStore::Extent(100, 0, 100, b));
+  em.insert_extent(new BlueStore::Extent(100, 0, 100, b));
   ASSERT_FALSE(em.has_any_lextents(0, 50));
   ASSERT_FALSE(em.has_any_lextents(0, 100));
   ASSERT_FALSE(em.has_any_lextents(50, 50));
@@ -1198,7 +1255,7 @@ TEST(ExtentMap, has_any_lextents)
   ASSERT_TRUE(em.has_any_lextents(199, 2));
   ASSERT_FALSE(em.has_any_lextents(200, 2));
 
-  em.extent_map.insert(*new BlueStore::Extent(200, 0, 100, b));
+  em.insert_extent(new BlueStore::Extent(200, 0, 100, b));
   ASSERT_TRUE(em.has_any_lextents(199, 1));
   ASSERT_TRUE(em.has_any_lextents(199, 2));
   ASSERT_TRUE(em.has_any_lextents(200, 2));
@@ -1206,7 +1263,7 @@ TEST(ExtentMap, has_any_lextents)
   ASSERT_TRUE(em.has_any_lextents(299, 1));
   ASSERT_FALSE(em.has_any_lextents(300, 1));
 
-  em.extent_map.insert(*new BlueStore::Extent(400, 0, 100, b));
+  em.insert_extent(new BlueStore::Extent(400, 0, 100, b));
   ASSERT_TRUE(em.has_any_lextents(0, 10000));
   ASSERT_TRUE(em.has_any_lextents(199, 1));
   ASSERT_FALSE(em.has_any_lextents(300, 1));
@@ -1223,8 +1280,7 @@ void erase_and_delete(BlueStore::ExtentMap& em, size_t v)
 {
   auto d = em.find(v);
   ASSERT_NE(d, em.extent_map.end());
-  em.extent_map.erase(d);
-  delete &*d;
+  em.rm(d);
 }
 
 TEST(ExtentMap, compress_extent_map)
@@ -1238,7 +1294,8 @@ TEST(ExtentMap, compress_extent_map)
   auto coll = ceph::make_ref<BlueStore::Collection>(&store, oc, bc, coll_t());
   BlueStore::Onode onode(coll.get(), ghobject_t(), "");
   BlueStore::ExtentMap em(&onode,
-    g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size);
+    g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size,
+    g_ceph_context->_conf->bluestore_extent_map_flat_index_max);
   BlueStore::BlobRef b1(new BlueStore::Blob);
   BlueStore::BlobRef b2(new BlueStore::Blob);
   BlueStore::BlobRef b3(new BlueStore::Blob);
@@ -1246,30 +1303,30 @@ TEST(ExtentMap, compress_extent_map)
   b2->shared_blob = new BlueStore::SharedBlob(coll.get());
   b3->shared_blob = new BlueStore::SharedBlob(coll.get());
 
-  em.extent_map.insert(*new BlueStore::Extent(0, 0, 100, b1));
-  em.extent_map.insert(*new BlueStore::Extent(100, 0, 100, b2));
+  em.insert_extent(new BlueStore::Extent(0, 0, 100, b1));
+  em.insert_extent(new BlueStore::Extent(100, 0, 100, b2));
   ASSERT_EQ(0, em.compress_extent_map(0, 10000));
   ASSERT_EQ(2u, em.extent_map.size());
 
-  em.extent_map.insert(*new BlueStore::Extent(200, 100, 100, b2));
-  em.extent_map.insert(*new BlueStore::Extent(300, 200, 100, b2));
+  em.insert_extent(new BlueStore::Extent(200, 100, 100, b2));
+  em.insert_extent(new BlueStore::Extent(300, 200, 100, b2));
   ASSERT_EQ(0, em.compress_extent_map(0, 0));
   ASSERT_EQ(0, em.compress_extent_map(100000, 1000));
   ASSERT_EQ(2, em.compress_extent_map(0, 100000));
   ASSERT_EQ(2u, em.extent_map.size());
   erase_and_delete(em, 100);
-  em.extent_map.insert(*new BlueStore::Extent(100, 0, 100, b2));
-  em.extent_map.insert(*new BlueStore::Extent(200, 100, 100, b3));
-  em.extent_map.insert(*new BlueStore::Extent(300, 200, 100, b2));
+  em.insert_extent(new BlueStore::Extent(100, 0, 100, b2));
+  em.insert_extent(new BlueStore::Extent(200, 100, 100, b3));
+  em.insert_extent(new BlueStore::Extent(300, 200, 100, b2));
   ASSERT_EQ(0, em.compress_extent_map(0, 1));
   ASSERT_EQ(0, em.compress_extent_map(0, 100000));
   ASSERT_EQ(4u, em.extent_map.size());
 
-  em.extent_map.insert(*new BlueStore::Extent(400, 300, 100, b2));
-  em.extent_map.insert(*new BlueStore::Extent(500, 500, 100, b2));
-  em.extent_map.insert(*new BlueStore::Extent(600, 600, 100, b2));
-  em.extent_map.insert(*new BlueStore::Extent(700, 0, 100, b1));
-  em.extent_map.insert(*new BlueStore::Extent(800, 0, 100, b3));
+  em.insert_extent(new BlueStore::Extent(400, 300, 100, b2));
+  em.insert_extent(new BlueStore::Extent(500, 500, 100, b2));
+  em.insert_extent(new BlueStore::Extent(600, 600, 100, b2));
+  em.insert_extent(new BlueStore::Extent(700, 0, 100, b1));
+  em.insert_extent(new BlueStore::Extent(800, 0, 100, b3));
   ASSERT_EQ(0, em.compress_extent_map(0, 99));
   ASSERT_EQ(0, em.compress_extent_map(800, 1000));
   ASSERT_EQ(2, em.compress_extent_map(100, 500));
@@ -1277,9 +1334,9 @@ TEST(ExtentMap, compress_extent_map)
   erase_and_delete(em, 300);
   erase_and_delete(em, 500);
   erase_and_delete(em, 700);
-  em.extent_map.insert(*new BlueStore::Extent(400, 300, 100, b2));
-  em.extent_map.insert(*new BlueStore::Extent(500, 400, 100, b2));
-  em.extent_map.insert(*new BlueStore::Extent(700, 500, 100, b2));
+  em.insert_extent(new BlueStore::Extent(400, 300, 100, b2));
+  em.insert_extent(new BlueStore::Extent(500, 400, 100, b2));
+  em.insert_extent(new BlueStore::Extent(700, 500, 100, b2));
   ASSERT_EQ(1, em.compress_extent_map(0, 1000));
   ASSERT_EQ(6u, em.extent_map.size());
 }
@@ -1306,7 +1363,8 @@ TEST(GarbageCollector, BasicTest)
   auto coll = ceph::make_ref<BlueStore::Collection>(&store, oc, bc, coll_t());
   BlueStore::Onode onode(coll.get(), ghobject_t(), "");
   BlueStore::ExtentMap em(&onode,
-    g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size);
+    g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size,
+    g_ceph_context->_conf->bluestore_extent_map_flat_index_max);
 
   BlueStore::old_extent_map_t old_extents;
 
@@ -1348,13 +1406,13 @@ TEST(GarbageCollector, BasicTest)
     b2->dirty_blob().allocated_test(bluestore_pextent_t(1, 0x1000));
     b3->dirty_blob().allocated_test(bluestore_pextent_t(2, 0x1000));
     b4->dirty_blob().allocated_test(bluestore_pextent_t(3, 0x1000));
-    em.extent_map.insert(*new BlueStore::Extent(100, 100, 10, b1));
+    em.insert_extent(new BlueStore::Extent(100, 100, 10, b1));
     b1->get_ref(coll.get(), 100, 10);
-    em.extent_map.insert(*new BlueStore::Extent(200, 200, 10, b2));
+    em.insert_extent(new BlueStore::Extent(200, 200, 10, b2));
     b2->get_ref(coll.get(), 200, 10);
-    em.extent_map.insert(*new BlueStore::Extent(300, 300, 100, b4));
+    em.insert_extent(new BlueStore::Extent(300, 300, 100, b4));
     b4->get_ref(coll.get(), 300, 100);
-    em.extent_map.insert(*new BlueStore::Extent(4096, 0, 10, b3));
+    em.insert_extent(new BlueStore::Extent(4096, 0, 10, b3));
     b3->get_ref(coll.get(), 0, 10);
 
     old_extents.push_back(*new BlueStore::OldExtent(300, 300, 10, b1)); 
@@ -1396,7 +1454,8 @@ TEST(GarbageCollector, BasicTest)
     auto coll = ceph::make_ref<BlueStore::Collection>(&store, oc, bc, coll_t());
     BlueStore::Onode onode(coll.get(), ghobject_t(), "");
     BlueStore::ExtentMap em(&onode,
-      g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size);
+      g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size,
+      g_ceph_context->_conf->bluestore_extent_map_flat_index_max);
 
     BlueStore::old_extent_map_t old_extents;
     BlueStore::GarbageCollector gc(g_ceph_context);
@@ -1415,18 +1474,18 @@ TEST(GarbageCollector, BasicTest)
     b3->dirty_blob().allocated_test(bluestore_pextent_t(2, 0x20000));
     b4->dirty_blob().allocated_test(bluestore_pextent_t(3, 0x10000));
 
-    em.extent_map.insert(*new BlueStore::Extent(0, 0, 0x8000, b1));
+    em.insert_extent(new BlueStore::Extent(0, 0, 0x8000, b1));
     b1->get_ref(coll.get(), 0, 0x8000);
-    em.extent_map.insert(
-      *new BlueStore::Extent(0x8000, 0x8000, 0x8000, b2)); // new extent
+    em.insert_extent(
+      new BlueStore::Extent(0x8000, 0x8000, 0x8000, b2)); // new extent
     b2->get_ref(coll.get(), 0x8000, 0x8000);
-    em.extent_map.insert(
-      *new BlueStore::Extent(0x10000, 0, 0x20000, b3)); // new extent
+    em.insert_extent(
+      new BlueStore::Extent(0x10000, 0, 0x20000, b3)); // new extent
     b3->get_ref(coll.get(), 0, 0x20000);
-    em.extent_map.insert(
-      *new BlueStore::Extent(0x30000, 0, 0xf000, b4)); // new extent
+    em.insert_extent(
+      new BlueStore::Extent(0x30000, 0, 0xf000, b4)); // new extent
     b4->get_ref(coll.get(), 0, 0xf000);
-    em.extent_map.insert(*new BlueStore::Extent(0x3f000, 0x3f000, 0x1000, b1));
+    em.insert_extent(new BlueStore::Extent(0x3f000, 0x3f000, 0x1000, b1));
     b1->get_ref(coll.get(), 0x3f000, 0x1000);
 
     old_extents.push_back(*new BlueStore::OldExtent(0x8000, 0x8000, 0x8000, b1)); 
@@ -1483,10 +1542,10 @@ TEST(GarbageCollector, BasicTest)
     b2->dirty_blob().set_compressed(0x4000, 0x2000);
     b2->dirty_blob().allocated_test(bluestore_pextent_t(0, 0x2000));
 
-    em.extent_map.insert(*new BlueStore::Extent(0, 0, 0x3000, b1));
+    em.insert_extent(new BlueStore::Extent(0, 0, 0x3000, b1));
     b1->get_ref(coll.get(), 0, 0x3000);
-    em.extent_map.insert(
-      *new BlueStore::Extent(0x3000, 0, 0x4000, b2)); // new extent
+    em.insert_extent(
+      new BlueStore::Extent(0x3000, 0, 0x4000, b2)); // new extent
     b2->get_ref(coll.get(), 0, 0x4000);
 
     old_extents.push_back(*new BlueStore::OldExtent(0x3000, 0x3000, 0x1000, b1)); 
@@ -1524,7 +1583,8 @@ TEST(GarbageCollector, BasicTest)
     auto coll = ceph::make_ref<BlueStore::Collection>(&store, oc, bc, coll_t());
     BlueStore::Onode onode(coll.get(), ghobject_t(), "");
     BlueStore::ExtentMap em(&onode,
-      g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size);
+      g_ceph_context->_conf->bluestore_extent_map_inline_shard_prealloc_size,
+      g_ceph_context->_conf->bluestore_extent_map_flat_index_max);
 
     BlueStore::old_extent_map_t old_extents;
     BlueStore::GarbageCollector gc(g_ceph_context);
@@ -1547,18 +1607,18 @@ TEST(GarbageCollector, BasicTest)
     b3->dirty_blob().allocated_test(bluestore_pextent_t(2, 0x20000));
     b4->dirty_blob().allocated_test(bluestore_pextent_t(3, 0x1000));
 
-    em.extent_map.insert(*new BlueStore::Extent(0, 0, 0x8000, b0));
+    em.insert_extent(new BlueStore::Extent(0, 0, 0x8000, b0));
     b0->get_ref(coll.get(), 0, 0x8000);
-    em.extent_map.insert(
-      *new BlueStore::Extent(0x8000, 0x8000, 0x8000, b2)); // new extent
+    em.insert_extent(
+      new BlueStore::Extent(0x8000, 0x8000, 0x8000, b2)); // new extent
     b2->get_ref(coll.get(), 0x8000, 0x8000);
-    em.extent_map.insert(
-      *new BlueStore::Extent(0x10000, 0, 0x20000, b3)); // new extent
+    em.insert_extent(
+      new BlueStore::Extent(0x10000, 0, 0x20000, b3)); // new extent
     b3->get_ref(coll.get(), 0, 0x20000);
-    em.extent_map.insert(
-      *new BlueStore::Extent(0x30000, 0, 0xf000, b4)); // new extent
+    em.insert_extent(
+      new BlueStore::Extent(0x30000, 0, 0xf000, b4)); // new extent
     b4->get_ref(coll.get(), 0, 0xf000);
-    em.extent_map.insert(*new BlueStore::Extent(0x3f000, 0x1f000, 0x1000, b1));
+    em.insert_extent(new BlueStore::Extent(0x3f000, 0x1f000, 0x1000, b1));
     b1->get_ref(coll.get(), 0x1f000, 0x1000);
 
     old_extents.push_back(*new BlueStore::OldExtent(0x8000, 0x8000, 0x8000, b0)); 
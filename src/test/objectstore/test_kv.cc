@@ -351,6 +351,45 @@ TEST_P(KVTest, ShardingRMRange) {
 }
 
 
+TEST_P(KVTest, MultiGet) {
+  if(string(GetParam()) != "rocksdb")
+    return;
+  std::string cfs("O(7)=");
+  ASSERT_EQ(0, db->create_and_open(cout, cfs));
+  {
+    KeyValueDB::Transaction t = db->get_transaction();
+    for (size_t i = 0; i < 100; i += 2) {
+      bufferlist value;
+      char* a;
+      ASSERT_EQ(asprintf(&a, "key%3.3ld", i), 6);
+      value.append(a);
+      t->set("O", a, value);
+      t->set("P", a, value);
+      free(a);
+    }
+    db->submit_transaction_sync(t);
+  }
+
+  for (auto prefix : {"O", "P"}) {
+    std::set<std::string> keys;
+    for (size_t i = 0; i < 100; i++) {
+      char* a;
+      ASSERT_EQ(asprintf(&a, "key%3.3ld", i), 6);
+      keys.insert(a);
+      free(a);
+    }
+    std::map<std::string, bufferlist> out;
+    ASSERT_EQ(0, db->get(prefix, keys, &out));
+    ASSERT_EQ(50u, out.size());
+    for (auto& [k, v] : out) {
+      ASSERT_EQ(0, (atoi(k.c_str() + 3) % 2));
+      ASSERT_EQ(k, v.to_str());
+    }
+  }
+
+  fini();
+}
+
 TEST_P(KVTest, RocksDBColumnFamilyTest) {
   if(string(GetParam()) != "rocksdb")
     return;
@@ -139,6 +139,69 @@ TEST(Transaction, MoveRangesDelSrcObj)
   t.write(c, o2, 1, bl.length(), bl);
 }
 
+TEST(Transaction, WriteMove)
+{
+  coll_t c(spg_t(pg_t(1,2), shard_id_t::NO_SHARD));
+  ghobject_t o1(hobject_t("obj", "", 123, 456, -1, ""));
+  bufferlist bl;
+  bl.append("some data");
+
+  auto a = ObjectStore::Transaction{};
+  a.write(c, o1, 1, bl.length(), bl, 0);
+  auto b = ObjectStore::Transaction{};
+  bufferlist moved = bl;
+  b.write(c, o1, 1, moved.length(), std::move(moved), 0);
+  ASSERT_EQ(0u, moved.length());
+
+  bufferlist abl, bbl;
+  a.encode(abl);
+  b.encode(bbl);
+  ASSERT_TRUE(abl.contents_equal(bbl));
+  ASSERT_EQ(a.get_data_alignment(), b.get_data_alignment());
+}
+
+TEST(Transaction, AppendMove)
+{
+  coll_t c(spg_t(pg_t(1,2), shard_id_t::NO_SHARD));
+  ghobject_t o1(hobject_t("obj", "", 123, 456, -1, ""));
+  ghobject_t o2(hobject_t("obj2", "", 123, 456, -1, ""));
+  bufferlist bl;
+  bl.append("some data");
+
+  auto make = [&](const ghobject_t& o) {
+    auto t = ObjectStore::Transaction{};
+    t.touch(c, o);
+    t.write(c, o, 0, bl.length(), bl);
+    return t;
+  };
+
+  // into an empty transaction
+  {
+    auto a = ObjectStore::Transaction{};
+    auto other = make(o1);
+    a.append(other);
+    auto b = ObjectStore::Transaction{};
+    b.append(make(o1));
+    bufferlist abl, bbl;
+    a.encode(abl);
+    b.encode(bbl);
+    ASSERT_TRUE(abl.contents_equal(bbl));
+  }
+  // into a non-empty one, ids are renumbered
+  {
+    auto a = make(o2);
+    auto other = make(o1);
+    a.append(other);
+    auto b = make(o2);
+    b.append(make(o1));
+    bufferlist abl, bbl;
+    a.encode(abl);
+    b.encode(bbl);
+    ASSERT_TRUE(abl.contents_equal(bbl));
+    ASSERT_EQ(4, b.get_num_ops());
+  }
+}
+
 TEST(Transaction, GetNumBytes)
 {
   auto a = ObjectStore::Transaction{};
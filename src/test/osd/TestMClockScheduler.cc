@@ -7,7 +7,9 @@
 #include "global/global_context.h"
 #include "global/global_init.h"
 #include "common/common_init.h"
+#include "common/ceph_json.h"
 
+#include "osd/OSDMap.h"
 #include "osd/scheduler/mClockScheduler.h"
 #include "osd/scheduler/OpSchedulerItem.h"
 
@@ -53,8 +55,9 @@ public:
   struct MockDmclockItem : public PGOpQueueable {
     op_scheduler_class scheduler_class;
 
-    MockDmclockItem(op_scheduler_class _scheduler_class) :
-      PGOpQueueable(spg_t()),
+    MockDmclockItem(op_scheduler_class _scheduler_class,
+		    spg_t pgid = spg_t()) :
+      PGOpQueueable(pgid),
       scheduler_class(_scheduler_class) {}
 
     MockDmclockItem()
@@ -175,3 +178,96 @@ TEST_F(mClockSchedulerTest, TestMultiClientOrderedEnqueueDequeue) {
   }
   ASSERT_TRUE(q.empty());
 }
+
+TEST_F(mClockSchedulerTest, TestCostCalibration) {
+  auto& conf = g_ceph_context->_conf;
+  conf.set_val_or_die("osd_mclock_cost_auto_calibrate", "true");
+  conf.set_val_or_die("osd_mclock_cost_calibration_samples", "100");
+  conf.apply_changes(nullptr);
+
+  // service time of 100us per op plus 0.01us per byte
+  const uint64_t sizes[] = {4096, 65536, 1 << 20};
+  for (unsigned i = 0; i < 300; ++i) {
+    uint64_t cost = sizes[i % 3];
+    q.note_service_time(
+      cost,
+      std::chrono::nanoseconds(100000 + cost * 10 / 1000));
+  }
+  // picked up on the next enqueue
+  q.enqueue(create_item(100, client1, op_scheduler_class::client));
+
+  JSONFormatter f;
+  f.open_object_section("q");
+  q.dump(f);
+  f.close_section();
+  std::stringstream ss;
+  f.flush(ss);
+  JSONParser parser;
+  ASSERT_TRUE(parser.parse(ss.str().c_str(), ss.str().length()));
+  JSONObj *model = parser.find_obj("cost_model");
+  ASSERT_TRUE(model);
+  // not rotational, so in milliseconds
+  double per_io = std::stod(
+    model->find_obj("osd_mclock_cost_per_io")->get_data());
+  double per_byte = std::stod(
+    model->find_obj("osd_mclock_cost_per_byte")->get_data());
+  ASSERT_NEAR(0.1, per_io, 0.01);
+  ASSERT_NEAR(0.00001, per_byte, 0.000001);
+
+  conf.set_val_or_die("osd_mclock_cost_auto_calibrate", "false");
+  conf.set_val_or_die("osd_mclock_cost_calibration_samples", "1000");
+  conf.apply_changes(nullptr);
+}
+
+TEST_F(mClockSchedulerTest, TestPoolQoS) {
+  OSDMap osdmap;
+  uuid_d fsid;
+  osdmap.build_simple(g_ceph_context, 0, fsid, 1);
+  OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+  inc.fsid = fsid;
+  inc.new_pool_max = osdmap.get_pool_max();
+  pg_pool_t empty;
+  for (int64_t pool : {1, 2}) {
+    pg_pool_t *p = inc.get_new_pool(pool, &empty);
+    p->size = 1;
+    p->set_pg_num(8);
+    p->set_pgp_num(8);
+    p->type = pg_pool_t::TYPE_REPLICATED;
+    inc.new_pool_names[pool] = "pool" + std::to_string(pool);
+  }
+  inc.new_pool_max = 2;
+  inc.new_pools[2].opts.set(pool_opts_t::MCLOCK_WGT, static_cast<int64_t>(5));
+  osdmap.apply_incremental(inc);
+  q.consume_map(osdmap);
+
+  auto client_count = [this] {
+    JSONFormatter f;
+    f.open_object_section("q");
+    q.dump(f);
+    f.close_section();
+    std::stringstream ss;
+    f.flush(ss);
+    JSONParser parser;
+    ceph_assert(parser.parse(ss.str().c_str(), ss.str().length()));
+    return std::stoi(
+      parser.find_obj("mClockClients")->find_obj("client_count")->get_data());
+  };
+
+  // clients of pool 1 are tracked separately, those of pool 2 together
+  for (auto &&c : {client1, client2, client3}) {
+    q.enqueue(create_item(100, c, op_scheduler_class::client,
+			  spg_t(pg_t(0, 1))));
+  }
+  ASSERT_EQ(3, client_count());
+  for (auto &&c : {client1, client2, client3}) {
+    q.enqueue(create_item(100, c, op_scheduler_class::client,
+			  spg_t(pg_t(0, 2))));
+  }
+  ASSERT_EQ(4, client_count());
+
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_FALSE(q.empty());
+    q.dequeue();
+  }
+  ASSERT_TRUE(q.empty());
+}
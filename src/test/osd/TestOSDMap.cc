@@ -2443,6 +2443,101 @@ TEST_F(OSDMapTest, ReadBalanceScore2) {
 
   }
 
+TEST_F(OSDMapTest, IncrementalMapping) {
+  set_up_map(12);
+  ThreadPool tp(g_ceph_context, "IncrementalMapping", "tp_mapping", 4);
+  tp.start();
+  ParallelPGMapper mapper(g_ceph_context, &tp);
+
+  auto check = [&]() {
+    for (auto& [poolid, pool] : osdmap.get_pools()) {
+      for (unsigned ps = 0; ps < pool.get_pg_num(); ++ps) {
+	pg_t pgid(ps, poolid);
+	vector<int> up, acting, up2, acting2;
+	int up_primary, acting_primary, up_primary2, acting_primary2;
+	osdmap.pg_to_up_acting_osds(pgid, &up, &up_primary,
+				    &acting, &acting_primary);
+	mapping.get(pgid, &up2, &up_primary2, &acting2, &acting_primary2);
+	ASSERT_EQ(up, up2) << pgid;
+	ASSERT_EQ(up_primary, up_primary2) << pgid;
+	ASSERT_EQ(acting, acting2) << pgid;
+	ASSERT_EQ(acting_primary, acting_primary2) << pgid;
+      }
+    }
+    ASSERT_EQ(osdmap.get_epoch(), mapping.get_epoch());
+  };
+  auto apply = [&](OSDMap::Incremental& inc) {
+    ASSERT_EQ(0, osdmap.apply_incremental(inc));
+    auto job = mapping.start_update(osdmap, mapper, 16, &inc);
+    job->wait();
+  };
+
+  mapping.start_update(osdmap, mapper, 16)->wait();
+  check();
+
+  pg_t rep_pg(3, my_rep_pool), ec_pg(5, my_ec_pool);
+  {
+    // pg_temp and primary_temp
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_pg_temp[rep_pg] = {7, 8, 9};
+    inc.new_primary_temp[ec_pg] = 4;
+    apply(inc);
+    check();
+  }
+  {
+    // an osd going down, and another's primary affinity
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_state[8] = CEPH_OSD_UP;
+    inc.new_primary_affinity[2] = CEPH_OSD_MAX_PRIMARY_AFFINITY / 2;
+    apply(inc);
+    check();
+  }
+  {
+    // upmaps
+    vector<int> up;
+    int up_primary;
+    osdmap.pg_to_raw_up(rep_pg, &up, &up_primary);
+    int to = 0;
+    while (std::find(up.begin(), up.end(), to) != up.end() ||
+	   osdmap.is_down(to)) {
+      ++to;
+    }
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_pg_temp[rep_pg] = {};
+    inc.new_pg_upmap_items[rep_pg] =
+      mempool::osdmap::vector<pair<int32_t,int32_t>>({{up[0], to}});
+    apply(inc);
+    check();
+  }
+  {
+    // a pool change
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.get_new_pool(my_rep_pool, osdmap.get_pg_pool(my_rep_pool))->size = 2;
+    apply(inc);
+    check();
+  }
+  {
+    // the osd coming back up cannot be narrowed down and remaps everything
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    entity_addrvec_t addrs;
+    addrs.v.push_back(entity_addr_t());
+    inc.new_up_client[8] = addrs;
+    inc.new_up_cluster[8] = addrs;
+    inc.new_hb_back_up[8] = addrs;
+    inc.new_hb_front_up[8] = addrs;
+    apply(inc);
+    check();
+  }
+  {
+    // nothing that affects placement
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_up_thru[1] = osdmap.get_epoch();
+    apply(inc);
+    check();
+  }
+  tp.stop();
+}
+
 INSTANTIATE_TEST_SUITE_P(
   OSDMap,
   OSDMapTest,
@@ -2459,12 +2459,16 @@ public:
     }
   }
 
-  void test_disk_roundtrip() {
-    ObjectStore::Transaction t;
+  static ghobject_t get_log_oid() {
     hobject_t hoid;
     hoid.pool = 1;
     hoid.oid = "log";
-    ghobject_t log_oid(hoid);
+    return ghobject_t(hoid);
+  }
+
+  void write_to_disk() {
+    ObjectStore::Transaction t;
+    ghobject_t log_oid = get_log_oid();
     map<string, bufferlist> km;
     write_log_and_missing(t, &km, test_coll, log_oid, false);
     if (!km.empty()) {
@@ -2472,12 +2476,20 @@ public:
     }
     auto ch = store->open_collection(test_coll);
     ASSERT_EQ(0, store->queue_transaction(ch, std::move(t)));
+  }
 
-    auto orig_dups = log.dups;
+  void read_from_disk() {
     clear();
+    auto ch = store->open_collection(test_coll);
     ostringstream err;
-    read_log_and_missing(store.get(), ch, log_oid,
+    read_log_and_missing(store.get(), ch, get_log_oid(),
 			 pg_info_t(), err, false);
+  }
+
+  void test_disk_roundtrip() {
+    write_to_disk();
+    auto orig_dups = log.dups;
+    read_from_disk();
     ASSERT_EQ(orig_dups.size(), log.dups.size());
     ASSERT_EQ(orig_dups, log.dups);
     auto dups_it = log.dups.begin();
@@ -2673,6 +2685,28 @@ TEST_F(PGLogMergeDupsTest, Superset) {
   check_index();
 }
 
+TEST_F(PGLogMergeDupsTest, ReadSkipsUntrackedDups) {
+  const auto dups_tracked = g_ceph_context->_conf->osd_pg_log_dups_tracked;
+
+  add_dups(example_dups_1());
+  index();
+  write_to_disk();
+
+  g_ceph_context->_conf.set_val_or_die("osd_pg_log_dups_tracked", "3");
+  read_from_disk();
+  EXPECT_EQ(3u, log.dups.size());
+  EXPECT_EQ(eversion_t(11, 1), log.dups.front().version);
+  EXPECT_EQ(eversion_t(13, 99), log.dups.back().version);
+  check_index();
+
+  // the next write removes the keys of the dups that were not loaded
+  write_to_disk();
+  g_ceph_context->_conf.set_val_or_die("osd_pg_log_dups_tracked",
+				       std::to_string(dups_tracked));
+  read_from_disk();
+  EXPECT_EQ(3u, log.dups.size());
+  EXPECT_EQ(eversion_t(11, 1), log.dups.front().version);
+}
 
 struct PGLogTrimTest :
   public ::testing::Test,
@@ -255,3 +255,63 @@ TEST(PerfCounters, read_avg) {
   t2.join();
   t1.join();
 }
+
+TEST(PerfCounters, read_avg_sharded) {
+  g_ceph_context->_conf.set_val("perf_counters_shards", "4");
+  std::shared_ptr<PerfCounters> fake_pf = setup_test_perfcounter3(g_ceph_context);
+  g_ceph_context->_conf.set_val("perf_counters_shards", "0");
+
+  std::thread t1(counters_inc_test, fake_pf);
+  std::thread t2(counters_inc_test, fake_pf);
+  std::thread t3(counters_readavg_test, fake_pf);
+  t3.join();
+  t2.join();
+  t1.join();
+
+  auto dat = fake_pf->get_tavg_ns(TEST_PERFCOUNTERS3_ELEMENT_READ);
+  ASSERT_EQ(200000u, dat.first);
+  ASSERT_EQ(200000u, dat.second);
+  fake_pf->reset();
+  dat = fake_pf->get_tavg_ns(TEST_PERFCOUNTERS3_ELEMENT_READ);
+  ASSERT_EQ(0u, dat.first);
+  ASSERT_EQ(0u, dat.second);
+}
+
+enum {
+  TEST_PERFCOUNTERS4_ELEMENT_FIRST = 500,
+  TEST_PERFCOUNTERS4_ELEMENT_COUNTER,
+  TEST_PERFCOUNTERS4_ELEMENT_GAUGE,
+  TEST_PERFCOUNTERS4_ELEMENT_LAST,
+};
+
+TEST(PerfCounters, ShardedCounters) {
+  g_ceph_context->_conf.set_val("perf_counters_shards", "3");
+  PerfCountersBuilder bld(g_ceph_context, "test_perfcounter_4",
+      TEST_PERFCOUNTERS4_ELEMENT_FIRST, TEST_PERFCOUNTERS4_ELEMENT_LAST);
+  bld.add_u64_counter(TEST_PERFCOUNTERS4_ELEMENT_COUNTER, "counter");
+  bld.add_u64(TEST_PERFCOUNTERS4_ELEMENT_GAUGE, "gauge");
+  std::unique_ptr<PerfCounters> fake_pf(bld.create_perf_counters());
+  g_ceph_context->_conf.set_val("perf_counters_shards", "0");
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 5; ++t) {
+    threads.emplace_back([&fake_pf] {
+      for (int i = 0; i < 1000; ++i) {
+	fake_pf->inc(TEST_PERFCOUNTERS4_ELEMENT_COUNTER, 2);
+	fake_pf->dec(TEST_PERFCOUNTERS4_ELEMENT_COUNTER);
+	fake_pf->inc(TEST_PERFCOUNTERS4_ELEMENT_GAUGE);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(5000u, fake_pf->get(TEST_PERFCOUNTERS4_ELEMENT_COUNTER));
+  ASSERT_EQ(5000u, fake_pf->get(TEST_PERFCOUNTERS4_ELEMENT_GAUGE));
+
+  // set replaces whatever the shards had accumulated
+  fake_pf->set(TEST_PERFCOUNTERS4_ELEMENT_COUNTER, 7);
+  ASSERT_EQ(7u, fake_pf->get(TEST_PERFCOUNTERS4_ELEMENT_COUNTER));
+  fake_pf->reset();
+  ASSERT_EQ(0u, fake_pf->get(TEST_PERFCOUNTERS4_ELEMENT_COUNTER));
+}
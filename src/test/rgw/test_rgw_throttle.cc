@@ -16,6 +16,7 @@
 
 #include <optional>
 #include <thread>
+#include <vector>
 #include "include/scope_guard.h"
 
 #include <spawn/spawn.hpp>
@@ -118,6 +119,28 @@ TEST_F(Aio_Throttle, NoThrottleUpToMax)
   }
 }
 
+TEST_F(Aio_Throttle, GrowWindowUpToMax)
+{
+  BlockingAioThrottle throttle(2, 8);
+  auto obj = make_obj(__PRETTY_FUNCTION__);
+  {
+    // none of the ops complete, so the window has to grow from 2 to 8
+    // for them to be issued without waiting
+    std::vector<scoped_completion> ops(8);
+    for (auto& op : ops) {
+      auto c = throttle.get(obj, wait_on(op), 1, 0);
+      EXPECT_TRUE(c.empty());
+    }
+    auto c = throttle.poll();
+    EXPECT_TRUE(c.empty());
+  }
+  auto completions = throttle.drain();
+  ASSERT_EQ(8u, completions.size());
+  for (auto& c : completions) {
+    EXPECT_EQ(-ECANCELED, c.result);
+  }
+}
+
 TEST_F(Aio_Throttle, CostOverWindow)
 {
   BlockingAioThrottle throttle(4);
@@ -207,6 +207,63 @@ TEST(mempool, test_factory)
    check_usage(mempool::osdmap::id);
 }
 
+struct slab_obj {
+  MEMPOOL_CLASS_HELPERS();
+  uint64_t a;
+  char pad[200];
+  explicit slab_obj(uint64_t _a) : a(_a) {}
+};
+MEMPOOL_DEFINE_OBJECT_SLAB_FACTORY(slab_obj, slab_obj, unittest_1);
+
+TEST(mempool, test_slab_factory)
+{
+  auto& slab_alloc = mempool::unittest_1::slab_alloc_slab_obj;
+  const size_t per_slab = mempool::slab_allocator<
+    mempool::unittest_1::id, slab_obj>::items_per_slab;
+  size_t items = mempool::unittest_1::allocated_items();
+  size_t bytes = mempool::unittest_1::allocated_bytes();
+  size_t slabs = slab_alloc.get_num_slabs();
+  // what the pool should show for the slabs allocated right now
+  auto slab_bytes = [&] {
+    return bytes + slab_alloc.get_num_slabs() * 64 * 1024 - slabs * 64 * 1024;
+  };
+
+  std::vector<slab_obj*> v;
+  for (uint64_t i = 0; i < per_slab * 3 + 1; ++i) {
+    v.push_back(new slab_obj(i));
+  }
+  ASSERT_EQ(items + v.size(), mempool::unittest_1::allocated_items());
+  // bytes are those of the slabs, headers and free room included
+  ASSERT_LE(slabs + 4, slab_alloc.get_num_slabs());
+  ASSERT_EQ(slab_bytes(), mempool::unittest_1::allocated_bytes());
+  ASSERT_LE(bytes + v.size() * sizeof(slab_obj),
+	    mempool::unittest_1::allocated_bytes());
+  for (uint64_t i = 0; i < v.size(); ++i) {
+    ASSERT_EQ(i, v[i]->a);
+  }
+
+  // free every other object, then reuse the holes
+  for (size_t i = 0; i < v.size(); i += 2) {
+    delete v[i];
+    v[i] = nullptr;
+  }
+  // the trailing slab held a single object and is gone by now, its
+  // object needs at most one new slab
+  size_t slabs_before_reuse = slab_alloc.get_num_slabs();
+  for (size_t i = 0; i < v.size(); i += 2) {
+    v[i] = new slab_obj(i);
+  }
+  ASSERT_GE(slabs_before_reuse + 1, slab_alloc.get_num_slabs());
+
+  for (auto o : v) {
+    delete o;
+  }
+  ASSERT_EQ(items, mempool::unittest_1::allocated_items());
+  // at most one empty slab is cached per arena, and it stays accounted
+  ASSERT_GE(slabs + 1, slab_alloc.get_num_slabs());
+  ASSERT_EQ(slab_bytes(), mempool::unittest_1::allocated_bytes());
+}
+
 TEST(mempool, vector)
 {
   {
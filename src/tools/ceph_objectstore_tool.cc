@@ -823,13 +823,14 @@ void get_omap_batch(ObjectMap::ObjectMapIterator &iter, map<string, bufferlist>
   }
 }
 
-int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj)
+int ObjectStoreTool::export_file(ObjectStore *store,
+				 ObjectStore::CollectionHandle &ch,
+				 ghobject_t &obj, uint64_t *data_bytes)
 {
   struct stat st;
   mysize_t total;
   footer ft;
 
-  auto ch = store->open_collection(cid);
   int ret = store->stat(ch, obj, &st);
   if (ret < 0)
     return ret;
@@ -837,6 +838,8 @@ int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj
   cerr << "Read " << obj << std::endl;
 
   total = st.st_size;
+  if (data_bytes)
+    *data_bytes = total;
   if (debug)
     cerr << "size=" << total << std::endl;
 
@@ -947,6 +950,15 @@ int ObjectStoreTool::export_files(ObjectStore *store, coll_t coll)
 {
   ghobject_t next;
   auto ch = store->open_collection(coll);
+  uint64_t num_objects = 0, num_bytes = 0;
+  auto start = ceph::mono_clock::now();
+  auto report = [&](const char *what) {
+    double secs = std::chrono::duration<double>(
+      ceph::mono_clock::now() - start).count();
+    cerr << what << " " << num_objects << " objects, "
+	 << byte_u_t(num_bytes) << " in " << secs << "s ("
+	 << byte_u_t(secs > 0 ? num_bytes / secs : 0) << "/s)" << std::endl;
+  };
   while (!next.is_max()) {
     vector<ghobject_t> objects;
     int r = store->collection_list(ch, next, ghobject_t::get_max(), 300,
@@ -960,11 +972,17 @@ int ObjectStoreTool::export_files(ObjectStore *store, coll_t coll)
       if (i->is_pgmeta() || i->hobj.is_temp() || !i->is_no_gen()) {
 	continue;
       }
-      r = export_file(store, coll, *i);
+      uint64_t bytes = 0;
+      r = export_file(store, ch, *i, &bytes);
       if (r < 0)
         return r;
+      ++num_objects;
+      num_bytes += bytes;
+      if (num_objects % 1000 == 0)
+	report("Exported");
     }
   }
+  report("Export of object data done:");
   return 0;
 }
 
@@ -37,7 +37,8 @@ class ObjectStoreTool : public RadosDump
       ObjectStore *store, OSDriver& driver, SnapMapper& mapper, coll_t coll,
       bufferlist &bl, OSDMap &curmap, bool *skipped_objects);
     int export_file(
-        ObjectStore *store, coll_t cid, ghobject_t &obj);
+        ObjectStore *store, ObjectStore::CollectionHandle &ch, ghobject_t &obj,
+        uint64_t *data_bytes = nullptr);
     int export_files(ObjectStore *store, coll_t coll);
 };
 
@@ -915,6 +915,32 @@ int PeerReplayer::should_sync_entry(const std::string &epath, const struct ceph_
   return 0;
 }
 
+// a directory whose recursive ctime is the same in both snapshots has had
+// nothing below it created, modified, renamed or removed in between
+bool PeerReplayer::is_subtree_unchanged(const std::string &dir_root, const Snapshot &current,
+                                        const Snapshot &prev, const std::string &epath) {
+  char cur_rctime[64];
+  char prev_rctime[64];
+  auto cur_path = entry_path(snapshot_path(m_cct, dir_root, current.first), epath);
+  int r = ceph_lgetxattr(m_local_mount, cur_path.c_str(), "ceph.dir.rctime",
+                         cur_rctime, sizeof(cur_rctime));
+  if (r <= 0) {
+    return false;
+  }
+  size_t cur_len = r;
+
+  auto prev_path = entry_path(snapshot_path(m_cct, dir_root, prev.first), epath);
+  r = ceph_lgetxattr(m_local_mount, prev_path.c_str(), "ceph.dir.rctime",
+                     prev_rctime, sizeof(prev_rctime));
+  if (r <= 0) {
+    return false;
+  }
+
+  bool unchanged = (size_t)r == cur_len && memcmp(cur_rctime, prev_rctime, cur_len) == 0;
+  dout(20) << ": epath=" << epath << ", unchanged=" << unchanged << dendl;
+  return unchanged;
+}
+
 int PeerReplayer::propagate_deleted_entries(const std::string &dir_root,
                                             const std::string &epath, const FHandles &fh) {
   dout(10) << ": dir_root=" << dir_root << ", epath=" << epath << dendl;
@@ -1185,6 +1211,11 @@ int PeerReplayer::do_synchronize(const std::string &dir_root, const Snapshot &cu
     return r;
   }
 
+  // subtree pruning compares against the previous local snapshot, so it is
+  // only possible for an incremental sync
+  bool prune_unchanged = prev && fh.p_mnt == m_local_mount &&
+    g_ceph_context->_conf.get_val<bool>("cephfs_mirror_prune_unchanged_subtrees");
+
   std::stack<SyncEntry> sync_stack;
   sync_stack.emplace(SyncEntry(".", tdirp, tstx));
   while (!sync_stack.empty()) {
@@ -1249,6 +1280,10 @@ int PeerReplayer::do_synchronize(const std::string &dir_root, const Snapshot &cu
         if (r < 0) {
           break;
         }
+        if (prune_unchanged && is_subtree_unchanged(dir_root, current, *prev, epath)) {
+          dout(10) << ": skipping unchanged subtree=" << epath << dendl;
+          continue;
+        }
         ceph_dir_result *dirp;
         r = opendirat(m_local_mount, fh.c_fd, epath, AT_SYMLINK_NOFOLLOW, &dirp);
         if (r < 0) {
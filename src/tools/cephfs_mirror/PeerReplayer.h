@@ -293,6 +293,8 @@ private:
 
   int should_sync_entry(const std::string &epath, const struct ceph_statx &cstx,
                         const FHandles &fh, bool *need_data_sync, bool *need_attr_sync);
+  bool is_subtree_unchanged(const std::string &dir_root, const Snapshot &current,
+                            const Snapshot &prev, const std::string &epath);
 
   int open_dir(MountRef mnt, const std::string &dir_path, boost::optional<uint64_t> snap_id);
   int pre_sync_check_and_open_handles(const std::string &dir_root, const Snapshot &current,
@@ -100,6 +100,7 @@ struct Config {
   int max_part = 255;
   int io_timeout = -1;
   int reattach_timeout = 30;
+  int num_connections = 1;
 
   bool exclusive = false;
   bool notrim = false;
@@ -157,6 +158,9 @@ static void usage()
             << "  --encryption-passphrase-file  Path of file containing passphrase for unlocking image encryption\n"
             << "  --exclusive                   Forbid writes by other clients\n"
             << "  --notrim                      Turn off trim/discard\n"
+            << "  --num-connections <num>       Number of nbd sockets, each served by\n"
+            << "                                its own threads (requires netlink)\n"
+            << "                                (default: " << Config().num_connections << ")\n"
             << "  --io-timeout <sec>            Set nbd IO timeout\n"
             << "  --max_part <limit>            Override for module param max_part\n"
             << "  --nbds_max <limit>            Override for module param nbds_max\n"
@@ -208,19 +212,23 @@ public:
   uint64_t quiesce_watch_handle = 0;
 
 private:
-  int fd;
+  struct Connection;
+
   librbd::Image &image;
   Config *cfg;
+  std::vector<std::unique_ptr<Connection>> connections;
 
 public:
-  NBDServer(int fd, librbd::Image& image, Config *cfg)
-    : fd(fd)
-    , image(image)
+  NBDServer(const std::vector<int>& fds, librbd::Image& image, Config *cfg)
+    : image(image)
     , cfg(cfg)
-    , reader_thread(*this, &NBDServer::reader_entry)
-    , writer_thread(*this, &NBDServer::writer_entry)
     , quiesce_thread(*this, &NBDServer::quiesce_entry)
   {
+    connections.reserve(fds.size());
+    for (auto fd : fds) {
+      connections.emplace_back(std::make_unique<Connection>(*this, fd));
+    }
+
     std::vector<librbd::config_option_t> options;
     image.config_list(&options);
     for (auto &option : options) {
@@ -248,7 +256,7 @@ private:
   struct IOContext
   {
     xlist<IOContext*>::item item;
-    NBDServer *server = nullptr;
+    Connection *conn = nullptr;
     struct nbd_request request;
     struct nbd_reply reply;
     bufferlist data;
@@ -261,62 +269,133 @@ private:
 
   friend std::ostream &operator<<(std::ostream &os, const IOContext &ctx);
 
+  class ConnectionThread : public Thread
+  {
+  public:
+    typedef void (NBDServer::*entry_func)(Connection *);
+  private:
+    NBDServer &server;
+    Connection *conn;
+    entry_func func;
+  public:
+    ConnectionThread(NBDServer &_server, Connection *_conn, entry_func _func)
+      :server(_server)
+      ,conn(_conn)
+      ,func(_func)
+    {}
+  protected:
+    void* entry() override
+    {
+      (server.*func)(conn);
+      return NULL;
+    }
+  };
+
+  // each nbd socket is served by its own reader/writer thread pair and
+  // tracks its own in-flight requests, while all of them share the image
+  // so that a flush received on any socket covers writes completed on
+  // every socket (as NBD_FLAG_CAN_MULTI_CONN requires)
+  struct Connection
+  {
+    NBDServer &server;
+    int fd;
+
+    ceph::mutex lock = ceph::make_mutex("NBDServer::Connection::Locker");
+    ceph::condition_variable cond;
+    xlist<IOContext*> io_pending;
+    xlist<IOContext*> io_finished;
+
+    ConnectionThread reader_thread;
+    ConnectionThread writer_thread;
+
+    Connection(NBDServer &server, int fd)
+      : server(server)
+      , fd(fd)
+      , reader_thread(server, this, &NBDServer::reader_entry)
+      , writer_thread(server, this, &NBDServer::writer_entry)
+    {}
+  };
+
   ceph::mutex lock = ceph::make_mutex("NBDServer::Locker");
   ceph::condition_variable cond;
-  xlist<IOContext*> io_pending;
-  xlist<IOContext*> io_finished;
 
   void io_start(IOContext *ctx)
   {
-    std::lock_guard l{lock};
-    io_pending.push_back(&ctx->item);
+    auto conn = ctx->conn;
+    std::lock_guard l{conn->lock};
+    conn->io_pending.push_back(&ctx->item);
   }
 
   void io_finish(IOContext *ctx)
   {
-    std::lock_guard l{lock};
+    auto conn = ctx->conn;
+    std::lock_guard l{conn->lock};
     ceph_assert(ctx->item.is_on_list());
     ctx->item.remove_myself();
-    io_finished.push_back(&ctx->item);
-    cond.notify_all();
+    conn->io_finished.push_back(&ctx->item);
+    conn->cond.notify_all();
   }
 
-  IOContext *wait_io_finish()
+  IOContext *wait_io_finish(Connection *conn)
   {
-    std::unique_lock l{lock};
-    cond.wait(l, [this] {
-                   return !io_finished.empty() ||
-                          (io_pending.empty() && terminated);
-                 });
+    std::unique_lock l{conn->lock};
+    conn->cond.wait(l, [this, conn] {
+                         return !conn->io_finished.empty() ||
+                                (conn->io_pending.empty() && terminated);
+                       });
 
-    if (io_finished.empty())
+    if (conn->io_finished.empty())
       return NULL;
 
-    IOContext *ret = io_finished.front();
-    io_finished.pop_front();
+    IOContext *ret = conn->io_finished.front();
+    conn->io_finished.pop_front();
 
     return ret;
   }
 
-  void wait_clean()
+  void wait_clean(Connection *conn)
   {
-    std::unique_lock l{lock};
-    cond.wait(l, [this] { return io_pending.empty(); });
+    std::unique_lock l{conn->lock};
+    conn->cond.wait(l, [conn] { return conn->io_pending.empty(); });
 
-    while(!io_finished.empty()) {
-      std::unique_ptr<IOContext> free_ctx(io_finished.front());
-      io_finished.pop_front();
+    while(!conn->io_finished.empty()) {
+      std::unique_ptr<IOContext> free_ctx(conn->io_finished.front());
+      conn->io_finished.pop_front();
     }
   }
 
   void assert_clean()
   {
-    std::unique_lock l{lock};
+    for (auto& conn : connections) {
+      std::unique_lock l{conn->lock};
+
+      ceph_assert(!conn->reader_thread.is_started());
+      ceph_assert(!conn->writer_thread.is_started());
+      ceph_assert(conn->io_pending.empty());
+      ceph_assert(conn->io_finished.empty());
+    }
+  }
+
+  void terminate()
+  {
+    {
+      std::lock_guard l{lock};
+      terminated = true;
+      cond.notify_all();
+    }
+
+    for (auto& conn : connections) {
+      std::lock_guard l{conn->lock};
+      conn->cond.notify_all();
+    }
 
-    ceph_assert(!reader_thread.is_started());
-    ceph_assert(!writer_thread.is_started());
-    ceph_assert(io_pending.empty());
-    ceph_assert(io_finished.empty());
+    if (connections.size() > 1) {
+      // wake up the readers of the remaining connections
+      terminate_event_sock.notify();
+    }
+
+    std::lock_guard disconnect_l{disconnect_lock};
+    disconnect_cond.notify_all();
   }
 
   static void aio_callback(librbd::completion_t cb, void *arg)
@@ -349,13 +428,14 @@ private:
     } else {
       ctx->reply.error = native_to_big<uint32_t>(0);
     }
-    ctx->server->io_finish(ctx);
+    ctx->conn->server.io_finish(ctx);
 
     aio_completion->release();
   }
 
-  void reader_entry()
+  void reader_entry(Connection *conn)
   {
+    int fd = conn->fd;
     struct pollfd poll_fds[2];
     memset(poll_fds, 0, sizeof(struct pollfd) * 2);
     poll_fds[0].fd = fd;
@@ -365,7 +445,7 @@ private:
 
     while (true) {
       std::unique_ptr<IOContext> ctx(new IOContext());
-      ctx->server = this;
+      ctx->conn = conn;
 
       dout(20) << __func__ << ": waiting for nbd request" << dendl;
 
@@ -462,21 +542,17 @@ error:
       }
     }
 signal:
-    std::lock_guard l{lock};
-    terminated = true;
-    cond.notify_all();
-
-    std::lock_guard disconnect_l{disconnect_lock};
-    disconnect_cond.notify_all();
+    terminate();
 
     dout(20) << __func__ << ": terminated" << dendl;
   }
 
-  void writer_entry()
+  void writer_entry(Connection *conn)
   {
+    int fd = conn->fd;
     while (true) {
       dout(20) << __func__ << ": waiting for io request" << dendl;
-      std::unique_ptr<IOContext> ctx(wait_io_finish());
+      std::unique_ptr<IOContext> ctx(wait_io_finish(conn));
       if (!ctx) {
 	dout(20) << __func__ << ": no io requests, terminating" << dendl;
         goto done;
@@ -501,7 +577,7 @@ signal:
       dout(20) << *ctx << ": finish" << dendl;
     }
   error:
-    wait_clean();
+    wait_clean(conn);
   done:
     ::shutdown(fd, SHUT_RDWR);
 
@@ -601,7 +677,7 @@ signal:
       (server.*func)();
       return NULL;
     }
-  } reader_thread, writer_thread, quiesce_thread;
+  } quiesce_thread;
 
   bool started = false;
   bool quiesce = false;
@@ -620,8 +696,10 @@ public:
                                         EVENT_SOCKET_TYPE_EVENTFD);
       ceph_assert(r >= 0);
 
-      reader_thread.create("rbd_reader");
-      writer_thread.create("rbd_writer");
+      for (auto& conn : connections) {
+        conn->reader_thread.create("rbd_reader");
+        conn->writer_thread.create("rbd_writer");
+      }
       if (cfg->quiesce) {
         quiesce_thread.create("rbd_quiesce");
       }
@@ -666,8 +744,10 @@ public:
 
       terminate_event_sock.notify();
 
-      reader_thread.join();
-      writer_thread.join();
+      for (auto& conn : connections) {
+        conn->reader_thread.join();
+        conn->writer_thread.join();
+      }
       if (cfg->quiesce) {
         quiesce_thread.join();
       }
@@ -1343,8 +1423,9 @@ static int netlink_connect_cb(struct nl_msg *msg, void *arg)
   return NL_OK;
 }
 
-static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id, int fd,
-                           uint64_t size, uint64_t flags, bool reconnect)
+static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id,
+                           const std::vector<int>& fds, uint64_t size,
+                           uint64_t flags, bool reconnect)
 {
   struct nlattr *sock_attr;
   struct nlattr *sock_opt;
@@ -1399,14 +1480,16 @@ static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id, int fd,
     goto free_msg;
   }
 
-  sock_opt = nla_nest_start(msg, NBD_SOCK_ITEM);
-  if (!sock_opt) {
-    cerr << "rbd-nbd: Could not init sock in netlink message." << std::endl;
-    goto free_msg;
-  }
+  for (auto fd : fds) {
+    sock_opt = nla_nest_start(msg, NBD_SOCK_ITEM);
+    if (!sock_opt) {
+      cerr << "rbd-nbd: Could not init sock in netlink message." << std::endl;
+      goto free_msg;
+    }
 
-  NLA_PUT_U32(msg, NBD_SOCK_FD, fd);
-  nla_nest_end(msg, sock_opt);
+    NLA_PUT_U32(msg, NBD_SOCK_FD, fd);
+    nla_nest_end(msg, sock_opt);
+  }
   nla_nest_end(msg, sock_attr);
 
   ret = nl_send_sync(sock, msg);
@@ -1425,8 +1508,8 @@ free_msg:
   return -EIO;
 }
 
-static int try_netlink_setup(Config *cfg, int fd, uint64_t size, uint64_t flags,
-                             bool reconnect)
+static int try_netlink_setup(Config *cfg, const std::vector<int>& fds,
+                             uint64_t size, uint64_t flags, bool reconnect)
 {
   struct nl_sock *sock;
   int nl_id, ret;
@@ -1440,7 +1523,7 @@ static int try_netlink_setup(Config *cfg, int fd, uint64_t size, uint64_t flags,
 
   dout(10) << "netlink interface supported." << dendl;
 
-  ret = netlink_connect(cfg, sock, nl_id, fd, size, flags, reconnect);
+  ret = netlink_connect(cfg, sock, nl_id, fds, size, flags, reconnect);
   netlink_cleanup(sock);
 
   if (ret != 0)
@@ -1496,11 +1579,12 @@ static void handle_signal(int signum)
   terminate_event_sock.notify();
 }
 
-static NBDServer *start_server(int fd, librbd::Image& image, Config *cfg)
+static NBDServer *start_server(const std::vector<int>& fds,
+                               librbd::Image& image, Config *cfg)
 {
   NBDServer *server;
 
-  server = new NBDServer(fd, image, cfg);
+  server = new NBDServer(fds, image, cfg);
   server->start();
 
   init_async_signal_handler();
@@ -1626,7 +1710,9 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   unsigned long blksize = RBD_NBD_BLKSIZE;
   bool use_netlink;
 
-  int fd[2];
+  // kernel side (fds) and server side (server_fds) of the nbd sockets
+  std::vector<int> fds;
+  std::vector<int> server_fds;
 
   librbd::image_info_t info;
 
@@ -1667,9 +1753,14 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   common_init_finish(g_ceph_context);
   global_init_chdir(g_ceph_context);
 
-  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == -1) {
-    r = -errno;
-    goto close_ret;
+  for (int i = 0; i < cfg->num_connections; ++i) {
+    int fd[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == -1) {
+      r = -errno;
+      goto close_fd;
+    }
+    fds.push_back(fd[0]);
+    server_fds.push_back(fd[1]);
   }
 
   r = rados.init_with_context(g_ceph_context);
@@ -1785,6 +1876,9 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
     flags |= NBD_FLAG_READ_ONLY;
     read_only = 1;
   }
+  if (cfg->num_connections > 1) {
+    flags |= NBD_FLAG_CAN_MULTI_CONN;
+  }
 
   if (info.size > ULONG_MAX) {
     r = -EFBIG;
@@ -1799,7 +1893,7 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   if (r < 0)
     goto close_fd;
 
-  server = start_server(fd[1], image, cfg);
+  server = start_server(server_fds, image, cfg);
 
   use_netlink = cfg->try_netlink || reconnect;
   if (use_netlink) {
@@ -1809,7 +1903,7 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
       uuid_gen.generate_random();
       cfg->cookie = uuid_gen.to_string();
     }
-    r = try_netlink_setup(cfg, fd[0], size, flags, reconnect);
+    r = try_netlink_setup(cfg, fds, size, flags, reconnect);
     if (r < 0) {
       goto free_server;
     } else if (r == 1) {
@@ -1818,7 +1912,13 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   }
 
   if (!use_netlink) {
-    r = try_ioctl_setup(cfg, fd[0], size, blksize, flags);
+    if (fds.size() > 1) {
+      r = -EINVAL;
+      cerr << "rbd-nbd: multiple connections require the netlink interface"
+           << std::endl;
+      goto free_server;
+    }
+    r = try_ioctl_setup(cfg, fds[0], size, blksize, flags);
     if (r < 0)
       goto free_server;
   }
@@ -1887,9 +1987,12 @@ close_nbd:
 free_server:
   delete server;
 close_fd:
-  close(fd[0]);
-  close(fd[1]);
-close_ret:
+  for (auto fd : fds) {
+    close(fd);
+  }
+  for (auto fd : server_fds) {
+    close(fd);
+  }
   image.close();
   io_ctx.close();
   rados.shutdown();
@@ -2142,6 +2245,16 @@ static int parse_args(vector<const char*>& args, std::ostream *err_msg,
       cfg->exclusive = true;
     } else if (ceph_argparse_flag(args, i, "--notrim", (char *)NULL)) {
       cfg->notrim = true;
+    } else if (ceph_argparse_witharg(args, i, &cfg->num_connections, err,
+                                     "--num-connections", (char *)NULL)) {
+      if (!err.str().empty()) {
+        *err_msg << "rbd-nbd: " << err.str();
+        return -EINVAL;
+      }
+      if (cfg->num_connections < 1) {
+        *err_msg << "rbd-nbd: Invalid argument for num-connections!";
+        return -EINVAL;
+      }
     } else if (ceph_argparse_witharg(args, i, &cfg->io_timeout, err,
                                      "--timeout", (char *)NULL)) {
       if (!err.str().empty()) {